@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/VM/IR/VMDialect.h"
 #include "iree/compiler/Dialect/VM/IR/VMTypes.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/TypeSwitch.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Diagnostics.h"
 
@@ -354,10 +355,64 @@ private:
 
 } // namespace
 
+// Returns the fused compare-and-branch opcode for |op| if it is a comparison
+// whose only use is as the condition of the vm.cond_br immediately following
+// it. The comparison result is never materialized in a register.
+static std::optional<Opcode>
+matchCompareBranch(Operation *op, IREE::VM::CondBranchOp &outCondBranchOp) {
+  auto condBranchOp =
+      dyn_cast_or_null<IREE::VM::CondBranchOp>(op->getNextNode());
+  if (!condBranchOp || op->getNumResults() != 1 ||
+      !op->getResult(0).hasOneUse() ||
+      condBranchOp.getCondition() != op->getResult(0)) {
+    return std::nullopt;
+  }
+  auto opcode =
+      llvm::TypeSwitch<Operation *, std::optional<Opcode>>(op)
+          .Case([](IREE::VM::CmpEQI32Op) { return Opcode::CmpBrEQI32; })
+          .Case([](IREE::VM::CmpNEI32Op) { return Opcode::CmpBrNEI32; })
+          .Case([](IREE::VM::CmpLTI32SOp) { return Opcode::CmpBrLTI32S; })
+          .Case([](IREE::VM::CmpLTI32UOp) { return Opcode::CmpBrLTI32U; })
+          .Case([](IREE::VM::CmpEQI64Op) { return Opcode::CmpBrEQI64; })
+          .Case([](IREE::VM::CmpNEI64Op) { return Opcode::CmpBrNEI64; })
+          .Case([](IREE::VM::CmpLTI64SOp) { return Opcode::CmpBrLTI64S; })
+          .Case([](IREE::VM::CmpLTI64UOp) { return Opcode::CmpBrLTI64U; })
+          .Default([](Operation *) { return std::nullopt; });
+  if (opcode)
+    outCondBranchOp = condBranchOp;
+  return opcode;
+}
+
+// Encodes |compareOp| and the |condBranchOp| consuming its result as a single
+// fused |opcode|. Operands are mapped against the op that uses them so that
+// register allocation and branch remapping match the unfused encoding.
+static LogicalResult encodeCompareBranch(Opcode opcode, Operation *compareOp,
+                                         IREE::VM::CondBranchOp condBranchOp,
+                                         VMFuncEncoder &encoder) {
+  if (failed(encoder.beginOp(compareOp)) ||
+      failed(encoder.encodeOpcode(stringifyOpcode(opcode),
+                                  static_cast<int>(opcode))) ||
+      failed(encoder.encodeOperand(compareOp->getOperand(0), 0)) ||
+      failed(encoder.encodeOperand(compareOp->getOperand(1), 1)) ||
+      failed(encoder.endOp(compareOp))) {
+    return failure();
+  }
+  if (failed(encoder.beginOp(condBranchOp)) ||
+      failed(encoder.encodeBranch(condBranchOp.getTrueDest(),
+                                  condBranchOp.getTrueOperands(), 0)) ||
+      failed(encoder.encodeBranch(condBranchOp.getFalseDest(),
+                                  condBranchOp.getFalseOperands(), 1)) ||
+      failed(encoder.endOp(condBranchOp))) {
+    return failure();
+  }
+  return success();
+}
+
 // static
 std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase) {
+    SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+    bool fuseOps) {
   EncodedBytecodeFunction result;
 
   // Perform register allocation first so that we can quickly lookup values as
@@ -380,7 +435,28 @@ std::optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       return std::nullopt;
     }
 
+    Operation *fusedOp = nullptr;
     for (auto &op : block.getOperations()) {
+      if (&op == fusedOp) {
+        // Already encoded as part of a fused superinstruction.
+        continue;
+      }
+      IREE::VM::CondBranchOp condBranchOp;
+      if (fuseOps) {
+        if (auto opcode = matchCompareBranch(&op, condBranchOp)) {
+          sourceMap.locations.push_back(
+              {static_cast<int32_t>(encoder.getOffset()), op.getLoc()});
+          if (failed(encodeCompareBranch(*opcode, &op, condBranchOp,
+                                         encoder))) {
+            op.emitOpError() << "failed to encode fused compare-and-branch";
+            return std::nullopt;
+          }
+          fusedOp = condBranchOp;
+          result.usesFusedOps = true;
+          continue;
+        }
+      }
+
       auto serializableOp = dyn_cast<IREE::VM::VMSerializableOp>(op);
       if (!serializableOp) {
         if (op.hasTrait<OpTrait::IREE::VM::AssignmentOp>()) {
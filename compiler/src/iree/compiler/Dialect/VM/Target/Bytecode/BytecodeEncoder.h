@@ -28,6 +28,10 @@ struct EncodedBytecodeFunction {
   uint16_t i32RegisterCount = 0;
   // Total vm.ref register slots required for execution.
   uint16_t refRegisterCount = 0;
+
+  // True if fused superinstructions were emitted into the bytecode and the
+  // function requires the EXT_FUSED feature at runtime.
+  bool usesFusedOps = false;
 };
 
 // Abstract encoder used for function bytecode encoding.
@@ -40,10 +44,14 @@ public:
   static constexpr uint32_t kVersion = (kVersionMajor << 16) | kVersionMinor;
 
   // Encodes a vm.func to bytecode and returns the result.
+  // If |fuseOps| is true then common op sequences are encoded as fused
+  // superinstructions (see VMOpcodesCore.td) that require the EXT_FUSED
+  // feature.
   // Returns None on failure.
   static std::optional<EncodedBytecodeFunction>
   encodeFunction(IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-                 SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase);
+                 SymbolTable &symbolTable, DebugDatabaseBuilder &debugDatabase,
+                 bool fuseOps);
 
   BytecodeEncoder() = default;
   ~BytecodeEncoder() = default;
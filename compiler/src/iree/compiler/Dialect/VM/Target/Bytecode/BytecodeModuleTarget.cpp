@@ -365,11 +365,15 @@ buildFlatBufferModule(IREE::VM::TargetOptions vmOptions,
   size_t totalBytecodeLength = 0;
   for (auto [i, funcOp] : llvm::enumerate(internalFuncOps)) {
     auto encodedFunction = BytecodeEncoder::encodeFunction(
-        funcOp, typeOrdinalMap, symbolTable, debugDatabase);
+        funcOp, typeOrdinalMap, symbolTable, debugDatabase,
+        bytecodeOptions.fuseOps);
     if (!encodedFunction) {
       return funcOp.emitError() << "failed to encode function bytecode";
     }
     auto funcRequirements = findRequiredFeatures(funcOp);
+    if (encodedFunction->usesFusedOps) {
+      funcRequirements |= iree_vm_FeatureBits_EXT_FUSED;
+    }
     moduleRequirements |= funcRequirements;
     iree_vm_FunctionDescriptor_assign(
         &functionDescriptors[i], totalBytecodeLength,
@@ -542,6 +546,8 @@ buildFlatBufferModule(IREE::VM::TargetOptions vmOptions,
     allowedFeatures |= iree_vm_FeatureBits_EXT_F32;
   if (vmOptions.f64Extension)
     allowedFeatures |= iree_vm_FeatureBits_EXT_F64;
+  if (bytecodeOptions.fuseOps)
+    allowedFeatures |= iree_vm_FeatureBits_EXT_FUSED;
   if ((moduleRequirements & allowedFeatures) != moduleRequirements) {
     return moduleOp.emitError()
            << "module uses features not allowed by flags (requires "
@@ -749,6 +755,12 @@ void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
   binder.opt<bool>("iree-vm-bytecode-module-strip-debug-ops", stripDebugOps,
                    llvm::cl::cat(vmBytecodeOptionsCategory),
                    llvm::cl::desc("Strips debug-only ops from the module"));
+  binder.opt<bool>(
+      "iree-vm-bytecode-module-fuse-ops", fuseOps,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Encodes common op sequences such as compare-and-branch "
+                     "as fused superinstructions (requires a runtime built "
+                     "with the EXT_FUSED feature)"));
   binder.opt<bool>(
       "iree-vm-emit-polyglot-zip", emitPolyglotZip,
       llvm::cl::cat(vmBytecodeOptionsCategory),
@@ -48,6 +48,12 @@ struct BytecodeTargetOptions {
   // Strips vm ops with the VM_DebugOnly trait.
   bool stripDebugOps = false;
 
+  // Encodes common op sequences as fused superinstructions. This reduces the
+  // number of instructions dispatched in hot loops but requires a runtime
+  // built with IREE_VM_EXT_FUSED_ENABLE. Disabled by default so that modules
+  // load on any runtime; deployments that control the runtime can opt in.
+  bool fuseOps = false;
+
   // Enables the output .vmfb to be inspected as a ZIP file.
   // This is useful for debugging/diagnosing issues as embedded executables can
   // be extracted and inspected. It adds several KB to the output files and
@@ -0,0 +1,36 @@
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN: --iree-vm-bytecode-module-output-format=flatbuffer-text \
+// RUN: --iree-vm-bytecode-module-fuse-ops=true %s | FileCheck %s
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN: --iree-vm-bytecode-module-output-format=flatbuffer-text %s | \
+// RUN: FileCheck %s --check-prefix=UNFUSED
+
+// UNFUSED-NOT: EXT_FUSED
+
+// CHECK: "name": "fused_module"
+vm.module @fused_module {
+  vm.export @max_i32
+
+  // CHECK: "function_descriptors":
+  // CHECK: "requirements": "EXT_FUSED"
+  vm.func @max_i32(%arg0 : i32, %arg1 : i32) -> i32 {
+    %cmp = vm.cmp.lt.i32.s %arg0, %arg1 : i32
+    vm.cond_br %cmp, ^bb1, ^bb2
+  ^bb1:
+    vm.return %arg1 : i32
+  ^bb2:
+    vm.return %arg0 : i32
+  }
+
+  // The comparison and branch are encoded as a single CmpBrLTI32S (0x87).
+  //      CHECK: "bytecode_data": [
+  // CHECK-NEXT:   121,
+  // CHECK-NEXT:   135,
+
+  // Without fusion the CmpLTI32S (0x4B) is followed by a CondBranch.
+  //      UNFUSED: "bytecode_data": [
+  // UNFUSED-NEXT:   121,
+  // UNFUSED-NEXT:   75,
+}
+
+// UNFUSED-NOT: EXT_FUSED
@@ -332,6 +332,12 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_EXT_F64_ENABLE 1
 #endif  // !IREE_VM_EXT_F64_ENABLE
 
+#if !defined(IREE_VM_EXT_FUSED_ENABLE)
+// Enables the fused superinstruction extension (compare-and-branch, etc).
+// Targeted from the compiler with `--iree-vm-bytecode-module-fuse-ops`.
+#define IREE_VM_EXT_FUSED_ENABLE 1
+#endif  // !IREE_VM_EXT_FUSED_ENABLE
+
 #if !defined(IREE_VM_UBSAN_CHECKABLE_ENABLE)
 // Exposes VMVX kernels to UBSAN checking, else disable UBSAN checking.
 #define IREE_VM_UBSAN_CHECKABLE_ENABLE 0
@@ -0,0 +1,162 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/sha256.h"
+
+#include <string.h>
+
+// Round constants: the first 32 bits of the fractional parts of the cube roots
+// of the first 64 primes.
+static const uint32_t iree_sha256_k[64] = {
+    0x428A2F98u, 0x71374491u, 0xB5C0FBCFu, 0xE9B5DBA5u, 0x3956C25Bu,
+    0x59F111F1u, 0x923F82A4u, 0xAB1C5ED5u, 0xD807AA98u, 0x12835B01u,
+    0x243185BEu, 0x550C7DC3u, 0x72BE5D74u, 0x80DEB1FEu, 0x9BDC06A7u,
+    0xC19BF174u, 0xE49B69C1u, 0xEFBE4786u, 0x0FC19DC6u, 0x240CA1CCu,
+    0x2DE92C6Fu, 0x4A7484AAu, 0x5CB0A9DCu, 0x76F988DAu, 0x983E5152u,
+    0xA831C66Du, 0xB00327C8u, 0xBF597FC7u, 0xC6E00BF3u, 0xD5A79147u,
+    0x06CA6351u, 0x14292967u, 0x27B70A85u, 0x2E1B2138u, 0x4D2C6DFCu,
+    0x53380D13u, 0x650A7354u, 0x766A0ABBu, 0x81C2C92Eu, 0x92722C85u,
+    0xA2BFE8A1u, 0xA81A664Bu, 0xC24B8B70u, 0xC76C51A3u, 0xD192E819u,
+    0xD6990624u, 0xF40E3585u, 0x106AA070u, 0x19A4C116u, 0x1E376C08u,
+    0x2748774Cu, 0x34B0BCB5u, 0x391C0CB3u, 0x4ED8AA4Au, 0x5B9CCA4Fu,
+    0x682E6FF3u, 0x748F82EEu, 0x78A5636Fu, 0x84C87814u, 0x8CC70208u,
+    0x90BEFFFAu, 0xA4506CEBu, 0xBEF9A3F7u, 0xC67178F2u,
+};
+
+static inline uint32_t iree_sha256_rotr(uint32_t value, int shift) {
+  return (value >> shift) | (value << (32 - shift));
+}
+
+// Hashes |block_count| consecutive 64-byte blocks at |data| into |state|.
+static void iree_sha256_transform(uint32_t state[8], const uint8_t* data,
+                                  iree_host_size_t block_count) {
+  for (; block_count > 0; --block_count, data += 64) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = ((uint32_t)data[i * 4 + 0] << 24) |
+             ((uint32_t)data[i * 4 + 1] << 16) |
+             ((uint32_t)data[i * 4 + 2] << 8) | ((uint32_t)data[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+      const uint32_t s0 = iree_sha256_rotr(w[i - 15], 7) ^
+                          iree_sha256_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = iree_sha256_rotr(w[i - 2], 17) ^
+                          iree_sha256_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+      const uint32_t s1 = iree_sha256_rotr(e, 6) ^ iree_sha256_rotr(e, 11) ^
+                          iree_sha256_rotr(e, 25);
+      const uint32_t ch = (e & f) ^ (~e & g);
+      const uint32_t t1 = h + s1 + ch + iree_sha256_k[i] + w[i];
+      const uint32_t s0 = iree_sha256_rotr(a, 2) ^ iree_sha256_rotr(a, 13) ^
+                          iree_sha256_rotr(a, 22);
+      const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      const uint32_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+void iree_sha256_initialize(iree_sha256_t* out_sha) {
+  // The first 32 bits of the fractional parts of the square roots of the first
+  // 8 primes.
+  out_sha->state[0] = 0x6A09E667u;
+  out_sha->state[1] = 0xBB67AE85u;
+  out_sha->state[2] = 0x3C6EF372u;
+  out_sha->state[3] = 0xA54FF53Au;
+  out_sha->state[4] = 0x510E527Fu;
+  out_sha->state[5] = 0x9B05688Cu;
+  out_sha->state[6] = 0x1F83D9ABu;
+  out_sha->state[7] = 0x5BE0CD19u;
+  out_sha->length = 0;
+  out_sha->block_length = 0;
+}
+
+void iree_sha256_update(iree_sha256_t* sha, iree_const_byte_span_t data) {
+  const uint8_t* ptr = data.data;
+  iree_host_size_t remaining = data.data_length;
+  if (!remaining) return;
+  sha->length += remaining;
+
+  // Complete any partial block from a prior update.
+  if (sha->block_length > 0) {
+    const iree_host_size_t fill =
+        iree_min(remaining, sizeof(sha->block) - sha->block_length);
+    memcpy(sha->block + sha->block_length, ptr, fill);
+    sha->block_length += fill;
+    ptr += fill;
+    remaining -= fill;
+    if (sha->block_length < sizeof(sha->block)) return;
+    iree_sha256_transform(sha->state, sha->block, 1);
+    sha->block_length = 0;
+  }
+
+  // Hash whole blocks directly from the input.
+  const iree_host_size_t block_count = remaining / 64;
+  iree_sha256_transform(sha->state, ptr, block_count);
+  ptr += block_count * 64;
+  remaining -= block_count * 64;
+
+  if (remaining > 0) {
+    memcpy(sha->block, ptr, remaining);
+    sha->block_length = remaining;
+  }
+}
+
+void iree_sha256_finalize(iree_sha256_t* sha,
+                          iree_sha256_digest_t* out_digest) {
+  const uint64_t bit_length = sha->length * 8;
+
+  // Pad with a single 1 bit and zeros up to 8 bytes before a block boundary
+  // followed by the big-endian message length in bits.
+  sha->block[sha->block_length++] = 0x80;
+  if (sha->block_length > sizeof(sha->block) - 8) {
+    memset(sha->block + sha->block_length, 0,
+           sizeof(sha->block) - sha->block_length);
+    iree_sha256_transform(sha->state, sha->block, 1);
+    sha->block_length = 0;
+  }
+  memset(sha->block + sha->block_length, 0,
+         sizeof(sha->block) - 8 - sha->block_length);
+  for (int i = 0; i < 8; ++i) {
+    sha->block[sizeof(sha->block) - 1 - i] = (uint8_t)(bit_length >> (i * 8));
+  }
+  iree_sha256_transform(sha->state, sha->block, 1);
+  sha->block_length = 0;
+
+  for (int i = 0; i < 8; ++i) {
+    out_digest->bytes[i * 4 + 0] = (uint8_t)(sha->state[i] >> 24);
+    out_digest->bytes[i * 4 + 1] = (uint8_t)(sha->state[i] >> 16);
+    out_digest->bytes[i * 4 + 2] = (uint8_t)(sha->state[i] >> 8);
+    out_digest->bytes[i * 4 + 3] = (uint8_t)(sha->state[i]);
+  }
+}
+
+void iree_sha256(iree_const_byte_span_t data,
+                 iree_sha256_digest_t* out_digest) {
+  iree_sha256_t sha;
+  iree_sha256_initialize(&sha);
+  iree_sha256_update(&sha, data);
+  iree_sha256_finalize(&sha, out_digest);
+}
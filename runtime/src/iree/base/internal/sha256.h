@@ -0,0 +1,59 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_SHA256_H_
+#define IREE_BASE_INTERNAL_SHA256_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//===----------------------------------------------------------------------===//
+// SHA-256 (FIPS 180-4)
+//===----------------------------------------------------------------------===//
+
+// Size in bytes of a SHA-256 digest.
+#define IREE_SHA256_DIGEST_SIZE 32
+
+// A SHA-256 digest.
+typedef struct iree_sha256_digest_t {
+  uint8_t bytes[IREE_SHA256_DIGEST_SIZE];
+} iree_sha256_digest_t;
+
+// Incremental SHA-256 hashing state.
+// Used when data is not contiguous; iree_sha256 hashes a single span.
+typedef struct iree_sha256_t {
+  // Intermediate hash value.
+  uint32_t state[8];
+  // Total number of bytes hashed.
+  uint64_t length;
+  // Partial block of data not yet hashed.
+  uint8_t block[64];
+  iree_host_size_t block_length;
+} iree_sha256_t;
+
+// Initializes |out_sha| to hash new data.
+void iree_sha256_initialize(iree_sha256_t* out_sha);
+
+// Hashes |data| following any data previously hashed with |sha|.
+void iree_sha256_update(iree_sha256_t* sha, iree_const_byte_span_t data);
+
+// Finishes hashing and stores the digest of all data in |out_digest|.
+// |sha| must be initialized again before hashing new data.
+void iree_sha256_finalize(iree_sha256_t* sha, iree_sha256_digest_t* out_digest);
+
+// Stores the SHA-256 digest of |data| in |out_digest|.
+void iree_sha256(iree_const_byte_span_t data, iree_sha256_digest_t* out_digest);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // IREE_BASE_INTERNAL_SHA256_H_
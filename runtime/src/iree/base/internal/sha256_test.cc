@@ -0,0 +1,65 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/sha256.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+static std::string ToHex(const iree_sha256_digest_t& digest) {
+  std::string hex;
+  for (uint8_t byte : digest.bytes) {
+    char chars[3];
+    snprintf(chars, sizeof(chars), "%02x", byte);
+    hex += chars;
+  }
+  return hex;
+}
+
+static std::string Sha256(const std::string& data) {
+  iree_sha256_digest_t digest;
+  iree_sha256(iree_make_const_byte_span(data.data(), data.size()), &digest);
+  return ToHex(digest);
+}
+
+// Test vectors from FIPS 180-4 examples and NIST CAVP.
+TEST(Sha256Test, KnownDigests) {
+  EXPECT_EQ(Sha256(""),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  EXPECT_EQ(Sha256("abc"),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  EXPECT_EQ(Sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  EXPECT_EQ(Sha256(std::string(1000000, 'a')),
+            "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// Tests that digests do not depend on how the data is split across updates.
+TEST(Sha256Test, Incremental) {
+  std::string data;
+  for (int i = 0; i < 300; ++i) data.push_back((char)(i * 7));
+  const std::string expected = Sha256(data);
+  for (size_t split_size : {1, 3, 55, 56, 63, 64, 65, 128, 299}) {
+    iree_sha256_t sha;
+    iree_sha256_initialize(&sha);
+    for (size_t offset = 0; offset < data.size(); offset += split_size) {
+      const size_t length = std::min(split_size, data.size() - offset);
+      iree_sha256_update(
+          &sha, iree_make_const_byte_span(data.data() + offset, length));
+    }
+    iree_sha256_update(&sha, iree_const_byte_span_empty());
+    iree_sha256_digest_t digest;
+    iree_sha256_finalize(&sha, &digest);
+    EXPECT_EQ(ToHex(digest), expected) << "split size " << split_size;
+  }
+}
+
+}  // namespace
@@ -229,6 +229,12 @@ void iree_thread_join(iree_thread_t* thread);
 
 void iree_thread_yield(void);
 
+// Returns the number of bytes of stack remaining to the calling thread below
+// its current stack position or 0 if the platform cannot report it.
+// Intended for deciding whether the caller can safely run work that expects a
+// certain amount of stack (such as tasks normally run on worker threads).
+iree_host_size_t iree_thread_stack_headroom(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
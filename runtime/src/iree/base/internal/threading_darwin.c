@@ -262,4 +262,16 @@ void iree_thread_join(iree_thread_t* thread) {
 
 void iree_thread_yield(void) { sched_yield(); }
 
+iree_host_size_t iree_thread_stack_headroom(void) {
+  // NOTE: darwin reports the highest address of the stack.
+  pthread_t self = pthread_self();
+  const uintptr_t stack_top = (uintptr_t)pthread_get_stackaddr_np(self);
+  const uintptr_t stack_base = stack_top - pthread_get_stacksize_np(self);
+  // The address of a local approximates the current stack pointer.
+  volatile uint8_t marker = 0;
+  const uintptr_t stack_pointer = (uintptr_t)&marker;
+  if (stack_pointer <= stack_base) return 0;
+  return (iree_host_size_t)(stack_pointer - stack_base);
+}
+
 #endif  // IREE_PLATFORM_APPLE
@@ -26,6 +26,7 @@
 #include "iree/base/internal/threading.h"
 
 #if defined(IREE_PLATFORM_EMSCRIPTEN)
+#include <emscripten/stack.h>
 #include <emscripten/threading.h>
 #endif  // IREE_PLATFORM_EMSCRIPTEN
 
@@ -119,6 +120,9 @@ static void* iree_thread_start_routine(void* param) {
   return (void*)((uintptr_t)entry(entry_arg));
 }
 
+static void iree_thread_make_cpu_set_from_affinity(
+    iree_thread_affinity_t affinity, cpu_set_t* out_set);
+
 iree_status_t iree_thread_create(iree_thread_entry_t entry, void* entry_arg,
                                  iree_thread_create_params_t params,
                                  iree_allocator_t allocator,
@@ -153,6 +157,18 @@ iree_status_t iree_thread_create(iree_thread_entry_t entry, void* entry_arg,
     pthread_attr_setstacksize(&thread_attr, params.stack_size);
   }
 
+#if defined(IREE_PLATFORM_LINUX) && !defined(IREE_PLATFORM_ANDROID)
+  // Apply the affinity before the thread starts running so that its stack is
+  // faulted in on the NUMA node it is going to be running on; Linux places
+  // pages on the node of the thread that first touches them. Other platforms
+  // get the affinity applied after creation below.
+  if (!iree_thread_affinity_is_unspecified(params.initial_affinity)) {
+    cpu_set_t cpu_set;
+    iree_thread_make_cpu_set_from_affinity(params.initial_affinity, &cpu_set);
+    pthread_attr_setaffinity_np(&thread_attr, sizeof(cpu_set), &cpu_set);
+  }
+#endif  // IREE_PLATFORM_LINUX && !IREE_PLATFORM_ANDROID
+
   *out_thread = thread;
 
   // Unfortunately we can't create the thread suspended (no API). This means
@@ -458,4 +474,37 @@ void iree_thread_join(iree_thread_t* thread) {
 
 void iree_thread_yield(void) { sched_yield(); }
 
+#if defined(IREE_PLATFORM_EMSCRIPTEN)
+
+iree_host_size_t iree_thread_stack_headroom(void) {
+  return (iree_host_size_t)emscripten_stack_get_free();
+}
+
+#else
+
+// Lowest address of the calling thread's stack or 0 if not yet queried.
+// pthread_getattr_np may need to parse /proc/self/maps for the main thread so
+// the result is cached as it never changes for the lifetime of the thread.
+static _Thread_local uintptr_t iree_thread_stack_base = 0;
+
+iree_host_size_t iree_thread_stack_headroom(void) {
+  if (!iree_thread_stack_base) {
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) return 0;
+    void* stack_addr = NULL;
+    size_t stack_size = 0;
+    int rc = pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) return 0;
+    iree_thread_stack_base = (uintptr_t)stack_addr;
+  }
+  // The address of a local approximates the current stack pointer.
+  volatile uint8_t marker = 0;
+  const uintptr_t stack_pointer = (uintptr_t)&marker;
+  if (stack_pointer <= iree_thread_stack_base) return 0;
+  return (iree_host_size_t)(stack_pointer - iree_thread_stack_base);
+}
+
+#endif  // IREE_PLATFORM_EMSCRIPTEN
+
 #endif  // IREE_PLATFORM_*
@@ -8,6 +8,7 @@
 
 #include <chrono>
 #include <cstring>
+#include <functional>
 #include <thread>
 
 #include "iree/base/internal/atomics.h"
@@ -113,6 +114,59 @@ TEST(ThreadTest, CreateSuspended) {
   iree_notification_deinitialize(&entry_data.barrier);
 }
 
+// Tests that the stack headroom reported on a thread with a known stack size is
+// within that stack.
+TEST(ThreadTest, StackHeadroom) {
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.stack_size = 256 * 1024;
+
+  struct entry_data_t {
+    iree_host_size_t headroom;
+    iree_notification_t barrier;
+    iree_atomic_int32_t done;
+  } entry_data;
+  entry_data.headroom = 0;
+  iree_atomic_store(&entry_data.done, 0, iree_memory_order_relaxed);
+  iree_notification_initialize(&entry_data.barrier);
+  iree_thread_entry_t entry_fn = +[](void* entry_arg) -> int {
+    auto* entry_data = reinterpret_cast<struct entry_data_t*>(entry_arg);
+    entry_data->headroom = iree_thread_stack_headroom();
+    iree_atomic_store(&entry_data->done, 1, iree_memory_order_release);
+    iree_notification_post(&entry_data->barrier, IREE_ALL_WAITERS);
+    return 0;
+  };
+
+  iree_thread_t* thread = nullptr;
+  IREE_ASSERT_OK(iree_thread_create(entry_fn, &entry_data, params,
+                                    iree_allocator_system(), &thread));
+  iree_notification_await(
+      &entry_data.barrier,
+      +[](void* entry_arg) -> bool {
+        auto* entry_data = reinterpret_cast<struct entry_data_t*>(entry_arg);
+        return iree_atomic_load(&entry_data->done,
+                                iree_memory_order_acquire) == 1;
+      },
+      &entry_data, iree_infinite_timeout());
+  iree_thread_release(thread);
+  iree_notification_deinitialize(&entry_data.barrier);
+
+  // 0 indicates the platform can't report the headroom. Platforms may round
+  // the stack size up (and some include guard pages) so only a loose upper
+  // bound is checked.
+  if (entry_data.headroom == 0) GTEST_SKIP() << "stack headroom unavailable";
+  EXPECT_LT(entry_data.headroom, 2 * params.stack_size);
+
+  // Deeper frames have less headroom.
+  iree_host_size_t outer_headroom = iree_thread_stack_headroom();
+  std::function<iree_host_size_t()> inner = []() {
+    volatile uint8_t inner_frame[16 * 1024];
+    inner_frame[0] = 1;
+    return iree_thread_stack_headroom() + inner_frame[0] - 1;
+  };
+  EXPECT_LT(inner(), outer_headroom);
+}
+
 // NOTE: testing whether priority took effect is really hard given that on
 // certain platforms the priority may not be respected or may be clamped by
 // the system. This is here to test the mechanics of the priority override code
@@ -337,4 +337,15 @@ void iree_thread_join(iree_thread_t* thread) {
 
 void iree_thread_yield(void) { YieldProcessor(); }
 
+iree_host_size_t iree_thread_stack_headroom(void) {
+  ULONG_PTR stack_low = 0;
+  ULONG_PTR stack_high = 0;
+  GetCurrentThreadStackLimits(&stack_low, &stack_high);
+  // The address of a local approximates the current stack pointer.
+  volatile uint8_t marker = 0;
+  const uintptr_t stack_pointer = (uintptr_t)&marker;
+  if (stack_pointer <= stack_low) return 0;
+  return (iree_host_size_t)(stack_pointer - stack_low);
+}
+
 #endif  // IREE_PLATFORM_WINDOWS
@@ -9,6 +9,14 @@
 
 #include <stdint.h>
 
+#include "iree/base/target_platform.h"
+
+#if defined(IREE_ARCH_X86_64) && defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#elif defined(IREE_ARCH_X86_64) && defined(IREE_COMPILER_GCC_COMPAT)
+#include <x86intrin.h>
+#endif  // IREE_ARCH_X86_64
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -17,6 +25,26 @@ extern "C" {
 // Also available to other libraries under base/ to avoid circular dependencies.
 int64_t iree_platform_time_now(void);
 
+// Returns the current value of a monotonically increasing tick counter that is
+// much cheaper to read than iree_platform_time_now.
+// Where the CPU has a constant-rate counter readable from user mode (x86-64
+// TSC, AArch64 CNTVCT_EL0) ticks are its cycles and otherwise they are
+// nanoseconds from iree_platform_time_now. The tick rate is not reported:
+// callers that need durations should calibrate tick deltas against the time
+// elapsed over a long enough interval (such as the lifetime of a subsystem).
+static inline int64_t iree_platform_ticks_now(void) {
+#if defined(IREE_ARCH_X86_64) && \
+    (defined(IREE_COMPILER_MSVC) || defined(IREE_COMPILER_GCC_COMPAT))
+  return (int64_t)__rdtsc();
+#elif defined(IREE_ARCH_ARM_64) && defined(IREE_COMPILER_GCC_COMPAT)
+  uint64_t value = 0;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return (int64_t)value;
+#else
+  return iree_platform_time_now();
+#endif  // IREE_ARCH_*
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,1321 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/loop_threaded.h"
+
+#if IREE_LOOP_THREADED_SUPPORTED
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/internal/wait_handle.h"
+
+// Amount of time that can remain in a wait-until while still considering it
+// resolved. This prevents waking the waiter only to sleep again for a few
+// nanoseconds.
+#define IREE_LOOP_THREADED_DELAY_SLOP_NS (2 /*ms*/ * 1000000)
+
+// Maximum number of epoll events processed per system wait.
+#define IREE_LOOP_THREADED_MAX_EPOLL_EVENTS 64
+
+// Marks a wait operation that is not in the deadline heap.
+#define IREE_LOOP_THREADED_HEAP_INDEX_NONE IREE_HOST_SIZE_MAX
+
+typedef struct iree_loop_threaded_dispatch_t iree_loop_threaded_dispatch_t;
+typedef struct iree_loop_threaded_wait_op_t iree_loop_threaded_wait_op_t;
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_run_ring_t
+//===----------------------------------------------------------------------===//
+
+// An operation that is ready to run on a worker.
+typedef struct iree_loop_threaded_run_op_t {
+  // Either IREE_LOOP_COMMAND_CALL or IREE_LOOP_COMMAND_DISPATCH.
+  iree_loop_command_t command;
+  iree_loop_threaded_scope_t* scope;
+  union {
+    // IREE_LOOP_COMMAND_CALL: callback issued with |status|.
+    iree_loop_callback_t callback;
+    // IREE_LOOP_COMMAND_DISPATCH: dispatch this op runs one slice of.
+    iree_loop_threaded_dispatch_t* dispatch;
+  };
+  // Status passed to the callback of a call; owned by the op.
+  iree_status_t status;
+} iree_loop_threaded_run_op_t;
+
+// Growable FIFO ringbuffer of runnable operations.
+// Capacity is reserved for every pending operation (including waits) when it
+// is scheduled so that waits resolving on the waiter thread never need to grow
+// the ring and can't fail to enqueue their callbacks.
+typedef struct iree_loop_threaded_run_ring_t {
+  // Power-of-two sized storage.
+  iree_loop_threaded_run_op_t* ops;
+  iree_host_size_t capacity;
+  iree_host_size_t read_head;
+  iree_host_size_t count;
+} iree_loop_threaded_run_ring_t;
+
+static void iree_loop_threaded_run_ring_deinitialize(
+    iree_loop_threaded_run_ring_t* run_ring, iree_allocator_t allocator) {
+  // Expected the workers to have drained the ring.
+  IREE_ASSERT(run_ring->count == 0);
+  iree_allocator_free(allocator, run_ring->ops);
+  memset(run_ring, 0, sizeof(*run_ring));
+}
+
+// Ensures the ring can hold at least |min_capacity| ops.
+static iree_status_t iree_loop_threaded_run_ring_reserve(
+    iree_loop_threaded_run_ring_t* run_ring, iree_allocator_t allocator,
+    iree_host_size_t min_capacity) {
+  if (IREE_LIKELY(min_capacity <= run_ring->capacity)) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_host_size_t new_capacity = (iree_host_size_t)
+      iree_math_round_up_to_pow2_u64(iree_max(min_capacity, 64));
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)new_capacity);
+
+  iree_loop_threaded_run_op_t* new_ops = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, new_capacity * sizeof(*new_ops),
+                                (void**)&new_ops));
+
+  // Unwrap the existing ops so that they start at index 0.
+  const iree_host_size_t mask = run_ring->capacity - 1;
+  for (iree_host_size_t i = 0; i < run_ring->count; ++i) {
+    new_ops[i] = run_ring->ops[(run_ring->read_head + i) & mask];
+  }
+  iree_allocator_free(allocator, run_ring->ops);
+  run_ring->ops = new_ops;
+  run_ring->capacity = new_capacity;
+  run_ring->read_head = 0;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Appends |op| to the ring. Capacity must have been reserved.
+static void iree_loop_threaded_run_ring_push(
+    iree_loop_threaded_run_ring_t* run_ring, iree_loop_threaded_run_op_t op) {
+  IREE_ASSERT_LT(run_ring->count, run_ring->capacity);
+  const iree_host_size_t mask = run_ring->capacity - 1;
+  run_ring->ops[(run_ring->read_head + run_ring->count) & mask] = op;
+  ++run_ring->count;
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_queue_depth", run_ring->count);
+}
+
+static bool iree_loop_threaded_run_ring_pop(
+    iree_loop_threaded_run_ring_t* run_ring,
+    iree_loop_threaded_run_op_t* out_op) {
+  if (!run_ring->count) return false;
+  *out_op = run_ring->ops[run_ring->read_head];
+  run_ring->read_head = (run_ring->read_head + 1) & (run_ring->capacity - 1);
+  --run_ring->count;
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_queue_depth", run_ring->count);
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Wait operations
+//===----------------------------------------------------------------------===//
+
+// One wait source of a wait operation registered with the waiter.
+typedef struct iree_loop_threaded_wait_link_t {
+  // Wait operation the link belongs to.
+  iree_loop_threaded_wait_op_t* op;
+  // Next link registered against the same file descriptor.
+  struct iree_loop_threaded_wait_link_t* next;
+  // Wait source queried when |fd| is ready or NULL once it has resolved.
+  iree_wait_source_t* wait_source;
+  // File descriptor that becomes readable when the wait source resolves.
+  int fd;
+  // True if the link is in the waiter file descriptor table.
+  bool registered;
+} iree_loop_threaded_wait_link_t;
+
+// A pending wait operation.
+// Allocated when scheduled and owned by the waiter thread once accepted.
+struct iree_loop_threaded_wait_op_t {
+  // Intrusive list of incoming operations or those owned by the waiter.
+  iree_loop_threaded_wait_op_t* next;
+  iree_loop_threaded_wait_op_t* prev;
+  // Intrusive list of operations to query during a waiter iteration.
+  iree_loop_threaded_wait_op_t* next_ready;
+  bool is_ready;
+  iree_loop_command_t command;
+  iree_loop_threaded_scope_t* scope;
+  iree_loop_callback_t callback;
+  // Time the wait-until resolves or any other wait times out.
+  iree_time_t deadline_ns;
+  // Index in the waiter deadline heap or IREE_LOOP_THREADED_HEAP_INDEX_NONE.
+  iree_host_size_t heap_index;
+  // Copy of the wait source of IREE_LOOP_COMMAND_WAIT_ONE operations.
+  iree_wait_source_t wait_one_source;
+  // One link per wait source.
+  iree_host_size_t link_count;
+  iree_loop_threaded_wait_link_t links[];
+};
+
+// Returns the file descriptor that becomes readable when |handle| is signaled
+// or -1 if the handle type cannot be waited on with epoll.
+static int iree_loop_threaded_wait_handle_fd(const iree_wait_handle_t* handle) {
+  switch (handle->type) {
+#if defined(IREE_HAVE_WAIT_TYPE_EVENTFD)
+    case IREE_WAIT_PRIMITIVE_TYPE_EVENT_FD:
+      return handle->value.event.fd;
+#endif  // IREE_HAVE_WAIT_TYPE_EVENTFD
+#if defined(IREE_HAVE_WAIT_TYPE_SYNC_FILE)
+    case IREE_WAIT_PRIMITIVE_TYPE_SYNC_FILE:
+      return handle->value.sync_file.fd;
+#endif  // IREE_HAVE_WAIT_TYPE_SYNC_FILE
+#if defined(IREE_HAVE_WAIT_TYPE_PIPE)
+    case IREE_WAIT_PRIMITIVE_TYPE_PIPE:
+      return handle->value.pipe.read_fd;
+#endif  // IREE_HAVE_WAIT_TYPE_PIPE
+    default:
+      return -1;
+  }
+}
+
+// Resolves |wait_source| to the file descriptor waited on by |link|.
+// Wait sources that are not wait handles are exported and the exported handle
+// is swapped into |wait_source| so that it can be queried on wake.
+static iree_status_t iree_loop_threaded_wait_link_initialize(
+    iree_loop_threaded_wait_op_t* op, iree_wait_source_t* wait_source,
+    iree_loop_threaded_wait_link_t* out_link) {
+  memset(out_link, 0, sizeof(*out_link));
+  out_link->op = op;
+  out_link->fd = -1;
+  if (iree_wait_source_is_immediate(*wait_source)) {
+    // Treated as an already resolved wait.
+    return iree_ok_status();
+  } else if (iree_wait_source_is_delay(*wait_source)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "delays must come from wait-until ops");
+  }
+
+  iree_wait_handle_t* wait_handle = iree_wait_handle_from_source(wait_source);
+  if (!wait_handle) {
+    iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+    IREE_RETURN_IF_ERROR(iree_wait_source_export(
+        *wait_source, IREE_WAIT_PRIMITIVE_TYPE_ANY, iree_immediate_timeout(),
+        &wait_primitive));
+    if (iree_wait_primitive_is_immediate(wait_primitive)) {
+      return iree_ok_status();
+    }
+    IREE_RETURN_IF_ERROR(iree_wait_source_import(wait_primitive, wait_source));
+    wait_handle = iree_wait_handle_from_source(wait_source);
+  }
+
+  const int fd = iree_loop_threaded_wait_handle_fd(wait_handle);
+  if (fd < 0) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "wait primitive type %d cannot be waited on by "
+                            "the threaded loop",
+                            (int)wait_handle->type);
+  }
+  out_link->wait_source = wait_source;
+  out_link->fd = fd;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_t
+//===----------------------------------------------------------------------===//
+
+// Shared state of a dispatch split into one slice per worker.
+struct iree_loop_threaded_dispatch_t {
+  iree_loop_dispatch_params_t params;
+  // Total number of workgroups in the grid.
+  int64_t workgroup_count;
+  // Index of the next workgroup to run.
+  iree_atomic_int64_t next_workgroup;
+  // Number of slices that have not yet retired.
+  iree_atomic_int32_t remaining_slices;
+  // iree_status_t of the first failing workgroup, if any.
+  iree_atomic_intptr_t status;
+};
+
+// Waiter thread state. Only accessed from the waiter thread after allocation.
+typedef struct iree_loop_threaded_waiter_t {
+  iree_thread_t* thread;
+  // epoll instance with all unresolved wait sources and |wake_fd| registered.
+  int epoll_fd;
+  // eventfd written to interrupt the waiter when new work arrives.
+  int wake_fd;
+  // All wait operations owned by the waiter.
+  iree_loop_threaded_wait_op_t* list_head;
+  // Chains of links registered with epoll indexed by file descriptor.
+  iree_loop_threaded_wait_link_t** fd_links;
+  iree_host_size_t fd_capacity;
+  // Min-heap of wait operations with finite deadlines.
+  iree_loop_threaded_wait_op_t** heap;
+  iree_host_size_t heap_count;
+  iree_host_size_t heap_capacity;
+} iree_loop_threaded_waiter_t;
+
+struct iree_loop_threaded_t {
+  iree_allocator_t allocator;
+
+  iree_slim_mutex_t mutex;
+  // Runnable operations. Guarded by |mutex|.
+  iree_loop_threaded_run_ring_t run_ring;
+  // Total pending operations across all scopes. Guarded by |mutex|.
+  int32_t pending_count;
+  // Wait operations not yet accepted by the waiter. Guarded by |mutex|.
+  iree_loop_threaded_wait_op_t* incoming_waits;
+  // Set when a scope fails and the waiter needs to abort its waits. Guarded by
+  // |mutex|.
+  bool abort_requested;
+  // Set when the loop is being freed and no new work may be scheduled.
+  // Guarded by |mutex|.
+  bool exiting;
+  // Set once the waiter has exited and workers should exit once the run ring
+  // is empty. Guarded by |mutex|.
+  bool workers_exiting;
+
+  // Posted when ops are added to |run_ring| or workers should exit.
+  iree_notification_t work_notification;
+  // Posted when a scope or the entire loop becomes idle.
+  iree_notification_t idle_notification;
+
+  iree_loop_threaded_waiter_t waiter;
+
+  iree_host_size_t worker_count;
+  iree_thread_t* workers[];
+};
+
+static void iree_loop_threaded_wake_waiter(
+    iree_loop_threaded_t* loop_threaded) {
+  const uint64_t value = 1;
+  ssize_t rv = 0;
+  do {
+    rv = write(loop_threaded->waiter.wake_fd, &value, sizeof(value));
+  } while (rv < 0 && errno == EINTR);
+}
+
+static bool iree_loop_threaded_scope_is_idle(void* arg) {
+  iree_loop_threaded_scope_t* scope = (iree_loop_threaded_scope_t*)arg;
+  iree_loop_threaded_t* loop_threaded = scope->loop_threaded;
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  const bool is_idle = scope->pending_count == 0;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  return is_idle;
+}
+
+static bool iree_loop_threaded_is_idle(void* arg) {
+  iree_loop_threaded_t* loop_threaded = (iree_loop_threaded_t*)arg;
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  const bool is_idle = loop_threaded->pending_count == 0;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  return is_idle;
+}
+
+static bool iree_loop_threaded_has_work(void* arg) {
+  iree_loop_threaded_t* loop_threaded = (iree_loop_threaded_t*)arg;
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  const bool has_work = loop_threaded->run_ring.count > 0 ||
+                        loop_threaded->workers_exiting;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  return has_work;
+}
+
+// Reserves run ring capacity for |count| new pending operations in |scope|.
+// Must be called with the loop mutex held.
+static iree_status_t iree_loop_threaded_reserve_locked(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_scope_t* scope,
+    iree_host_size_t count) {
+  if (IREE_UNLIKELY(loop_threaded->exiting)) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "new work cannot be enqueued while the loop is shutting down");
+  }
+  IREE_RETURN_IF_ERROR(iree_loop_threaded_run_ring_reserve(
+      &loop_threaded->run_ring, loop_threaded->allocator,
+      (iree_host_size_t)loop_threaded->pending_count + count));
+  scope->pending_count += (int32_t)count;
+  loop_threaded->pending_count += (int32_t)count;
+  return iree_ok_status();
+}
+
+// Retires |count| pending operations from |scope| and notifies any threads
+// waiting for the scope or loop to become idle.
+static void iree_loop_threaded_retire(iree_loop_threaded_t* loop_threaded,
+                                      iree_loop_threaded_scope_t* scope,
+                                      int32_t count) {
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  scope->pending_count -= count;
+  loop_threaded->pending_count -= count;
+  const bool any_idle =
+      scope->pending_count == 0 || loop_threaded->pending_count == 0;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  // NOTE: |scope| may be freed by a drainer as soon as the mutex is released.
+  if (any_idle) {
+    iree_notification_post(&loop_threaded->idle_notification,
+                           IREE_ALL_WAITERS);
+  }
+}
+
+// Marks |scope| as failed and requests that all of its pending operations be
+// aborted.
+static void iree_loop_threaded_abort_scope(iree_loop_threaded_t* loop_threaded,
+                                           iree_loop_threaded_scope_t* scope,
+                                           bool* out_first_failure) {
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  const bool first_failure = !scope->failed;
+  scope->failed = true;
+  loop_threaded->abort_requested = true;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  // Queued calls and dispatches are aborted as they are dequeued but waits
+  // need the waiter to notice.
+  iree_loop_threaded_wake_waiter(loop_threaded);
+  if (out_first_failure) *out_first_failure = first_failure;
+}
+
+// Emits |status| to the given |scope| and aborts associated operations.
+// Only the first failure of a scope is reported.
+static void iree_loop_threaded_emit_error(iree_loop_threaded_t* loop_threaded,
+                                          iree_loop_threaded_scope_t* scope,
+                                          iree_status_t status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(
+      z0, iree_status_code_string(iree_status_code(status)));
+
+  bool first_failure = false;
+  iree_loop_threaded_abort_scope(loop_threaded, scope, &first_failure);
+  if (first_failure && scope->error_fn) {
+    scope->error_fn(scope->error_user_data, status);
+  } else {
+    iree_status_ignore(status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// Waiter thread
+//===----------------------------------------------------------------------===//
+
+static void iree_loop_threaded_heap_swap(iree_loop_threaded_waiter_t* waiter,
+                                         iree_host_size_t i,
+                                         iree_host_size_t j) {
+  iree_loop_threaded_wait_op_t* op = waiter->heap[i];
+  waiter->heap[i] = waiter->heap[j];
+  waiter->heap[j] = op;
+  waiter->heap[i]->heap_index = i;
+  waiter->heap[j]->heap_index = j;
+}
+
+static void iree_loop_threaded_heap_sift_up(
+    iree_loop_threaded_waiter_t* waiter, iree_host_size_t i) {
+  while (i > 0) {
+    const iree_host_size_t parent = (i - 1) / 2;
+    if (waiter->heap[parent]->deadline_ns <= waiter->heap[i]->deadline_ns) {
+      break;
+    }
+    iree_loop_threaded_heap_swap(waiter, i, parent);
+    i = parent;
+  }
+}
+
+static void iree_loop_threaded_heap_sift_down(
+    iree_loop_threaded_waiter_t* waiter, iree_host_size_t i) {
+  for (;;) {
+    const iree_host_size_t left = 2 * i + 1;
+    const iree_host_size_t right = left + 1;
+    iree_host_size_t min = i;
+    if (left < waiter->heap_count &&
+        waiter->heap[left]->deadline_ns < waiter->heap[min]->deadline_ns) {
+      min = left;
+    }
+    if (right < waiter->heap_count &&
+        waiter->heap[right]->deadline_ns < waiter->heap[min]->deadline_ns) {
+      min = right;
+    }
+    if (min == i) break;
+    iree_loop_threaded_heap_swap(waiter, i, min);
+    i = min;
+  }
+}
+
+static iree_status_t iree_loop_threaded_heap_insert(
+    iree_loop_threaded_waiter_t* waiter, iree_allocator_t allocator,
+    iree_loop_threaded_wait_op_t* op) {
+  if (waiter->heap_count == waiter->heap_capacity) {
+    const iree_host_size_t new_capacity =
+        iree_max(64, waiter->heap_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        allocator, new_capacity * sizeof(waiter->heap[0]),
+        (void**)&waiter->heap));
+    waiter->heap_capacity = new_capacity;
+  }
+  const iree_host_size_t i = waiter->heap_count++;
+  waiter->heap[i] = op;
+  op->heap_index = i;
+  iree_loop_threaded_heap_sift_up(waiter, i);
+  return iree_ok_status();
+}
+
+static void iree_loop_threaded_heap_erase(iree_loop_threaded_waiter_t* waiter,
+                                          iree_loop_threaded_wait_op_t* op) {
+  const iree_host_size_t i = op->heap_index;
+  if (i == IREE_LOOP_THREADED_HEAP_INDEX_NONE) return;
+  const iree_host_size_t last = --waiter->heap_count;
+  if (i != last) {
+    waiter->heap[i] = waiter->heap[last];
+    waiter->heap[i]->heap_index = i;
+    iree_loop_threaded_heap_sift_down(waiter, i);
+    iree_loop_threaded_heap_sift_up(waiter, i);
+  }
+  op->heap_index = IREE_LOOP_THREADED_HEAP_INDEX_NONE;
+}
+
+static iree_status_t iree_loop_threaded_waiter_register(
+    iree_loop_threaded_waiter_t* waiter, iree_allocator_t allocator,
+    iree_loop_threaded_wait_link_t* link) {
+  const int fd = link->fd;
+  if ((iree_host_size_t)fd >= waiter->fd_capacity) {
+    const iree_host_size_t old_capacity = waiter->fd_capacity;
+    const iree_host_size_t new_capacity = (iree_host_size_t)
+        iree_math_round_up_to_pow2_u64(iree_max((iree_host_size_t)fd + 1, 64));
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        allocator, new_capacity * sizeof(waiter->fd_links[0]),
+        (void**)&waiter->fd_links));
+    memset(waiter->fd_links + old_capacity, 0,
+           (new_capacity - old_capacity) * sizeof(waiter->fd_links[0]));
+    waiter->fd_capacity = new_capacity;
+  }
+
+  // Multiple operations may wait on the same file descriptor but epoll only
+  // allows it to be registered once.
+  if (!waiter->fd_links[fd]) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(waiter->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to register fd %d with epoll", fd);
+    }
+  }
+  link->next = waiter->fd_links[fd];
+  waiter->fd_links[fd] = link;
+  link->registered = true;
+  return iree_ok_status();
+}
+
+static void iree_loop_threaded_waiter_unregister(
+    iree_loop_threaded_waiter_t* waiter, iree_loop_threaded_wait_link_t* link) {
+  if (!link->registered) return;
+  iree_loop_threaded_wait_link_t** it = &waiter->fd_links[link->fd];
+  while (*it != link) it = &(*it)->next;
+  *it = link->next;
+  link->next = NULL;
+  link->registered = false;
+  if (!waiter->fd_links[link->fd]) {
+    // Fails if the user closed the handle while waiting; nothing to do.
+    epoll_ctl(waiter->epoll_fd, EPOLL_CTL_DEL, link->fd, NULL);
+  }
+}
+
+// Returns DEFERRED if unresolved, OK if resolved, and an error otherwise.
+// Wait sources that have resolved are unregistered so that they don't wake the
+// waiter again while waiting for the others.
+static iree_status_t iree_loop_threaded_waiter_query(
+    iree_loop_threaded_waiter_t* waiter, iree_loop_threaded_wait_op_t* op,
+    iree_time_t now_ns) {
+  if (op->command == IREE_LOOP_COMMAND_WAIT_UNTIL) {
+    return op->deadline_ns <= now_ns + IREE_LOOP_THREADED_DELAY_SLOP_NS
+               ? iree_ok_status()
+               : iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  bool any_resolved = false;
+  bool all_resolved = true;
+  for (iree_host_size_t i = 0; i < op->link_count; ++i) {
+    iree_loop_threaded_wait_link_t* link = &op->links[i];
+    if (!link->wait_source) {
+      any_resolved = true;
+      continue;
+    }
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    IREE_RETURN_IF_ERROR(
+        iree_wait_source_query(*link->wait_source, &wait_status_code));
+    if (wait_status_code == IREE_STATUS_OK) {
+      iree_loop_threaded_waiter_unregister(waiter, link);
+      link->wait_source = NULL;
+      any_resolved = true;
+    } else if (wait_status_code == IREE_STATUS_DEFERRED) {
+      all_resolved = false;
+    } else {
+      return iree_status_from_code(wait_status_code);
+    }
+  }
+  if (op->command == IREE_LOOP_COMMAND_WAIT_ANY ? any_resolved
+                                                : all_resolved) {
+    return iree_ok_status();
+  } else if (op->deadline_ns <= now_ns) {
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  return iree_status_from_code(IREE_STATUS_DEFERRED);
+}
+
+// Retires the wait |op| by scheduling its callback with |status| on the
+// workers. The op is freed.
+static void iree_loop_threaded_waiter_complete(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_wait_op_t* op,
+    iree_status_t status) {
+  iree_loop_threaded_waiter_t* waiter = &loop_threaded->waiter;
+  for (iree_host_size_t i = 0; i < op->link_count; ++i) {
+    iree_loop_threaded_waiter_unregister(waiter, &op->links[i]);
+  }
+  iree_loop_threaded_heap_erase(waiter, op);
+  if (op->prev) {
+    op->prev->next = op->next;
+  } else {
+    waiter->list_head = op->next;
+  }
+  if (op->next) op->next->prev = op->prev;
+
+  // The run ring slot was reserved when the wait was scheduled.
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  iree_loop_threaded_run_ring_push(&loop_threaded->run_ring,
+                                   (iree_loop_threaded_run_op_t){
+                                       .command = IREE_LOOP_COMMAND_CALL,
+                                       .scope = op->scope,
+                                       .callback = op->callback,
+                                       .status = status,
+                                   });
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  iree_notification_post(&loop_threaded->work_notification, 1);
+
+  iree_allocator_free(loop_threaded->allocator, op);
+}
+
+// Takes ownership of a newly scheduled wait |op| and either completes it
+// immediately or registers it to be woken.
+static void iree_loop_threaded_waiter_accept(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_wait_op_t* op,
+    iree_time_t now_ns) {
+  iree_loop_threaded_waiter_t* waiter = &loop_threaded->waiter;
+  op->prev = NULL;
+  op->next = waiter->list_head;
+  if (waiter->list_head) waiter->list_head->prev = op;
+  waiter->list_head = op;
+
+  iree_status_t status = iree_loop_threaded_waiter_query(waiter, op, now_ns);
+  if (iree_status_is_deferred(status)) {
+    status = iree_ok_status();
+    for (iree_host_size_t i = 0;
+         i < op->link_count && iree_status_is_ok(status); ++i) {
+      if (!op->links[i].wait_source) continue;
+      status = iree_loop_threaded_waiter_register(
+          waiter, loop_threaded->allocator, &op->links[i]);
+    }
+    if (iree_status_is_ok(status) &&
+        op->deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+      status = iree_loop_threaded_heap_insert(waiter, loop_threaded->allocator,
+                                              op);
+    }
+    if (iree_status_is_ok(status)) return;  // now waiting
+  }
+  iree_loop_threaded_waiter_complete(loop_threaded, op, status);
+}
+
+// Aborts all waits in failed scopes or all waits if the loop is exiting.
+static void iree_loop_threaded_waiter_abort(
+    iree_loop_threaded_t* loop_threaded) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_loop_threaded_waiter_t* waiter = &loop_threaded->waiter;
+
+  iree_loop_threaded_wait_op_t* abort_list = NULL;
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  for (iree_loop_threaded_wait_op_t* op = waiter->list_head; op;
+       op = op->next) {
+    if (op->scope->failed || loop_threaded->exiting) {
+      op->next_ready = abort_list;
+      abort_list = op;
+    }
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+  // Workers replace the status with IREE_STATUS_ABORTED when they see the
+  // failed scope.
+  while (abort_list) {
+    iree_loop_threaded_wait_op_t* op = abort_list;
+    abort_list = op->next_ready;
+    iree_loop_threaded_waiter_complete(
+        loop_threaded, op, iree_status_from_code(IREE_STATUS_ABORTED));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Returns the epoll timeout in milliseconds until the earliest deadline.
+static int iree_loop_threaded_waiter_timeout_ms(
+    iree_loop_threaded_waiter_t* waiter, iree_time_t now_ns) {
+  if (!waiter->heap_count) return -1;
+  const iree_time_t deadline_ns = waiter->heap[0]->deadline_ns;
+  if (deadline_ns <= now_ns) return 0;
+  // Round up so that we don't wake before the deadline and spin.
+  const iree_time_t timeout_ms = (deadline_ns - now_ns + 999999) / 1000000;
+  return timeout_ms > INT_MAX ? INT_MAX : (int)timeout_ms;
+}
+
+static void iree_loop_threaded_mark_ready(iree_loop_threaded_wait_op_t* op,
+                                          iree_loop_threaded_wait_op_t** list) {
+  if (op->is_ready) return;
+  op->is_ready = true;
+  op->next_ready = *list;
+  *list = op;
+}
+
+static int iree_loop_threaded_waiter_main(void* entry_arg) {
+  iree_loop_threaded_t* loop_threaded = (iree_loop_threaded_t*)entry_arg;
+  iree_loop_threaded_waiter_t* waiter = &loop_threaded->waiter;
+  struct epoll_event events[IREE_LOOP_THREADED_MAX_EPOLL_EVENTS];
+  for (;;) {
+    // Reset the wake counter before taking the incoming state so that any wake
+    // issued after this point interrupts the next system wait.
+    uint64_t wake_value = 0;
+    ssize_t rv = 0;
+    do {
+      rv = read(waiter->wake_fd, &wake_value, sizeof(wake_value));
+    } while (rv < 0 && errno == EINTR);
+
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+    iree_loop_threaded_wait_op_t* incoming_waits =
+        loop_threaded->incoming_waits;
+    loop_threaded->incoming_waits = NULL;
+    const bool abort_requested = loop_threaded->abort_requested;
+    loop_threaded->abort_requested = false;
+    const bool exiting = loop_threaded->exiting;
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+    // Incoming waits are pushed in LIFO order; reverse them so that callbacks
+    // for waits that resolve together are issued in the order scheduled.
+    iree_loop_threaded_wait_op_t* accept_list = NULL;
+    while (incoming_waits) {
+      iree_loop_threaded_wait_op_t* op = incoming_waits;
+      incoming_waits = op->next;
+      op->next = accept_list;
+      accept_list = op;
+    }
+    iree_time_t now_ns = iree_time_now();
+    while (accept_list) {
+      iree_loop_threaded_wait_op_t* op = accept_list;
+      accept_list = op->next;
+      iree_loop_threaded_waiter_accept(loop_threaded, op, now_ns);
+    }
+
+    if (abort_requested || exiting) {
+      iree_loop_threaded_waiter_abort(loop_threaded);
+    }
+    if (exiting) break;
+
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_loop_threaded_waiter_wait");
+    // Interrupted waits are treated as spurious wakes.
+    int event_count =
+        epoll_wait(waiter->epoll_fd, events, IREE_ARRAYSIZE(events),
+                   iree_loop_threaded_waiter_timeout_ms(waiter, now_ns));
+    IREE_TRACE_ZONE_END(z_wait);
+    if (event_count < 0) event_count = 0;
+
+    // Gather all ops that may have resolved or timed out.
+    now_ns = iree_time_now();
+    iree_loop_threaded_wait_op_t* ready_list = NULL;
+    for (int i = 0; i < event_count; ++i) {
+      const int fd = events[i].data.fd;
+      if (fd == waiter->wake_fd) continue;
+      for (iree_loop_threaded_wait_link_t* link = waiter->fd_links[fd]; link;
+           link = link->next) {
+        iree_loop_threaded_mark_ready(link->op, &ready_list);
+      }
+    }
+    const iree_time_t expire_ns = now_ns + IREE_LOOP_THREADED_DELAY_SLOP_NS;
+    while (waiter->heap_count && waiter->heap[0]->deadline_ns <= expire_ns) {
+      iree_loop_threaded_wait_op_t* op = waiter->heap[0];
+      iree_loop_threaded_heap_erase(waiter, op);
+      iree_loop_threaded_mark_ready(op, &ready_list);
+    }
+
+    while (ready_list) {
+      iree_loop_threaded_wait_op_t* op = ready_list;
+      ready_list = op->next_ready;
+      op->is_ready = false;
+      iree_status_t status =
+          iree_loop_threaded_waiter_query(waiter, op, now_ns);
+      if (iree_status_is_deferred(status)) {
+        // Still waiting; ops popped from the heap near their deadline go back.
+        status = iree_ok_status();
+        if (op->heap_index == IREE_LOOP_THREADED_HEAP_INDEX_NONE &&
+            op->deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+          status = iree_loop_threaded_heap_insert(
+              waiter, loop_threaded->allocator, op);
+        }
+        if (iree_status_is_ok(status)) continue;
+      }
+      iree_loop_threaded_waiter_complete(loop_threaded, op, status);
+    }
+  }
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Worker threads
+//===----------------------------------------------------------------------===//
+
+static void iree_loop_threaded_run_call(iree_loop_threaded_t* loop_threaded,
+                                        iree_loop_threaded_run_op_t op,
+                                        bool aborted) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (aborted) {
+    // To prevent enqueuing more work while aborting we pass in a NULL loop.
+    // We can't do anything with the errors so we ignore them.
+    iree_status_ignore(op.status);
+    iree_status_ignore(op.callback.fn(op.callback.user_data, iree_loop_null(),
+                                      iree_make_status(IREE_STATUS_ABORTED)));
+  } else {
+    iree_status_t status = op.callback.fn(
+        op.callback.user_data, iree_loop_threaded_scope(op.scope), op.status);
+    if (!iree_status_is_ok(status)) {
+      iree_loop_threaded_emit_error(loop_threaded, op.scope, status);
+    }
+  }
+  iree_loop_threaded_retire(loop_threaded, op.scope, 1);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Runs workgroups of a dispatch until none remain. The last slice to retire
+// issues the completion callback with the first workgroup error, if any.
+static void iree_loop_threaded_run_dispatch_slice(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_run_op_t op,
+    bool aborted) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_loop_threaded_dispatch_t* dispatch = op.dispatch;
+  const iree_loop_dispatch_params_t* params = &dispatch->params;
+  const iree_loop_t loop = iree_loop_threaded_scope(op.scope);
+
+  const uint32_t workgroup_count_x = params->workgroup_count_xyz[0];
+  const uint32_t workgroup_count_y = params->workgroup_count_xyz[1];
+  while (!aborted && !iree_atomic_load(&dispatch->status,
+                                       iree_memory_order_acquire)) {
+    const int64_t i = iree_atomic_fetch_add(&dispatch->next_workgroup, 1,
+                                            iree_memory_order_relaxed);
+    if (i >= dispatch->workgroup_count) break;
+    const uint32_t x = (uint32_t)(i % workgroup_count_x);
+    const uint32_t y = (uint32_t)((i / workgroup_count_x) % workgroup_count_y);
+    const uint32_t z =
+        (uint32_t)(i / ((int64_t)workgroup_count_x * workgroup_count_y));
+    iree_status_t workgroup_status =
+        params->workgroup_fn(params->callback.user_data, loop, x, y, z);
+    if (!iree_status_is_ok(workgroup_status)) {
+      intptr_t expected = 0;
+      if (!iree_atomic_compare_exchange_strong(
+              &dispatch->status, &expected, (intptr_t)workgroup_status,
+              iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+        iree_status_ignore(workgroup_status);
+      }
+      break;
+    }
+  }
+
+  if (iree_atomic_fetch_sub(&dispatch->remaining_slices, 1,
+                            iree_memory_order_acq_rel) == 1) {
+    // Fire the completion callback with either success or the first error hit
+    // by a workgroup.
+    iree_status_t workgroup_status = (iree_status_t)iree_atomic_load(
+        &dispatch->status, iree_memory_order_acquire);
+    iree_loop_threaded_run_call(loop_threaded,
+                                (iree_loop_threaded_run_op_t){
+                                    .command = IREE_LOOP_COMMAND_CALL,
+                                    .scope = op.scope,
+                                    .callback = params->callback,
+                                    .status = workgroup_status,
+                                },
+                                aborted);
+    iree_allocator_free(loop_threaded->allocator, dispatch);
+  } else {
+    iree_loop_threaded_retire(loop_threaded, op.scope, 1);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Dequeues the next runnable op, blocking until one is available.
+// Returns false if the worker should exit.
+static bool iree_loop_threaded_dequeue(iree_loop_threaded_t* loop_threaded,
+                                       iree_loop_threaded_run_op_t* out_op,
+                                       bool* out_aborted) {
+  for (;;) {
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+    if (iree_loop_threaded_run_ring_pop(&loop_threaded->run_ring, out_op)) {
+      *out_aborted = out_op->scope->failed || loop_threaded->exiting;
+      iree_slim_mutex_unlock(&loop_threaded->mutex);
+      return true;
+    }
+    const bool workers_exiting = loop_threaded->workers_exiting;
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+    if (workers_exiting) return false;
+    iree_notification_await(&loop_threaded->work_notification,
+                            iree_loop_threaded_has_work, loop_threaded,
+                            iree_infinite_timeout());
+  }
+}
+
+static int iree_loop_threaded_worker_main(void* entry_arg) {
+  iree_loop_threaded_t* loop_threaded = (iree_loop_threaded_t*)entry_arg;
+  iree_loop_threaded_run_op_t op;
+  bool aborted = false;
+  while (iree_loop_threaded_dequeue(loop_threaded, &op, &aborted)) {
+    switch (op.command) {
+      case IREE_LOOP_COMMAND_CALL:
+        iree_loop_threaded_run_call(loop_threaded, op, aborted);
+        break;
+      case IREE_LOOP_COMMAND_DISPATCH:
+        iree_loop_threaded_run_dispatch_slice(loop_threaded, op, aborted);
+        break;
+      default:
+        IREE_ASSERT_UNREACHABLE("unhandled run op command");
+        break;
+    }
+  }
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Scheduling
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_loop_threaded_enqueue_call(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_scope_t* scope,
+    iree_loop_callback_t callback, iree_status_t op_status) {
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  iree_status_t status =
+      iree_loop_threaded_reserve_locked(loop_threaded, scope, 1);
+  if (iree_status_is_ok(status)) {
+    iree_loop_threaded_run_ring_push(&loop_threaded->run_ring,
+                                     (iree_loop_threaded_run_op_t){
+                                         .command = IREE_LOOP_COMMAND_CALL,
+                                         .scope = scope,
+                                         .callback = callback,
+                                         .status = op_status,
+                                     });
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  if (iree_status_is_ok(status)) {
+    iree_notification_post(&loop_threaded->work_notification, 1);
+  }
+  return status;
+}
+
+static iree_status_t iree_loop_threaded_enqueue_dispatch(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_scope_t* scope,
+    const iree_loop_dispatch_params_t* params) {
+  const uint64_t workgroup_count_xy = (uint64_t)params->workgroup_count_xyz[0] *
+                                      params->workgroup_count_xyz[1];
+  const uint64_t workgroup_count_z = params->workgroup_count_xyz[2];
+  if (workgroup_count_xy == 0 || workgroup_count_z == 0) {
+    // Empty grid; only the completion callback is issued.
+    return iree_loop_threaded_enqueue_call(loop_threaded, scope,
+                                           params->callback, iree_ok_status());
+  } else if (workgroup_count_xy > INT64_MAX / workgroup_count_z) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "dispatch grid %ux%ux%u exceeds the maximum",
+                            params->workgroup_count_xyz[0],
+                            params->workgroup_count_xyz[1],
+                            params->workgroup_count_xyz[2]);
+  }
+  const int64_t workgroup_count =
+      (int64_t)(workgroup_count_xy * workgroup_count_z);
+  const iree_host_size_t slice_count = (iree_host_size_t)iree_min(
+      (int64_t)loop_threaded->worker_count, workgroup_count);
+
+  iree_loop_threaded_dispatch_t* dispatch = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      loop_threaded->allocator, sizeof(*dispatch), (void**)&dispatch));
+  dispatch->params = *params;
+  dispatch->workgroup_count = workgroup_count;
+  iree_atomic_store(&dispatch->next_workgroup, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&dispatch->remaining_slices, (int32_t)slice_count,
+                    iree_memory_order_relaxed);
+  iree_atomic_store(&dispatch->status, 0, iree_memory_order_relaxed);
+
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  iree_status_t status =
+      iree_loop_threaded_reserve_locked(loop_threaded, scope, slice_count);
+  if (iree_status_is_ok(status)) {
+    for (iree_host_size_t i = 0; i < slice_count; ++i) {
+      iree_loop_threaded_run_ring_push(
+          &loop_threaded->run_ring,
+          (iree_loop_threaded_run_op_t){
+              .command = IREE_LOOP_COMMAND_DISPATCH,
+              .scope = scope,
+              .dispatch = dispatch,
+              .status = iree_ok_status(),
+          });
+    }
+  }
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+
+  if (iree_status_is_ok(status)) {
+    iree_notification_post(&loop_threaded->work_notification,
+                           (int32_t)slice_count);
+  } else {
+    iree_allocator_free(loop_threaded->allocator, dispatch);
+  }
+  return status;
+}
+
+static iree_status_t iree_loop_threaded_enqueue_wait(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_scope_t* scope,
+    iree_loop_command_t command, const void* params) {
+  iree_loop_callback_t callback;
+  iree_time_t deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  iree_host_size_t wait_source_count = 0;
+  iree_wait_source_t* wait_sources = NULL;
+  switch (command) {
+    case IREE_LOOP_COMMAND_WAIT_UNTIL: {
+      const iree_loop_wait_until_params_t* wait_until =
+          (const iree_loop_wait_until_params_t*)params;
+      callback = wait_until->callback;
+      deadline_ns = wait_until->deadline_ns;
+      break;
+    }
+    case IREE_LOOP_COMMAND_WAIT_ONE: {
+      const iree_loop_wait_one_params_t* wait_one =
+          (const iree_loop_wait_one_params_t*)params;
+      callback = wait_one->callback;
+      deadline_ns = wait_one->deadline_ns;
+      wait_source_count = 1;
+      break;
+    }
+    default: {
+      const iree_loop_wait_multi_params_t* wait_multi =
+          (const iree_loop_wait_multi_params_t*)params;
+      callback = wait_multi->callback;
+      deadline_ns = wait_multi->deadline_ns;
+      wait_source_count = wait_multi->count;
+      wait_sources = wait_multi->wait_sources;
+      break;
+    }
+  }
+
+  iree_loop_threaded_wait_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      loop_threaded->allocator,
+      sizeof(*op) + wait_source_count * sizeof(op->links[0]), (void**)&op));
+  op->command = command;
+  op->scope = scope;
+  op->callback = callback;
+  op->deadline_ns = deadline_ns;
+  op->heap_index = IREE_LOOP_THREADED_HEAP_INDEX_NONE;
+  if (command == IREE_LOOP_COMMAND_WAIT_ONE) {
+    op->wait_one_source =
+        ((const iree_loop_wait_one_params_t*)params)->wait_source;
+    wait_sources = &op->wait_one_source;
+  }
+  op->link_count = wait_source_count;
+
+  // Wait sources are resolved on the calling thread so that unsupported ones
+  // are reported to the caller.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < wait_source_count && iree_status_is_ok(status); ++i) {
+    status = iree_loop_threaded_wait_link_initialize(op, &wait_sources[i],
+                                                     &op->links[i]);
+  }
+
+  bool scope_failed = false;
+  bool wake_waiter = false;
+  if (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&loop_threaded->mutex);
+    status = iree_loop_threaded_reserve_locked(loop_threaded, scope, 1);
+    if (iree_status_is_ok(status)) {
+      scope_failed = scope->failed;
+      if (scope_failed) {
+        // The waiter may have already aborted the scope; abort directly.
+        iree_loop_threaded_run_ring_push(&loop_threaded->run_ring,
+                                         (iree_loop_threaded_run_op_t){
+                                             .command = IREE_LOOP_COMMAND_CALL,
+                                             .scope = scope,
+                                             .callback = callback,
+                                             .status = iree_ok_status(),
+                                         });
+      } else {
+        wake_waiter = loop_threaded->incoming_waits == NULL;
+        op->next = loop_threaded->incoming_waits;
+        loop_threaded->incoming_waits = op;
+      }
+    }
+    iree_slim_mutex_unlock(&loop_threaded->mutex);
+  }
+
+  if (!iree_status_is_ok(status) || scope_failed) {
+    iree_allocator_free(loop_threaded->allocator, op);
+  }
+  if (scope_failed) {
+    iree_notification_post(&loop_threaded->work_notification, 1);
+  } else if (wake_waiter) {
+    iree_loop_threaded_wake_waiter(loop_threaded);
+  }
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_scope_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_loop_threaded_scope_initialize(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_error_fn_t error_fn,
+    void* error_user_data, iree_loop_threaded_scope_t* out_scope) {
+  memset(out_scope, 0, sizeof(*out_scope));
+  out_scope->loop_threaded = loop_threaded;
+  out_scope->pending_count = 0;
+  out_scope->failed = false;
+  out_scope->error_fn = error_fn;
+  out_scope->error_user_data = error_user_data;
+}
+
+IREE_API_EXPORT void iree_loop_threaded_scope_deinitialize(
+    iree_loop_threaded_scope_t* scope) {
+  IREE_ASSERT_ARGUMENT(scope);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_loop_threaded_t* loop_threaded = scope->loop_threaded;
+  if (loop_threaded && !iree_loop_threaded_scope_is_idle(scope)) {
+    iree_loop_threaded_abort_scope(loop_threaded, scope,
+                                   /*out_first_failure=*/NULL);
+    iree_notification_await(&loop_threaded->idle_notification,
+                            iree_loop_threaded_scope_is_idle, scope,
+                            iree_infinite_timeout());
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_allocate(
+    iree_loop_threaded_options_t options, iree_allocator_t allocator,
+    iree_loop_threaded_t** out_loop_threaded) {
+  IREE_ASSERT_ARGUMENT(out_loop_threaded);
+  *out_loop_threaded = NULL;
+  if (!options.worker_count) {
+    options.worker_count = IREE_LOOP_THREADED_DEFAULT_WORKER_COUNT;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)options.worker_count);
+
+  iree_loop_threaded_t* loop_threaded = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(
+              allocator,
+              sizeof(*loop_threaded) +
+                  options.worker_count * sizeof(loop_threaded->workers[0]),
+              (void**)&loop_threaded));
+  loop_threaded->allocator = allocator;
+  iree_slim_mutex_initialize(&loop_threaded->mutex);
+  iree_notification_initialize(&loop_threaded->work_notification);
+  iree_notification_initialize(&loop_threaded->idle_notification);
+  loop_threaded->worker_count = options.worker_count;
+
+  iree_status_t status = iree_ok_status();
+  iree_loop_threaded_waiter_t* waiter = &loop_threaded->waiter;
+  waiter->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  waiter->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (waiter->epoll_fd < 0 || waiter->wake_fd < 0) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to create the loop epoll instance");
+  }
+  if (iree_status_is_ok(status)) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = waiter->wake_fd;
+    if (epoll_ctl(waiter->epoll_fd, EPOLL_CTL_ADD, waiter->wake_fd, &event) <
+        0) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to register the loop wake fd");
+    }
+  }
+
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  if (iree_status_is_ok(status)) {
+    params.name = IREE_SV("iree-loop-waiter");
+    status = iree_thread_create(iree_loop_threaded_waiter_main, loop_threaded,
+                                params, allocator, &waiter->thread);
+  }
+  params.name = IREE_SV("iree-loop-worker");
+  for (iree_host_size_t i = 0;
+       i < options.worker_count && iree_status_is_ok(status); ++i) {
+    status = iree_thread_create(iree_loop_threaded_worker_main, loop_threaded,
+                                params, allocator, &loop_threaded->workers[i]);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_loop_threaded = loop_threaded;
+  } else {
+    iree_loop_threaded_free(loop_threaded);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_loop_threaded_free(
+    iree_loop_threaded_t* loop_threaded) {
+  IREE_ASSERT_ARGUMENT(loop_threaded);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t allocator = loop_threaded->allocator;
+  iree_loop_threaded_waiter_t* waiter = &loop_threaded->waiter;
+
+  // Reject new work and have the waiter abort all pending waits. Their
+  // callbacks are issued by the workers with IREE_STATUS_ABORTED along with
+  // any queued calls and dispatches. Releasing a thread joins it.
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  loop_threaded->exiting = true;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  if (waiter->thread) {
+    iree_loop_threaded_wake_waiter(loop_threaded);
+    iree_thread_release(waiter->thread);
+    waiter->thread = NULL;
+  }
+  iree_slim_mutex_lock(&loop_threaded->mutex);
+  loop_threaded->workers_exiting = true;
+  iree_slim_mutex_unlock(&loop_threaded->mutex);
+  iree_notification_post(&loop_threaded->work_notification, IREE_ALL_WAITERS);
+  for (iree_host_size_t i = 0; i < loop_threaded->worker_count; ++i) {
+    iree_thread_release(loop_threaded->workers[i]);
+  }
+
+  if (waiter->wake_fd >= 0) close(waiter->wake_fd);
+  if (waiter->epoll_fd >= 0) close(waiter->epoll_fd);
+  iree_allocator_free(allocator, waiter->fd_links);
+  iree_allocator_free(allocator, waiter->heap);
+  iree_loop_threaded_run_ring_deinitialize(&loop_threaded->run_ring,
+                                           allocator);
+  iree_notification_deinitialize(&loop_threaded->idle_notification);
+  iree_notification_deinitialize(&loop_threaded->work_notification);
+  iree_slim_mutex_deinitialize(&loop_threaded->mutex);
+  iree_allocator_free(allocator, loop_threaded);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_wait_idle(
+    iree_loop_threaded_t* loop_threaded, iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(loop_threaded);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  if (!iree_notification_await(&loop_threaded->idle_notification,
+                               iree_loop_threaded_is_idle, loop_threaded,
+                               timeout)) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Blocks the caller until all work in |scope| has completed.
+static iree_status_t iree_loop_threaded_drain_scope(
+    iree_loop_threaded_scope_t* scope, iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  if (!iree_notification_await(&scope->loop_threaded->idle_notification,
+                               iree_loop_threaded_scope_is_idle, scope,
+                               iree_make_deadline(deadline_ns))) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Control function for the threaded loop.
+// |self| must be an iree_loop_threaded_scope_t.
+IREE_API_EXPORT iree_status_t iree_loop_threaded_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(self);
+  iree_loop_threaded_scope_t* scope = (iree_loop_threaded_scope_t*)self;
+  iree_loop_threaded_t* loop_threaded = scope->loop_threaded;
+
+  // NOTE: we return immediately to make this all (hopefully) tail calls.
+  switch (command) {
+    case IREE_LOOP_COMMAND_CALL:
+      return iree_loop_threaded_enqueue_call(
+          loop_threaded, scope,
+          ((const iree_loop_call_params_t*)params)->callback,
+          iree_ok_status());
+    case IREE_LOOP_COMMAND_DISPATCH:
+      return iree_loop_threaded_enqueue_dispatch(
+          loop_threaded, scope, (const iree_loop_dispatch_params_t*)params);
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+      return iree_loop_threaded_enqueue_wait(loop_threaded, scope, command,
+                                             params);
+    case IREE_LOOP_COMMAND_DRAIN:
+      return iree_loop_threaded_drain_scope(
+          scope, ((const iree_loop_drain_params_t*)params)->deadline_ns);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented loop command");
+  }
+}
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_allocate(
+    iree_loop_threaded_options_t options, iree_allocator_t allocator,
+    iree_loop_threaded_t** out_loop_threaded) {
+  IREE_ASSERT_ARGUMENT(out_loop_threaded);
+  *out_loop_threaded = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "threaded loops require epoll and are not available "
+                          "on this platform");
+}
+
+IREE_API_EXPORT void iree_loop_threaded_free(
+    iree_loop_threaded_t* loop_threaded) {}
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_wait_idle(
+    iree_loop_threaded_t* loop_threaded, iree_timeout_t timeout) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "threaded loops are not available on this platform");
+}
+
+IREE_API_EXPORT void iree_loop_threaded_scope_initialize(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_error_fn_t error_fn,
+    void* error_user_data, iree_loop_threaded_scope_t* out_scope) {
+  memset(out_scope, 0, sizeof(*out_scope));
+  out_scope->loop_threaded = loop_threaded;
+  out_scope->error_fn = error_fn;
+  out_scope->error_user_data = error_user_data;
+}
+
+IREE_API_EXPORT void iree_loop_threaded_scope_deinitialize(
+    iree_loop_threaded_scope_t* scope) {}
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "threaded loops are not available on this platform");
+}
+
+#endif  // IREE_LOOP_THREADED_SUPPORTED
@@ -0,0 +1,136 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_LOOP_THREADED_H_
+#define IREE_BASE_LOOP_THREADED_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Nonzero if iree_loop_threaded_t is available on the target platform.
+// Waits are multiplexed with epoll and only Linux/Android are supported today;
+// on other platforms iree_loop_threaded_allocate returns
+// IREE_STATUS_UNAVAILABLE.
+#if !defined(IREE_LOOP_THREADED_SUPPORTED)
+#if (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)) && \
+    !IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#define IREE_LOOP_THREADED_SUPPORTED 1
+#else
+#define IREE_LOOP_THREADED_SUPPORTED 0
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+#endif  // !IREE_LOOP_THREADED_SUPPORTED
+
+// Default number of worker threads used when none is specified.
+#define IREE_LOOP_THREADED_DEFAULT_WORKER_COUNT 4
+
+//===----------------------------------------------------------------------===//
+// iree_loop_threaded_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_loop_threaded_options_t {
+  // Number of worker threads used to run calls and dispatch workgroups.
+  // 0 selects IREE_LOOP_THREADED_DEFAULT_WORKER_COUNT.
+  iree_host_size_t worker_count;
+} iree_loop_threaded_options_t;
+
+// A thread-safe loop that runs operations on a pool of worker threads.
+//
+// Calls are run by whichever worker is available and dispatches are split
+// across all workers. All wait operations are multiplexed onto a single epoll
+// instance serviced by a dedicated waiter thread so that many thousands of
+// outstanding waits cost only their registration. Operations are started in
+// FIFO order but unlike most loops may run concurrently with one another and
+// callers must not depend on one operation retiring before the next begins.
+//
+// Operations may be scheduled from any thread, including from within
+// callbacks running on the loop and from threads not associated with it.
+// iree_loop_drain blocks the caller until the scope is idle and must not be
+// called from within a callback of the scope being drained.
+//
+// Thread-safe.
+typedef struct iree_loop_threaded_t iree_loop_threaded_t;
+
+// Allocates a threaded loop using |allocator| stored into |out_loop_threaded|.
+// All worker threads are started before returning.
+IREE_API_EXPORT iree_status_t iree_loop_threaded_allocate(
+    iree_loop_threaded_options_t options, iree_allocator_t allocator,
+    iree_loop_threaded_t** out_loop_threaded);
+
+// Frees a threaded |loop_threaded|, aborting all pending operations and joining
+// all threads. Callbacks of aborted operations are issued before returning.
+IREE_API_EXPORT void iree_loop_threaded_free(
+    iree_loop_threaded_t* loop_threaded);
+
+// Waits until the loop is idle (all operations in all scopes have retired).
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |timeout| is reached before the
+// loop is idle.
+IREE_API_EXPORT iree_status_t iree_loop_threaded_wait_idle(
+    iree_loop_threaded_t* loop_threaded, iree_timeout_t timeout);
+
+// Handles scope errors returned from loop callback operations.
+// Ownership of |status| is passed to the handler and must be freed.
+// May be called from any thread owned by the loop.
+typedef void(IREE_API_PTR* iree_loop_threaded_error_fn_t)(void* user_data,
+                                                          iree_status_t status);
+
+// A scope of execution within a loop.
+// Each scope has a dedicated error handler that is notified of the first error
+// that propagates from a loop operation scheduled against the scope. Once an
+// error arises all other operations in the same scope, including any scheduled
+// afterward, are aborted. Scopes must be deinitialized and initialized again
+// to be reused after a failure.
+//
+// All fields are guarded by the loop and must not be accessed directly.
+typedef struct iree_loop_threaded_scope_t {
+  // Target loop for execution.
+  iree_loop_threaded_t* loop_threaded;
+
+  // Total number of pending operations in the scope, including those that are
+  // currently running. When 0 the scope is considered idle.
+  int32_t pending_count;
+
+  // True once an operation in the scope has failed.
+  bool failed;
+
+  // Optional function used to report errors that occur during execution.
+  iree_loop_threaded_error_fn_t error_fn;
+  void* error_user_data;
+} iree_loop_threaded_scope_t;
+
+// Initializes a loop scope that runs operations against |loop_threaded|.
+IREE_API_EXPORT void iree_loop_threaded_scope_initialize(
+    iree_loop_threaded_t* loop_threaded, iree_loop_threaded_error_fn_t error_fn,
+    void* error_user_data, iree_loop_threaded_scope_t* out_scope);
+
+// Deinitializes a loop |scope|, aborting any pending operations and waiting
+// for those currently running to retire.
+IREE_API_EXPORT void iree_loop_threaded_scope_deinitialize(
+    iree_loop_threaded_scope_t* scope);
+
+IREE_API_EXPORT iree_status_t iree_loop_threaded_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr);
+
+// Returns a loop that schedules operations against |scope|.
+// The scope must remain valid until all operations scheduled against it have
+// completed.
+static inline iree_loop_t iree_loop_threaded_scope(
+    iree_loop_threaded_scope_t* scope) {
+  iree_loop_t loop = {
+      scope,
+      iree_loop_threaded_ctl,
+  };
+  return loop;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_LOOP_THREADED_H_
@@ -0,0 +1,149 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/loop_threaded.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+#if IREE_LOOP_THREADED_SUPPORTED
+
+// Contains the test definitions applied to all loop implementations:
+#include "iree/base/loop_test.h"
+
+void AllocateLoop(iree_status_t* out_status, iree_allocator_t allocator,
+                  iree_loop_t* out_loop) {
+  iree_loop_threaded_options_t options = {0};
+  options.worker_count = 4;
+
+  iree_loop_threaded_t* loop_threaded = NULL;
+  IREE_CHECK_OK(
+      iree_loop_threaded_allocate(options, allocator, &loop_threaded));
+
+  iree_loop_threaded_scope_t* scope = NULL;
+  IREE_CHECK_OK(
+      iree_allocator_malloc(allocator, sizeof(*scope), (void**)&scope));
+  iree_loop_threaded_scope_initialize(
+      loop_threaded,
+      +[](void* user_data, iree_status_t status) {
+        iree_status_t* status_ptr = (iree_status_t*)user_data;
+        if (iree_status_is_ok(*status_ptr)) {
+          *status_ptr = status;
+        } else {
+          iree_status_ignore(status);
+        }
+      },
+      out_status, scope);
+  *out_loop = iree_loop_threaded_scope(scope);
+}
+
+void FreeLoop(iree_allocator_t allocator, iree_loop_t loop) {
+  iree_loop_threaded_scope_t* scope = (iree_loop_threaded_scope_t*)loop.self;
+  iree_loop_threaded_t* loop_threaded = scope->loop_threaded;
+
+  iree_loop_threaded_scope_deinitialize(scope);
+  iree_allocator_free(allocator, scope);
+
+  iree_loop_threaded_free(loop_threaded);
+}
+
+namespace iree {
+namespace testing {
+
+// Tests scheduling calls from many threads not owned by the loop.
+TEST_F(LoopTest, CrossThreadCalls) {
+  static constexpr int kThreadCount = 8;
+  static constexpr int kCallsPerThread = 1000;
+  std::atomic<int> call_count = {0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kCallsPerThread; ++j) {
+        IREE_EXPECT_OK(iree_loop_call(
+            loop, IREE_LOOP_PRIORITY_DEFAULT,
+            +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+              IREE_EXPECT_OK(status);
+              ++*reinterpret_cast<std::atomic<int>*>(user_data_ptr);
+              return iree_ok_status();
+            },
+            &call_count));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(call_count, kThreadCount * kCallsPerThread);
+}
+
+// Tests many concurrent waits including several on the same event.
+TEST_F(LoopTest, ManyWaits) {
+  static constexpr int kEventCount = 64;
+  static constexpr int kWaitsPerEvent = 4;
+  std::vector<iree_event_t> events(kEventCount);
+  for (auto& event : events) {
+    IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  }
+
+  std::atomic<int> wait_count = {0};
+  for (auto& event : events) {
+    for (int i = 0; i < kWaitsPerEvent; ++i) {
+      IREE_ASSERT_OK(iree_loop_wait_one(
+          loop, iree_event_await(&event), iree_make_timeout_ms(10000),
+          +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+            IREE_EXPECT_OK(status);
+            ++*reinterpret_cast<std::atomic<int>*>(user_data_ptr);
+            return iree_ok_status();
+          },
+          &wait_count));
+    }
+  }
+
+  std::thread thread([&]() {
+    for (auto& event : events) iree_event_set(&event);
+  });
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  thread.join();
+
+  IREE_ASSERT_OK(loop_status);
+  EXPECT_EQ(wait_count, kEventCount * kWaitsPerEvent);
+  for (auto& event : events) iree_event_deinitialize(&event);
+}
+
+// Tests that work scheduled after a scope has failed is aborted.
+TEST_F(LoopTest, FailedScopeAbortsNewWork) {
+  IREE_ASSERT_OK(iree_loop_call(
+      loop, IREE_LOOP_PRIORITY_DEFAULT,
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        return iree_status_from_code(IREE_STATUS_DATA_LOSS);
+      },
+      NULL));
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, loop_status);
+
+  bool did_call_callback = false;
+  IREE_ASSERT_OK(iree_loop_call(
+      loop, IREE_LOOP_PRIORITY_DEFAULT,
+      +[](void* user_data_ptr, iree_loop_t loop, iree_status_t status) {
+        IREE_EXPECT_STATUS_IS(IREE_STATUS_ABORTED, status);
+        iree_status_ignore(status);
+        *reinterpret_cast<bool*>(user_data_ptr) = true;
+        return iree_ok_status();
+      },
+      &did_call_callback));
+  IREE_ASSERT_OK(iree_loop_drain(loop, iree_infinite_timeout()));
+  EXPECT_TRUE(did_call_callback);
+}
+
+}  // namespace testing
+}  // namespace iree
+
+#endif  // IREE_LOOP_THREADED_SUPPORTED
@@ -64,6 +64,74 @@ TEST_F(CommandBufferTest, SubmitEmpty) {
   iree_hal_command_buffer_release(command_buffer);
 }
 
+// Submits the same reusable command buffer several times back-to-back with no
+// semaphores ordering the submissions. Each submission binds a different target
+// buffer and may overlap with the execution of the others.
+TEST_F(CommandBufferTest, SubmitReusableOverlapping) {
+  const int kSubmissionCount = 8;
+  const iree_device_size_t kBufferSize = 1024 * 1024;
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_DEFAULT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/1, &command_buffer));
+  uint8_t pattern = 0x5A;
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer,
+      iree_hal_make_indirect_buffer_ref(/*buffer_slot=*/0, /*offset=*/0,
+                                        kBufferSize),
+      &pattern, sizeof(pattern), IREE_HAL_FILL_FLAG_NONE));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  iree_hal_buffer_t* device_buffers[kSubmissionCount] = {NULL};
+  iree_hal_semaphore_t* semaphores[kSubmissionCount] = {NULL};
+  uint64_t payload_values[kSubmissionCount];
+  for (int i = 0; i < kSubmissionCount; ++i) {
+    CreateZeroedDeviceBuffer(kBufferSize, &device_buffers[i]);
+    semaphores[i] = CreateSemaphore();
+    payload_values[i] = 1ull;
+    const iree_hal_buffer_binding_t bindings[] = {
+        {device_buffers[i], 0, IREE_HAL_WHOLE_BUFFER},
+    };
+    iree_hal_semaphore_list_t signal_semaphores = {
+        /*count=*/1,
+        /*semaphores=*/&semaphores[i],
+        /*payload_values=*/&payload_values[i],
+    };
+    IREE_ASSERT_OK(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphores, command_buffer,
+        iree_hal_buffer_binding_table_t{IREE_ARRAYSIZE(bindings), bindings},
+        IREE_HAL_EXECUTE_FLAG_NONE));
+  }
+  iree_hal_semaphore_list_t wait_semaphores = {
+      /*count=*/kSubmissionCount,
+      /*semaphores=*/semaphores,
+      /*payload_values=*/payload_values,
+  };
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait(wait_semaphores,
+                                              iree_infinite_timeout(),
+                                              IREE_HAL_WAIT_FLAG_DEFAULT));
+
+  std::vector<uint8_t> reference_buffer(kBufferSize, pattern);
+  for (int i = 0; i < kSubmissionCount; ++i) {
+    std::vector<uint8_t> actual_data(kBufferSize);
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, device_buffers[i], /*source_offset=*/0,
+        /*target_buffer=*/actual_data.data(), /*data_length=*/kBufferSize,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+  }
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  for (int i = 0; i < kSubmissionCount; ++i) {
+    iree_hal_semaphore_release(semaphores[i]);
+    iree_hal_buffer_release(device_buffers[i]);
+  }
+}
+
 }  // namespace iree::hal::cts
 
 #endif  // IREE_HAL_CTS_COMMAND_BUFFER_TEST_H_
@@ -0,0 +1,154 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+#define IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree::hal::cts {
+
+using ::testing::ContainerEq;
+
+class QueueAllocaTest : public CTSTestBase<> {
+ protected:
+  static constexpr iree_device_size_t kAllocationSize = 4096;
+
+  static iree_hal_buffer_params_t DefaultParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                   IREE_HAL_BUFFER_USAGE_MAPPING;
+    return params;
+  }
+
+  // Allocates a buffer ordered after |semaphore| reaches |wait_value| and
+  // signals |semaphore| to |signal_value| once it is available.
+  iree_hal_buffer_t* QueueAlloca(iree_hal_semaphore_t* semaphore,
+                                 uint64_t wait_value, uint64_t signal_value) {
+    iree_hal_semaphore_list_t wait_list = {1, &semaphore, &wait_value};
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_device_queue_alloca(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list, signal_list,
+        IREE_HAL_ALLOCATOR_POOL_DEFAULT, DefaultParams(), kAllocationSize,
+        IREE_HAL_ALLOCA_FLAG_NONE, &buffer));
+    return buffer;
+  }
+
+  // Deallocates |buffer| once |semaphore| reaches |wait_value| and signals
+  // |semaphore| to |signal_value| once it has been deallocated.
+  void QueueDealloca(iree_hal_semaphore_t* semaphore, uint64_t wait_value,
+                     uint64_t signal_value, iree_hal_buffer_t* buffer) {
+    iree_hal_semaphore_list_t wait_list = {1, &semaphore, &wait_value};
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+    IREE_CHECK_OK(iree_hal_device_queue_dealloca(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list, signal_list, buffer,
+        IREE_HAL_DEALLOCA_FLAG_NONE));
+  }
+
+  // Fills |buffer| with |pattern| once |semaphore| reaches |wait_value| and
+  // signals |semaphore| to |signal_value| once the fill has completed.
+  void QueueFill(iree_hal_semaphore_t* semaphore, uint64_t wait_value,
+                 uint64_t signal_value, iree_hal_buffer_t* buffer,
+                 uint8_t pattern) {
+    iree_hal_semaphore_list_t wait_list = {1, &semaphore, &wait_value};
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+    IREE_CHECK_OK(iree_hal_device_queue_fill(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list, signal_list, buffer,
+        0, kAllocationSize, &pattern, sizeof(pattern),
+        IREE_HAL_FILL_FLAG_NONE));
+  }
+
+  void Write(iree_hal_buffer_t* buffer, uint8_t value) {
+    std::vector<uint8_t> data(kAllocationSize, value);
+    IREE_CHECK_OK(iree_hal_device_transfer_h2d(
+        device_, data.data(), buffer, 0, data.size(),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  }
+
+  std::vector<uint8_t> Read(iree_hal_buffer_t* buffer) {
+    std::vector<uint8_t> data(kAllocationSize);
+    IREE_CHECK_OK(iree_hal_device_transfer_d2h(
+        device_, buffer, 0, data.data(), data.size(),
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    return data;
+  }
+};
+
+// Tests an allocation that is deallocated and followed by another allocation
+// ordered after the deallocation (which may reuse the same memory).
+TEST_F(QueueAllocaTest, AllocaDeallocaAlloca) {
+  iree_hal_semaphore_t* semaphore = CreateSemaphore();
+
+  iree_hal_buffer_t* buffer0 = QueueAlloca(semaphore, 0ull, 1ull);
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, 1ull,
+                                         iree_infinite_timeout(),
+                                         IREE_HAL_WAIT_FLAG_DEFAULT));
+  Write(buffer0, 0xA0);
+  EXPECT_THAT(Read(buffer0),
+              ContainerEq(std::vector<uint8_t>(kAllocationSize, 0xA0)));
+  QueueDealloca(semaphore, 1ull, 2ull, buffer0);
+  iree_hal_buffer_release(buffer0);
+
+  iree_hal_buffer_t* buffer1 = QueueAlloca(semaphore, 2ull, 3ull);
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, 3ull,
+                                         iree_infinite_timeout(),
+                                         IREE_HAL_WAIT_FLAG_DEFAULT));
+  Write(buffer1, 0xB1);
+  EXPECT_THAT(Read(buffer1),
+              ContainerEq(std::vector<uint8_t>(kAllocationSize, 0xB1)));
+  QueueDealloca(semaphore, 3ull, 4ull, buffer1);
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, 4ull,
+                                         iree_infinite_timeout(),
+                                         IREE_HAL_WAIT_FLAG_DEFAULT));
+  iree_hal_buffer_release(buffer1);
+
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Tests a sequence of allocations, fills, and deallocations enqueued before any
+// of them execute. Each allocation is ordered after the prior deallocation and
+// may reuse its memory before the deallocation has executed.
+TEST_F(QueueAllocaTest, AllocaDeallocaAllocaPipelined) {
+  iree_hal_semaphore_t* semaphore = CreateSemaphore();
+
+  const uint8_t pattern0 = 0xA0;
+  iree_hal_buffer_t* buffer0 = QueueAlloca(semaphore, 0ull, 1ull);
+  QueueFill(semaphore, 1ull, 2ull, buffer0, pattern0);
+  QueueDealloca(semaphore, 2ull, 3ull, buffer0);
+  iree_hal_buffer_release(buffer0);
+
+  const uint8_t pattern1 = 0xB1;
+  iree_hal_buffer_t* buffer1 = QueueAlloca(semaphore, 3ull, 4ull);
+  QueueFill(semaphore, 4ull, 5ull, buffer1, pattern1);
+
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, 5ull,
+                                         iree_infinite_timeout(),
+                                         IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_THAT(Read(buffer1),
+              ContainerEq(std::vector<uint8_t>(kAllocationSize, pattern1)));
+  QueueDealloca(semaphore, 5ull, 6ull, buffer1);
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(semaphore, 6ull,
+                                         iree_infinite_timeout(),
+                                         IREE_HAL_WAIT_FLAG_DEFAULT));
+  iree_hal_buffer_release(buffer1);
+
+  iree_hal_semaphore_release(semaphore);
+}
+
+}  // namespace iree::hal::cts
+
+#endif  // IREE_HAL_CTS_QUEUE_ALLOCA_TEST_H_
@@ -21,6 +21,7 @@
 #include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
 #include "iree/hal/utils/queue_emulation.h"
+#include "iree/hal/utils/queue_pool.h"
 
 typedef struct iree_hal_sync_device_t {
   iree_hal_resource_t resource;
@@ -36,6 +37,10 @@ typedef struct iree_hal_sync_device_t {
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t large_block_pool;
 
+  // Pool used for queue-ordered allocations. As all queue operations complete
+  // synchronously deallocated memory is immediately reusable.
+  iree_hal_queue_pool_t* alloca_pool;
+
   // Shared semaphore state used to emulate OS-level primitives. This backend
   // is intended to run on bare-metal systems where we need to perform all
   // synchronization ourselves.
@@ -109,6 +114,10 @@ iree_status_t iree_hal_sync_device_create(
     }
 
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
+
+    status = iree_hal_queue_pool_create(
+        IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS, host_allocator,
+        &device->alloca_pool);
   }
 
   if (iree_status_is_ok(status)) {
@@ -127,6 +136,8 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
 
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
+  iree_hal_queue_pool_release(device->alloca_pool);
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -177,6 +188,7 @@ static void iree_hal_sync_replace_channel_provider(
 
 static iree_status_t iree_hal_sync_device_trim(iree_hal_device_t* base_device) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  iree_hal_queue_pool_trim(device->alloca_pool);
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -297,15 +309,34 @@ static iree_status_t iree_hal_sync_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size, iree_hal_alloca_flags_t flags,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   IREE_RETURN_IF_ERROR(
       iree_hal_semaphore_list_wait(wait_semaphore_list, iree_infinite_timeout(),
                                    IREE_HAL_WAIT_FLAG_DEFAULT));
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                         params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+
+  // All prior deallocations have completed by the time we get here so the
+  // pool only hands out memory that is immediately reusable.
+  iree_hal_buffer_placement_t placement = {
+      .device = base_device,
+      .queue_affinity = queue_affinity ? queue_affinity
+                                       : IREE_HAL_QUEUE_AFFINITY_ANY,
+      .flags = IREE_HAL_BUFFER_PLACEMENT_FLAG_ASYNCHRONOUS,
+  };
+  if (iree_all_bits_set(flags, IREE_HAL_ALLOCA_FLAG_INDETERMINATE_LIFETIME)) {
+    placement.flags |= IREE_HAL_BUFFER_PLACEMENT_FLAG_INDETERMINATE_LIFETIME;
+  }
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_queue_pool_acquire(
+      device->alloca_pool, device->device_allocator, placement,
+      iree_hal_semaphore_list_empty(), params, allocation_size, &buffer));
+
+  iree_status_t status = iree_hal_semaphore_list_signal(signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_sync_device_queue_dealloca(
@@ -313,11 +344,13 @@ static iree_status_t iree_hal_sync_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer, iree_hal_dealloca_flags_t flags) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
-      IREE_HAL_EXECUTE_FLAG_NONE));
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_semaphore_list_wait(wait_semaphore_list, iree_infinite_timeout(),
+                                   IREE_HAL_WAIT_FLAG_DEFAULT));
+  IREE_RETURN_IF_ERROR(iree_hal_queue_pool_release_buffer(
+      device->alloca_pool, buffer, iree_hal_semaphore_list_empty()));
+  return iree_hal_semaphore_list_signal(signal_semaphore_list);
 }
 
 static iree_status_t iree_hal_sync_device_queue_read(
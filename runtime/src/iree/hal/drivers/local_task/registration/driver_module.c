@@ -20,6 +20,72 @@ IREE_FLAG(
     bool, task_abort_on_failure, false,
     "Aborts the program on the first failure within a task system queue.");
 
+IREE_FLAG(
+    int32_t, task_file_transfer_chunk_count, 0,
+    "Maximum number of chunks a queue file read/write is split into for\n"
+    "concurrent processing by executor workers. 0 uses one per worker.");
+
+IREE_FLAG(
+    int64_t, task_file_transfer_chunk_size, 0,
+    "Maximum size in bytes of each file I/O operation performed by queue\n"
+    "file reads/writes. 0 selects a default.");
+
+IREE_FLAG(
+    bool, task_file_direct_io, false,
+    "Reads files imported by the device with direct I/O (O_DIRECT)\n"
+    "bypassing the page cache where io_uring and the file system support it.");
+
+IREE_FLAG(
+    int32_t, task_file_queue_depth, 0,
+    "Maximum number of io_uring requests each file read/write keeps in\n"
+    "flight. 0 selects a default.");
+
+IREE_FLAG(
+    int32_t, task_file_request_size, 0,
+    "Bytes transferred by each io_uring file request. 0 selects a default.");
+
+IREE_FLAG(
+    string, task_queue_priorities, "",
+    "Comma-separated scheduling priority of each device queue from\n"
+    "[`high`, `normal`, `low`]. One queue is created per entry with queues\n"
+    "sharing executors round-robin. Submissions select a priority by the\n"
+    "queue affinity they target. Empty creates one normal priority queue per\n"
+    "executor.");
+
+// Parses --task_queue_priorities into the priority queue masks of |params|.
+// |out_queue_count| is set to the number of queues listed or 0 if none were.
+static iree_status_t iree_hal_local_task_driver_parse_queue_priorities(
+    iree_hal_task_device_params_t* params, iree_host_size_t* out_queue_count) {
+  *out_queue_count = 0;
+  iree_string_view_t remaining =
+      iree_make_cstring_view(FLAG_task_queue_priorities);
+  iree_host_size_t queue_count = 0;
+  while (!iree_string_view_is_empty(remaining)) {
+    iree_string_view_t value = iree_string_view_empty();
+    iree_string_view_split(remaining, ',', &value, &remaining);
+    value = iree_string_view_trim(value);
+    if (queue_count >= IREE_HAL_MAX_QUEUES) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "at most %" PRIhsz " queue priorities allowed",
+                              (iree_host_size_t)IREE_HAL_MAX_QUEUES);
+    }
+    iree_hal_queue_affinity_t queue_affinity = 1ull << queue_count;
+    if (iree_string_view_equal(value, IREE_SV("high"))) {
+      params->high_priority_queues |= queue_affinity;
+    } else if (iree_string_view_equal(value, IREE_SV("low"))) {
+      params->low_priority_queues |= queue_affinity;
+    } else if (!iree_string_view_equal(value, IREE_SV("normal"))) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unknown queue priority `%.*s`; expected one of "
+                              "[high, normal, low]",
+                              (int)value.size, value.data);
+    }
+    ++queue_count;
+  }
+  *out_queue_count = queue_count;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -49,6 +115,30 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
   if (FLAG_task_abort_on_failure) {
     default_params.queue_scope_flags |= IREE_TASK_SCOPE_FLAG_ABORT_ON_FAILURE;
   }
+  if (FLAG_task_file_transfer_chunk_count < 0 ||
+      FLAG_task_file_transfer_chunk_size < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file transfer chunk count and size must be >= 0");
+  }
+  default_params.file_transfer_chunk_count =
+      (iree_host_size_t)FLAG_task_file_transfer_chunk_count;
+  default_params.file_transfer_chunk_size =
+      (iree_device_size_t)FLAG_task_file_transfer_chunk_size;
+  if (FLAG_task_file_queue_depth < 0 || FLAG_task_file_request_size < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file queue depth and request size must be >= 0");
+  }
+  if (FLAG_task_file_direct_io) {
+    default_params.file_options.uring.flags |=
+        IREE_HAL_URING_FILE_FLAG_DIRECT_IO;
+  }
+  default_params.file_options.uring.queue_depth =
+      (uint32_t)FLAG_task_file_queue_depth;
+  default_params.file_options.uring.request_size =
+      (uint32_t)FLAG_task_file_request_size;
+  iree_host_size_t queue_count = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_local_task_driver_parse_queue_priorities(
+      &default_params, &queue_count));
 
   // Create executors for each topology specified by flags.
   // Stack allocated storage today but we can query for the total count and
@@ -81,12 +171,25 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
                                             &device_allocator);
   }
 
+  // Queues listed in --task_queue_priorities share the executors round-robin.
+  iree_task_executor_t* queue_executors[IREE_HAL_MAX_QUEUES] = {NULL};
+  if (queue_count == 0 || executor_count == 0) {
+    queue_count = executor_count;
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
+      queue_executors[i] = executors[i];
+    }
+  } else {
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
+      queue_executors[i] = executors[i % executor_count];
+    }
+  }
+
   // Create a task driver that will use the given executors for scheduling work
   // and loaders for loading executables.
   if (iree_status_is_ok(status)) {
     status = iree_hal_task_driver_create(
-        driver_name, &default_params, executor_count, executors, loader_count,
-        loaders, device_allocator, host_allocator, out_driver);
+        driver_name, &default_params, queue_count, queue_executors,
+        loader_count, loaders, device_allocator, host_allocator, out_driver);
   }
 
   for (iree_host_size_t i = 0; i < executor_count; ++i) {
@@ -15,12 +15,59 @@
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/resource_set.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/list.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
+//===----------------------------------------------------------------------===//
+// Reusable command buffer support
+//===----------------------------------------------------------------------===//
+
+// Initial state of a task recorded into a reusable command buffer.
+// Executing a task graph is destructive: completion links are cleared as tasks
+// retire, dependency counts are consumed, and dispatches toggle their flags as
+// they are issued. Snapshots are captured when recording ends and restored to
+// re-arm the graph before each issue.
+typedef struct iree_hal_task_cmd_snapshot_t {
+  struct iree_hal_task_cmd_snapshot_t* next;
+  iree_task_t* task;
+  iree_task_t* completion_task;
+  int32_t pending_dependency_count;
+  iree_task_flags_t flags;
+  // Workgroup count pointer of IREE_TASK_FLAG_DISPATCH_INDIRECT dispatches as
+  // it is replaced with the sampled value when the dispatch is issued.
+  const uint32_t* workgroup_count_ptr;
+} iree_hal_task_cmd_snapshot_t;
+
+// Resolves the |buffer_refs| of a command against |binding_table| and patches
+// the command with the resolved buffers.
+typedef iree_status_t (*iree_hal_task_cmd_fixup_fn_t)(
+    void* cmd, iree_host_size_t buffer_ref_count,
+    const iree_hal_buffer_ref_t* buffer_refs,
+    iree_hal_buffer_binding_table_t binding_table);
+
+// A command that references binding table slots and must be patched with the
+// bound buffers each time the command buffer is issued.
+typedef struct iree_hal_task_cmd_fixup_t {
+  struct iree_hal_task_cmd_fixup_t* next;
+  iree_hal_task_cmd_fixup_fn_t fn;
+  void* cmd;
+  // Buffer references as originally recorded (direct or indirect).
+  iree_host_size_t buffer_ref_count;
+  iree_hal_buffer_ref_t buffer_refs[];
+} iree_hal_task_cmd_fixup_t;
+
+typedef struct iree_hal_task_command_buffer_t iree_hal_task_command_buffer_t;
+
+// Task the leaves of a reusable command buffer DAG complete into.
+typedef struct iree_hal_task_cmd_exit_t {
+  iree_task_nop_t task;
+  iree_hal_task_command_buffer_t* command_buffer;
+} iree_hal_task_cmd_exit_t;
+
 //===----------------------------------------------------------------------===//
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
@@ -33,10 +80,22 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
-typedef struct iree_hal_task_command_buffer_t {
+//
+// Reusable (non-ONE_SHOT) command buffers keep the task DAG recorded in the
+// arena and re-arm it on each issue instead of rebuilding it. All tasks in the
+// DAG join on an exit task that marks the graph as idle again once every task
+// has retired (or been discarded). The commands are also recorded into a
+// deferred command buffer so that issues made while the DAG is still in-flight
+// can replay them into a new one-shot task command buffer.
+struct iree_hal_task_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Unretained device allocator and block pool used to create the one-shot
+  // command buffers that deferred commands are replayed into.
+  iree_hal_allocator_t* device_allocator;
+  iree_arena_block_pool_t* block_pool;
+
   iree_task_scope_t* scope;
 
   // Arena used for all allocations; references the shared device block pool.
@@ -58,6 +117,33 @@ typedef struct iree_hal_task_command_buffer_t {
   // An empty list indicates that root_tasks are also the leaves.
   iree_task_list_t leaf_tasks;
 
+  // Commands referencing binding table slots that are resolved on issue.
+  iree_hal_task_cmd_fixup_t* fixup_head;
+  iree_hal_task_cmd_fixup_t* fixup_tail;
+
+  // Reusable command buffer state; unused if ONE_SHOT.
+  struct {
+    // Initial state of every task in the DAG, including the exit task.
+    iree_hal_task_cmd_snapshot_t* snapshot_head;
+    iree_hal_task_cmd_snapshot_t* snapshot_tail;
+
+    // Tasks at the root of the DAG as the root_tasks list is consumed by each
+    // issue.
+    iree_host_size_t root_task_count;
+    iree_task_t** root_tasks;
+
+    // Task the leaves of the DAG complete into. Chained to the retire task of
+    // each issue.
+    iree_hal_task_cmd_exit_t* exit_task;
+
+    // Non-zero while an issue of the DAG is in-flight.
+    iree_atomic_int32_t in_flight;
+
+    // Deferred recording of all commands replayed into a one-shot command
+    // buffer when the DAG is issued while already in-flight.
+    iree_hal_command_buffer_t* replay;
+  } reuse;
+
   // TODO(benvanik): move this out of the struct and allocate from the arena -
   // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
@@ -77,7 +163,7 @@ typedef struct iree_hal_task_command_buffer_t {
     // All execution tasks emitted that must execute after |open_barrier|.
     iree_task_list_t open_tasks;
   } state;
-} iree_hal_task_command_buffer_t;
+};
 
 static const iree_hal_command_buffer_vtable_t
     iree_hal_task_command_buffer_vtable;
@@ -98,25 +184,6 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
-  if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_task_command_buffer_t* command_buffer = NULL;
@@ -131,16 +198,30 @@ iree_status_t iree_hal_task_command_buffer_create(
         binding_capacity, (uint8_t*)command_buffer + sizeof(*command_buffer),
         &iree_hal_task_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
+    command_buffer->device_allocator = device_allocator;
+    command_buffer->block_pool = block_pool;
     command_buffer->scope = scope;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->fixup_head = NULL;
+    command_buffer->fixup_tail = NULL;
+    memset(&command_buffer->reuse, 0, sizeof(command_buffer->reuse));
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_UNRETAINED)) {
       status = iree_hal_resource_set_allocate(block_pool,
                                               &command_buffer->resource_set);
     }
   }
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    // Commands are validated as they are recorded into this command buffer and
+    // don't need to be validated again when forwarded to the replay.
+    status = iree_hal_deferred_command_buffer_create(
+        device_allocator, mode | IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        command_categories, queue_affinity, binding_capacity, block_pool,
+        host_allocator, &command_buffer->reuse.replay);
+  }
   if (iree_status_is_ok(status)) {
     *out_command_buffer = &command_buffer->base;
   } else {
@@ -163,6 +244,7 @@ static void iree_hal_task_command_buffer_destroy(
   iree_task_list_discard(&command_buffer->leaf_tasks);
   iree_arena_deinitialize(&command_buffer->arena);
   iree_hal_resource_set_free(command_buffer->resource_set);
+  iree_hal_command_buffer_release(command_buffer->reuse.replay);
   iree_allocator_free(host_allocator, command_buffer);
 
   IREE_TRACE_ZONE_END(z0);
@@ -180,15 +262,101 @@ bool iree_hal_task_command_buffer_isa(
 
 static iree_status_t iree_hal_task_command_buffer_flush_tasks(
     iree_hal_task_command_buffer_t* command_buffer);
+static iree_status_t iree_hal_task_command_buffer_finalize_reuse(
+    iree_hal_task_command_buffer_t* command_buffer);
+static void iree_hal_task_command_buffer_exit_cleanup(
+    iree_task_t* task, iree_status_code_t status_code);
+
+// Returns true if the task DAG is retained and re-armed on each issue.
+static bool iree_hal_task_command_buffer_is_reusable(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  return !iree_all_bits_set(iree_hal_command_buffer_mode(&command_buffer->base),
+                            IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+}
+
+// Tracks |task| as part of the task DAG of a reusable command buffer so that it
+// can be re-armed on each issue. No-op for one-shot command buffers.
+static iree_status_t iree_hal_task_command_buffer_track_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
+  if (!iree_hal_task_command_buffer_is_reusable(command_buffer)) {
+    return iree_ok_status();
+  }
+  iree_hal_task_cmd_snapshot_t* snapshot = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*snapshot), (void**)&snapshot));
+  memset(snapshot, 0, sizeof(*snapshot));
+  snapshot->task = task;
+  if (command_buffer->reuse.snapshot_tail) {
+    command_buffer->reuse.snapshot_tail->next = snapshot;
+  } else {
+    command_buffer->reuse.snapshot_head = snapshot;
+  }
+  command_buffer->reuse.snapshot_tail = snapshot;
+  return iree_ok_status();
+}
+
+// Appends a fixup for |cmd| with storage for |buffer_ref_count| buffer
+// references that the caller must populate.
+static iree_status_t iree_hal_task_command_buffer_append_fixup(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_fixup_fn_t fn, void* cmd,
+    iree_host_size_t buffer_ref_count, iree_hal_task_cmd_fixup_t** out_fixup) {
+  iree_hal_task_cmd_fixup_t* fixup = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena,
+      sizeof(*fixup) + buffer_ref_count * sizeof(fixup->buffer_refs[0]),
+      (void**)&fixup));
+  fixup->next = NULL;
+  fixup->fn = fn;
+  fixup->cmd = cmd;
+  fixup->buffer_ref_count = buffer_ref_count;
+  if (command_buffer->fixup_tail) {
+    command_buffer->fixup_tail->next = fixup;
+  } else {
+    command_buffer->fixup_head = fixup;
+  }
+  command_buffer->fixup_tail = fixup;
+  *out_fixup = fixup;
+  return iree_ok_status();
+}
+
+// Records a fixup for |cmd| if any of |buffer_refs| reference a binding table
+// slot. |fn| will be called with a copy of the original |buffer_refs| each time
+// the command buffer is issued.
+static iree_status_t iree_hal_task_command_buffer_record_fixup(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_fixup_fn_t fn, void* cmd,
+    iree_host_size_t buffer_ref_count,
+    const iree_hal_buffer_ref_t* buffer_refs) {
+  bool any_indirect = false;
+  for (iree_host_size_t i = 0; i < buffer_ref_count; ++i) {
+    if (!buffer_refs[i].buffer) {
+      any_indirect = true;
+      break;
+    }
+  }
+  if (!any_indirect) return iree_ok_status();
+  iree_hal_task_cmd_fixup_t* fixup = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_fixup(
+      command_buffer, fn, cmd, buffer_ref_count, &fixup));
+  memcpy(fixup->buffer_refs, buffer_refs,
+         buffer_ref_count * sizeof(fixup->buffer_refs[0]));
+  return iree_ok_status();
+}
 
 static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  if (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+  if (!iree_task_list_is_empty(&command_buffer->root_tasks) ||
+      command_buffer->reuse.root_task_count > 0) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_command_buffer_begin(command_buffer->reuse.replay));
+  }
   return iree_ok_status();
 }
 
@@ -209,8 +377,87 @@ static iree_status_t iree_hal_task_command_buffer_end(
                         &command_buffer->root_tasks);
   }
 
+  if (iree_hal_task_command_buffer_is_reusable(command_buffer)) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_finalize_reuse(command_buffer));
+  }
+
   iree_hal_resource_set_freeze(command_buffer->resource_set);
 
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_command_buffer_end(command_buffer->reuse.replay));
+  }
+
+  return iree_ok_status();
+}
+
+// Captures the recorded task DAG of a reusable command buffer so that it can be
+// re-armed on each issue. The root and leaf task lists are consumed.
+static iree_status_t iree_hal_task_command_buffer_finalize_reuse(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  // If the command buffer is empty (valid!) then issues are no-ops.
+  if (iree_task_list_is_empty(&command_buffer->root_tasks)) {
+    return iree_ok_status();
+  }
+
+  // Join all leaves on the exit task. When the exit task completes (or is
+  // discarded) it's guaranteed that all tasks in the DAG have as well.
+  iree_hal_task_cmd_exit_t* exit_task = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*exit_task), (void**)&exit_task));
+  iree_task_nop_initialize(command_buffer->scope, &exit_task->task);
+  iree_task_set_cleanup_fn(&exit_task->task.header,
+                           iree_hal_task_command_buffer_exit_cleanup);
+  exit_task->command_buffer = command_buffer;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_task(
+      command_buffer, &exit_task->task.header));
+  iree_task_list_t* tail_tasks =
+      iree_task_list_is_empty(&command_buffer->leaf_tasks)
+          ? &command_buffer->root_tasks
+          : &command_buffer->leaf_tasks;
+  for (iree_task_t* task = iree_task_list_front(tail_tasks); task != NULL;
+       task = task->next_task) {
+    iree_task_set_completion_task(task, &exit_task->task.header);
+  }
+  command_buffer->reuse.exit_task = exit_task;
+
+  // The root list links are reused by the executor once issued so we retain
+  // the roots separately.
+  iree_host_size_t root_task_count = 0;
+  for (iree_task_t* task = iree_task_list_front(&command_buffer->root_tasks);
+       task != NULL; task = task->next_task) {
+    ++root_task_count;
+  }
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena,
+      root_task_count * sizeof(command_buffer->reuse.root_tasks[0]),
+      (void**)&command_buffer->reuse.root_tasks));
+  iree_host_size_t root_index = 0;
+  for (iree_task_t* task = iree_task_list_front(&command_buffer->root_tasks);
+       task != NULL; task = task->next_task) {
+    command_buffer->reuse.root_tasks[root_index++] = task;
+  }
+  command_buffer->reuse.root_task_count = root_task_count;
+  iree_task_list_initialize(&command_buffer->root_tasks);
+  iree_task_list_initialize(&command_buffer->leaf_tasks);
+
+  // Snapshot the initial state of every task now that the DAG is complete.
+  for (iree_hal_task_cmd_snapshot_t* snapshot =
+           command_buffer->reuse.snapshot_head;
+       snapshot != NULL; snapshot = snapshot->next) {
+    iree_task_t* task = snapshot->task;
+    snapshot->completion_task = task->completion_task;
+    snapshot->pending_dependency_count = iree_atomic_load(
+        &task->pending_dependency_count, iree_memory_order_relaxed);
+    snapshot->flags = task->flags;
+    if (task->type == IREE_TASK_TYPE_DISPATCH &&
+        iree_all_bits_set(task->flags, IREE_TASK_FLAG_DISPATCH_INDIRECT)) {
+      snapshot->workgroup_count_ptr =
+          ((iree_task_dispatch_t*)task)->workgroup_count.ptr;
+    }
+  }
+
   return iree_ok_status();
 }
 
@@ -285,6 +532,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
                                            sizeof(*barrier), (void**)&barrier));
   iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_task(
+      command_buffer, &barrier->header));
 
   // If there were previous tasks then join them to the barrier.
   for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
@@ -321,6 +570,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
 // scope (after state.open_barrier and before the next barrier).
 static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
     iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_track_task(command_buffer, task));
   if (command_buffer->state.open_barrier == NULL) {
     // If there is no open barrier then we are at the head and going right into
     // the task DAG.
@@ -337,20 +588,198 @@ static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Marks the DAG of a reusable command buffer as idle once the exit task has
+// retired or been discarded. All other tasks in the DAG have completed by then.
+static void iree_hal_task_command_buffer_exit_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_cmd_exit_t* exit_task = (iree_hal_task_cmd_exit_t*)task;
+  iree_atomic_store(&exit_task->command_buffer->reuse.in_flight, 0,
+                    iree_memory_order_release);
+}
+
+// Restores every task in the DAG to its state as recorded.
+static void iree_hal_task_command_buffer_rearm(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_hal_task_cmd_snapshot_t* snapshot =
+           command_buffer->reuse.snapshot_head;
+       snapshot != NULL; snapshot = snapshot->next) {
+    iree_task_t* task = snapshot->task;
+    task->completion_task = snapshot->completion_task;
+    iree_atomic_store(&task->pending_dependency_count,
+                      snapshot->pending_dependency_count,
+                      iree_memory_order_relaxed);
+    task->flags = snapshot->flags;
+    if (task->type == IREE_TASK_TYPE_DISPATCH) {
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      if (iree_all_bits_set(task->flags, IREE_TASK_FLAG_DISPATCH_INDIRECT)) {
+        dispatch_task->workgroup_count.ptr = snapshot->workgroup_count_ptr;
+      }
+      memset(&dispatch_task->statistics, 0, sizeof(dispatch_task->statistics));
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Patches all commands referencing binding table slots with the buffers bound
+// in |binding_table|.
+static iree_status_t iree_hal_task_command_buffer_apply_fixups(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  if (!command_buffer->fixup_head) return iree_ok_status();
+  if (IREE_UNLIKELY(iree_hal_buffer_binding_table_is_empty(binding_table))) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "command buffer references binding table slots but no binding table "
+        "was provided");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  for (iree_hal_task_cmd_fixup_t* fixup = command_buffer->fixup_head;
+       fixup != NULL; fixup = fixup->next) {
+    status = fixup->fn(fixup->cmd, fixup->buffer_ref_count, fixup->buffer_refs,
+                       binding_table);
+    if (!iree_status_is_ok(status)) break;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Resolves |buffer_ref| against |binding_table| and fails if the slot is empty.
+static iree_status_t iree_hal_task_cmd_resolve_ref(
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_buffer_ref_t buffer_ref, iree_hal_buffer_ref_t* out_resolved_ref) {
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_binding_table_resolve_ref(
+      binding_table, buffer_ref, out_resolved_ref));
+  if (IREE_UNLIKELY(!out_resolved_ref->buffer)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "binding table slot %u is NULL; all referenced "
+                            "slots must have a valid buffer",
+                            buffer_ref.buffer_slot);
+  }
+  return iree_ok_status();
+}
+
+// Replays the deferred recording of a reusable |command_buffer| into a new
+// one-shot task command buffer and issues that. This is used when the recorded
+// DAG is already in-flight and cannot be re-armed.
+static iree_status_t iree_hal_task_command_buffer_issue_replay(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
+    iree_arena_allocator_t* arena, iree_hal_resource_set_t* resource_set,
+    iree_task_submission_t* pending_submission) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Create a transient command buffer that we'll apply the deferred commands
+  // into. It will live beyond this function as we'll issue the commands but
+  // they may not run immediately.
+  iree_hal_command_buffer_t* replay_command_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_task_command_buffer_create(
+          command_buffer->device_allocator, command_buffer->scope,
+          iree_hal_command_buffer_mode(&command_buffer->base) |
+              IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+              IREE_HAL_COMMAND_BUFFER_MODE_UNRETAINED |
+              // NOTE: we need to validate if a binding table is provided as the
+              // bindings were not known when it was originally recorded.
+              (iree_hal_buffer_binding_table_is_empty(binding_table)
+                   ? IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED
+                   : 0),
+          iree_hal_command_buffer_allowed_categories(&command_buffer->base),
+          command_buffer->base.queue_affinity, /*binding_capacity=*/0,
+          command_buffer->block_pool, command_buffer->host_allocator,
+          &replay_command_buffer));
+
+  // Keep the command buffer live until the queue operation completes.
+  iree_status_t status =
+      iree_hal_resource_set_insert(resource_set, 1, &replay_command_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_command_buffer_release(replay_command_buffer);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Replay the commands from the deferred command buffer into the new task one.
+  // This creates the task graph and captures the binding references but does
+  // not yet issue the commands.
+  status = iree_hal_deferred_command_buffer_apply(
+      command_buffer->reuse.replay, replay_command_buffer, binding_table);
+
+  // Issue the task command buffer as if it had been recorded directly to begin
+  // with.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_task_command_buffer_issue(
+        replay_command_buffer, iree_hal_buffer_binding_table_empty(),
+        queue_state, retire_task, arena, resource_set, pending_submission);
+  }
+
+  // Still retained in the resource set until retirement.
+  iree_hal_command_buffer_release(replay_command_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
-    iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission) {
+    iree_arena_allocator_t* arena, iree_hal_resource_set_t* resource_set,
+    iree_task_submission_t* pending_submission) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
   IREE_ASSERT_TRUE(command_buffer);
 
+  if (iree_hal_task_command_buffer_is_reusable(command_buffer)) {
+    // If the command buffer is empty (valid!) then we are a no-op.
+    if (command_buffer->reuse.root_task_count == 0) {
+      return iree_ok_status();
+    }
+
+    // The DAG is shared by all issues and can only be in-flight once. Issues
+    // that overlap with one still in-flight replay the commands instead.
+    if (iree_atomic_exchange(&command_buffer->reuse.in_flight, 1,
+                             iree_memory_order_acquire) != 0) {
+      return iree_hal_task_command_buffer_issue_replay(
+          command_buffer, binding_table, queue_state, retire_task, arena,
+          resource_set, pending_submission);
+    }
+    iree_hal_task_command_buffer_rearm(command_buffer);
+    iree_status_t status = iree_hal_task_command_buffer_apply_fixups(
+        command_buffer, binding_table);
+    if (!iree_status_is_ok(status)) {
+      iree_atomic_store(&command_buffer->reuse.in_flight, 0,
+                        iree_memory_order_release);
+      return status;
+    }
+
+    // Chain the retire task onto the exit task that all leaves complete into.
+    iree_task_set_completion_task(&command_buffer->reuse.exit_task->task.header,
+                                  retire_task);
+
+    // Enqueue all root tasks that are ready to run immediately.
+    iree_task_list_t root_tasks;
+    iree_task_list_initialize(&root_tasks);
+    for (iree_host_size_t i = 0; i < command_buffer->reuse.root_task_count;
+         ++i) {
+      iree_task_list_push_back(&root_tasks,
+                               command_buffer->reuse.root_tasks[i]);
+    }
+    iree_task_submission_enqueue_list(pending_submission, &root_tasks);
+    return iree_ok_status();
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
   bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
   if (!has_root_tasks) {
     return iree_ok_status();
   }
 
+  IREE_RETURN_IF_ERROR(
+      iree_hal_task_command_buffer_apply_fixups(command_buffer, binding_table));
+
   bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
   if (has_leaf_tasks) {
     // Chain the retire task onto the leaf tasks as their completion indicates
@@ -412,6 +841,13 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_execution_barrier(
+        command_buffer->reuse.replay, source_stage_mask, target_stage_mask,
+        flags, memory_barrier_count, memory_barriers, buffer_barrier_count,
+        buffer_barriers));
+  }
+
   // TODO(benvanik): actual DAG construction. Right now we are just doing simple
   // global barriers each time and forcing a join-fork point.
   return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
@@ -454,6 +890,12 @@ static iree_status_t iree_hal_task_command_buffer_wait_events(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_wait_events(
+        command_buffer->reuse.replay, event_count, events, source_stage_mask,
+        target_stage_mask, memory_barrier_count, memory_barriers,
+        buffer_barrier_count, buffer_barriers));
+  }
   // TODO(#4518): implement events. For now we just insert global barriers.
   return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
 }
@@ -511,6 +953,19 @@ static iree_status_t iree_hal_task_cmd_fill_tile(
   return status;
 }
 
+static iree_status_t iree_hal_task_cmd_fill_fixup(
+    void* user_context, iree_host_size_t buffer_ref_count,
+    const iree_hal_buffer_ref_t* buffer_refs,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_task_cmd_fill_buffer_t* cmd =
+      (iree_hal_task_cmd_fill_buffer_t*)user_context;
+  IREE_RETURN_IF_ERROR(iree_hal_task_cmd_resolve_ref(
+      binding_table, buffer_refs[0], &cmd->target_ref));
+  cmd->task.workgroup_count.value[0] = (uint32_t)iree_device_size_ceil_div(
+      cmd->target_ref.length, cmd->task.workgroup_size[0]);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_command_buffer_fill_buffer(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_buffer_ref_t target_ref, const void* pattern,
@@ -518,6 +973,12 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_fill_buffer(
+        command_buffer->reuse.replay, target_ref, pattern, pattern_length,
+        flags));
+  }
+
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, 1, &target_ref.buffer));
 
@@ -530,8 +991,11 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
       /*y=*/1,
       /*z=*/1,
   };
+  // NOTE: indirect references have their workgroup count set on issue.
   const uint32_t workgroup_count[3] = {
-      /*x=*/iree_device_size_ceil_div(target_ref.length, workgroup_size[0]),
+      /*x=*/target_ref.buffer ? iree_device_size_ceil_div(target_ref.length,
+                                                         workgroup_size[0])
+                              : 0,
       /*y=*/1,
       /*z=*/1,
   };
@@ -542,6 +1006,8 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   cmd->target_ref = target_ref;
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_fixup(
+      command_buffer, iree_hal_task_cmd_fill_fixup, cmd, 1, &target_ref));
 
   return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
                                                           &cmd->task.header);
@@ -570,6 +1036,16 @@ static iree_status_t iree_hal_task_cmd_update_buffer(
   return status;
 }
 
+static iree_status_t iree_hal_task_cmd_update_fixup(
+    void* user_context, iree_host_size_t buffer_ref_count,
+    const iree_hal_buffer_ref_t* buffer_refs,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_task_cmd_update_buffer_t* cmd =
+      (iree_hal_task_cmd_update_buffer_t*)user_context;
+  return iree_hal_task_cmd_resolve_ref(binding_table, buffer_refs[0],
+                                       &cmd->target_ref);
+}
+
 static iree_status_t iree_hal_task_command_buffer_update_buffer(
     iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
     iree_host_size_t source_offset, iree_hal_buffer_ref_t target_ref,
@@ -577,6 +1053,12 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_update_buffer(
+        command_buffer->reuse.replay, source_buffer, source_offset, target_ref,
+        flags));
+  }
+
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, 1, &target_ref.buffer));
 
@@ -594,6 +1076,8 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   cmd->target_ref = target_ref;
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->target_ref.length);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_fixup(
+      command_buffer, iree_hal_task_cmd_update_fixup, cmd, 1, &target_ref));
 
   return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
                                                           &cmd->task.header);
@@ -641,6 +1125,21 @@ static iree_status_t iree_hal_task_cmd_copy_tile(
   return status;
 }
 
+static iree_status_t iree_hal_task_cmd_copy_fixup(
+    void* user_context, iree_host_size_t buffer_ref_count,
+    const iree_hal_buffer_ref_t* buffer_refs,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_task_cmd_copy_buffer_t* cmd =
+      (iree_hal_task_cmd_copy_buffer_t*)user_context;
+  IREE_RETURN_IF_ERROR(iree_hal_task_cmd_resolve_ref(
+      binding_table, buffer_refs[0], &cmd->source_ref));
+  IREE_RETURN_IF_ERROR(iree_hal_task_cmd_resolve_ref(
+      binding_table, buffer_refs[1], &cmd->target_ref));
+  cmd->task.workgroup_count.value[0] = (uint32_t)iree_device_size_ceil_div(
+      cmd->target_ref.length, cmd->task.workgroup_size[0]);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_command_buffer_copy_buffer(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_buffer_ref_t source_ref, iree_hal_buffer_ref_t target_ref,
@@ -648,6 +1147,11 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_copy_buffer(
+        command_buffer->reuse.replay, source_ref, target_ref, flags));
+  }
+
   const iree_hal_buffer_t* buffers[2] = {
       source_ref.buffer,
       target_ref.buffer,
@@ -664,8 +1168,11 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
       /*y=*/1,
       /*z=*/1,
   };
+  // NOTE: indirect references have their workgroup count set on issue.
   const uint32_t workgroup_count[3] = {
-      /*x=*/iree_device_size_ceil_div(target_ref.length, workgroup_size[0]),
+      /*x=*/target_ref.buffer ? iree_device_size_ceil_div(target_ref.length,
+                                                         workgroup_size[0])
+                              : 0,
       /*y=*/1,
       /*z=*/1,
   };
@@ -675,6 +1182,10 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
       workgroup_size, workgroup_count, &cmd->task);
   cmd->source_ref = source_ref;
   cmd->target_ref = target_ref;
+  const iree_hal_buffer_ref_t buffer_refs[2] = {source_ref, target_ref};
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_fixup(
+      command_buffer, iree_hal_task_cmd_copy_fixup, cmd,
+      IREE_ARRAYSIZE(buffer_refs), buffer_refs));
 
   return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
                                                           &cmd->task.header);
@@ -753,8 +1264,10 @@ static iree_status_t iree_hal_task_cmd_dispatch_tile(
       .workgroup_count_x = tile_context->workgroup_count[0],
       .workgroup_count_y = tile_context->workgroup_count[1],
       .workgroup_count_z = tile_context->workgroup_count[2],
-      .max_concurrency =
-          iree_task_affinity_set_count_ones(cmd->task.header.affinity_set),
+      .max_concurrency = (uint8_t)iree_min(
+          iree_task_affinity_worker_count(cmd->task.header.affinity,
+                                          IREE_TASK_AFFINITY_MAX_BLOCK_SIZE),
+          UINT8_MAX),
       .binding_count = cmd->binding_count,
   };
   uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
@@ -783,6 +1296,54 @@ static iree_status_t iree_hal_task_cmd_dispatch_tile(
   return status;
 }
 
+// Maps the buffers bound to any binding table slots referenced by the dispatch.
+// |buffer_refs| contains the recorded bindings and, if the workgroup count is
+// sourced from a buffer, the workgroup count reference last.
+static iree_status_t iree_hal_task_cmd_dispatch_fixup(
+    void* user_context, iree_host_size_t buffer_ref_count,
+    const iree_hal_buffer_ref_t* buffer_refs,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_task_cmd_dispatch_t* cmd =
+      (iree_hal_task_cmd_dispatch_t*)user_context;
+
+  uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
+  cmd_ptr += cmd->constant_count * sizeof(uint32_t);
+  void** binding_ptrs = (void**)cmd_ptr;
+  cmd_ptr += cmd->binding_count * sizeof(*binding_ptrs);
+  size_t* binding_lengths = (size_t*)cmd_ptr;
+  for (iree_host_size_t i = 0; i < cmd->binding_count; ++i) {
+    // Direct bindings were mapped when recorded.
+    if (buffer_refs[i].buffer) continue;
+    iree_hal_buffer_ref_t binding;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_cmd_resolve_ref(binding_table, buffer_refs[i], &binding));
+    // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
+    iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+        binding.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+        IREE_HAL_MEMORY_ACCESS_ANY, binding.offset, binding.length,
+        &buffer_mapping));
+    binding_ptrs[i] = buffer_mapping.contents.data;
+    binding_lengths[i] = buffer_mapping.contents.data_length;
+  }
+
+  if (buffer_ref_count > cmd->binding_count &&
+      !buffer_refs[cmd->binding_count].buffer) {
+    iree_hal_buffer_ref_t workgroup_count_ref;
+    IREE_RETURN_IF_ERROR(iree_hal_task_cmd_resolve_ref(
+        binding_table, buffer_refs[cmd->binding_count], &workgroup_count_ref));
+    iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+        workgroup_count_ref.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+        IREE_HAL_MEMORY_ACCESS_READ, workgroup_count_ref.offset,
+        3 * sizeof(uint32_t), &buffer_mapping));
+    cmd->task.workgroup_count.ptr =
+        (const uint32_t*)buffer_mapping.contents.data;
+  }
+
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_command_buffer_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable,
@@ -799,6 +1360,12 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
         "direct/indirect arguments are not supported in the task system");
   }
 
+  if (command_buffer->reuse.replay) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_dispatch(
+        command_buffer->reuse.replay, executable, export_ordinal, config,
+        constants, bindings, flags));
+  }
+
   iree_hal_local_executable_t* local_executable =
       iree_hal_local_executable_cast(executable);
   iree_hal_executable_dispatch_attrs_v0_t dispatch_attrs = {0};
@@ -827,20 +1394,29 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
 
   iree_host_size_t resource_count = 1;
   const void* resources[2] = {executable, NULL};
-  if (iree_hal_dispatch_uses_indirect_parameters(flags)) {
+  const bool uses_indirect_parameters =
+      iree_hal_dispatch_uses_indirect_parameters(flags);
+  bool uses_binding_table = false;
+  if (uses_indirect_parameters) {
     resources[resource_count++] = config.workgroup_count_ref.buffer;
 
     // Make task system fetch the workgroup count from the provided buffer.
     cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_INDIRECT;
 
-    // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
-    iree_hal_buffer_mapping_t buffer_mapping = {{0}};
-    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
-        config.workgroup_count_ref.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
-        IREE_HAL_MEMORY_ACCESS_READ, config.workgroup_count_ref.offset,
-        3 * sizeof(uint32_t), &buffer_mapping));
-    cmd->task.workgroup_count.ptr =
-        (const uint32_t*)buffer_mapping.contents.data;
+    if (config.workgroup_count_ref.buffer) {
+      // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
+      iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+      IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+          config.workgroup_count_ref.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+          IREE_HAL_MEMORY_ACCESS_READ, config.workgroup_count_ref.offset,
+          3 * sizeof(uint32_t), &buffer_mapping));
+      cmd->task.workgroup_count.ptr =
+          (const uint32_t*)buffer_mapping.contents.data;
+    } else {
+      // Mapped from the binding table on issue.
+      cmd->task.workgroup_count.ptr = NULL;
+      uses_binding_table = true;
+    }
   }
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, resource_count, resources));
@@ -853,6 +1429,12 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
           IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE +
       config.dynamic_workgroup_local_memory;
 
+  // Share measured workgroup costs across all dispatches of the export so that
+  // the task system can size its scheduling to the work.
+  if (local_executable->workgroup_costs) {
+    cmd->task.tile_cost_ns = &local_executable->workgroup_costs[export_ordinal];
+  }
+
   // Push constants are pulled directly from the args and copied into the
   // command buffer. Note that we require 4 byte alignment and if the input
   // buffer is not aligned we have to fail.
@@ -899,6 +1481,9 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
           binding.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
           IREE_HAL_MEMORY_ACCESS_ANY, binding.offset, binding.length,
           &buffer_mapping));
+    } else if (command_buffer->base.binding_capacity > 0) {
+      // Mapped from the binding table on issue.
+      uses_binding_table = true;
     } else {
       return iree_make_status(
           IREE_STATUS_FAILED_PRECONDITION,
@@ -913,6 +1498,18 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
       command_buffer->resource_set, bindings.count, bindings.values,
       offsetof(iree_hal_buffer_ref_t, buffer), sizeof(iree_hal_buffer_ref_t)));
 
+  if (uses_binding_table) {
+    iree_hal_task_cmd_fixup_t* fixup = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_append_fixup(
+        command_buffer, iree_hal_task_cmd_dispatch_fixup, cmd,
+        bindings.count + (uses_indirect_parameters ? 1 : 0), &fixup));
+    memcpy(fixup->buffer_refs, bindings.values,
+           bindings.count * sizeof(fixup->buffer_refs[0]));
+    if (uses_indirect_parameters) {
+      fixup->buffer_refs[bindings.count] = config.workgroup_count_ref;
+    }
+  }
+
   return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
                                                           &cmd->task.header);
 }
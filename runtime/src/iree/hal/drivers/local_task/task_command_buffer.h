@@ -11,6 +11,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
+#include "iree/hal/utils/resource_set.h"
 #include "iree/task/scope.h"
 #include "iree/task/task.h"
 
@@ -18,6 +19,13 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Creates a command buffer that records directly into a task DAG.
+//
+// Command buffers without IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT retain the
+// recorded DAG and re-arm it on each issue. Issues made while the DAG is still
+// in-flight replay the commands into a new one-shot command buffer. Commands
+// may reference binding table slots when |binding_capacity| is non-zero and
+// the slots are resolved on each issue.
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_allocator_t* device_allocator, iree_task_scope_t* scope,
     iree_hal_command_buffer_mode_t mode,
@@ -31,9 +39,10 @@ bool iree_hal_task_command_buffer_isa(
     iree_hal_command_buffer_t* command_buffer);
 
 // Issues a recorded command buffer using the serial |queue_state|.
-// |queue_state| is used to track the synchronization scope of the queue from
-// prior commands such as signaled events and will be mutated as events are
-// reset or new events are signaled.
+// Any binding table slots referenced by the commands are resolved from
+// |binding_table|. |queue_state| is used to track the synchronization scope of
+// the queue from prior commands such as signaled events and will be mutated as
+// events are reset or new events are signaled.
 //
 // |retire_task| will be scheduled once all commands issued from the command
 // buffer retire and can be used as a fence point.
@@ -44,12 +53,17 @@ bool iree_hal_task_command_buffer_isa(
 // all of the allocated commands issued have completed and their memory in the
 // arena can be recycled.
 //
+// Any transient resources required by the issue are retained by |resource_set|
+// which must also live at least as long as |retire_task|.
+//
 // |pending_submission| will receive the ready list of commands and must be
 // submitted to the executor (or discarded on failure) by the caller.
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
-    iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission);
+    iree_arena_allocator_t* arena, iree_hal_resource_set_t* resource_set,
+    iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
 }  // extern "C"
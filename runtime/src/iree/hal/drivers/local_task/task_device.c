@@ -18,11 +18,16 @@
 #include "iree/hal/drivers/local_task/task_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/local_executable_cache.h"
-#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
+#include "iree/hal/utils/scheduler_statistics.h"
 #include "iree/hal/utils/queue_emulation.h"
 
+// Default maximum size of each file I/O operation performed by queue file
+// transfers. Large enough to amortize syscall overheads while small enough
+// that medium-sized transfers are split across multiple workers.
+#define IREE_HAL_TASK_DEVICE_FILE_TRANSFER_CHUNK_SIZE (16 * 1024 * 1024)
+
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
   iree_string_view_t identifier;
@@ -43,6 +48,12 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Chunking of queue file transfers; see iree_hal_task_device_params_t.
+  iree_host_size_t file_transfer_chunk_count;
+  iree_device_size_t file_transfer_chunk_size;
+  // Options for files imported from handles.
+  iree_hal_file_registry_options_t file_options;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -59,6 +70,11 @@ void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_scope_flags = IREE_TASK_SCOPE_FLAG_NONE;
+  out_params->high_priority_queues = 0;
+  out_params->low_priority_queues = 0;
+  out_params->file_transfer_chunk_count = 0;
+  out_params->file_transfer_chunk_size = 0;
+  memset(&out_params->file_options, 0, sizeof(out_params->file_options));
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -71,6 +87,10 @@ static iree_status_t iree_hal_task_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "must have at least one queue");
   }
+  if (params->high_priority_queues & params->low_priority_queues) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "queues cannot be both high and low priority");
+  }
   return iree_ok_status();
 }
 
@@ -115,6 +135,12 @@ iree_status_t iree_hal_task_device_create(
     device->host_allocator = host_allocator;
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
+    device->file_transfer_chunk_count = params->file_transfer_chunk_count;
+    device->file_transfer_chunk_size =
+        params->file_transfer_chunk_size
+            ? params->file_transfer_chunk_size
+            : IREE_HAL_TASK_DEVICE_FILE_TRANSFER_CHUNK_SIZE;
+    device->file_options = params->file_options;
 
     iree_arena_block_pool_initialize(4096, host_allocator,
                                      &device->small_block_pool);
@@ -130,15 +156,27 @@ iree_status_t iree_hal_task_device_create(
       iree_hal_executable_loader_retain(device->loaders[i]);
     }
 
-    device->queue_count = queue_count;
-    for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    // Only successfully initialized queues are counted so that a partially
+    // constructed device can be destroyed.
+    device->queue_count = 0;
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
       iree_hal_queue_affinity_t queue_affinity = 1ull << i;
-      iree_hal_task_queue_initialize(
-          device->identifier, queue_affinity, params->queue_scope_flags,
+      iree_task_scope_flags_t scope_flags = params->queue_scope_flags;
+      if (params->high_priority_queues & queue_affinity) {
+        scope_flags &= ~IREE_TASK_SCOPE_FLAG_PRIORITY_LOW;
+        scope_flags |= IREE_TASK_SCOPE_FLAG_PRIORITY_HIGH;
+      } else if (params->low_priority_queues & queue_affinity) {
+        scope_flags &= ~IREE_TASK_SCOPE_FLAG_PRIORITY_HIGH;
+        scope_flags |= IREE_TASK_SCOPE_FLAG_PRIORITY_LOW;
+      }
+      status = iree_hal_task_queue_initialize(
+          device->identifier, queue_affinity, scope_flags,
           queue_executors[i], &device->small_block_pool,
-          &device->large_block_pool, device->device_allocator,
+          &device->large_block_pool, device->device_allocator, host_allocator,
           &device->queues[i]);
+      if (!iree_status_is_ok(status)) break;
+      ++device->queue_count;
     }
   }
 
@@ -225,6 +263,51 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   return iree_ok_status();
 }
 
+// Queries the scheduler statistics summed across all unique queue executors.
+static void iree_hal_task_device_query_executor_statistics(
+    iree_hal_task_device_t* device,
+    iree_task_executor_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_task_executor_t* executor = device->queues[i].executor;
+    bool is_duplicate = false;
+    for (iree_host_size_t j = 0; j < i && !is_duplicate; ++j) {
+      is_duplicate = device->queues[j].executor == executor;
+    }
+    if (is_duplicate) continue;
+    iree_task_executor_statistics_t statistics;
+    iree_task_executor_query_statistics(executor, &statistics);
+    out_statistics->worker_count += statistics.worker_count;
+    const int64_t mailbox_max_depth = out_statistics->workers.mailbox_max_depth;
+#define IREE_HAL_TASK_SUM_WORKER_STATISTIC(name) \
+  out_statistics->workers.name += statistics.workers.name;
+    IREE_HAL_SCHEDULER_WORKER_STATISTICS(IREE_HAL_TASK_SUM_WORKER_STATISTIC)
+#undef IREE_HAL_TASK_SUM_WORKER_STATISTIC
+#define IREE_HAL_TASK_SUM_EXECUTOR_STATISTIC(name) \
+  out_statistics->name += statistics.name;
+    IREE_HAL_SCHEDULER_EXECUTOR_STATISTICS(IREE_HAL_TASK_SUM_EXECUTOR_STATISTIC)
+#undef IREE_HAL_TASK_SUM_EXECUTOR_STATISTIC
+    // The maximum depth is the maximum across executors and not the sum.
+    out_statistics->workers.mailbox_max_depth =
+        iree_max(mailbox_max_depth, statistics.workers.mailbox_max_depth);
+  }
+}
+
+// Scheduler statistics exposed under IREE_HAL_SCHEDULER_STATISTICS_CATEGORY.
+static const struct {
+  const char* key;
+  iree_host_size_t offset;
+} iree_hal_task_device_statistics_keys[] = {
+#define IREE_HAL_TASK_WORKER_STATISTIC(name) \
+  {#name, offsetof(iree_task_executor_statistics_t, workers.name)},
+    IREE_HAL_SCHEDULER_WORKER_STATISTICS(IREE_HAL_TASK_WORKER_STATISTIC)
+#undef IREE_HAL_TASK_WORKER_STATISTIC
+#define IREE_HAL_TASK_EXECUTOR_STATISTIC(name) \
+  {#name, offsetof(iree_task_executor_statistics_t, name)},
+    IREE_HAL_SCHEDULER_EXECUTOR_STATISTICS(IREE_HAL_TASK_EXECUTOR_STATISTIC)
+#undef IREE_HAL_TASK_EXECUTOR_STATISTIC
+};
+
 static iree_status_t iree_hal_task_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
@@ -261,6 +344,26 @@ static iree_status_t iree_hal_task_device_query_i64(
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.cpu"))) {
     return iree_cpu_lookup_data_by_key(key, out_value);
+  } else if (iree_string_view_equal(
+                 category, IREE_SV(IREE_HAL_SCHEDULER_STATISTICS_CATEGORY))) {
+    iree_task_executor_statistics_t statistics;
+    iree_hal_task_device_query_executor_statistics(device, &statistics);
+    if (iree_string_view_equal(key, IREE_SV("worker_count"))) {
+      *out_value = (int64_t)statistics.worker_count;
+      return iree_ok_status();
+    }
+    for (iree_host_size_t i = 0;
+         i < IREE_ARRAYSIZE(iree_hal_task_device_statistics_keys); ++i) {
+      if (iree_string_view_equal(
+              key, iree_make_cstring_view(
+                       iree_hal_task_device_statistics_keys[i].key))) {
+        memcpy(out_value,
+               (const uint8_t*)&statistics +
+                   iree_hal_task_device_statistics_keys[i].offset,
+               sizeof(*out_value));
+        return iree_ok_status();
+      }
+    }
   }
 
   return iree_make_status(
@@ -296,26 +399,13 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) ||
-      binding_capacity > 0) {
-    // TODO(indirect-cmd): natively support reusable task command buffers. For
-    // now we emulate by recording into a deferred command buffer and
-    // recording/issuing at submission time. The task system needs some
-    // reworking to support being able to resubmit task graphs as today it is
-    // destructive.
-    return iree_hal_deferred_command_buffer_create(
-        iree_hal_device_allocator(base_device), mode, command_categories,
-        queue_affinity, binding_capacity, &device->large_block_pool,
-        device->host_allocator, out_command_buffer);
-  } else {
-    iree_host_size_t queue_index = iree_hal_task_device_select_queue(
-        device, command_categories, queue_affinity);
-    return iree_hal_task_command_buffer_create(
-        iree_hal_device_allocator(base_device),
-        &device->queues[queue_index].scope, mode, command_categories,
-        queue_affinity, binding_capacity, &device->large_block_pool,
-        device->host_allocator, out_command_buffer);
-  }
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, command_categories, queue_affinity);
+  return iree_hal_task_command_buffer_create(
+      iree_hal_device_allocator(base_device),
+      &device->queues[queue_index].scope, mode, command_categories,
+      queue_affinity, binding_capacity, &device->large_block_pool,
+      device->host_allocator, out_command_buffer);
 }
 
 static iree_status_t iree_hal_task_device_create_event(
@@ -332,11 +422,12 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
 
   // Sum up the total worker count across all queues so that the loaders can
-  // preallocate worker-specific storage.
+  // preallocate worker-specific storage. Threads donated to the executors run
+  // tasks with their own worker IDs and need storage as well.
   iree_host_size_t total_worker_count = 0;
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     total_worker_count +=
-        iree_task_executor_worker_count(device->queues[i].executor);
+        iree_task_executor_worker_capacity(device->queues[i].executor);
   }
 
   return iree_hal_local_executable_cache_create(
@@ -348,9 +439,11 @@ static iree_status_t iree_hal_task_device_import_file(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
     iree_hal_external_file_flags_t flags, iree_hal_file_t** out_file) {
-  return iree_hal_file_from_handle(
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  return iree_hal_file_from_handle_with_options(
       iree_hal_device_allocator(base_device), queue_affinity, access, handle,
-      iree_hal_device_host_allocator(base_device), out_file);
+      &device->file_options, iree_hal_device_host_allocator(base_device),
+      out_file);
 }
 
 static iree_status_t iree_hal_task_device_create_semaphore(
@@ -385,15 +478,12 @@ static iree_status_t iree_hal_task_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size, iree_hal_alloca_flags_t flags,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_semaphore_list_wait(wait_semaphore_list, iree_infinite_timeout(),
-                                   IREE_HAL_WAIT_FLAG_DEFAULT));
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                         params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  const iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  return iree_hal_task_queue_submit_alloca(
+      &device->queues[queue_index], base_device, wait_semaphore_list,
+      signal_semaphore_list, params, allocation_size, flags, out_buffer);
 }
 
 static iree_status_t iree_hal_task_device_queue_dealloca(
@@ -401,11 +491,43 @@ static iree_status_t iree_hal_task_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer, iree_hal_dealloca_flags_t flags) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
-      IREE_HAL_EXECUTE_FLAG_NONE));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  const iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
+  return iree_hal_task_queue_submit_dealloca(&device->queues[queue_index],
+                                             wait_semaphore_list,
+                                             signal_semaphore_list, buffer);
+}
+
+// Returns true if a transfer with |file| can be performed directly by the queue
+// using synchronous file I/O on executor workers. Files with device-accessible
+// storage are better handled as copies and files without synchronous I/O need
+// the generic streaming implementation.
+static bool iree_hal_task_device_can_transfer_file(iree_hal_file_t* file) {
+  return iree_hal_file_storage_buffer(file) == NULL &&
+         iree_hal_file_supports_synchronous_io(file);
+}
+
+// Submits a queue file transfer split into chunks based on device parameters.
+static iree_status_t iree_hal_task_device_submit_file_transfer(
+    iree_hal_task_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_task_file_transfer_t transfer) {
+  const iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_TRANSFER, queue_affinity);
+  iree_hal_task_queue_t* queue = &device->queues[queue_index];
+  if (transfer.length == 0) {
+    return iree_hal_task_queue_submit_barrier(queue, wait_semaphore_list,
+                                              signal_semaphore_list);
+  }
+  transfer.chunk_count =
+      device->file_transfer_chunk_count
+          ? device->file_transfer_chunk_count
+          : iree_task_executor_worker_count(queue->executor);
+  transfer.chunk_size = device->file_transfer_chunk_size;
+  return iree_hal_task_queue_submit_file_transfer(
+      queue, wait_semaphore_list, signal_semaphore_list, &transfer);
 }
 
 static iree_status_t iree_hal_task_device_queue_read(
@@ -415,12 +537,30 @@ static iree_status_t iree_hal_task_device_queue_read(
     iree_hal_file_t* source_file, uint64_t source_offset,
     iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
     iree_device_size_t length, iree_hal_read_flags_t flags) {
-  // TODO: expose streaming chunk count/size options.
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (iree_hal_task_device_can_transfer_file(source_file) &&
+      iree_all_bits_set(iree_hal_file_allowed_access(source_file),
+                        IREE_HAL_MEMORY_ACCESS_READ)) {
+    iree_hal_task_file_transfer_t transfer = {
+        .is_write = false,
+        .file = source_file,
+        .file_offset = source_offset,
+        .buffer = target_buffer,
+        .buffer_offset = target_offset,
+        .length = length,
+    };
+    return iree_hal_task_device_submit_file_transfer(
+        device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
+        transfer);
+  }
+
+  // Fall back to the generic implementation for files with storage buffers (as
+  // they can be copied on the queue) and for producing consistent errors.
   iree_status_t loop_status = iree_ok_status();
   iree_hal_file_transfer_options_t options = {
       .loop = iree_loop_inline(&loop_status),
-      .chunk_count = IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT,
-      .chunk_size = IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT,
+      .chunk_count = device->file_transfer_chunk_count,
+      .chunk_size = device->file_transfer_chunk_size,
   };
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_read_streaming(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
@@ -436,12 +576,30 @@ static iree_status_t iree_hal_task_device_queue_write(
     iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
     iree_hal_file_t* target_file, uint64_t target_offset,
     iree_device_size_t length, iree_hal_write_flags_t flags) {
-  // TODO: expose streaming chunk count/size options.
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (iree_hal_task_device_can_transfer_file(target_file) &&
+      iree_all_bits_set(iree_hal_file_allowed_access(target_file),
+                        IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    iree_hal_task_file_transfer_t transfer = {
+        .is_write = true,
+        .file = target_file,
+        .file_offset = target_offset,
+        .buffer = source_buffer,
+        .buffer_offset = source_offset,
+        .length = length,
+    };
+    return iree_hal_task_device_submit_file_transfer(
+        device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
+        transfer);
+  }
+
+  // Fall back to the generic implementation for files with storage buffers (as
+  // they can be copied on the queue) and for producing consistent errors.
   iree_status_t loop_status = iree_ok_status();
   iree_hal_file_transfer_options_t options = {
       .loop = iree_loop_inline(&loop_status),
-      .chunk_count = IREE_HAL_FILE_TRANSFER_CHUNK_COUNT_DEFAULT,
-      .chunk_size = IREE_HAL_FILE_TRANSFER_CHUNK_SIZE_DEFAULT,
+      .chunk_count = device->file_transfer_chunk_count,
+      .chunk_size = device->file_transfer_chunk_size,
   };
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_write_streaming(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
@@ -497,11 +655,119 @@ static iree_status_t iree_hal_task_device_queue_flush(
   return iree_ok_status();
 }
 
+// Returns the executor that waiting threads can be donated to or NULL if the
+// device has no such executor. Semaphores do not track which queue will signal
+// them and donating to an executor that isn't running the waited work would
+// only delay it (or block the waiter on unrelated work) so donation is only
+// possible when all queues share a single executor that has donor slots.
+static iree_task_executor_t* iree_hal_task_device_donation_executor(
+    iree_hal_task_device_t* device) {
+  if (device->queue_count == 0) return NULL;
+  iree_task_executor_t* executor = device->queues[0].executor;
+  for (iree_host_size_t i = 1; i < device->queue_count; ++i) {
+    if (device->queues[i].executor != executor) return NULL;
+  }
+  if (iree_task_executor_worker_capacity(executor) <=
+      iree_task_executor_worker_count(executor)) {
+    return NULL;  // no donor slots
+  }
+  return executor;
+}
+
+// A wait on a list of semaphores that can be donated to an executor.
+// Lives on the stack of the waiting thread for the duration of the wait.
+typedef struct iree_hal_task_device_wait_t {
+  iree_hal_task_device_t* device;
+  iree_hal_wait_mode_t wait_mode;
+  iree_hal_semaphore_list_t semaphore_list;
+  iree_hal_wait_flags_t flags;
+} iree_hal_task_device_wait_t;
+
+// Queries whether |wait| has resolved without blocking or acquiring any
+// timepoints. Failures are reported as soon as any semaphore has failed; the
+// final result of the wait is always taken from a multi-wait.
+static iree_status_code_t iree_hal_task_device_wait_query(
+    const iree_hal_task_device_wait_t* wait) {
+  const iree_hal_semaphore_list_t semaphore_list = wait->semaphore_list;
+  iree_host_size_t reached_count = 0;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    uint64_t current_value = 0;
+    iree_status_t status =
+        iree_hal_semaphore_query(semaphore_list.semaphores[i], &current_value);
+    if (!iree_status_is_ok(status)) {
+      return iree_status_consume_code(status);
+    }
+    if (current_value >= semaphore_list.payload_values[i]) ++reached_count;
+  }
+  const bool resolved = wait->wait_mode == IREE_HAL_WAIT_MODE_ANY
+                            ? reached_count > 0
+                            : reached_count == semaphore_list.count;
+  return resolved || semaphore_list.count == 0 ? IREE_STATUS_OK
+                                               : IREE_STATUS_DEFERRED;
+}
+
+static iree_status_t iree_hal_task_device_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_hal_task_device_wait_t* wait =
+      (iree_hal_task_device_wait_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      *out_wait_status_code = iree_hal_task_device_wait_query(wait);
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_hal_task_semaphore_multi_wait(
+          wait->wait_mode, wait->semaphore_list, timeout, wait->flags,
+          iree_hal_task_device_shared_event_pool(wait->device),
+          &wait->device->large_block_pool);
+    }
+    case IREE_WAIT_SOURCE_COMMAND_EXPORT: {
+      const iree_wait_primitive_type_t target_type =
+          ((const iree_wait_source_export_params_t*)params)->target_type;
+      iree_wait_primitive_t* out_wait_primitive =
+          (iree_wait_primitive_t*)inout_ptr;
+      memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "requested wait primitive type %d is unavailable",
+                              (int)target_type);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
 static iree_status_t iree_hal_task_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
     iree_hal_wait_flags_t flags) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+
+  // If the executor accepts donated threads then help it make progress on the
+  // work we are waiting for instead of sleeping. The donor polls the whole
+  // list between tasks and blocks with the same multi-wait (and |flags|) as a
+  // plain wait when there's nothing to steal so both wait modes are supported.
+  iree_task_executor_t* executor =
+      iree_hal_task_device_donation_executor(device);
+  if (executor) {
+    iree_hal_task_device_wait_t wait = {
+        .device = device,
+        .wait_mode = wait_mode,
+        .semaphore_list = semaphore_list,
+        .flags = flags,
+    };
+    iree_wait_source_t wait_source = {
+        .self = &wait,
+        .data = 0,
+        .ctl = iree_hal_task_device_wait_source_ctl,
+    };
+    return iree_task_executor_donate_caller(executor, wait_source, timeout);
+  }
+
   return iree_hal_task_semaphore_multi_wait(
       wait_mode, semaphore_list, timeout, flags,
       iree_hal_task_device_shared_event_pool(device),
@@ -10,6 +10,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/task/executor.h"
 
 #ifdef __cplusplus
@@ -25,6 +26,22 @@ typedef struct iree_hal_task_device_params_t {
   iree_host_size_t arena_block_size;
   // Default flags for the iree_task_scope_t used for each queue.
   iree_task_scope_flags_t queue_scope_flags;
+  // Queues whose tasks are scheduled at IREE_TASK_PRIORITY_HIGH or
+  // IREE_TASK_PRIORITY_LOW, overriding any priority in |queue_scope_flags|.
+  // Submissions select their priority by the queue affinity they target. Queues
+  // of different priorities sharing an executor let latency-sensitive work run
+  // ahead of batch work submitted to the same device.
+  iree_hal_queue_affinity_t high_priority_queues;
+  iree_hal_queue_affinity_t low_priority_queues;
+  // Maximum number of chunks a queue file read/write is split into. Each chunk
+  // is transferred by an executor worker concurrently with the others.
+  // 0 uses one chunk per worker in the queue executor.
+  iree_host_size_t file_transfer_chunk_count;
+  // Maximum size in bytes of each individual file I/O operation performed by
+  // queue file reads/writes. 0 selects a default.
+  iree_device_size_t file_transfer_chunk_size;
+  // Options for files imported from handles, such as io_uring direct I/O.
+  iree_hal_file_registry_options_t file_options;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -0,0 +1,307 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_device.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Tracks host calls made on a queue and which of them ran on the thread that
+// waited for them.
+struct HostCallState {
+  std::thread::id waiter_thread_id;
+  std::chrono::milliseconds duration;
+  std::atomic<int> call_count = {0};
+  std::atomic<int> waiter_call_count = {0};
+  // Optional calls whose count is recorded when each call runs.
+  HostCallState* observed = nullptr;
+  std::atomic<int> observed_call_count = {-1};
+};
+
+static iree_status_t HostCall(void* user_data, const uint64_t args[4],
+                              iree_hal_host_call_context_t* context) {
+  HostCallState* state = (HostCallState*)user_data;
+  std::this_thread::sleep_for(state->duration);
+  if (std::this_thread::get_id() == state->waiter_thread_id) {
+    ++state->waiter_call_count;
+  }
+  if (state->observed) {
+    state->observed_call_count = state->observed->call_count.load();
+  }
+  ++state->call_count;
+  return iree_ok_status();
+}
+
+class TaskDeviceTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    for (iree_hal_semaphore_t* semaphore : semaphores_) {
+      iree_hal_semaphore_release(semaphore);
+    }
+    if (device_) iree_hal_device_release(device_);
+    if (device_allocator_) iree_hal_allocator_release(device_allocator_);
+    for (iree_task_executor_t* executor : executors_) {
+      iree_task_executor_release(executor);
+    }
+  }
+
+  // Creates |executor_count| executors with a single worker and a single donor
+  // slot each and a device with one queue per executor.
+  void CreateDevice(iree_host_size_t executor_count) {
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    CreateDevice(executor_count, &params, /*queue_count=*/executor_count);
+  }
+
+  // Creates |executor_count| executors as above and a device with
+  // |queue_count| queues sharing them round-robin.
+  void CreateDevice(iree_host_size_t executor_count,
+                    const iree_hal_task_device_params_t* params,
+                    iree_host_size_t queue_count) {
+    for (iree_host_size_t i = 0; i < executor_count; ++i) {
+      iree_task_topology_t topology;
+      iree_task_topology_initialize_from_group_count(/*group_count=*/1,
+                                                     &topology);
+      iree_task_executor_options_t options;
+      iree_task_executor_options_initialize(&options);
+      options.donor_count = 1;
+      iree_task_executor_t* executor = NULL;
+      iree_status_t status = iree_task_executor_create(
+          options, &topology, iree_allocator_system(), &executor);
+      iree_task_topology_deinitialize(&topology);
+      IREE_ASSERT_OK(status);
+      executors_.push_back(executor);
+    }
+
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("test"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+
+    std::vector<iree_task_executor_t*> queue_executors(queue_count);
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
+      queue_executors[i] = executors_[i % executors_.size()];
+    }
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("local-task"), params, queue_count,
+        queue_executors.data(), /*loader_count=*/0, /*loaders=*/NULL,
+        device_allocator_, iree_allocator_system(), &device_));
+  }
+
+  // Enqueues |count| independent host calls on the queue selected by
+  // |queue_affinity| and returns the list of semaphores signaled by them.
+  iree_hal_semaphore_list_t EnqueueHostCalls(
+      iree_hal_queue_affinity_t queue_affinity, int count,
+      HostCallState* state) {
+    iree_host_size_t first_index = semaphores_.size();
+    for (int i = 0; i < count; ++i) {
+      iree_hal_semaphore_t* semaphore = NULL;
+      IREE_CHECK_OK(iree_hal_semaphore_create(
+          device_, IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+          IREE_HAL_SEMAPHORE_FLAG_DEFAULT, &semaphore));
+      semaphores_.push_back(semaphore);
+      payload_values_.push_back(1ull);
+    }
+    for (int i = 0; i < count; ++i) {
+      iree_hal_semaphore_list_t signal_list = {
+          1, &semaphores_[first_index + i], &payload_values_[first_index + i]};
+      const uint64_t args[4] = {0};
+      IREE_CHECK_OK(iree_hal_device_queue_host_call(
+          device_, queue_affinity, iree_hal_semaphore_list_empty(),
+          signal_list, iree_hal_make_host_call(HostCall, state), args,
+          IREE_HAL_HOST_CALL_FLAG_NONE));
+    }
+    iree_hal_semaphore_list_t list = {(iree_host_size_t)count,
+                                      &semaphores_[first_index],
+                                      &payload_values_[first_index]};
+    return list;
+  }
+
+  std::vector<iree_task_executor_t*> executors_;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  std::vector<iree_hal_semaphore_t*> semaphores_;
+  std::vector<uint64_t> payload_values_;
+};
+
+// Tests that a thread waiting on the device helps the executor shared by all
+// queues run the work it is waiting on.
+TEST_F(TaskDeviceTest, WaitDonatesToSharedExecutor) {
+  CreateDevice(/*executor_count=*/1);
+
+  // All calls land on the single worker; each takes long enough that the
+  // waiter has time to steal some of the others.
+  HostCallState state;
+  state.waiter_thread_id = std::this_thread::get_id();
+  state.duration = std::chrono::milliseconds(2);
+  semaphores_.reserve(16);
+  payload_values_.reserve(16);
+  iree_hal_semaphore_list_t wait_list =
+      EnqueueHostCalls(IREE_HAL_QUEUE_AFFINITY_ANY, /*count=*/16, &state);
+
+  IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+      device_, IREE_HAL_WAIT_MODE_ALL, wait_list, iree_infinite_timeout(),
+      IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_EQ(state.call_count.load(), 16);
+  EXPECT_GT(state.waiter_call_count.load(), 0);
+}
+
+// Tests that a thread waiting for any of several semaphores also helps the
+// executor run the work it is waiting on.
+TEST_F(TaskDeviceTest, WaitAnyDonatesToSharedExecutor) {
+  CreateDevice(/*executor_count=*/1);
+
+  HostCallState state;
+  state.waiter_thread_id = std::this_thread::get_id();
+  state.duration = std::chrono::milliseconds(2);
+  semaphores_.reserve(32);
+  payload_values_.reserve(32);
+  iree_hal_semaphore_list_t busy_list =
+      EnqueueHostCalls(IREE_HAL_QUEUE_AFFINITY_ANY, /*count=*/16, &state);
+  iree_hal_semaphore_list_t wait_list =
+      EnqueueHostCalls(IREE_HAL_QUEUE_AFFINITY_ANY, /*count=*/16, &state);
+
+  // Any one of the later calls is enough but the single worker needs to get
+  // through many calls before it reaches them; the waiter steals some.
+  IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+      device_, IREE_HAL_WAIT_MODE_ANY, wait_list, iree_infinite_timeout(),
+      IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_GT(state.waiter_call_count.load(), 0);
+
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait(
+      busy_list, iree_infinite_timeout(), IREE_HAL_WAIT_FLAG_DEFAULT));
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait(
+      wait_list, iree_infinite_timeout(), IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_EQ(state.call_count.load(), 32);
+}
+
+// Tests that the caller's wait flags are honored by donated waits.
+TEST_F(TaskDeviceTest, WaitActiveDonatesToSharedExecutor) {
+  CreateDevice(/*executor_count=*/1);
+
+  HostCallState state;
+  state.waiter_thread_id = std::this_thread::get_id();
+  state.duration = std::chrono::milliseconds(2);
+  semaphores_.reserve(16);
+  payload_values_.reserve(16);
+  iree_hal_semaphore_list_t wait_list =
+      EnqueueHostCalls(IREE_HAL_QUEUE_AFFINITY_ANY, /*count=*/16, &state);
+
+  IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+      device_, IREE_HAL_WAIT_MODE_ALL, wait_list, iree_infinite_timeout(),
+      IREE_HAL_WAIT_FLAG_ACTIVE));
+  EXPECT_EQ(state.call_count.load(), 16);
+  EXPECT_GT(state.waiter_call_count.load(), 0);
+
+  // A timed out wait reports DEADLINE_EXCEEDED through the donor as well.
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+      IREE_HAL_SEMAPHORE_FLAG_DEFAULT, &semaphore));
+  semaphores_.push_back(semaphore);
+  uint64_t payload_value = 1ull;
+  iree_hal_semaphore_list_t pending_list = {1, &semaphore, &payload_value};
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree::Status(iree_hal_device_wait_semaphores(
+          device_, IREE_HAL_WAIT_MODE_ANY, pending_list,
+          iree_make_timeout_ms(5), IREE_HAL_WAIT_FLAG_ACTIVE)));
+}
+
+// Tests that a thread waiting on the device does not run work from executors
+// other than the one it is waiting on. The device cannot tell which queue will
+// signal a semaphore and must not donate the waiter to any of them.
+TEST_F(TaskDeviceTest, WaitDoesNotDonateToOtherExecutors) {
+  CreateDevice(/*executor_count=*/2);
+
+  // Queue 0 is kept busy with work the waiter could steal while queue 1 runs
+  // the slower call the waiter is waiting on. The device selects queues by
+  // affinity modulo the queue count.
+  HostCallState busy_state;
+  busy_state.waiter_thread_id = std::this_thread::get_id();
+  busy_state.duration = std::chrono::milliseconds(2);
+  HostCallState waited_state;
+  waited_state.waiter_thread_id = std::this_thread::get_id();
+  waited_state.duration = std::chrono::milliseconds(20);
+  semaphores_.reserve(17);
+  payload_values_.reserve(17);
+  iree_hal_semaphore_list_t busy_list =
+      EnqueueHostCalls(/*queue_affinity=*/2ull, /*count=*/16, &busy_state);
+  iree_hal_semaphore_list_t waited_list =
+      EnqueueHostCalls(/*queue_affinity=*/1ull, /*count=*/1, &waited_state);
+
+  IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+      device_, IREE_HAL_WAIT_MODE_ALL, waited_list, iree_infinite_timeout(),
+      IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_EQ(waited_state.call_count.load(), 1);
+  EXPECT_EQ(busy_state.waiter_call_count.load(), 0);
+
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait(
+      busy_list, iree_infinite_timeout(), IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_EQ(busy_state.call_count.load(), 16);
+  EXPECT_EQ(busy_state.waiter_call_count.load(), 0);
+}
+
+// Tests that work submitted to a high priority queue runs ahead of work
+// already submitted to a low priority queue sharing the same executor.
+TEST_F(TaskDeviceTest, HighPriorityQueueRunsAhead) {
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  params.low_priority_queues = 1ull << 0;
+  params.high_priority_queues = 1ull << 1;
+  CreateDevice(/*executor_count=*/1, &params, /*queue_count=*/2);
+
+  // The device selects queues by affinity modulo the queue count.
+  HostCallState low_state;
+  low_state.duration = std::chrono::milliseconds(5);
+  HostCallState high_state;
+  high_state.duration = std::chrono::milliseconds(0);
+  high_state.observed = &low_state;
+  semaphores_.reserve(11);
+  payload_values_.reserve(11);
+  iree_hal_semaphore_list_t low_list =
+      EnqueueHostCalls(/*queue_affinity=*/2ull, /*count=*/10, &low_state);
+  iree_hal_semaphore_list_t high_list =
+      EnqueueHostCalls(/*queue_affinity=*/1ull, /*count=*/1, &high_state);
+
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait(
+      high_list, iree_infinite_timeout(), IREE_HAL_WAIT_FLAG_DEFAULT));
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait(
+      low_list, iree_infinite_timeout(), IREE_HAL_WAIT_FLAG_DEFAULT));
+  EXPECT_EQ(low_state.call_count.load(), 10);
+  EXPECT_EQ(high_state.call_count.load(), 1);
+  EXPECT_LT(high_state.observed_call_count.load(), 10);
+}
+
+// Tests that a queue cannot be both high and low priority.
+TEST_F(TaskDeviceTest, ConflictingQueuePriorities) {
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("test"), iree_allocator_system(),
+      iree_allocator_system(), &device_allocator_));
+  iree_hal_task_device_params_t params;
+  iree_hal_task_device_params_initialize(&params);
+  params.low_priority_queues = 1ull << 0;
+  params.high_priority_queues = 1ull << 0;
+  iree_task_executor_t* executor = NULL;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_INVALID_ARGUMENT,
+      iree::Status(iree_hal_task_device_create(
+          iree_make_cstring_view("local-task"), &params, /*queue_count=*/1,
+          &executor, /*loader_count=*/0, /*loaders=*/NULL, device_allocator_,
+          iree_allocator_system(), &device_)));
+}
+
+}  // namespace
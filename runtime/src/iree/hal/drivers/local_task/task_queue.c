@@ -11,7 +11,6 @@
 
 #include "iree/hal/drivers/local_task/task_command_buffer.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
-#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/resource_set.h"
 #include "iree/task/submission.h"
 
@@ -198,66 +197,6 @@ typedef struct iree_hal_task_queue_issue_cmd_t {
   iree_hal_buffer_binding_table_t binding_table;
 } iree_hal_task_queue_issue_cmd_t;
 
-static iree_status_t iree_hal_task_queue_issue_cmd_deferred(
-    iree_hal_task_queue_issue_cmd_t* cmd,
-    iree_hal_command_buffer_t* command_buffer,
-    iree_hal_buffer_binding_table_t binding_table,
-    iree_task_submission_t* pending_submission) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-
-  // Create a transient command buffer that we'll apply the deferred commands
-  // into. It will live beyond this function as we'll issue the commands but
-  // they may not run immediately.
-  iree_hal_command_buffer_t* task_command_buffer = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_hal_task_command_buffer_create(
-          cmd->queue->device_allocator, &cmd->queue->scope,
-          iree_hal_command_buffer_mode(command_buffer) |
-              IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
-              IREE_HAL_COMMAND_BUFFER_MODE_UNRETAINED |
-              // NOTE: we need to validate if a binding table is provided as the
-              // bindings were not known when it was originally recorded.
-              (iree_hal_buffer_binding_table_is_empty(binding_table)
-                   ? IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED
-                   : 0),
-          iree_hal_command_buffer_allowed_categories(command_buffer),
-          cmd->queue->affinity, /*binding_capacity=*/0,
-          cmd->queue->large_block_pool,
-          iree_hal_allocator_host_allocator(cmd->queue->device_allocator),
-          &task_command_buffer));
-
-  // Keep the command buffer live until the queue operation completes.
-  iree_status_t status =
-      iree_hal_resource_set_insert(cmd->resource_set, 1, &task_command_buffer);
-  if (!iree_status_is_ok(status)) {
-    iree_hal_command_buffer_release(task_command_buffer);
-    IREE_TRACE_ZONE_END(z0);
-    return status;
-  }
-
-  // Replay the commands from the deferred command buffer into the new task one.
-  // This creates the task graph and captures the binding references but does
-  // not yet issue the commands.
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_deferred_command_buffer_apply(
-              command_buffer, task_command_buffer, binding_table));
-
-  // Issue the task command buffer as if it had been recorded directly to begin
-  // with.
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_task_command_buffer_issue(task_command_buffer,
-                                             &cmd->queue->state,
-                                             cmd->task.header.completion_task,
-                                             cmd->arena, pending_submission));
-
-  // Still retained in the resource set until retirement.
-  iree_hal_command_buffer_release(task_command_buffer);
-
-  IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
-}
-
 // Issues a set of command buffers without waiting for them to complete.
 static iree_status_t iree_hal_task_queue_issue_cmd(
     void* user_context, iree_task_t* task,
@@ -270,18 +209,10 @@ static iree_status_t iree_hal_task_queue_issue_cmd(
   iree_status_t status = iree_ok_status();
   if (cmd->command_buffer != NULL) {
     if (iree_hal_task_command_buffer_isa(cmd->command_buffer)) {
-      if (cmd->binding_table.count > 0) {
-        status = iree_make_status(
-            IREE_STATUS_UNIMPLEMENTED,
-            "task command buffers do not support binding tables yet");
-      } else {
-        status = iree_hal_task_command_buffer_issue(
-            cmd->command_buffer, &cmd->queue->state,
-            cmd->task.header.completion_task, cmd->arena, pending_submission);
-      }
-    } else if (iree_hal_deferred_command_buffer_isa(cmd->command_buffer)) {
-      status = iree_hal_task_queue_issue_cmd_deferred(
-          cmd, cmd->command_buffer, cmd->binding_table, pending_submission);
+      status = iree_hal_task_command_buffer_issue(
+          cmd->command_buffer, cmd->binding_table, &cmd->queue->state,
+          cmd->task.header.completion_task, cmd->arena, cmd->resource_set,
+          pending_submission);
     } else {
       status = iree_make_status(
           IREE_STATUS_UNIMPLEMENTED,
@@ -412,7 +343,7 @@ static void iree_hal_task_queue_retire_cmd_cleanup(
   // Release resources now that all are known to have retired.
   // In success cases we try to do this eagerly to allow for more potential
   // reuse but during full/partial failures they may still be live here.
-  if (!cmd->resource_set) {
+  if (cmd->resource_set) {
     iree_hal_resource_set_free(cmd->resource_set);
     cmd->resource_set = NULL;
   }
@@ -652,23 +583,119 @@ static iree_status_t iree_hal_task_queue_host_call_cmd_allocate(
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_task_queue_transfer_cmd_t
+//===----------------------------------------------------------------------===//
+
+// Task to transfer data between a file and a buffer.
+// The transfer is split into one tile per chunk of the total length and each
+// tile is processed by whichever worker picks it up. Since file I/O is
+// synchronous the workers processing tiles are blocked until their I/O
+// completes but the submitting thread and the rest of the executor are not.
+typedef struct iree_hal_task_queue_transfer_cmd_t {
+  // Dispatch to iree_hal_task_queue_transfer_cmd_tile.
+  iree_task_dispatch_t task;
+
+  // Transfer being performed. The file and buffer are retained by the
+  // submission resource set.
+  iree_hal_task_file_transfer_t transfer;
+
+  // Number of bytes of the transfer processed by each tile. The last tile may
+  // process fewer bytes.
+  iree_device_size_t tile_length;
+} iree_hal_task_queue_transfer_cmd_t;
+
+// Transfers the range of the file covered by the tile in chunks.
+static iree_status_t iree_hal_task_queue_transfer_cmd_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_task_queue_transfer_cmd_t* cmd =
+      (const iree_hal_task_queue_transfer_cmd_t*)user_context;
+  const iree_hal_task_file_transfer_t* transfer = &cmd->transfer;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_device_size_t tile_offset =
+      (iree_device_size_t)tile_context->workgroup_xyz[0] * cmd->tile_length;
+  const iree_device_size_t tile_end =
+      iree_min(tile_offset + cmd->tile_length, transfer->length);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)(tile_end - tile_offset));
+
+  iree_status_t status = iree_ok_status();
+  for (iree_device_size_t offset = tile_offset;
+       offset < tile_end && iree_status_is_ok(status);
+       offset += transfer->chunk_size) {
+    const iree_device_size_t length =
+        iree_min(transfer->chunk_size, tile_end - offset);
+    const uint64_t file_offset = transfer->file_offset + offset;
+    const iree_device_size_t buffer_offset = transfer->buffer_offset + offset;
+    if (transfer->is_write) {
+      status = iree_hal_file_write(transfer->file, file_offset,
+                                   transfer->buffer, buffer_offset, length);
+    } else {
+      status = iree_hal_file_read(transfer->file, file_offset, transfer->buffer,
+                                  buffer_offset, length);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Allocates and initializes a iree_hal_task_queue_transfer_cmd_t task.
+static iree_status_t iree_hal_task_queue_transfer_cmd_allocate(
+    void* user_data, iree_task_scope_t* scope, iree_hal_task_queue_t* queue,
+    iree_task_t* retire_task, iree_arena_allocator_t* arena,
+    iree_hal_resource_set_t* resource_set, iree_task_t** out_issue_task) {
+  const iree_hal_task_file_transfer_t* transfer =
+      (const iree_hal_task_file_transfer_t*)user_data;
+
+  iree_hal_task_queue_transfer_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(arena, sizeof(*cmd), (void**)&cmd));
+  cmd->transfer = *transfer;
+
+  // Split the transfer into at most chunk_count tiles of at least one chunk
+  // each so that small transfers don't fan out across the executor.
+  iree_device_size_t tile_count =
+      iree_device_size_ceil_div(transfer->length, transfer->chunk_size);
+  tile_count = iree_max(1, iree_min(tile_count, transfer->chunk_count));
+  cmd->tile_length = iree_device_size_ceil_div(transfer->length, tile_count);
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)tile_count, 1, 1};
+  iree_task_dispatch_initialize(
+      scope,
+      iree_task_make_dispatch_closure(iree_hal_task_queue_transfer_cmd_tile,
+                                      cmd),
+      workgroup_size, workgroup_count, &cmd->task);
+  iree_task_set_completion_task(&cmd->task.header, retire_task);
+
+  *out_issue_task = &cmd->task.header;
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_task_queue_t
 //===----------------------------------------------------------------------===//
 
-void iree_hal_task_queue_initialize(iree_string_view_t identifier,
-                                    iree_hal_queue_affinity_t affinity,
-                                    iree_task_scope_flags_t scope_flags,
-                                    iree_task_executor_t* executor,
-                                    iree_arena_block_pool_t* small_block_pool,
-                                    iree_arena_block_pool_t* large_block_pool,
-                                    iree_hal_allocator_t* device_allocator,
-                                    iree_hal_task_queue_t* out_queue) {
+iree_status_t iree_hal_task_queue_initialize(
+    iree_string_view_t identifier, iree_hal_queue_affinity_t affinity,
+    iree_task_scope_flags_t scope_flags, iree_task_executor_t* executor,
+    iree_arena_block_pool_t* small_block_pool,
+    iree_arena_block_pool_t* large_block_pool,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_task_queue_t* out_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
 
   memset(out_queue, 0, sizeof(*out_queue));
 
+  // The pool is the only fallible part of initialization so we create it first
+  // and leave the queue zeroed if it fails.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_queue_pool_create(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS,
+                                 host_allocator, &out_queue->alloca_pool));
+
   out_queue->affinity = affinity;
   out_queue->executor = executor;
   iree_task_executor_retain(out_queue->executor);
@@ -682,6 +709,7 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
   iree_hal_task_queue_state_initialize(&out_queue->state);
 
   IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
@@ -692,6 +720,7 @@ void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
 
   iree_hal_task_queue_state_deinitialize(&queue->state);
   iree_task_scope_deinitialize(&queue->scope);
+  iree_hal_queue_pool_release(queue->alloca_pool);
   iree_hal_allocator_release(queue->device_allocator);
   iree_task_executor_release(queue->executor);
 
@@ -700,6 +729,7 @@ void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
 
 void iree_hal_task_queue_trim(iree_hal_task_queue_t* queue) {
   IREE_ASSERT_ARGUMENT(queue);
+  iree_hal_queue_pool_trim(queue->alloca_pool);
   iree_task_executor_trim(queue->executor);
 }
 
@@ -797,6 +827,67 @@ iree_status_t iree_hal_task_queue_submit_barrier(
   return status;
 }
 
+iree_status_t iree_hal_task_queue_submit_alloca(
+    iree_hal_task_queue_t* queue, iree_hal_device_t* device,
+    iree_hal_semaphore_list_t wait_semaphores,
+    iree_hal_semaphore_list_t signal_semaphores,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_alloca_flags_t flags, iree_hal_buffer_t** out_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Memory is reserved from the pool immediately: any block we get back is
+  // only reused if it was released at a timepoint the allocation is ordered
+  // after. The queue operation itself is then just a barrier.
+  iree_hal_buffer_placement_t placement = {
+      .device = device,
+      .queue_affinity = queue->affinity,
+      .flags = IREE_HAL_BUFFER_PLACEMENT_FLAG_ASYNCHRONOUS,
+  };
+  if (iree_all_bits_set(flags, IREE_HAL_ALLOCA_FLAG_INDETERMINATE_LIFETIME)) {
+    placement.flags |= IREE_HAL_BUFFER_PLACEMENT_FLAG_INDETERMINATE_LIFETIME;
+  }
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_queue_pool_acquire(queue->alloca_pool,
+                                      queue->device_allocator, placement,
+                                      wait_semaphores, params, allocation_size,
+                                      &buffer));
+
+  iree_status_t status = iree_hal_task_queue_submit_barrier(
+      queue, wait_semaphores, signal_semaphores);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_task_queue_submit_dealloca(
+    iree_hal_task_queue_t* queue, iree_hal_semaphore_list_t wait_semaphores,
+    iree_hal_semaphore_list_t signal_semaphores, iree_hal_buffer_t* buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The buffer is dead once the waits are satisfied and the signals are only
+  // reached after that, so either list orders users after the deallocation.
+  // We prefer the signals as that's what subsequent allocations will usually
+  // be waiting on.
+  iree_hal_semaphore_list_t release_semaphores =
+      signal_semaphores.count > 0 ? signal_semaphores : wait_semaphores;
+  iree_status_t status = iree_hal_queue_pool_release_buffer(
+      queue->alloca_pool, buffer, release_semaphores);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_task_queue_submit_barrier(queue, wait_semaphores,
+                                                signal_semaphores);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_task_queue_submit_batches(
     iree_hal_task_queue_t* queue, iree_host_size_t batch_count,
     const iree_hal_task_submission_batch_t* batches) {
@@ -813,6 +904,26 @@ static iree_status_t iree_hal_task_queue_submit_batches(
   return iree_ok_status();
 }
 
+iree_status_t iree_hal_task_queue_submit_file_transfer(
+    iree_hal_task_queue_t* queue, iree_hal_semaphore_list_t wait_semaphores,
+    iree_hal_semaphore_list_t signal_semaphores,
+    const iree_hal_task_file_transfer_t* transfer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer->length);
+  iree_hal_resource_t* resources[2] = {
+      (iree_hal_resource_t*)transfer->file,
+      (iree_hal_resource_t*)transfer->buffer,
+  };
+  iree_status_t status = iree_hal_task_queue_submit(
+      queue, wait_semaphores, signal_semaphores, IREE_ARRAYSIZE(resources),
+      resources, iree_hal_task_queue_transfer_cmd_allocate, (void*)transfer);
+  if (iree_status_is_ok(status)) {
+    iree_task_executor_flush(queue->executor);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_task_queue_submit_commands(
     iree_hal_task_queue_t* queue, iree_host_size_t batch_count,
     const iree_hal_task_submission_batch_t* batches) {
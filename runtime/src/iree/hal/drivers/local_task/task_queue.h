@@ -14,6 +14,7 @@
 #include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
+#include "iree/hal/utils/queue_pool.h"
 #include "iree/task/executor.h"
 #include "iree/task/scope.h"
 #include "iree/task/task.h"
@@ -39,6 +40,27 @@ typedef struct iree_hal_task_submission_batch_t {
   iree_hal_semaphore_list_t signal_semaphores;
 } iree_hal_task_submission_batch_t;
 
+// A file transfer to or from a buffer performed by the queue.
+// Transfers are split into tiles processed concurrently by executor workers
+// using synchronous file I/O.
+typedef struct iree_hal_task_file_transfer_t {
+  // True if transferring from |buffer| into |file| and otherwise from |file|
+  // into |buffer|.
+  bool is_write;
+  // File to read from or write to. Must support synchronous I/O.
+  iree_hal_file_t* file;
+  uint64_t file_offset;
+  // Host-mappable buffer to write to or read from.
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t buffer_offset;
+  // Total length of the transfer in bytes.
+  iree_device_size_t length;
+  // Maximum number of tiles the transfer is split into.
+  iree_host_size_t chunk_count;
+  // Maximum number of bytes transferred by each file operation.
+  iree_device_size_t chunk_size;
+} iree_hal_task_file_transfer_t;
+
 typedef struct iree_hal_task_queue_t {
   // Affinity mask this queue processes.
   iree_hal_queue_affinity_t affinity;
@@ -54,6 +76,11 @@ typedef struct iree_hal_task_queue_t {
   // Device allocator used for transient allocations/tracking.
   iree_hal_allocator_t* device_allocator;
 
+  // Pool used for queue-ordered allocations. Memory deallocated on the queue
+  // is returned here tagged with the dealloca timepoints and reused by
+  // allocations ordered after them.
+  iree_hal_queue_pool_t* alloca_pool;
+
   // Scope used for all tasks in the queue.
   // This allows for easy waits on all outstanding queue tasks as well as
   // differentiation of tasks within the executor.
@@ -65,14 +92,13 @@ typedef struct iree_hal_task_queue_t {
   iree_hal_task_queue_state_t state;
 } iree_hal_task_queue_t;
 
-void iree_hal_task_queue_initialize(iree_string_view_t identifier,
-                                    iree_hal_queue_affinity_t affinity,
-                                    iree_task_scope_flags_t scope_flags,
-                                    iree_task_executor_t* executor,
-                                    iree_arena_block_pool_t* small_block_pool,
-                                    iree_arena_block_pool_t* large_block_pool,
-                                    iree_hal_allocator_t* device_allocator,
-                                    iree_hal_task_queue_t* out_queue);
+iree_status_t iree_hal_task_queue_initialize(
+    iree_string_view_t identifier, iree_hal_queue_affinity_t affinity,
+    iree_task_scope_flags_t scope_flags, iree_task_executor_t* executor,
+    iree_arena_block_pool_t* small_block_pool,
+    iree_arena_block_pool_t* large_block_pool,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_task_queue_t* out_queue);
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue);
 
@@ -82,6 +108,31 @@ iree_status_t iree_hal_task_queue_submit_barrier(
     iree_hal_task_queue_t* queue, iree_hal_semaphore_list_t wait_semaphores,
     iree_hal_semaphore_list_t signal_semaphores);
 
+// Allocates a buffer that is usable by work waiting on |signal_semaphores|.
+// The allocation is made from the queue pool without blocking: memory
+// deallocated at a timepoint covered by |wait_semaphores| may be reused.
+iree_status_t iree_hal_task_queue_submit_alloca(
+    iree_hal_task_queue_t* queue, iree_hal_device_t* device,
+    iree_hal_semaphore_list_t wait_semaphores,
+    iree_hal_semaphore_list_t signal_semaphores,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_alloca_flags_t flags, iree_hal_buffer_t** out_buffer);
+
+// Deallocates |buffer| once |wait_semaphores| are reached. The memory is
+// returned to the queue pool immediately and may be reused by any work ordered
+// after |signal_semaphores|.
+iree_status_t iree_hal_task_queue_submit_dealloca(
+    iree_hal_task_queue_t* queue, iree_hal_semaphore_list_t wait_semaphores,
+    iree_hal_semaphore_list_t signal_semaphores, iree_hal_buffer_t* buffer);
+
+// Performs |transfer| on executor workers once |wait_semaphores| are reached
+// and signals |signal_semaphores| when it has completed. The file and buffer
+// are retained until the transfer retires.
+iree_status_t iree_hal_task_queue_submit_file_transfer(
+    iree_hal_task_queue_t* queue, iree_hal_semaphore_list_t wait_semaphores,
+    iree_hal_semaphore_list_t signal_semaphores,
+    const iree_hal_task_file_transfer_t* transfer);
+
 iree_status_t iree_hal_task_queue_submit_commands(
     iree_hal_task_queue_t* queue, iree_host_size_t batch_count,
     const iree_hal_task_submission_batch_t* batches);
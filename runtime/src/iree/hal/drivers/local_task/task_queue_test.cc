@@ -0,0 +1,448 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using ::iree::Status;
+using ::iree::StatusCode;
+using ::iree::testing::status::StatusIs;
+using ::testing::ContainerEq;
+
+//===----------------------------------------------------------------------===//
+// TestFile
+//===----------------------------------------------------------------------===//
+
+// Host memory-backed file that only supports synchronous I/O so that queue
+// reads and writes take the tiled transfer path. Each I/O operation is recorded
+// and operations touching |fail_offset| fail. |destroyed| is set, if provided,
+// when the last reference is released.
+struct TestFile {
+  iree_hal_resource_t resource;
+  std::vector<uint8_t> contents;
+  uint64_t fail_offset = UINT64_MAX;
+  std::atomic<bool>* destroyed = nullptr;
+  std::mutex mutex;
+  std::vector<std::pair<uint64_t, iree_device_size_t>> operations;
+};
+
+static TestFile* TestFileCast(iree_hal_file_t* file) {
+  return reinterpret_cast<TestFile*>(file);
+}
+
+static void TestFileDestroy(iree_hal_file_t* base_file) {
+  TestFile* file = TestFileCast(base_file);
+  if (file->destroyed) file->destroyed->store(true);
+  delete file;
+}
+
+static iree_hal_memory_access_t TestFileAllowedAccess(iree_hal_file_t* file) {
+  return IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE;
+}
+
+static uint64_t TestFileLength(iree_hal_file_t* file) {
+  return TestFileCast(file)->contents.size();
+}
+
+static iree_hal_buffer_t* TestFileStorageBuffer(iree_hal_file_t* file) {
+  return NULL;
+}
+
+static bool TestFileSupportsSynchronousIO(iree_hal_file_t* file) {
+  return true;
+}
+
+// Records the operation and fails if it covers the failure offset.
+static iree_status_t TestFileBeginOperation(TestFile* file,
+                                            uint64_t file_offset,
+                                            iree_device_size_t length) {
+  std::lock_guard<std::mutex> lock(file->mutex);
+  file->operations.push_back({file_offset, length});
+  if (file->fail_offset >= file_offset &&
+      file->fail_offset < file_offset + length) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS, "injected I/O failure");
+  }
+  if (file_offset + length > file->contents.size()) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "I/O past end of file");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t TestFileRead(iree_hal_file_t* base_file,
+                                  uint64_t file_offset,
+                                  iree_hal_buffer_t* buffer,
+                                  iree_device_size_t buffer_offset,
+                                  iree_device_size_t length) {
+  TestFile* file = TestFileCast(base_file);
+  IREE_RETURN_IF_ERROR(TestFileBeginOperation(file, file_offset, length));
+  return iree_hal_buffer_map_write(buffer, buffer_offset,
+                                   file->contents.data() + file_offset, length);
+}
+
+static iree_status_t TestFileWrite(iree_hal_file_t* base_file,
+                                   uint64_t file_offset,
+                                   iree_hal_buffer_t* buffer,
+                                   iree_device_size_t buffer_offset,
+                                   iree_device_size_t length) {
+  TestFile* file = TestFileCast(base_file);
+  IREE_RETURN_IF_ERROR(TestFileBeginOperation(file, file_offset, length));
+  return iree_hal_buffer_map_read(buffer, buffer_offset,
+                                  file->contents.data() + file_offset, length);
+}
+
+static const iree_hal_file_vtable_t kTestFileVtable = {
+    /*.destroy=*/TestFileDestroy,
+    /*.allowed_access=*/TestFileAllowedAccess,
+    /*.length=*/TestFileLength,
+    /*.storage_buffer=*/TestFileStorageBuffer,
+    /*.supports_synchronous_io=*/TestFileSupportsSynchronousIO,
+    /*.read=*/TestFileRead,
+    /*.write=*/TestFileWrite,
+};
+
+//===----------------------------------------------------------------------===//
+// Queue file transfers
+//===----------------------------------------------------------------------===//
+
+// Tests the tiled queue_read/queue_write path used for files that support
+// synchronous I/O. The device is configured with small chunks so that modest
+// transfers are split across several tiles and several chunks per tile.
+class TaskQueueFileTransferTest : public ::testing::Test {
+ protected:
+  static constexpr iree_host_size_t kChunkCount = 4;
+  static constexpr iree_device_size_t kChunkSize = 4096;
+
+  void SetUp() override {
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(/*group_count=*/4,
+                                                   &topology);
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_status_t status = iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor_);
+    iree_task_topology_deinitialize(&topology);
+    IREE_ASSERT_OK(status);
+
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("test"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    params.file_transfer_chunk_count = kChunkCount;
+    params.file_transfer_chunk_size = kChunkSize;
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("local-task"), &params, /*queue_count=*/1,
+        &executor_, /*loader_count=*/0, /*loaders=*/NULL, device_allocator_,
+        iree_allocator_system(), &device_));
+
+    IREE_ASSERT_OK(iree_hal_semaphore_create(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+        IREE_HAL_SEMAPHORE_FLAG_DEFAULT, &semaphore_));
+  }
+
+  void TearDown() override {
+    if (semaphore_) iree_hal_semaphore_release(semaphore_);
+    if (device_) iree_hal_device_release(device_);
+    if (device_allocator_) iree_hal_allocator_release(device_allocator_);
+    if (executor_) iree_task_executor_release(executor_);
+  }
+
+  // Creates a file of |length| bytes with a byte pattern based on the offset.
+  TestFile* CreateFile(iree_device_size_t length) {
+    TestFile* file = new TestFile();
+    iree_hal_resource_initialize(&kTestFileVtable, &file->resource);
+    file->contents.resize(length);
+    for (iree_device_size_t i = 0; i < length; ++i) {
+      file->contents[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    return file;
+  }
+
+  iree_hal_file_t* AsFile(TestFile* file) {
+    return reinterpret_cast<iree_hal_file_t*>(file);
+  }
+
+  iree_hal_buffer_t* CreateBuffer(iree_device_size_t length, uint8_t value) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                     length, &buffer));
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_fill(buffer, 0, length, &value, sizeof(value)));
+    return buffer;
+  }
+
+  std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::vector<uint8_t> data(iree_hal_buffer_byte_length(buffer));
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, 0, data.data(), data.size()));
+    return data;
+  }
+
+  // Queues a read of |length| bytes from |file| into |buffer| that signals
+  // |semaphore_| to |signal_value| and waits for it.
+  iree_status_t ReadAndWait(TestFile* file, uint64_t file_offset,
+                            iree_hal_buffer_t* buffer,
+                            iree_device_size_t buffer_offset,
+                            iree_device_size_t length, uint64_t signal_value) {
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore_, &signal_value};
+    IREE_RETURN_IF_ERROR(iree_hal_device_queue_read(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_list, AsFile(file), file_offset, buffer, buffer_offset, length,
+        IREE_HAL_READ_FLAG_NONE));
+    return iree_hal_semaphore_wait(semaphore_, signal_value,
+                                   iree_infinite_timeout(),
+                                   IREE_HAL_WAIT_FLAG_DEFAULT);
+  }
+
+  // Queues a write of |length| bytes from |buffer| into |file| that signals
+  // |semaphore_| to |signal_value| and waits for it.
+  iree_status_t WriteAndWait(iree_hal_buffer_t* buffer,
+                             iree_device_size_t buffer_offset, TestFile* file,
+                             uint64_t file_offset, iree_device_size_t length,
+                             uint64_t signal_value) {
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore_, &signal_value};
+    IREE_RETURN_IF_ERROR(iree_hal_device_queue_write(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_list, buffer, buffer_offset, AsFile(file), file_offset, length,
+        IREE_HAL_WRITE_FLAG_NONE));
+    return iree_hal_semaphore_wait(semaphore_, signal_value,
+                                   iree_infinite_timeout(),
+                                   IREE_HAL_WAIT_FLAG_DEFAULT);
+  }
+
+  // Verifies that |semaphore| was failed instead of reaching its payload.
+  // The local-task queue fails semaphores with the aborted status code of the
+  // failing submission while the original I/O failure is retained by the queue.
+  void ExpectFailed(iree_hal_semaphore_t* semaphore) {
+    EXPECT_THAT(
+        Status(iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout(),
+                                       IREE_HAL_WAIT_FLAG_DEFAULT)),
+        StatusIs(StatusCode::kAborted));
+    uint64_t value = 0;
+    iree_status_t status = iree_hal_semaphore_query(semaphore, &value);
+    EXPECT_FALSE(iree_status_is_ok(status));
+    iree_status_ignore(status);
+    EXPECT_GE(value, IREE_HAL_SEMAPHORE_FAILURE_VALUE);
+  }
+
+  // Verifies that the operations performed on |file| are no larger than a
+  // chunk and exactly cover [offset, offset + length) without overlap.
+  void ExpectOperationsCover(TestFile* file, uint64_t offset,
+                             iree_device_size_t length) {
+    std::vector<std::pair<uint64_t, iree_device_size_t>> operations =
+        file->operations;
+    std::sort(operations.begin(), operations.end());
+    uint64_t next_offset = offset;
+    for (const auto& operation : operations) {
+      EXPECT_EQ(operation.first, next_offset);
+      EXPECT_GT(operation.second, 0u);
+      EXPECT_LE(operation.second, kChunkSize);
+      next_offset = operation.first + operation.second;
+    }
+    EXPECT_EQ(next_offset, offset + length);
+  }
+
+  iree_task_executor_t* executor_ = NULL;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+};
+
+// Reads a transfer spanning every tile with several whole chunks per tile.
+TEST_F(TaskQueueFileTransferTest, ReadMultipleTiles) {
+  const iree_device_size_t length = kChunkCount * 4 * kChunkSize;
+  TestFile* file = CreateFile(length);
+  iree_hal_buffer_t* buffer = CreateBuffer(length, 0xCD);
+
+  IREE_ASSERT_OK(ReadAndWait(file, 0, buffer, 0, length, 1ull));
+
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(file->contents));
+  EXPECT_EQ(file->operations.size(), kChunkCount * 4);
+  ExpectOperationsCover(file, 0, length);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// Writes a transfer spanning every tile with several whole chunks per tile.
+TEST_F(TaskQueueFileTransferTest, WriteMultipleTiles) {
+  const iree_device_size_t length = kChunkCount * 4 * kChunkSize;
+  TestFile* file = CreateFile(length);
+  iree_hal_buffer_t* buffer = CreateBuffer(length, 0xCD);
+
+  IREE_ASSERT_OK(WriteAndWait(buffer, 0, file, 0, length, 1ull));
+
+  EXPECT_THAT(file->contents, ContainerEq(std::vector<uint8_t>(length, 0xCD)));
+  EXPECT_EQ(file->operations.size(), kChunkCount * 4);
+  ExpectOperationsCover(file, 0, length);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// Reads a transfer whose length is not a multiple of the tile or chunk size
+// from/to unaligned offsets such that the final tile and chunks are partial.
+TEST_F(TaskQueueFileTransferTest, ReadPartialTile) {
+  const uint64_t file_offset = 13;
+  const iree_device_size_t buffer_offset = 5;
+  const iree_device_size_t length = (kChunkCount * 2 + 1) * kChunkSize + 77;
+  TestFile* file = CreateFile(file_offset + length + 11);
+  iree_hal_buffer_t* buffer = CreateBuffer(buffer_offset + length + 3, 0xCD);
+
+  IREE_ASSERT_OK(
+      ReadAndWait(file, file_offset, buffer, buffer_offset, length, 1ull));
+
+  std::vector<uint8_t> expected(buffer_offset + length + 3, 0xCD);
+  std::memcpy(expected.data() + buffer_offset,
+              file->contents.data() + file_offset, length);
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(expected));
+  ExpectOperationsCover(file, file_offset, length);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// Writes a transfer whose length is not a multiple of the tile or chunk size
+// from/to unaligned offsets such that the final tile and chunks are partial.
+TEST_F(TaskQueueFileTransferTest, WritePartialTile) {
+  const uint64_t file_offset = 13;
+  const iree_device_size_t buffer_offset = 5;
+  const iree_device_size_t length = (kChunkCount * 2 + 1) * kChunkSize + 77;
+  TestFile* file = CreateFile(file_offset + length + 11);
+  std::vector<uint8_t> expected = file->contents;
+  iree_hal_buffer_t* buffer = CreateBuffer(buffer_offset + length + 3, 0xCD);
+
+  IREE_ASSERT_OK(
+      WriteAndWait(buffer, buffer_offset, file, file_offset, length, 1ull));
+
+  std::fill_n(expected.begin() + file_offset, length, 0xCD);
+  EXPECT_THAT(file->contents, ContainerEq(expected));
+  ExpectOperationsCover(file, file_offset, length);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// Reads a transfer smaller than a single chunk.
+TEST_F(TaskQueueFileTransferTest, ReadSubChunk) {
+  const iree_device_size_t length = kChunkSize / 2 + 1;
+  TestFile* file = CreateFile(length);
+  iree_hal_buffer_t* buffer = CreateBuffer(length, 0xCD);
+
+  IREE_ASSERT_OK(ReadAndWait(file, 0, buffer, 0, length, 1ull));
+
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(file->contents));
+  EXPECT_EQ(file->operations.size(), 1u);
+  ExpectOperationsCover(file, 0, length);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// Zero-length transfers signal without performing any I/O.
+TEST_F(TaskQueueFileTransferTest, ZeroLength) {
+  TestFile* file = CreateFile(kChunkSize);
+  iree_hal_buffer_t* buffer = CreateBuffer(kChunkSize, 0xCD);
+
+  IREE_ASSERT_OK(ReadAndWait(file, 0, buffer, 0, 0, 1ull));
+  IREE_ASSERT_OK(WriteAndWait(buffer, 0, file, 0, 0, 2ull));
+
+  EXPECT_TRUE(file->operations.empty());
+  EXPECT_THAT(ReadBuffer(buffer),
+              ContainerEq(std::vector<uint8_t>(kChunkSize, 0xCD)));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// A failure in one tile fails all signal semaphores of the transfer.
+TEST_F(TaskQueueFileTransferTest, ReadTileFailure) {
+  const iree_device_size_t length = kChunkCount * 2 * kChunkSize;
+  TestFile* file = CreateFile(length);
+  file->fail_offset = length - kChunkSize / 2;
+  iree_hal_buffer_t* buffer = CreateBuffer(length, 0xCD);
+
+  iree_hal_semaphore_t* other_semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+      IREE_HAL_SEMAPHORE_FLAG_DEFAULT, &other_semaphore));
+  iree_hal_semaphore_t* signal_semaphores[2] = {semaphore_, other_semaphore};
+  uint64_t signal_values[2] = {1ull, 1ull};
+  iree_hal_semaphore_list_t signal_list = {2, signal_semaphores,
+                                           signal_values};
+  IREE_ASSERT_OK(iree_hal_device_queue_read(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      signal_list, AsFile(file), 0, buffer, 0, length,
+      IREE_HAL_READ_FLAG_NONE));
+
+  for (iree_hal_semaphore_t* semaphore : signal_semaphores) {
+    ExpectFailed(semaphore);
+  }
+
+  iree_hal_semaphore_release(other_semaphore);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// A failure in one tile of a write fails the signal semaphore.
+TEST_F(TaskQueueFileTransferTest, WriteTileFailure) {
+  const iree_device_size_t length = kChunkCount * 2 * kChunkSize;
+  TestFile* file = CreateFile(length);
+  file->fail_offset = kChunkSize;
+  iree_hal_buffer_t* buffer = CreateBuffer(length, 0xCD);
+
+  EXPECT_THAT(Status(WriteAndWait(buffer, 0, file, 0, length, 1ull)),
+              StatusIs(StatusCode::kAborted));
+  ExpectFailed(semaphore_);
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(AsFile(file));
+}
+
+// Resources retained by a failed submission are released when it retires.
+TEST_F(TaskQueueFileTransferTest, FailureReleasesResources) {
+  const iree_device_size_t length = kChunkCount * kChunkSize;
+  std::atomic<bool> destroyed = {false};
+  TestFile* file = CreateFile(length);
+  file->fail_offset = 0;
+  file->destroyed = &destroyed;
+  iree_hal_buffer_t* buffer = CreateBuffer(length, 0xCD);
+
+  EXPECT_THAT(Status(ReadAndWait(file, 0, buffer, 0, length, 1ull)),
+              StatusIs(StatusCode::kAborted));
+  iree_hal_file_release(AsFile(file));
+
+  // Releasing the device waits for the queue to retire all submissions.
+  iree_hal_semaphore_release(semaphore_);
+  semaphore_ = NULL;
+  iree_hal_device_release(device_);
+  device_ = NULL;
+  EXPECT_TRUE(destroyed.load());
+
+  iree_hal_buffer_release(buffer);
+}
+
+}  // namespace
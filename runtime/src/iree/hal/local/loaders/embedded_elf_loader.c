@@ -80,7 +80,8 @@ static iree_status_t iree_hal_elf_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
-  return iree_ok_status();
+  return iree_hal_local_executable_allocate_workgroup_costs(
+      &executable->base, executable->library.v0->exports.count);
 }
 
 static iree_status_t iree_hal_elf_executable_create(
@@ -66,6 +66,8 @@ static iree_status_t iree_hal_static_executable_create(
     executable->library.header = library_header;
     executable->identifier = iree_make_cstring_view((*library_header)->name);
     executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+    status = iree_hal_local_executable_allocate_workgroup_costs(
+        &executable->base, executable->library.v0->exports.count);
   }
 
   // Copy executable constants so we own them.
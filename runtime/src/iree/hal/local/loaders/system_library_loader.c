@@ -200,7 +200,8 @@ static iree_status_t iree_hal_system_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
-  return iree_ok_status();
+  return iree_hal_local_executable_allocate_workgroup_costs(
+      &executable->base, executable->library.v0->exports.count);
 }
 
 static int iree_hal_system_executable_import_thunk_v0(
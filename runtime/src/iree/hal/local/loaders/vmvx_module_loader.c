@@ -272,6 +272,11 @@ static iree_status_t iree_hal_vmvx_executable_create(
     }
   }
 
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_allocate_workgroup_costs(
+        &executable->base, entry_count);
+  }
+
   // Query the optional local workgroup size from each entry point.
   if (iree_status_is_ok(status)) {
     // TODO(benvanik): pack this more efficiently; this requires a lot of
@@ -17,6 +17,7 @@ void iree_hal_local_executable_initialize(
 
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
+  out_base_executable->workgroup_costs = NULL;
 
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
@@ -24,7 +25,28 @@ void iree_hal_local_executable_initialize(
 }
 
 void iree_hal_local_executable_deinitialize(
-    iree_hal_local_executable_t* base_executable) {}
+    iree_hal_local_executable_t* base_executable) {
+  iree_allocator_free(base_executable->host_allocator,
+                      base_executable->workgroup_costs);
+  base_executable->workgroup_costs = NULL;
+}
+
+iree_status_t iree_hal_local_executable_allocate_workgroup_costs(
+    iree_hal_local_executable_t* base_executable,
+    iree_host_size_t export_count) {
+  IREE_ASSERT_ARGUMENT(base_executable);
+  IREE_ASSERT(!base_executable->workgroup_costs);
+  if (export_count == 0) return iree_ok_status();
+  iree_atomic_int64_t* workgroup_costs = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      base_executable->host_allocator, export_count * sizeof(*workgroup_costs),
+      (void**)&workgroup_costs));
+  for (iree_host_size_t i = 0; i < export_count; ++i) {
+    iree_atomic_store(&workgroup_costs[i], 0, iree_memory_order_relaxed);
+  }
+  base_executable->workgroup_costs = workgroup_costs;
+  return iree_ok_status();
+}
 
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value) {
@@ -8,6 +8,7 @@
 #define IREE_HAL_LOCAL_LOCAL_EXECUTABLE_H_
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 
@@ -25,6 +26,13 @@ typedef struct iree_hal_local_executable_t {
   // minimum amount of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Per-entry point average cost of a single workgroup in nanoseconds as
+  // measured by drivers that distribute workgroups across threads. Entries are
+  // 0 until measured. Allocated by the parent type with
+  // iree_hal_local_executable_allocate_workgroup_costs and NULL if the
+  // executable does not support feedback.
+  iree_atomic_int64_t* workgroup_costs;
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -48,6 +56,12 @@ void iree_hal_local_executable_initialize(
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable);
 
+// Allocates zero-initialized |workgroup_costs| storage for |export_count|
+// entry points. Freed when the executable is deinitialized.
+iree_status_t iree_hal_local_executable_allocate_workgroup_costs(
+    iree_hal_local_executable_t* base_executable,
+    iree_host_size_t export_count);
+
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
@@ -8,13 +8,29 @@
 
 #include "iree/hal/utils/fd_file.h"
 #include "iree/hal/utils/memory_file.h"
+#include "iree/hal/utils/uring_file.h"
 
 IREE_API_EXPORT iree_status_t iree_hal_file_from_handle(
     iree_hal_allocator_t* device_allocator,
     iree_hal_queue_affinity_t queue_affinity, iree_hal_memory_access_t access,
     iree_io_file_handle_t* handle, iree_allocator_t host_allocator,
     iree_hal_file_t** out_file) {
+  iree_hal_file_registry_options_t options;
+  memset(&options, 0, sizeof(options));
+  return iree_hal_file_from_handle_with_options(device_allocator,
+                                                queue_affinity, access, handle,
+                                                &options, host_allocator,
+                                                out_file);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_file_from_handle_with_options(
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_memory_access_t access,
+    iree_io_file_handle_t* handle,
+    const iree_hal_file_registry_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
   IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_file);
   *out_file = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -26,10 +42,23 @@ IREE_API_EXPORT iree_status_t iree_hal_file_from_handle(
           iree_hal_memory_file_wrap(device_allocator, queue_affinity, access,
                                     handle, host_allocator, out_file);
       break;
-    case IREE_IO_FILE_HANDLE_TYPE_FD:
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+#if IREE_HAL_URING_FILE_ENABLE
+      // Prefer io_uring and fall back to the portable pread/pwrite
+      // implementation if it can't be used for any reason: io_uring may be
+      // missing or denied and ring setup can also fail on resource limits
+      // (locked memory, ring count) that pread/pwrite are not subject to.
+      // Problems with the file itself are reported by the fd file as well.
+      status = iree_hal_uring_file_from_handle(
+          access, handle, &options->uring, host_allocator, out_file);
+      if (iree_status_is_ok(status)) break;
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "io_uring unavailable");
+      iree_status_ignore(status);
+#endif  // IREE_HAL_URING_FILE_ENABLE
       status = iree_hal_fd_file_from_handle(access, handle, host_allocator,
                                             out_file);
       break;
+    }
     default:
       status = iree_make_status(
           IREE_STATUS_UNIMPLEMENTED,
@@ -9,12 +9,20 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/utils/uring_file.h"
 #include "iree/io/file_handle.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
+// Options for files created by iree_hal_file_from_handle_with_options.
+// Zero-initialize for defaults.
+typedef struct iree_hal_file_registry_options_t {
+  // Options for IREE_IO_FILE_HANDLE_TYPE_FD files when io_uring is available.
+  iree_hal_uring_file_options_t uring;
+} iree_hal_file_registry_options_t;
+
 // Creates a file backed by |handle| using a common host implementation.
 // Supported file handle types are determined based on compile configuration.
 //
@@ -28,6 +36,18 @@ IREE_API_EXPORT iree_status_t iree_hal_file_from_handle(
     iree_io_file_handle_t* handle, iree_allocator_t host_allocator,
     iree_hal_file_t** out_file);
 
+// Creates a file backed by |handle| as with iree_hal_file_from_handle using
+// |options| to configure the implementation.
+//
+// IREE_IO_FILE_HANDLE_TYPE_FD handles use io_uring when available and fall
+// back to pread/pwrite if the io_uring file cannot be created for any reason.
+IREE_API_EXPORT iree_status_t iree_hal_file_from_handle_with_options(
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_memory_access_t access,
+    iree_io_file_handle_t* handle,
+    const iree_hal_file_registry_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
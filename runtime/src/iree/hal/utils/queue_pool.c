@@ -0,0 +1,485 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/queue_pool.h"
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/detail.h"
+
+#define _VTABLE_DISPATCH(buffer, method_name) \
+  IREE_HAL_VTABLE_DISPATCH(buffer, iree_hal_buffer, method_name)
+
+//===----------------------------------------------------------------------===//
+// iree_hal_queue_pool_block_t
+//===----------------------------------------------------------------------===//
+
+// A free backing allocation in the pool.
+// The allocation may only be reused by work ordered after all of the release
+// timepoints.
+typedef struct iree_hal_queue_pool_block_t {
+  struct iree_hal_queue_pool_block_t* next;
+  // Backing allocation from the device allocator. Retained.
+  iree_hal_buffer_t* buffer;
+  // Parameters the backing allocation was requested with.
+  iree_hal_buffer_params_t params;
+  // Timepoints at which the allocation is released. Semaphores are retained.
+  iree_host_size_t timepoint_count;
+  iree_hal_semaphore_t** semaphores;
+  uint64_t* payload_values;
+} iree_hal_queue_pool_block_t;
+
+static iree_status_t iree_hal_queue_pool_block_allocate(
+    iree_hal_buffer_t* buffer, iree_hal_buffer_params_t params,
+    const iree_hal_semaphore_list_t release_semaphore_list,
+    iree_allocator_t host_allocator, iree_hal_queue_pool_block_t** out_block) {
+  *out_block = NULL;
+  const iree_host_size_t timepoint_count = release_semaphore_list.count;
+  iree_hal_queue_pool_block_t* block = NULL;
+  iree_host_size_t total_size =
+      sizeof(*block) + timepoint_count * sizeof(block->semaphores[0]) +
+      timepoint_count * sizeof(block->payload_values[0]);
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&block));
+  block->next = NULL;
+  block->buffer = buffer;
+  iree_hal_buffer_retain(block->buffer);
+  block->params = params;
+  block->timepoint_count = timepoint_count;
+  block->payload_values = (uint64_t*)((uint8_t*)block + sizeof(*block));
+  block->semaphores =
+      (iree_hal_semaphore_t**)(block->payload_values + timepoint_count);
+  for (iree_host_size_t i = 0; i < timepoint_count; ++i) {
+    block->semaphores[i] = release_semaphore_list.semaphores[i];
+    iree_hal_semaphore_retain(block->semaphores[i]);
+    block->payload_values[i] = release_semaphore_list.payload_values[i];
+  }
+  *out_block = block;
+  return iree_ok_status();
+}
+
+static void iree_hal_queue_pool_block_free(iree_hal_queue_pool_block_t* block,
+                                           iree_allocator_t host_allocator) {
+  for (iree_host_size_t i = 0; i < block->timepoint_count; ++i) {
+    iree_hal_semaphore_release(block->semaphores[i]);
+  }
+  iree_hal_buffer_release(block->buffer);
+  iree_allocator_free(host_allocator, block);
+}
+
+static void iree_hal_queue_pool_block_free_list(
+    iree_hal_queue_pool_block_t* block, iree_allocator_t host_allocator) {
+  while (block) {
+    iree_hal_queue_pool_block_t* next_block = block->next;
+    iree_hal_queue_pool_block_free(block, host_allocator);
+    block = next_block;
+  }
+}
+
+// Returns true if a block with |params| can satisfy a request for |params|.
+// We require the same parameters so that the reused allocation is identical to
+// what would have been allocated fresh.
+static bool iree_hal_queue_pool_params_match(
+    const iree_hal_buffer_params_t* block_params,
+    const iree_hal_buffer_params_t* params) {
+  return block_params->type == params->type &&
+         block_params->usage == params->usage &&
+         block_params->access == params->access &&
+         block_params->min_alignment == params->min_alignment;
+}
+
+// Returns true if |block| can be reused by work ordered after
+// |wait_semaphore_list|. Each release timepoint must either be covered by a
+// wait on the same semaphore for an equal or later payload or have already
+// been reached. Failed semaphores never release their blocks.
+static bool iree_hal_queue_pool_block_is_available(
+    const iree_hal_queue_pool_block_t* block,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < block->timepoint_count; ++i) {
+    bool is_covered = false;
+    for (iree_host_size_t j = 0; j < wait_semaphore_list.count; ++j) {
+      if (wait_semaphore_list.semaphores[j] == block->semaphores[i] &&
+          wait_semaphore_list.payload_values[j] >= block->payload_values[i]) {
+        is_covered = true;
+        break;
+      }
+    }
+    if (is_covered) continue;
+    uint64_t current_value = 0;
+    iree_status_t status =
+        iree_hal_semaphore_query(block->semaphores[i], &current_value);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      return false;
+    }
+    if (current_value < block->payload_values[i]) return false;
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_queue_pool_t
+//===----------------------------------------------------------------------===//
+
+struct iree_hal_queue_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+
+  // Maximum number of free blocks retained before evicting the oldest.
+  iree_host_size_t max_free_blocks;
+
+  // Guards the free list.
+  iree_slim_mutex_t mutex;
+
+  // Free blocks in release order: the head is the oldest and the first to be
+  // evicted when the pool is over capacity.
+  iree_host_size_t free_count;
+  iree_hal_queue_pool_block_t* free_head;
+  iree_hal_queue_pool_block_t* free_tail;
+};
+
+IREE_API_EXPORT iree_status_t iree_hal_queue_pool_create(
+    iree_host_size_t max_free_blocks, iree_allocator_t host_allocator,
+    iree_hal_queue_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_queue_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->max_free_blocks = max_free_blocks;
+  iree_slim_mutex_initialize(&pool->mutex);
+  pool->free_count = 0;
+  pool->free_head = NULL;
+  pool->free_tail = NULL;
+
+  *out_pool = pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_queue_pool_destroy(iree_hal_queue_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = pool->host_allocator;
+
+  iree_hal_queue_pool_trim(pool);
+
+  iree_slim_mutex_deinitialize(&pool->mutex);
+
+  iree_allocator_free(host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_hal_queue_pool_retain(iree_hal_queue_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_hal_queue_pool_release(iree_hal_queue_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_queue_pool_destroy(pool);
+  }
+}
+
+IREE_API_EXPORT void iree_hal_queue_pool_trim(iree_hal_queue_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Outstanding wrapper buffers retain their backing allocations so it's
+  // always safe to drop the pool references even if work is still pending.
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_queue_pool_block_t* free_head = pool->free_head;
+  pool->free_count = 0;
+  pool->free_head = NULL;
+  pool->free_tail = NULL;
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  iree_hal_queue_pool_block_free_list(free_head, pool->host_allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Inserts |buffer| into the pool as a free block reusable after
+// |release_semaphore_list|. Evicts the oldest blocks if over capacity.
+static iree_status_t iree_hal_queue_pool_insert(
+    iree_hal_queue_pool_t* pool, iree_hal_buffer_t* buffer,
+    iree_hal_buffer_params_t params,
+    const iree_hal_semaphore_list_t release_semaphore_list) {
+  iree_hal_queue_pool_block_t* block = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_queue_pool_block_allocate(
+      buffer, params, release_semaphore_list, pool->host_allocator, &block));
+
+  iree_slim_mutex_lock(&pool->mutex);
+  if (pool->free_tail) {
+    pool->free_tail->next = block;
+  } else {
+    pool->free_head = block;
+  }
+  pool->free_tail = block;
+  ++pool->free_count;
+  iree_hal_queue_pool_block_t* evicted_head = NULL;
+  iree_hal_queue_pool_block_t* evicted_tail = NULL;
+  while (pool->free_count > pool->max_free_blocks) {
+    iree_hal_queue_pool_block_t* evicted_block = pool->free_head;
+    pool->free_head = evicted_block->next;
+    if (!pool->free_head) pool->free_tail = NULL;
+    --pool->free_count;
+    evicted_block->next = NULL;
+    if (evicted_tail) {
+      evicted_tail->next = evicted_block;
+    } else {
+      evicted_head = evicted_block;
+    }
+    evicted_tail = evicted_block;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  iree_hal_queue_pool_block_free_list(evicted_head, pool->host_allocator);
+  return iree_ok_status();
+}
+
+// Removes and returns the smallest free block compatible with |params| that
+// is at least |allocation_size| and no more than twice that (to avoid pinning
+// large allocations with small requests), or NULL if none is available to work
+// ordered after |wait_semaphore_list|.
+static iree_hal_queue_pool_block_t* iree_hal_queue_pool_take(
+    iree_hal_queue_pool_t* pool, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_queue_pool_block_t* best_prev = NULL;
+  iree_hal_queue_pool_block_t* best_block = NULL;
+  iree_device_size_t best_size = 0;
+  iree_hal_queue_pool_block_t* prev = NULL;
+  for (iree_hal_queue_pool_block_t* block = pool->free_head; block != NULL;
+       prev = block, block = block->next) {
+    const iree_device_size_t block_size =
+        iree_hal_buffer_allocation_size(block->buffer);
+    if (block_size < allocation_size || block_size / 2 > allocation_size ||
+        (best_block && block_size >= best_size) ||
+        !iree_hal_queue_pool_params_match(&block->params, params) ||
+        !iree_hal_queue_pool_block_is_available(block, wait_semaphore_list)) {
+      continue;
+    }
+    best_prev = prev;
+    best_block = block;
+    best_size = block_size;
+    if (block_size == allocation_size) break;
+  }
+  if (best_block) {
+    if (best_prev) {
+      best_prev->next = best_block->next;
+    } else {
+      pool->free_head = best_block->next;
+    }
+    if (pool->free_tail == best_block) pool->free_tail = best_prev;
+    --pool->free_count;
+    best_block->next = NULL;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  return best_block;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_queue_pool_buffer_t
+//===----------------------------------------------------------------------===//
+
+// A buffer handed out by the pool wrapping a backing allocation.
+// The wrapper is its own allocated buffer so that it can carry the
+// asynchronous placement used to route deallocations back to the pool.
+typedef struct iree_hal_queue_pool_buffer_t {
+  iree_hal_buffer_t base;
+  iree_allocator_t host_allocator;
+  // Pool the backing allocation is returned to. Retained.
+  iree_hal_queue_pool_t* pool;
+  // Backing allocation from the device allocator. Retained.
+  iree_hal_buffer_t* backing_buffer;
+  // Parameters the backing allocation was requested with.
+  iree_hal_buffer_params_t params;
+  // Set once the backing allocation has been returned to the pool.
+  iree_atomic_int32_t is_released;
+} iree_hal_queue_pool_buffer_t;
+
+static const iree_hal_buffer_vtable_t iree_hal_queue_pool_buffer_vtable;
+
+static iree_hal_queue_pool_buffer_t* iree_hal_queue_pool_buffer_cast(
+    iree_hal_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_queue_pool_buffer_vtable);
+  return (iree_hal_queue_pool_buffer_t*)base_value;
+}
+
+static iree_status_t iree_hal_queue_pool_buffer_create(
+    iree_hal_queue_pool_t* pool, iree_hal_buffer_placement_t placement,
+    iree_hal_buffer_t* backing_buffer, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer) {
+  iree_hal_queue_pool_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      pool->host_allocator, sizeof(*buffer), (void**)&buffer));
+  iree_hal_buffer_initialize(
+      placement, &buffer->base, allocation_size, /*byte_offset=*/0,
+      allocation_size, iree_hal_buffer_memory_type(backing_buffer),
+      iree_hal_buffer_allowed_access(backing_buffer),
+      iree_hal_buffer_allowed_usage(backing_buffer),
+      &iree_hal_queue_pool_buffer_vtable, &buffer->base);
+  buffer->host_allocator = pool->host_allocator;
+  buffer->pool = pool;
+  iree_hal_queue_pool_retain(buffer->pool);
+  buffer->backing_buffer = backing_buffer;
+  iree_hal_buffer_retain(buffer->backing_buffer);
+  buffer->params = params;
+  iree_atomic_store(&buffer->is_released, 0, iree_memory_order_relaxed);
+  *out_buffer = &buffer->base;
+  return iree_ok_status();
+}
+
+static void iree_hal_queue_pool_buffer_destroy(iree_hal_buffer_t* base_buffer) {
+  iree_hal_queue_pool_buffer_t* buffer =
+      iree_hal_queue_pool_buffer_cast(base_buffer);
+  iree_allocator_t host_allocator = buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // If the buffer was never deallocated via the queue then nothing can be
+  // using it anymore and the backing allocation is immediately reusable. If
+  // we fail to track it we just let it be freed.
+  if (!iree_atomic_exchange(&buffer->is_released, 1,
+                            iree_memory_order_acq_rel)) {
+    iree_status_ignore(iree_hal_queue_pool_insert(
+        buffer->pool, buffer->backing_buffer, buffer->params,
+        iree_hal_semaphore_list_empty()));
+  }
+
+  iree_hal_buffer_release(buffer->backing_buffer);
+  iree_hal_queue_pool_release(buffer->pool);
+  iree_allocator_free(host_allocator, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_hal_queue_pool_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_buffer_t* backing_buffer =
+      iree_hal_queue_pool_buffer_cast(base_buffer)->backing_buffer;
+  return _VTABLE_DISPATCH(backing_buffer, map_range)(
+      backing_buffer, mapping_mode, memory_access,
+      iree_hal_buffer_byte_offset(backing_buffer) + local_byte_offset,
+      local_byte_length, mapping);
+}
+
+static iree_status_t iree_hal_queue_pool_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_buffer_t* backing_buffer =
+      iree_hal_queue_pool_buffer_cast(base_buffer)->backing_buffer;
+  return _VTABLE_DISPATCH(backing_buffer, unmap_range)(
+      backing_buffer,
+      iree_hal_buffer_byte_offset(backing_buffer) + local_byte_offset,
+      local_byte_length, mapping);
+}
+
+static iree_status_t iree_hal_queue_pool_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_buffer_t* backing_buffer =
+      iree_hal_queue_pool_buffer_cast(base_buffer)->backing_buffer;
+  return _VTABLE_DISPATCH(backing_buffer, invalidate_range)(
+      backing_buffer,
+      iree_hal_buffer_byte_offset(backing_buffer) + local_byte_offset,
+      local_byte_length);
+}
+
+static iree_status_t iree_hal_queue_pool_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_buffer_t* backing_buffer =
+      iree_hal_queue_pool_buffer_cast(base_buffer)->backing_buffer;
+  return _VTABLE_DISPATCH(backing_buffer, flush_range)(
+      backing_buffer,
+      iree_hal_buffer_byte_offset(backing_buffer) + local_byte_offset,
+      local_byte_length);
+}
+
+static const iree_hal_buffer_vtable_t iree_hal_queue_pool_buffer_vtable = {
+    .recycle = iree_hal_buffer_recycle,
+    .destroy = iree_hal_queue_pool_buffer_destroy,
+    .map_range = iree_hal_queue_pool_buffer_map_range,
+    .unmap_range = iree_hal_queue_pool_buffer_unmap_range,
+    .invalidate_range = iree_hal_queue_pool_buffer_invalidate_range,
+    .flush_range = iree_hal_queue_pool_buffer_flush_range,
+};
+
+//===----------------------------------------------------------------------===//
+// Acquire/release
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_hal_queue_pool_acquire(
+    iree_hal_queue_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_placement_t placement,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
+
+  // Try to reuse a free block and otherwise allocate a new one.
+  iree_hal_buffer_t* backing_buffer = NULL;
+  iree_hal_queue_pool_block_t* block = iree_hal_queue_pool_take(
+      pool, &params, allocation_size, wait_semaphore_list);
+  if (block) {
+    backing_buffer = block->buffer;
+    iree_hal_buffer_retain(backing_buffer);
+    iree_hal_queue_pool_block_free(block, pool->host_allocator);
+  } else {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_allocate_buffer(device_allocator, params,
+                                               allocation_size,
+                                               &backing_buffer));
+  }
+
+  iree_status_t status = iree_hal_queue_pool_buffer_create(
+      pool, placement, backing_buffer, params, allocation_size, out_buffer);
+  iree_hal_buffer_release(backing_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_queue_pool_release_buffer(
+    iree_hal_queue_pool_t* pool, iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t release_semaphore_list) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_resource_is(allocated_buffer,
+                            &iree_hal_queue_pool_buffer_vtable)) {
+    return iree_ok_status();
+  }
+  iree_hal_queue_pool_buffer_t* pool_buffer =
+      iree_hal_queue_pool_buffer_cast(allocated_buffer);
+  if (pool_buffer->pool != pool) return iree_ok_status();
+  if (iree_atomic_exchange(&pool_buffer->is_released, 1,
+                           iree_memory_order_acq_rel)) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_queue_pool_insert(
+      pool, pool_buffer->backing_buffer, pool_buffer->params,
+      release_semaphore_list);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,86 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_QUEUE_POOL_H_
+#define IREE_HAL_UTILS_QUEUE_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Default maximum number of free blocks retained by a pool. When exceeded the
+// oldest free blocks are released back to the device allocator.
+#define IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS 64
+
+// A pool of device allocations used to implement stream-ordered
+// iree_hal_device_queue_alloca/iree_hal_device_queue_dealloca on devices that
+// have no native pooling of their own.
+//
+// Buffers acquired from the pool wrap a backing allocation from the device
+// allocator. When a buffer is released via a queue deallocation its backing
+// allocation is returned to the pool immediately tagged with the timepoints
+// at which the deallocation completes. Subsequent acquisitions can reuse the
+// backing allocation without blocking if they are ordered after those
+// timepoints: either because they wait on them as part of their own wait list
+// or because the timepoints have already been reached.
+//
+// Wrapping buffers retain their backing allocation so trimming or evicting a
+// block from the pool never frees memory that may still be used by in-flight
+// work. Buffers that are released without a queue deallocation (such as those
+// with indeterminate lifetimes) return their backing allocation to the pool
+// when their last reference is dropped.
+//
+// Thread-safe: multiple threads can acquire and release concurrently.
+typedef struct iree_hal_queue_pool_t iree_hal_queue_pool_t;
+
+// Creates a new empty queue pool retaining up to |max_free_blocks| free
+// allocations for reuse.
+IREE_API_EXPORT iree_status_t iree_hal_queue_pool_create(
+    iree_host_size_t max_free_blocks, iree_allocator_t host_allocator,
+    iree_hal_queue_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+IREE_API_EXPORT void iree_hal_queue_pool_retain(iree_hal_queue_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+IREE_API_EXPORT void iree_hal_queue_pool_release(iree_hal_queue_pool_t* pool);
+
+// Drops all free blocks in the pool. Memory still referenced by outstanding
+// buffers will be released when those buffers are.
+IREE_API_EXPORT void iree_hal_queue_pool_trim(iree_hal_queue_pool_t* pool);
+
+// Acquires a buffer of |allocation_size| bytes with the given |params| that
+// may be used by any work ordered after |wait_semaphore_list|. A free block
+// is reused if its release timepoints are covered by the wait list or have
+// been reached and otherwise a new allocation is made from |device_allocator|.
+// The returned buffer has the provided |placement| and never blocks.
+IREE_API_EXPORT iree_status_t iree_hal_queue_pool_acquire(
+    iree_hal_queue_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_placement_t placement,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Returns the backing allocation of |buffer| to the pool for reuse by work
+// ordered after all of |release_semaphore_list|. An empty list indicates the
+// allocation is immediately reusable. The buffer itself remains valid until
+// released by all owners but must not be accessed by any work not ordered
+// before the release timepoints.
+//
+// Buffers not acquired from |pool| and buffers that have already been released
+// are ignored.
+IREE_API_EXPORT iree_status_t iree_hal_queue_pool_release_buffer(
+    iree_hal_queue_pool_t* pool, iree_hal_buffer_t* buffer,
+    const iree_hal_semaphore_list_t release_semaphore_list);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_QUEUE_POOL_H_
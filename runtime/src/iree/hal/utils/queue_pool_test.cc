@@ -0,0 +1,474 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/queue_pool.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/semaphore_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+namespace {
+extern const iree_hal_semaphore_vtable_t test_semaphore_vtable;
+}  // namespace
+
+// Host-only semaphore that can be signaled and failed by the test.
+// The pool only ever queries semaphores and never waits on them.
+struct TestSemaphore {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+  uint64_t current_value;
+  iree_status_code_t failure_code;
+
+  static iree_hal_semaphore_t* Create(iree_allocator_t host_allocator) {
+    TestSemaphore* semaphore = nullptr;
+    IREE_CHECK_OK(iree_allocator_malloc(host_allocator, sizeof(*semaphore),
+                                        (void**)&semaphore));
+    iree_hal_semaphore_initialize(&test_semaphore_vtable, &semaphore->base);
+    semaphore->host_allocator = host_allocator;
+    semaphore->current_value = 0ull;
+    semaphore->failure_code = IREE_STATUS_OK;
+    return &semaphore->base;
+  }
+
+  static TestSemaphore* Cast(iree_hal_semaphore_t* base_semaphore) {
+    return reinterpret_cast<TestSemaphore*>(base_semaphore);
+  }
+
+  static void Destroy(iree_hal_semaphore_t* base_semaphore) {
+    auto* semaphore = Cast(base_semaphore);
+    iree_hal_semaphore_deinitialize(&semaphore->base);
+    iree_allocator_free(semaphore->host_allocator, semaphore);
+  }
+
+  static iree_status_t Query(iree_hal_semaphore_t* base_semaphore,
+                             uint64_t* out_value) {
+    auto* semaphore = Cast(base_semaphore);
+    *out_value = semaphore->current_value;
+    return iree_status_from_code(semaphore->failure_code);
+  }
+
+  static iree_status_t Signal(iree_hal_semaphore_t* base_semaphore,
+                              uint64_t new_value) {
+    Cast(base_semaphore)->current_value = new_value;
+    return iree_ok_status();
+  }
+
+  static void Fail(iree_hal_semaphore_t* base_semaphore, iree_status_t status) {
+    Cast(base_semaphore)->failure_code = iree_status_consume_code(status);
+  }
+
+  static iree_status_t Wait(iree_hal_semaphore_t* base_semaphore,
+                            uint64_t value, iree_timeout_t timeout,
+                            iree_hal_wait_flags_t flags) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+  }
+};
+
+namespace {
+const iree_hal_semaphore_vtable_t test_semaphore_vtable = {
+    /*.destroy=*/TestSemaphore::Destroy,
+    /*.query=*/TestSemaphore::Query,
+    /*.signal=*/TestSemaphore::Signal,
+    /*.fail=*/TestSemaphore::Fail,
+    /*.wait=*/TestSemaphore::Wait,
+};
+}  // namespace
+
+class QueuePoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), host_allocator_, host_allocator_, &device_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_queue_pool_release(pool_);
+    iree_hal_allocator_release(device_allocator_);
+  }
+
+  void CreatePool(iree_host_size_t max_free_blocks) {
+    IREE_ASSERT_OK(
+        iree_hal_queue_pool_create(max_free_blocks, host_allocator_, &pool_));
+  }
+
+  static iree_hal_buffer_params_t DefaultParams() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+    return params;
+  }
+
+  iree_hal_buffer_t* Acquire(
+      iree_device_size_t allocation_size = 256,
+      iree_hal_semaphore_list_t wait_semaphore_list =
+          iree_hal_semaphore_list_empty(),
+      iree_hal_buffer_params_t params = DefaultParams()) {
+    iree_hal_buffer_placement_t placement = {
+        /*.device=*/NULL,
+        /*.queue_affinity=*/IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*.flags=*/IREE_HAL_BUFFER_PLACEMENT_FLAG_ASYNCHRONOUS,
+    };
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_queue_pool_acquire(
+        pool_, device_allocator_, placement, wait_semaphore_list, params,
+        allocation_size, &buffer));
+    return buffer;
+  }
+
+  // Returns the host address of the backing allocation of |buffer|. Buffers
+  // share a backing allocation if and only if they have the same address as
+  // long as the buffers are live.
+  static void* BackingAddress(iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_mapping_t mapping;
+    IREE_CHECK_OK(iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+        IREE_HAL_WHOLE_BUFFER, &mapping));
+    void* address = mapping.contents.data;
+    IREE_CHECK_OK(iree_hal_buffer_unmap_range(&mapping));
+    return address;
+  }
+
+  iree_allocator_t host_allocator_ = iree_allocator_system();
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_hal_queue_pool_t* pool_ = NULL;
+};
+
+// Tests that allocations released with no timepoints are immediately reused.
+TEST_F(QueuePoolTest, ReuseImmediatelyReleased) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, buffer0, iree_hal_semaphore_list_empty()));
+
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_EQ(BackingAddress(buffer1), address0);
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+}
+
+// Tests that allocations are only reused once their release timepoint has been
+// reached when the acquisition doesn't wait on it.
+TEST_F(QueuePoolTest, ReuseAfterTimepointReached) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_semaphore_t* semaphore = TestSemaphore::Create(host_allocator_);
+  uint64_t release_value = 2ull;
+  iree_hal_semaphore_list_t release_list = {1, &semaphore, &release_value};
+
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(
+      iree_hal_queue_pool_release_buffer(pool_, buffer0, release_list));
+
+  // Not yet reached: a new allocation is made.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore, 1ull));
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_NE(BackingAddress(buffer1), address0);
+
+  // Reached: the released allocation is reused.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore, 2ull));
+  iree_hal_buffer_t* buffer2 = Acquire();
+  EXPECT_EQ(BackingAddress(buffer2), address0);
+
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Tests that allocations are reused before their release timepoint is reached
+// if the acquisition waits on the same semaphore for an equal or later value.
+TEST_F(QueuePoolTest, ReuseCoveredByWaits) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_semaphore_t* semaphore = TestSemaphore::Create(host_allocator_);
+  iree_hal_semaphore_t* other_semaphore =
+      TestSemaphore::Create(host_allocator_);
+  uint64_t release_value = 2ull;
+  iree_hal_semaphore_list_t release_list = {1, &semaphore, &release_value};
+
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(
+      iree_hal_queue_pool_release_buffer(pool_, buffer0, release_list));
+
+  // Waiting on an earlier value of the semaphore doesn't order after release.
+  uint64_t early_value = 1ull;
+  iree_hal_semaphore_list_t early_list = {1, &semaphore, &early_value};
+  iree_hal_buffer_t* buffer1 = Acquire(256, early_list);
+  EXPECT_NE(BackingAddress(buffer1), address0);
+
+  // Waiting on a different semaphore doesn't order after release.
+  iree_hal_semaphore_list_t other_list = {1, &other_semaphore, &release_value};
+  iree_hal_buffer_t* buffer2 = Acquire(256, other_list);
+  EXPECT_NE(BackingAddress(buffer2), address0);
+
+  // Waiting on a later value of the semaphore covers the release.
+  iree_hal_semaphore_t* wait_semaphores[2] = {other_semaphore, semaphore};
+  uint64_t wait_values[2] = {1ull, 3ull};
+  iree_hal_semaphore_list_t wait_list = {2, wait_semaphores, wait_values};
+  iree_hal_buffer_t* buffer3 = Acquire(256, wait_list);
+  EXPECT_EQ(BackingAddress(buffer3), address0);
+
+  iree_hal_buffer_release(buffer3);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_semaphore_release(other_semaphore);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Tests that every release timepoint must be reached or covered.
+TEST_F(QueuePoolTest, ReuseRequiresAllTimepoints) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_semaphore_t* semaphores[2] = {
+      TestSemaphore::Create(host_allocator_),
+      TestSemaphore::Create(host_allocator_),
+  };
+  uint64_t release_values[2] = {1ull, 1ull};
+  iree_hal_semaphore_list_t release_list = {2, semaphores, release_values};
+
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(
+      iree_hal_queue_pool_release_buffer(pool_, buffer0, release_list));
+
+  // Covering only the first timepoint is not enough.
+  iree_hal_semaphore_list_t wait_list = {1, &semaphores[0], &release_values[0]};
+  iree_hal_buffer_t* buffer1 = Acquire(256, wait_list);
+  EXPECT_NE(BackingAddress(buffer1), address0);
+
+  // Covering the first and having reached the second is.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[1], 1ull));
+  iree_hal_buffer_t* buffer2 = Acquire(256, wait_list);
+  EXPECT_EQ(BackingAddress(buffer2), address0);
+
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_semaphore_release(semaphores[1]);
+  iree_hal_semaphore_release(semaphores[0]);
+}
+
+// Tests that allocations released on a semaphore that has failed are never
+// reused by work not waiting on it.
+TEST_F(QueuePoolTest, NoReuseAfterFailure) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_semaphore_t* semaphore = TestSemaphore::Create(host_allocator_);
+  uint64_t release_value = 1ull;
+  iree_hal_semaphore_list_t release_list = {1, &semaphore, &release_value};
+
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(
+      iree_hal_queue_pool_release_buffer(pool_, buffer0, release_list));
+
+  iree_hal_semaphore_fail(semaphore,
+                          iree_make_status(IREE_STATUS_DATA_LOSS, "failed"));
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_NE(BackingAddress(buffer1), address0);
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Tests that free blocks are only reused for matching parameters and sizes no
+// more than twice the requested size.
+TEST_F(QueuePoolTest, ReuseMatchingRequests) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_buffer_t* buffer0 = Acquire(1024);
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, buffer0, iree_hal_semaphore_list_empty()));
+
+  // Larger than the free block.
+  iree_hal_buffer_t* buffer1 = Acquire(2048);
+  EXPECT_NE(BackingAddress(buffer1), address0);
+
+  // Less than half the size of the free block.
+  iree_hal_buffer_t* buffer2 = Acquire(256);
+  EXPECT_NE(BackingAddress(buffer2), address0);
+
+  // Different parameters.
+  iree_hal_buffer_params_t params = DefaultParams();
+  params.usage |= IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE;
+  iree_hal_buffer_t* buffer3 = Acquire(1024, iree_hal_semaphore_list_empty(),
+                                       params);
+  EXPECT_NE(BackingAddress(buffer3), address0);
+
+  // Smaller but within the reuse window.
+  iree_hal_buffer_t* buffer4 = Acquire(768);
+  EXPECT_EQ(BackingAddress(buffer4), address0);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer4), 768);
+
+  iree_hal_buffer_release(buffer4);
+  iree_hal_buffer_release(buffer3);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+}
+
+// Tests that the oldest free blocks are evicted once more than
+// |max_free_blocks| are retained.
+TEST_F(QueuePoolTest, EvictOldestAtMaxFreeBlocks) {
+  CreatePool(/*max_free_blocks=*/2);
+  iree_hal_buffer_t* buffers[3] = {Acquire(), Acquire(), Acquire()};
+  void* addresses[3];
+  for (int i = 0; i < 3; ++i) {
+    addresses[i] = BackingAddress(buffers[i]);
+    IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+        pool_, buffers[i], iree_hal_semaphore_list_empty()));
+  }
+
+  // The first block was evicted so only the last two are reused and the third
+  // acquisition makes a new allocation. The original buffers are still live so
+  // the new allocation can't have the address of the evicted block.
+  iree_hal_buffer_t* new_buffers[3] = {Acquire(), Acquire(), Acquire()};
+  EXPECT_EQ(BackingAddress(new_buffers[0]), addresses[1]);
+  EXPECT_EQ(BackingAddress(new_buffers[1]), addresses[2]);
+  void* new_address = BackingAddress(new_buffers[2]);
+  EXPECT_NE(new_address, addresses[0]);
+  EXPECT_NE(new_address, addresses[1]);
+  EXPECT_NE(new_address, addresses[2]);
+
+  for (int i = 0; i < 3; ++i) {
+    iree_hal_buffer_release(new_buffers[i]);
+    iree_hal_buffer_release(buffers[i]);
+  }
+}
+
+// Tests that dropping the last reference to a buffer that was never released
+// to the pool returns its allocation for immediate reuse.
+TEST_F(QueuePoolTest, WrapperDroppedWithoutRelease) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  iree_hal_buffer_release(buffer0);
+
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_EQ(BackingAddress(buffer1), address0);
+  iree_hal_buffer_release(buffer1);
+}
+
+// Tests that releasing a buffer more than once only returns it to the pool
+// once, including when the buffer is later dropped.
+TEST_F(QueuePoolTest, ReleaseOnce) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, buffer0, iree_hal_semaphore_list_empty()));
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, buffer0, iree_hal_semaphore_list_empty()));
+  iree_hal_buffer_release(buffer0);
+
+  iree_hal_buffer_t* buffer1 = Acquire();
+  iree_hal_buffer_t* buffer2 = Acquire();
+  EXPECT_EQ(BackingAddress(buffer1), address0);
+  EXPECT_NE(BackingAddress(buffer2), address0);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer1);
+}
+
+// Tests that subspans of pooled buffers release the whole allocation.
+TEST_F(QueuePoolTest, ReleaseSubspan) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  iree_hal_buffer_t* subspan = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_subspan(buffer0, 16, 64, host_allocator_,
+                                         &subspan));
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, subspan, iree_hal_semaphore_list_empty()));
+  iree_hal_buffer_release(subspan);
+
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_EQ(BackingAddress(buffer1), address0);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+}
+
+// Tests that buffers not acquired from the pool are ignored.
+TEST_F(QueuePoolTest, ReleaseForeignBuffers) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+
+  // Buffers allocated directly from the device allocator.
+  iree_hal_buffer_t* heap_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, DefaultParams(), 256, &heap_buffer));
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, heap_buffer, iree_hal_semaphore_list_empty()));
+  iree_hal_buffer_t* buffer0 = Acquire();
+  EXPECT_NE(BackingAddress(buffer0), BackingAddress(heap_buffer));
+
+  // Buffers acquired from another pool are ignored and still returned to
+  // their own pool when dropped.
+  iree_hal_queue_pool_t* other_pool = NULL;
+  IREE_ASSERT_OK(iree_hal_queue_pool_create(
+      IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS, host_allocator_,
+      &other_pool));
+  iree_hal_buffer_placement_t placement = {
+      /*.device=*/NULL,
+      /*.queue_affinity=*/IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*.flags=*/IREE_HAL_BUFFER_PLACEMENT_FLAG_ASYNCHRONOUS,
+  };
+  iree_hal_buffer_t* other_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_queue_pool_acquire(
+      other_pool, device_allocator_, placement,
+      iree_hal_semaphore_list_empty(), DefaultParams(), 256, &other_buffer));
+  void* other_address = BackingAddress(other_buffer);
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, other_buffer, iree_hal_semaphore_list_empty()));
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_NE(BackingAddress(buffer1), other_address);
+  iree_hal_buffer_release(other_buffer);
+  iree_hal_buffer_t* other_reused_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_queue_pool_acquire(
+      other_pool, device_allocator_, placement,
+      iree_hal_semaphore_list_empty(), DefaultParams(), 256,
+      &other_reused_buffer));
+  EXPECT_EQ(BackingAddress(other_reused_buffer), other_address);
+
+  iree_hal_buffer_release(other_reused_buffer);
+  iree_hal_queue_pool_release(other_pool);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(heap_buffer);
+}
+
+// Tests that trimming drops free blocks without affecting live buffers.
+TEST_F(QueuePoolTest, Trim) {
+  CreatePool(IREE_HAL_QUEUE_POOL_DEFAULT_MAX_FREE_BLOCKS);
+  iree_hal_buffer_t* buffer0 = Acquire();
+  void* address0 = BackingAddress(buffer0);
+  IREE_ASSERT_OK(iree_hal_queue_pool_release_buffer(
+      pool_, buffer0, iree_hal_semaphore_list_empty()));
+  iree_hal_queue_pool_trim(pool_);
+
+  // The released buffer is still live and retains its allocation.
+  iree_hal_buffer_t* buffer1 = Acquire();
+  EXPECT_NE(BackingAddress(buffer1), address0);
+  EXPECT_EQ(BackingAddress(buffer0), address0);
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer0);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,42 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_SCHEDULER_STATISTICS_H_
+#define IREE_HAL_UTILS_SCHEDULER_STATISTICS_H_
+
+// iree_hal_device_query_i64 category under which devices that schedule work
+// with an iree_task_executor_t (local-task) report scheduler statistics.
+// The "worker_count" key is the number of workers summed into the statistics.
+#define IREE_HAL_SCHEDULER_STATISTICS_CATEGORY "task.statistics"
+
+// Expands |X(name)| for each key reported under the scheduler statistics
+// category that is summed from the iree_task_worker_statistics_t of each
+// worker. Each name is the corresponding field name.
+#define IREE_HAL_SCHEDULER_WORKER_STATISTICS(X) \
+  X(task_count)                                 \
+  X(busy_ns)                                    \
+  X(idle_ns)                                    \
+  X(theft_attempt_count)                        \
+  X(theft_count)                                \
+  X(theft_ns)                                   \
+  X(mailbox_flush_count)                        \
+  X(mailbox_task_count)                         \
+  X(mailbox_max_depth)                          \
+  X(wake_count)                                 \
+  X(wake_latency_ns)
+
+// Expands |X(name)| for each key reported under the scheduler statistics
+// category that comes from an executor-level iree_task_executor_statistics_t
+// field of the same name.
+#define IREE_HAL_SCHEDULER_EXECUTOR_STATISTICS(X) \
+  X(coordinate_count)                             \
+  X(coordinate_ns)                                \
+  X(post_count)                                   \
+  X(posted_task_count)                            \
+  X(wake_request_count)                           \
+  X(donated_task_count)
+
+#endif  // IREE_HAL_UTILS_SCHEDULER_STATISTICS_H_
@@ -0,0 +1,818 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Must define _GNU_SOURCE before includes to get O_DIRECT from fcntl.h.
+#define _GNU_SOURCE
+
+#include "iree/hal/utils/uring_file.h"
+
+#if IREE_HAL_URING_FILE_ENABLE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "iree/base/internal/synchronization.h"
+
+// Required alignment of file offsets, lengths, and memory for O_DIRECT reads.
+// Logical block sizes are at most the page size on the platforms we target.
+#define IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT 4096
+
+//===----------------------------------------------------------------------===//
+// iree_hal_uring_t
+//===----------------------------------------------------------------------===//
+
+// A minimal single-threaded io_uring instance using the raw syscalls so that
+// we don't take a dependency on liburing. Only one thread may use a ring at a
+// time; files pool rings to support concurrent callers.
+typedef struct iree_hal_uring_t {
+  // Next ring in the owning file's free list.
+  struct iree_hal_uring_t* next;
+  // io_uring file descriptor.
+  int fd;
+  // Number of submission queue entries.
+  uint32_t sq_entries;
+
+  // Submission queue ring (shared with the kernel).
+  void* sq_ring_ptr;
+  size_t sq_ring_size;
+  uint32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t* sq_array;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+
+  // Completion queue ring (shared with the kernel). May alias sq_ring_ptr.
+  void* cq_ring_ptr;
+  size_t cq_ring_size;
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  struct io_uring_cqe* cqes;
+
+  // Bounce buffer used for direct I/O, registered with the ring if possible.
+  // NULL if direct I/O is not used.
+  uint8_t* bounce_buffer;
+  size_t bounce_size;
+  // True if |bounce_buffer| is registered and fixed-buffer ops can be used.
+  bool bounce_registered;
+} iree_hal_uring_t;
+
+static void iree_hal_uring_destroy(iree_hal_uring_t* ring,
+                                   iree_allocator_t host_allocator) {
+  if (!ring) return;
+  if (ring->bounce_buffer) munmap(ring->bounce_buffer, ring->bounce_size);
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring_ptr && ring->cq_ring_ptr != ring->sq_ring_ptr) {
+    munmap(ring->cq_ring_ptr, ring->cq_ring_size);
+  }
+  if (ring->sq_ring_ptr) munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+  if (ring->fd >= 0) close(ring->fd);
+  iree_allocator_free(host_allocator, ring);
+}
+
+// Maps the ring region at |offset| of the io_uring |fd|.
+static void* iree_hal_uring_map(int fd, size_t size, off_t offset) {
+  void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, offset);
+  return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+// Creates a ring with at least |entries| submission queue entries. If
+// |bounce_size| is non-zero a bounce buffer of that size is allocated for
+// direct I/O and registered with the ring.
+static iree_status_t iree_hal_uring_create(uint32_t entries,
+                                           iree_host_size_t bounce_size,
+                                           iree_allocator_t host_allocator,
+                                           iree_hal_uring_t** out_ring) {
+  *out_ring = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_uring_t* ring = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*ring), (void**)&ring));
+  ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (ring->fd < 0) {
+    const int error_number = errno;
+    iree_hal_uring_destroy(ring, host_allocator);
+    IREE_TRACE_ZONE_END(z0);
+    // Kernels built without io_uring, or sandboxes that deny it, are expected
+    // and callers fall back to other implementations.
+    if (error_number == ENOSYS || error_number == EPERM ||
+        error_number == EACCES) {
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "io_uring is not available (errno %d)",
+                              error_number);
+    }
+    return iree_make_status(iree_status_code_from_errno(error_number),
+                            "io_uring_setup failed");
+  }
+  ring->sq_entries = params.sq_entries;
+
+  iree_status_t status = iree_ok_status();
+  ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    ring->sq_ring_size = iree_max(ring->sq_ring_size, ring->cq_ring_size);
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+  ring->sq_ring_ptr =
+      iree_hal_uring_map(ring->fd, ring->sq_ring_size, IORING_OFF_SQ_RING);
+  if (!ring->sq_ring_ptr) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to map io_uring submission queue");
+  }
+  if (iree_status_is_ok(status)) {
+    ring->cq_ring_ptr =
+        (params.features & IORING_FEAT_SINGLE_MMAP)
+            ? ring->sq_ring_ptr
+            : iree_hal_uring_map(ring->fd, ring->cq_ring_size,
+                                 IORING_OFF_CQ_RING);
+    if (!ring->cq_ring_ptr) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to map io_uring completion queue");
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)iree_hal_uring_map(
+        ring->fd, ring->sqes_size, IORING_OFF_SQES);
+    if (!ring->sqes) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to map io_uring submission entries");
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    uint8_t* sq_ring = (uint8_t*)ring->sq_ring_ptr;
+    ring->sq_tail = (uint32_t*)(sq_ring + params.sq_off.tail);
+    ring->sq_mask = *(uint32_t*)(sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t*)(sq_ring + params.sq_off.array);
+    uint8_t* cq_ring = (uint8_t*)ring->cq_ring_ptr;
+    ring->cq_head = (uint32_t*)(cq_ring + params.cq_off.head);
+    ring->cq_tail = (uint32_t*)(cq_ring + params.cq_off.tail);
+    ring->cq_mask = *(uint32_t*)(cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq_ring + params.cq_off.cqes);
+  }
+
+  // Allocate and register the bounce buffer. Registration pins the pages once
+  // instead of on every request; it can fail if the locked memory limit is too
+  // low in which case we still use the buffer with regular reads.
+  if (iree_status_is_ok(status) && bounce_size > 0) {
+    void* bounce_buffer = mmap(NULL, bounce_size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bounce_buffer == MAP_FAILED) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to allocate direct I/O bounce buffer");
+    } else {
+      ring->bounce_buffer = (uint8_t*)bounce_buffer;
+      ring->bounce_size = bounce_size;
+      struct iovec iov = {
+          .iov_base = ring->bounce_buffer,
+          .iov_len = ring->bounce_size,
+      };
+      ring->bounce_registered = syscall(__NR_io_uring_register, ring->fd,
+                                        IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+      IREE_TRACE_ZONE_APPEND_TEXT(
+          z0, ring->bounce_registered ? "registered" : "unregistered");
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_ring = ring;
+  } else {
+    iree_hal_uring_destroy(ring, host_allocator);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the next free submission entry. Callers must ensure fewer than
+// sq_entries entries are pending submission.
+static struct io_uring_sqe* iree_hal_uring_next_sqe(iree_hal_uring_t* ring) {
+  const uint32_t tail = *ring->sq_tail;
+  const uint32_t index = tail & ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  // Publish the entry to the kernel; it's only read on io_uring_enter so the
+  // contents written after this but before entering are still observed.
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  return sqe;
+}
+
+// Submits |submit_count| pending entries and waits for at least |wait_count|
+// completions.
+static iree_status_t iree_hal_uring_enter(iree_hal_uring_t* ring,
+                                          uint32_t submit_count,
+                                          uint32_t wait_count) {
+  while (submit_count > 0 || wait_count > 0) {
+    const long result =
+        syscall(__NR_io_uring_enter, ring->fd, submit_count, wait_count,
+                wait_count ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (result < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "io_uring_enter failed");
+    }
+    // Waits are satisfied once the kernel returns from a GETEVENTS enter.
+    submit_count -= iree_min(submit_count, (uint32_t)result);
+    wait_count = 0;
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Batched transfers
+//===----------------------------------------------------------------------===//
+
+// A single transfer request in flight on a ring.
+typedef struct iree_hal_uring_request_t {
+  // File offset of the next byte to transfer.
+  uint64_t file_offset;
+  // Memory address of the next byte to transfer.
+  uint8_t* ptr;
+  // Bytes remaining in the request.
+  uint32_t length;
+  // For direct reads through the bounce buffer: user range covered by the
+  // request to copy out of the bounce buffer once the read completes. NULL if
+  // the request transfers directly to or from user memory.
+  uint8_t* copy_target;
+  const uint8_t* copy_source;
+  uint32_t copy_length;
+} iree_hal_uring_request_t;
+
+// Describes a transfer of |length| bytes between |file_offset| in the file and
+// |ptr| in host memory split into requests of at most |request_size|.
+typedef struct iree_hal_uring_transfer_t {
+  int fd;
+  bool is_write;
+  // Reads are direct I/O and go through the ring bounce buffer with aligned
+  // windows unless the user memory and range are already aligned.
+  bool use_bounce;
+  uint32_t queue_depth;
+  uint32_t request_size;
+  uint64_t file_offset;
+  uint8_t* ptr;
+  uint64_t length;
+} iree_hal_uring_transfer_t;
+
+// Enqueues the remainder of |request| at |request_index| on the ring.
+static void iree_hal_uring_enqueue_request(
+    iree_hal_uring_t* ring, const iree_hal_uring_transfer_t* transfer,
+    uint32_t request_index, const iree_hal_uring_request_t* request) {
+  struct io_uring_sqe* sqe = iree_hal_uring_next_sqe(ring);
+  if (transfer->is_write) {
+    sqe->opcode = IORING_OP_WRITE;
+  } else if (request->copy_target && ring->bounce_registered) {
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->buf_index = 0;
+  } else {
+    sqe->opcode = IORING_OP_READ;
+  }
+  sqe->fd = transfer->fd;
+  sqe->off = request->file_offset;
+  sqe->addr = (uint64_t)(uintptr_t)request->ptr;
+  sqe->len = request->length;
+  sqe->user_data = request_index;
+}
+
+// Initializes |request| to cover the next portion of |transfer| starting at
+// |*cursor| and advances the cursor. Requests never cross request_size
+// boundaries in the file so that aligned direct I/O windows fit in one bounce
+// buffer slot. Direct I/O requests whose file range and user memory are both
+// aligned read into the user memory without going through the bounce buffer.
+static void iree_hal_uring_prepare_request(
+    iree_hal_uring_t* ring, const iree_hal_uring_transfer_t* transfer,
+    uint32_t request_index, uint64_t* cursor,
+    iree_hal_uring_request_t* request) {
+  const uint64_t file_start = transfer->file_offset + *cursor;
+  const uint64_t file_end = iree_min(
+      transfer->file_offset + transfer->length,
+      (file_start / transfer->request_size + 1) * transfer->request_size);
+  uint8_t* user_ptr = transfer->ptr + *cursor;
+  const uint32_t user_length = (uint32_t)(file_end - file_start);
+  *cursor += user_length;
+  const bool is_aligned =
+      iree_host_size_has_alignment((iree_host_size_t)file_start,
+                                   IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT) &&
+      iree_host_size_has_alignment((iree_host_size_t)user_length,
+                                   IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT) &&
+      iree_host_size_has_alignment((iree_host_size_t)user_ptr,
+                                   IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT);
+  if (!transfer->use_bounce || is_aligned) {
+    request->file_offset = file_start;
+    request->ptr = user_ptr;
+    request->length = user_length;
+    request->copy_target = NULL;
+    request->copy_source = NULL;
+    request->copy_length = 0;
+    return;
+  }
+  const uint64_t window_start =
+      file_start & ~(uint64_t)(IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT - 1);
+  const uint64_t window_end =
+      iree_align_uint64(file_end, IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT);
+  uint8_t* slot =
+      ring->bounce_buffer + (size_t)request_index * transfer->request_size;
+  request->file_offset = window_start;
+  request->ptr = slot;
+  request->length = (uint32_t)(window_end - window_start);
+  request->copy_target = user_ptr;
+  request->copy_source = slot + (file_start - window_start);
+  request->copy_length = user_length;
+}
+
+// Performs |transfer| keeping up to queue_depth requests in flight.
+// Short transfers are resubmitted for the remainder. On failure all requests
+// in flight are drained before returning so the kernel no longer references
+// the memory.
+static iree_status_t iree_hal_uring_transfer(
+    iree_hal_uring_t* ring, const iree_hal_uring_transfer_t* transfer,
+    iree_hal_uring_request_t* requests) {
+  iree_status_t status = iree_ok_status();
+  uint64_t cursor = 0;
+  uint32_t inflight_count = 0;
+  uint32_t pending_count = 0;
+
+  // Fill the queue.
+  for (uint32_t i = 0; i < transfer->queue_depth && cursor < transfer->length;
+       ++i) {
+    iree_hal_uring_prepare_request(ring, transfer, i, &cursor, &requests[i]);
+    iree_hal_uring_enqueue_request(ring, transfer, i, &requests[i]);
+    ++pending_count;
+  }
+
+  while (pending_count > 0 || inflight_count > 0) {
+    iree_status_t enter_status =
+        iree_hal_uring_enter(ring, pending_count, inflight_count ? 1 : 0);
+    if (!iree_status_is_ok(enter_status)) {
+      // If we can't enter the ring we can't drain it either; the caller must
+      // destroy the ring to cancel any requests still in flight.
+      return iree_status_join(status, enter_status);
+    }
+    inflight_count += pending_count;
+    pending_count = 0;
+
+    // Process all available completions.
+    uint32_t head = *ring->cq_head;
+    const uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+      const uint32_t request_index = (uint32_t)cqe->user_data;
+      const int32_t result = cqe->res;
+      iree_hal_uring_request_t* request = &requests[request_index];
+      --inflight_count;
+      if (!iree_status_is_ok(status)) continue;  // draining
+      if (result < 0) {
+        status = iree_make_status(iree_status_code_from_errno(-result),
+                                  "failed to %s file range",
+                                  transfer->is_write ? "write" : "read");
+        continue;
+      }
+
+      // Direct reads may end early at the end of the file but only need to
+      // cover the user range.
+      const uint32_t transferred = (uint32_t)result;
+      if (request->copy_target) {
+        const uint64_t needed = (request->copy_source - request->ptr) +
+                                request->copy_length;
+        if (transferred < request->length && transferred >= needed) {
+          request->length = transferred;
+        }
+      }
+      if (transferred == 0) {
+        status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                  "end of file hit during %s",
+                                  transfer->is_write ? "write" : "read");
+        continue;
+      } else if (transferred < request->length) {
+        // Short transfer; resubmit the remainder.
+        request->file_offset += transferred;
+        request->ptr += transferred;
+        request->length -= transferred;
+        iree_hal_uring_enqueue_request(ring, transfer, request_index, request);
+        ++pending_count;
+        continue;
+      }
+
+      // Request complete: copy out of the bounce buffer and issue the next.
+      if (request->copy_target) {
+        memcpy(request->copy_target, request->copy_source,
+               request->copy_length);
+      }
+      if (cursor < transfer->length) {
+        iree_hal_uring_prepare_request(ring, transfer, request_index, &cursor,
+                                       request);
+        iree_hal_uring_enqueue_request(ring, transfer, request_index, request);
+        ++pending_count;
+      }
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    // Entries enqueued after a failure are still submitted so that the ring
+    // state stays consistent; they complete and are ignored while draining.
+  }
+
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_uring_file_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_uring_file_t {
+  iree_hal_resource_t resource;
+  // Used to allocate this structure.
+  iree_allocator_t host_allocator;
+  // Allowed access bits.
+  iree_hal_memory_access_t access;
+  // Base file handle, retained.
+  iree_io_file_handle_t* handle;
+  // File descriptor, unretained (the handle retains it).
+  int fd;
+  // Descriptor opened with O_DIRECT for reads or -1 if not using direct I/O.
+  int direct_fd;
+  // Total file (stream) length in bytes as queried on creation.
+  uint64_t length;
+  // Maximum number of requests in flight per operation.
+  uint32_t queue_depth;
+  // Bytes per request.
+  uint32_t request_size;
+  // Maximum number of rings created.
+  uint32_t max_ring_count;
+
+  // Guards the ring pool.
+  iree_slim_mutex_t mutex;
+  // Total number of rings created, including those in use.
+  uint32_t ring_count IREE_GUARDED_BY(mutex);
+  // Rings not currently in use by an operation.
+  iree_hal_uring_t* free_rings IREE_GUARDED_BY(mutex);
+  // Posted when a ring is returned to the pool or destroyed.
+  iree_notification_t ring_notification;
+} iree_hal_uring_file_t;
+
+static const iree_hal_file_vtable_t iree_hal_uring_file_vtable;
+
+static iree_hal_uring_file_t* iree_hal_uring_file_cast(
+    iree_hal_file_t* IREE_RESTRICT base_value) {
+  return (iree_hal_uring_file_t*)base_value;
+}
+
+static iree_status_t iree_hal_uring_file_create_ring(
+    iree_hal_uring_file_t* file, iree_hal_uring_t** out_ring) {
+  const iree_host_size_t bounce_size =
+      file->direct_fd >= 0 ? (iree_host_size_t)file->queue_depth *
+                                 file->request_size
+                           : 0;
+  return iree_hal_uring_create(file->queue_depth, bounce_size,
+                               file->host_allocator, out_ring);
+}
+
+// State for iree_hal_uring_file_try_acquire_ring.
+typedef struct iree_hal_uring_file_acquire_t {
+  iree_hal_uring_file_t* file;
+  // Ring taken from the pool, if any.
+  iree_hal_uring_t* ring;
+  // True if the caller may create a new ring.
+  bool create;
+} iree_hal_uring_file_acquire_t;
+
+// Takes a free ring from the pool or reserves room for a new one.
+// Returns false if all rings are in use and no more may be created.
+static bool iree_hal_uring_file_try_acquire_ring(void* arg) {
+  iree_hal_uring_file_acquire_t* acquire =
+      (iree_hal_uring_file_acquire_t*)arg;
+  iree_hal_uring_file_t* file = acquire->file;
+  iree_slim_mutex_lock(&file->mutex);
+  if (file->free_rings) {
+    acquire->ring = file->free_rings;
+    file->free_rings = acquire->ring->next;
+  } else if (file->ring_count < file->max_ring_count) {
+    ++file->ring_count;
+    acquire->create = true;
+  }
+  iree_slim_mutex_unlock(&file->mutex);
+  return acquire->ring || acquire->create;
+}
+
+// Acquires a ring for exclusive use by the caller, waiting for one to be
+// released if the file already has max_ring_count rings in use.
+static iree_status_t iree_hal_uring_file_acquire_ring(
+    iree_hal_uring_file_t* file, iree_hal_uring_t** out_ring) {
+  iree_hal_uring_file_acquire_t acquire = {
+      .file = file,
+      .ring = NULL,
+      .create = false,
+  };
+  iree_notification_await(&file->ring_notification,
+                          iree_hal_uring_file_try_acquire_ring, &acquire,
+                          iree_infinite_timeout());
+  if (acquire.ring) {
+    acquire.ring->next = NULL;
+    *out_ring = acquire.ring;
+    return iree_ok_status();
+  }
+  iree_status_t status = iree_hal_uring_file_create_ring(file, out_ring);
+  if (!iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&file->mutex);
+    --file->ring_count;
+    iree_slim_mutex_unlock(&file->mutex);
+    iree_notification_post(&file->ring_notification, 1);
+  }
+  return status;
+}
+
+// Returns a ring acquired with iree_hal_uring_file_acquire_ring to the pool.
+static void iree_hal_uring_file_release_ring(iree_hal_uring_file_t* file,
+                                             iree_hal_uring_t* ring) {
+  iree_slim_mutex_lock(&file->mutex);
+  ring->next = file->free_rings;
+  file->free_rings = ring;
+  iree_slim_mutex_unlock(&file->mutex);
+  iree_notification_post(&file->ring_notification, 1);
+}
+
+// Destroys a ring acquired with iree_hal_uring_file_acquire_ring instead of
+// returning it to the pool.
+static void iree_hal_uring_file_discard_ring(iree_hal_uring_file_t* file,
+                                             iree_hal_uring_t* ring) {
+  iree_hal_uring_destroy(ring, file->host_allocator);
+  iree_slim_mutex_lock(&file->mutex);
+  --file->ring_count;
+  iree_slim_mutex_unlock(&file->mutex);
+  iree_notification_post(&file->ring_notification, 1);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_uring_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    const iree_hal_uring_file_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+
+  iree_io_file_handle_primitive_t primitive =
+      iree_io_file_handle_primitive(handle);
+  if (primitive.type != IREE_IO_FILE_HANDLE_TYPE_FD) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "support for creating non-fd files not supported");
+  }
+  const int fd = primitive.value.fd;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Query the file length. This also acts as a quick check that the file
+  // descriptor is accessible.
+  struct stat stat_buffer = {0};
+  if (fstat(fd, &stat_buffer) == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to stat file descriptor length");
+  }
+  if (iree_all_bits_set(access, IREE_HAL_MEMORY_ACCESS_READ) &&
+      !(stat_buffer.st_mode & S_IRUSR)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_PERMISSION_DENIED,
+        "read access requested on a file descriptor that is not readable");
+  } else if (iree_all_bits_set(access, IREE_HAL_MEMORY_ACCESS_WRITE) &&
+             !(stat_buffer.st_mode & S_IWUSR)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "write access requested on a file descriptor that "
+                            "is not writable");
+  }
+
+  iree_hal_uring_file_t* file = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*file), (void**)&file));
+  iree_hal_resource_initialize(&iree_hal_uring_file_vtable, &file->resource);
+  file->host_allocator = host_allocator;
+  file->access = access;
+  file->handle = handle;
+  iree_io_file_handle_retain(file->handle);
+  file->fd = fd;
+  file->direct_fd = -1;
+  file->length = (uint64_t)stat_buffer.st_size;
+  file->queue_depth = options->queue_depth
+                          ? options->queue_depth
+                          : IREE_HAL_URING_FILE_DEFAULT_QUEUE_DEPTH;
+  file->request_size = options->request_size
+                           ? options->request_size
+                           : IREE_HAL_URING_FILE_DEFAULT_REQUEST_SIZE;
+  file->max_ring_count = options->max_ring_count
+                             ? options->max_ring_count
+                             : IREE_HAL_URING_FILE_DEFAULT_MAX_RING_COUNT;
+  iree_slim_mutex_initialize(&file->mutex);
+  iree_notification_initialize(&file->ring_notification);
+
+  // Reopen the file with O_DIRECT if requested. Not all file systems support
+  // it (tmpfs, some network file systems) and we fall back to buffered reads
+  // if the reopen fails.
+  if (iree_all_bits_set(options->flags, IREE_HAL_URING_FILE_FLAG_DIRECT_IO)) {
+    file->request_size = (uint32_t)iree_align_uint64(
+        file->request_size, IREE_HAL_URING_FILE_DIRECT_IO_ALIGNMENT);
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    file->direct_fd = open(path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    IREE_TRACE_ZONE_APPEND_TEXT(
+        z0, file->direct_fd >= 0 ? "direct" : "direct unsupported");
+  }
+
+  // Create the first ring eagerly to verify io_uring is usable.
+  iree_hal_uring_t* ring = NULL;
+  iree_status_t status = iree_hal_uring_file_create_ring(file, &ring);
+  if (iree_status_is_ok(status)) {
+    file->ring_count = 1;
+    file->free_rings = ring;
+    *out_file = (iree_hal_file_t*)file;
+  } else {
+    iree_hal_file_release((iree_hal_file_t*)file);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_uring_file_destroy(
+    iree_hal_file_t* IREE_RESTRICT base_file) {
+  iree_hal_uring_file_t* file = iree_hal_uring_file_cast(base_file);
+  iree_allocator_t host_allocator = file->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  while (file->free_rings) {
+    iree_hal_uring_t* ring = file->free_rings;
+    file->free_rings = ring->next;
+    iree_hal_uring_destroy(ring, host_allocator);
+  }
+  iree_notification_deinitialize(&file->ring_notification);
+  iree_slim_mutex_deinitialize(&file->mutex);
+  if (file->direct_fd >= 0) close(file->direct_fd);
+  iree_io_file_handle_release(file->handle);
+
+  iree_allocator_free(host_allocator, file);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_hal_memory_access_t iree_hal_uring_file_allowed_access(
+    iree_hal_file_t* base_file) {
+  iree_hal_uring_file_t* file = iree_hal_uring_file_cast(base_file);
+  return file->access;
+}
+
+static uint64_t iree_hal_uring_file_length(iree_hal_file_t* base_file) {
+  iree_hal_uring_file_t* file = iree_hal_uring_file_cast(base_file);
+  return file->length;
+}
+
+static iree_hal_buffer_t* iree_hal_uring_file_storage_buffer(
+    iree_hal_file_t* base_file) {
+  return NULL;
+}
+
+static bool iree_hal_uring_file_supports_synchronous_io(
+    iree_hal_file_t* base_file) {
+  return true;
+}
+
+// Transfers |length| bytes between |file_offset| and host memory at |ptr|.
+static iree_status_t iree_hal_uring_file_transfer(iree_hal_uring_file_t* file,
+                                                  bool is_write,
+                                                  uint64_t file_offset,
+                                                  uint8_t* ptr,
+                                                  uint64_t length) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, length);
+
+  const bool use_direct = !is_write && file->direct_fd >= 0;
+  const iree_hal_uring_transfer_t transfer = {
+      .fd = use_direct ? file->direct_fd : file->fd,
+      .is_write = is_write,
+      .use_bounce = use_direct,
+      .queue_depth = file->queue_depth,
+      .request_size = file->request_size,
+      .file_offset = file_offset,
+      .ptr = ptr,
+      .length = length,
+  };
+
+  // Request state lives on the stack for typical queue depths.
+  iree_hal_uring_request_t inline_requests[32];
+  iree_hal_uring_request_t* requests = inline_requests;
+  if (file->queue_depth > IREE_ARRAYSIZE(inline_requests)) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(file->host_allocator,
+                                  file->queue_depth * sizeof(requests[0]),
+                                  (void**)&requests));
+  }
+
+  iree_hal_uring_t* ring = NULL;
+  iree_status_t status = iree_hal_uring_file_acquire_ring(file, &ring);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_uring_transfer(ring, &transfer, requests);
+    if (iree_status_is_ok(status)) {
+      iree_hal_uring_file_release_ring(file, ring);
+    } else {
+      // Failed rings may still have requests in flight; tearing them down
+      // cancels the requests before the memory is returned to the caller.
+      iree_hal_uring_file_discard_ring(file, ring);
+    }
+  }
+
+  if (requests != inline_requests) {
+    iree_allocator_free(file->host_allocator, requests);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_uring_file_read(iree_hal_file_t* base_file,
+                                              uint64_t file_offset,
+                                              iree_hal_buffer_t* buffer,
+                                              iree_device_size_t buffer_offset,
+                                              iree_device_size_t length) {
+  if (length == 0) return iree_ok_status();
+  iree_hal_uring_file_t* file = iree_hal_uring_file_cast(base_file);
+
+  iree_hal_buffer_mapping_t mapping = {{0}};
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, buffer_offset, length, &mapping));
+
+  iree_status_t status = iree_hal_uring_file_transfer(
+      file, /*is_write=*/false, file_offset, mapping.contents.data,
+      mapping.contents.data_length);
+
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_flush_range(&mapping, 0, length);
+  }
+
+  return iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+}
+
+static iree_status_t iree_hal_uring_file_write(iree_hal_file_t* base_file,
+                                               uint64_t file_offset,
+                                               iree_hal_buffer_t* buffer,
+                                               iree_device_size_t buffer_offset,
+                                               iree_device_size_t length) {
+  if (length == 0) return iree_ok_status();
+  iree_hal_uring_file_t* file = iree_hal_uring_file_cast(base_file);
+
+  iree_hal_buffer_mapping_t mapping = {{0}};
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ,
+      buffer_offset, length, &mapping));
+
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_invalidate_range(&mapping, 0, length);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_uring_file_transfer(file, /*is_write=*/true, file_offset,
+                                          mapping.contents.data,
+                                          mapping.contents.data_length);
+  }
+
+  return iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+}
+
+static const iree_hal_file_vtable_t iree_hal_uring_file_vtable = {
+    .destroy = iree_hal_uring_file_destroy,
+    .allowed_access = iree_hal_uring_file_allowed_access,
+    .length = iree_hal_uring_file_length,
+    .storage_buffer = iree_hal_uring_file_storage_buffer,
+    .supports_synchronous_io = iree_hal_uring_file_supports_synchronous_io,
+    .read = iree_hal_uring_file_read,
+    .write = iree_hal_uring_file_write,
+};
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_hal_uring_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    const iree_hal_uring_file_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "io_uring file support is not available in this "
+                          "build or on this platform");
+}
+
+#endif  // IREE_HAL_URING_FILE_ENABLE
@@ -0,0 +1,90 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_URING_FILE_H_
+#define IREE_HAL_UTILS_URING_FILE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/file_handle.h"
+
+#if !defined(IREE_HAL_URING_FILE_ENABLE)
+#if IREE_FILE_IO_ENABLE && defined(IREE_PLATFORM_LINUX) && \
+    !defined(IREE_PLATFORM_ANDROID) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IREE_HAL_URING_FILE_ENABLE 1
+#endif  // __has_include(<linux/io_uring.h>)
+#endif  // IREE_FILE_IO_ENABLE && IREE_PLATFORM_LINUX
+#if !defined(IREE_HAL_URING_FILE_ENABLE)
+#define IREE_HAL_URING_FILE_ENABLE 0
+#endif  // !IREE_HAL_URING_FILE_ENABLE
+#endif  // !IREE_HAL_URING_FILE_ENABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_uring_file_t
+//===----------------------------------------------------------------------===//
+
+// Default number of requests each read or write keeps in flight.
+#define IREE_HAL_URING_FILE_DEFAULT_QUEUE_DEPTH 16
+
+// Default number of bytes transferred by each request.
+#define IREE_HAL_URING_FILE_DEFAULT_REQUEST_SIZE (512 * 1024)
+
+// Default maximum number of rings each file creates for concurrent callers.
+#define IREE_HAL_URING_FILE_DEFAULT_MAX_RING_COUNT 8
+
+typedef uint32_t iree_hal_uring_file_flags_t;
+enum iree_hal_uring_file_flag_bits_t {
+  IREE_HAL_URING_FILE_FLAG_NONE = 0u,
+  // Reads bypass the page cache (O_DIRECT) by way of a second descriptor
+  // reopened from the file handle. Reads are performed in aligned windows into
+  // bounce buffers registered with the ring and copied out so that targets and
+  // ranges need not be aligned. Writes always use the page cache.
+  IREE_HAL_URING_FILE_FLAG_DIRECT_IO = 1u << 0,
+};
+
+// Options controlling how a file issues I/O.
+// Zero-initialize for defaults.
+typedef struct iree_hal_uring_file_options_t {
+  iree_hal_uring_file_flags_t flags;
+  // Maximum number of requests in flight per read/write or 0 for
+  // IREE_HAL_URING_FILE_DEFAULT_QUEUE_DEPTH.
+  uint32_t queue_depth;
+  // Bytes transferred per request or 0 for
+  // IREE_HAL_URING_FILE_DEFAULT_REQUEST_SIZE.
+  uint32_t request_size;
+  // Maximum number of rings (and with direct I/O their bounce buffers) the
+  // file creates or 0 for IREE_HAL_URING_FILE_DEFAULT_MAX_RING_COUNT. Callers
+  // beyond this many wait for another to finish its read or write.
+  uint32_t max_ring_count;
+} iree_hal_uring_file_options_t;
+
+// Creates a file backed by |handle| on disk that issues I/O through io_uring.
+// Only supports file handles of IREE_IO_FILE_HANDLE_TYPE_FD.
+//
+// Each synchronous read or write splits its range into |request_size| requests
+// and submits up to |queue_depth| of them in a single batch so that one
+// caller keeps the storage device busy. Rings are created on demand up to
+// |max_ring_count| and pooled so that multiple threads may perform I/O on the
+// file concurrently.
+//
+// Returns IREE_STATUS_UNAVAILABLE if io_uring is not supported by the platform
+// or is disallowed (kernel configuration, seccomp policies, etc); callers
+// should fall back to iree_hal_fd_file_from_handle.
+IREE_API_EXPORT iree_status_t iree_hal_uring_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    const iree_hal_uring_file_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_URING_FILE_H_
@@ -0,0 +1,425 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/uring_file.h"
+
+#if IREE_HAL_URING_FILE_ENABLE
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+using ::testing::ContainerEq;
+
+class UringFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("test"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+  }
+
+  void TearDown() override {
+    if (handle_) iree_io_file_handle_release(handle_);
+    iree_hal_allocator_release(device_allocator_);
+  }
+
+  // Creates a temporary file with |length| bytes of patterned contents and
+  // opens a handle to it. The file is unlinked immediately and removed when
+  // the handle is closed.
+  void CreateTempFile(iree_host_size_t length) {
+    const char* tmpdir = getenv("TEST_TMPDIR");
+    if (!tmpdir) tmpdir = getenv("TMPDIR");
+    if (!tmpdir) tmpdir = "/tmp";
+    std::string path = std::string(tmpdir) + "/iree_uring_file_test_XXXXXX";
+    int fd = mkstemp(&path[0]);
+    ASSERT_GE(fd, 0);
+    unlink(path.c_str());
+    contents_.resize(length);
+    for (iree_host_size_t i = 0; i < length; ++i) {
+      contents_[i] = static_cast<uint8_t>((i * 31) ^ (i >> 9));
+    }
+    ASSERT_EQ(pwrite(fd, contents_.data(), contents_.size(), 0),
+              static_cast<ssize_t>(contents_.size()));
+    IREE_ASSERT_OK(iree_io_file_handle_open_fd(
+        IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE, fd,
+        iree_allocator_system(), &handle_));
+    close(fd);
+  }
+
+  // Creates a file for the temporary file. Returns false if io_uring is not
+  // available in which case the test should be skipped.
+  bool CreateFile(iree_hal_uring_file_flags_t flags, uint32_t queue_depth,
+                  uint32_t request_size, iree_hal_file_t** out_file,
+                  uint32_t max_ring_count = 0) {
+    iree_hal_uring_file_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.flags = flags;
+    options.queue_depth = queue_depth;
+    options.request_size = request_size;
+    options.max_ring_count = max_ring_count;
+    iree_status_t status = iree_hal_uring_file_from_handle(
+        IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, handle_,
+        &options, iree_allocator_system(), out_file);
+    if (iree_status_is_unavailable(status)) {
+      iree_status_ignore(status);
+      return false;
+    }
+    IREE_CHECK_OK(status);
+    return true;
+  }
+
+  iree_hal_buffer_t* CreateBuffer(iree_device_size_t length, uint8_t value) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                     length, &buffer));
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_fill(buffer, 0, length, &value, sizeof(value)));
+    return buffer;
+  }
+
+  std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer,
+                                  iree_device_size_t offset,
+                                  iree_device_size_t length) {
+    std::vector<uint8_t> data(length);
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, offset, data.data(), data.size()));
+    return data;
+  }
+
+  std::vector<uint8_t> ReadFileContents() {
+    int fd = iree_io_file_handle_primitive(handle_).value.fd;
+    struct stat stat_buffer = {0};
+    IREE_CHECK_OK(fstat(fd, &stat_buffer) == 0
+                      ? iree_ok_status()
+                      : iree_make_status(IREE_STATUS_INTERNAL));
+    std::vector<uint8_t> data(stat_buffer.st_size);
+    EXPECT_EQ(pread(fd, data.data(), data.size(), 0),
+              static_cast<ssize_t>(data.size()));
+    return data;
+  }
+
+  std::vector<uint8_t> Contents(uint64_t offset, iree_host_size_t length) {
+    return std::vector<uint8_t>(contents_.begin() + offset,
+                                contents_.begin() + offset + length);
+  }
+
+  // Reads |length| bytes at |file_offset| with |file| into a new buffer at an
+  // unaligned offset and verifies the contents.
+  void ExpectRead(iree_hal_file_t* file, uint64_t file_offset,
+                  iree_device_size_t length) {
+    const iree_device_size_t buffer_offset = 3;
+    iree_hal_buffer_t* buffer = CreateBuffer(buffer_offset + length + 5, 0xCD);
+    IREE_EXPECT_OK(
+        iree_hal_file_read(file, file_offset, buffer, buffer_offset, length));
+    EXPECT_THAT(ReadBuffer(buffer, buffer_offset, length),
+                ContainerEq(Contents(file_offset, length)));
+    EXPECT_THAT(ReadBuffer(buffer, 0, buffer_offset),
+                ContainerEq(std::vector<uint8_t>(buffer_offset, 0xCD)));
+    EXPECT_THAT(ReadBuffer(buffer, buffer_offset + length, 5),
+                ContainerEq(std::vector<uint8_t>(5, 0xCD)));
+    iree_hal_buffer_release(buffer);
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  iree_io_file_handle_t* handle_ = NULL;
+  std::vector<uint8_t> contents_;
+};
+
+// Reads ranges spanning many requests and more requests than the queue depth.
+TEST_F(UringFileTest, Read) {
+  CreateTempFile(64 * 1024 + 123);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_NONE, /*queue_depth=*/4,
+                  /*request_size=*/4096, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  EXPECT_EQ(iree_hal_file_length(file), contents_.size());
+  EXPECT_TRUE(iree_hal_file_supports_synchronous_io(file));
+  EXPECT_EQ(iree_hal_file_storage_buffer(file), nullptr);
+
+  ExpectRead(file, 0, contents_.size());
+  ExpectRead(file, 1, 4096);
+  ExpectRead(file, 4095, 2);
+  ExpectRead(file, 777, 40000);
+  ExpectRead(file, contents_.size() - 1, 1);
+
+  iree_hal_file_release(file);
+}
+
+// Writes ranges spanning many requests and reads them back.
+TEST_F(UringFileTest, Write) {
+  CreateTempFile(64 * 1024 + 123);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_NONE, /*queue_depth=*/4,
+                  /*request_size=*/4096, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  const uint64_t file_offset = 1001;
+  const iree_device_size_t length = 30000;
+  iree_hal_buffer_t* buffer = CreateBuffer(length + 7, 0x5A);
+  IREE_ASSERT_OK(iree_hal_file_write(file, file_offset, buffer, 7, length));
+  iree_hal_buffer_release(buffer);
+
+  std::fill_n(contents_.begin() + file_offset, length, 0x5A);
+  EXPECT_THAT(ReadFileContents(), ContainerEq(contents_));
+  ExpectRead(file, 0, contents_.size());
+
+  iree_hal_file_release(file);
+}
+
+// Zero-length operations succeed without touching the file.
+TEST_F(UringFileTest, ZeroLength) {
+  CreateTempFile(4096);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_NONE, 0, 0, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  iree_hal_buffer_t* buffer = CreateBuffer(16, 0xCD);
+  IREE_EXPECT_OK(iree_hal_file_read(file, 100000, buffer, 0, 0));
+  IREE_EXPECT_OK(iree_hal_file_write(file, 0, buffer, 0, 0));
+  iree_hal_buffer_release(buffer);
+  EXPECT_THAT(ReadFileContents(), ContainerEq(contents_));
+  iree_hal_file_release(file);
+}
+
+// Reads crossing the end of the file are short and then hit the end of the
+// file. The failed ring is discarded and the file remains usable.
+TEST_F(UringFileTest, ReadPastEnd) {
+  CreateTempFile(3 * 4096 + 100);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_NONE, /*queue_depth=*/2,
+                  /*request_size=*/4096, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  iree_hal_buffer_t* buffer = CreateBuffer(4 * 4096, 0xCD);
+  EXPECT_THAT(
+      Status(iree_hal_file_read(file, 0, buffer, 0, contents_.size() + 1)),
+      StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_hal_file_read(file, 3 * 4096 + 50, buffer, 0, 51)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_hal_file_read(file, contents_.size(), buffer, 0, 1)),
+              StatusIs(StatusCode::kOutOfRange));
+  iree_hal_buffer_release(buffer);
+
+  ExpectRead(file, 0, contents_.size());
+  ExpectRead(file, 3 * 4096 + 50, 50);
+
+  iree_hal_file_release(file);
+}
+
+// Direct I/O reads through aligned bounce windows regardless of the alignment
+// of the file range and target buffer. Falls back to buffered reads when the
+// file system does not support O_DIRECT.
+TEST_F(UringFileTest, DirectRead) {
+  CreateTempFile(5 * 8192 + 1234);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_DIRECT_IO, /*queue_depth=*/2,
+                  /*request_size=*/8192, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  ExpectRead(file, 0, contents_.size());
+  ExpectRead(file, 0, 8192);
+  ExpectRead(file, 1, 8190);
+  ExpectRead(file, 4095, 2);
+  ExpectRead(file, 8191, 8194);
+  ExpectRead(file, 5000, 30000);
+  // Windows extending past the unaligned end of the file.
+  ExpectRead(file, 5 * 8192 + 1000, 234);
+  ExpectRead(file, 3 * 8192 + 17, contents_.size() - (3 * 8192 + 17));
+
+  iree_hal_file_release(file);
+}
+
+// Direct I/O reads of aligned ranges into aligned memory bypass the bounce
+// buffer while unaligned portions of the same read still use it.
+TEST_F(UringFileTest, DirectReadAligned) {
+  CreateTempFile(4 * 8192 + 1234);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_DIRECT_IO, /*queue_depth=*/2,
+                  /*request_size=*/8192, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  const iree_host_size_t storage_size = 5 * 8192;
+  uint8_t* storage = (uint8_t*)aligned_alloc(4096, storage_size);
+  ASSERT_NE(storage, nullptr);
+  iree_hal_buffer_placement_t placement = {};
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_heap_buffer_wrap(
+      placement,
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_COHERENT,
+      IREE_HAL_MEMORY_ACCESS_ALL,
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING,
+      storage_size, iree_make_byte_span(storage, storage_size),
+      iree_hal_buffer_release_callback_null(), iree_allocator_system(),
+      &buffer));
+
+  struct {
+    uint64_t file_offset;
+    iree_device_size_t buffer_offset;
+    iree_device_size_t length;
+  } ranges[] = {
+      // Entirely aligned.
+      {0, 0, 4 * 8192},
+      {8192, 4096, 2 * 8192},
+      // Aligned middle with unaligned head and tail.
+      {4000, 4000, 3 * 8192},
+      // Aligned file range into unaligned memory.
+      {8192, 1, 8192},
+      // Aligned start through the unaligned end of the file.
+      {2 * 8192, 0, contents_.size() - 2 * 8192},
+  };
+  for (const auto& range : ranges) {
+    memset(storage, 0xCD, storage_size);
+    IREE_ASSERT_OK(iree_hal_file_read(file, range.file_offset, buffer,
+                                      range.buffer_offset, range.length));
+    EXPECT_THAT(std::vector<uint8_t>(
+                    storage + range.buffer_offset,
+                    storage + range.buffer_offset + range.length),
+                ContainerEq(Contents(range.file_offset, range.length)));
+    EXPECT_THAT(
+        std::vector<uint8_t>(storage, storage + range.buffer_offset),
+        ContainerEq(std::vector<uint8_t>(range.buffer_offset, 0xCD)));
+  }
+
+  iree_hal_buffer_release(buffer);
+  free(storage);
+  iree_hal_file_release(file);
+}
+
+// Direct I/O reads past the end of the file fail and the file remains usable.
+TEST_F(UringFileTest, DirectReadPastEnd) {
+  CreateTempFile(2 * 4096 + 100);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_DIRECT_IO, /*queue_depth=*/2,
+                  /*request_size=*/4096, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  iree_hal_buffer_t* buffer = CreateBuffer(4 * 4096, 0xCD);
+  EXPECT_THAT(
+      Status(iree_hal_file_read(file, 0, buffer, 0, contents_.size() + 1)),
+      StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_hal_file_read(file, 2 * 4096 + 99, buffer, 0, 2)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_hal_file_read(file, 3 * 4096, buffer, 0, 4096)),
+              StatusIs(StatusCode::kOutOfRange));
+  iree_hal_buffer_release(buffer);
+
+  ExpectRead(file, 0, contents_.size());
+
+  iree_hal_file_release(file);
+}
+
+// Direct I/O only applies to reads; writes use the page cache.
+TEST_F(UringFileTest, DirectWrite) {
+  CreateTempFile(3 * 4096);
+  iree_hal_file_t* file = NULL;
+  if (!CreateFile(IREE_HAL_URING_FILE_FLAG_DIRECT_IO, /*queue_depth=*/2,
+                  /*request_size=*/4096, &file)) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+
+  iree_hal_buffer_t* buffer = CreateBuffer(5000, 0x5A);
+  IREE_ASSERT_OK(iree_hal_file_write(file, 3000, buffer, 0, 5000));
+  iree_hal_buffer_release(buffer);
+
+  std::fill_n(contents_.begin() + 3000, 5000, 0x5A);
+  EXPECT_THAT(ReadFileContents(), ContainerEq(contents_));
+  ExpectRead(file, 0, contents_.size());
+
+  iree_hal_file_release(file);
+}
+
+// Threads performing I/O on the same file concurrently each use their own
+// pooled ring. Failures on some threads discard their rings without affecting
+// the others. When more threads than the maximum ring count perform I/O they
+// wait for rings to be released.
+TEST_F(UringFileTest, ConcurrentReads) {
+  static constexpr int kThreadCount = 8;
+  static constexpr iree_device_size_t kTileSize = 16 * 1024 + 7;
+  CreateTempFile(kThreadCount * kTileSize);
+  struct {
+    iree_hal_uring_file_flags_t flags;
+    uint32_t max_ring_count;
+  } configs[] = {
+      {IREE_HAL_URING_FILE_FLAG_NONE, 0},
+      {IREE_HAL_URING_FILE_FLAG_DIRECT_IO, 0},
+      {IREE_HAL_URING_FILE_FLAG_NONE, 1},
+      {IREE_HAL_URING_FILE_FLAG_DIRECT_IO, 3},
+  };
+  for (const auto& config : configs) {
+    iree_hal_file_t* file = NULL;
+    if (!CreateFile(config.flags, /*queue_depth=*/3, /*request_size=*/4096,
+                    &file, config.max_ring_count)) {
+      GTEST_SKIP() << "io_uring unavailable";
+    }
+    std::vector<iree_hal_buffer_t*> buffers(kThreadCount);
+    std::vector<iree_hal_buffer_t*> scratch_buffers(kThreadCount);
+    for (int i = 0; i < kThreadCount; ++i) {
+      buffers[i] = CreateBuffer(kTileSize, 0xCD);
+      scratch_buffers[i] = CreateBuffer(kTileSize, 0xCD);
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreadCount; ++i) {
+      threads.emplace_back([&, i]() {
+        for (int iteration = 0; iteration < 16; ++iteration) {
+          if (i % 4 == 3 && iteration % 2 == 1) {
+            // Reads past the end of the file fail and discard the ring.
+            EXPECT_THAT(Status(iree_hal_file_read(file, contents_.size() - 10,
+                                                  scratch_buffers[i], 0,
+                                                  kTileSize)),
+                        StatusIs(StatusCode::kOutOfRange));
+            continue;
+          }
+          IREE_EXPECT_OK(iree_hal_file_read(file, i * kTileSize, buffers[i], 0,
+                                            kTileSize));
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int i = 0; i < kThreadCount; ++i) {
+      EXPECT_THAT(ReadBuffer(buffers[i], 0, kTileSize),
+                  ContainerEq(Contents(i * kTileSize, kTileSize)));
+      iree_hal_buffer_release(buffers[i]);
+      iree_hal_buffer_release(scratch_buffers[i]);
+    }
+    iree_hal_file_release(file);
+  }
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_URING_FILE_ENABLE
@@ -0,0 +1,460 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/compression.h"
+
+IREE_API_EXPORT iree_status_t iree_io_compression_type_parse(
+    iree_string_view_t value, iree_io_compression_type_t* out_type) {
+  IREE_ASSERT_ARGUMENT(out_type);
+  if (iree_string_view_is_empty(value) ||
+      iree_string_view_equal(value, IREE_SV("none"))) {
+    *out_type = IREE_IO_COMPRESSION_TYPE_NONE;
+  } else if (iree_string_view_equal(value, IREE_SV("lz4"))) {
+    *out_type = IREE_IO_COMPRESSION_TYPE_LZ4;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported compression type `%.*s`; expected "
+                            "`none` or `lz4`",
+                            (int)value.size, value.data);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_string_view_t
+iree_io_compression_type_name(iree_io_compression_type_t type) {
+  switch (type) {
+    case IREE_IO_COMPRESSION_TYPE_NONE:
+      return IREE_SV("none");
+    case IREE_IO_COMPRESSION_TYPE_LZ4:
+      return IREE_SV("lz4");
+    default:
+      return IREE_SV("unknown");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// LZ4 block format
+//===----------------------------------------------------------------------===//
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+//
+// A block is a sequence of (literals, match) pairs each starting with a token
+// byte holding the literal length in the high nibble and the match length
+// minus 4 in the low nibble. Lengths of 15 are extended by subsequent bytes
+// until one is not 255. The literals are followed by a 2-byte little-endian
+// match offset. The final sequence has only literals.
+//
+// The compressor here is a single-probe greedy matcher: not the best ratio but
+// simple, allocation-free, and fast. Parameters are compressed once offline and
+// decompressed on every load so decode speed is what matters.
+
+// Minimum match length encoded by the format.
+#define IREE_IO_LZ4_MIN_MATCH 4
+// The last match must start at least this many bytes before the end.
+#define IREE_IO_LZ4_MF_LIMIT 12
+// The last this many bytes are always literals.
+#define IREE_IO_LZ4_LAST_LITERALS 5
+// Maximum match distance representable by the 2-byte offset.
+#define IREE_IO_LZ4_MAX_DISTANCE 65535
+// log2 of the number of entries in the compressor hash table.
+#define IREE_IO_LZ4_HASH_LOG 12
+
+static inline uint32_t iree_io_lz4_read32(const uint8_t* ptr) {
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static inline uint32_t iree_io_lz4_hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - IREE_IO_LZ4_HASH_LOG);
+}
+
+// Writes an extended length |length| (already reduced by 15) to |op|.
+static inline uint8_t* iree_io_lz4_write_length(uint8_t* op,
+                                                iree_host_size_t length) {
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = (uint8_t)length;
+  return op;
+}
+
+// Returns the worst-case number of bytes needed to encode a sequence with
+// |literal_length| literals (plus a match if |has_match|).
+static inline iree_host_size_t iree_io_lz4_sequence_size(
+    iree_host_size_t literal_length, bool has_match,
+    iree_host_size_t match_length) {
+  iree_host_size_t size = 1 + literal_length + literal_length / 255 + 1;
+  if (has_match) size += 2 + match_length / 255 + 1;
+  return size;
+}
+
+static iree_status_t iree_io_lz4_compress(iree_const_byte_span_t source,
+                                          iree_byte_span_t target,
+                                          iree_host_size_t* out_length) {
+  const uint8_t* const src = source.data;
+  const uint8_t* const iend = src + source.data_length;
+  uint8_t* op = target.data;
+  uint8_t* const oend = target.data + target.data_length;
+  const uint8_t* anchor = src;
+
+  if (source.data_length > IREE_IO_LZ4_MF_LIMIT) {
+    const uint8_t* const mflimit = iend - IREE_IO_LZ4_MF_LIMIT;
+    const uint8_t* const matchlimit = iend - IREE_IO_LZ4_LAST_LITERALS;
+    uint32_t table[1u << IREE_IO_LZ4_HASH_LOG];
+    memset(table, 0, sizeof(table));
+    const uint8_t* ip = src + 1;
+    while (ip < mflimit) {
+      const uint32_t sequence = iree_io_lz4_read32(ip);
+      const uint32_t hash = iree_io_lz4_hash(sequence);
+      const uint8_t* ref = src + table[hash];
+      table[hash] = (uint32_t)(ip - src);
+      if (ref >= ip || ip - ref > IREE_IO_LZ4_MAX_DISTANCE ||
+          iree_io_lz4_read32(ref) != sequence) {
+        // Skip faster the longer we go without finding a match so that
+        // incompressible data doesn't take forever.
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+
+      // Extend the match backwards into pending literals and then forwards.
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        --ip;
+        --ref;
+      }
+      iree_host_size_t match_length = IREE_IO_LZ4_MIN_MATCH;
+      while (ip + match_length < matchlimit &&
+             ip[match_length] == ref[match_length]) {
+        ++match_length;
+      }
+
+      const iree_host_size_t literal_length = (iree_host_size_t)(ip - anchor);
+      if (iree_io_lz4_sequence_size(literal_length, true, match_length) >
+          (iree_host_size_t)(oend - op)) {
+        return iree_status_from_code(IREE_STATUS_RESOURCE_EXHAUSTED);
+      }
+      uint8_t* token = op++;
+      if (literal_length >= 15) {
+        *token = 15 << 4;
+        op = iree_io_lz4_write_length(op, literal_length - 15);
+      } else {
+        *token = (uint8_t)(literal_length << 4);
+      }
+      memcpy(op, anchor, literal_length);
+      op += literal_length;
+      const uint16_t offset = (uint16_t)(ip - ref);
+      *op++ = (uint8_t)(offset & 0xFF);
+      *op++ = (uint8_t)(offset >> 8);
+      const iree_host_size_t match_code = match_length - IREE_IO_LZ4_MIN_MATCH;
+      if (match_code >= 15) {
+        *token |= 15;
+        op = iree_io_lz4_write_length(op, match_code - 15);
+      } else {
+        *token |= (uint8_t)match_code;
+      }
+
+      ip += match_length;
+      anchor = ip;
+      if (ip < mflimit) {
+        // Seed the table with the position just before the new anchor so that
+        // runs of repeated data keep matching.
+        table[iree_io_lz4_hash(iree_io_lz4_read32(ip - 2))] =
+            (uint32_t)(ip - 2 - src);
+      }
+    }
+  }
+
+  // Emit the trailing literals as the final sequence.
+  const iree_host_size_t literal_length = (iree_host_size_t)(iend - anchor);
+  if (iree_io_lz4_sequence_size(literal_length, false, 0) >
+      (iree_host_size_t)(oend - op)) {
+    return iree_status_from_code(IREE_STATUS_RESOURCE_EXHAUSTED);
+  }
+  if (literal_length >= 15) {
+    *op++ = 15 << 4;
+    op = iree_io_lz4_write_length(op, literal_length - 15);
+  } else {
+    *op++ = (uint8_t)(literal_length << 4);
+  }
+  if (literal_length > 0) {
+    memcpy(op, anchor, literal_length);
+    op += literal_length;
+  }
+
+  *out_length = (iree_host_size_t)(op - target.data);
+  return iree_ok_status();
+}
+
+// Reads an extended length from |*ip| and adds it to |*length|.
+static inline bool iree_io_lz4_read_length(const uint8_t** ip,
+                                           const uint8_t* iend,
+                                           iree_host_size_t* length) {
+  uint8_t byte = 0;
+  do {
+    if (*ip >= iend) return false;
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+static iree_status_t iree_io_lz4_decompress(iree_const_byte_span_t source,
+                                            iree_byte_span_t target) {
+  const uint8_t* ip = source.data;
+  const uint8_t* const iend = ip + source.data_length;
+  uint8_t* op = target.data;
+  uint8_t* const ostart = target.data;
+  uint8_t* const oend = target.data + target.data_length;
+  while (ip < iend) {
+    const uint8_t token = *ip++;
+
+    // Copy literals.
+    iree_host_size_t literal_length = token >> 4;
+    if (literal_length == 15 &&
+        !iree_io_lz4_read_length(&ip, iend, &literal_length)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "LZ4 literal length truncated");
+    }
+    if (literal_length > (iree_host_size_t)(iend - ip) ||
+        literal_length > (iree_host_size_t)(oend - op)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "LZ4 literal run overflows block");
+    }
+    if (literal_length > 0) {
+      memcpy(op, ip, literal_length);
+      ip += literal_length;
+      op += literal_length;
+    }
+    if (ip == iend) break;  // final sequence
+
+    // Copy the match from already decoded output.
+    if (iend - ip < 2) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "LZ4 match offset truncated");
+    }
+    const iree_host_size_t offset = (iree_host_size_t)ip[0] | (ip[1] << 8);
+    ip += 2;
+    iree_host_size_t match_length = token & 15;
+    if (match_length == 15 &&
+        !iree_io_lz4_read_length(&ip, iend, &match_length)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "LZ4 match length truncated");
+    }
+    match_length += IREE_IO_LZ4_MIN_MATCH;
+    if (offset == 0 || offset > (iree_host_size_t)(op - ostart) ||
+        match_length > (iree_host_size_t)(oend - op)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "LZ4 match out of bounds (offset=%" PRIhsz
+                              ", length=%" PRIhsz ")",
+                              offset, match_length);
+    }
+    const uint8_t* match = op - offset;
+    if (offset >= match_length) {
+      memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      // Overlapping copy replicating the last |offset| bytes.
+      for (iree_host_size_t i = 0; i < match_length; ++i) *op++ = *match++;
+    }
+  }
+  if (op != oend) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "LZ4 block decoded to %" PRIhsz
+                            " bytes but expected %" PRIhsz,
+                            (iree_host_size_t)(op - ostart),
+                            target.data_length);
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Block compression
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_io_compress_block(
+    iree_io_compression_type_t type, iree_const_byte_span_t source,
+    iree_byte_span_t target, iree_host_size_t* out_length) {
+  IREE_ASSERT_ARGUMENT(out_length);
+  *out_length = 0;
+  switch (type) {
+    case IREE_IO_COMPRESSION_TYPE_NONE:
+      if (source.data_length > target.data_length) {
+        return iree_status_from_code(IREE_STATUS_RESOURCE_EXHAUSTED);
+      }
+      memcpy(target.data, source.data, source.data_length);
+      *out_length = source.data_length;
+      return iree_ok_status();
+    case IREE_IO_COMPRESSION_TYPE_LZ4:
+      return iree_io_lz4_compress(source, target, out_length);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "compression type %d not supported", (int)type);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_io_decompress_block(
+    iree_io_compression_type_t type, iree_const_byte_span_t source,
+    iree_byte_span_t target) {
+  switch (type) {
+    case IREE_IO_COMPRESSION_TYPE_NONE:
+      if (source.data_length != target.data_length) {
+        return iree_make_status(IREE_STATUS_DATA_LOSS,
+                                "uncompressed block length mismatch");
+      }
+      memcpy(target.data, source.data, source.data_length);
+      return iree_ok_status();
+    case IREE_IO_COMPRESSION_TYPE_LZ4:
+      return iree_io_lz4_decompress(source, target);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "compression type %d not supported", (int)type);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Block-compressed storage
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_io_compressed_blocks_verify(
+    const iree_io_compressed_blocks_t* blocks, uint64_t compressed_length) {
+  IREE_ASSERT_ARGUMENT(blocks);
+  if (blocks->type != IREE_IO_COMPRESSION_TYPE_NONE &&
+      blocks->type != IREE_IO_COMPRESSION_TYPE_LZ4) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "compression type %d not supported",
+                            (int)blocks->type);
+  }
+  if (blocks->block_size < IREE_IO_COMPRESSION_MIN_BLOCK_SIZE ||
+      blocks->block_size > IREE_IO_COMPRESSION_MAX_BLOCK_SIZE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "compression block size %u out of range [%d, %d]",
+                            blocks->block_size,
+                            IREE_IO_COMPRESSION_MIN_BLOCK_SIZE,
+                            IREE_IO_COMPRESSION_MAX_BLOCK_SIZE);
+  }
+  if (blocks->block_count !=
+      iree_io_compressed_block_count(blocks->length, blocks->block_size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "block count %" PRIhsz
+                            " does not match length %" PRIu64,
+                            blocks->block_count, blocks->length);
+  }
+  for (iree_host_size_t i = 0; i < blocks->block_count; ++i) {
+    const uint64_t block_start = blocks->block_offsets[i];
+    const uint64_t block_end = blocks->block_offsets[i + 1];
+    if (block_end < block_start || block_end > compressed_length ||
+        block_end - block_start > blocks->block_size) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "compressed block %" PRIhsz
+                              " range [%" PRIu64 ", %" PRIu64
+                              ") invalid for %" PRIu64 " bytes of storage",
+                              i, block_start, block_end, compressed_length);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Decompresses block |i| of |blocks| into |target|, which must be exactly the
+// uncompressed size of the block. |compressed_data| holds the compressed data
+// starting at |compressed_data_offset|.
+static iree_status_t iree_io_compressed_blocks_read_block(
+    const iree_io_compressed_blocks_t* blocks,
+    iree_const_byte_span_t compressed_data, uint64_t compressed_data_offset,
+    iree_host_size_t i, iree_byte_span_t target) {
+  const uint64_t block_start = blocks->block_offsets[i];
+  const uint64_t block_end = blocks->block_offsets[i + 1];
+  if (block_end < block_start || block_start < compressed_data_offset ||
+      block_end - compressed_data_offset > compressed_data.data_length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "compressed block %" PRIhsz " out of range", i);
+  }
+  iree_const_byte_span_t source = iree_make_const_byte_span(
+      compressed_data.data + (block_start - compressed_data_offset),
+      (iree_host_size_t)(block_end - block_start));
+  if (source.data_length == target.data_length) {
+    // Stored uncompressed.
+    memcpy(target.data, source.data, source.data_length);
+    return iree_ok_status();
+  }
+  return iree_io_decompress_block(blocks->type, source, target);
+}
+
+IREE_API_EXPORT void iree_io_compressed_blocks_range(
+    const iree_io_compressed_blocks_t* blocks, uint64_t offset, uint64_t length,
+    uint64_t* out_compressed_offset, uint64_t* out_compressed_length) {
+  IREE_ASSERT_ARGUMENT(blocks);
+  IREE_ASSERT_ARGUMENT(out_compressed_offset);
+  IREE_ASSERT_ARGUMENT(out_compressed_length);
+  *out_compressed_offset = 0;
+  *out_compressed_length = 0;
+  if (length == 0 || offset >= blocks->length || !blocks->block_size) return;
+  const uint64_t end_offset = iree_min(offset + length, blocks->length);
+  const iree_host_size_t first_block =
+      (iree_host_size_t)(offset / blocks->block_size);
+  const iree_host_size_t last_block =
+      (iree_host_size_t)((end_offset - 1) / blocks->block_size);
+  *out_compressed_offset = blocks->block_offsets[first_block];
+  *out_compressed_length =
+      blocks->block_offsets[last_block + 1] - *out_compressed_offset;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_compressed_blocks_read(
+    const iree_io_compressed_blocks_t* blocks,
+    iree_const_byte_span_t compressed_data, uint64_t compressed_data_offset,
+    uint64_t offset, iree_byte_span_t target, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(blocks);
+  if (target.data_length == 0) return iree_ok_status();
+  if (offset + target.data_length > blocks->length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "read range [%" PRIu64 ", %" PRIu64
+                            ") out of bounds of %" PRIu64 " bytes",
+                            offset, offset + target.data_length,
+                            blocks->length);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, target.data_length);
+
+  const uint64_t block_size = blocks->block_size;
+  const uint64_t end_offset = offset + target.data_length;
+  uint8_t* scratch = NULL;
+  iree_status_t status = iree_ok_status();
+  for (uint64_t block_offset = offset - offset % block_size;
+       iree_status_is_ok(status) && block_offset < end_offset;
+       block_offset += block_size) {
+    const iree_host_size_t block_index =
+        (iree_host_size_t)(block_offset / block_size);
+    const iree_host_size_t block_length =
+        (iree_host_size_t)iree_min(block_size, blocks->length - block_offset);
+    const uint64_t copy_start = iree_max(offset, block_offset);
+    const uint64_t copy_end = iree_min(end_offset, block_offset + block_length);
+    uint8_t* target_ptr = target.data + (copy_start - offset);
+    if (copy_start == block_offset && copy_end == block_offset + block_length) {
+      // Whole block: decompress directly into the target.
+      status = iree_io_compressed_blocks_read_block(
+          blocks, compressed_data, compressed_data_offset, block_index,
+          iree_make_byte_span(target_ptr, block_length));
+      continue;
+    }
+
+    // Partial block: decompress into scratch and copy out the subrange.
+    if (!scratch) {
+      status = iree_allocator_malloc_uninitialized(
+          host_allocator, blocks->block_size, (void**)&scratch);
+      if (!iree_status_is_ok(status)) break;
+    }
+    status = iree_io_compressed_blocks_read_block(
+        blocks, compressed_data, compressed_data_offset, block_index,
+        iree_make_byte_span(scratch, block_length));
+    if (iree_status_is_ok(status)) {
+      memcpy(target_ptr, scratch + (copy_start - block_offset),
+             (iree_host_size_t)(copy_end - copy_start));
+    }
+  }
+  iree_allocator_free(host_allocator, scratch);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
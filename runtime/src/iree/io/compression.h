@@ -0,0 +1,121 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_COMPRESSION_H_
+#define IREE_IO_COMPRESSION_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Block compression
+//===----------------------------------------------------------------------===//
+
+// Identifies the codec used to compress a block of data.
+// Values match iree_io_parameter_archive_compression_type_t so that they can be
+// passed through from archive files without translation.
+typedef enum iree_io_compression_type_e {
+  // Data is stored uncompressed.
+  IREE_IO_COMPRESSION_TYPE_NONE = 0u,
+  // LZ4 block format (no frame header or checksums). Decoding is fast enough
+  // to keep up with storage and compatible with blocks produced by the
+  // reference LZ4_compress_* routines.
+  IREE_IO_COMPRESSION_TYPE_LZ4 = 1u,
+} iree_io_compression_type_t;
+
+// Minimum and maximum supported uncompressed block sizes.
+#define IREE_IO_COMPRESSION_MIN_BLOCK_SIZE (4 * 1024)
+#define IREE_IO_COMPRESSION_MAX_BLOCK_SIZE (64 * 1024 * 1024)
+
+// Default block size used when compressing parameters. Large enough to get a
+// good compression ratio and small enough that a single parameter is split
+// into enough blocks to decompress in parallel.
+#define IREE_IO_COMPRESSION_DEFAULT_BLOCK_SIZE (256 * 1024)
+
+// Parses a compression type from a string (`none` or `lz4`).
+IREE_API_EXPORT iree_status_t iree_io_compression_type_parse(
+    iree_string_view_t value, iree_io_compression_type_t* out_type);
+
+// Returns a string name for the compression |type|.
+IREE_API_EXPORT iree_string_view_t
+iree_io_compression_type_name(iree_io_compression_type_t type);
+
+// Compresses |source| into |target| using |type| and returns the number of
+// bytes written in |out_length|. Returns IREE_STATUS_RESOURCE_EXHAUSTED
+// (without a message) if the compressed form does not fit in |target|;
+// callers sizing |target| smaller than |source| can use this to detect
+// incompressible data and store it as-is.
+IREE_API_EXPORT iree_status_t iree_io_compress_block(
+    iree_io_compression_type_t type, iree_const_byte_span_t source,
+    iree_byte_span_t target, iree_host_size_t* out_length);
+
+// Decompresses |source| into |target| using |type|. The decompressed data must
+// exactly fill |target| and malformed input is reported as an error instead of
+// reading or writing out of bounds.
+IREE_API_EXPORT iree_status_t iree_io_decompress_block(
+    iree_io_compression_type_t type, iree_const_byte_span_t source,
+    iree_byte_span_t target);
+
+//===----------------------------------------------------------------------===//
+// Block-compressed storage
+//===----------------------------------------------------------------------===//
+
+// Describes a range of data stored as a sequence of independently compressed
+// blocks. Each block covers |block_size| uncompressed bytes (the last may be
+// shorter) and block i occupies [block_offsets[i], block_offsets[i + 1]) in
+// the compressed data. A block whose compressed length equals its
+// uncompressed length is stored as-is.
+typedef struct iree_io_compressed_blocks_t {
+  // Codec used for each block.
+  iree_io_compression_type_t type;
+  // Uncompressed bytes per block.
+  uint32_t block_size;
+  // Total uncompressed length of all blocks.
+  uint64_t length;
+  // Number of blocks; ceil(length / block_size).
+  iree_host_size_t block_count;
+  // block_count + 1 offsets into the compressed data.
+  const uint64_t* block_offsets;
+} iree_io_compressed_blocks_t;
+
+// Returns the number of |block_size| blocks required to store |length| bytes.
+static inline uint64_t iree_io_compressed_block_count(uint64_t length,
+                                                      uint32_t block_size) {
+  return block_size ? (length + block_size - 1) / block_size : 0;
+}
+
+// Verifies that |blocks| is well-formed and that all blocks are contained
+// within |compressed_length| bytes of compressed data.
+IREE_API_EXPORT iree_status_t iree_io_compressed_blocks_verify(
+    const iree_io_compressed_blocks_t* blocks, uint64_t compressed_length);
+
+// Returns the range of compressed data holding all blocks that overlap the
+// uncompressed range [offset, offset + length). Callers can use this to only
+// access the compressed data required to read the range.
+IREE_API_EXPORT void iree_io_compressed_blocks_range(
+    const iree_io_compressed_blocks_t* blocks, uint64_t offset, uint64_t length,
+    uint64_t* out_compressed_offset, uint64_t* out_compressed_length);
+
+// Decompresses the uncompressed range starting at |offset| into |target| from
+// the |compressed_data| described by |blocks|. |compressed_data| starts at
+// |compressed_data_offset| in the compressed data and must contain all blocks
+// overlapping the range (see iree_io_compressed_blocks_range). The range need
+// not be block aligned: partial blocks at either end are decompressed into a
+// temporary buffer allocated from |host_allocator| and interior blocks are
+// decompressed directly into |target|.
+IREE_API_EXPORT iree_status_t iree_io_compressed_blocks_read(
+    const iree_io_compressed_blocks_t* blocks,
+    iree_const_byte_span_t compressed_data, uint64_t compressed_data_offset,
+    uint64_t offset, iree_byte_span_t target, iree_allocator_t host_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_COMPRESSION_H_
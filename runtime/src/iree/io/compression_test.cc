@@ -0,0 +1,274 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/compression.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Returns |length| bytes of data that compresses reasonably well: a mix of
+// runs, repeated phrases, and noise.
+static std::vector<uint8_t> MakeTestData(size_t length, uint32_t seed) {
+  std::vector<uint8_t> data(length);
+  uint32_t state = seed;
+  for (size_t i = 0; i < length; ++i) {
+    state = state * 1664525u + 1013904223u;
+    if ((i / 97) % 3 == 0) {
+      data[i] = (uint8_t)(i % 7);
+    } else if ((i / 97) % 3 == 1) {
+      data[i] = (uint8_t)"parameter"[i % 9];
+    } else {
+      data[i] = (uint8_t)(state >> 24);
+    }
+  }
+  return data;
+}
+
+// Returns |length| bytes of incompressible data.
+static std::vector<uint8_t> MakeNoise(size_t length, uint32_t seed) {
+  std::vector<uint8_t> data(length);
+  uint32_t state = seed;
+  for (size_t i = 0; i < length; ++i) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    data[i] = (uint8_t)state;
+  }
+  return data;
+}
+
+static std::vector<uint8_t> RoundTrip(const std::vector<uint8_t>& source) {
+  std::vector<uint8_t> compressed(source.size() + source.size() / 255 + 16);
+  iree_host_size_t compressed_length = 0;
+  IREE_CHECK_OK(iree_io_compress_block(
+      IREE_IO_COMPRESSION_TYPE_LZ4,
+      iree_make_const_byte_span(source.data(), source.size()),
+      iree_make_byte_span(compressed.data(), compressed.size()),
+      &compressed_length));
+  std::vector<uint8_t> decompressed(source.size());
+  IREE_CHECK_OK(iree_io_decompress_block(
+      IREE_IO_COMPRESSION_TYPE_LZ4,
+      iree_make_const_byte_span(compressed.data(), compressed_length),
+      iree_make_byte_span(decompressed.data(), decompressed.size())));
+  return decompressed;
+}
+
+TEST(CompressionTest, RoundTripLz4) {
+  for (size_t length : {0, 1, 12, 13, 100, 4096, 65536 + 1000, 300000}) {
+    std::vector<uint8_t> data = MakeTestData(length, (uint32_t)length);
+    EXPECT_EQ(RoundTrip(data), data) << "length=" << length;
+    std::vector<uint8_t> noise = MakeNoise(length, (uint32_t)length + 1);
+    EXPECT_EQ(RoundTrip(noise), noise) << "length=" << length;
+  }
+}
+
+TEST(CompressionTest, Lz4ShrinksRepetitiveData) {
+  std::vector<uint8_t> data(64 * 1024, 0xCD);
+  std::vector<uint8_t> compressed(data.size());
+  iree_host_size_t compressed_length = 0;
+  IREE_ASSERT_OK(iree_io_compress_block(
+      IREE_IO_COMPRESSION_TYPE_LZ4,
+      iree_make_const_byte_span(data.data(), data.size()),
+      iree_make_byte_span(compressed.data(), compressed.size()),
+      &compressed_length));
+  EXPECT_LT(compressed_length, data.size() / 100);
+}
+
+TEST(CompressionTest, Lz4IncompressibleExhausts) {
+  std::vector<uint8_t> data = MakeNoise(16 * 1024, 7);
+  std::vector<uint8_t> compressed(data.size() - 1);
+  iree_host_size_t compressed_length = 0;
+  EXPECT_THAT(Status(iree_io_compress_block(
+                  IREE_IO_COMPRESSION_TYPE_LZ4,
+                  iree_make_const_byte_span(data.data(), data.size()),
+                  iree_make_byte_span(compressed.data(), compressed.size()),
+                  &compressed_length)),
+              StatusIs(StatusCode::kResourceExhausted));
+}
+
+TEST(CompressionTest, Lz4RejectsCorruptInput) {
+  std::vector<uint8_t> data = MakeTestData(8192, 3);
+  std::vector<uint8_t> compressed(data.size());
+  iree_host_size_t compressed_length = 0;
+  IREE_ASSERT_OK(iree_io_compress_block(
+      IREE_IO_COMPRESSION_TYPE_LZ4,
+      iree_make_const_byte_span(data.data(), data.size()),
+      iree_make_byte_span(compressed.data(), compressed.size()),
+      &compressed_length));
+  std::vector<uint8_t> decompressed(data.size());
+
+  // Truncated input.
+  EXPECT_THAT(Status(iree_io_decompress_block(
+                  IREE_IO_COMPRESSION_TYPE_LZ4,
+                  iree_make_const_byte_span(compressed.data(),
+                                            compressed_length / 2),
+                  iree_make_byte_span(decompressed.data(),
+                                      decompressed.size()))),
+              StatusIs(StatusCode::kDataLoss));
+
+  // Output too small.
+  EXPECT_THAT(Status(iree_io_decompress_block(
+                  IREE_IO_COMPRESSION_TYPE_LZ4,
+                  iree_make_const_byte_span(compressed.data(),
+                                            compressed_length),
+                  iree_make_byte_span(decompressed.data(),
+                                      decompressed.size() - 1))),
+              StatusIs(StatusCode::kDataLoss));
+
+  // Match referencing data before the start of the output.
+  const uint8_t bad_offset[] = {0x10, 'a', 0x08, 0x00, 0x50, 1, 2, 3, 4, 5};
+  EXPECT_THAT(Status(iree_io_decompress_block(
+                  IREE_IO_COMPRESSION_TYPE_LZ4,
+                  iree_make_const_byte_span(bad_offset, sizeof(bad_offset)),
+                  iree_make_byte_span(decompressed.data(), 10))),
+              StatusIs(StatusCode::kDataLoss));
+}
+
+// Compresses |data| into |block_size| blocks the same way the IRPA builder
+// does, storing incompressible blocks as-is.
+static void CompressBlocks(const std::vector<uint8_t>& data,
+                           uint32_t block_size,
+                           std::vector<uint64_t>* out_offsets,
+                           std::vector<uint8_t>* out_storage) {
+  out_offsets->push_back(0);
+  std::vector<uint8_t> scratch(block_size);
+  for (size_t offset = 0; offset < data.size(); offset += block_size) {
+    size_t length = std::min<size_t>(block_size, data.size() - offset);
+    iree_host_size_t compressed_length = 0;
+    iree_status_t status = iree_io_compress_block(
+        IREE_IO_COMPRESSION_TYPE_LZ4,
+        iree_make_const_byte_span(data.data() + offset, length),
+        iree_make_byte_span(scratch.data(), length - 1), &compressed_length);
+    if (iree_status_is_resource_exhausted(status)) {
+      iree_status_ignore(status);
+      out_storage->insert(out_storage->end(), data.begin() + offset,
+                          data.begin() + offset + length);
+    } else {
+      IREE_CHECK_OK(status);
+      out_storage->insert(out_storage->end(), scratch.begin(),
+                          scratch.begin() + compressed_length);
+    }
+    out_offsets->push_back(out_storage->size());
+  }
+}
+
+TEST(CompressedBlocksTest, ReadRanges) {
+  const uint32_t block_size = IREE_IO_COMPRESSION_MIN_BLOCK_SIZE;
+  std::vector<uint8_t> data = MakeTestData(block_size * 5 + 123, 11);
+  // Make one block incompressible so it gets stored raw.
+  std::vector<uint8_t> noise = MakeNoise(block_size, 5);
+  std::memcpy(data.data() + block_size * 2, noise.data(), noise.size());
+
+  std::vector<uint64_t> offsets;
+  std::vector<uint8_t> storage;
+  CompressBlocks(data, block_size, &offsets, &storage);
+  EXPECT_EQ(offsets[3] - offsets[2], block_size);
+
+  iree_io_compressed_blocks_t blocks = {};
+  blocks.type = IREE_IO_COMPRESSION_TYPE_LZ4;
+  blocks.block_size = block_size;
+  blocks.length = data.size();
+  blocks.block_count = offsets.size() - 1;
+  blocks.block_offsets = offsets.data();
+  IREE_ASSERT_OK(iree_io_compressed_blocks_verify(&blocks, storage.size()));
+
+  const std::pair<size_t, size_t> ranges[] = {
+      {0, data.size()},                    // everything
+      {0, block_size},                     // exactly one block
+      {block_size * 2, block_size},        // the raw block
+      {100, 200},                          // within one block
+      {block_size - 10, block_size + 20},  // straddling blocks
+      {data.size() - 50, 50},              // tail of the short last block
+  };
+  for (const auto& range : ranges) {
+    std::vector<uint8_t> target(range.second);
+    IREE_ASSERT_OK(iree_io_compressed_blocks_read(
+        &blocks, iree_make_const_byte_span(storage.data(), storage.size()),
+        /*compressed_data_offset=*/0, range.first,
+        iree_make_byte_span(target.data(), target.size()),
+        iree_allocator_system()));
+    EXPECT_EQ(0, std::memcmp(target.data(), data.data() + range.first,
+                             target.size()))
+        << "offset=" << range.first << " length=" << range.second;
+
+    // Reading from only the blocks covering the range must match.
+    uint64_t compressed_offset = 0;
+    uint64_t compressed_length = 0;
+    iree_io_compressed_blocks_range(&blocks, range.first, range.second,
+                                    &compressed_offset, &compressed_length);
+    ASSERT_LE(compressed_offset + compressed_length, storage.size());
+    std::vector<uint8_t> window(storage.begin() + compressed_offset,
+                                storage.begin() + compressed_offset +
+                                    compressed_length);
+    std::vector<uint8_t> window_target(range.second);
+    IREE_ASSERT_OK(iree_io_compressed_blocks_read(
+        &blocks, iree_make_const_byte_span(window.data(), window.size()),
+        compressed_offset, range.first,
+        iree_make_byte_span(window_target.data(), window_target.size()),
+        iree_allocator_system()));
+    EXPECT_EQ(window_target, target)
+        << "offset=" << range.first << " length=" << range.second;
+  }
+
+  // Blocks outside of the provided compressed data are rejected.
+  {
+    uint64_t compressed_offset = 0;
+    uint64_t compressed_length = 0;
+    iree_io_compressed_blocks_range(&blocks, block_size, block_size,
+                                    &compressed_offset, &compressed_length);
+    EXPECT_EQ(compressed_offset, offsets[1]);
+    EXPECT_EQ(compressed_length, offsets[2] - offsets[1]);
+    std::vector<uint8_t> target(block_size * 2);
+    EXPECT_THAT(Status(iree_io_compressed_blocks_read(
+                    &blocks,
+                    iree_make_const_byte_span(
+                        storage.data() + compressed_offset, compressed_length),
+                    compressed_offset, block_size,
+                    iree_make_byte_span(target.data(), target.size()),
+                    iree_allocator_system())),
+                StatusIs(StatusCode::kOutOfRange));
+  }
+
+  std::vector<uint8_t> target(16);
+  EXPECT_THAT(Status(iree_io_compressed_blocks_read(
+                  &blocks,
+                  iree_make_const_byte_span(storage.data(), storage.size()),
+                  /*compressed_data_offset=*/0, data.size() - 8,
+                  iree_make_byte_span(target.data(), target.size()),
+                  iree_allocator_system())),
+              StatusIs(StatusCode::kOutOfRange));
+}
+
+TEST(CompressedBlocksTest, VerifyRejectsBadTables) {
+  const uint64_t offsets[] = {0, 10, 5};
+  iree_io_compressed_blocks_t blocks = {};
+  blocks.type = IREE_IO_COMPRESSION_TYPE_LZ4;
+  blocks.block_size = IREE_IO_COMPRESSION_MIN_BLOCK_SIZE;
+  blocks.length = IREE_IO_COMPRESSION_MIN_BLOCK_SIZE + 1;
+  blocks.block_count = 2;
+  blocks.block_offsets = offsets;
+  EXPECT_THAT(Status(iree_io_compressed_blocks_verify(&blocks, 100)),
+              StatusIs(StatusCode::kOutOfRange));
+  blocks.block_count = 3;
+  EXPECT_THAT(Status(iree_io_compressed_blocks_verify(&blocks, 100)),
+              StatusIs(StatusCode::kInvalidArgument));
+  blocks.block_size = 1;
+  EXPECT_THAT(Status(iree_io_compressed_blocks_verify(&blocks, 100)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
@@ -166,6 +166,57 @@ iree_io_file_handle_flush(iree_io_file_handle_t* handle) {
   return status;
 }
 
+static iree_status_t iree_io_platform_fd_prefetch(int fd, uint64_t offset,
+                                                  uint64_t length) {
+#if IREE_FILE_IO_ENABLE && defined(POSIX_FADV_WILLNEED)
+  // NOTE: posix_fadvise returns the error instead of setting errno.
+  int ret = posix_fadvise(fd, (off_t)offset, (off_t)length,
+                          POSIX_FADV_WILLNEED);
+  return ret == 0 ? iree_ok_status()
+                  : iree_make_status(iree_status_code_from_errno(ret),
+                                     "unable to prefetch file range");
+#elif IREE_FILE_IO_ENABLE && defined(F_RDADVISE)
+  struct radvisory advisory = {
+      .ra_offset = (off_t)offset,
+      .ra_count = (int)iree_min(length, (uint64_t)INT32_MAX),
+  };
+  return fcntl(fd, F_RDADVISE, &advisory) != -1
+             ? iree_ok_status()
+             : iree_make_status(iree_status_code_from_errno(errno),
+                                "unable to prefetch file range");
+#else
+  // No read-ahead hint available; prefetching is only ever a hint.
+  return iree_ok_status();
+#endif  // POSIX_FADV_WILLNEED
+}
+
+IREE_API_EXPORT iree_status_t iree_io_file_handle_prefetch(
+    iree_io_file_handle_t* handle, uint64_t offset, uint64_t length) {
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, length);
+  iree_status_t status = iree_ok_status();
+  switch (handle->primitive.type) {
+    case IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION: {
+      // No-op; contents are already in memory.
+      break;
+    }
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+      status = iree_io_platform_fd_prefetch(handle->primitive.value.fd, offset,
+                                            length);
+      break;
+    }
+    default: {
+      status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "prefetch not supported on handle type %d",
+                                (int)handle->primitive.type);
+      break;
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_io_file_handle_t utilities
 //===----------------------------------------------------------------------===//
@@ -704,8 +755,13 @@ static iree_status_t iree_io_platform_map_file_view(
   }
 #endif  // MAP_HUGETLB
 
-  // Map the memory.
-  void* ptr = mmap(NULL, adjusted_length, prot, map_flags, fd, offset);
+  // Map the memory. mmap requires the file offset to be page aligned so we
+  // map from the containing page and offset into it.
+  const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  const uint64_t page_offset = offset & ~(page_size - 1);
+  const iree_host_size_t page_delta = (iree_host_size_t)(offset - page_offset);
+  void* ptr = mmap(NULL, page_delta + adjusted_length, prot, map_flags, fd,
+                   page_offset);
   if (ptr == MAP_FAILED) {
     return iree_make_status(iree_status_code_from_errno(errno),
                             "failed to map file handle range %" PRIu64
@@ -725,11 +781,12 @@ static iree_status_t iree_io_platform_map_file_view(
   }
 #endif  // MADV_DONTDUMP
   if (advice) {
-    madvise(ptr, adjusted_length, advice);
+    madvise(ptr, page_delta + adjusted_length, advice);
   }
 
   *out_impl = ptr;
-  *out_contents = iree_make_byte_span(ptr, adjusted_length);
+  *out_contents =
+      iree_make_byte_span((uint8_t*)ptr + page_delta, adjusted_length);
   return iree_ok_status();
 }
 
@@ -737,7 +794,9 @@ static void iree_io_platform_unmap_file_view(iree_io_file_mapping_flags_t flags,
                                              void* impl,
                                              iree_byte_span_t contents) {
   if (impl) {
-    munmap(impl, (size_t)contents.data_length);
+    // The mapping starts at the page containing the contents.
+    munmap(impl, (size_t)(contents.data - (uint8_t*)impl) +
+                     (size_t)contents.data_length);
   }
 }
 
@@ -818,11 +877,19 @@ static iree_status_t iree_io_platform_map_file_view(
   } else if (iree_all_bits_set(access, IREE_IO_FILE_ACCESS_WRITE)) {
     desired_access |= FILE_MAP_WRITE;
   }
+  // Views must start at a multiple of the allocation granularity so we map
+  // from the containing granule and offset into it.
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  const uint64_t granularity = system_info.dwAllocationGranularity;
+  const uint64_t view_offset = offset & ~(granularity - 1);
+  const iree_host_size_t view_delta = (iree_host_size_t)(offset - view_offset);
   LARGE_INTEGER offset_li = {0};
-  offset_li.QuadPart = offset;
-  void* ptr = MapViewOfFileEx(mapping, desired_access, offset_li.HighPart,
-                              offset_li.LowPart, (SIZE_T)adjusted_length,
-                              /*lpBaseAddress=*/NULL);
+  offset_li.QuadPart = view_offset;
+  void* view_ptr = MapViewOfFileEx(
+      mapping, desired_access, offset_li.HighPart, offset_li.LowPart,
+      (SIZE_T)(view_delta + adjusted_length), /*lpBaseAddress=*/NULL);
+  void* ptr = view_ptr ? (uint8_t*)view_ptr + view_delta : NULL;
   if (!ptr) {
     CloseHandle(mapping);
     return iree_make_status(
@@ -865,7 +932,12 @@ static void iree_io_platform_unmap_file_view(iree_io_file_mapping_flags_t flags,
                                              void* impl,
                                              iree_byte_span_t contents) {
   if (contents.data) {
-    UnmapViewOfFile(contents.data);
+    // The view starts at the allocation granule containing the contents.
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    UnmapViewOfFile((void*)((uintptr_t)contents.data &
+                            ~((uintptr_t)system_info.dwAllocationGranularity -
+                              1)));
   }
 
 #if defined(WER_MAX_REGISTERED_ENTRIES) && \
@@ -155,6 +155,16 @@ static inline iree_io_file_handle_primitive_value_t iree_io_file_handle_value(
 IREE_API_EXPORT iree_status_t
 iree_io_file_handle_flush(iree_io_file_handle_t* handle);
 
+// Hints that the range [|offset|, |offset| + |length|) of |handle| will be
+// read soon and that the system should begin reading it into the page cache.
+// Returns without waiting for the reads to complete. Handles that are already
+// resident in memory and platforms without read-ahead hints ignore the request.
+//
+// Implemented by posix_fadvise(POSIX_FADV_WILLNEED)/F_RDADVISE, where
+// available.
+IREE_API_EXPORT iree_status_t iree_io_file_handle_prefetch(
+    iree_io_file_handle_t* handle, uint64_t offset, uint64_t length);
+
 //===----------------------------------------------------------------------===//
 // iree_io_file_handle_t platform files
 //===----------------------------------------------------------------------===//
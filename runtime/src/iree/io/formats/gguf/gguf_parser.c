@@ -408,6 +408,10 @@ typedef struct iree_io_gguf_parser_t {
   // tensor_data_size (and the required tensor_data_offset) have not been
   // calculated yet.
   uint64_t tensor_data_size;
+  // Options controlling repacking of block-quantized tensors.
+  const iree_io_gguf_parse_options_t* options;
+  // Allocator used for temporary allocations during parsing.
+  iree_allocator_t host_allocator;
 } iree_io_gguf_parser_t;
 
 static iree_status_t iree_io_gguf_calculate_storage_size(
@@ -650,12 +654,30 @@ static iree_status_t iree_io_gguf_append_tensor_info(
                   },
           },
   };
-  return iree_io_parameter_index_add(parser->index, &entry);
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_add(parser->index, &entry));
+
+  // Add repacked forms of 2D block-quantized tensors alongside the original.
+  // Tensors that can't be repacked (unsupported types or shapes) are only
+  // available in their original form.
+  if (parser->options->repack.layout != IREE_IO_GGUF_REPACK_LAYOUT_NONE &&
+      tensor_info->n_dimensions == 2) {
+    iree_status_t status = iree_io_gguf_repack_append_entries(
+        tensor_info->name, (iree_io_gguf_block_type_t)tensor_info->type,
+        /*n=*/tensor_info->dimensions[1], /*k=*/tensor_info->dimensions[0],
+        parser->file_handle, parser->tensor_data_offset + begin, storage_size,
+        &parser->options->repack, parser->index, parser->host_allocator);
+    if (iree_status_is_unimplemented(status)) {
+      status = iree_status_ignore(status);
+    }
+    IREE_RETURN_IF_ERROR(status);
+  }
+  return iree_ok_status();
 }
 
 static iree_status_t iree_io_parse_gguf_index_from_memory(
     iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
-    iree_io_parameter_index_t* index) {
+    const iree_io_gguf_parse_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator) {
   // Read the header enough to check for file validity and version.
   // Unfortunately the format has a variable-length header (vs being
   // table-based) and that means we have to actually parse the header fully
@@ -694,6 +716,8 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
       .alignment = GGUF_DEFAULT_ALIGNMENT,  // may be overridden
       .tensor_data_offset = 0,              // to be calculated
       .tensor_data_size = 0,                // to be calculated
+      .options = options,
+      .host_allocator = host_allocator,
   };
 
   // Scope data to the remainder of the file and enumerate all metadata pairs.
@@ -718,6 +742,13 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
   parser.tensor_data_size =
       file_contents.data_length - parser.tensor_data_offset;
 
+  // The first scan verified all tensor infos are present so the count can be
+  // trusted to size the index.
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_reserve(
+      parser.index,
+      iree_io_parameter_index_count(parser.index) +
+          (iree_host_size_t)tensor_count));
+
   // Scan forward through the tensor info now that we know the tensor data
   // offset and add the tensor entries.
   IREE_RETURN_IF_ERROR(iree_io_gguf_enumerate_tensor_info(
@@ -729,6 +760,21 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
 IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index,
     iree_allocator_t host_allocator) {
+  const iree_io_gguf_parse_options_t options = {
+      .repack =
+          {
+              .layout = IREE_IO_GGUF_REPACK_LAYOUT_NONE,
+          },
+  };
+  return iree_io_parse_gguf_index_with_options(file_handle, &options, index,
+                                               host_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index_with_options(
+    iree_io_file_handle_t* file_handle,
+    const iree_io_gguf_parse_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -742,7 +788,8 @@ IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index(
                                 host_allocator, &file_mapping));
 
   iree_status_t status = iree_io_parse_gguf_index_from_memory(
-      file_handle, iree_io_file_mapping_contents_ro(file_mapping), index);
+      file_handle, iree_io_file_mapping_contents_ro(file_mapping), options,
+      index, host_allocator);
 
   iree_io_file_mapping_release(file_mapping);
 
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/io/file_handle.h"
+#include "iree/io/formats/gguf/gguf_repack.h"
 #include "iree/io/parameter_index.h"
 
 #ifdef __cplusplus
@@ -26,6 +27,21 @@ IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index,
     iree_allocator_t host_allocator);
 
+// Options controlling how .gguf files are parsed.
+typedef struct iree_io_gguf_parse_options_t {
+  // When a layout is set 2D block-quantized tensors are added to the index
+  // both as-is and as repacked `<name>.packed`, `<name>.scales`, and
+  // `<name>.biases` parameters (see iree_io_gguf_repack_output_t) produced
+  // when loaded.
+  iree_io_gguf_repack_options_t repack;
+} iree_io_gguf_parse_options_t;
+
+// Parses a .gguf file as with iree_io_parse_gguf_index using |options|.
+IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index_with_options(
+    iree_io_file_handle_t* file_handle,
+    const iree_io_gguf_parse_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
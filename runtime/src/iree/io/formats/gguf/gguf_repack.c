@@ -0,0 +1,604 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/formats/gguf/gguf_repack.h"
+
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+
+// Block layouts (see gguf_parser.c and ggml-quants.h):
+//   Q4_0: f16 d, u8 qs[16]                  value = (q - 8) * d
+//   Q4_1: f16 d, f16 m, u8 qs[16]           value = q * d + m
+//   Q8_0: f16 d, s8 qs[32]                  value = q * d
+//   Q4_K: f16 d, f16 dmin, u8 scales[12], u8 qs[128] over 256 elements in 8
+//         groups of 32 with 6-bit packed (sc, m) per group:
+//                                           value = q * (d * sc) - dmin * m
+// 4-bit blocks store element i in the low nibble of qs[i] and element i + 16
+// in the high nibble; Q4_K does the same per 64 elements with qs[32c + l]
+// holding elements 64c + l (low) and 64c + 32 + l (high).
+
+//===----------------------------------------------------------------------===//
+// Repack descriptors
+//===----------------------------------------------------------------------===//
+
+// Transform parameters:
+//   params[0] = block_type | output << 8 | layout << 16
+//   params[1] = N
+//   params[2] = K
+//   params[3] = N0 | K0 << 16
+
+typedef struct iree_io_gguf_repack_desc_t {
+  iree_io_gguf_block_type_t type;
+  iree_io_gguf_repack_output_t output;
+  iree_io_gguf_repack_layout_t layout;
+  uint64_t n;
+  uint64_t k;
+  uint32_t n0;
+  uint32_t k0;
+  // Elements and bytes per source block.
+  uint32_t block_elements;
+  uint32_t block_size;
+  // Bytes per source row of K elements.
+  uint64_t row_size;
+  // Value subtracted from raw quantized values when storing signed layouts.
+  int32_t zero_point;
+  // Bits per packed element.
+  uint32_t element_bits;
+  // Packed tile counts and bytes per tile.
+  uint64_t n1;
+  uint64_t k1;
+  uint64_t tile_size;
+  // Scale/bias groups per row.
+  uint64_t group_count;
+} iree_io_gguf_repack_desc_t;
+
+static bool iree_io_gguf_block_traits(iree_io_gguf_block_type_t type,
+                                      uint32_t* out_block_elements,
+                                      uint32_t* out_block_size) {
+  switch (type) {
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_0:
+      *out_block_elements = 32;
+      *out_block_size = 2 + 16;
+      return true;
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_1:
+      *out_block_elements = 32;
+      *out_block_size = 2 + 2 + 16;
+      return true;
+    case IREE_IO_GGUF_BLOCK_TYPE_Q8_0:
+      *out_block_elements = 32;
+      *out_block_size = 2 + 32;
+      return true;
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_K:
+      *out_block_elements = 256;
+      *out_block_size = 2 + 2 + 12 + 128;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool iree_io_gguf_repack_layout_supports(
+    iree_io_gguf_repack_layout_t layout, iree_io_gguf_block_type_t type) {
+  switch (layout) {
+    case IREE_IO_GGUF_REPACK_LAYOUT_S4:
+      return type == IREE_IO_GGUF_BLOCK_TYPE_Q4_0;
+    case IREE_IO_GGUF_REPACK_LAYOUT_U4:
+      return type == IREE_IO_GGUF_BLOCK_TYPE_Q4_0 ||
+             type == IREE_IO_GGUF_BLOCK_TYPE_Q4_1 ||
+             type == IREE_IO_GGUF_BLOCK_TYPE_Q4_K;
+    case IREE_IO_GGUF_REPACK_LAYOUT_S8:
+      return type == IREE_IO_GGUF_BLOCK_TYPE_Q8_0 ||
+             type == IREE_IO_GGUF_BLOCK_TYPE_Q4_0;
+    case IREE_IO_GGUF_REPACK_LAYOUT_F32:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool iree_io_gguf_repack_layout_has_output(
+    iree_io_gguf_repack_layout_t layout, iree_io_gguf_repack_output_t output) {
+  switch (output) {
+    case IREE_IO_GGUF_REPACK_OUTPUT_PACKED:
+      return true;
+    case IREE_IO_GGUF_REPACK_OUTPUT_SCALES:
+      return layout != IREE_IO_GGUF_REPACK_LAYOUT_F32;
+    case IREE_IO_GGUF_REPACK_OUTPUT_BIASES:
+      return layout == IREE_IO_GGUF_REPACK_LAYOUT_U4;
+    default:
+      return false;
+  }
+}
+
+static void iree_io_gguf_repack_default_tile(
+    iree_io_gguf_repack_layout_t layout, uint32_t* out_n0, uint32_t* out_k0) {
+  // Matches the RHS tiles the mmt4d ukernels prefer on common CPUs.
+  switch (layout) {
+    case IREE_IO_GGUF_REPACK_LAYOUT_S4:
+      *out_n0 = 16;
+      *out_k0 = 8;
+      break;
+    case IREE_IO_GGUF_REPACK_LAYOUT_U4:
+      *out_n0 = 32;
+      *out_k0 = 8;
+      break;
+    case IREE_IO_GGUF_REPACK_LAYOUT_S8:
+      *out_n0 = 16;
+      *out_k0 = 2;
+      break;
+    default:
+      *out_n0 = 16;
+      *out_k0 = 1;
+      break;
+  }
+}
+
+// Initializes |out_desc| for repacking a [K, N] tensor. Returns
+// IREE_STATUS_UNIMPLEMENTED if the tensor cannot be repacked as requested.
+static iree_status_t iree_io_gguf_repack_desc_initialize(
+    iree_io_gguf_block_type_t type, iree_io_gguf_repack_output_t output,
+    iree_io_gguf_repack_layout_t layout, uint64_t n, uint64_t k, uint32_t n0,
+    uint32_t k0, iree_io_gguf_repack_desc_t* out_desc) {
+  memset(out_desc, 0, sizeof(*out_desc));
+  if (!iree_io_gguf_block_traits(type, &out_desc->block_elements,
+                                 &out_desc->block_size)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "GGML type %u cannot be repacked", (uint32_t)type);
+  }
+  if (!iree_io_gguf_repack_layout_supports(layout, type) ||
+      !iree_io_gguf_repack_layout_has_output(layout, output)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "GGML type %u cannot be repacked into layout %u "
+                            "output %u",
+                            (uint32_t)type, (uint32_t)layout,
+                            (uint32_t)output);
+  }
+  if (k % out_desc->block_elements != 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "K=%" PRIu64 " is not a multiple of the %u element "
+                            "block size",
+                            k, out_desc->block_elements);
+  }
+  out_desc->element_bits = layout == IREE_IO_GGUF_REPACK_LAYOUT_F32 ? 32
+                           : layout == IREE_IO_GGUF_REPACK_LAYOUT_S8 ? 8
+                                                                     : 4;
+  if (n0 == 0 || k0 == 0 || n0 > IREE_IO_GGUF_REPACK_MAX_TILE_DIM ||
+      k0 > IREE_IO_GGUF_REPACK_MAX_TILE_DIM ||
+      n0 * k0 > IREE_IO_GGUF_REPACK_MAX_TILE_ELEMENTS ||
+      (out_desc->element_bits == 4 && (k0 % 2) != 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid repack tile %ux%u", n0, k0);
+  }
+  out_desc->type = type;
+  out_desc->output = output;
+  out_desc->layout = layout;
+  out_desc->n = n;
+  out_desc->k = k;
+  out_desc->n0 = n0;
+  out_desc->k0 = k0;
+  out_desc->row_size = (k / out_desc->block_elements) * out_desc->block_size;
+  out_desc->zero_point = (type == IREE_IO_GGUF_BLOCK_TYPE_Q4_0 &&
+                          (layout == IREE_IO_GGUF_REPACK_LAYOUT_S4 ||
+                           layout == IREE_IO_GGUF_REPACK_LAYOUT_S8))
+                             ? 8
+                             : 0;
+  out_desc->n1 = (n + n0 - 1) / n0;
+  out_desc->k1 = (k + k0 - 1) / k0;
+  out_desc->tile_size = (uint64_t)n0 * k0 * out_desc->element_bits / 8;
+  out_desc->group_count = k / IREE_IO_GGUF_REPACK_GROUP_SIZE;
+  return iree_ok_status();
+}
+
+// Returns the total length in bytes of the output described by |desc|.
+static uint64_t iree_io_gguf_repack_desc_length(
+    const iree_io_gguf_repack_desc_t* desc) {
+  if (desc->output == IREE_IO_GGUF_REPACK_OUTPUT_PACKED) {
+    return desc->n1 * desc->k1 * desc->tile_size;
+  }
+  return desc->n * desc->group_count * sizeof(float);
+}
+
+// Returns the length in bytes of the independently producible output chunks:
+// one panel of K1 tiles or one row of groups.
+static uint64_t iree_io_gguf_repack_desc_chunk_size(
+    const iree_io_gguf_repack_desc_t* desc) {
+  if (desc->output == IREE_IO_GGUF_REPACK_OUTPUT_PACKED) {
+    return desc->k1 * desc->tile_size;
+  }
+  return desc->group_count * sizeof(float);
+}
+
+//===----------------------------------------------------------------------===//
+// Group decoding
+//===----------------------------------------------------------------------===//
+
+static inline float iree_io_gguf_load_f16(const uint8_t* ptr) {
+  return iree_math_f16_to_f32((uint16_t)(ptr[0] | (ptr[1] << 8)));
+}
+
+// Unpacks the 6-bit scale and min of group |j| of a Q4_K super-block.
+static inline void iree_io_gguf_q4_k_scale_min(const uint8_t* scales,
+                                               uint32_t j, uint8_t* out_sc,
+                                               uint8_t* out_m) {
+  if (j < 4) {
+    *out_sc = scales[j] & 63;
+    *out_m = scales[j + 4] & 63;
+  } else {
+    *out_sc = (scales[j + 4] & 0xF) | ((scales[j - 4] >> 6) << 4);
+    *out_m = (scales[j + 4] >> 4) | ((scales[j] >> 6) << 4);
+  }
+}
+
+// Decodes the scale and bias of group |g| of |row| such that
+// value = q * scale + bias for the raw quantized values q of the group.
+static void iree_io_gguf_decode_group_params(
+    const iree_io_gguf_repack_desc_t* desc, const uint8_t* row, uint64_t g,
+    float* out_scale, float* out_bias) {
+  switch (desc->type) {
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_0: {
+      const uint8_t* block = row + g * desc->block_size;
+      const float d = iree_io_gguf_load_f16(block);
+      *out_scale = d;
+      *out_bias = -8.0f * d;
+      break;
+    }
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_1: {
+      const uint8_t* block = row + g * desc->block_size;
+      *out_scale = iree_io_gguf_load_f16(block);
+      *out_bias = iree_io_gguf_load_f16(block + 2);
+      break;
+    }
+    case IREE_IO_GGUF_BLOCK_TYPE_Q8_0: {
+      const uint8_t* block = row + g * desc->block_size;
+      *out_scale = iree_io_gguf_load_f16(block);
+      *out_bias = 0.0f;
+      break;
+    }
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_K: {
+      const uint8_t* block = row + (g / 8) * desc->block_size;
+      uint8_t sc = 0, m = 0;
+      iree_io_gguf_q4_k_scale_min(block + 4, (uint32_t)(g % 8), &sc, &m);
+      *out_scale = iree_io_gguf_load_f16(block) * sc;
+      *out_bias = -iree_io_gguf_load_f16(block + 2) * m;
+      break;
+    }
+    default:
+      *out_scale = 0.0f;
+      *out_bias = 0.0f;
+      break;
+  }
+}
+
+// Decodes the raw quantized values of group |g| of |row| into |out_q|.
+static void iree_io_gguf_decode_group_values(
+    const iree_io_gguf_repack_desc_t* desc, const uint8_t* row, uint64_t g,
+    int8_t out_q[IREE_IO_GGUF_REPACK_GROUP_SIZE]) {
+  switch (desc->type) {
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_0:
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_1: {
+      const uint8_t* qs = row + g * desc->block_size +
+                          (desc->type == IREE_IO_GGUF_BLOCK_TYPE_Q4_0 ? 2 : 4);
+      for (uint32_t l = 0; l < 16; ++l) {
+        out_q[l] = (int8_t)(qs[l] & 0xF);
+        out_q[l + 16] = (int8_t)(qs[l] >> 4);
+      }
+      break;
+    }
+    case IREE_IO_GGUF_BLOCK_TYPE_Q8_0: {
+      memcpy(out_q, row + g * desc->block_size + 2,
+             IREE_IO_GGUF_REPACK_GROUP_SIZE);
+      break;
+    }
+    case IREE_IO_GGUF_BLOCK_TYPE_Q4_K: {
+      const uint32_t j = (uint32_t)(g % 8);
+      const uint8_t* qs =
+          row + (g / 8) * desc->block_size + 2 + 2 + 12 + (j / 2) * 32;
+      const uint32_t shift = (j % 2) * 4;
+      for (uint32_t l = 0; l < 32; ++l) {
+        out_q[l] = (int8_t)((qs[l] >> shift) & 0xF);
+      }
+      break;
+    }
+    default:
+      memset(out_q, 0, IREE_IO_GGUF_REPACK_GROUP_SIZE);
+      break;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Tile packing
+//===----------------------------------------------------------------------===//
+
+// Decodes group |g| of |row| into |out_packed| in the packed element format so
+// that runs of K elements can be copied directly into tiles. |out_packed|
+// must have room for IREE_IO_GGUF_REPACK_GROUP_SIZE f32 elements.
+static void iree_io_gguf_repack_pack_group(
+    const iree_io_gguf_repack_desc_t* desc, const uint8_t* row, uint64_t g,
+    uint8_t* out_packed) {
+  int8_t q[IREE_IO_GGUF_REPACK_GROUP_SIZE];
+  iree_io_gguf_decode_group_values(desc, row, g, q);
+  switch (desc->element_bits) {
+    case 4: {
+      // Even K elements in the low nibble, odd in the high nibble. Tiles and
+      // groups both start at even K so pairs never straddle either.
+      for (uint32_t l = 0; l < IREE_IO_GGUF_REPACK_GROUP_SIZE / 2; ++l) {
+        const uint8_t lo = (uint8_t)(q[2 * l + 0] - desc->zero_point) & 0xF;
+        const uint8_t hi = (uint8_t)(q[2 * l + 1] - desc->zero_point) & 0xF;
+        out_packed[l] = (uint8_t)(lo | (hi << 4));
+      }
+      break;
+    }
+    case 8: {
+      int8_t* values = (int8_t*)out_packed;
+      for (uint32_t l = 0; l < IREE_IO_GGUF_REPACK_GROUP_SIZE; ++l) {
+        values[l] = (int8_t)(q[l] - desc->zero_point);
+      }
+      break;
+    }
+    default: {
+      float scale = 0.0f, bias = 0.0f;
+      iree_io_gguf_decode_group_params(desc, row, g, &scale, &bias);
+      float values[IREE_IO_GGUF_REPACK_GROUP_SIZE];
+      for (uint32_t l = 0; l < IREE_IO_GGUF_REPACK_GROUP_SIZE; ++l) {
+        values[l] = (float)q[l] * scale + bias;
+      }
+      memcpy(out_packed, values, sizeof(values));
+      break;
+    }
+  }
+}
+
+// Packs tiles [|k1_begin|, |k1_end|) of panel |n1| clipped to the output
+// range starting at |offset| into |target|. Each group covered by the tiles is
+// decoded once and its elements are copied into every tile it spans.
+static void iree_io_gguf_repack_panel_range(
+    const iree_io_gguf_repack_desc_t* desc, const uint8_t* source, uint64_t n1,
+    uint64_t k1_begin, uint64_t k1_end, uint64_t offset,
+    iree_byte_span_t target) {
+  const uint64_t end = offset + target.data_length;
+  const uint32_t row_stride = desc->k0 * desc->element_bits / 8;
+  const uint64_t panel_offset = n1 * desc->k1 * desc->tile_size;
+  const uint64_t k_begin = k1_begin * desc->k0;
+  const uint64_t k_end = iree_min(desc->k, k1_end * desc->k0);
+  uint8_t packed[IREE_IO_GGUF_REPACK_GROUP_SIZE * sizeof(float)];
+  for (uint32_t n0 = 0; n0 < desc->n0; ++n0) {
+    const uint64_t n = n1 * desc->n0 + n0;
+    if (n >= desc->n) break;
+    const uint8_t* row = source + n * desc->row_size;
+    for (uint64_t g = k_begin / IREE_IO_GGUF_REPACK_GROUP_SIZE;
+         g * IREE_IO_GGUF_REPACK_GROUP_SIZE < k_end; ++g) {
+      const uint64_t group_k = g * IREE_IO_GGUF_REPACK_GROUP_SIZE;
+      const uint64_t group_k_end =
+          iree_min(k_end, group_k + IREE_IO_GGUF_REPACK_GROUP_SIZE);
+      iree_io_gguf_repack_pack_group(desc, row, g, packed);
+      // Copy the run of the group in each tile it spans.
+      for (uint64_t k = iree_max(k_begin, group_k); k < group_k_end;) {
+        const uint64_t k1 = k / desc->k0;
+        const uint64_t run_end = iree_min(group_k_end, (k1 + 1) * desc->k0);
+        const uint64_t run_offset = panel_offset + k1 * desc->tile_size +
+                                    n0 * row_stride +
+                                    (k % desc->k0) * desc->element_bits / 8;
+        const uint64_t run_length = (run_end - k) * desc->element_bits / 8;
+        const uint64_t copy_begin = iree_max(run_offset, offset);
+        const uint64_t copy_end = iree_min(run_offset + run_length, end);
+        if (copy_begin < copy_end) {
+          memcpy(target.data + (copy_begin - offset),
+                 packed + (k - group_k) * desc->element_bits / 8 +
+                     (copy_begin - run_offset),
+                 (iree_host_size_t)(copy_end - copy_begin));
+        }
+        k = run_end;
+      }
+    }
+  }
+}
+
+static void iree_io_gguf_repack_packed_range(
+    const iree_io_gguf_repack_desc_t* desc, const uint8_t* source,
+    uint64_t offset, iree_byte_span_t target) {
+  if (target.data_length == 0) return;
+  // Elements outside of the [N, K] bounds are zero. Every other byte is
+  // written exactly once below.
+  if ((desc->n % desc->n0) != 0 || (desc->k % desc->k0) != 0) {
+    memset(target.data, 0, target.data_length);
+  }
+  const uint64_t first_tile = offset / desc->tile_size;
+  const uint64_t last_tile =
+      (offset + target.data_length - 1) / desc->tile_size;
+  for (uint64_t n1 = first_tile / desc->k1; n1 <= last_tile / desc->k1; ++n1) {
+    const uint64_t panel_tile = n1 * desc->k1;
+    const uint64_t k1_begin = iree_max(first_tile, panel_tile) - panel_tile;
+    const uint64_t k1_end =
+        iree_min(last_tile + 1, panel_tile + desc->k1) - panel_tile;
+    iree_io_gguf_repack_panel_range(desc, source, n1, k1_begin, k1_end, offset,
+                                    target);
+  }
+}
+
+static void iree_io_gguf_repack_group_range(
+    const iree_io_gguf_repack_desc_t* desc, const uint8_t* source,
+    uint64_t offset, iree_byte_span_t target) {
+  const uint64_t end = offset + target.data_length;
+  for (uint64_t i = offset / sizeof(float); i * sizeof(float) < end; ++i) {
+    const uint64_t n = i / desc->group_count;
+    const uint64_t g = i % desc->group_count;
+    float scale = 0.0f, bias = 0.0f;
+    iree_io_gguf_decode_group_params(desc, source + n * desc->row_size, g,
+                                     &scale, &bias);
+    const float value =
+        desc->output == IREE_IO_GGUF_REPACK_OUTPUT_SCALES ? scale : bias;
+    // Clip the value bytes to the target range.
+    const uint64_t value_begin = i * sizeof(float);
+    const uint64_t copy_begin = iree_max(value_begin, offset);
+    const uint64_t copy_end = iree_min(value_begin + sizeof(float), end);
+    memcpy(target.data + (copy_begin - offset),
+           (const uint8_t*)&value + (copy_begin - value_begin),
+           (iree_host_size_t)(copy_end - copy_begin));
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_io_gguf_repack_transform(
+    const uint64_t params[4], iree_const_byte_span_t source, uint64_t offset,
+    iree_byte_span_t target) {
+  iree_io_gguf_repack_desc_t desc;
+  IREE_RETURN_IF_ERROR(iree_io_gguf_repack_desc_initialize(
+      (iree_io_gguf_block_type_t)(params[0] & 0xFF),
+      (iree_io_gguf_repack_output_t)((params[0] >> 8) & 0xFF),
+      (iree_io_gguf_repack_layout_t)((params[0] >> 16) & 0xFF), params[1],
+      params[2], (uint32_t)(params[3] & 0xFFFF),
+      (uint32_t)((params[3] >> 16) & 0xFFFF), &desc));
+  if (source.data_length < desc.n * desc.row_size) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "repack source has %" PRIhsz
+                            " bytes but %" PRIu64 " are required",
+                            source.data_length, desc.n * desc.row_size);
+  }
+  const uint64_t length = iree_io_gguf_repack_desc_length(&desc);
+  if (offset > length || target.data_length > length - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "repack range [%" PRIu64 ", %" PRIu64
+                            ") out of bounds of the %" PRIu64 " byte output",
+                            offset, offset + target.data_length, length);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, target.data_length);
+  if (desc.output == IREE_IO_GGUF_REPACK_OUTPUT_PACKED) {
+    iree_io_gguf_repack_packed_range(&desc, source.data, offset, target);
+  } else {
+    iree_io_gguf_repack_group_range(&desc, source.data, offset, target);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Index integration
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_io_gguf_repack_options_parse(
+    iree_string_view_t value, iree_io_gguf_repack_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  iree_string_view_t layout_str = iree_string_view_empty();
+  iree_string_view_t tile_str = iree_string_view_empty();
+  iree_string_view_split(value, ':', &layout_str, &tile_str);
+  if (iree_string_view_equal(layout_str, IREE_SV("none"))) {
+    out_options->layout = IREE_IO_GGUF_REPACK_LAYOUT_NONE;
+  } else if (iree_string_view_equal(layout_str, IREE_SV("s4"))) {
+    out_options->layout = IREE_IO_GGUF_REPACK_LAYOUT_S4;
+  } else if (iree_string_view_equal(layout_str, IREE_SV("u4"))) {
+    out_options->layout = IREE_IO_GGUF_REPACK_LAYOUT_U4;
+  } else if (iree_string_view_equal(layout_str, IREE_SV("s8"))) {
+    out_options->layout = IREE_IO_GGUF_REPACK_LAYOUT_S8;
+  } else if (iree_string_view_equal(layout_str, IREE_SV("f32"))) {
+    out_options->layout = IREE_IO_GGUF_REPACK_LAYOUT_F32;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unknown repack layout `%.*s`; expected one of "
+                            "none, s4, u4, s8, f32",
+                            (int)layout_str.size, layout_str.data);
+  }
+  if (!iree_string_view_is_empty(tile_str)) {
+    iree_string_view_t n_str = iree_string_view_empty();
+    iree_string_view_t k_str = iree_string_view_empty();
+    iree_string_view_split(tile_str, 'x', &n_str, &k_str);
+    if (!iree_string_view_atoi_uint32(n_str, &out_options->tile_n) ||
+        !iree_string_view_atoi_uint32(k_str, &out_options->tile_k)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid repack tile `%.*s`; expected N0xK0",
+                              (int)tile_str.size, tile_str.data);
+    }
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_io_gguf_repack_append_entries(
+    iree_string_view_t name, iree_io_gguf_block_type_t type, uint64_t n,
+    uint64_t k, iree_io_file_handle_t* file_handle, uint64_t offset,
+    uint64_t length, const iree_io_gguf_repack_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(file_handle);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(index);
+  if (options->layout == IREE_IO_GGUF_REPACK_LAYOUT_NONE) {
+    return iree_ok_status();
+  }
+  uint32_t n0 = 0, k0 = 0;
+  iree_io_gguf_repack_default_tile(options->layout, &n0, &k0);
+  if (options->tile_n) n0 = options->tile_n;
+  if (options->tile_k) k0 = options->tile_k;
+
+  // Verify the packed output first so that unsupported tensors are rejected
+  // before any entries are added.
+  iree_io_gguf_repack_desc_t desc;
+  IREE_RETURN_IF_ERROR(iree_io_gguf_repack_desc_initialize(
+      type, IREE_IO_GGUF_REPACK_OUTPUT_PACKED, options->layout, n, k, n0, k0,
+      &desc));
+  if (n * desc.row_size != length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "tensor `%.*s` has %" PRIu64
+                            " bytes but its shape requires %" PRIu64,
+                            (int)name.size, name.data, length,
+                            n * desc.row_size);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, name.data, name.size);
+
+  static const char* suffixes[] = {
+      [IREE_IO_GGUF_REPACK_OUTPUT_PACKED] = ".packed",
+      [IREE_IO_GGUF_REPACK_OUTPUT_SCALES] = ".scales",
+      [IREE_IO_GGUF_REPACK_OUTPUT_BIASES] = ".biases",
+  };
+  char* key_buffer = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, name.size + /*.packed*/ 7, (void**)&key_buffer);
+  if (iree_status_is_ok(status)) memcpy(key_buffer, name.data, name.size);
+  for (uint32_t output = IREE_IO_GGUF_REPACK_OUTPUT_PACKED;
+       iree_status_is_ok(status) &&
+       output <= IREE_IO_GGUF_REPACK_OUTPUT_BIASES;
+       ++output) {
+    if (!iree_io_gguf_repack_layout_has_output(options->layout, output)) {
+      continue;
+    }
+    status = iree_io_gguf_repack_desc_initialize(
+        type, (iree_io_gguf_repack_output_t)output, options->layout, n, k, n0,
+        k0, &desc);
+    if (!iree_status_is_ok(status)) break;
+    memcpy(key_buffer + name.size, suffixes[output], 7);
+    iree_io_parameter_index_entry_t entry = {
+        .key = iree_make_string_view(key_buffer, name.size + 7),
+        .metadata = iree_const_byte_span_empty(),
+        .length = iree_io_gguf_repack_desc_length(&desc),
+        .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM,
+        .storage =
+            {
+                .transform =
+                    {
+                        .handle = file_handle,
+                        .offset = offset,
+                        .length = length,
+                        .fn = iree_io_gguf_repack_transform,
+                        .params =
+                            {
+                                (uint64_t)type | ((uint64_t)output << 8) |
+                                    ((uint64_t)options->layout << 16),
+                                n,
+                                k,
+                                (uint64_t)n0 | ((uint64_t)k0 << 16),
+                            },
+                        .chunk_size =
+                            iree_io_gguf_repack_desc_chunk_size(&desc),
+                    },
+            },
+    };
+    status = iree_io_parameter_index_add(index, &entry);
+  }
+  iree_allocator_free(host_allocator, key_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
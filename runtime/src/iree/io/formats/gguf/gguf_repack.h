@@ -0,0 +1,114 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_FORMATS_GGUF_GGUF_REPACK_H_
+#define IREE_IO_FORMATS_GGUF_GGUF_REPACK_H_
+
+#include "iree/base/api.h"
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// GGUF block-quantized tensor repacking
+//===----------------------------------------------------------------------===//
+
+// GGML block-quantized tensor types that can be repacked.
+// Values match the ggml_type enum stored in GGUF tensor info.
+typedef enum iree_io_gguf_block_type_e {
+  IREE_IO_GGUF_BLOCK_TYPE_Q4_0 = 2u,
+  IREE_IO_GGUF_BLOCK_TYPE_Q4_1 = 3u,
+  IREE_IO_GGUF_BLOCK_TYPE_Q8_0 = 8u,
+  IREE_IO_GGUF_BLOCK_TYPE_Q4_K = 12u,
+} iree_io_gguf_block_type_t;
+
+// Number of consecutive elements along K sharing one scale (and bias) in the
+// repacked scale/bias parameters. All supported block types have groups of
+// this size (Q4_K super-blocks are made of 8 groups).
+#define IREE_IO_GGUF_REPACK_GROUP_SIZE 32
+
+// Maximum tile dimensions. Tiles are built on the stack when producing
+// partial ranges and N0 * K0 is limited to keep them small.
+#define IREE_IO_GGUF_REPACK_MAX_TILE_DIM 64
+#define IREE_IO_GGUF_REPACK_MAX_TILE_ELEMENTS 1024
+
+// Element layout of the repacked tiles. Each layout matches the RHS operand of
+// an mmt4d microkernel so that the packed parameter can be consumed without
+// any further relayout at runtime.
+typedef enum iree_io_gguf_repack_layout_e {
+  // Tensors are left in their GGUF block layout.
+  IREE_IO_GGUF_REPACK_LAYOUT_NONE = 0u,
+  // Signed 4-bit values (q - 8) for the s8s4s32 ukernel. Q4_0 only.
+  IREE_IO_GGUF_REPACK_LAYOUT_S4,
+  // Unsigned 4-bit values for the s16u4s32 ukernel with per-group biases.
+  // Q4_0, Q4_1, and Q4_K.
+  IREE_IO_GGUF_REPACK_LAYOUT_U4,
+  // Signed 8-bit values for the s8s8s32 ukernel. Q8_0 and Q4_0 (as q - 8).
+  IREE_IO_GGUF_REPACK_LAYOUT_S8,
+  // Dequantized f32 values for the f32f32f32 ukernel. All block types.
+  IREE_IO_GGUF_REPACK_LAYOUT_F32,
+} iree_io_gguf_repack_layout_t;
+
+// Options controlling how block-quantized tensors are repacked when parsing.
+// Zero-initialize to leave tensors as-is.
+typedef struct iree_io_gguf_repack_options_t {
+  // Element layout of the repacked tiles or NONE to disable repacking.
+  iree_io_gguf_repack_layout_t layout;
+  // Tile size along N (N0) or 0 for the layout default.
+  uint32_t tile_n;
+  // Tile size along K (K0) or 0 for the layout default. Must be even for
+  // 4-bit layouts.
+  uint32_t tile_k;
+} iree_io_gguf_repack_options_t;
+
+// Parses repack options from a string of the form `layout[:N0xK0]` where
+// layout is one of `none`, `s4`, `u4`, `s8`, or `f32` (such as `u4:32x8`).
+IREE_API_EXPORT iree_status_t iree_io_gguf_repack_options_parse(
+    iree_string_view_t value, iree_io_gguf_repack_options_t* out_options);
+
+// Identifies one of the parameters produced by repacking a tensor.
+typedef enum iree_io_gguf_repack_output_e {
+  // `<name>.packed`: tiles of shape [N1][K1][N0][K0] with N1 = ceil(N / N0)
+  // and K1 = ceil(K / K0), zero-padded. 4-bit layouts store two elements per
+  // byte with the even K element in the low nibble.
+  IREE_IO_GGUF_REPACK_OUTPUT_PACKED = 0u,
+  // `<name>.scales`: f32 [N][K / IREE_IO_GGUF_REPACK_GROUP_SIZE] group scales.
+  // Present for all quantized layouts (not F32).
+  IREE_IO_GGUF_REPACK_OUTPUT_SCALES,
+  // `<name>.biases`: f32 [N][K / IREE_IO_GGUF_REPACK_GROUP_SIZE] group biases
+  // such that value = q * scale + bias. Present only for the U4 layout.
+  IREE_IO_GGUF_REPACK_OUTPUT_BIASES,
+} iree_io_gguf_repack_output_t;
+
+// Adds transform entries to |index| producing the repacked outputs of the
+// 2D tensor |name| of |type| with GGUF dimensions [K, N] (K innermost) stored
+// at |offset| for |length| bytes in |file_handle|. The repacking runs when the
+// parameters are read and can be split into independent chunks of one packed
+// panel (or one scale row) to be performed in parallel.
+//
+// Returns IREE_STATUS_UNIMPLEMENTED if the tensor cannot be repacked into the
+// layout (unsupported type/layout combination or K not a multiple of the
+// block size); callers may then leave the tensor as-is.
+IREE_API_EXPORT iree_status_t iree_io_gguf_repack_append_entries(
+    iree_string_view_t name, iree_io_gguf_block_type_t type, uint64_t n,
+    uint64_t k, iree_io_file_handle_t* file_handle, uint64_t offset,
+    uint64_t length, const iree_io_gguf_repack_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator);
+
+// Transform function producing repacked parameter contents.
+// Matches iree_io_parameter_transform_fn_t and is exposed for testing.
+IREE_API_EXPORT iree_status_t iree_io_gguf_repack_transform(
+    const uint64_t params[4], iree_const_byte_span_t source, uint64_t offset,
+    iree_byte_span_t target);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_FORMATS_GGUF_GGUF_REPACK_H_
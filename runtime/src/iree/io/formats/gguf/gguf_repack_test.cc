@@ -0,0 +1,336 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/formats/gguf/gguf_repack.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/internal/math.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+static void StoreF16(uint8_t* ptr, float value) {
+  uint16_t bits = iree_math_f32_to_f16(value);
+  ptr[0] = (uint8_t)bits;
+  ptr[1] = (uint8_t)(bits >> 8);
+}
+
+static float LoadF16(const uint8_t* ptr) {
+  return iree_math_f16_to_f32((uint16_t)(ptr[0] | (ptr[1] << 8)));
+}
+
+// Random [K, N] tensor in a GGML block format along with its dequantized
+// values computed the way the reference ggml dequantize_row_* routines do.
+struct QuantizedTensor {
+  iree_io_gguf_block_type_t type;
+  uint64_t n = 0;
+  uint64_t k = 0;
+  std::vector<uint8_t> data;
+  std::vector<float> values;  // [N][K]
+};
+
+static QuantizedTensor MakeTensor(iree_io_gguf_block_type_t type, uint64_t n,
+                                  uint64_t k, uint32_t seed) {
+  QuantizedTensor tensor;
+  tensor.type = type;
+  tensor.n = n;
+  tensor.k = k;
+  uint32_t state = seed;
+  auto next = [&]() {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  };
+  const uint64_t block_elements =
+      type == IREE_IO_GGUF_BLOCK_TYPE_Q4_K ? 256 : 32;
+  const uint64_t block_size = type == IREE_IO_GGUF_BLOCK_TYPE_Q4_0   ? 18
+                              : type == IREE_IO_GGUF_BLOCK_TYPE_Q4_1 ? 20
+                              : type == IREE_IO_GGUF_BLOCK_TYPE_Q8_0 ? 34
+                                                                     : 144;
+  tensor.data.resize(n * (k / block_elements) * block_size);
+  for (auto& byte : tensor.data) byte = (uint8_t)next();
+  tensor.values.resize(n * k);
+  for (uint64_t row = 0; row < n; ++row) {
+    for (uint64_t b = 0; b < k / block_elements; ++b) {
+      uint8_t* block =
+          tensor.data.data() + (row * (k / block_elements) + b) * block_size;
+      float* y = tensor.values.data() + row * k + b * block_elements;
+      // Keep scales finite and small.
+      StoreF16(block, (float)(next() % 1000) / 4096.0f);
+      if (type != IREE_IO_GGUF_BLOCK_TYPE_Q8_0) {
+        StoreF16(block + 2, (float)(next() % 1000) / 8192.0f - 0.06f);
+      }
+      const float d = LoadF16(block);
+      switch (type) {
+        case IREE_IO_GGUF_BLOCK_TYPE_Q4_0:
+          for (int j = 0; j < 16; ++j) {
+            y[j] = ((block[2 + j] & 0xF) - 8) * d;
+            y[j + 16] = ((block[2 + j] >> 4) - 8) * d;
+          }
+          break;
+        case IREE_IO_GGUF_BLOCK_TYPE_Q4_1: {
+          const float m = LoadF16(block + 2);
+          for (int j = 0; j < 16; ++j) {
+            y[j] = (block[4 + j] & 0xF) * d + m;
+            y[j + 16] = (block[4 + j] >> 4) * d + m;
+          }
+          break;
+        }
+        case IREE_IO_GGUF_BLOCK_TYPE_Q8_0:
+          for (int j = 0; j < 32; ++j) y[j] = (int8_t)block[2 + j] * d;
+          break;
+        case IREE_IO_GGUF_BLOCK_TYPE_Q4_K: {
+          const float dmin = LoadF16(block + 2);
+          const uint8_t* scales = block + 4;
+          const uint8_t* q = block + 16;
+          int is = 0;
+          for (int j = 0; j < 256; j += 64) {
+            uint8_t sc[2], m[2];
+            for (int h = 0; h < 2; ++h, ++is) {
+              if (is < 4) {
+                sc[h] = scales[is] & 63;
+                m[h] = scales[is + 4] & 63;
+              } else {
+                sc[h] = (scales[is + 4] & 0xF) | ((scales[is - 4] >> 6) << 4);
+                m[h] = (scales[is + 4] >> 4) | ((scales[is] >> 6) << 4);
+              }
+            }
+            for (int l = 0; l < 32; ++l) {
+              *y++ = d * sc[0] * (q[l] & 0xF) - dmin * m[0];
+            }
+            for (int l = 0; l < 32; ++l) {
+              *y++ = d * sc[1] * (q[l] >> 4) - dmin * m[1];
+            }
+            q += 32;
+          }
+          break;
+        }
+      }
+    }
+  }
+  return tensor;
+}
+
+static uint64_t MakeParam0(iree_io_gguf_block_type_t type,
+                           iree_io_gguf_repack_output_t output,
+                           iree_io_gguf_repack_layout_t layout) {
+  return (uint64_t)type | ((uint64_t)output << 8) | ((uint64_t)layout << 16);
+}
+
+static std::vector<uint8_t> Transform(const QuantizedTensor& tensor,
+                                      iree_io_gguf_repack_output_t output,
+                                      iree_io_gguf_repack_layout_t layout,
+                                      uint32_t n0, uint32_t k0, uint64_t offset,
+                                      uint64_t length) {
+  const uint64_t params[4] = {MakeParam0(tensor.type, output, layout),
+                              tensor.n, tensor.k, n0 | (k0 << 16)};
+  // Filled with garbage to check that every byte is written.
+  std::vector<uint8_t> target(length, 0xCD);
+  IREE_CHECK_OK(iree_io_gguf_repack_transform(
+      params, iree_make_const_byte_span(tensor.data.data(), tensor.data.size()),
+      offset, iree_make_byte_span(target.data(), target.size())));
+  return target;
+}
+
+// Returns the stored element at (n, k) of the packed tiles.
+static float PackedElement(const std::vector<uint8_t>& packed,
+                           iree_io_gguf_repack_layout_t layout, uint64_t k,
+                           uint32_t n0, uint32_t k0, uint64_t n, uint64_t kk) {
+  const uint64_t k1_count = (k + k0 - 1) / k0;
+  const uint64_t tile = (n / n0) * k1_count + kk / k0;
+  const uint64_t element = tile * n0 * k0 + (n % n0) * k0 + kk % k0;
+  switch (layout) {
+    case IREE_IO_GGUF_REPACK_LAYOUT_S4: {
+      int nibble = (packed[element / 2] >> ((element % 2) * 4)) & 0xF;
+      return (float)(nibble >= 8 ? nibble - 16 : nibble);
+    }
+    case IREE_IO_GGUF_REPACK_LAYOUT_U4:
+      return (float)((packed[element / 2] >> ((element % 2) * 4)) & 0xF);
+    case IREE_IO_GGUF_REPACK_LAYOUT_S8:
+      return (float)(int8_t)packed[element];
+    default: {
+      float value = 0.0f;
+      std::memcpy(&value, packed.data() + element * sizeof(float),
+                  sizeof(value));
+      return value;
+    }
+  }
+}
+
+struct RepackCase {
+  iree_io_gguf_block_type_t type;
+  iree_io_gguf_repack_layout_t layout;
+  uint32_t n0;
+  uint32_t k0;
+};
+
+TEST(GgufRepackTest, MatchesReferenceDequantization) {
+  const RepackCase cases[] = {
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_0, IREE_IO_GGUF_REPACK_LAYOUT_S4, 16, 8},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_0, IREE_IO_GGUF_REPACK_LAYOUT_U4, 8, 2},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_0, IREE_IO_GGUF_REPACK_LAYOUT_S8, 16, 2},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_0, IREE_IO_GGUF_REPACK_LAYOUT_U4, 13, 16},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_1, IREE_IO_GGUF_REPACK_LAYOUT_U4, 32, 8},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q8_0, IREE_IO_GGUF_REPACK_LAYOUT_S8, 7, 3},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_K, IREE_IO_GGUF_REPACK_LAYOUT_U4, 16, 6},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q4_K, IREE_IO_GGUF_REPACK_LAYOUT_F32, 4, 1},
+      {IREE_IO_GGUF_BLOCK_TYPE_Q8_0, IREE_IO_GGUF_REPACK_LAYOUT_F32, 5, 12},
+  };
+  for (const auto& c : cases) {
+    // Odd N and tiles that don't divide K exercise the padding.
+    const uint64_t n = 13;
+    const uint64_t k = 512;
+    QuantizedTensor tensor = MakeTensor(c.type, n, k, c.type * 7 + c.layout);
+    const uint64_t n1 = (n + c.n0 - 1) / c.n0;
+    const uint64_t k1 = (k + c.k0 - 1) / c.k0;
+    const uint32_t bits = c.layout == IREE_IO_GGUF_REPACK_LAYOUT_F32  ? 32
+                          : c.layout == IREE_IO_GGUF_REPACK_LAYOUT_S8 ? 8
+                                                                      : 4;
+    std::vector<uint8_t> packed =
+        Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_PACKED, c.layout, c.n0,
+                  c.k0, 0, n1 * k1 * c.n0 * c.k0 * bits / 8);
+    std::vector<uint8_t> scales, biases;
+    const uint64_t group_bytes = n * (k / 32) * sizeof(float);
+    if (c.layout != IREE_IO_GGUF_REPACK_LAYOUT_F32) {
+      scales = Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_SCALES, c.layout,
+                         c.n0, c.k0, 0, group_bytes);
+    }
+    if (c.layout == IREE_IO_GGUF_REPACK_LAYOUT_U4) {
+      biases = Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_BIASES, c.layout,
+                         c.n0, c.k0, 0, group_bytes);
+    }
+    for (uint64_t row = 0; row < n1 * c.n0; ++row) {
+      for (uint64_t col = 0; col < k1 * c.k0; ++col) {
+        float element =
+            PackedElement(packed, c.layout, k, c.n0, c.k0, row, col);
+        if (row >= n || col >= k) {
+          ASSERT_EQ(element, 0.0f) << "padding at " << row << "," << col;
+          continue;
+        }
+        float value = element;
+        if (c.layout != IREE_IO_GGUF_REPACK_LAYOUT_F32) {
+          float scale = 0.0f, bias = 0.0f;
+          const uint64_t group = row * (k / 32) + col / 32;
+          std::memcpy(&scale, scales.data() + group * sizeof(float),
+                      sizeof(float));
+          if (!biases.empty()) {
+            std::memcpy(&bias, biases.data() + group * sizeof(float),
+                        sizeof(float));
+          }
+          value = element * scale + bias;
+        }
+        const float expected = tensor.values[row * k + col];
+        ASSERT_NEAR(value, expected, 1e-4f + 1e-5f * std::abs(expected))
+            << "type=" << c.type << " layout=" << c.layout << " at " << row
+            << "," << col;
+      }
+    }
+  }
+}
+
+TEST(GgufRepackTest, PartialRangesMatchWhole) {
+  QuantizedTensor tensor =
+      MakeTensor(IREE_IO_GGUF_BLOCK_TYPE_Q4_K, 9, 256, 123);
+  // Padded tiles and tiles that evenly divide the tensor.
+  const uint32_t tiles[][2] = {{4, 10}, {3, 8}};
+  for (const auto& tile : tiles) {
+    const uint32_t n0 = tile[0], k0 = tile[1];
+    const uint64_t length =
+        ((9 + n0 - 1) / n0) * ((256 + k0 - 1) / k0) * n0 * k0 / 2;
+    std::vector<uint8_t> whole =
+        Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_PACKED,
+                  IREE_IO_GGUF_REPACK_LAYOUT_U4, n0, k0, 0, length);
+    for (uint64_t offset : {0ull, 1ull, 19ull, 20ull, 521ull}) {
+      for (uint64_t size : {1ull, 7ull, 20ull, 333ull}) {
+        if (offset + size > length) continue;
+        std::vector<uint8_t> part =
+            Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_PACKED,
+                      IREE_IO_GGUF_REPACK_LAYOUT_U4, n0, k0, offset, size);
+        EXPECT_EQ(0, std::memcmp(part.data(), whole.data() + offset, size))
+            << "tile=" << n0 << "x" << k0 << " offset=" << offset
+            << " size=" << size;
+      }
+    }
+  }
+  const uint32_t n0 = 4, k0 = 10;
+  const uint64_t group_bytes = 9 * (256 / 32) * sizeof(float);
+  std::vector<uint8_t> whole_biases =
+      Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_BIASES,
+                IREE_IO_GGUF_REPACK_LAYOUT_U4, n0, k0, 0, group_bytes);
+  std::vector<uint8_t> part_biases =
+      Transform(tensor, IREE_IO_GGUF_REPACK_OUTPUT_BIASES,
+                IREE_IO_GGUF_REPACK_LAYOUT_U4, n0, k0, 3, 50);
+  EXPECT_EQ(0, std::memcmp(part_biases.data(), whole_biases.data() + 3, 50));
+}
+
+TEST(GgufRepackTest, AppendEntries) {
+  QuantizedTensor tensor =
+      MakeTensor(IREE_IO_GGUF_BLOCK_TYPE_Q4_0, 8, 64, 5);
+  iree_io_file_handle_t* file_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(tensor.data.data(), tensor.data.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &file_handle));
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+
+  iree_io_gguf_repack_options_t options;
+  IREE_ASSERT_OK(
+      iree_io_gguf_repack_options_parse(IREE_SV("u4:16x4"), &options));
+  EXPECT_EQ(options.layout, IREE_IO_GGUF_REPACK_LAYOUT_U4);
+  EXPECT_EQ(options.tile_n, 16u);
+  EXPECT_EQ(options.tile_k, 4u);
+  IREE_ASSERT_OK(iree_io_gguf_repack_append_entries(
+      IREE_SV("w"), tensor.type, tensor.n, tensor.k, file_handle, 0,
+      tensor.data.size(), &options, index, iree_allocator_system()));
+  EXPECT_EQ(iree_io_parameter_index_count(index), 3u);
+
+  const iree_io_parameter_index_entry_t* packed = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_lookup(index, IREE_SV("w.packed"), &packed));
+  EXPECT_EQ(packed->type, IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM);
+  EXPECT_EQ(packed->length, 1u * 16u * 16u * 4u / 2u);
+  EXPECT_EQ(packed->storage.transform.chunk_size, 16u * 16u * 4u / 2u);
+  const iree_io_parameter_index_entry_t* biases = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_lookup(index, IREE_SV("w.biases"), &biases));
+  EXPECT_EQ(biases->length, 8u * 2u * sizeof(float));
+
+  // Q8_0 has no 4-bit form and K must be a whole number of blocks.
+  IREE_ASSERT_OK(iree_io_gguf_repack_options_parse(IREE_SV("s4"), &options));
+  EXPECT_THAT(Status(iree_io_gguf_repack_append_entries(
+                  IREE_SV("x"), IREE_IO_GGUF_BLOCK_TYPE_Q8_0, tensor.n, 32,
+                  file_handle, 0, tensor.n * 34, &options, index,
+                  iree_allocator_system())),
+              StatusIs(StatusCode::kUnimplemented));
+  EXPECT_THAT(Status(iree_io_gguf_repack_append_entries(
+                  IREE_SV("y"), tensor.type, 4, 48, file_handle, 0, 4 * 27,
+                  &options, index, iree_allocator_system())),
+              StatusIs(StatusCode::kUnimplemented));
+  EXPECT_THAT(Status(iree_io_gguf_repack_options_parse(IREE_SV("s4:16x3"),
+                                                       &options)),
+              StatusIs(StatusCode::kOk));
+  EXPECT_THAT(Status(iree_io_gguf_repack_append_entries(
+                  IREE_SV("z"), tensor.type, tensor.n, tensor.k, file_handle,
+                  0, tensor.data.size(), &options, index,
+                  iree_allocator_system())),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(iree_io_parameter_index_count(index), 3u);
+
+  iree_io_parameter_index_release(index);
+  iree_io_file_handle_release(file_handle);
+}
+
+}  // namespace
+}  // namespace iree
@@ -6,6 +6,10 @@
 
 #include "iree/io/formats/irpa/irpa_builder.h"
 
+#include "iree/io/formats/irpa/irpa_util.h"
+#include "iree/io/memory_stream.h"
+#include "iree/io/parallel.h"
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_initialize(
     iree_allocator_t host_allocator,
     iree_io_parameter_archive_builder_t* out_builder) {
@@ -21,9 +25,96 @@ IREE_API_EXPORT void iree_io_parameter_archive_builder_deinitialize(
     iree_io_parameter_archive_builder_t* builder) {
   IREE_ASSERT_ARGUMENT(builder);
   iree_io_parameter_index_release(builder->index);
+  iree_allocator_free(builder->host_allocator, builder->entry_hashes);
   memset(builder, 0, sizeof(*builder));
 }
 
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_set_hash_type(
+    iree_io_parameter_archive_builder_t* builder,
+    iree_io_parameter_archive_hash_type_t hash_type) {
+  IREE_ASSERT_ARGUMENT(builder);
+  if (!iree_io_parameter_archive_builder_is_empty(builder)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "hash type must be set before adding entries");
+  }
+  builder->hash_type = hash_type;
+  return iree_ok_status();
+}
+
+// Ensures |builder| has storage for the hashes of all entries added so far.
+static iree_status_t iree_io_parameter_archive_builder_reserve_hashes(
+    iree_io_parameter_archive_builder_t* builder) {
+  const iree_host_size_t entry_count =
+      iree_io_parameter_index_count(builder->index);
+  if (entry_count <= builder->entry_hash_capacity) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+      builder->host_allocator, entry_count * sizeof(builder->entry_hashes[0]),
+      (void**)&builder->entry_hashes));
+  memset(builder->entry_hashes + builder->entry_hash_capacity, 0,
+         (entry_count - builder->entry_hash_capacity) *
+             sizeof(builder->entry_hashes[0]));
+  builder->entry_hash_capacity = entry_count;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_set_entry_hash(
+    iree_io_parameter_archive_builder_t* builder, iree_host_size_t entry_index,
+    uint64_t value) {
+  IREE_ASSERT_ARGUMENT(builder);
+  if (builder->hash_type == IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "builder has no hash type set");
+  }
+  if (entry_index >= iree_io_parameter_index_count(builder->index)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "entry index %" PRIhsz " out of range (%" PRIhsz
+                            " entries)",
+                            entry_index,
+                            iree_io_parameter_index_count(builder->index));
+  }
+  IREE_RETURN_IF_ERROR(
+      iree_io_parameter_archive_builder_reserve_hashes(builder));
+  builder->entry_hashes[entry_index].type = builder->hash_type;
+  builder->entry_hashes[entry_index].value = value;
+  return iree_ok_status();
+}
+
+// Returns the size of the hash trailing entries with storage, if any.
+static iree_io_physical_size_t iree_io_parameter_archive_builder_hash_size(
+    const iree_io_parameter_archive_builder_t* builder) {
+  return builder->hash_type != IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE
+             ? sizeof(iree_io_parameter_archive_entry_hash_t)
+             : 0;
+}
+
+// Returns the entry flags for entries with storage.
+static iree_io_parameter_archive_entry_flags_t
+iree_io_parameter_archive_builder_storage_entry_flags(
+    const iree_io_parameter_archive_builder_t* builder) {
+  return builder->hash_type != IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE
+             ? IREE_IO_PARAMETER_ARCHIVE_ENTRY_FLAG_HASH
+             : IREE_IO_PARAMETER_ARCHIVE_ENTRY_FLAG_NONE;
+}
+
+// Writes the hash trailing the entry at |entry_index| if the builder stores
+// hashes.
+static iree_status_t iree_io_parameter_archive_builder_write_entry_hash(
+    const iree_io_parameter_archive_builder_t* builder,
+    iree_host_size_t entry_index, iree_io_stream_t* stream) {
+  if (builder->hash_type == IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE) {
+    return iree_ok_status();
+  }
+  iree_io_parameter_archive_entry_hash_t entry_hash = {
+      .type = IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE,
+      .reserved = 0,
+      .value = 0,
+  };
+  if (entry_index < builder->entry_hash_capacity) {
+    entry_hash = builder->entry_hashes[entry_index];
+  }
+  return iree_io_stream_write(stream, sizeof(entry_hash), &entry_hash);
+}
+
 IREE_API_EXPORT bool iree_io_parameter_archive_builder_is_empty(
     const iree_io_parameter_archive_builder_t* builder) {
   IREE_ASSERT_ARGUMENT(builder);
@@ -48,6 +139,15 @@ iree_io_parameter_archive_builder_storage_offset(
       iree_io_parameter_archive_builder_storage_alignment(builder));
 }
 
+// Returns the storage-relative offset of the block table of a compressed
+// |entry|. The table immediately follows the compressed data.
+static iree_io_physical_offset_t iree_io_parameter_archive_block_table_offset(
+    const iree_io_parameter_index_entry_t* entry) {
+  return iree_align_uint64(
+      entry->storage.compressed.offset + entry->storage.compressed.length,
+      iree_alignof(uint64_t));
+}
+
 IREE_API_EXPORT iree_io_physical_size_t
 iree_io_parameter_archive_builder_total_size(
     const iree_io_parameter_archive_builder_t* builder) {
@@ -87,13 +187,29 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
       .length = builder->storage_segment_size,
   };
 
+  // Compressed entries were added in version 0.1. We only bump the version
+  // when they are used so that other archives remain loadable by older
+  // runtimes.
+  uint16_t version_minor = 0;
+  for (iree_host_size_t i = 0;
+       i < iree_io_parameter_index_count(builder->index); ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_index_get(builder->index, i, &source_entry));
+    if (source_entry->type ==
+        IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+      version_minor = 1;
+      break;
+    }
+  }
+
   // Write the archive header referencing the other segments in the file.
   iree_io_parameter_archive_header_v0_t header = {
       .prefix =
           {
               .magic = IREE_IO_PARAMETER_ARCHIVE_MAGIC,
               .version_major = 0,
-              .version_minor = 0,
+              .version_minor = version_minor,
               .header_size = sizeof(header),
               .next_header_offset = 0,
               .flags = 0,
@@ -168,9 +284,13 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         iree_io_parameter_archive_data_entry_t data_entry = {
             .header =
                 {
-                    .entry_size = sizeof(data_entry),
+                    .entry_size =
+                        sizeof(data_entry) +
+                        iree_io_parameter_archive_builder_hash_size(builder),
                     .type = IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_DATA,
-                    .flags = 0,
+                    .flags =
+                        iree_io_parameter_archive_builder_storage_entry_flags(
+                            builder),
                     .name = name_ref,
                     .metadata = metadata_ref,
                     .minimum_alignment =
@@ -186,6 +306,52 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         target_entry.storage.file.offset += storage_segment.offset;
         IREE_RETURN_AND_END_ZONE_IF_ERROR(
             z0, iree_io_stream_write(stream, sizeof(data_entry), &data_entry));
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_parameter_archive_builder_write_entry_hash(builder, i,
+                                                                   stream));
+        break;
+      }
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED: {
+        const iree_io_compressed_blocks_t* blocks =
+            &target_entry.storage.compressed.blocks;
+        iree_io_parameter_archive_compressed_entry_t compressed_entry = {
+            .header =
+                {
+                    .entry_size =
+                        sizeof(compressed_entry) +
+                        iree_io_parameter_archive_builder_hash_size(builder),
+                    .type = IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_COMPRESSED,
+                    .flags =
+                        iree_io_parameter_archive_builder_storage_entry_flags(
+                            builder),
+                    .name = name_ref,
+                    .metadata = metadata_ref,
+                    .minimum_alignment =
+                        IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
+                },
+            .length = target_entry.length,
+            .compression_type = blocks->type,
+            .block_size = blocks->block_size,
+            .block_table =
+                {
+                    .offset = iree_io_parameter_archive_block_table_offset(
+                        &target_entry),
+                    .length = (blocks->block_count + 1) * sizeof(uint64_t),
+                },
+            .storage =
+                {
+                    .offset = target_entry.storage.compressed.offset,
+                    .length = target_entry.storage.compressed.length,
+                },
+        };
+        target_entry.storage.compressed.handle = file_handle;
+        target_entry.storage.compressed.offset += storage_segment.offset;
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_stream_write(stream, sizeof(compressed_entry),
+                                     &compressed_entry));
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_parameter_archive_builder_write_entry_hash(builder, i,
+                                                                   stream));
         break;
       }
       default: {
@@ -219,6 +385,31 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
                                  source_entry->metadata.data));
   }
 
+  // Write the block tables of compressed entries into the storage segment.
+  // The compressed data is written by the caller.
+  for (iree_host_size_t i = 0;
+       i < iree_io_parameter_index_count(builder->index); ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_index_get(builder->index, i, &source_entry));
+    if (source_entry->type !=
+        IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+      continue;
+    }
+    const iree_io_compressed_blocks_t* blocks =
+        &source_entry->storage.compressed.blocks;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_stream_seek(
+                stream, IREE_IO_STREAM_SEEK_SET,
+                file_offset + storage_segment.offset +
+                    iree_io_parameter_archive_block_table_offset(
+                        source_entry)));
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_stream_write(
+                stream, (blocks->block_count + 1) * sizeof(uint64_t),
+                blocks->block_offsets));
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
@@ -292,7 +483,8 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
   builder->entry_segment_size =
       iree_align_uint64(builder->entry_segment_size,
                         IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT) +
-      sizeof(iree_io_parameter_archive_data_entry_t);
+      sizeof(iree_io_parameter_archive_data_entry_t) +
+      iree_io_parameter_archive_builder_hash_size(builder);
   builder->metadata_segment_size += name.size + metadata.data_length;
   builder->storage_segment_size = entry.storage.file.offset + entry.length;
   if (!builder->storage_alignment) {
@@ -303,25 +495,541 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_archive_builder_add_compressed_entry(
+    iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
+    iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
+    const iree_io_compressed_blocks_t* blocks,
+    iree_io_physical_size_t compressed_length) {
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_ASSERT_ARGUMENT(blocks);
+  IREE_RETURN_IF_ERROR(
+      iree_io_compressed_blocks_verify(blocks, compressed_length));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, name.data, name.size);
+  iree_io_parameter_index_entry_t entry = {
+      .key = name,
+      .metadata = metadata,
+      .length = blocks->length,
+      .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED,
+      .storage =
+          {
+              .compressed =
+                  {
+                      .handle = NULL,  // set on commit
+                      .offset = iree_align_uint64(builder->storage_segment_size,
+                                                  minimum_alignment),
+                      .length = compressed_length,
+                      .blocks = *blocks,
+                  },
+          },
+  };
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_index_add(builder->index, &entry));
+  builder->entry_segment_size =
+      iree_align_uint64(builder->entry_segment_size,
+                        IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT) +
+      sizeof(iree_io_parameter_archive_compressed_entry_t) +
+      iree_io_parameter_archive_builder_hash_size(builder);
+  builder->metadata_segment_size += name.size + metadata.data_length;
+  builder->storage_segment_size =
+      iree_io_parameter_archive_block_table_offset(&entry) +
+      (blocks->block_count + 1) * sizeof(uint64_t);
+  // Block tables are 8-byte aligned relative to the storage segment and need
+  // the segment itself to be at least as aligned.
+  builder->storage_alignment = iree_max(
+      iree_max(builder->storage_alignment, minimum_alignment),
+      iree_alignof(uint64_t));
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_io_build_parameter_archive
+//===----------------------------------------------------------------------===//
+
+// Compresses |source| into |block_size| blocks written back-to-back into
+// |target| and stores the offset of each block in |block_offsets|
+// (block_count + 1). |target| must have at least as many bytes as |source|;
+// blocks that don't compress are stored as-is.
+static iree_status_t iree_io_parameter_archive_compress_blocks(
+    iree_io_compression_type_t compression_type, uint32_t block_size,
+    iree_const_byte_span_t source, iree_byte_span_t target,
+    uint64_t* block_offsets) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, source.data_length);
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t compressed_offset = 0;
+  iree_host_size_t block_index = 0;
+  block_offsets[0] = 0;
+  for (iree_host_size_t offset = 0;
+       iree_status_is_ok(status) && offset < source.data_length;
+       offset += block_size, ++block_index) {
+    iree_const_byte_span_t block = iree_make_const_byte_span(
+        source.data + offset,
+        iree_min(block_size, source.data_length - offset));
+    // Only keep the compressed form if it's smaller than the block; readers
+    // treat a block with equal compressed and uncompressed lengths as raw.
+    iree_host_size_t compressed_length = 0;
+    status = iree_io_compress_block(
+        compression_type, block,
+        iree_make_byte_span(target.data + compressed_offset,
+                            block.data_length - 1),
+        &compressed_length);
+    if (iree_status_is_resource_exhausted(status)) {
+      status = iree_status_ignore(status);
+      memcpy(target.data + compressed_offset, block.data, block.data_length);
+      compressed_length = block.data_length;
+    }
+    compressed_offset += compressed_length;
+    block_offsets[block_index + 1] = compressed_offset;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Contents of a file-backed source entry compressed while sizing the archive.
+// Kept until the entry is written to the storage segment so that each entry is
+// only compressed once.
+typedef struct iree_io_parameter_archive_compressed_data_t {
+  // Offsets of each block in |data| (block_count + 1).
+  uint64_t* block_offsets;
+  // Compressed blocks.
+  uint8_t* data;
+  iree_host_size_t length;
+} iree_io_parameter_archive_compressed_data_t;
+
+static void iree_io_parameter_archive_compressed_data_reset(
+    iree_io_parameter_archive_compressed_data_t* compressed_data,
+    iree_allocator_t host_allocator) {
+  iree_allocator_free(host_allocator, compressed_data->block_offsets);
+  iree_allocator_free(host_allocator, compressed_data->data);
+  memset(compressed_data, 0, sizeof(*compressed_data));
+}
+
+// Compresses the file-backed |source_entry| into |block_size| blocks stored in
+// |out_compressed_data|. The caller must reset |out_compressed_data| when it
+// is no longer needed, even on failure.
+static iree_status_t iree_io_parameter_archive_compress_entry(
+    const iree_io_parameter_index_entry_t* source_entry,
+    iree_io_compression_type_t compression_type, uint32_t block_size,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_archive_compressed_data_t* out_compressed_data) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, source_entry->key.data,
+                              source_entry->key.size);
+
+  const iree_host_size_t block_count =
+      (iree_host_size_t)iree_io_compressed_block_count(source_entry->length,
+                                                       block_size);
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator,
+      (block_count + 1) * sizeof(out_compressed_data->block_offsets[0]),
+      (void**)&out_compressed_data->block_offsets);
+
+  // Compressed blocks are never larger than the source; the storage is trimmed
+  // to the compressed length once known.
+  iree_io_file_mapping_t* mapping = NULL;
+  if (iree_status_is_ok(status) && source_entry->length > 0) {
+    status = iree_allocator_malloc_uninitialized(
+        host_allocator, (iree_host_size_t)source_entry->length,
+        (void**)&out_compressed_data->data);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_file_map_view(
+          source_entry->storage.file.handle, IREE_IO_FILE_ACCESS_READ,
+          source_entry->storage.file.offset,
+          (iree_host_size_t)source_entry->length,
+          IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS |
+              IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS,
+          host_allocator, &mapping);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_compress_blocks(
+        compression_type, block_size,
+        mapping ? iree_io_file_mapping_contents_ro(mapping)
+                : iree_const_byte_span_empty(),
+        iree_make_byte_span(out_compressed_data->data,
+                            (iree_host_size_t)source_entry->length),
+        out_compressed_data->block_offsets);
+  }
+  iree_io_file_mapping_release(mapping);
+
+  if (iree_status_is_ok(status)) {
+    out_compressed_data->length =
+        (iree_host_size_t)out_compressed_data->block_offsets[block_count];
+    if (out_compressed_data->length > 0 &&
+        out_compressed_data->length < source_entry->length) {
+      status = iree_allocator_realloc(host_allocator,
+                                      out_compressed_data->length,
+                                      (void**)&out_compressed_data->data);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+typedef struct iree_io_parameter_archive_compress_state_t {
+  iree_io_parameter_index_t* source_index;
+  iree_io_compression_type_t compression_type;
+  uint32_t block_size;
+  // Compressed contents indexed by entry. Only file-backed entries are
+  // compressed.
+  iree_io_parameter_archive_compressed_data_t* compressed_datas;
+  iree_allocator_t host_allocator;
+} iree_io_parameter_archive_compress_state_t;
+
+// Compresses the source entry at |entry_index| if it is file-backed.
+static iree_status_t iree_io_parameter_archive_compress_indexed_entry(
+    void* user_data, iree_host_size_t entry_index) {
+  const iree_io_parameter_archive_compress_state_t* state =
+      (const iree_io_parameter_archive_compress_state_t*)user_data;
+  const iree_io_parameter_index_entry_t* source_entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_get(
+      state->source_index, entry_index, &source_entry));
+  if (source_entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+    return iree_ok_status();
+  }
+  return iree_io_parameter_archive_compress_entry(
+      source_entry, state->compression_type, state->block_size,
+      state->host_allocator, &state->compressed_datas[entry_index]);
+}
+
+// Declares the compressed |source_entry| in |builder| with the block layout
+// of |compressed_data|.
+static iree_status_t iree_io_parameter_archive_builder_add_compressed_data(
+    iree_io_parameter_archive_builder_t* builder,
+    const iree_io_parameter_index_entry_t* source_entry,
+    iree_io_compression_type_t compression_type, uint32_t block_size,
+    const iree_io_parameter_archive_compressed_data_t* compressed_data) {
+  const iree_io_compressed_blocks_t blocks = {
+      .type = compression_type,
+      .block_size = block_size,
+      .length = source_entry->length,
+      .block_count = (iree_host_size_t)iree_io_compressed_block_count(
+          source_entry->length, block_size),
+      .block_offsets = compressed_data->block_offsets,
+  };
+  return iree_io_parameter_archive_builder_add_compressed_entry(
+      builder, source_entry->key, source_entry->metadata,
+      IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT, &blocks,
+      compressed_data->length);
+}
+
+// Writes the decompressed contents of the compressed |source_entry| to
+// |stream| one block at a time.
+static iree_status_t iree_io_parameter_archive_decompress_entry(
+    const iree_io_parameter_index_entry_t* source_entry,
+    iree_io_stream_t* stream, iree_allocator_t host_allocator) {
+  if (source_entry->length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, source_entry->key.data,
+                              source_entry->key.size);
+
+  const iree_io_compressed_blocks_t* blocks =
+      &source_entry->storage.compressed.blocks;
+  iree_io_file_mapping_t* mapping = NULL;
+  iree_status_t status = iree_io_file_map_view(
+      source_entry->storage.compressed.handle, IREE_IO_FILE_ACCESS_READ,
+      source_entry->storage.compressed.offset,
+      (iree_host_size_t)source_entry->storage.compressed.length,
+      IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS, host_allocator, &mapping);
+  uint8_t* scratch = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc_uninitialized(
+        host_allocator, blocks->block_size, (void**)&scratch);
+  }
+  for (uint64_t offset = 0;
+       iree_status_is_ok(status) && offset < source_entry->length;
+       offset += blocks->block_size) {
+    iree_byte_span_t block = iree_make_byte_span(
+        scratch, (iree_host_size_t)iree_min(blocks->block_size,
+                                            source_entry->length - offset));
+    status = iree_io_compressed_blocks_read(
+        blocks, iree_io_file_mapping_contents_ro(mapping),
+        /*compressed_data_offset=*/0, offset, block, host_allocator);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_stream_write(stream, block.data_length, block.data);
+    }
+  }
+  iree_allocator_free(host_allocator, scratch);
+  iree_io_file_mapping_release(mapping);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Writes the transformed contents of the |source_entry| to |stream| one
+// transform chunk at a time. Transforms are one-way and the archive stores
+// their output as a plain data entry.
+static iree_status_t iree_io_parameter_archive_transform_entry(
+    const iree_io_parameter_index_entry_t* source_entry,
+    iree_io_stream_t* stream, iree_allocator_t host_allocator) {
+  if (source_entry->length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, source_entry->key.data,
+                              source_entry->key.size);
+
+  // Process whole transform chunks but at least enough at a time to amortize
+  // the per-call overhead of small chunks.
+  const uint64_t transform_chunk_size =
+      iree_max(1, source_entry->storage.transform.chunk_size);
+  const iree_host_size_t chunk_size = (iree_host_size_t)iree_min(
+      source_entry->length,
+      iree_max(1, IREE_IO_COMPRESSION_DEFAULT_BLOCK_SIZE /
+                      transform_chunk_size) *
+          transform_chunk_size);
+
+  iree_io_file_mapping_t* mapping = NULL;
+  iree_status_t status = iree_io_file_map_view(
+      source_entry->storage.transform.handle, IREE_IO_FILE_ACCESS_READ,
+      source_entry->storage.transform.offset,
+      (iree_host_size_t)source_entry->storage.transform.length,
+      IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS, host_allocator, &mapping);
+  uint8_t* scratch = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc_uninitialized(host_allocator, chunk_size,
+                                                 (void**)&scratch);
+  }
+  for (uint64_t offset = 0;
+       iree_status_is_ok(status) && offset < source_entry->length;
+       offset += chunk_size) {
+    iree_byte_span_t chunk = iree_make_byte_span(
+        scratch,
+        (iree_host_size_t)iree_min(chunk_size, source_entry->length - offset));
+    status = source_entry->storage.transform.fn(
+        source_entry->storage.transform.params,
+        iree_io_file_mapping_contents_ro(mapping), offset, chunk);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_stream_write(stream, chunk.data_length, chunk.data);
+    }
+  }
+  iree_allocator_free(host_allocator, scratch);
+  iree_io_file_mapping_release(mapping);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Writes |length| bytes of |file_handle| starting at |file_offset| to
+// |stream|. The source is read through a mapping so that multiple entries
+// from the same file can be copied concurrently.
+static iree_status_t iree_io_parameter_archive_copy_range(
+    iree_io_file_handle_t* file_handle, uint64_t file_offset, uint64_t length,
+    iree_io_stream_t* stream, iree_allocator_t host_allocator) {
+  if (length == 0) return iree_ok_status();
+  iree_io_file_mapping_t* mapping = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_file_map_view(
+      file_handle, IREE_IO_FILE_ACCESS_READ, file_offset,
+      (iree_host_size_t)length,
+      IREE_IO_FILE_MAPPING_FLAG_SEQUENTIAL_ACCESS |
+          IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS,
+      host_allocator, &mapping));
+  iree_const_byte_span_t contents = iree_io_file_mapping_contents_ro(mapping);
+  iree_status_t status =
+      iree_io_stream_write(stream, contents.data_length, contents.data);
+  iree_io_file_mapping_release(mapping);
+  return status;
+}
+
+typedef struct iree_io_parameter_archive_write_state_t {
+  // Index of source entries in the same order as the builder entries.
+  iree_io_parameter_index_t* source_index;
+  // Builder with all entries declared. Entry hashes are written by workers.
+  iree_io_parameter_archive_builder_t* builder;
+  // Contents of entries compressed while sizing the archive indexed by entry.
+  // Each is released once written.
+  iree_io_parameter_archive_compressed_data_t* compressed_datas;
+  // Storage segment of the target archive mapped for writing.
+  iree_byte_span_t storage;
+  iree_allocator_t host_allocator;
+} iree_io_parameter_archive_write_state_t;
+
+// Writes the contents of the source entry at |entry_index| into the storage
+// reserved for it in the target archive and records the hash of the written
+// bytes. Each entry has its own storage range so entries can be written
+// concurrently.
+static iree_status_t iree_io_parameter_archive_write_entry(
+    void* user_data, iree_host_size_t entry_index) {
+  iree_io_parameter_archive_write_state_t* state =
+      (iree_io_parameter_archive_write_state_t*)user_data;
+  const iree_io_parameter_index_entry_t* source_entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_get(state->source_index,
+                                                   entry_index, &source_entry));
+  const iree_io_parameter_index_entry_t* declared_entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_get(
+      state->builder->index, entry_index, &declared_entry));
+
+  // Find the storage reserved in the archive (if any).
+  iree_io_physical_offset_t storage_offset = 0;
+  iree_io_physical_size_t storage_length = 0;
+  switch (declared_entry->type) {
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT:
+      // No work to do.
+      return iree_ok_status();
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+      storage_offset = declared_entry->storage.compressed.offset;
+      storage_length = declared_entry->storage.compressed.length;
+      break;
+    default:
+      storage_offset = declared_entry->storage.file.offset;
+      storage_length = declared_entry->length;
+      break;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, source_entry->key.data,
+                              source_entry->key.size);
+  iree_byte_span_t target = iree_make_byte_span(
+      state->storage.data + storage_offset, (iree_host_size_t)storage_length);
+
+  iree_io_stream_t* target_stream = NULL;
+  iree_status_t status = iree_io_memory_stream_wrap(
+      IREE_IO_STREAM_MODE_WRITABLE, target,
+      iree_io_stream_release_callback_null(), state->host_allocator,
+      &target_stream);
+  if (iree_status_is_ok(status)) {
+    switch (source_entry->type) {
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
+        if (declared_entry->type ==
+            IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+          iree_io_parameter_archive_compressed_data_t* compressed_data =
+              &state->compressed_datas[entry_index];
+          status = iree_io_stream_write(target_stream, compressed_data->length,
+                                        compressed_data->data);
+          iree_io_parameter_archive_compressed_data_reset(
+              compressed_data, state->host_allocator);
+        } else {
+          status = iree_io_parameter_archive_copy_range(
+              source_entry->storage.file.handle,
+              source_entry->storage.file.offset, source_entry->length,
+              target_stream, state->host_allocator);
+        }
+        break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+        if (declared_entry->type ==
+            IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+          // Already compressed: copy the stored blocks as-is.
+          status = iree_io_parameter_archive_copy_range(
+              source_entry->storage.compressed.handle,
+              source_entry->storage.compressed.offset,
+              source_entry->storage.compressed.length, target_stream,
+              state->host_allocator);
+        } else {
+          status = iree_io_parameter_archive_decompress_entry(
+              source_entry, target_stream, state->host_allocator);
+        }
+        break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM:
+        status = iree_io_parameter_archive_transform_entry(
+            source_entry, target_stream, state->host_allocator);
+        break;
+      default:
+        status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "unhandled index entry storage type %d",
+                                  (int)source_entry->type);
+        break;
+    }
+  }
+  iree_io_stream_release(target_stream);
+
+  // Hash the bytes as stored in the archive. Hash slots were reserved for all
+  // entries prior to starting the workers.
+  if (iree_status_is_ok(status) &&
+      state->builder->hash_type == IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64) {
+    iree_io_parameter_archive_entry_hash_t* entry_hash =
+        &state->builder->entry_hashes[entry_index];
+    entry_hash->type = IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64;
+    entry_hash->value = iree_io_xxh64(
+        iree_make_const_byte_span(target.data, target.data_length));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
     iree_io_parameter_index_t* source_index,
     iree_io_parameter_index_t* target_index,
     iree_io_parameter_archive_file_open_callback_t target_file_open,
     iree_io_physical_offset_t target_file_offset,
     iree_allocator_t host_allocator) {
+  const iree_io_parameter_archive_build_options_t options = {
+      .compression_type = IREE_IO_COMPRESSION_TYPE_NONE,
+      .compression_block_size = 0,
+      .hash_type = IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE,
+      .worker_count = 0,
+  };
+  return iree_io_build_parameter_archive_with_options(
+      source_index, target_index, target_file_open, target_file_offset,
+      &options, host_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive_with_options(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_parameter_archive_file_open_callback_t target_file_open,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(source_index);
   IREE_ASSERT_ARGUMENT(target_index);
   IREE_ASSERT_ARGUMENT(target_file_open.fn);
+  IREE_ASSERT_ARGUMENT(options);
+  const iree_io_compression_type_t compression_type = options->compression_type;
+  const uint32_t block_size = options->compression_block_size
+                                  ? options->compression_block_size
+                                  : IREE_IO_COMPRESSION_DEFAULT_BLOCK_SIZE;
+  if (compression_type != IREE_IO_COMPRESSION_TYPE_NONE &&
+      (block_size < IREE_IO_COMPRESSION_MIN_BLOCK_SIZE ||
+       block_size > IREE_IO_COMPRESSION_MAX_BLOCK_SIZE)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "compression block size %u out of range [%d, %d]",
+                            block_size, IREE_IO_COMPRESSION_MIN_BLOCK_SIZE,
+                            IREE_IO_COMPRESSION_MAX_BLOCK_SIZE);
+  }
+  if (options->hash_type != IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE &&
+      options->hash_type != IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "unsupported hash type %u", options->hash_type);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_io_parameter_archive_builder_t builder;
   iree_io_parameter_archive_builder_initialize(host_allocator, &builder);
+  iree_status_t status = iree_io_parameter_archive_builder_set_hash_type(
+      &builder, options->hash_type);
+
+  // File-backed entries are compressed in parallel before sizing the archive
+  // as their compressed sizes are needed for the layout. The compressed
+  // contents are kept for the write phase.
+  const iree_host_size_t entry_count =
+      iree_io_parameter_index_count(source_index);
+  iree_io_parameter_archive_compressed_data_t* compressed_datas = NULL;
+  if (iree_status_is_ok(status) && entry_count > 0 &&
+      compression_type != IREE_IO_COMPRESSION_TYPE_NONE) {
+    status = iree_allocator_malloc(host_allocator,
+                                   entry_count * sizeof(compressed_datas[0]),
+                                   (void**)&compressed_datas);
+    if (iree_status_is_ok(status)) {
+      iree_io_parameter_archive_compress_state_t compress_state = {
+          .source_index = source_index,
+          .compression_type = compression_type,
+          .block_size = block_size,
+          .compressed_datas = compressed_datas,
+          .host_allocator = host_allocator,
+      };
+      status = iree_io_parallel_for(
+          options->worker_count, entry_count,
+          iree_io_parameter_archive_compress_indexed_entry, &compress_state,
+          host_allocator);
+    }
+  }
 
-  // Declare a parameter for each entry in the index.
+  // Declare a parameter for each entry in the index in order.
   // This lets us calculate the size we require to store the entry metadata and
-  // its contents (if any). No data is accessed yet.
-  iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < iree_io_parameter_index_count(source_index);
+  // its contents (if any). Only compressed entries have been read.
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < entry_count;
        ++i) {
     const iree_io_parameter_index_entry_t* source_entry = NULL;
     status = iree_io_parameter_index_get(source_index, i, &source_entry);
@@ -334,6 +1042,34 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
             source_entry->storage.splat.pattern_length, source_entry->length);
         break;
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
+        if (compression_type != IREE_IO_COMPRESSION_TYPE_NONE) {
+          status = iree_io_parameter_archive_builder_add_compressed_data(
+              &builder, source_entry, compression_type, block_size,
+              &compressed_datas[i]);
+        } else {
+          status = iree_io_parameter_archive_builder_add_data_entry(
+              &builder, source_entry->key, source_entry->metadata,
+              IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
+              source_entry->length);
+        }
+        break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+        if (compression_type != IREE_IO_COMPRESSION_TYPE_NONE) {
+          // Already compressed; copy the blocks as-is.
+          status = iree_io_parameter_archive_builder_add_compressed_entry(
+              &builder, source_entry->key, source_entry->metadata,
+              IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
+              &source_entry->storage.compressed.blocks,
+              source_entry->storage.compressed.length);
+        } else {
+          status = iree_io_parameter_archive_builder_add_data_entry(
+              &builder, source_entry->key, source_entry->metadata,
+              IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
+              source_entry->length);
+        }
+        break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM:
+        // Transformed contents are materialized and stored uncompressed.
         status = iree_io_parameter_archive_builder_add_data_entry(
             &builder, source_entry->key, source_entry->metadata,
             IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
@@ -359,6 +1095,40 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
                                  archive_length, &target_file_handle);
   }
 
+  // Write parameter entry contents (if any) directly into a mapping of the
+  // storage segment. Each entry is written (and compressed/hashed) by one of
+  // the workers and the header is written after so that it can include the
+  // content hashes.
+  if (iree_status_is_ok(status) && builder.storage_segment_size > 0) {
+    if (builder.hash_type != IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE) {
+      status = iree_io_parameter_archive_builder_reserve_hashes(&builder);
+    }
+    iree_io_file_mapping_t* storage_mapping = NULL;
+    if (iree_status_is_ok(status)) {
+      status = iree_io_file_map_view(
+          target_file_handle,
+          IREE_IO_FILE_ACCESS_READ | IREE_IO_FILE_ACCESS_WRITE,
+          target_file_offset +
+              iree_io_parameter_archive_builder_storage_offset(&builder),
+          (iree_host_size_t)builder.storage_segment_size,
+          IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS, host_allocator,
+          &storage_mapping);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_io_parameter_archive_write_state_t write_state = {
+          .source_index = source_index,
+          .builder = &builder,
+          .compressed_datas = compressed_datas,
+          .storage = iree_io_file_mapping_contents_rw(storage_mapping),
+          .host_allocator = host_allocator,
+      };
+      status = iree_io_parallel_for(
+          options->worker_count, entry_count,
+          iree_io_parameter_archive_write_entry, &write_state, host_allocator);
+    }
+    iree_io_file_mapping_release(storage_mapping);
+  }
+
   // Wrap the target file in a stream.
   iree_io_stream_t* target_stream = NULL;
   if (iree_status_is_ok(status)) {
@@ -368,50 +1138,12 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
   }
 
   // Commit the archive header to the file and produce an index referencing it.
-  // This will allow us to know where to copy file contents.
   if (iree_status_is_ok(status)) {
     status = iree_io_parameter_archive_builder_write(
         &builder, target_file_handle, target_file_offset, target_stream,
         target_index);
   }
 
-  // Copy over parameter entry file contents (if any).
-  // This is a slow operation and something we could optimize with lower-level
-  // platform primitives.
-  if (iree_status_is_ok(status)) {
-    for (iree_host_size_t i = 0;
-         i < iree_io_parameter_index_count(source_index); ++i) {
-      const iree_io_parameter_index_entry_t* source_entry = NULL;
-      status = iree_io_parameter_index_get(source_index, i, &source_entry);
-      if (!iree_status_is_ok(status)) break;
-      const iree_io_parameter_index_entry_t* target_entry = NULL;
-      status = iree_io_parameter_index_lookup(target_index, source_entry->key,
-                                              &target_entry);
-      if (!iree_status_is_ok(status)) break;
-      switch (source_entry->type) {
-        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT:
-          // No work to do.
-          break;
-        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
-          status = iree_io_stream_seek(
-              target_stream, IREE_IO_STREAM_SEEK_SET,
-              target_file_offset + target_entry->storage.file.offset);
-          if (!iree_status_is_ok(status)) break;
-          status = iree_io_stream_write_file(
-              target_stream, source_entry->storage.file.handle,
-              source_entry->storage.file.offset, target_entry->length,
-              host_allocator);
-          break;
-        default:
-          status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                    "unhandled index entry storage type %d",
-                                    (int)source_entry->type);
-          break;
-      }
-      if (!iree_status_is_ok(status)) break;
-    }
-  }
-
   iree_io_stream_release(target_stream);
 
   // Flush file contents before returning to the caller (in case they open the
@@ -421,6 +1153,13 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
   }
 
   iree_io_file_handle_release(target_file_handle);
+  if (compressed_datas) {
+    for (iree_host_size_t i = 0; i < entry_count; ++i) {
+      iree_io_parameter_archive_compressed_data_reset(&compressed_datas[i],
+                                                      host_allocator);
+    }
+    iree_allocator_free(host_allocator, compressed_datas);
+  }
   iree_io_parameter_archive_builder_deinitialize(&builder);
 
   IREE_TRACE_ZONE_END(z0);
@@ -8,6 +8,7 @@
 #define IREE_IO_FORMATS_IRPA_IRPA_BUILDER_H_
 
 #include "iree/base/api.h"
+#include "iree/io/compression.h"
 #include "iree/io/file_handle.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/stream.h"
@@ -40,6 +41,13 @@ typedef struct iree_io_parameter_archive_builder_t {
   iree_io_physical_size_t metadata_segment_size;
   iree_io_physical_size_t storage_segment_size;
   iree_io_physical_size_t storage_alignment;
+  // Hash stored with entries that have storage or NONE to omit hashes.
+  iree_io_parameter_archive_hash_type_t hash_type;
+  // Content hashes of each entry in |index| set with
+  // iree_io_parameter_archive_builder_set_entry_hash. Entries beyond
+  // |entry_hash_capacity| have no hash.
+  iree_io_parameter_archive_entry_hash_t* entry_hashes;
+  iree_host_size_t entry_hash_capacity;
 } iree_io_parameter_archive_builder_t;
 
 // Initializes a new parameter builder in |out_builder| for use.
@@ -53,6 +61,22 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_initialize(
 IREE_API_EXPORT void iree_io_parameter_archive_builder_deinitialize(
     iree_io_parameter_archive_builder_t* builder);
 
+// Sets the |hash_type| stored with entries that have storage in the archive.
+// Must be called before any entries are added as the hashes occupy space in
+// the entry table. Hash values must be provided with
+// iree_io_parameter_archive_builder_set_entry_hash prior to writing the
+// archive; entries without one are written with a hash type of NONE.
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_set_hash_type(
+    iree_io_parameter_archive_builder_t* builder,
+    iree_io_parameter_archive_hash_type_t hash_type);
+
+// Sets the content hash |value| of the entry at |entry_index| (in the order
+// entries were added). The hash must be computed with the builder hash type
+// over the bytes stored in the archive for the entry.
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_set_entry_hash(
+    iree_io_parameter_archive_builder_t* builder, iree_host_size_t entry_index,
+    uint64_t value);
+
 // Returns true if no parameters have been added to the archive.
 IREE_API_EXPORT bool iree_io_parameter_archive_builder_is_empty(
     const iree_io_parameter_archive_builder_t* builder);
@@ -92,6 +116,20 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
     iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
     iree_io_physical_size_t data_length);
 
+// Adds a new block-compressed data entry to |builder|.
+// |metadata| (if provided) and the |blocks| offset table are copied prior to
+// returning. Physical storage will be allocated for |compressed_length| bytes
+// of compressed data aligned to at least |minimum_alignment| followed by the
+// block table. The block table is written by
+// iree_io_parameter_archive_builder_write and the compressed data must be
+// written by the caller.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_archive_builder_add_compressed_entry(
+    iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
+    iree_const_byte_span_t metadata, iree_io_physical_size_t minimum_alignment,
+    const iree_io_compressed_blocks_t* blocks,
+    iree_io_physical_size_t compressed_length);
+
 // Callback for opening a file for writing.
 // Implementations need to ensure that at least |archive_length| bytes are
 // available in the file starting at |archive_offset|.
@@ -108,6 +146,26 @@ typedef struct {
   void* user_data;
 } iree_io_parameter_archive_file_open_callback_t;
 
+// Options controlling how iree_io_build_parameter_archive_with_options writes
+// parameter contents. Zero-initialize for the defaults.
+typedef struct iree_io_parameter_archive_build_options_t {
+  // Codec used to compress file-backed parameters or NONE to store them as-is.
+  // Parameters that are already compressed in the source are copied without
+  // recompression; when NONE they are decompressed.
+  iree_io_compression_type_t compression_type;
+  // Uncompressed bytes per compressed block or 0 for
+  // IREE_IO_COMPRESSION_DEFAULT_BLOCK_SIZE. Smaller blocks allow for more
+  // parallelism when loading at the cost of compression ratio.
+  uint32_t compression_block_size;
+  // Hash stored with each entry that has storage or NONE to omit hashes.
+  // Hashes are computed over the bytes written to the archive.
+  iree_io_parameter_archive_hash_type_t hash_type;
+  // Maximum number of threads used to compress, write and hash parameter
+  // contents. Each parameter is handled by a single thread. 0 or 1 processes
+  // all contents on the calling thread.
+  iree_host_size_t worker_count;
+} iree_io_parameter_archive_build_options_t;
+
 // Builds a parameter archive from the given |source_index| and returns a new
 // index in |target_index| referencing the new archive file.
 // The total size of the archive will be calculated and the provided
@@ -121,6 +179,25 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
     iree_io_physical_offset_t target_file_offset,
     iree_allocator_t host_allocator);
 
+// Builds a parameter archive as with iree_io_build_parameter_archive using
+// the provided |options| to control how parameter contents are stored.
+//
+// When compressing the archive size is not known until all parameters have
+// been compressed. File-backed parameters are compressed in parallel before
+// sizing the archive and the compressed contents are held in memory until
+// written, so peak memory use is the total compressed size.
+//
+// Parameter contents are written through a mapping of the target file by up
+// to |options| worker_count threads and the archive header is written once
+// all contents (and their hashes) are available.
+IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive_with_options(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_parameter_archive_file_open_callback_t target_file_open,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -6,8 +6,40 @@
 
 #include "iree/io/formats/irpa/irpa_parser.h"
 
+#include "iree/io/formats/irpa/irpa_util.h"
+#include "iree/io/parallel.h"
 #include "iree/schemas/parameter_archive.h"
 
+// Storage range of an entry with a content hash pending verification.
+typedef struct iree_io_irpa_hashed_range_t {
+  iree_string_view_t name;
+  iree_io_physical_offset_t offset;
+  iree_io_physical_size_t length;
+  uint64_t value;
+} iree_io_irpa_hashed_range_t;
+
+// List of hashed ranges gathered while parsing.
+typedef struct iree_io_irpa_hashed_range_list_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+  iree_io_irpa_hashed_range_t* values;
+} iree_io_irpa_hashed_range_list_t;
+
+static iree_status_t iree_io_irpa_hashed_range_list_append(
+    iree_io_irpa_hashed_range_list_t* list,
+    const iree_io_irpa_hashed_range_t* range) {
+  if (list->count == list->capacity) {
+    const iree_host_size_t new_capacity = iree_max(16, list->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        list->host_allocator, new_capacity * sizeof(list->values[0]),
+        (void**)&list->values));
+    list->capacity = new_capacity;
+  }
+  list->values[list->count++] = *range;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_io_verify_irpa_v0_file_range(
     iree_const_byte_span_t file_contents, iree_io_physical_offset_t base_offset,
     iree_io_parameter_archive_range_t range) {
@@ -88,6 +120,49 @@ static iree_status_t iree_io_resolve_irpa_v0_storage(
   return iree_ok_status();
 }
 
+// Adds the content hash trailing the |entry_struct_size| bytes of
+// |entry_header| (if any) to |hashed_ranges| for verification. No-op if
+// |hashed_ranges| is NULL.
+static iree_status_t iree_io_parse_irpa_v0_entry_hash(
+    iree_const_byte_span_t file_contents, iree_io_physical_offset_t base_offset,
+    const iree_io_parameter_archive_header_v0_t* header,
+    const iree_io_parameter_archive_entry_header_t* entry_header,
+    iree_io_physical_size_t entry_struct_size,
+    iree_io_parameter_archive_storage_ref_t storage, iree_string_view_t name,
+    iree_io_irpa_hashed_range_list_t* hashed_ranges) {
+  if (!hashed_ranges || !iree_all_bits_set(
+                            entry_header->flags,
+                            IREE_IO_PARAMETER_ARCHIVE_ENTRY_FLAG_HASH)) {
+    return iree_ok_status();
+  }
+  iree_io_parameter_archive_entry_hash_t entry_hash;
+  if (entry_header->entry_size < entry_struct_size + sizeof(entry_hash)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "entry hash length underflow");
+  }
+  memcpy(&entry_hash, (const uint8_t*)entry_header + entry_struct_size,
+         sizeof(entry_hash));
+  switch (entry_hash.type) {
+    case IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE:
+      return iree_ok_status();
+    case IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64:
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "entry `%.*s` has unsupported hash type %u",
+                              (int)name.size, name.data, entry_hash.type);
+  }
+  iree_io_irpa_hashed_range_t range = {
+      .name = name,
+      .offset = 0,
+      .length = storage.length,
+      .value = entry_hash.value,
+  };
+  IREE_RETURN_IF_ERROR(iree_io_resolve_irpa_v0_storage(
+      file_contents, base_offset, header, storage, &range.offset));
+  return iree_io_irpa_hashed_range_list_append(hashed_ranges, &range);
+}
+
 static iree_status_t iree_io_parse_irpa_v0_splat_entry(
     const iree_io_parameter_archive_header_v0_t* header,
     const iree_io_parameter_archive_splat_entry_t* splat_entry,
@@ -154,13 +229,88 @@ static iree_status_t iree_io_parse_irpa_v0_data_entry(
   return iree_io_parameter_index_add(index, &entry);
 }
 
+static iree_status_t iree_io_parse_irpa_v0_compressed_entry(
+    iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
+    iree_io_physical_offset_t base_offset,
+    const iree_io_parameter_archive_header_v0_t* header,
+    const iree_io_parameter_archive_compressed_entry_t* compressed_entry,
+    iree_string_view_t name, iree_const_byte_span_t metadata,
+    iree_io_parameter_index_t* index) {
+  if (compressed_entry->header.entry_size < sizeof(*compressed_entry)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "compressed entry length underflow");
+  }
+  iree_io_physical_offset_t storage_offset = 0;
+  IREE_RETURN_IF_ERROR(iree_io_resolve_irpa_v0_storage(
+      file_contents, base_offset, header, compressed_entry->storage,
+      &storage_offset));
+  iree_io_physical_offset_t block_table_offset = 0;
+  IREE_RETURN_IF_ERROR(iree_io_resolve_irpa_v0_storage(
+      file_contents, base_offset, header, compressed_entry->block_table,
+      &block_table_offset));
+
+  // The block table must have one offset per block plus the end offset.
+  const uint64_t block_count = iree_io_compressed_block_count(
+      compressed_entry->length, compressed_entry->block_size);
+  if (compressed_entry->block_table.length !=
+      (block_count + 1) * sizeof(uint64_t)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "compressed entry block table length %" PRIu64
+        " does not match %" PRIu64 " blocks of %u bytes",
+        compressed_entry->block_table.length, block_count,
+        compressed_entry->block_size);
+  }
+  if (!iree_host_size_has_alignment(
+          (iree_host_size_t)(uintptr_t)(file_contents.data +
+                                        block_table_offset),
+          iree_alignof(uint64_t))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "compressed entry block table misaligned");
+  }
+
+  iree_io_parameter_index_entry_t entry = {
+      .key = name,
+      .metadata = metadata,
+      .length = compressed_entry->length,
+      .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED,
+      .storage =
+          {
+              .compressed =
+                  {
+                      .handle = file_handle,
+                      .offset = storage_offset,
+                      .length = compressed_entry->storage.length,
+                      .blocks =
+                          {
+                              .type = (iree_io_compression_type_t)
+                                          compressed_entry->compression_type,
+                              .block_size = compressed_entry->block_size,
+                              .length = compressed_entry->length,
+                              .block_count = (iree_host_size_t)block_count,
+                              .block_offsets =
+                                  (const uint64_t*)(file_contents.data +
+                                                    block_table_offset),
+                          },
+                  },
+          },
+  };
+  IREE_RETURN_IF_ERROR(iree_io_compressed_blocks_verify(
+                           &entry.storage.compressed.blocks,
+                           compressed_entry->storage.length),
+                       "verifying compressed entry `%.*s`", (int)name.size,
+                       name.data);
+  return iree_io_parameter_index_add(index, &entry);
+}
+
 static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
     iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
     iree_io_physical_offset_t base_offset,
     const iree_io_parameter_archive_header_prefix_t* header_prefix,
-    iree_io_parameter_index_t* index) {
-  // Get the full header struct.
-  if (header_prefix->version_minor > 0) {
+    iree_io_parameter_index_t* index,
+    iree_io_irpa_hashed_range_list_t* hashed_ranges) {
+  // Get the full header struct. Minor version 1 added compressed entries.
+  if (header_prefix->version_minor > 1) {
     return iree_make_status(
         IREE_STATUS_UNIMPLEMENTED,
         "IRPA version %u.%u not supported (major supported "
@@ -191,6 +341,17 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
                            file_contents, base_offset, header->storage_segment),
                        "verifying storage segment");
 
+  // Reserve index capacity for all entries up front. The entry count comes
+  // from the file and is bounded by what could fit in the (verified) entry
+  // table so that a corrupt header can't make us over-allocate.
+  const iree_io_physical_size_t max_entry_count =
+      header->entry_segment.length /
+      sizeof(iree_io_parameter_archive_entry_header_t);
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_reserve(
+      index, iree_io_parameter_index_count(index) +
+                 (iree_host_size_t)iree_min(header->entry_count,
+                                            max_entry_count)));
+
   // Walk the entry table, which has variable-length entries.
   iree_io_physical_offset_t entry_offset =
       base_offset + header->entry_segment.offset;
@@ -244,10 +405,26 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
         break;
       }
       case IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_DATA: {
+        const iree_io_parameter_archive_data_entry_t* data_entry =
+            (const iree_io_parameter_archive_data_entry_t*)entry_header;
         IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_data_entry(
-            file_handle, file_contents, base_offset, header,
-            (const iree_io_parameter_archive_data_entry_t*)entry_header, name,
+            file_handle, file_contents, base_offset, header, data_entry, name,
             metadata, index));
+        IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_entry_hash(
+            file_contents, base_offset, header, entry_header,
+            sizeof(*data_entry), data_entry->storage, name, hashed_ranges));
+        break;
+      }
+      case IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_COMPRESSED: {
+        const iree_io_parameter_archive_compressed_entry_t* compressed_entry =
+            (const iree_io_parameter_archive_compressed_entry_t*)entry_header;
+        IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_compressed_entry(
+            file_handle, file_contents, base_offset, header, compressed_entry,
+            name, metadata, index));
+        IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_entry_hash(
+            file_contents, base_offset, header, entry_header,
+            sizeof(*compressed_entry), compressed_entry->storage, name,
+            hashed_ranges));
         break;
       }
       default:
@@ -262,7 +439,8 @@ static iree_status_t iree_io_parse_irpa_v0_index_from_memory(
 
 static iree_status_t iree_io_parse_irpa_index_from_memory(
     iree_io_file_handle_t* file_handle, iree_const_byte_span_t file_contents,
-    iree_io_physical_offset_t base_offset, iree_io_parameter_index_t* index) {
+    iree_io_physical_offset_t base_offset, iree_io_parameter_index_t* index,
+    iree_io_irpa_hashed_range_list_t* hashed_ranges) {
   // Check the basic header information is something we can process.
   if (file_contents.data_length <
       base_offset + sizeof(iree_io_parameter_archive_header_prefix_t)) {
@@ -303,7 +481,8 @@ static iree_status_t iree_io_parse_irpa_index_from_memory(
   switch (header_prefix->version_major) {
     case 0: {
       IREE_RETURN_IF_ERROR(iree_io_parse_irpa_v0_index_from_memory(
-          file_handle, file_contents, base_offset, header_prefix, index));
+          file_handle, file_contents, base_offset, header_prefix, index,
+          hashed_ranges));
       break;
     }
     default: {
@@ -318,12 +497,54 @@ static iree_status_t iree_io_parse_irpa_index_from_memory(
   if (header_prefix->next_header_offset == 0) return iree_ok_status();
   return iree_io_parse_irpa_index_from_memory(
       file_handle, file_contents,
-      base_offset + header_prefix->next_header_offset, index);
+      base_offset + header_prefix->next_header_offset, index, hashed_ranges);
+}
+
+typedef struct iree_io_irpa_verify_state_t {
+  iree_const_byte_span_t file_contents;
+  const iree_io_irpa_hashed_range_list_t* hashed_ranges;
+} iree_io_irpa_verify_state_t;
+
+// Verifies the contents of the hashed range at |range_index|.
+static iree_status_t iree_io_irpa_verify_hashed_range(
+    void* user_data, iree_host_size_t range_index) {
+  const iree_io_irpa_verify_state_t* state =
+      (const iree_io_irpa_verify_state_t*)user_data;
+  const iree_io_irpa_hashed_range_t* range =
+      &state->hashed_ranges->values[range_index];
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, range->name.data, range->name.size);
+  const uint64_t value = iree_io_xxh64(iree_make_const_byte_span(
+      state->file_contents.data + range->offset,
+      (iree_host_size_t)range->length));
+  iree_status_t status = iree_ok_status();
+  if (value != range->value) {
+    status = iree_make_status(
+        IREE_STATUS_DATA_LOSS,
+        "parameter `%.*s` contents do not match the archive hash (expected "
+        "%016" PRIx64 ", got %016" PRIx64 ")",
+        (int)range->name.size, range->name.data, range->value, value);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 IREE_API_EXPORT iree_status_t iree_io_parse_irpa_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index,
     iree_allocator_t host_allocator) {
+  const iree_io_irpa_parse_options_t options = {
+      .verify_hashes = false,
+      .worker_count = 0,
+  };
+  return iree_io_parse_irpa_index_with_options(file_handle, &options, index,
+                                               host_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parse_irpa_index_with_options(
+    iree_io_file_handle_t* file_handle,
+    const iree_io_irpa_parse_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -336,10 +557,30 @@ IREE_API_EXPORT iree_status_t iree_io_parse_irpa_index(
                                 IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS,
                                 host_allocator, &file_mapping));
 
+  // Hashed ranges are only gathered when verifying.
+  iree_io_irpa_hashed_range_list_t hashed_ranges = {
+      .host_allocator = host_allocator,
+      .count = 0,
+      .capacity = 0,
+      .values = NULL,
+  };
   iree_status_t status = iree_io_parse_irpa_index_from_memory(
       file_handle, iree_io_file_mapping_contents_ro(file_mapping),
-      /*base_offset=*/0, index);
+      /*base_offset=*/0, index,
+      options->verify_hashes ? &hashed_ranges : NULL);
+
+  // Verify the hashed contents in parallel.
+  if (iree_status_is_ok(status) && hashed_ranges.count > 0) {
+    iree_io_irpa_verify_state_t verify_state = {
+        .file_contents = iree_io_file_mapping_contents_ro(file_mapping),
+        .hashed_ranges = &hashed_ranges,
+    };
+    status = iree_io_parallel_for(
+        options->worker_count, hashed_ranges.count,
+        iree_io_irpa_verify_hashed_range, &verify_state, host_allocator);
+  }
 
+  iree_allocator_free(host_allocator, hashed_ranges.values);
   iree_io_file_mapping_release(file_mapping);
 
   IREE_TRACE_ZONE_END(z0);
@@ -23,6 +23,26 @@ IREE_API_EXPORT iree_status_t iree_io_parse_irpa_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index,
     iree_allocator_t host_allocator);
 
+// Options controlling how IRPA files are parsed.
+// Zero-initialize for the defaults.
+typedef struct iree_io_irpa_parse_options_t {
+  // Verifies the stored contents of all entries that have a content hash and
+  // fails with IREE_STATUS_DATA_LOSS if any don't match. This reads the
+  // contents of every hashed parameter and can take significant time for large
+  // archives.
+  bool verify_hashes;
+  // Maximum number of threads used to verify entry contents. 0 or 1 verifies
+  // on the calling thread.
+  iree_host_size_t worker_count;
+} iree_io_irpa_parse_options_t;
+
+// Parses an IREE archive file as with iree_io_parse_irpa_index using the
+// provided |options|.
+IREE_API_EXPORT iree_status_t iree_io_parse_irpa_index_with_options(
+    iree_io_file_handle_t* file_handle,
+    const iree_io_irpa_parse_options_t* options,
+    iree_io_parameter_index_t* index, iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -6,6 +6,11 @@
 
 #include "iree/io/formats/irpa/irpa_parser.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "iree/io/formats/irpa/irpa_builder.h"
+#include "iree/io/formats/irpa/irpa_util.h"
 #include "iree/io/formats/irpa/testdata/irpa_files.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -157,5 +162,258 @@ TEST(IrpaFormatTest, MixedDataAndSplats) {
   iree_io_parameter_index_release(index);
 }
 
+// Allocates archive storage in a host vector when building archives.
+static iree_status_t OpenVectorFile(void* user_data,
+                                    iree_io_physical_offset_t archive_offset,
+                                    iree_io_physical_size_t archive_length,
+                                    iree_io_file_handle_t** out_file_handle) {
+  auto* storage = (std::vector<uint8_t>*)user_data;
+  storage->resize(archive_offset + archive_length);
+  return iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ | IREE_IO_FILE_ACCESS_WRITE,
+      iree_make_byte_span(storage->data(), storage->size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      out_file_handle);
+}
+
+// Builds an archive from |source_index| into |storage| with |options| and
+// parses it back into |out_index|.
+static void BuildAndParse(iree_io_parameter_index_t* source_index,
+                          iree_io_compression_type_t compression_type,
+                          std::vector<uint8_t>* storage,
+                          iree_io_parameter_index_t** out_index,
+                          iree_io_parameter_archive_hash_type_t hash_type =
+                              IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE) {
+  iree_io_parameter_index_t* built_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &built_index));
+  iree_io_parameter_archive_build_options_t options = {};
+  options.compression_type = compression_type;
+  options.compression_block_size = IREE_IO_COMPRESSION_MIN_BLOCK_SIZE;
+  options.hash_type = hash_type;
+  options.worker_count = 4;
+  iree_io_parameter_archive_file_open_callback_t file_open = {};
+  file_open.fn = OpenVectorFile;
+  file_open.user_data = storage;
+  IREE_ASSERT_OK(iree_io_build_parameter_archive_with_options(
+      source_index, built_index, file_open, /*target_file_offset=*/0,
+      &options, iree_allocator_system()));
+  iree_io_parameter_index_release(built_index);
+
+  iree_io_file_handle_t* file_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(storage->data(), storage->size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &file_handle));
+  IREE_ASSERT_OK(iree_io_parameter_index_create(iree_allocator_system(),
+                                                out_index));
+  iree_io_irpa_parse_options_t parse_options = {};
+  parse_options.verify_hashes = true;
+  parse_options.worker_count = 4;
+  IREE_ASSERT_OK(iree_io_parse_irpa_index_with_options(
+      file_handle, &parse_options, *out_index, iree_allocator_system()));
+  iree_io_file_handle_release(file_handle);
+}
+
+// Parses |storage| verifying all entry hashes.
+static iree_status_t ParseVerified(std::vector<uint8_t>* storage) {
+  iree_io_file_handle_t* file_handle = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(storage->data(), storage->size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &file_handle));
+  iree_io_parameter_index_t* index = NULL;
+  iree_status_t status =
+      iree_io_parameter_index_create(iree_allocator_system(), &index);
+  if (iree_status_is_ok(status)) {
+    iree_io_irpa_parse_options_t parse_options = {};
+    parse_options.verify_hashes = true;
+    parse_options.worker_count = 2;
+    status = iree_io_parse_irpa_index_with_options(
+        file_handle, &parse_options, index, iree_allocator_system());
+  }
+  iree_io_parameter_index_release(index);
+  iree_io_file_handle_release(file_handle);
+  return status;
+}
+
+TEST(IrpaFormatTest, CompressedRoundTrip) {
+  // Somewhat compressible data spanning several blocks with a short tail.
+  std::vector<uint8_t> data(IREE_IO_COMPRESSION_MIN_BLOCK_SIZE * 3 + 100);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (uint8_t)((i / 16) * 7 + (i % 5));
+  }
+  iree_io_file_handle_t* data_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ, iree_make_byte_span(data.data(), data.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &data_handle));
+  iree_io_parameter_index_t* source_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &source_index));
+  iree_io_parameter_index_entry_t source_entry = {};
+  source_entry.key = IREE_SV("key0");
+  source_entry.length = data.size();
+  source_entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+  source_entry.storage.file.handle = data_handle;
+  source_entry.storage.file.offset = 0;
+  IREE_ASSERT_OK(iree_io_parameter_index_add(source_index, &source_entry));
+  iree_io_file_handle_release(data_handle);
+
+  // Compress into a new archive.
+  std::vector<uint8_t> compressed_storage;
+  iree_io_parameter_index_t* compressed_index = NULL;
+  BuildAndParse(source_index, IREE_IO_COMPRESSION_TYPE_LZ4,
+                &compressed_storage, &compressed_index);
+  ASSERT_NE(compressed_index, nullptr);
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(compressed_index,
+                                                IREE_SV("key0"), &entry));
+  EXPECT_EQ(entry->type, IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED);
+  EXPECT_EQ(entry->length, data.size());
+  EXPECT_EQ(entry->storage.compressed.blocks.block_count, 4);
+  EXPECT_LT(entry->storage.compressed.length, data.size());
+  std::vector<uint8_t> contents(data.size());
+  IREE_ASSERT_OK(iree_io_compressed_blocks_read(
+      &entry->storage.compressed.blocks,
+      iree_make_const_byte_span(
+          compressed_storage.data() + entry->storage.compressed.offset,
+          entry->storage.compressed.length),
+      /*compressed_data_offset=*/0, 0,
+      iree_make_byte_span(contents.data(), contents.size()),
+      iree_allocator_system()));
+  EXPECT_EQ(contents, data);
+
+  // Decompress back into an uncompressed archive.
+  std::vector<uint8_t> uncompressed_storage;
+  iree_io_parameter_index_t* uncompressed_index = NULL;
+  BuildAndParse(compressed_index, IREE_IO_COMPRESSION_TYPE_NONE,
+                &uncompressed_storage, &uncompressed_index);
+  ASSERT_NE(uncompressed_index, nullptr);
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(uncompressed_index,
+                                                IREE_SV("key0"), &entry));
+  EXPECT_EQ(entry->type, IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE);
+  ASSERT_EQ(entry->length, data.size());
+  EXPECT_EQ(0, memcmp(uncompressed_storage.data() + entry->storage.file.offset,
+                      data.data(), data.size()));
+
+  iree_io_parameter_index_release(uncompressed_index);
+  iree_io_parameter_index_release(compressed_index);
+  iree_io_parameter_index_release(source_index);
+}
+
+TEST(IrpaFormatTest, XXH64) {
+  // Reference values from the xxHash test suite.
+  EXPECT_EQ(iree_io_xxh64(iree_const_byte_span_empty()),
+            0xEF46DB3751D8E999ull);
+  EXPECT_EQ(iree_io_xxh64(iree_make_const_byte_span("a", 1)),
+            0xD24EC4F1A98C6E5Bull);
+  EXPECT_EQ(iree_io_xxh64(iree_make_const_byte_span("abc", 3)),
+            0x44BC2CF5AD770999ull);
+
+  // Hashing in pieces must match hashing all at once.
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = (uint8_t)(i * 31 + 7);
+  const uint64_t expected =
+      iree_io_xxh64(iree_make_const_byte_span(data.data(), data.size()));
+  for (size_t piece_size : {1, 3, 31, 32, 33, 100}) {
+    iree_io_xxh64_state_t state;
+    iree_io_xxh64_initialize(/*seed=*/0, &state);
+    for (size_t i = 0; i < data.size(); i += piece_size) {
+      const size_t length = std::min(piece_size, data.size() - i);
+      iree_io_xxh64_update(&state,
+                           iree_make_const_byte_span(&data[i], length));
+    }
+    EXPECT_EQ(iree_io_xxh64_finalize(&state), expected);
+  }
+}
+
+TEST(IrpaFormatTest, HashedRoundTrip) {
+  // Several parameters so that workers each get some.
+  std::vector<std::vector<uint8_t>> datas(6);
+  for (size_t i = 0; i < datas.size(); ++i) {
+    datas[i].resize(IREE_IO_COMPRESSION_MIN_BLOCK_SIZE + i * 1000);
+    for (size_t j = 0; j < datas[i].size(); ++j) {
+      datas[i][j] = (uint8_t)((j / 8) * (i + 3) + j % 3);
+    }
+  }
+  iree_io_parameter_index_t* source_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &source_index));
+  const char* keys[] = {"key0", "key1", "key2", "key3", "key4", "key5"};
+  for (size_t i = 0; i < datas.size(); ++i) {
+    iree_io_file_handle_t* data_handle = NULL;
+    IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ,
+        iree_make_byte_span(datas[i].data(), datas[i].size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        &data_handle));
+    iree_io_parameter_index_entry_t source_entry = {};
+    source_entry.key = iree_make_cstring_view(keys[i]);
+    source_entry.length = datas[i].size();
+    source_entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+    source_entry.storage.file.handle = data_handle;
+    source_entry.storage.file.offset = 0;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(source_index, &source_entry));
+    iree_io_file_handle_release(data_handle);
+  }
+
+  for (iree_io_compression_type_t compression_type :
+       {IREE_IO_COMPRESSION_TYPE_NONE, IREE_IO_COMPRESSION_TYPE_LZ4}) {
+    std::vector<uint8_t> storage;
+    iree_io_parameter_index_t* index = NULL;
+    BuildAndParse(source_index, compression_type, &storage, &index,
+                  IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64);
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(iree_io_parameter_index_count(index), datas.size());
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    for (size_t i = 0; i < datas.size(); ++i) {
+      IREE_ASSERT_OK(iree_io_parameter_index_lookup(
+          index, iree_make_cstring_view(keys[i]), &entry));
+      ASSERT_EQ(entry->length, datas[i].size());
+      std::vector<uint8_t> contents(datas[i].size());
+      if (entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+        memcpy(contents.data(), storage.data() + entry->storage.file.offset,
+               contents.size());
+      } else {
+        IREE_ASSERT_OK(iree_io_compressed_blocks_read(
+            &entry->storage.compressed.blocks,
+            iree_make_const_byte_span(
+                storage.data() + entry->storage.compressed.offset,
+                entry->storage.compressed.length),
+            /*compressed_data_offset=*/0, 0,
+            iree_make_byte_span(contents.data(), contents.size()),
+            iree_allocator_system()));
+      }
+      EXPECT_EQ(contents, datas[i]);
+    }
+
+    // Corrupting the stored contents of any entry must fail verification.
+    IREE_ASSERT_OK(iree_io_parameter_index_lookup(index, IREE_SV("key3"),
+                                                  &entry));
+    const uint64_t corrupt_offset =
+        entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE
+            ? entry->storage.file.offset
+            : entry->storage.compressed.offset;
+    iree_io_parameter_index_release(index);
+    storage[corrupt_offset + 10] ^= 0x01;
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS,
+                          Status(ParseVerified(&storage)));
+    storage[corrupt_offset + 10] ^= 0x01;
+    IREE_EXPECT_OK(Status(ParseVerified(&storage)));
+  }
+
+  // Archives without hashes parse when verifying.
+  std::vector<uint8_t> storage;
+  iree_io_parameter_index_t* index = NULL;
+  BuildAndParse(source_index, IREE_IO_COMPRESSION_TYPE_NONE, &storage, &index);
+  ASSERT_NE(index, nullptr);
+  iree_io_parameter_index_release(index);
+
+  iree_io_parameter_index_release(source_index);
+}
+
 }  // namespace
 }  // namespace iree
@@ -0,0 +1,176 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/formats/irpa/irpa_util.h"
+
+#include "iree/base/internal/math.h"
+
+//===----------------------------------------------------------------------===//
+// Entry content hashing
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_hash_type_parse(
+    iree_string_view_t value, iree_io_parameter_archive_hash_type_t* out_type) {
+  IREE_ASSERT_ARGUMENT(out_type);
+  if (iree_string_view_is_empty(value) ||
+      iree_string_view_equal(value, IREE_SV("none"))) {
+    *out_type = IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE;
+  } else if (iree_string_view_equal(value, IREE_SV("xxh64"))) {
+    *out_type = IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unknown hash type `%.*s`; expected `none` or "
+                            "`xxh64`",
+                            (int)value.size, value.data);
+  }
+  return iree_ok_status();
+}
+
+// XXH64 as specified in
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+#define IREE_IO_XXH64_PRIME_1 0x9E3779B185EBCA87ull
+#define IREE_IO_XXH64_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define IREE_IO_XXH64_PRIME_3 0x165667B19E3779F9ull
+#define IREE_IO_XXH64_PRIME_4 0x85EBCA77C2B2CA63ull
+#define IREE_IO_XXH64_PRIME_5 0x27D4EB2F165667C5ull
+
+static inline uint64_t iree_io_xxh64_load_u64(const uint8_t* ptr) {
+  uint64_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static inline uint32_t iree_io_xxh64_load_u32(const uint8_t* ptr) {
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static inline uint64_t iree_io_xxh64_round(uint64_t lane, uint64_t input) {
+  lane += input * IREE_IO_XXH64_PRIME_2;
+  lane = iree_math_rotl_u64(lane, 31);
+  return lane * IREE_IO_XXH64_PRIME_1;
+}
+
+static inline uint64_t iree_io_xxh64_merge_round(uint64_t hash, uint64_t lane) {
+  hash ^= iree_io_xxh64_round(0, lane);
+  return hash * IREE_IO_XXH64_PRIME_1 + IREE_IO_XXH64_PRIME_4;
+}
+
+// Adds each whole 32 byte stripe in |data| to |lanes| and returns the number
+// of bytes consumed.
+static iree_host_size_t iree_io_xxh64_consume_stripes(
+    uint64_t lanes[4], const uint8_t* data, iree_host_size_t length) {
+  uint64_t lane0 = lanes[0], lane1 = lanes[1];
+  uint64_t lane2 = lanes[2], lane3 = lanes[3];
+  const uint8_t* ptr = data;
+  const uint8_t* limit = data + (length & ~(iree_host_size_t)31);
+  for (; ptr < limit; ptr += 32) {
+    lane0 = iree_io_xxh64_round(lane0, iree_io_xxh64_load_u64(ptr + 0));
+    lane1 = iree_io_xxh64_round(lane1, iree_io_xxh64_load_u64(ptr + 8));
+    lane2 = iree_io_xxh64_round(lane2, iree_io_xxh64_load_u64(ptr + 16));
+    lane3 = iree_io_xxh64_round(lane3, iree_io_xxh64_load_u64(ptr + 24));
+  }
+  lanes[0] = lane0;
+  lanes[1] = lane1;
+  lanes[2] = lane2;
+  lanes[3] = lane3;
+  return (iree_host_size_t)(ptr - data);
+}
+
+IREE_API_EXPORT void iree_io_xxh64_initialize(
+    uint64_t seed, iree_io_xxh64_state_t* out_state) {
+  IREE_ASSERT_ARGUMENT(out_state);
+  memset(out_state, 0, sizeof(*out_state));
+  out_state->lanes[0] = seed + IREE_IO_XXH64_PRIME_1 + IREE_IO_XXH64_PRIME_2;
+  out_state->lanes[1] = seed + IREE_IO_XXH64_PRIME_2;
+  out_state->lanes[2] = seed;
+  out_state->lanes[3] = seed - IREE_IO_XXH64_PRIME_1;
+}
+
+IREE_API_EXPORT void iree_io_xxh64_update(iree_io_xxh64_state_t* state,
+                                          iree_const_byte_span_t data) {
+  IREE_ASSERT_ARGUMENT(state);
+  if (data.data_length == 0) return;
+  const uint8_t* ptr = data.data;
+  iree_host_size_t remaining = data.data_length;
+  state->total_length += remaining;
+
+  // Complete any partial stripe from a prior update.
+  if (state->buffer_length > 0) {
+    const iree_host_size_t fill_length =
+        iree_min(remaining, sizeof(state->buffer) - state->buffer_length);
+    memcpy(state->buffer + state->buffer_length, ptr, fill_length);
+    state->buffer_length += (uint32_t)fill_length;
+    ptr += fill_length;
+    remaining -= fill_length;
+    if (state->buffer_length < sizeof(state->buffer)) return;
+    iree_io_xxh64_consume_stripes(state->lanes, state->buffer,
+                                  sizeof(state->buffer));
+    state->buffer_length = 0;
+  }
+
+  // Consume whole stripes directly from the input and buffer the rest.
+  const iree_host_size_t consumed_length =
+      iree_io_xxh64_consume_stripes(state->lanes, ptr, remaining);
+  ptr += consumed_length;
+  remaining -= consumed_length;
+  memcpy(state->buffer, ptr, remaining);
+  state->buffer_length = (uint32_t)remaining;
+}
+
+IREE_API_EXPORT uint64_t
+iree_io_xxh64_finalize(const iree_io_xxh64_state_t* state) {
+  IREE_ASSERT_ARGUMENT(state);
+  uint64_t hash = 0;
+  if (state->total_length >= 32) {
+    hash = iree_math_rotl_u64(state->lanes[0], 1) +
+           iree_math_rotl_u64(state->lanes[1], 7) +
+           iree_math_rotl_u64(state->lanes[2], 12) +
+           iree_math_rotl_u64(state->lanes[3], 18);
+    for (int i = 0; i < 4; ++i) {
+      hash = iree_io_xxh64_merge_round(hash, state->lanes[i]);
+    }
+  } else {
+    // lanes[2] holds the seed until a stripe has been consumed.
+    hash = state->lanes[2] + IREE_IO_XXH64_PRIME_5;
+  }
+  hash += state->total_length;
+
+  // Mix in the remaining bytes of the last partial stripe.
+  const uint8_t* ptr = state->buffer;
+  const uint8_t* end = state->buffer + state->buffer_length;
+  for (; ptr + 8 <= end; ptr += 8) {
+    hash ^= iree_io_xxh64_round(0, iree_io_xxh64_load_u64(ptr));
+    hash = iree_math_rotl_u64(hash, 27) * IREE_IO_XXH64_PRIME_1 +
+           IREE_IO_XXH64_PRIME_4;
+  }
+  if (ptr + 4 <= end) {
+    hash ^= (uint64_t)iree_io_xxh64_load_u32(ptr) * IREE_IO_XXH64_PRIME_1;
+    hash = iree_math_rotl_u64(hash, 23) * IREE_IO_XXH64_PRIME_2 +
+           IREE_IO_XXH64_PRIME_3;
+    ptr += 4;
+  }
+  for (; ptr < end; ++ptr) {
+    hash ^= (uint64_t)(*ptr) * IREE_IO_XXH64_PRIME_5;
+    hash = iree_math_rotl_u64(hash, 11) * IREE_IO_XXH64_PRIME_1;
+  }
+
+  // Avalanche.
+  hash ^= hash >> 33;
+  hash *= IREE_IO_XXH64_PRIME_2;
+  hash ^= hash >> 29;
+  hash *= IREE_IO_XXH64_PRIME_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+IREE_API_EXPORT uint64_t iree_io_xxh64(iree_const_byte_span_t data) {
+  iree_io_xxh64_state_t state;
+  iree_io_xxh64_initialize(/*seed=*/0, &state);
+  iree_io_xxh64_update(&state, data);
+  return iree_io_xxh64_finalize(&state);
+}
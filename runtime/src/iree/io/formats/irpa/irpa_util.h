@@ -0,0 +1,57 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_FORMATS_IRPA_IRPA_UTIL_H_
+#define IREE_IO_FORMATS_IRPA_IRPA_UTIL_H_
+
+#include "iree/base/api.h"
+#include "iree/schemas/parameter_archive.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Entry content hashing
+//===----------------------------------------------------------------------===//
+
+// Parses a hash type name (`none` or `xxh64`).
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_hash_type_parse(
+    iree_string_view_t value, iree_io_parameter_archive_hash_type_t* out_type);
+
+// Streaming XXH64 state. Contents may be hashed in pieces of any size and
+// produce the same result as hashing them all at once.
+typedef struct iree_io_xxh64_state_t {
+  // Total number of bytes hashed.
+  uint64_t total_length;
+  // Accumulator lanes for each 32 byte stripe.
+  uint64_t lanes[4];
+  // Bytes of a partial stripe not yet added to the lanes.
+  uint8_t buffer[32];
+  uint32_t buffer_length;
+} iree_io_xxh64_state_t;
+
+// Initializes |out_state| to hash with the given |seed|.
+IREE_API_EXPORT void iree_io_xxh64_initialize(uint64_t seed,
+                                              iree_io_xxh64_state_t* out_state);
+
+// Adds |data| to the hash in |state|.
+IREE_API_EXPORT void iree_io_xxh64_update(iree_io_xxh64_state_t* state,
+                                          iree_const_byte_span_t data);
+
+// Returns the hash of all data added to |state|. The state is not modified and
+// more data may be added after.
+IREE_API_EXPORT uint64_t
+iree_io_xxh64_finalize(const iree_io_xxh64_state_t* state);
+
+// Returns the XXH64 hash of |data| with a seed of 0.
+IREE_API_EXPORT uint64_t iree_io_xxh64(iree_const_byte_span_t data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_FORMATS_IRPA_IRPA_UTIL_H_
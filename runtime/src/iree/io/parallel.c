@@ -0,0 +1,103 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parallel.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/threading.h"
+
+typedef struct iree_io_parallel_state_t {
+  iree_io_parallel_work_fn_t fn;
+  void* user_data;
+  iree_host_size_t item_count;
+  // Index of the next item to hand out.
+  iree_atomic_int64_t next_index;
+  // Set when any worker fails so that the others stop early.
+  iree_atomic_int32_t failed;
+} iree_io_parallel_state_t;
+
+typedef struct iree_io_parallel_worker_t {
+  iree_io_parallel_state_t* state;
+  iree_thread_t* thread;
+  iree_status_t status;
+} iree_io_parallel_worker_t;
+
+static iree_status_t iree_io_parallel_run(iree_io_parallel_state_t* state) {
+  iree_status_t status = iree_ok_status();
+  while (!iree_atomic_load(&state->failed, iree_memory_order_relaxed)) {
+    const int64_t item_index =
+        iree_atomic_fetch_add(&state->next_index, 1, iree_memory_order_relaxed);
+    if (item_index >= (int64_t)state->item_count) break;
+    status = state->fn(state->user_data, (iree_host_size_t)item_index);
+    if (!iree_status_is_ok(status)) {
+      iree_atomic_store(&state->failed, 1, iree_memory_order_relaxed);
+      break;
+    }
+  }
+  return status;
+}
+
+static int iree_io_parallel_worker_main(void* entry_arg) {
+  iree_io_parallel_worker_t* worker = (iree_io_parallel_worker_t*)entry_arg;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  worker->status = iree_io_parallel_run(worker->state);
+  IREE_TRACE_ZONE_END(z0);
+  return 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parallel_for(
+    iree_host_size_t worker_count, iree_host_size_t item_count,
+    iree_io_parallel_work_fn_t fn, void* user_data,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(fn);
+  if (item_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, item_count);
+
+  iree_io_parallel_state_t state = {
+      .fn = fn,
+      .user_data = user_data,
+      .item_count = item_count,
+  };
+  iree_atomic_store(&state.next_index, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&state.failed, 0, iree_memory_order_relaxed);
+
+  // The calling thread acts as one of the workers.
+  const iree_host_size_t thread_count =
+      iree_min(iree_max(worker_count, 1), item_count) - 1;
+  iree_io_parallel_worker_t* workers = NULL;
+  if (thread_count > 0 &&
+      iree_status_is_ok(iree_allocator_malloc(host_allocator,
+                                              thread_count * sizeof(workers[0]),
+                                              (void**)&workers))) {
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = IREE_SV("iree-io-worker");
+    for (iree_host_size_t i = 0; i < thread_count; ++i) {
+      workers[i].state = &state;
+      workers[i].status = iree_ok_status();
+      // Failing to create a thread (or threads being unavailable) only reduces
+      // parallelism as the remaining workers pick up the items.
+      iree_status_ignore(iree_thread_create(iree_io_parallel_worker_main,
+                                            &workers[i], params, host_allocator,
+                                            &workers[i].thread));
+    }
+  }
+
+  iree_status_t status = iree_io_parallel_run(&state);
+
+  // Releasing the threads joins them. Only the first failure is kept.
+  for (iree_host_size_t i = 0; workers && i < thread_count; ++i) {
+    iree_thread_release(workers[i].thread);
+    status = iree_status_join(status, workers[i].status);
+  }
+  iree_allocator_free(host_allocator, workers);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,36 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARALLEL_H_
+#define IREE_IO_PARALLEL_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Processes the item at |item_index|. May be called from any thread.
+typedef iree_status_t(IREE_API_PTR* iree_io_parallel_work_fn_t)(
+    void* user_data, iree_host_size_t item_index);
+
+// Calls |fn| once for each item in [0, |item_count|) using up to
+// |worker_count| threads (including the calling thread). Items are handed out
+// in order as workers become available. Processing stops at the first failure
+// and the failing status is returned once all workers have finished.
+//
+// If threads are unavailable on the platform all items are processed on the
+// calling thread.
+IREE_API_EXPORT iree_status_t iree_io_parallel_for(
+    iree_host_size_t worker_count, iree_host_size_t item_count,
+    iree_io_parallel_work_fn_t fn, void* user_data,
+    iree_allocator_t host_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARALLEL_H_
@@ -7,8 +7,12 @@
 #include "iree/io/parameter_index.h"
 
 #include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
 #include "iree/base/internal/synchronization.h"
 
+// Sentinel used for unused hash table slots.
+#define IREE_IO_PARAMETER_INDEX_EMPTY_SLOT UINT32_MAX
+
 struct iree_io_parameter_index_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t host_allocator;
@@ -23,10 +27,72 @@ struct iree_io_parameter_index_t {
   // Currently used entry count in elements.
   iree_host_size_t entry_count;
   // Dense list of entries in the index. Grows as needed.
+  // Entries are kept in insertion order for enumeration.
   iree_io_parameter_index_entry_t** entries;
+
+  // Open-addressed (linear probing) hash table mapping entry keys to their
+  // ordinal in |entries|. Unused slots are IREE_IO_PARAMETER_INDEX_EMPTY_SLOT.
+  // Capacity is a power of two kept at least twice the entry capacity so that
+  // the load factor never exceeds 0.5 and probe sequences stay short.
+  iree_host_size_t slot_capacity;
+  uint32_t* slots;
+
+  // Populator run on the first query of a lazily-created index. Unused (NULL
+  // fn) when the index was created eagerly.
+  iree_io_parameter_index_populator_t populator;
+  // Held while the populator runs so that concurrent queries wait for it.
+  // Separate from |mutex| as the populator adds entries.
+  iree_slim_mutex_t populate_mutex;
+  // Set (with release semantics) once population has completed, successfully
+  // or not. Always set for eagerly-created indices.
+  iree_atomic_int32_t populated;
+  // Failure from the populator, if any. Immutable once |populated| is set.
+  iree_status_t populate_status;
 };
 
-IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
+// FNV-1a hash of |key|.
+static uint64_t iree_io_parameter_index_hash_key(iree_string_view_t key) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < key.size; ++i) {
+    hash ^= (uint8_t)key.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Inserts the entry at |ordinal| into the hash table. Duplicate keys are
+// inserted after existing ones so lookups return the first added.
+static void iree_io_parameter_index_insert_slot_unsafe(
+    iree_io_parameter_index_t* index, uint32_t ordinal) {
+  const iree_host_size_t slot_mask = index->slot_capacity - 1;
+  iree_host_size_t slot = (iree_host_size_t)iree_io_parameter_index_hash_key(
+                              index->entries[ordinal]->key) &
+                          slot_mask;
+  while (index->slots[slot] != IREE_IO_PARAMETER_INDEX_EMPTY_SLOT) {
+    slot = (slot + 1) & slot_mask;
+  }
+  index->slots[slot] = ordinal;
+}
+
+// Finds the first entry with |key| or returns NULL if not present.
+static iree_io_parameter_index_entry_t* iree_io_parameter_index_find_unsafe(
+    iree_io_parameter_index_t* index, iree_string_view_t key) {
+  if (!index->slot_capacity) return NULL;
+  const iree_host_size_t slot_mask = index->slot_capacity - 1;
+  iree_host_size_t slot =
+      (iree_host_size_t)iree_io_parameter_index_hash_key(key) & slot_mask;
+  uint32_t ordinal = 0;
+  while ((ordinal = index->slots[slot]) !=
+         IREE_IO_PARAMETER_INDEX_EMPTY_SLOT) {
+    iree_io_parameter_index_entry_t* entry = index->entries[ordinal];
+    if (iree_string_view_equal(key, entry->key)) return entry;
+    slot = (slot + 1) & slot_mask;
+  }
+  return NULL;
+}
+
+static iree_status_t iree_io_parameter_index_create_with_populator(
+    iree_io_parameter_index_populator_t populator,
     iree_allocator_t host_allocator, iree_io_parameter_index_t** out_index) {
   IREE_ASSERT_ARGUMENT(out_index);
   *out_index = NULL;
@@ -46,12 +112,57 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
   index->entry_capacity = 0;
   index->entry_count = 0;
   index->entries = NULL;
+  index->slot_capacity = 0;
+  index->slots = NULL;
+
+  index->populator = populator;
+  iree_slim_mutex_initialize(&index->populate_mutex);
+  iree_atomic_store(&index->populated, populator.fn ? 0 : 1,
+                    iree_memory_order_release);
+  index->populate_status = iree_ok_status();
 
   *out_index = index;
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
+    iree_allocator_t host_allocator, iree_io_parameter_index_t** out_index) {
+  iree_io_parameter_index_populator_t populator = {0};
+  return iree_io_parameter_index_create_with_populator(
+      populator, host_allocator, out_index);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_create_lazy(
+    iree_io_parameter_index_populator_t populator,
+    iree_allocator_t host_allocator, iree_io_parameter_index_t** out_index) {
+  IREE_ASSERT_ARGUMENT(populator.fn);
+  return iree_io_parameter_index_create_with_populator(
+      populator, host_allocator, out_index);
+}
+
+// Runs the populator of a lazily-created index if it has not yet run and
+// returns its result. Cheap once population has completed.
+static iree_status_t iree_io_parameter_index_ensure_populated(
+    iree_io_parameter_index_t* index) {
+  if (IREE_UNLIKELY(
+          !iree_atomic_load(&index->populated, iree_memory_order_acquire))) {
+    iree_slim_mutex_lock(&index->populate_mutex);
+    if (!iree_atomic_load(&index->populated, iree_memory_order_acquire)) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_io_parameter_index_populate");
+      index->populate_status =
+          index->populator.fn(index->populator.user_data, index);
+      iree_atomic_store(&index->populated, 1, iree_memory_order_release);
+      IREE_TRACE_ZONE_END(z0);
+    }
+    iree_slim_mutex_unlock(&index->populate_mutex);
+  }
+  if (IREE_LIKELY(iree_status_is_ok(index->populate_status))) {
+    return iree_ok_status();
+  }
+  return iree_status_clone(index->populate_status);
+}
+
 static void iree_io_parameter_index_destroy(iree_io_parameter_index_t* index) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -65,15 +176,30 @@ static void iree_io_parameter_index_destroy(iree_io_parameter_index_t* index) {
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
         iree_io_file_handle_release(entry->storage.file.handle);
         break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+        iree_io_file_handle_release(entry->storage.compressed.handle);
+        break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM:
+        iree_io_file_handle_release(entry->storage.transform.handle);
+        break;
     }
     iree_allocator_free(host_allocator, entry);
   }
   if (index->entries) {
     iree_allocator_free(host_allocator, index->entries);
   }
+  if (index->slots) {
+    iree_allocator_free(host_allocator, index->slots);
+  }
 
   iree_slim_mutex_deinitialize(&index->mutex);
 
+  if (index->populator.release) {
+    index->populator.release(index->populator.user_data);
+  }
+  iree_status_ignore(index->populate_status);
+  iree_slim_mutex_deinitialize(&index->populate_mutex);
+
   iree_allocator_free(host_allocator, index);
 
   IREE_TRACE_ZONE_END(z0);
@@ -96,28 +222,74 @@ IREE_API_EXPORT void iree_io_parameter_index_release(
 IREE_API_EXPORT iree_host_size_t
 iree_io_parameter_index_count(iree_io_parameter_index_t* index) {
   IREE_ASSERT_ARGUMENT(index);
+  iree_status_t status = iree_io_parameter_index_ensure_populated(index);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return 0;
+  }
   iree_slim_mutex_lock(&index->mutex);
   iree_host_size_t count = index->entry_count;
   iree_slim_mutex_unlock(&index->mutex);
   return count;
 }
 
+IREE_API_EXPORT bool iree_io_parameter_index_is_populated(
+    iree_io_parameter_index_t* index) {
+  IREE_ASSERT_ARGUMENT(index);
+  return iree_atomic_load(&index->populated, iree_memory_order_acquire) != 0;
+}
+
 static iree_status_t iree_io_parameter_index_reserve_unsafe(
     iree_io_parameter_index_t* index, iree_host_size_t new_capacity) {
   IREE_ASSERT_ARGUMENT(index);
-  if (new_capacity < index->entry_capacity) return iree_ok_status();
+  if (new_capacity <= index->entry_capacity) return iree_ok_status();
+  if (new_capacity >= IREE_IO_PARAMETER_INDEX_EMPTY_SLOT / 2) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "parameter index capacity %" PRIhsz
+                            " exceeds the maximum supported",
+                            new_capacity);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, new_capacity);
 
+  // Allocate a hash table sized for the new capacity first so that we never
+  // end up with more entry capacity than the table can hold.
+  const iree_host_size_t new_slot_capacity =
+      (iree_host_size_t)iree_math_round_up_to_pow2_u64(
+          iree_max(1, new_capacity * 2));
+  uint32_t* new_slots = NULL;
+  iree_status_t status = iree_ok_status();
+  if (new_slot_capacity > index->slot_capacity) {
+    status = iree_allocator_malloc_uninitialized(
+        index->host_allocator, new_slot_capacity * sizeof(new_slots[0]),
+        (void**)&new_slots);
+  }
+
   iree_io_parameter_index_entry_t** new_entries = index->entries;
-  iree_status_t status = iree_allocator_realloc(
-      index->host_allocator, new_capacity * sizeof(index->entries[0]),
-      (void**)&new_entries);
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_realloc(index->host_allocator,
+                                    new_capacity * sizeof(index->entries[0]),
+                                    (void**)&new_entries);
+  }
   if (iree_status_is_ok(status)) {
     index->entry_capacity = new_capacity;
     index->entries = new_entries;
   }
 
+  // Rehash all existing entries into the new table. Entries are reinserted in
+  // order so duplicate keys keep resolving to the first one added.
+  if (iree_status_is_ok(status) && new_slots) {
+    memset(new_slots, 0xFF, new_slot_capacity * sizeof(new_slots[0]));
+    iree_allocator_free(index->host_allocator, index->slots);
+    index->slot_capacity = new_slot_capacity;
+    index->slots = new_slots;
+    for (iree_host_size_t i = 0; i < index->entry_count; ++i) {
+      iree_io_parameter_index_insert_slot_unsafe(index, (uint32_t)i);
+    }
+  } else {
+    iree_allocator_free(index->host_allocator, new_slots);
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -151,10 +323,35 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
   // Clone the entry memory. We allocate it as a single slab and stash the
   // pointers for easier access by callers. Entries themselves are never
   // reallocated so the pointers are safe to embed.
+  // Compressed entries also carry their block offset table which we store
+  // (aligned) after the key and metadata.
   iree_io_parameter_index_entry_t* cloned_entry = NULL;
+  const iree_host_size_t string_size =
+      sizeof(*cloned_entry) + entry->key.size + entry->metadata.data_length;
+  iree_host_size_t block_table_size = 0;
+  if (iree_status_is_ok(status) &&
+      entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+    if (entry->storage.compressed.blocks.length != entry->length) {
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "compressed entry block length %" PRIu64
+          " does not match entry length %" PRIu64,
+          entry->storage.compressed.blocks.length, entry->length);
+    }
+    block_table_size =
+        (entry->storage.compressed.blocks.block_count + 1) * sizeof(uint64_t);
+  }
+  if (iree_status_is_ok(status) &&
+      entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM &&
+      !entry->storage.transform.fn) {
+    status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "transform entry has no transform function");
+  }
+  const iree_host_size_t block_table_offset =
+      iree_host_align(string_size, iree_alignof(uint64_t));
   if (iree_status_is_ok(status)) {
     iree_host_size_t total_size =
-        sizeof(*cloned_entry) + entry->key.size + entry->metadata.data_length;
+        block_table_size ? block_table_offset + block_table_size : string_size;
     status = iree_allocator_malloc(index->host_allocator, total_size,
                                    (void**)&cloned_entry);
   }
@@ -179,13 +376,31 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
         cloned_entry->storage.file = entry->storage.file;
         iree_io_file_handle_retain(cloned_entry->storage.file.handle);
         break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED: {
+        cloned_entry->storage.compressed = entry->storage.compressed;
+        uint64_t* block_offsets =
+            (uint64_t*)((uint8_t*)cloned_entry + block_table_offset);
+        memcpy(block_offsets, entry->storage.compressed.blocks.block_offsets,
+               block_table_size);
+        cloned_entry->storage.compressed.blocks.block_offsets = block_offsets;
+        iree_io_file_handle_retain(cloned_entry->storage.compressed.handle);
+        break;
+      }
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM:
+        cloned_entry->storage.transform = entry->storage.transform;
+        iree_io_file_handle_retain(cloned_entry->storage.transform.handle);
+        break;
     }
     memcpy((void*)cloned_entry->key.data, entry->key.data, entry->key.size);
-    memcpy((void*)cloned_entry->metadata.data, entry->metadata.data,
-           entry->metadata.data_length);
+    if (entry->metadata.data_length > 0) {
+      memcpy((void*)cloned_entry->metadata.data, entry->metadata.data,
+             entry->metadata.data_length);
+    }
 
     // Append the entry to the file index.
-    index->entries[index->entry_count++] = cloned_entry;
+    const uint32_t ordinal = (uint32_t)index->entry_count++;
+    index->entries[ordinal] = cloned_entry;
+    iree_io_parameter_index_insert_slot_unsafe(index, ordinal);
   }
 
   iree_slim_mutex_unlock(&index->mutex);
@@ -199,6 +414,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_get(
   IREE_ASSERT_ARGUMENT(index);
   IREE_ASSERT_ARGUMENT(out_entry);
   *out_entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_ensure_populated(index));
   iree_slim_mutex_lock(&index->mutex);
 
   iree_status_t status = iree_ok_status();
@@ -223,16 +439,12 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
   *out_entry = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, key.data, key.size);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_index_ensure_populated(index));
   iree_slim_mutex_lock(&index->mutex);
 
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < index->entry_count; ++i) {
-    const iree_io_parameter_index_entry_t* entry = index->entries[i];
-    if (iree_string_view_equal(key, entry->key)) {
-      *out_entry = entry;
-      break;
-    }
-  }
+  *out_entry = iree_io_parameter_index_find_unsafe(index, key);
   if (*out_entry == NULL) {
     status = iree_make_status(IREE_STATUS_NOT_FOUND,
                               "no parameter found in index with key '%.*s'",
@@ -247,6 +459,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_dump(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_string_builder_t* builder) {
+  IREE_RETURN_IF_ERROR(iree_io_parameter_index_ensure_populated(index));
   iree_host_size_t entry_count = iree_io_parameter_index_count(index);
   uint64_t total_bytes = 0;
   for (iree_host_size_t i = 0; i < entry_count; ++i) {
@@ -301,6 +514,31 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_dump(
             (int)entry->key.size, entry->key.data));
         break;
       }
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED: {
+        iree_string_view_t type_name = iree_io_compression_type_name(
+            entry->storage.compressed.blocks.type);
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+            builder,
+            "%16" PRIu64 " | %16" PRIu64 " | %16" PRIu64
+            " | `%.*s` (%.*s, %" PRIu64 " bytes)\n",
+            entry->storage.compressed.offset,
+            entry->storage.compressed.offset + entry->storage.compressed.length,
+            entry->length, (int)entry->key.size, entry->key.data,
+            (int)type_name.size, type_name.data,
+            entry->storage.compressed.length));
+        break;
+      }
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM: {
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+            builder,
+            "%16" PRIu64 " | %16" PRIu64 " | %16" PRIu64
+            " | `%.*s` (transformed from %" PRIu64 " bytes)\n",
+            entry->storage.transform.offset,
+            entry->storage.transform.offset + entry->storage.transform.length,
+            entry->length, (int)entry->key.size, entry->key.data,
+            entry->storage.transform.length));
+        break;
+      }
       default: {
         IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
             builder,
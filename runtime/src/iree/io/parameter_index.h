@@ -8,6 +8,7 @@
 #define IREE_IO_PARAMETER_INDEX_H_
 
 #include "iree/base/api.h"
+#include "iree/io/compression.h"
 #include "iree/io/file_handle.h"
 
 #ifdef __cplusplus
@@ -23,8 +24,27 @@ typedef enum iree_io_parameter_index_entry_storage_type_e {
   // Parameter is backed by a range of bytes within a file. Access rights are
   // inherited from the file handle.
   IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE,
+  // Parameter is backed by a range of bytes within a file containing the
+  // parameter contents as a sequence of independently compressed blocks.
+  // Read-only; loads decompress into the target buffer.
+  IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED,
+  // Parameter contents are produced on demand by a transform function from a
+  // range of bytes within a file (repacking, dequantization, etc).
+  // Read-only; loads run the transform into the target buffer.
+  IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM,
 } iree_io_parameter_index_entry_storage_type_t;
 
+// Produces the transformed parameter contents in the range
+// [offset, offset + target.data_length) into |target| from the entire
+// |source| storage of the parameter. |params| are the values the entry was
+// declared with.
+//
+// Transforms may be called concurrently from multiple threads on disjoint
+// ranges of the same parameter and must not retain |source| or |target|.
+typedef iree_status_t(IREE_API_PTR* iree_io_parameter_transform_fn_t)(
+    const uint64_t params[4], iree_const_byte_span_t source, uint64_t offset,
+    iree_byte_span_t target);
+
 // Power of two; enough bytes to fit complex128 (complex<f64>).
 // Prefer 1, 2, and 4 byte patterns as they can often hit hardware accelerated
 // fast paths while 8 and 16 may require emulation.
@@ -64,6 +84,39 @@ typedef struct iree_io_parameter_index_entry_t {
       // Offset of the entry in bytes relative to the base file offset.
       uint64_t offset;
     } file;
+    // Describes a file-backed parameter stored as compressed blocks.
+    // Valid when type is IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED.
+    struct {
+      // File handle backing this entry, retained.
+      iree_io_file_handle_t* handle;
+      // Offset of the compressed data in bytes relative to the base file
+      // offset.
+      uint64_t offset;
+      // Total length of the compressed data in bytes.
+      uint64_t length;
+      // Block layout of the compressed data. The block offset table is copied
+      // into the index when the entry is added. |blocks.length| must match the
+      // entry length.
+      iree_io_compressed_blocks_t blocks;
+    } compressed;
+    // Describes a parameter produced by transforming file-backed data.
+    // Valid when type is IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM.
+    struct {
+      // File handle backing this entry, retained.
+      iree_io_file_handle_t* handle;
+      // Offset of the source data in bytes relative to the base file offset.
+      uint64_t offset;
+      // Total length of the source data in bytes.
+      uint64_t length;
+      // Function producing the parameter contents from the source data.
+      iree_io_parameter_transform_fn_t fn;
+      // Transform-defined parameters passed to |fn|.
+      uint64_t params[4];
+      // Granularity in bytes at which ranges of the parameter contents are
+      // cheapest to produce independently (such as one packed row panel).
+      // Callers splitting work try to align ranges to it. 0 if unknown.
+      uint64_t chunk_size;
+    } transform;
   } storage;
 } iree_io_parameter_index_entry_t;
 
@@ -81,6 +134,40 @@ typedef struct iree_io_parameter_index_t iree_io_parameter_index_t;
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_create(
     iree_allocator_t host_allocator, iree_io_parameter_index_t** out_index);
 
+// Populates |index| with its initial entries by calling
+// iree_io_parameter_index_reserve and iree_io_parameter_index_add. Populators
+// must not query the index (count/get/lookup/etc) as that would wait for the
+// population already in progress.
+typedef iree_status_t(IREE_API_PTR* iree_io_parameter_index_populate_fn_t)(
+    void* user_data, iree_io_parameter_index_t* index);
+
+// Releases the populator |user_data| when the index is destroyed.
+typedef void(IREE_API_PTR* iree_io_parameter_index_populator_release_fn_t)(
+    void* user_data);
+
+// Deferred population of a lazily-created index.
+typedef struct iree_io_parameter_index_populator_t {
+  // Called once on the first query of the index.
+  iree_io_parameter_index_populate_fn_t fn;
+  // Optional; called with |user_data| when the index is destroyed.
+  iree_io_parameter_index_populator_release_fn_t release;
+  void* user_data;
+} iree_io_parameter_index_populator_t;
+
+// Creates a file index that is populated by |populator| the first time it is
+// queried instead of up front. This allows callers to defer parsing parameter
+// files until (and unless) a parameter they contain is requested.
+//
+// Queries from any thread wait for population to complete. If population fails
+// the failure is returned from all queries of the index. Entries may still be
+// added directly with iree_io_parameter_index_add before population and will
+// precede those added by the populator.
+//
+// Ownership of the populator |user_data| passes to the index on success.
+IREE_API_EXPORT iree_status_t iree_io_parameter_index_create_lazy(
+    iree_io_parameter_index_populator_t populator,
+    iree_allocator_t host_allocator, iree_io_parameter_index_t** out_index);
+
 // Retains the given |index| for the caller.
 IREE_API_EXPORT void iree_io_parameter_index_retain(
     iree_io_parameter_index_t* index);
@@ -92,11 +179,20 @@ IREE_API_EXPORT void iree_io_parameter_index_release(
 // Returns the number of entries in the index at the time the method is called.
 // New entries may be added by other threads between when the value is queried
 // and when the caller enumerates entries. Use this only for debugging.
+// Returns 0 if the index is lazily populated and population failed.
 IREE_API_EXPORT iree_host_size_t
 iree_io_parameter_index_count(iree_io_parameter_index_t* index);
 
+// Returns true if |index| has been populated. Indices created with
+// iree_io_parameter_index_create are always populated and lazily-created ones
+// are populated by their first query. Does not populate the index.
+IREE_API_EXPORT bool iree_io_parameter_index_is_populated(
+    iree_io_parameter_index_t* index);
+
 // Reserves storage for at least |new_capacity| entries in the index.
-// Ignored if storage capacity is already sufficient.
+// Ignored if storage capacity is already sufficient. Callers adding many
+// entries should reserve up front to avoid repeatedly rehashing the lookup
+// table as the index grows.
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_reserve(
     iree_io_parameter_index_t* index, iree_host_size_t new_capacity);
 
@@ -115,7 +211,9 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_get(
     const iree_io_parameter_index_entry_t** out_entry);
 
 // Performs a file entry lookup of |key| in the index and returns it.
-// The returned |out_entry| is valid for the lifetime of the index.
+// Lookups are hashed and take constant time on average regardless of the
+// number of entries. If multiple entries share the same key the first added is
+// returned. The returned |out_entry| is valid for the lifetime of the index.
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_lookup(
     iree_io_parameter_index_t* index, iree_string_view_t key,
     const iree_io_parameter_index_entry_t** out_entry);
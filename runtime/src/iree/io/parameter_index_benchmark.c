@@ -0,0 +1,92 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_index.h"
+#include "iree/testing/benchmark.h"
+
+// Measures building an index of N splat entries and then resolving every one
+// of them by key as happens when loading a program that uses all parameters.
+//
+// user_data is the number of entries.
+static iree_status_t iree_io_parameter_index_benchmark_load_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_host_size_t entry_count =
+      (iree_host_size_t)(uintptr_t)benchmark_def->user_data;
+
+  // Keys are formatted once outside of the timed region.
+  char* key_storage = NULL;
+  static const iree_host_size_t kMaxKeyLength = 48;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, entry_count * kMaxKeyLength, (void**)&key_storage));
+  for (iree_host_size_t i = 0; i < entry_count; ++i) {
+    snprintf(key_storage + i * kMaxKeyLength, kMaxKeyLength,
+             "model.layers.%" PRIhsz ".self_attn.q_proj.weight", i);
+  }
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_io_parameter_index_t* index = NULL;
+    status = iree_io_parameter_index_create(host_allocator, &index);
+    for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < entry_count;
+         ++i) {
+      iree_io_parameter_index_entry_t entry = {
+          .key = iree_make_cstring_view(key_storage + i * kMaxKeyLength),
+          .metadata = iree_const_byte_span_empty(),
+          .length = 4096,
+          .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT,
+      };
+      status = iree_io_parameter_index_add(index, &entry);
+    }
+    for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < entry_count;
+         ++i) {
+      const iree_io_parameter_index_entry_t* entry = NULL;
+      status = iree_io_parameter_index_lookup(
+          index, iree_make_cstring_view(key_storage + i * kMaxKeyLength),
+          &entry);
+    }
+    iree_io_parameter_index_release(index);
+  }
+
+  iree_allocator_free(host_allocator, key_storage);
+  return status;
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_io_parameter_index_benchmark_load_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_io_parameter_index_benchmark_load_n,
+    };
+    benchmark_def.user_data = (void*)1000u;
+    iree_benchmark_register(iree_make_cstring_view("load_1000"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)10000u;
+    iree_benchmark_register(iree_make_cstring_view("load_10000"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)100000u;
+    iree_benchmark_register(iree_make_cstring_view("load_100000"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)500000u;
+    iree_benchmark_register(iree_make_cstring_view("load_500000"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
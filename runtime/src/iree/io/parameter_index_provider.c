@@ -6,6 +6,8 @@
 
 #include "iree/io/parameter_index_provider.h"
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/utils/file_cache.h"
 
 // Limit concurrent operations to avoid blowing the stack. This is arbitrary and
@@ -13,13 +15,40 @@
 // a growable stack scratchpad.
 #define IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY 8
 
+// A host mapping of a file handle used to import parameters without copying.
+typedef struct iree_io_parameter_file_mapping_t {
+  // Handle the mapping was made from (retained).
+  iree_io_file_handle_t* handle;
+  // Shared read-only mapping of the entire file or NULL if the file could not
+  // be mapped. Failures are cached so that we don't retry each parameter.
+  iree_io_file_mapping_t* mapping;
+} iree_io_parameter_file_mapping_t;
+
 typedef struct iree_io_parameter_index_provider_t {
   iree_io_parameter_provider_t base;
   iree_allocator_t host_allocator;
+  iree_io_parameter_index_provider_flags_t flags;
   iree_host_size_t max_concurrent_operations;
   iree_string_view_t scope;
   iree_io_parameter_index_t* index;
   iree_hal_file_cache_t* file_cache;
+  // Optional profile recording parameter accesses, retained.
+  iree_io_parameter_profile_t* profile;
+
+  // Guards the file mapping list.
+  iree_slim_mutex_t mapping_mutex;
+  // Total capacity of the mapping list in elements.
+  iree_host_size_t mapping_capacity;
+  // Currently used mapping count in elements.
+  iree_host_size_t mapping_count;
+  // Dense list of file mappings made by loads when
+  // IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES is set. Grows as needed.
+  iree_io_parameter_file_mapping_t* mappings;
+
+  // Guards the decode op list.
+  iree_slim_mutex_t decode_op_mutex;
+  // Decode host calls that have been enqueued and not yet reclaimed.
+  struct iree_io_parameter_decode_op_t* decode_op_head;
 } iree_io_parameter_index_provider_t;
 
 static const iree_io_parameter_provider_vtable_t
@@ -35,6 +64,19 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider) {
+  return iree_io_parameter_index_provider_create_with_flags(
+      scope, index, IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_NONE,
+      max_concurrent_operations, /*profile=*/NULL, host_allocator,
+      out_provider);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_flags(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    iree_io_parameter_index_provider_flags_t flags,
+    iree_host_size_t max_concurrent_operations,
+    iree_io_parameter_profile_t* profile, iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_ASSERT_ARGUMENT(out_provider);
   *out_provider = NULL;
@@ -52,7 +94,10 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
   iree_atomic_ref_count_init(&provider->base.ref_count);
   provider->base.vtable = &iree_io_parameter_index_provider_vtable;
   provider->host_allocator = host_allocator;
+  provider->flags = flags;
   provider->max_concurrent_operations = max_concurrent_operations;
+  iree_slim_mutex_initialize(&provider->mapping_mutex);
+  iree_slim_mutex_initialize(&provider->decode_op_mutex);
 
   provider->scope = iree_make_string_view(
       (const char*)provider + sizeof(*provider), scope.size);
@@ -61,6 +106,9 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
   provider->index = index;
   iree_io_parameter_index_retain(index);
 
+  provider->profile = profile;
+  iree_io_parameter_profile_retain(profile);
+
   iree_status_t status =
       iree_hal_file_cache_create(host_allocator, &provider->file_cache);
 
@@ -73,6 +121,144 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
   return status;
 }
 
+// Drops all cached file mappings. Buffers imported from the mappings retain
+// them and the memory remains valid until the last buffer is released.
+static void iree_io_parameter_index_provider_trim_mappings(
+    iree_io_parameter_index_provider_t* provider) {
+  iree_slim_mutex_lock(&provider->mapping_mutex);
+  for (iree_host_size_t i = 0; i < provider->mapping_count; ++i) {
+    iree_io_file_mapping_release(provider->mappings[i].mapping);
+    iree_io_file_handle_release(provider->mappings[i].handle);
+  }
+  iree_allocator_free(provider->host_allocator, provider->mappings);
+  provider->mappings = NULL;
+  provider->mapping_capacity = 0;
+  provider->mapping_count = 0;
+  iree_slim_mutex_unlock(&provider->mapping_mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// Decode op tracking
+//===----------------------------------------------------------------------===//
+
+// Host calls have no cleanup hook: if any of their waits fail they are never
+// issued and the state they captured would leak. Decode ops are instead tracked
+// by the provider and reclaimed once they have either completed or can no
+// longer be issued.
+
+// Bits of iree_io_parameter_decode_op_t::state.
+enum iree_io_parameter_decode_op_state_bits_e {
+  // Enqueued and waiting for the host call to be issued.
+  IREE_IO_PARAMETER_DECODE_OP_STATE_PENDING = 0,
+  // The host call has been issued.
+  IREE_IO_PARAMETER_DECODE_OP_STATE_RUNNING = 1u << 0,
+  // The op has released its resources and is no longer accessed by the host
+  // call. Its memory may be freed by whoever tracks it.
+  IREE_IO_PARAMETER_DECODE_OP_STATE_COMPLETE = 1u << 1,
+  // The provider was destroyed while the op was still outstanding and the host
+  // call frees the op when it completes.
+  IREE_IO_PARAMETER_DECODE_OP_STATE_ORPHANED = 1u << 2,
+};
+
+// State for a host call decoding a range of a compressed or transformed
+// parameter into a host-mappable buffer.
+typedef struct iree_io_parameter_decode_op_t {
+  // Next op in the provider decode op list.
+  struct iree_io_parameter_decode_op_t* next;
+  // iree_io_parameter_decode_op_state_bits_e.
+  iree_atomic_int32_t state;
+  iree_allocator_t host_allocator;
+  // Timepoint signaled by the host call. If it fails before the call is issued
+  // the call will never be issued.
+  iree_hal_semaphore_t* signal_semaphore;
+  // Index owning |entry|, retained to keep the entry live.
+  iree_io_parameter_index_t* index;
+  const iree_io_parameter_index_entry_t* entry;
+  // Decoded offset in the parameter to start decoding from.
+  uint64_t parameter_offset;
+  // Target buffer range receiving the decoded data.
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t buffer_offset;
+  iree_device_size_t length;
+} iree_io_parameter_decode_op_t;
+
+static void iree_io_parameter_decode_op_release_resources(
+    iree_io_parameter_decode_op_t* op) {
+  iree_hal_buffer_release(op->buffer);
+  op->buffer = NULL;
+  iree_io_parameter_index_release(op->index);
+  op->index = NULL;
+  iree_hal_semaphore_release(op->signal_semaphore);
+  op->signal_semaphore = NULL;
+}
+
+// Returns true if the |op| host call can no longer be issued because its
+// signal timepoint has failed.
+static bool iree_io_parameter_decode_op_is_abandoned(
+    iree_io_parameter_decode_op_t* op) {
+  uint64_t value = 0;
+  iree_status_t status = iree_hal_semaphore_query(op->signal_semaphore, &value);
+  const bool is_failed = !iree_status_is_ok(status);
+  iree_status_ignore(status);
+  return is_failed;
+}
+
+// Adds an enqueued |op| to the |provider| decode op list.
+static void iree_io_parameter_index_provider_track_decode_op(
+    iree_io_parameter_index_provider_t* provider,
+    iree_io_parameter_decode_op_t* op) {
+  iree_slim_mutex_lock(&provider->decode_op_mutex);
+  op->next = provider->decode_op_head;
+  provider->decode_op_head = op;
+  iree_slim_mutex_unlock(&provider->decode_op_mutex);
+}
+
+// Frees all decode ops that have completed and releases the resources of any
+// that were abandoned because their waits failed.
+static void iree_io_parameter_index_provider_reclaim_decode_ops(
+    iree_io_parameter_index_provider_t* provider) {
+  iree_slim_mutex_lock(&provider->decode_op_mutex);
+  iree_io_parameter_decode_op_t** link = &provider->decode_op_head;
+  while (*link) {
+    iree_io_parameter_decode_op_t* op = *link;
+    int32_t state = iree_atomic_load(&op->state, iree_memory_order_acquire);
+    if (state == IREE_IO_PARAMETER_DECODE_OP_STATE_PENDING &&
+        iree_io_parameter_decode_op_is_abandoned(op) &&
+        iree_atomic_compare_exchange_strong(
+            &op->state, &state, IREE_IO_PARAMETER_DECODE_OP_STATE_COMPLETE,
+            iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+      iree_io_parameter_decode_op_release_resources(op);
+      state = IREE_IO_PARAMETER_DECODE_OP_STATE_COMPLETE;
+    }
+    if (state & IREE_IO_PARAMETER_DECODE_OP_STATE_COMPLETE) {
+      *link = op->next;
+      iree_allocator_free(op->host_allocator, op);
+    } else {
+      link = &op->next;
+    }
+  }
+  iree_slim_mutex_unlock(&provider->decode_op_mutex);
+}
+
+// Reclaims what decode ops it can and hands the rest off to their host calls.
+// Ops that are still pending and whose waits fail after this point are leaked.
+static void iree_io_parameter_index_provider_orphan_decode_ops(
+    iree_io_parameter_index_provider_t* provider) {
+  iree_io_parameter_index_provider_reclaim_decode_ops(provider);
+  iree_io_parameter_decode_op_t* op = provider->decode_op_head;
+  provider->decode_op_head = NULL;
+  while (op) {
+    iree_io_parameter_decode_op_t* next = op->next;
+    const int32_t prior_state = iree_atomic_fetch_or(
+        &op->state, IREE_IO_PARAMETER_DECODE_OP_STATE_ORPHANED,
+        iree_memory_order_acq_rel);
+    if (prior_state & IREE_IO_PARAMETER_DECODE_OP_STATE_COMPLETE) {
+      iree_allocator_free(op->host_allocator, op);
+    }
+    op = next;
+  }
+}
+
 static void iree_io_parameter_index_provider_destroy(
     iree_io_parameter_provider_t* IREE_RESTRICT base_provider) {
   iree_io_parameter_index_provider_t* provider =
@@ -80,7 +266,12 @@ static void iree_io_parameter_index_provider_destroy(
   iree_allocator_t host_allocator = provider->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_io_parameter_index_provider_orphan_decode_ops(provider);
+  iree_slim_mutex_deinitialize(&provider->decode_op_mutex);
+  iree_io_parameter_index_provider_trim_mappings(provider);
+  iree_slim_mutex_deinitialize(&provider->mapping_mutex);
   iree_hal_file_cache_release(provider->file_cache);
+  iree_io_parameter_profile_release(provider->profile);
   iree_io_parameter_index_release(provider->index);
 
   iree_allocator_free(host_allocator, provider);
@@ -99,6 +290,8 @@ static iree_status_t iree_io_parameter_index_provider_notify(
     case IREE_IO_PARAMETER_PROVIDER_SIGNAL_SUSPEND:
     case IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY:
       iree_hal_file_cache_trim(provider->file_cache);
+      iree_io_parameter_index_provider_trim_mappings(provider);
+      iree_io_parameter_index_provider_reclaim_decode_ops(provider);
       break;
     default:
       break;
@@ -137,6 +330,13 @@ static iree_status_t iree_io_parameter_index_provider_resolve(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_io_parameter_index_lookup(provider->index, key, &entry));
 
+  // Record the access for future prefetching. Profiling is best-effort and
+  // must not cause parameter operations to fail.
+  if (provider->profile) {
+    iree_status_ignore(iree_io_parameter_profile_record(provider->profile,
+                                                        provider->scope, key));
+  }
+
   // Get (or import) the HAL file backing the entry.
   // NOTE: file is retained!
   iree_hal_file_t* file = NULL;
@@ -179,6 +379,22 @@ static iree_status_t iree_io_validate_parameter_range(
             IREE_HAL_MEMORY_ACCESS_WRITE | IREE_HAL_MEMORY_ACCESS_DISCARD;
       }
       break;
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+      // Compressed entries can only be read as writes would need to recompress.
+      if (iree_all_bits_set(
+              iree_io_file_handle_access(entry->storage.compressed.handle),
+              IREE_IO_FILE_ACCESS_READ)) {
+        allowed_access |= IREE_HAL_MEMORY_ACCESS_READ;
+      }
+      break;
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM:
+      // Transformed entries can only be read as transforms are one-way.
+      if (iree_all_bits_set(
+              iree_io_file_handle_access(entry->storage.transform.handle),
+              IREE_IO_FILE_ACCESS_READ)) {
+        allowed_access |= IREE_HAL_MEMORY_ACCESS_READ;
+      }
+      break;
     default:
       // Unknown entries are inaccessible.
       allowed_access = IREE_HAL_MEMORY_ACCESS_NONE;
@@ -297,6 +513,9 @@ static void iree_io_parameter_op_batch_begin(
 
   memset(out_batch, 0, sizeof(*out_batch));
 
+  // Reclaim decode ops from prior batches that have finished or failed.
+  iree_io_parameter_index_provider_reclaim_decode_ops(provider);
+
   out_batch->provider = provider;
   out_batch->device = device;
   out_batch->queue_affinity = queue_affinity;
@@ -359,27 +578,23 @@ static iree_status_t iree_io_parameter_op_batch_resolve_entry(
   return status;
 }
 
+// A point on one of the batch timelines that other operations can wait on.
+typedef struct {
+  iree_hal_semaphore_t* semaphore;  // unretained, owned by the batch
+  uint64_t value;
+} iree_io_parameter_op_timepoint_t;
+
 typedef struct {
   iree_hal_semaphore_list_t wait_semaphore_list;
   iree_hal_semaphore_list_t signal_semaphore_list;
-  uint64_t scratch_values[2];  // wait/signal payload values
+  iree_hal_semaphore_t* scratch_semaphores[2];  // wait semaphores
+  uint64_t scratch_values[3];  // wait/wait/signal payload values
 } iree_io_parameter_op_step_t;
 
-// Selects a timeline with the fewest bytes outstanding and accounts for the new
-// |op_byte_length| bytes on that timeline. Returns semaphore lists the caller
-// must wait on before performing their operation and signal after their
-// operation completes.
-static iree_status_t iree_io_parameter_op_batch_advance_timeline(
-    iree_io_parameter_op_batch_t* batch, uint64_t op_byte_length,
-    iree_io_parameter_op_step_t* IREE_RESTRICT out_step) {
-  IREE_ASSERT_ARGUMENT(batch);
-  IREE_ASSERT_ARGUMENT(out_step);
-  memset(out_step, 0, sizeof(*out_step));
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, op_byte_length);
-
-  // Find the timeline with the fewest outstanding bytes.
-  // Linear scan as the number of timelines is expected to be small.
+// Returns the index of the timeline with the fewest bytes outstanding.
+// Linear scan as the number of timelines is expected to be small.
+static iree_host_size_t iree_io_parameter_op_batch_select_timeline(
+    const iree_io_parameter_op_batch_t* batch) {
   uint64_t smallest_value = batch->timeline_bytes_outstanding[0];
   iree_host_size_t smallest_index = 0;
   for (iree_host_size_t i = 1; i < batch->concurrency; ++i) {
@@ -388,8 +603,24 @@ static iree_status_t iree_io_parameter_op_batch_advance_timeline(
       smallest_index = i;
     }
   }
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)smallest_index);
-  const iree_host_size_t timeline_index = smallest_index;
+  return smallest_index;
+}
+
+// Accounts for the new |op_byte_length| bytes on the timeline at
+// |timeline_index| and returns semaphore lists the caller must wait on before
+// performing their operation and signal after their operation completes. If
+// |dependency| is provided the operation will also wait for it.
+static iree_status_t iree_io_parameter_op_batch_advance_timeline_at(
+    iree_io_parameter_op_batch_t* batch, iree_host_size_t timeline_index,
+    uint64_t op_byte_length,
+    const iree_io_parameter_op_timepoint_t* dependency,
+    iree_io_parameter_op_step_t* IREE_RESTRICT out_step) {
+  IREE_ASSERT_ARGUMENT(batch);
+  IREE_ASSERT_ARGUMENT(out_step);
+  memset(out_step, 0, sizeof(*out_step));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, op_byte_length);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)timeline_index);
 
   // Acquire the timeline semaphore used for this operation.
   // We create the semaphores on-demand so that in cases where we don't perform
@@ -419,44 +650,82 @@ static iree_status_t iree_io_parameter_op_batch_advance_timeline(
   // of memory or I/O bandwidth).
   batch->timeline_bytes_outstanding[timeline_index] += op_byte_length;
 
+  // Dependencies on our own timeline are implied by the continuation.
+  if (dependency && dependency->semaphore == timeline_semaphore) {
+    dependency = NULL;
+  }
+
   // Select the wait semaphore list; the first wave of operations all wait on
   // the original wait semaphore list provided by the initiator.
   if (is_first_timeline_use) {
     // First use of this timeline; wait on incoming list and begin the timeline.
     IREE_ASSERT_EQ(timeline_index, batch->timeline_live_count);
     ++batch->timeline_live_count;
-    out_step->wait_semaphore_list = batch->wait_semaphore_list;
+    if (dependency) {
+      // Dependencies are always on other batch timelines that have already
+      // waited on the incoming list so we only need to wait on them.
+      out_step->scratch_semaphores[0] = dependency->semaphore;
+      out_step->scratch_values[0] = dependency->value;
+      out_step->wait_semaphore_list.count = 1;
+    } else {
+      out_step->wait_semaphore_list = batch->wait_semaphore_list;
+    }
   } else {
     // Continuation of the selected timeline.
+    out_step->scratch_semaphores[0] = timeline_semaphore;
     out_step->scratch_values[0] = previous_timeline_value;
     out_step->wait_semaphore_list.count = 1;
-    out_step->wait_semaphore_list.semaphores =
-        &batch->timeline_semaphores[timeline_index];
-    out_step->wait_semaphore_list.payload_values = &out_step->scratch_values[0];
+    if (dependency) {
+      out_step->scratch_semaphores[1] = dependency->semaphore;
+      out_step->scratch_values[1] = dependency->value;
+      out_step->wait_semaphore_list.count = 2;
+    }
+  }
+  if (out_step->wait_semaphore_list.count > 0 &&
+      !out_step->wait_semaphore_list.semaphores) {
+    out_step->wait_semaphore_list.semaphores = out_step->scratch_semaphores;
+    out_step->wait_semaphore_list.payload_values = out_step->scratch_values;
   }
 
   // Signal the continuation of the timeline.
-  out_step->scratch_values[1] = next_timeline_value;
+  out_step->scratch_values[2] = next_timeline_value;
   out_step->signal_semaphore_list.count = 1;
   out_step->signal_semaphore_list.semaphores =
       &batch->timeline_semaphores[timeline_index];
-  out_step->signal_semaphore_list.payload_values = &out_step->scratch_values[1];
+  out_step->signal_semaphore_list.payload_values = &out_step->scratch_values[2];
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
+// Selects a timeline with the fewest bytes outstanding and accounts for the new
+// |op_byte_length| bytes on that timeline. Returns semaphore lists the caller
+// must wait on before performing their operation and signal after their
+// operation completes.
+static iree_status_t iree_io_parameter_op_batch_advance_timeline(
+    iree_io_parameter_op_batch_t* batch, uint64_t op_byte_length,
+    iree_io_parameter_op_step_t* IREE_RESTRICT out_step) {
+  return iree_io_parameter_op_batch_advance_timeline_at(
+      batch, iree_io_parameter_op_batch_select_timeline(batch), op_byte_length,
+      /*dependency=*/NULL, out_step);
+}
+
 // Enqueues a queue-ordered allocation.
 // A timeline is selected based on utilization and the following operation is
 // guaranteed to select the same timeline to ensure the allocation and
 // operation are serialized and the wait has a higher chance of being elided.
+// |out_timepoint| is set to the point at which the allocation is available
+// for operations on other timelines to wait on.
 static iree_status_t iree_io_parameter_op_batch_enqueue_alloca(
     iree_io_parameter_op_batch_t* batch, iree_hal_allocator_pool_t pool,
     iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
-    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer,
+    iree_io_parameter_op_timepoint_t* IREE_RESTRICT out_timepoint) {
   IREE_ASSERT_ARGUMENT(batch);
   IREE_ASSERT_ARGUMENT(out_buffer);
+  IREE_ASSERT_ARGUMENT(out_timepoint);
   *out_buffer = NULL;
+  memset(out_timepoint, 0, sizeof(*out_timepoint));
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // By passing 0 for the operation size we ensure that subsequent operations
@@ -475,6 +744,8 @@ static iree_status_t iree_io_parameter_op_batch_enqueue_alloca(
               batch->device, batch->queue_affinity, step.wait_semaphore_list,
               step.signal_semaphore_list, pool, params, allocation_size,
               IREE_HAL_ALLOCA_FLAG_NONE, out_buffer));
+  out_timepoint->semaphore = step.signal_semaphore_list.semaphores[0];
+  out_timepoint->value = step.signal_semaphore_list.payload_values[0];
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
@@ -567,6 +838,243 @@ static iree_status_t iree_io_parameter_op_batch_enqueue_file_write(
   return status;
 }
 
+// Minimum number of decoded bytes handled by a single decode host call.
+// Parameters smaller than this are decoded by one call and larger ones are
+// split across the batch timelines so that they decode in parallel.
+#define IREE_IO_PARAMETER_DECODE_MIN_CHUNK_SIZE (1 * 1024 * 1024)
+
+static iree_status_t iree_io_parameter_decode_op_call(
+    void* user_data, const uint64_t args[4],
+    iree_hal_host_call_context_t* context) {
+  iree_io_parameter_decode_op_t* op = (iree_io_parameter_decode_op_t*)user_data;
+  iree_atomic_fetch_or(&op->state, IREE_IO_PARAMETER_DECODE_OP_STATE_RUNNING,
+                       iree_memory_order_acq_rel);
+  const iree_io_parameter_index_entry_t* entry = op->entry;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, entry->key.data, entry->key.size);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, op->length);
+
+  // Only map the compressed blocks covering the range as other chunks of the
+  // parameter are decoded by other calls.
+  iree_io_file_mapping_t* file_mapping = NULL;
+  uint64_t compressed_offset = 0;
+  iree_status_t status = iree_ok_status();
+  if (entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+    uint64_t compressed_length = 0;
+    iree_io_compressed_blocks_range(&entry->storage.compressed.blocks,
+                                    op->parameter_offset, op->length,
+                                    &compressed_offset, &compressed_length);
+    status = iree_io_file_map_view(
+        entry->storage.compressed.handle, IREE_IO_FILE_ACCESS_READ,
+        entry->storage.compressed.offset + compressed_offset,
+        (iree_host_size_t)compressed_length, IREE_IO_FILE_MAPPING_FLAG_NONE,
+        op->host_allocator, &file_mapping);
+  } else {
+    status = iree_io_file_map_view(
+        entry->storage.transform.handle, IREE_IO_FILE_ACCESS_READ,
+        entry->storage.transform.offset,
+        (iree_host_size_t)entry->storage.transform.length,
+        IREE_IO_FILE_MAPPING_FLAG_NONE, op->host_allocator, &file_mapping);
+  }
+
+  iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_map_range(
+        op->buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+        IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, op->buffer_offset, op->length,
+        &buffer_mapping);
+  }
+  if (iree_status_is_ok(status)) {
+    if (entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED) {
+      status = iree_io_compressed_blocks_read(
+          &entry->storage.compressed.blocks,
+          iree_io_file_mapping_contents_ro(file_mapping), compressed_offset,
+          op->parameter_offset, buffer_mapping.contents, op->host_allocator);
+    } else {
+      status = entry->storage.transform.fn(
+          entry->storage.transform.params,
+          iree_io_file_mapping_contents_ro(file_mapping), op->parameter_offset,
+          buffer_mapping.contents);
+    }
+    if (iree_status_is_ok(status) &&
+        !iree_all_bits_set(iree_hal_buffer_memory_type(op->buffer),
+                           IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+      status = iree_hal_buffer_mapping_flush_range(&buffer_mapping, 0,
+                                                   IREE_HAL_WHOLE_BUFFER);
+    }
+    status =
+        iree_status_join(status, iree_hal_buffer_unmap_range(&buffer_mapping));
+  }
+  iree_io_file_mapping_release(file_mapping);
+
+  // The op may be freed by the provider as soon as it is marked complete.
+  iree_allocator_t host_allocator = op->host_allocator;
+  iree_io_parameter_decode_op_release_resources(op);
+  const int32_t prior_state = iree_atomic_fetch_or(
+      &op->state, IREE_IO_PARAMETER_DECODE_OP_STATE_COMPLETE,
+      iree_memory_order_acq_rel);
+  if (prior_state & IREE_IO_PARAMETER_DECODE_OP_STATE_ORPHANED) {
+    iree_allocator_free(host_allocator, op);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Enqueues a host call on |step| decoding |length| bytes of |entry| starting
+// at |parameter_offset| into the host-mappable |buffer|. The op is tracked by
+// the provider so that its resources are released even if the call is never
+// issued.
+static iree_status_t iree_io_parameter_op_batch_enqueue_decode_call(
+    iree_io_parameter_op_batch_t* batch,
+    const iree_io_parameter_op_step_t* step,
+    const iree_io_parameter_index_entry_t* entry, uint64_t parameter_offset,
+    iree_hal_buffer_t* buffer, iree_device_size_t buffer_offset,
+    iree_device_size_t length) {
+  IREE_ASSERT(step->signal_semaphore_list.count == 1);
+  iree_allocator_t host_allocator = batch->provider->host_allocator;
+  iree_io_parameter_decode_op_t* op = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, sizeof(*op), (void**)&op));
+  op->host_allocator = host_allocator;
+  op->signal_semaphore = step->signal_semaphore_list.semaphores[0];
+  iree_hal_semaphore_retain(op->signal_semaphore);
+  op->index = batch->provider->index;
+  iree_io_parameter_index_retain(op->index);
+  op->entry = entry;
+  op->parameter_offset = parameter_offset;
+  op->buffer = buffer;
+  iree_hal_buffer_retain(op->buffer);
+  op->buffer_offset = buffer_offset;
+  op->length = length;
+  const uint64_t args[4] = {0};
+  iree_status_t status = iree_hal_device_queue_host_call(
+      batch->device, batch->queue_affinity, step->wait_semaphore_list,
+      step->signal_semaphore_list,
+      iree_hal_make_host_call(iree_io_parameter_decode_op_call, op), args,
+      IREE_HAL_HOST_CALL_FLAG_NONE);
+  if (iree_status_is_ok(status)) {
+    iree_io_parameter_index_provider_track_decode_op(batch->provider, op);
+  } else {
+    iree_io_parameter_decode_op_release_resources(op);
+    iree_allocator_free(host_allocator, op);
+  }
+  return status;
+}
+
+// Enqueues decoding of the compressed or transformed |entry| range starting at
+// |parameter_offset| into the |target_buffer| range. The range is split into
+// chunks aligned to the entry decode granularity (compression blocks or
+// transform chunks) that are distributed across the batch timelines and
+// decoded in parallel by host calls. If |dependency| is provided all chunks
+// wait for it (such as the allocation of |target_buffer|).
+//
+// Host calls require host-mappable memory. When the target buffer is not
+// mappable each chunk is decoded into a transient staging buffer and copied
+// into the target on the same timeline.
+static iree_status_t iree_io_parameter_op_batch_enqueue_decode(
+    iree_io_parameter_op_batch_t* batch,
+    const iree_io_parameter_index_entry_t* entry, uint64_t parameter_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_buffer_offset,
+    iree_device_size_t length,
+    const iree_io_parameter_op_timepoint_t* dependency) {
+  IREE_ASSERT_ARGUMENT(batch);
+  IREE_ASSERT_ARGUMENT(entry);
+  IREE_ASSERT_ARGUMENT(target_buffer);
+  if (length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, length);
+
+  const bool is_mappable =
+      iree_all_bits_set(iree_hal_buffer_memory_type(target_buffer),
+                        IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+      iree_all_bits_set(iree_hal_buffer_allowed_usage(target_buffer),
+                        IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, is_mappable ? "direct" : "staged");
+
+  // Split into one chunk per timeline, rounding up to whole decode granules so
+  // that no compressed block or transform chunk is decoded by more than one
+  // chunk. Transform chunks need not be a power of two.
+  const uint64_t granule =
+      entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED
+          ? entry->storage.compressed.blocks.block_size
+          : iree_max(1, entry->storage.transform.chunk_size);
+  const uint64_t chunk_size =
+      iree_max(IREE_IO_PARAMETER_DECODE_MIN_CHUNK_SIZE,
+               (length + batch->concurrency - 1) / batch->concurrency);
+
+  iree_status_t status = iree_ok_status();
+  for (uint64_t chunk_offset = 0;
+       iree_status_is_ok(status) && chunk_offset < length;) {
+    // Align chunk ends to granule boundaries in the parameter.
+    const uint64_t chunk_limit = parameter_offset + chunk_offset + chunk_size;
+    const uint64_t chunk_end =
+        iree_min(length, ((chunk_limit + granule - 1) / granule) * granule -
+                             parameter_offset);
+    const uint64_t chunk_length = chunk_end - chunk_offset;
+    const iree_host_size_t timeline_index =
+        iree_io_parameter_op_batch_select_timeline(batch);
+    iree_io_parameter_op_step_t step;
+    status = iree_io_parameter_op_batch_advance_timeline_at(
+        batch, timeline_index, chunk_length, dependency, &step);
+    if (iree_status_is_ok(status) && is_mappable) {
+      status = iree_io_parameter_op_batch_enqueue_decode_call(
+          batch, &step, entry, parameter_offset + chunk_offset, target_buffer,
+          target_buffer_offset + chunk_offset, chunk_length);
+    } else if (iree_status_is_ok(status)) {
+      // alloca -> decode -> copy -> dealloca all on the same timeline.
+      const iree_hal_buffer_params_t staging_params = {
+          .usage = IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED,
+          .access = IREE_HAL_MEMORY_ACCESS_ALL,
+          .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+                  IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
+          .queue_affinity = batch->queue_affinity,
+      };
+      iree_hal_buffer_t* staging_buffer = NULL;
+      status = iree_hal_device_queue_alloca(
+          batch->device, batch->queue_affinity, step.wait_semaphore_list,
+          step.signal_semaphore_list, IREE_HAL_ALLOCATOR_POOL_DEFAULT,
+          staging_params, chunk_length, IREE_HAL_ALLOCA_FLAG_NONE,
+          &staging_buffer);
+      if (iree_status_is_ok(status)) {
+        status = iree_io_parameter_op_batch_advance_timeline_at(
+            batch, timeline_index, 0, NULL, &step);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_io_parameter_op_batch_enqueue_decode_call(
+            batch, &step, entry, parameter_offset + chunk_offset,
+            staging_buffer, 0, chunk_length);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_io_parameter_op_batch_advance_timeline_at(
+            batch, timeline_index, 0, NULL, &step);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_hal_device_queue_copy(
+            batch->device, batch->queue_affinity, step.wait_semaphore_list,
+            step.signal_semaphore_list, staging_buffer, 0, target_buffer,
+            target_buffer_offset + chunk_offset, chunk_length,
+            IREE_HAL_COPY_FLAG_NONE);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_io_parameter_op_batch_advance_timeline_at(
+            batch, timeline_index, 0, NULL, &step);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_hal_device_queue_dealloca(
+            batch->device, batch->queue_affinity, step.wait_semaphore_list,
+            step.signal_semaphore_list, staging_buffer,
+            IREE_HAL_DEALLOCA_FLAG_NONE);
+      }
+      iree_hal_buffer_release(staging_buffer);
+    }
+    chunk_offset = chunk_end;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Flushes any outstanding work in the |batch| and signals the user timeline.
 // Must only be called once at the end of the batch.
 static iree_status_t iree_io_parameter_op_batch_flush(
@@ -678,6 +1186,172 @@ static void iree_io_file_handle_buffer_release(void* user_data,
   iree_io_file_handle_release((iree_io_file_handle_t*)user_data);
 }
 
+static void iree_io_file_mapping_buffer_release(void* user_data,
+                                                iree_hal_buffer_t* buffer) {
+  iree_io_file_mapping_release((iree_io_file_mapping_t*)user_data);
+}
+
+// Returns a retained shared read-only mapping of the entire file |handle| in
+// |out_mapping| or NULL if the file cannot be mapped. Mappings are made on
+// first use and cached for the lifetime of the provider (or until trimmed).
+static iree_status_t iree_io_parameter_index_provider_map_file(
+    iree_io_parameter_index_provider_t* provider, iree_io_file_handle_t* handle,
+    iree_io_file_mapping_t** out_mapping) {
+  *out_mapping = NULL;
+  iree_slim_mutex_lock(&provider->mapping_mutex);
+
+  for (iree_host_size_t i = 0; i < provider->mapping_count; ++i) {
+    if (provider->mappings[i].handle == handle) {
+      iree_io_file_mapping_t* mapping = provider->mappings[i].mapping;
+      iree_io_file_mapping_retain(mapping);
+      iree_slim_mutex_unlock(&provider->mapping_mutex);
+      *out_mapping = mapping;
+      return iree_ok_status();
+    }
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  if (provider->mapping_count == provider->mapping_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(8u, provider->mapping_capacity * 2);
+    status = iree_allocator_realloc(
+        provider->host_allocator, new_capacity * sizeof(provider->mappings[0]),
+        (void**)&provider->mappings);
+    if (iree_status_is_ok(status)) provider->mapping_capacity = new_capacity;
+  }
+
+  // Map the whole file once; most files contain many parameters and mapping
+  // each individually would waste address space on page alignment and
+  // kernel time on VMAs. If mapping fails (platform without mapping support,
+  // special files, etc) we remember that so that loads fall back to reads
+  // without trying again.
+  iree_io_file_mapping_t* mapping = NULL;
+  if (iree_status_is_ok(status)) {
+    iree_status_t map_status = iree_io_file_map_view(
+        handle, IREE_IO_FILE_ACCESS_READ, 0, IREE_HOST_SIZE_MAX,
+        IREE_IO_FILE_MAPPING_FLAG_EXCLUDE_FROM_DUMPS, provider->host_allocator,
+        &mapping);
+    if (!iree_status_is_ok(map_status)) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "mapping failed");
+      iree_status_ignore(map_status);
+    }
+    iree_io_parameter_file_mapping_t* entry =
+        &provider->mappings[provider->mapping_count++];
+    entry->handle = handle;
+    iree_io_file_handle_retain(entry->handle);
+    entry->mapping = mapping;
+    iree_io_file_mapping_retain(mapping);
+  }
+
+  iree_slim_mutex_unlock(&provider->mapping_mutex);
+  if (iree_status_is_ok(status)) {
+    *out_mapping = mapping;
+  } else {
+    iree_io_file_mapping_release(mapping);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Attempts to import the parameter range of |entry| described by |span| as a
+// buffer aliasing the host memory backing the file. Returns NULL in
+// |out_buffer| if the entry cannot be imported and must be allocated and read
+// instead.
+static iree_status_t iree_io_parameter_index_provider_try_import(
+    iree_io_parameter_index_provider_t* provider, iree_hal_device_t* device,
+    iree_hal_buffer_params_t target_params,
+    const iree_io_parameter_index_entry_t* entry, iree_io_parameter_span_t span,
+    iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  if (entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+      span.buffer_offset != 0) {
+    return iree_ok_status();
+  }
+
+  // Try first to reuse the file backing store directly as a buffer. This only
+  // works with specific file types and with specific target usage. The most
+  // common cases for this are when using parameters as staging sources (so
+  // host memory is ok) or on unified memory systems (where host memory is
+  // device memory) and the file was originally mapped or the provider was
+  // asked to map files.
+  iree_io_file_handle_t* handle = entry->storage.file.handle;
+  uint64_t file_offset = entry->storage.file.offset + span.parameter_offset;
+  iree_byte_span_t contents = iree_byte_span_empty();
+  iree_hal_buffer_release_callback_t release_callback =
+      iree_hal_buffer_release_callback_null();
+  iree_io_file_mapping_t* mapping = NULL;
+  switch (iree_io_file_handle_type(handle)) {
+    case IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION: {
+      contents = iree_io_file_handle_primitive(handle).value.host_allocation;
+      release_callback.fn = iree_io_file_handle_buffer_release;
+      release_callback.user_data = handle;
+      break;
+    }
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+      if (!iree_all_bits_set(provider->flags,
+                             IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES)) {
+        return iree_ok_status();
+      }
+      // Mappings are read-only and shared with every other process mapping
+      // the file so the buffers must not be writable.
+      if (iree_any_bit_set(target_params.access,
+                           IREE_HAL_MEMORY_ACCESS_WRITE |
+                               IREE_HAL_MEMORY_ACCESS_DISCARD)) {
+        return iree_ok_status();
+      }
+      target_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+      // The mapping is page aligned so the parameter must be aligned in the
+      // file to be importable; avoid mapping files if it never would be.
+      if (!iree_host_size_has_alignment((iree_host_size_t)file_offset,
+                                        IREE_HAL_HEAP_BUFFER_ALIGNMENT)) {
+        return iree_ok_status();
+      }
+      IREE_RETURN_IF_ERROR(iree_io_parameter_index_provider_map_file(
+          provider, handle, &mapping));
+      if (!mapping) return iree_ok_status();
+      contents = iree_io_file_mapping_contents_rw(mapping);
+      release_callback.fn = iree_io_file_mapping_buffer_release;
+      release_callback.user_data = mapping;
+      break;
+    }
+    default:
+      return iree_ok_status();
+  }
+  if (file_offset > contents.data_length ||
+      span.length > contents.data_length - file_offset) {
+    iree_io_file_mapping_release(mapping);
+    return iree_ok_status();
+  }
+
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = span.length,
+      .handle =
+          {
+              .host_allocation =
+                  {
+                      .ptr = contents.data + file_offset,
+                  },
+          },
+  };
+  if (!mapping) iree_io_file_handle_retain(handle);
+  iree_status_t import_status = iree_hal_allocator_import_buffer(
+      iree_hal_device_allocator(device), target_params, &external_buffer,
+      release_callback, out_buffer);
+  if (!iree_status_is_ok(import_status)) {
+    // Failed to import - that's ok as we'll just do the full allocate + read.
+    iree_status_ignore(import_status);
+    if (mapping) {
+      iree_io_file_mapping_release(mapping);
+    } else {
+      iree_io_file_handle_release(handle);
+    }
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_io_parameter_index_provider_load(
     iree_io_parameter_provider_t* base_provider, iree_hal_device_t* device,
     iree_hal_queue_affinity_t queue_affinity,
@@ -725,52 +1399,13 @@ static iree_status_t iree_io_parameter_index_provider_load(
     // extremely expensive driver handling. Startup paths with parameters aren't
     // usually critical, though, so it's (probably) fine today as-is.
 
-    // Try first to reuse the file backing store directly as a buffer. This only
-    // works with specific file types and with specific target usage. The most
-    // common cases for this are when using parameters as staging sources (so
-    // host memory is ok) or on unified memory systems (where host memory is
-    // device memory) and the file was originally mapped. We could extend the
-    // conditions in which we use this with some better file handle helpers that
-    // allow us to map files that we already have open via other mechanisms
-    // (FILE, fd, etc).
+    // Try first to reuse the file backing store directly as a buffer.
     iree_hal_buffer_t* target_buffer = NULL;
-    if (iree_status_is_ok(status) &&
-        source_entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE &&
-        iree_io_file_handle_type(source_entry->storage.file.handle) ==
-            IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-      iree_byte_span_t host_allocation =
-          iree_io_file_handle_primitive(source_entry->storage.file.handle)
-              .value.host_allocation;
-      iree_hal_external_buffer_t external_buffer = {
-          .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
-          .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
-          .size = host_allocation.data_length,
-          .handle =
-              {
-                  .host_allocation =
-                      {
-                          .ptr = host_allocation.data +
-                                 source_entry->storage.file.offset,
-                      },
-              },
-      };
-      iree_hal_buffer_release_callback_t release_callback = {
-          .fn = iree_io_file_handle_buffer_release,
-          .user_data = source_entry->storage.file.handle,
-      };
-      iree_io_file_handle_retain(source_entry->storage.file.handle);
-      iree_status_t import_status = iree_hal_allocator_import_buffer(
-          iree_hal_device_allocator(device), target_params, &external_buffer,
-          release_callback, &target_buffer);
-      if (iree_status_is_ok(import_status)) {
-        // Import succeeded - issue a barrier to preserve the async timeline.
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_index_provider_try_import(
+          provider, device, target_params, source_entry, span, &target_buffer);
+      if (target_buffer) {
         IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import succeeded");
-      } else {
-        // Failed to import - that's ok as we'll just do the full allocate +
-        // read.
-        IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import failed");
-        import_status = iree_status_ignore(import_status);
-        iree_io_file_handle_release(source_entry->storage.file.handle);
       }
     }
 
@@ -778,9 +1413,10 @@ static iree_status_t iree_io_parameter_index_provider_load(
     if (iree_status_is_ok(status) && !target_buffer) {
       // Enqueue an allocation of the target buffer on a timeline.
       // The next operation we enqueue will go on the same timeline.
+      iree_io_parameter_op_timepoint_t alloca_timepoint;
       status = iree_io_parameter_op_batch_enqueue_alloca(
           &batch, IREE_HAL_ALLOCATOR_POOL_DEFAULT, target_params, span.length,
-          &target_buffer);
+          &target_buffer, &alloca_timepoint);
 
       // Enqueue the operation on the same timeline as the allocation.
       if (iree_status_is_ok(status)) {
@@ -801,6 +1437,14 @@ static iree_status_t iree_io_parameter_index_provider_load(
                 target_buffer, span.buffer_offset, span.length, 0);
             break;
           }
+          case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+          case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM: {
+            IREE_ASSERT(!source_file);
+            status = iree_io_parameter_op_batch_enqueue_decode(
+                &batch, source_entry, span.parameter_offset, target_buffer,
+                span.buffer_offset, span.length, &alloca_timepoint);
+            break;
+          }
           default: {
             status = iree_make_status(
                 IREE_STATUS_FAILED_PRECONDITION,
@@ -891,6 +1535,14 @@ static iree_status_t iree_io_parameter_index_provider_gather(
               target_buffer, span.buffer_offset, span.length, 0);
           break;
         }
+        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM: {
+          IREE_ASSERT(!source_file);
+          status = iree_io_parameter_op_batch_enqueue_decode(
+              &batch, source_entry, span.parameter_offset, target_buffer,
+              span.buffer_offset, span.length, /*dependency=*/NULL);
+          break;
+        }
         default: {
           status = iree_make_status(
               IREE_STATUS_FAILED_PRECONDITION,
@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/io/parameter_index.h"
+#include "iree/io/parameter_profile.h"
 #include "iree/io/parameter_provider.h"
 
 #ifdef __cplusplus
@@ -21,6 +22,22 @@ extern "C" {
 // Reasonable default for the `max_concurrent_operations` parameter.
 #define IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS 16
 
+// Flags controlling parameter index provider behavior.
+typedef uint32_t iree_io_parameter_index_provider_flags_t;
+enum iree_io_parameter_index_provider_flag_bits_t {
+  IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_NONE = 0u,
+  // Loads of parameters stored in platform files (fds, etc) map the files into
+  // host memory with shared read-only mappings and import the parameter ranges
+  // directly as buffers when the device allocator supports importing host
+  // allocations. Processes mapping the same file share the same page cache
+  // pages and loads complete without reading any parameter data. Parameters
+  // that are not suitably aligned, devices that cannot import host memory, and
+  // files that cannot be mapped fall back to allocating and reading.
+  //
+  // Loaded buffers only allow read access.
+  IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES = 1u << 0,
+};
+
 // Creates a parameter provider serving from the provided |index|.
 // As parameters are operated on their files will be registered with the devices
 // they are used on and cached for future requests.
@@ -35,6 +52,21 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider);
 
+// Creates a parameter provider serving from the provided |index| as with
+// iree_io_parameter_index_provider_create with the behavior controlled by
+// |flags|.
+//
+// If an optional |profile| is provided it is retained and the first access of
+// each parameter is recorded in it so that a future run can prefetch parameters
+// in the order they are used.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_flags(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    iree_io_parameter_index_provider_flags_t flags,
+    iree_host_size_t max_concurrent_operations,
+    iree_io_parameter_profile_t* profile, iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,525 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_index_provider.h"
+
+#include "iree/base/api.h"
+
+#if IREE_FILE_IO_ENABLE
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/io/compression.h"
+#include "iree/io/file_contents.h"
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+using ::testing::ContainerEq;
+
+//===----------------------------------------------------------------------===//
+// Import tracking allocator
+//===----------------------------------------------------------------------===//
+
+// Heap allocator wrapper that records imports and optionally rejects them.
+struct TestAllocator {
+  iree_hal_resource_t resource;
+  iree_hal_allocator_t* base_allocator;
+  bool reject_imports;
+  int import_count;
+  iree_device_size_t import_size;
+  void* import_ptr;
+};
+
+static TestAllocator* TestAllocatorCast(iree_hal_allocator_t* allocator) {
+  return (TestAllocator*)allocator;
+}
+
+static void TestAllocatorDestroy(iree_hal_allocator_t* allocator) {
+  TestAllocator* test_allocator = TestAllocatorCast(allocator);
+  iree_hal_allocator_release(test_allocator->base_allocator);
+  delete test_allocator;
+}
+
+static iree_allocator_t TestAllocatorHostAllocator(
+    const iree_hal_allocator_t* allocator) {
+  return iree_allocator_system();
+}
+
+static iree_status_t TestAllocatorTrim(iree_hal_allocator_t* allocator) {
+  return iree_hal_allocator_trim(TestAllocatorCast(allocator)->base_allocator);
+}
+
+static void TestAllocatorQueryStatistics(
+    iree_hal_allocator_t* allocator,
+    iree_hal_allocator_statistics_t* out_statistics) {
+  iree_hal_allocator_query_statistics(
+      TestAllocatorCast(allocator)->base_allocator, out_statistics);
+}
+
+static iree_status_t TestAllocatorQueryMemoryHeaps(
+    iree_hal_allocator_t* allocator, iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* heaps, iree_host_size_t* out_count) {
+  return iree_hal_allocator_query_memory_heaps(
+      TestAllocatorCast(allocator)->base_allocator, capacity, heaps,
+      out_count);
+}
+
+static iree_hal_buffer_compatibility_t TestAllocatorQueryBufferCompatibility(
+    iree_hal_allocator_t* allocator, iree_hal_buffer_params_t* params,
+    iree_device_size_t* allocation_size) {
+  return iree_hal_allocator_query_buffer_compatibility(
+      TestAllocatorCast(allocator)->base_allocator, *params, *allocation_size,
+      params, allocation_size);
+}
+
+static iree_status_t TestAllocatorAllocateBuffer(
+    iree_hal_allocator_t* allocator, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer) {
+  return iree_hal_allocator_allocate_buffer(
+      TestAllocatorCast(allocator)->base_allocator, *params, allocation_size,
+      out_buffer);
+}
+
+static void TestAllocatorDeallocateBuffer(iree_hal_allocator_t* allocator,
+                                          iree_hal_buffer_t* buffer) {
+  // No-op; buffers are never pointed back at us for deallocation.
+}
+
+static iree_status_t TestAllocatorImportBuffer(
+    iree_hal_allocator_t* allocator, const iree_hal_buffer_params_t* params,
+    iree_hal_external_buffer_t* external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** out_buffer) {
+  TestAllocator* test_allocator = TestAllocatorCast(allocator);
+  ++test_allocator->import_count;
+  test_allocator->import_size = external_buffer->size;
+  test_allocator->import_ptr = external_buffer->handle.host_allocation.ptr;
+  if (test_allocator->reject_imports) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE, "imports rejected");
+  }
+  return iree_hal_allocator_import_buffer(test_allocator->base_allocator,
+                                          *params, external_buffer,
+                                          release_callback, out_buffer);
+}
+
+static iree_status_t TestAllocatorExportBuffer(
+    iree_hal_allocator_t* allocator, iree_hal_buffer_t* buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* out_external_buffer) {
+  return iree_hal_allocator_export_buffer(
+      TestAllocatorCast(allocator)->base_allocator, buffer, requested_type,
+      requested_flags, out_external_buffer);
+}
+
+static const iree_hal_allocator_vtable_t kTestAllocatorVtable = [] {
+  iree_hal_allocator_vtable_t vtable = {};
+  vtable.destroy = TestAllocatorDestroy;
+  vtable.host_allocator = TestAllocatorHostAllocator;
+  vtable.trim = TestAllocatorTrim;
+  vtable.query_statistics = TestAllocatorQueryStatistics;
+  vtable.query_memory_heaps = TestAllocatorQueryMemoryHeaps;
+  vtable.query_buffer_compatibility = TestAllocatorQueryBufferCompatibility;
+  vtable.allocate_buffer = TestAllocatorAllocateBuffer;
+  vtable.deallocate_buffer = TestAllocatorDeallocateBuffer;
+  vtable.import_buffer = TestAllocatorImportBuffer;
+  vtable.export_buffer = TestAllocatorExportBuffer;
+  return vtable;
+}();
+
+//===----------------------------------------------------------------------===//
+// ParameterIndexProviderTest
+//===----------------------------------------------------------------------===//
+
+static std::string GetUniquePath(const char* unique_name) {
+  const char* test_tmpdir = getenv("TEST_TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+  if (!test_tmpdir) test_tmpdir = getenv("TEMP");
+  if (!test_tmpdir) test_tmpdir = "/tmp";
+  std::random_device d;
+  uint64_t random = (static_cast<uint64_t>(d()) << 32) | d();
+  char unique_path[256];
+  snprintf(unique_path, sizeof unique_path, "%s/iree_test_%" PRIx64 "_%s",
+           test_tmpdir, random, unique_name);
+  return unique_path;
+}
+
+class ParameterIndexProviderTest : public ::testing::Test {
+ protected:
+  // Parameters live at page-aligned offsets within a file large enough that
+  // their ranges never cover the whole file.
+  static constexpr uint64_t kFileLength = 4 * 4096;
+  static constexpr uint64_t kParameterLength = 1000;
+
+  void SetUp() override {
+    allocator_ = new TestAllocator();
+    iree_hal_resource_initialize(&kTestAllocatorVtable, &allocator_->resource);
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        IREE_SV("test"), iree_allocator_system(), iree_allocator_system(),
+        &allocator_->base_allocator));
+
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_sync_device_create(
+        IREE_SV("local-sync"), &params, /*loader_count=*/0, /*loaders=*/NULL,
+        (iree_hal_allocator_t*)allocator_, iree_allocator_system(), &device_));
+
+    contents_.resize(kFileLength);
+    for (size_t i = 0; i < contents_.size(); ++i) {
+      contents_[i] = static_cast<uint8_t>((i * 31) ^ (i >> 8));
+    }
+    path_ = GetUniquePath("parameter_index_provider_test.bin");
+    IREE_ASSERT_OK(iree_io_file_contents_write(
+        iree_make_string_view(path_.data(), path_.size()),
+        iree_make_const_byte_span(contents_.data(), contents_.size()),
+        iree_allocator_system()));
+    IREE_ASSERT_OK(iree_io_file_handle_open(
+        IREE_IO_FILE_MODE_READ,
+        iree_make_string_view(path_.data(), path_.size()),
+        iree_allocator_system(), &file_handle_));
+    ASSERT_EQ(iree_io_file_handle_type(file_handle_),
+              IREE_IO_FILE_HANDLE_TYPE_FD);
+
+    IREE_ASSERT_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), &index_));
+  }
+
+  void TearDown() override {
+    iree_io_parameter_provider_release(provider_);
+    iree_io_parameter_index_release(index_);
+    iree_io_file_handle_release(file_handle_);
+    if (!path_.empty()) remove(path_.c_str());
+    iree_hal_device_release(device_);
+    iree_hal_allocator_release((iree_hal_allocator_t*)allocator_);
+  }
+
+  // Adds a parameter |key| backed by the file at |offset|.
+  void AddParameter(const char* key, uint64_t offset) {
+    iree_io_parameter_index_entry_t entry = {};
+    entry.key = iree_make_cstring_view(key);
+    entry.metadata = iree_const_byte_span_empty();
+    entry.length = kParameterLength;
+    entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+    entry.storage.file.handle = file_handle_;
+    entry.storage.file.offset = offset;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(index_, &entry));
+  }
+
+  // Adds a parameter |key| stored as |kBlockSize| blocks in the file at
+  // |offset|. The blocks are stored uncompressed so that the decoded contents
+  // match the file range.
+  void AddCompressedParameter(const char* key, uint64_t offset) {
+    static constexpr uint32_t kBlockSize = 256;
+    std::vector<uint64_t> block_offsets;
+    for (uint64_t block_offset = 0; block_offset < kParameterLength;
+         block_offset += kBlockSize) {
+      block_offsets.push_back(block_offset);
+    }
+    block_offsets.push_back(kParameterLength);
+    iree_io_parameter_index_entry_t entry = {};
+    entry.key = iree_make_cstring_view(key);
+    entry.metadata = iree_const_byte_span_empty();
+    entry.length = kParameterLength;
+    entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED;
+    entry.storage.compressed.handle = file_handle_;
+    entry.storage.compressed.offset = offset;
+    entry.storage.compressed.length = kParameterLength;
+    entry.storage.compressed.blocks.type = IREE_IO_COMPRESSION_TYPE_LZ4;
+    entry.storage.compressed.blocks.block_size = kBlockSize;
+    entry.storage.compressed.blocks.length = kParameterLength;
+    entry.storage.compressed.blocks.block_count = block_offsets.size() - 1;
+    entry.storage.compressed.blocks.block_offsets = block_offsets.data();
+    IREE_ASSERT_OK(iree_io_parameter_index_add(index_, &entry));
+  }
+
+  void CreateProvider(iree_io_parameter_index_provider_flags_t flags) {
+    IREE_ASSERT_OK(iree_io_parameter_index_provider_create_with_flags(
+        IREE_SV("model"), index_, flags,
+        IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
+        /*profile=*/NULL, iree_allocator_system(), &provider_));
+  }
+
+  // Returns load parameters. Loads from the parameters module leave |access|
+  // unspecified (IREE_HAL_MEMORY_ACCESS_NONE) so that providers may return
+  // read-only buffers.
+  static iree_hal_buffer_params_t MakeParams(
+      iree_hal_memory_access_t access) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.access = access;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    return params;
+  }
+
+  static iree_status_t Enumerate(void* user_data, iree_host_size_t i,
+                                 iree_string_view_t* out_key,
+                                 iree_io_parameter_span_t* out_span) {
+    *out_key = iree_make_cstring_view((const char*)user_data);
+    out_span->parameter_offset = 0;
+    out_span->buffer_offset = 0;
+    out_span->length = kParameterLength;
+    return iree_ok_status();
+  }
+
+  static iree_status_t Emit(void* user_data, iree_host_size_t i,
+                            iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_retain(buffer);
+    *(iree_hal_buffer_t**)user_data = buffer;
+    return iree_ok_status();
+  }
+
+  // Loads parameter |key| with |params| and waits for it to be available.
+  iree_hal_buffer_t* Load(const char* key, iree_hal_buffer_params_t params) {
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_CHECK_OK(iree_hal_semaphore_create(device_,
+                                            IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+                                            IREE_HAL_SEMAPHORE_FLAG_DEFAULT,
+                                            &semaphore));
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+    iree_io_parameter_enumerator_t enumerator = {Enumerate, (void*)key};
+    iree_hal_buffer_t* buffer = NULL;
+    iree_io_parameter_emitter_t emitter = {Emit, &buffer};
+    IREE_CHECK_OK(iree_io_parameter_provider_load(
+        provider_, device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+        iree_hal_semaphore_list_empty(), signal_list, IREE_SV("model"), params,
+        /*count=*/1, enumerator, emitter));
+    IREE_CHECK_OK(iree_hal_semaphore_wait(semaphore, signal_value,
+                                          iree_infinite_timeout(),
+                                          IREE_HAL_WAIT_FLAG_DEFAULT));
+    iree_hal_semaphore_release(semaphore);
+    return buffer;
+  }
+
+  // Loads parameter |key| after |wait_semaphore| reaches 1 and returns the
+  // status the load signals with.
+  iree_status_t LoadAfter(const char* key, iree_hal_semaphore_t* wait_semaphore,
+                          iree_hal_buffer_t** out_buffer) {
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+        IREE_HAL_SEMAPHORE_FLAG_DEFAULT, &semaphore));
+    uint64_t wait_value = 1ull;
+    iree_hal_semaphore_list_t wait_list = {1, &wait_semaphore, &wait_value};
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_list = {1, &semaphore, &signal_value};
+    iree_io_parameter_enumerator_t enumerator = {Enumerate, (void*)key};
+    iree_io_parameter_emitter_t emitter = {Emit, out_buffer};
+    iree_status_t status = iree_io_parameter_provider_load(
+        provider_, device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list,
+        signal_list, IREE_SV("model"),
+        MakeParams(IREE_HAL_MEMORY_ACCESS_NONE), /*count=*/1, enumerator,
+        emitter);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_semaphore_wait(semaphore, signal_value,
+                                       iree_make_timeout_ms(10000),
+                                       IREE_HAL_WAIT_FLAG_DEFAULT);
+    }
+    iree_hal_semaphore_release(semaphore);
+    return status;
+  }
+
+  std::vector<uint8_t> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::vector<uint8_t> data(iree_hal_buffer_byte_length(buffer));
+    IREE_CHECK_OK(iree_hal_buffer_map_read(buffer, 0, data.data(),
+                                           data.size()));
+    return data;
+  }
+
+  std::vector<uint8_t> FileRange(uint64_t offset) {
+    return std::vector<uint8_t>(contents_.begin() + offset,
+                                contents_.begin() + offset + kParameterLength);
+  }
+
+  TestAllocator* allocator_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  std::vector<uint8_t> contents_;
+  std::string path_;
+  iree_io_file_handle_t* file_handle_ = NULL;
+  iree_io_parameter_index_t* index_ = NULL;
+  iree_io_parameter_provider_t* provider_ = NULL;
+};
+
+// Tests that without MAP_FILES file-backed parameters are always read.
+TEST_F(ParameterIndexProviderTest, DefaultDoesNotImport) {
+  AddParameter("a", 4096);
+  IREE_ASSERT_OK(iree_io_parameter_index_provider_create(
+      IREE_SV("model"), index_,
+      IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
+      iree_allocator_system(), &provider_));
+
+  iree_hal_buffer_t* buffer =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(allocator_->import_count, 0);
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(FileRange(4096)));
+  iree_hal_buffer_release(buffer);
+}
+
+// Tests that an aligned read-only load imports a buffer aliasing only the
+// parameter range of the mapped file.
+TEST_F(ParameterIndexProviderTest, MapFilesImportsParameterRange) {
+  AddParameter("a", 4096);
+  const uint64_t offset_b = 2 * 4096 + IREE_HAL_HEAP_BUFFER_ALIGNMENT;
+  AddParameter("b", offset_b);
+  CreateProvider(IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES);
+
+  iree_hal_buffer_t* buffer_a =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer_a, nullptr);
+  EXPECT_EQ(allocator_->import_count, 1);
+  EXPECT_EQ(allocator_->import_size, kParameterLength);
+  uint8_t* import_ptr_a = (uint8_t*)allocator_->import_ptr;
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer_a), kParameterLength);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(
+                iree_hal_buffer_allocated_buffer(buffer_a)),
+            kParameterLength);
+  EXPECT_EQ(iree_hal_buffer_allowed_access(buffer_a),
+            IREE_HAL_MEMORY_ACCESS_READ);
+  EXPECT_THAT(ReadBuffer(buffer_a), ContainerEq(FileRange(4096)));
+
+  // Both parameters alias the same shared mapping of the file.
+  iree_hal_buffer_t* buffer_b =
+      Load("b", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer_b, nullptr);
+  EXPECT_EQ(allocator_->import_count, 2);
+  EXPECT_EQ(allocator_->import_size, kParameterLength);
+  EXPECT_EQ((uint8_t*)allocator_->import_ptr - import_ptr_a,
+            offset_b - 4096);
+  EXPECT_EQ(iree_hal_buffer_allocation_size(
+                iree_hal_buffer_allocated_buffer(buffer_b)),
+            kParameterLength);
+  EXPECT_THAT(ReadBuffer(buffer_b), ContainerEq(FileRange(offset_b)));
+
+  // The mapping must remain live while buffers reference it even if the
+  // provider trims its cache.
+  IREE_ASSERT_OK(iree_io_parameter_provider_notify(
+      provider_, IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY));
+  iree_io_parameter_provider_release(provider_);
+  provider_ = NULL;
+  EXPECT_THAT(ReadBuffer(buffer_a), ContainerEq(FileRange(4096)));
+
+  iree_hal_buffer_release(buffer_b);
+  iree_hal_buffer_release(buffer_a);
+}
+
+// Tests that loads requesting write access are read into new allocations as
+// the shared mappings are read-only.
+TEST_F(ParameterIndexProviderTest, MapFilesWriteAccessFallsBackToRead) {
+  AddParameter("a", 4096);
+  CreateProvider(IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES);
+
+  iree_hal_buffer_t* buffer =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_ALL));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(allocator_->import_count, 0);
+  EXPECT_TRUE(iree_all_bits_set(iree_hal_buffer_allowed_access(buffer),
+                                IREE_HAL_MEMORY_ACCESS_WRITE));
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(FileRange(4096)));
+
+  // Writes must not be visible in the file or to other loads.
+  const uint8_t pattern = 0xCD;
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer, 0, IREE_HAL_WHOLE_BUFFER,
+                                          &pattern, sizeof(pattern)));
+  iree_hal_buffer_t* other_buffer =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(other_buffer, nullptr);
+  EXPECT_THAT(ReadBuffer(other_buffer), ContainerEq(FileRange(4096)));
+
+  iree_hal_buffer_release(other_buffer);
+  iree_hal_buffer_release(buffer);
+}
+
+// Tests that parameters not aligned in the file are read into new allocations.
+TEST_F(ParameterIndexProviderTest, MapFilesMisalignedOffsetFallsBackToRead) {
+  AddParameter("a", 4096 + 1);
+  CreateProvider(IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES);
+
+  iree_hal_buffer_t* buffer =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(allocator_->import_count, 0);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), kParameterLength);
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(FileRange(4096 + 1)));
+  iree_hal_buffer_release(buffer);
+}
+
+// Tests that parameters are read into new allocations when the device
+// allocator rejects the import.
+TEST_F(ParameterIndexProviderTest, MapFilesImportRejectedFallsBackToRead) {
+  allocator_->reject_imports = true;
+  AddParameter("a", 4096);
+  CreateProvider(IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES);
+
+  iree_hal_buffer_t* buffer =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(allocator_->import_count, 1);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), kParameterLength);
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(FileRange(4096)));
+  iree_hal_buffer_release(buffer);
+}
+
+// Tests that compressed parameters are decoded from the blocks covering them.
+TEST_F(ParameterIndexProviderTest, DecodesCompressedParameter) {
+  AddCompressedParameter("a", 4096);
+  CreateProvider(IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_NONE);
+
+  iree_hal_buffer_t* buffer =
+      Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(iree_hal_buffer_byte_length(buffer), kParameterLength);
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(FileRange(4096)));
+  iree_hal_buffer_release(buffer);
+}
+
+// Tests that decode calls that are never issued because their waits fail do
+// not leak the buffers and index they reference.
+TEST_F(ParameterIndexProviderTest, DecodeAbandonedOnFailedWait) {
+  AddCompressedParameter("a", 4096);
+  CreateProvider(IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_NONE);
+
+  iree_hal_semaphore_t* wait_semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, 0ull,
+      IREE_HAL_SEMAPHORE_FLAG_DEFAULT, &wait_semaphore));
+  iree_hal_semaphore_fail(wait_semaphore,
+                          iree_make_status(IREE_STATUS_CANCELLED));
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = LoadAfter("a", wait_semaphore, &buffer);
+  EXPECT_FALSE(iree_status_is_ok(status));
+  iree_status_ignore(status);
+  iree_hal_buffer_release(buffer);
+  iree_hal_semaphore_release(wait_semaphore);
+
+  // Later loads reclaim the abandoned call and still decode.
+  buffer = Load("a", MakeParams(IREE_HAL_MEMORY_ACCESS_NONE));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_THAT(ReadBuffer(buffer), ContainerEq(FileRange(4096)));
+  iree_hal_buffer_release(buffer);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
+
+#endif  // IREE_FILE_IO_ENABLE
@@ -0,0 +1,191 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_index.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+static iree_status_t AddSplat(iree_io_parameter_index_t* index,
+                              const std::string& key, uint64_t length) {
+  iree_io_parameter_index_entry_t entry = {};
+  entry.key = iree_make_string_view(key.data(), key.size());
+  entry.metadata = iree_const_byte_span_empty();
+  entry.length = length;
+  entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT;
+  return iree_io_parameter_index_add(index, &entry);
+}
+
+TEST(ParameterIndexTest, LookupMissing) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  EXPECT_THAT(Status(iree_io_parameter_index_lookup(index, IREE_SV("a"),
+                                                    &entry)),
+              StatusIs(StatusCode::kNotFound));
+  IREE_ASSERT_OK(AddSplat(index, "a", 1));
+  EXPECT_THAT(Status(iree_io_parameter_index_lookup(index, IREE_SV("b"),
+                                                    &entry)),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_EQ(entry, nullptr);
+  iree_io_parameter_index_release(index);
+}
+
+// Tests that lookups resolve across growth of the index and that entries are
+// still enumerated in insertion order.
+TEST(ParameterIndexTest, LookupMany) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  static constexpr int kEntryCount = 5000;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kEntryCount; ++i) {
+    keys.push_back("layer." + std::to_string(i) + ".weight");
+    IREE_ASSERT_OK(AddSplat(index, keys.back(), i));
+  }
+  ASSERT_EQ(iree_io_parameter_index_count(index), kEntryCount);
+  for (int i = kEntryCount - 1; i >= 0; --i) {
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_lookup(
+        index, iree_make_string_view(keys[i].data(), keys[i].size()),
+        &entry));
+    EXPECT_EQ(entry->length, i);
+  }
+  for (int i = 0; i < kEntryCount; ++i) {
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(index, i, &entry));
+    EXPECT_TRUE(iree_string_view_equal(
+        entry->key, iree_make_string_view(keys[i].data(), keys[i].size())));
+  }
+  iree_io_parameter_index_release(index);
+}
+
+// Tests that when a key is added multiple times the first entry is returned,
+// including after the index has been rehashed by a reservation.
+TEST(ParameterIndexTest, DuplicateKeys) {
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &index));
+  IREE_ASSERT_OK(AddSplat(index, "dup", 1));
+  IREE_ASSERT_OK(AddSplat(index, "other", 2));
+  IREE_ASSERT_OK(AddSplat(index, "dup", 3));
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(index, IREE_SV("dup"), &entry));
+  EXPECT_EQ(entry->length, 1);
+  IREE_ASSERT_OK(iree_io_parameter_index_reserve(index, 1024));
+  IREE_ASSERT_OK(iree_io_parameter_index_lookup(index, IREE_SV("dup"), &entry));
+  EXPECT_EQ(entry->length, 1);
+  iree_io_parameter_index_release(index);
+}
+
+struct LazyPopulator {
+  int populate_count = 0;
+  int release_count = 0;
+  iree_status_code_t failure = IREE_STATUS_OK;
+
+  iree_io_parameter_index_populator_t Get() {
+    iree_io_parameter_index_populator_t populator;
+    populator.fn = Populate;
+    populator.release = Release;
+    populator.user_data = this;
+    return populator;
+  }
+
+  static iree_status_t Populate(void* user_data,
+                                iree_io_parameter_index_t* index) {
+    auto* populator = (LazyPopulator*)user_data;
+    ++populator->populate_count;
+    IREE_RETURN_IF_ERROR(AddSplat(index, "lazy", 2));
+    if (populator->failure != IREE_STATUS_OK) {
+      return iree_make_status(populator->failure, "populate failed");
+    }
+    return AddSplat(index, "lazy2", 3);
+  }
+
+  static void Release(void* user_data) {
+    ++((LazyPopulator*)user_data)->release_count;
+  }
+};
+
+// Tests that lazy indices are populated once on first query and that entries
+// added before population precede the populated ones.
+TEST(ParameterIndexTest, LazyPopulation) {
+  LazyPopulator populator;
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_create_lazy(
+      populator.Get(), iree_allocator_system(), &index));
+  IREE_ASSERT_OK(AddSplat(index, "eager", 1));
+  EXPECT_EQ(populator.populate_count, 0);
+
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_lookup(index, IREE_SV("lazy2"), &entry));
+  EXPECT_EQ(entry->length, 3);
+  EXPECT_EQ(populator.populate_count, 1);
+  ASSERT_EQ(iree_io_parameter_index_count(index), 3);
+  IREE_ASSERT_OK(iree_io_parameter_index_get(index, 0, &entry));
+  EXPECT_TRUE(iree_string_view_equal(entry->key, IREE_SV("eager")));
+  IREE_ASSERT_OK(iree_io_parameter_index_get(index, 1, &entry));
+  EXPECT_TRUE(iree_string_view_equal(entry->key, IREE_SV("lazy")));
+  EXPECT_EQ(populator.populate_count, 1);
+
+  EXPECT_EQ(populator.release_count, 0);
+  iree_io_parameter_index_release(index);
+  EXPECT_EQ(populator.release_count, 1);
+}
+
+// Tests that population failures are returned from all queries.
+TEST(ParameterIndexTest, LazyPopulationFailure) {
+  LazyPopulator populator;
+  populator.failure = IREE_STATUS_DATA_LOSS;
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_create_lazy(
+      populator.Get(), iree_allocator_system(), &index));
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  EXPECT_THAT(Status(iree_io_parameter_index_lookup(index, IREE_SV("lazy"),
+                                                    &entry)),
+              StatusIs(StatusCode::kDataLoss));
+  EXPECT_THAT(Status(iree_io_parameter_index_get(index, 0, &entry)),
+              StatusIs(StatusCode::kDataLoss));
+  EXPECT_EQ(iree_io_parameter_index_count(index), 0);
+  EXPECT_EQ(populator.populate_count, 1);
+  iree_io_parameter_index_release(index);
+  EXPECT_EQ(populator.release_count, 1);
+}
+
+// Tests that concurrent first queries wait for a single population.
+TEST(ParameterIndexTest, LazyPopulationConcurrent) {
+  LazyPopulator populator;
+  iree_io_parameter_index_t* index = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_create_lazy(
+      populator.Get(), iree_allocator_system(), &index));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([index]() {
+      const iree_io_parameter_index_entry_t* entry = NULL;
+      IREE_EXPECT_OK(
+          iree_io_parameter_index_lookup(index, IREE_SV("lazy2"), &entry));
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(populator.populate_count, 1);
+  iree_io_parameter_index_release(index);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
@@ -0,0 +1,576 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_profile.h"
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+
+// Ranges of the same file separated by no more than this many bytes are
+// prefetched as one. Parameters are usually stored in order with only
+// alignment padding between them.
+#define IREE_IO_PARAMETER_PROFILE_PREFETCH_COALESCE_GAP 4096
+
+// A parameter recorded in the profile. The scope and key characters are stored
+// immediately following the struct.
+typedef struct iree_io_parameter_profile_entry_t {
+  // iree_io_parameter_profile_hash of |scope| and |key|.
+  uint64_t hash;
+  iree_string_view_t scope;
+  iree_string_view_t key;
+} iree_io_parameter_profile_entry_t;
+
+// Open-addressed (linear probing) hash table of recorded entries. Tables are
+// replaced when the profile grows but are only freed when the profile is
+// destroyed so that lookups can probe them without holding the mutex.
+typedef struct iree_io_parameter_profile_table_t {
+  // Table this one replaced, if any.
+  struct iree_io_parameter_profile_table_t* previous;
+  // Power of two kept at least twice the entry capacity of the profile so that
+  // probing always reaches an unused slot.
+  iree_host_size_t capacity;
+  // iree_io_parameter_profile_entry_t pointers or 0 for unused slots. Slots
+  // are set once with release semantics and never change afterward. Stored
+  // immediately following the struct.
+  iree_atomic_intptr_t* slots;
+} iree_io_parameter_profile_table_t;
+
+// A range of a file to prefetch.
+typedef struct iree_io_parameter_prefetch_range_t {
+  // File handle the range is in, retained.
+  iree_io_file_handle_t* handle;
+  uint64_t offset;
+  uint64_t length;
+} iree_io_parameter_prefetch_range_t;
+
+struct iree_io_parameter_profile_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+
+  // Optional stream that newly recorded entries are written to, retained.
+  iree_io_stream_t* output_stream;
+
+  // Guards the entries list, hash table updates, and output stream.
+  iree_slim_mutex_t mutex;
+
+  // Total capacity of the entries list in elements.
+  iree_host_size_t entry_capacity;
+  // Currently used entry count in elements.
+  iree_host_size_t entry_count;
+  // Dense list of entries in the order they were first accessed.
+  iree_io_parameter_profile_entry_t** entries;
+
+  // Current iree_io_parameter_profile_table_t of all entries or 0 if none have
+  // been recorded. Replaced with release semantics when grown.
+  iree_atomic_intptr_t table;
+
+  // Background thread issuing read-ahead of |prefetch_ranges| or NULL if no
+  // prefetch has been started.
+  iree_thread_t* prefetch_thread;
+  // Set when the profile is destroyed to stop the prefetch thread early.
+  iree_atomic_int32_t prefetch_cancelled;
+  // Ranges to prefetch in order.
+  iree_host_size_t prefetch_range_count;
+  iree_io_parameter_prefetch_range_t* prefetch_ranges;
+};
+
+// FNV-1a hash of |scope| and |key|.
+static uint64_t iree_io_parameter_profile_hash(iree_string_view_t scope,
+                                               iree_string_view_t key) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < scope.size; ++i) {
+    hash ^= (uint8_t)scope.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  // Separator so that `ab`/`c` and `a`/`bc` hash differently.
+  hash ^= 0xFFu;
+  hash *= 0x100000001B3ull;
+  for (iree_host_size_t i = 0; i < key.size; ++i) {
+    hash ^= (uint8_t)key.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Inserts |entry| into |table|. Must be called with the mutex held.
+static void iree_io_parameter_profile_table_insert_unsafe(
+    iree_io_parameter_profile_table_t* table,
+    iree_io_parameter_profile_entry_t* entry) {
+  const iree_host_size_t slot_mask = table->capacity - 1;
+  iree_host_size_t slot = (iree_host_size_t)entry->hash & slot_mask;
+  while (iree_atomic_load(&table->slots[slot], iree_memory_order_relaxed)) {
+    slot = (slot + 1) & slot_mask;
+  }
+  iree_atomic_store(&table->slots[slot], (intptr_t)entry,
+                    iree_memory_order_release);
+}
+
+// Returns true if an entry with |scope| and |key| is in |table|.
+// Safe to call without the mutex held.
+static bool iree_io_parameter_profile_table_contains(
+    iree_io_parameter_profile_table_t* table, uint64_t hash,
+    iree_string_view_t scope, iree_string_view_t key) {
+  if (!table) return false;
+  const iree_host_size_t slot_mask = table->capacity - 1;
+  iree_host_size_t slot = (iree_host_size_t)hash & slot_mask;
+  const iree_io_parameter_profile_entry_t* entry = NULL;
+  while ((entry = (const iree_io_parameter_profile_entry_t*)iree_atomic_load(
+              &table->slots[slot], iree_memory_order_acquire))) {
+    if (entry->hash == hash && iree_string_view_equal(scope, entry->scope) &&
+        iree_string_view_equal(key, entry->key)) {
+      return true;
+    }
+    slot = (slot + 1) & slot_mask;
+  }
+  return false;
+}
+
+// Grows the entries list and hash table to fit at least one more entry.
+static iree_status_t iree_io_parameter_profile_reserve_unsafe(
+    iree_io_parameter_profile_t* profile) {
+  if (profile->entry_count < profile->entry_capacity) return iree_ok_status();
+  const iree_host_size_t new_capacity =
+      iree_max(64, profile->entry_capacity * 2);
+
+  // Build the new hash table before publishing anything so that a failure
+  // leaves the profile unchanged.
+  const iree_host_size_t new_slot_capacity =
+      (iree_host_size_t)iree_math_round_up_to_pow2_u64(new_capacity * 2);
+  iree_io_parameter_profile_table_t* new_table = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      profile->host_allocator,
+      sizeof(*new_table) + new_slot_capacity * sizeof(new_table->slots[0]),
+      (void**)&new_table));
+  iree_status_t status = iree_allocator_realloc(
+      profile->host_allocator, new_capacity * sizeof(profile->entries[0]),
+      (void**)&profile->entries);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(profile->host_allocator, new_table);
+    return status;
+  }
+  profile->entry_capacity = new_capacity;
+
+  new_table->previous = (iree_io_parameter_profile_table_t*)iree_atomic_load(
+      &profile->table, iree_memory_order_relaxed);
+  new_table->capacity = new_slot_capacity;
+  new_table->slots = (iree_atomic_intptr_t*)((uint8_t*)new_table +
+                                             sizeof(*new_table));
+  for (iree_host_size_t i = 0; i < profile->entry_count; ++i) {
+    iree_io_parameter_profile_table_insert_unsafe(new_table,
+                                                  profile->entries[i]);
+  }
+  iree_atomic_store(&profile->table, (intptr_t)new_table,
+                    iree_memory_order_release);
+  return iree_ok_status();
+}
+
+// Returns true if |value| can be written to a serialized profile line.
+static bool iree_io_parameter_profile_is_serializable(
+    iree_string_view_t value) {
+  return iree_string_view_find_first_of(value, IREE_SV("\t\r\n"), 0) ==
+         IREE_STRING_VIEW_NPOS;
+}
+
+// Writes the line for |entry| to the profile output stream.
+static iree_status_t iree_io_parameter_profile_write_entry_unsafe(
+    iree_io_parameter_profile_t* profile,
+    const iree_io_parameter_profile_entry_t* entry) {
+  if (!iree_io_parameter_profile_is_serializable(entry->scope) ||
+      !iree_io_parameter_profile_is_serializable(entry->key)) {
+    return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(iree_io_stream_write(
+      profile->output_stream, entry->scope.size, entry->scope.data));
+  IREE_RETURN_IF_ERROR(iree_io_stream_write_char(profile->output_stream, '\t'));
+  IREE_RETURN_IF_ERROR(iree_io_stream_write(
+      profile->output_stream, entry->key.size, entry->key.data));
+  return iree_io_stream_write_char(profile->output_stream, '\n');
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_create(
+    iree_io_stream_t* output_stream, iree_allocator_t host_allocator,
+    iree_io_parameter_profile_t** out_profile) {
+  IREE_ASSERT_ARGUMENT(out_profile);
+  *out_profile = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*profile),
+                                (void**)&profile));
+  iree_atomic_ref_count_init(&profile->ref_count);
+  profile->host_allocator = host_allocator;
+  profile->output_stream = output_stream;
+  iree_io_stream_retain(output_stream);
+  iree_slim_mutex_initialize(&profile->mutex);
+
+  // Grown on first use.
+  profile->entry_capacity = 0;
+  profile->entry_count = 0;
+  profile->entries = NULL;
+  iree_atomic_store(&profile->table, 0, iree_memory_order_relaxed);
+
+  profile->prefetch_thread = NULL;
+  iree_atomic_store(&profile->prefetch_cancelled, 0, iree_memory_order_relaxed);
+  profile->prefetch_range_count = 0;
+  profile->prefetch_ranges = NULL;
+
+  *out_profile = profile;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Releases the handles retained by |ranges| and frees the list.
+static void iree_io_parameter_prefetch_ranges_free(
+    iree_host_size_t range_count, iree_io_parameter_prefetch_range_t* ranges,
+    iree_allocator_t host_allocator) {
+  for (iree_host_size_t i = 0; i < range_count; ++i) {
+    iree_io_file_handle_release(ranges[i].handle);
+  }
+  iree_allocator_free(host_allocator, ranges);
+}
+
+static void iree_io_parameter_profile_destroy(
+    iree_io_parameter_profile_t* profile) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = profile->host_allocator;
+
+  // Stop and join the prefetch thread (if any) before dropping the ranges it
+  // is walking.
+  iree_atomic_store(&profile->prefetch_cancelled, 1, iree_memory_order_release);
+  iree_thread_release(profile->prefetch_thread);
+  iree_io_parameter_prefetch_ranges_free(profile->prefetch_range_count,
+                                         profile->prefetch_ranges,
+                                         host_allocator);
+
+  for (iree_host_size_t i = 0; i < profile->entry_count; ++i) {
+    iree_allocator_free(host_allocator, profile->entries[i]);
+  }
+  iree_allocator_free(host_allocator, profile->entries);
+  iree_io_parameter_profile_table_t* table =
+      (iree_io_parameter_profile_table_t*)iree_atomic_load(
+          &profile->table, iree_memory_order_acquire);
+  while (table) {
+    iree_io_parameter_profile_table_t* previous = table->previous;
+    iree_allocator_free(host_allocator, table);
+    table = previous;
+  }
+  iree_slim_mutex_deinitialize(&profile->mutex);
+  iree_io_stream_release(profile->output_stream);
+
+  iree_allocator_free(host_allocator, profile);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_io_parameter_profile_retain(
+    iree_io_parameter_profile_t* profile) {
+  if (IREE_LIKELY(profile)) {
+    iree_atomic_ref_count_inc(&profile->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_io_parameter_profile_release(
+    iree_io_parameter_profile_t* profile) {
+  if (IREE_LIKELY(profile) &&
+      iree_atomic_ref_count_dec(&profile->ref_count) == 1) {
+    iree_io_parameter_profile_destroy(profile);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_record(
+    iree_io_parameter_profile_t* profile, iree_string_view_t scope,
+    iree_string_view_t key) {
+  IREE_ASSERT_ARGUMENT(profile);
+  const uint64_t hash = iree_io_parameter_profile_hash(scope, key);
+
+  // Fast path for parameters already recorded. This is the common case as
+  // parameters are accessed repeatedly and it does not take the mutex.
+  if (iree_io_parameter_profile_table_contains(
+          (iree_io_parameter_profile_table_t*)iree_atomic_load(
+              &profile->table, iree_memory_order_acquire),
+          hash, scope, key)) {
+    return iree_ok_status();
+  }
+
+  // Check again with the mutex held as another thread may have recorded the
+  // parameter since.
+  iree_slim_mutex_lock(&profile->mutex);
+  if (iree_io_parameter_profile_table_contains(
+          (iree_io_parameter_profile_table_t*)iree_atomic_load(
+              &profile->table, iree_memory_order_relaxed),
+          hash, scope, key)) {
+    iree_slim_mutex_unlock(&profile->mutex);
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, key.data, key.size);
+
+  iree_status_t status = iree_io_parameter_profile_reserve_unsafe(profile);
+
+  iree_io_parameter_profile_entry_t* entry = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(profile->host_allocator,
+                                   sizeof(*entry) + scope.size + key.size,
+                                   (void**)&entry);
+  }
+  if (iree_status_is_ok(status)) {
+    char* string_storage = (char*)entry + sizeof(*entry);
+    memcpy(string_storage, scope.data, scope.size);
+    memcpy(string_storage + scope.size, key.data, key.size);
+    entry->hash = hash;
+    entry->scope = iree_make_string_view(string_storage, scope.size);
+    entry->key = iree_make_string_view(string_storage + scope.size, key.size);
+    profile->entries[profile->entry_count++] = entry;
+    iree_io_parameter_profile_table_insert_unsafe(
+        (iree_io_parameter_profile_table_t*)iree_atomic_load(
+            &profile->table, iree_memory_order_relaxed),
+        entry);
+    if (profile->output_stream) {
+      status = iree_io_parameter_profile_write_entry_unsafe(profile, entry);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  iree_slim_mutex_unlock(&profile->mutex);
+  return status;
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_io_parameter_profile_count(iree_io_parameter_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_slim_mutex_lock(&profile->mutex);
+  iree_host_size_t count = profile->entry_count;
+  iree_slim_mutex_unlock(&profile->mutex);
+  return count;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_get(
+    iree_io_parameter_profile_t* profile, iree_host_size_t i,
+    iree_string_view_t* out_scope, iree_string_view_t* out_key) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(out_scope);
+  IREE_ASSERT_ARGUMENT(out_key);
+  *out_scope = iree_string_view_empty();
+  *out_key = iree_string_view_empty();
+  iree_slim_mutex_lock(&profile->mutex);
+  iree_status_t status = iree_ok_status();
+  if (i < profile->entry_count) {
+    // Entries are never moved once recorded so the views remain valid.
+    *out_scope = profile->entries[i]->scope;
+    *out_key = profile->entries[i]->key;
+  } else {
+    status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "profile entry %" PRIhsz
+                              " out of bounds (have %" PRIhsz " entries)",
+                              i, profile->entry_count);
+  }
+  iree_slim_mutex_unlock(&profile->mutex);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Prefetching
+//===----------------------------------------------------------------------===//
+
+// Growable list of prefetch ranges built while resolving a prior profile.
+typedef struct iree_io_parameter_prefetch_range_list_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+  iree_io_parameter_prefetch_range_t* values;
+} iree_io_parameter_prefetch_range_list_t;
+
+// Appends the range [|offset|, |offset| + |length|) of |handle| to |list|,
+// extending the last range instead when they are (nearly) contiguous.
+static iree_status_t iree_io_parameter_prefetch_range_list_append(
+    iree_io_parameter_prefetch_range_list_t* list,
+    iree_io_file_handle_t* handle, uint64_t offset, uint64_t length) {
+  if (list->count > 0) {
+    iree_io_parameter_prefetch_range_t* last = &list->values[list->count - 1];
+    const uint64_t last_end = last->offset + last->length;
+    if (last->handle == handle && offset >= last->offset &&
+        offset <= last_end + IREE_IO_PARAMETER_PROFILE_PREFETCH_COALESCE_GAP) {
+      last->length = iree_max(last_end, offset + length) - last->offset;
+      return iree_ok_status();
+    }
+  }
+  if (list->count == list->capacity) {
+    const iree_host_size_t new_capacity = iree_max(16, list->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        list->host_allocator, new_capacity * sizeof(list->values[0]),
+        (void**)&list->values));
+    list->capacity = new_capacity;
+  }
+  iree_io_parameter_prefetch_range_t* range = &list->values[list->count++];
+  range->handle = handle;
+  iree_io_file_handle_retain(handle);
+  range->offset = offset;
+  range->length = length;
+  return iree_ok_status();
+}
+
+// Returns the index for |scope| in |scope_map| or NULL if not present.
+static iree_io_parameter_index_t* iree_io_parameter_profile_find_scope(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope) {
+  for (iree_host_size_t i = 0; i < scope_map->count; ++i) {
+    if (iree_string_view_equal(scope_map->entries[i]->scope, scope)) {
+      return scope_map->entries[i]->index;
+    }
+  }
+  return NULL;
+}
+
+// Appends the file range storing the parameter |key| in |scope| to |list|.
+// Parameters that are not found or have no file storage are ignored as are
+// those in lazily-created indices that have not been populated: resolving them
+// would parse the parameter files up front and defeat the laziness.
+static iree_status_t iree_io_parameter_profile_resolve_range(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope,
+    iree_string_view_t key, iree_io_parameter_prefetch_range_list_t* list) {
+  iree_io_parameter_index_t* index =
+      iree_io_parameter_profile_find_scope(scope_map, scope);
+  if (!index || !iree_io_parameter_index_is_populated(index)) {
+    return iree_ok_status();
+  }
+  const iree_io_parameter_index_entry_t* entry = NULL;
+  iree_status_t status = iree_io_parameter_index_lookup(index, key, &entry);
+  if (iree_status_is_not_found(status)) {
+    iree_status_ignore(status);
+    return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(status);
+  switch (entry->type) {
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
+      return iree_io_parameter_prefetch_range_list_append(
+          list, entry->storage.file.handle, entry->storage.file.offset,
+          entry->length);
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_COMPRESSED:
+      return iree_io_parameter_prefetch_range_list_append(
+          list, entry->storage.compressed.handle,
+          entry->storage.compressed.offset, entry->storage.compressed.length);
+    case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_TRANSFORM:
+      return iree_io_parameter_prefetch_range_list_append(
+          list, entry->storage.transform.handle,
+          entry->storage.transform.offset, entry->storage.transform.length);
+    default:
+      // Splats (and anything else without file storage) have nothing to read.
+      return iree_ok_status();
+  }
+}
+
+// Parses the serialized |prior_profile| and appends the ranges of all
+// parameters listed to |list| in order.
+static iree_status_t iree_io_parameter_profile_resolve_ranges(
+    iree_string_view_t prior_profile, iree_io_scope_map_t* scope_map,
+    iree_io_parameter_prefetch_range_list_t* list) {
+  iree_host_size_t line_number = 0;
+  while (!iree_string_view_is_empty(prior_profile)) {
+    iree_string_view_t line = iree_string_view_empty();
+    iree_string_view_split(prior_profile, '\n', &line, &prior_profile);
+    ++line_number;
+    if (iree_string_view_ends_with(line, IREE_SV("\r"))) {
+      line = iree_string_view_remove_suffix(line, 1);
+    }
+    if (iree_string_view_is_empty(line) ||
+        iree_string_view_starts_with(line, IREE_SV("#"))) {
+      continue;
+    }
+    iree_string_view_t scope = iree_string_view_empty();
+    iree_string_view_t key = iree_string_view_empty();
+    if (iree_string_view_split(line, '\t', &scope, &key) == -1) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "malformed parameter profile line %" PRIhsz
+                              "; expected `scope<TAB>key`",
+                              line_number);
+    }
+    IREE_RETURN_IF_ERROR(
+        iree_io_parameter_profile_resolve_range(scope_map, scope, key, list));
+  }
+  return iree_ok_status();
+}
+
+static int iree_io_parameter_profile_prefetch_main(void* entry_arg) {
+  iree_io_parameter_profile_t* profile =
+      (iree_io_parameter_profile_t*)entry_arg;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < profile->prefetch_range_count; ++i) {
+    const iree_io_parameter_prefetch_range_t* range =
+        &profile->prefetch_ranges[i];
+    for (uint64_t offset = 0; offset < range->length;
+         offset += IREE_IO_PARAMETER_PROFILE_PREFETCH_CHUNK_SIZE) {
+      if (iree_atomic_load(&profile->prefetch_cancelled,
+                           iree_memory_order_acquire)) {
+        IREE_TRACE_ZONE_END(z0);
+        return 0;
+      }
+      // Prefetching is only a hint and failures only mean a slower first
+      // access so they are ignored.
+      iree_status_ignore(iree_io_file_handle_prefetch(
+          range->handle, range->offset + offset,
+          iree_min(range->length - offset,
+                   (uint64_t)IREE_IO_PARAMETER_PROFILE_PREFETCH_CHUNK_SIZE)));
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_prefetch(
+    iree_io_parameter_profile_t* profile, iree_string_view_t prior_profile,
+    iree_io_scope_map_t* scope_map) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(scope_map);
+  if (profile->prefetch_thread || profile->prefetch_ranges) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "prefetch already started on this profile");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Resolve all parameters on the calling thread so that the prefetch thread
+  // does not need to touch the indices.
+  iree_io_parameter_prefetch_range_list_t list = {
+      .host_allocator = profile->host_allocator,
+      .count = 0,
+      .capacity = 0,
+      .values = NULL,
+  };
+  iree_status_t status =
+      iree_io_parameter_profile_resolve_ranges(prior_profile, scope_map, &list);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, list.count);
+  if (!iree_status_is_ok(status) || list.count == 0) {
+    iree_io_parameter_prefetch_ranges_free(list.count, list.values,
+                                           profile->host_allocator);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  profile->prefetch_range_count = list.count;
+  profile->prefetch_ranges = list.values;
+
+  // Prefetching competes with the program for I/O and should not delay it.
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = IREE_SV("iree-io-prefetch");
+  params.priority_class = IREE_THREAD_PRIORITY_CLASS_LOW;
+  status = iree_thread_create(iree_io_parameter_profile_prefetch_main, profile,
+                              params, profile->host_allocator,
+                              &profile->prefetch_thread);
+  if (!iree_status_is_ok(status)) {
+    iree_io_parameter_prefetch_ranges_free(profile->prefetch_range_count,
+                                           profile->prefetch_ranges,
+                                           profile->host_allocator);
+    profile->prefetch_range_count = 0;
+    profile->prefetch_ranges = NULL;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,88 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_PROFILE_H_
+#define IREE_IO_PARAMETER_PROFILE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/io/scope_map.h"
+#include "iree/io/stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_profile_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of bytes prefetched with a single read-ahead hint. Large
+// parameters are split so that prefetching can be stopped promptly.
+#define IREE_IO_PARAMETER_PROFILE_PREFETCH_CHUNK_SIZE (4 * 1024 * 1024)
+
+// Records the order in which parameters are first accessed and uses the order
+// recorded by a prior run to warm the page cache on startup.
+//
+// Profiles are serialized as text with one `scope<TAB>key` line per parameter
+// in the order they were first accessed. Lines starting with `#` are comments.
+// Parameters with tabs or newlines in their scope or key are recorded but not
+// serialized.
+//
+// Thread-safe; parameter providers may record accesses from any thread.
+typedef struct iree_io_parameter_profile_t iree_io_parameter_profile_t;
+
+// Creates a new empty parameter profile.
+// If |output_stream| is provided it is retained and each newly recorded access
+// is written to it as it is recorded instead of all at once on shutdown.
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_create(
+    iree_io_stream_t* output_stream, iree_allocator_t host_allocator,
+    iree_io_parameter_profile_t** out_profile);
+
+// Retains the given |profile| for the caller.
+IREE_API_EXPORT void iree_io_parameter_profile_retain(
+    iree_io_parameter_profile_t* profile);
+
+// Releases the given |profile| from the caller. Any in-progress prefetching is
+// stopped when the profile is destroyed.
+IREE_API_EXPORT void iree_io_parameter_profile_release(
+    iree_io_parameter_profile_t* profile);
+
+// Records an access of the parameter |key| in |scope|. Only the first access
+// of each parameter is recorded.
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_record(
+    iree_io_parameter_profile_t* profile, iree_string_view_t scope,
+    iree_string_view_t key);
+
+// Returns the number of unique parameters recorded in |profile|.
+IREE_API_EXPORT iree_host_size_t
+iree_io_parameter_profile_count(iree_io_parameter_profile_t* profile);
+
+// Returns the scope and key of the parameter recorded at position |i| in
+// access order. The returned strings are valid for the lifetime of |profile|.
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_get(
+    iree_io_parameter_profile_t* profile, iree_host_size_t i,
+    iree_string_view_t* out_scope, iree_string_view_t* out_key);
+
+// Begins warming the page cache with the contents of the parameters listed in
+// the serialized |prior_profile| (such as one written by a prior run) in the
+// order they are listed. Parameters are resolved against the indices in
+// |scope_map| before returning and any not found (such as when the profile is
+// from a different set of parameters) are ignored. Lazily-created indices that
+// have not yet been populated are skipped instead of being populated early.
+// Read-ahead is issued from a background thread owned by |profile| and stops
+// early if the profile is destroyed. Only one prefetch may be started per
+// profile.
+IREE_API_EXPORT iree_status_t iree_io_parameter_profile_prefetch(
+    iree_io_parameter_profile_t* profile, iree_string_view_t prior_profile,
+    iree_io_scope_map_t* scope_map);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_PROFILE_H_
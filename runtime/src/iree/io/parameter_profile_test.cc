@@ -0,0 +1,246 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_profile.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/io/file_handle.h"
+#include "iree/io/parameter_index.h"
+#include "iree/io/vec_stream.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+static std::string GetProfileKey(iree_io_parameter_profile_t* profile,
+                                 iree_host_size_t i) {
+  iree_string_view_t scope = iree_string_view_empty();
+  iree_string_view_t key = iree_string_view_empty();
+  IREE_CHECK_OK(iree_io_parameter_profile_get(profile, i, &scope, &key));
+  return std::string(scope.data, scope.size) + "/" +
+         std::string(key.data, key.size);
+}
+
+static iree_status_t AppendBlock(void* user_data,
+                                 iree_const_byte_span_t block) {
+  auto* contents = (std::string*)user_data;
+  contents->append((const char*)block.data, block.data_length);
+  return iree_ok_status();
+}
+
+TEST(ParameterProfileTest, RecordsFirstAccessOrder) {
+  iree_io_stream_t* stream = NULL;
+  IREE_ASSERT_OK(iree_io_vec_stream_create(
+      IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_WRITABLE,
+      /*block_size=*/64, iree_allocator_system(), &stream));
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_profile_create(
+      stream, iree_allocator_system(), &profile));
+
+  IREE_ASSERT_OK(
+      iree_io_parameter_profile_record(profile, IREE_SV("a"), IREE_SV("x")));
+  IREE_ASSERT_OK(
+      iree_io_parameter_profile_record(profile, IREE_SV(""), IREE_SV("y")));
+  IREE_ASSERT_OK(
+      iree_io_parameter_profile_record(profile, IREE_SV("a"), IREE_SV("x")));
+  IREE_ASSERT_OK(
+      iree_io_parameter_profile_record(profile, IREE_SV("b"), IREE_SV("x")));
+  IREE_ASSERT_OK(
+      iree_io_parameter_profile_record(profile, IREE_SV(""), IREE_SV("y")));
+  // Recorded but not serializable.
+  IREE_ASSERT_OK(iree_io_parameter_profile_record(profile, IREE_SV("a"),
+                                                  IREE_SV("bad\tkey")));
+
+  ASSERT_EQ(iree_io_parameter_profile_count(profile), 4);
+  EXPECT_EQ(GetProfileKey(profile, 0), "a/x");
+  EXPECT_EQ(GetProfileKey(profile, 1), "/y");
+  EXPECT_EQ(GetProfileKey(profile, 2), "b/x");
+  EXPECT_EQ(GetProfileKey(profile, 3), "a/bad\tkey");
+  iree_string_view_t scope, key;
+  EXPECT_THAT(Status(iree_io_parameter_profile_get(profile, 4, &scope, &key)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  std::string contents;
+  IREE_ASSERT_OK(
+      iree_io_vec_stream_enumerate_blocks(stream, AppendBlock, &contents));
+  EXPECT_EQ(contents, "a\tx\n\ty\nb\tx\n");
+
+  iree_io_parameter_profile_release(profile);
+  iree_io_stream_release(stream);
+}
+
+// Tests that deduplication holds across growth of the profile.
+TEST(ParameterProfileTest, RecordMany) {
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_profile_create(
+      /*output_stream=*/NULL, iree_allocator_system(), &profile));
+  static constexpr int kKeyCount = 1000;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kKeyCount; ++i) {
+    keys.push_back("layer." + std::to_string(i) + ".weight");
+  }
+  for (int pass = 0; pass < 2; ++pass) {
+    for (const auto& key : keys) {
+      IREE_ASSERT_OK(iree_io_parameter_profile_record(
+          profile, IREE_SV("model"),
+          iree_make_string_view(key.data(), key.size())));
+    }
+  }
+  ASSERT_EQ(iree_io_parameter_profile_count(profile), kKeyCount);
+  for (int i = 0; i < kKeyCount; ++i) {
+    EXPECT_EQ(GetProfileKey(profile, i), "model/" + keys[i]);
+  }
+  iree_io_parameter_profile_release(profile);
+}
+
+// Tests that concurrent records of the same parameters are deduplicated while
+// the profile grows.
+TEST(ParameterProfileTest, RecordConcurrently) {
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_profile_create(
+      /*output_stream=*/NULL, iree_allocator_system(), &profile));
+  static constexpr int kKeyCount = 1000;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kKeyCount; ++i) {
+    keys.push_back("layer." + std::to_string(i) + ".weight");
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (const auto& key : keys) {
+        IREE_CHECK_OK(iree_io_parameter_profile_record(
+            profile, IREE_SV("model"),
+            iree_make_string_view(key.data(), key.size())));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(iree_io_parameter_profile_count(profile), kKeyCount);
+  iree_io_parameter_profile_release(profile);
+}
+
+class ParameterProfilePrefetchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    storage_.resize(4096);
+    IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ,
+        iree_make_byte_span(storage_.data(), storage_.size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        &file_handle_));
+    iree_io_scope_map_initialize(iree_allocator_system(), &scope_map_);
+    iree_io_parameter_index_t* index = NULL;
+    IREE_ASSERT_OK(
+        iree_io_scope_map_lookup(&scope_map_, IREE_SV("model"), &index));
+    for (int i = 0; i < 4; ++i) {
+      std::string key = "p" + std::to_string(i);
+      iree_io_parameter_index_entry_t entry = {};
+      entry.key = iree_make_string_view(key.data(), key.size());
+      entry.length = 512;
+      entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+      entry.storage.file.handle = file_handle_;
+      entry.storage.file.offset = i * 1024;
+      IREE_ASSERT_OK(iree_io_parameter_index_add(index, &entry));
+    }
+    iree_io_parameter_index_entry_t splat_entry = {};
+    splat_entry.key = IREE_SV("splat");
+    splat_entry.length = 16;
+    splat_entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT;
+    splat_entry.storage.splat.pattern_length = 1;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(index, &splat_entry));
+  }
+
+  void TearDown() override {
+    iree_io_scope_map_deinitialize(&scope_map_);
+    iree_io_file_handle_release(file_handle_);
+  }
+
+  std::vector<uint8_t> storage_;
+  iree_io_file_handle_t* file_handle_ = NULL;
+  iree_io_scope_map_t scope_map_;
+};
+
+TEST_F(ParameterProfilePrefetchTest, Prefetch) {
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_profile_create(
+      /*output_stream=*/NULL, iree_allocator_system(), &profile));
+  // Unknown scopes and keys and splats are ignored.
+  IREE_ASSERT_OK(iree_io_parameter_profile_prefetch(
+      profile,
+      IREE_SV("# comment\r\n"
+              "model\tp2\n"
+              "model\tsplat\n"
+              "\n"
+              "other\tp0\n"
+              "model\tmissing\r\n"
+              "model\tp0\n"
+              "model\tp1\n"),
+      &scope_map_));
+  // Only one prefetch may be started.
+  EXPECT_THAT(Status(iree_io_parameter_profile_prefetch(
+                  profile, IREE_SV("model\tp3\n"), &scope_map_)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  // Destroying the profile stops and joins the prefetch thread.
+  iree_io_parameter_profile_release(profile);
+}
+
+static iree_status_t PopulateNothing(void* user_data,
+                                     iree_io_parameter_index_t* index) {
+  *(int*)user_data += 1;
+  return iree_ok_status();
+}
+
+// Tests that prefetching does not populate lazily-created indices.
+TEST_F(ParameterProfilePrefetchTest, SkipsUnpopulatedLazyScopes) {
+  int populate_count = 0;
+  iree_io_parameter_index_populator_t populator = {};
+  populator.fn = PopulateNothing;
+  populator.user_data = &populate_count;
+  iree_io_parameter_index_t* lazy_index = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_index_create_lazy(
+      populator, iree_allocator_system(), &lazy_index));
+  EXPECT_FALSE(iree_io_parameter_index_is_populated(lazy_index));
+  IREE_ASSERT_OK(
+      iree_io_scope_map_insert(&scope_map_, IREE_SV("lazy"), lazy_index));
+
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_profile_create(
+      /*output_stream=*/NULL, iree_allocator_system(), &profile));
+  IREE_ASSERT_OK(iree_io_parameter_profile_prefetch(
+      profile, IREE_SV("lazy\tp0\nmodel\tp0\n"), &scope_map_));
+  EXPECT_EQ(populate_count, 0);
+  EXPECT_FALSE(iree_io_parameter_index_is_populated(lazy_index));
+  iree_io_parameter_profile_release(profile);
+
+  EXPECT_EQ(iree_io_parameter_index_count(lazy_index), 0);
+  EXPECT_EQ(populate_count, 1);
+  EXPECT_TRUE(iree_io_parameter_index_is_populated(lazy_index));
+  iree_io_parameter_index_release(lazy_index);
+}
+
+TEST_F(ParameterProfilePrefetchTest, Malformed) {
+  iree_io_parameter_profile_t* profile = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_profile_create(
+      /*output_stream=*/NULL, iree_allocator_system(), &profile));
+  EXPECT_THAT(Status(iree_io_parameter_profile_prefetch(
+                  profile, IREE_SV("model\tp0\nno_tab\n"), &scope_map_)),
+              StatusIs(StatusCode::kInvalidArgument));
+  // A failed prefetch can be retried.
+  IREE_EXPECT_OK(iree_io_parameter_profile_prefetch(
+      profile, IREE_SV("model\tp0\n"), &scope_map_));
+  iree_io_parameter_profile_release(profile);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
@@ -29,54 +29,95 @@ IREE_API_EXPORT void iree_io_scope_map_deinitialize(
   IREE_TRACE_ZONE_END(z0);
 }
 
-IREE_API_EXPORT iree_status_t iree_io_scope_map_lookup(
-    iree_io_scope_map_t* scope_map, iree_string_view_t scope,
-    iree_io_parameter_index_t** out_index) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_TEXT(z0, scope.data, scope.size);
-
+// Returns the entry for |scope| or NULL if not present.
+static iree_io_scope_map_entry_t* iree_io_scope_map_find(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope) {
   for (iree_host_size_t i = 0; i < scope_map->count; ++i) {
     iree_io_scope_map_entry_t* entry = scope_map->entries[i];
-    if (iree_string_view_equal(scope, entry->scope)) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
-      *out_index = entry->index;
-      IREE_TRACE_ZONE_END(z0);
-      return iree_ok_status();
-    }
+    if (iree_string_view_equal(scope, entry->scope)) return entry;
   }
-  IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
+  return NULL;
+}
 
+// Appends a new entry for |scope| without an index assigned.
+static iree_status_t iree_io_scope_map_append(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope,
+    iree_io_scope_map_entry_t** out_entry) {
   if (scope_map->count == scope_map->capacity) {
     iree_host_size_t new_capacity = iree_max(8, scope_map->capacity * 2);
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_allocator_realloc(
-                scope_map->host_allocator,
-                new_capacity * sizeof(iree_io_scope_map_entry_t*),
-                (void**)&scope_map->entries));
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        scope_map->host_allocator,
+        new_capacity * sizeof(iree_io_scope_map_entry_t*),
+        (void**)&scope_map->entries));
     scope_map->capacity = new_capacity;
   }
 
   iree_io_scope_map_entry_t* entry = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(scope_map->host_allocator,
-                                sizeof(*entry) + scope.size, (void**)&entry));
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      scope_map->host_allocator, sizeof(*entry) + scope.size, (void**)&entry));
   entry->scope =
       iree_make_string_view((const char*)entry + sizeof(*entry), scope.size);
   memcpy((char*)entry->scope.data, scope.data, scope.size);
+  entry->index = NULL;
 
-  iree_status_t status =
-      iree_io_parameter_index_create(scope_map->host_allocator, &entry->index);
+  scope_map->entries[scope_map->count++] = entry;
+  *out_entry = entry;
+  return iree_ok_status();
+}
 
-  if (iree_status_is_ok(status)) {
-    scope_map->entries[scope_map->count++] = entry;
+IREE_API_EXPORT iree_status_t iree_io_scope_map_lookup(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope,
+    iree_io_parameter_index_t** out_index) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, scope.data, scope.size);
+
+  iree_io_scope_map_entry_t* entry = iree_io_scope_map_find(scope_map, scope);
+  if (entry) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
     *out_index = entry->index;
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
+
+  iree_io_parameter_index_t* index = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_index_create(scope_map->host_allocator, &index));
+  iree_status_t status = iree_io_scope_map_append(scope_map, scope, &entry);
+  if (iree_status_is_ok(status)) {
+    entry->index = index;
+    *out_index = index;
   } else {
-    iree_allocator_free(scope_map->host_allocator, entry);
+    iree_io_parameter_index_release(index);
   }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_io_scope_map_insert(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope,
+    iree_io_parameter_index_t* index) {
+  IREE_ASSERT_ARGUMENT(index);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, scope.data, scope.size);
+
+  if (iree_io_scope_map_find(scope_map, scope)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_ALREADY_EXISTS,
+                            "parameter scope `%.*s` already present",
+                            (int)scope.size, scope.data);
+  }
+
+  iree_io_scope_map_entry_t* entry = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_scope_map_append(scope_map, scope, &entry));
+  entry->index = index;
+  iree_io_parameter_index_retain(index);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_io_scope_map_dump(
     iree_io_scope_map_t* scope_map, iree_string_builder_t* builder) {
   for (iree_host_size_t i = 0; i < scope_map->count; ++i) {
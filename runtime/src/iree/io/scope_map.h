@@ -38,6 +38,13 @@ IREE_API_EXPORT iree_status_t iree_io_scope_map_lookup(
     iree_io_scope_map_t* scope_map, iree_string_view_t scope,
     iree_io_parameter_index_t** out_index);
 
+// Inserts an existing |index| for |scope| and retains it. Used to register
+// indices that are created specially (such as lazily-populated ones). Fails if
+// |scope| is already present in the map.
+IREE_API_EXPORT iree_status_t iree_io_scope_map_insert(
+    iree_io_scope_map_t* scope_map, iree_string_view_t scope,
+    iree_io_parameter_index_t* index);
+
 IREE_API_EXPORT iree_status_t iree_io_scope_map_dump(
     iree_io_scope_map_t* scope_map, iree_string_builder_t* builder);
 
@@ -38,6 +38,18 @@
 // original file on each machine running the tests/benchmarks.
 // Use `iree-convert-parameters` with the `--strip` flag to strip all parameter
 // values or `--splat=key` to strip selected parameters.
+//
+// Parameter contents may also be stored compressed as a sequence of
+// independently compressed blocks so that loaders can decompress blocks in
+// parallel and read arbitrary subranges without decompressing the whole
+// parameter. Use `iree-convert-parameters --compress=lz4` to produce
+// compressed archives. Archives containing compressed entries are written as
+// version 0.1 so that older runtimes report a version mismatch instead of an
+// unknown entry type.
+//
+// Entries with storage may carry a hash of their stored bytes so that archives
+// can be verified after being copied or downloaded. Hashes trail the entry
+// structure and are ignored by parsers that don't know about them.
 
 #if defined(_MSC_VER)
 #define IREE_IO_PACKED_BEGIN __pragma(pack(push, 1))
@@ -160,12 +172,22 @@ enum iree_io_parameter_archive_entry_type_e {
   // Entry represents data stored in an external file.
   // See iree_io_parameter_archive_external_entry_t.
   IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_EXTERNAL = 3,
+  // Entry represents block-compressed data embedded in the archive.
+  // See iree_io_parameter_archive_compressed_entry_t.
+  IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_COMPRESSED = 4,
 };
 // Defines the type of an entry in the archive entry table.
 typedef uint32_t iree_io_parameter_archive_entry_type_t;
 
 // Entry type-specific flag bits.
 typedef uint64_t iree_io_parameter_archive_entry_flags_t;
+enum iree_io_parameter_archive_entry_flag_bits_e {
+  IREE_IO_PARAMETER_ARCHIVE_ENTRY_FLAG_NONE = 0ull,
+  // An iree_io_parameter_archive_entry_hash_t immediately follows the
+  // type-specific entry structure and is included in the entry size. Only valid
+  // on DATA and COMPRESSED entries.
+  IREE_IO_PARAMETER_ARCHIVE_ENTRY_FLAG_HASH = 1ull << 0,
+};
 
 // Header shared across all entry types.
 // The total size of the header and the entry are included to allow for
@@ -236,6 +258,61 @@ typedef struct iree_io_parameter_archive_external_entry_t {
   iree_io_parameter_archive_range_t range;
 } iree_io_parameter_archive_external_entry_t;
 
+enum iree_io_parameter_archive_compression_type_e {
+  // Blocks are stored uncompressed.
+  IREE_IO_PARAMETER_ARCHIVE_COMPRESSION_TYPE_NONE = 0,
+  // Blocks are encoded in the LZ4 block format (no frame headers).
+  IREE_IO_PARAMETER_ARCHIVE_COMPRESSION_TYPE_LZ4 = 1,
+};
+// Defines the codec used to compress the blocks of a compressed entry.
+typedef uint32_t iree_io_parameter_archive_compression_type_t;
+
+// An entry referencing block-compressed data in the archive data storage
+// segment. The uncompressed contents are split into |block_size| blocks (the
+// last may be shorter) that are each compressed independently.
+//
+// The block table is an array of block_count + 1 little-endian uint64_t
+// offsets relative to the start of |storage| where block i occupies
+// [table[i], table[i + 1]). block_count is ceil(length / block_size). A block
+// whose compressed length equals its uncompressed length is stored as-is;
+// writers use this for blocks that don't compress.
+typedef struct iree_io_parameter_archive_compressed_entry_t {
+  // Entry header with type IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_COMPRESSED.
+  iree_io_parameter_archive_entry_header_t header;
+  // Total uncompressed length of the parameter in bytes.
+  iree_io_physical_size_t length;
+  // Codec used for all blocks.
+  iree_io_parameter_archive_compression_type_t compression_type;
+  // Uncompressed bytes per block.
+  uint32_t block_size;
+  // Block offset table in the data storage segment. 8-byte aligned.
+  iree_io_parameter_archive_storage_ref_t block_table;
+  // Compressed block data in the data storage segment.
+  iree_io_parameter_archive_storage_ref_t storage;
+} iree_io_parameter_archive_compressed_entry_t;
+
+enum iree_io_parameter_archive_hash_type_e {
+  // No hash is stored; the hash value is ignored.
+  IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE = 0,
+  // 64-bit xxHash (XXH64) with a seed of 0.
+  IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_XXH64 = 1,
+};
+// Defines the algorithm used to produce an entry content hash.
+typedef uint32_t iree_io_parameter_archive_hash_type_t;
+
+// Content hash trailing entries with IREE_IO_PARAMETER_ARCHIVE_ENTRY_FLAG_HASH.
+// The hash covers the bytes of the entry storage range as stored in the
+// archive: the raw contents of DATA entries and the compressed block data
+// (excluding the block table) of COMPRESSED entries.
+typedef struct iree_io_parameter_archive_entry_hash_t {
+  // Algorithm used to produce |value|.
+  iree_io_parameter_archive_hash_type_t type;
+  // Reserved for future use; must be zero.
+  uint32_t reserved;
+  // Hash of the entry storage range.
+  uint64_t value;
+} iree_io_parameter_archive_entry_hash_t;
+
 IREE_IO_PACKED_END
 
 #endif  // IREE_SCHEMAS_PARAMETER_ARCHIVE_H_
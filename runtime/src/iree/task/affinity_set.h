@@ -7,6 +7,10 @@
 #ifndef IREE_TASK_AFFINITY_SET_H_
 #define IREE_TASK_AFFINITY_SET_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/math.h"
 #include "iree/task/tuning.h"
@@ -15,71 +19,351 @@
 extern "C" {
 #endif  // __cplusplus
 
-// TODO(benvanik): if IREE_TASK_EXECUTOR_MAX_WORKER_COUNT <= 32 then switch
-// these to using the 32-bit primitives. No real effect on larger 64-bit systems
-// but if we were on a smaller 32-bit system with 2 cores it's kind of silly to
-// be doing expensive 64-bit atomics on a 32-bit bus all for just 2 bits of
-// data :)
+// Affinity is tracked at two levels of granularity:
+//
+//   iree_task_affinity_set_t: one bit per worker, stored as an array of 64-bit
+//     words. Used by the executor for all worker bookkeeping (live/idle masks,
+//     post batches, constructive sharing) and able to address up to
+//     IREE_TASK_EXECUTOR_MAX_WORKER_COUNT workers.
+//
+//   iree_task_affinity_t: a single 64-bit word stored in every task header
+//     where each bit selects a contiguous block of workers. Executors with
+//     <= 64 workers use blocks of a single worker and larger executors use
+//     the smallest block size that covers all workers. The task header has a
+//     strict size budget (see iree_task_t) and the full set would blow it when
+//     there are more than 64 workers. Tasks are expanded to full worker sets
+//     only when they are routed to workers.
+//
+// Topologies are populated node-by-node and cache-domain-by-cache-domain and
+// as such the 64-worker words (and the blocks within them) generally map to
+// hardware NUMA nodes/CCXs on large machines: stealing and routing that walks
+// the words in order will touch nearby workers first.
+//
+// When IREE_TASK_EXECUTOR_MAX_WORKER_COUNT <= 64 both representations are a
+// single uint64_t and all of the operations below compile down to the same
+// bit twiddling as a plain integer mask.
 
 //===----------------------------------------------------------------------===//
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
-typedef uint64_t iree_task_affinity_set_t;
+// Number of bits in each word of an iree_task_affinity_set_t.
+#define IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT 64
+
+// Number of words required to have one bit per worker.
+#define IREE_TASK_AFFINITY_SET_WORD_COUNT                \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT +                \
+    IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT - 1) /         \
+   IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT)
+
+// Sentinel returned from iree_task_affinity_set_find_* when no bits are set.
+#define IREE_TASK_AFFINITY_SET_INDEX_NONE IREE_HOST_SIZE_MAX
+
+// A bitset with one bit per worker in an executor.
+typedef struct iree_task_affinity_set_t {
+  uint64_t words[IREE_TASK_AFFINITY_SET_WORD_COUNT];
+} iree_task_affinity_set_t;
+
+// Returns a set with no workers selected.
+static inline iree_task_affinity_set_t iree_task_affinity_set_empty(void) {
+  iree_task_affinity_set_t set;
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    set.words[i] = 0;
+  }
+  return set;
+}
+
+// Returns a set with the first |count| workers selected.
+static inline iree_task_affinity_set_t iree_task_affinity_set_ones(
+    iree_host_size_t count) {
+  iree_task_affinity_set_t set;
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    const iree_host_size_t word_base =
+        i * IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT;
+    if (count >= word_base + IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT) {
+      set.words[i] = UINT64_MAX;
+    } else if (count > word_base) {
+      set.words[i] = UINT64_MAX >> (64 - (count - word_base));
+    } else {
+      set.words[i] = 0;
+    }
+  }
+  return set;
+}
 
 // Allows for only a specific worker to be selected.
-static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
-    uint8_t worker_index) {
-  return 1ull << worker_index;
+static inline iree_task_affinity_set_t iree_task_affinity_set_for_worker(
+    iree_host_size_t worker_index) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  set.words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] =
+      1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+  return set;
+}
+
+// Allows for any worker to be selected.
+static inline iree_task_affinity_set_t iree_task_affinity_set_for_any_worker(
+    void) {
+  return iree_task_affinity_set_ones(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+}
+
+// Allows for workers in the range [worker_start, worker_end) to be selected.
+static inline iree_task_affinity_set_t iree_task_affinity_set_for_worker_range(
+    iree_host_size_t worker_start, iree_host_size_t worker_end) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_ones(worker_end);
+  iree_task_affinity_set_t excluded = iree_task_affinity_set_ones(worker_start);
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    set.words[i] &= ~excluded.words[i];
+  }
+  return set;
+}
+
+// Returns true if no workers are selected in |set|.
+static inline bool iree_task_affinity_set_is_empty(
+    iree_task_affinity_set_t set) {
+  uint64_t any = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    any |= set.words[i];
+  }
+  return any == 0;
+}
+
+// Returns true if |a| and |b| select exactly the same workers.
+static inline bool iree_task_affinity_set_equal(iree_task_affinity_set_t a,
+                                                iree_task_affinity_set_t b) {
+  uint64_t diff = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    diff |= a.words[i] ^ b.words[i];
+  }
+  return diff == 0;
+}
+
+// Returns true if |worker_index| is selected in |set|.
+static inline bool iree_task_affinity_set_test(iree_task_affinity_set_t set,
+                                               iree_host_size_t worker_index) {
+  return (set.words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] >>
+          (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT)) &
+         1;
+}
+
+// Selects |worker_index| in |set|.
+static inline void iree_task_affinity_set_insert(
+    iree_task_affinity_set_t* set, iree_host_size_t worker_index) {
+  set->words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] |=
+      1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+}
+
+// Deselects |worker_index| in |set|.
+static inline void iree_task_affinity_set_erase(iree_task_affinity_set_t* set,
+                                                iree_host_size_t worker_index) {
+  set->words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] &=
+      ~(1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT));
 }
 
-// Allows for a range of workers to be selected.
-static inline iree_task_affinity_set_t iree_task_affinity_for_worker_range(
-    uint8_t worker_start, uint8_t worker_end) {
-  return ((1ull << (worker_start - 1)) - 1) ^ ((1ull << worker_end) - 1);
+// Returns |a| & |b|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_and(
+    iree_task_affinity_set_t a, iree_task_affinity_set_t b) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    a.words[i] &= b.words[i];
+  }
+  return a;
+}
+
+// Returns |a| | |b|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_or(
+    iree_task_affinity_set_t a, iree_task_affinity_set_t b) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    a.words[i] |= b.words[i];
+  }
+  return a;
+}
+
+// Returns |a| & ~|b|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_and_not(
+    iree_task_affinity_set_t a, iree_task_affinity_set_t b) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    a.words[i] &= ~b.words[i];
+  }
+  return a;
+}
+
+// Returns the total number of workers selected in |set|.
+static inline int iree_task_affinity_set_count_ones(
+    iree_task_affinity_set_t set) {
+  int count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    count += iree_math_count_ones_u64(set.words[i]);
+  }
+  return count;
+}
+
+// Returns the index of the first worker selected in |set| at or after
+// |worker_index| or IREE_TASK_AFFINITY_SET_INDEX_NONE if there are none.
+// This is O(words) and not O(bits): empty words are skipped entirely.
+static inline iree_host_size_t iree_task_affinity_set_find_next(
+    iree_task_affinity_set_t set, iree_host_size_t worker_index) {
+  iree_host_size_t word_index =
+      worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT;
+  if (word_index >= IREE_TASK_AFFINITY_SET_WORD_COUNT) {
+    return IREE_TASK_AFFINITY_SET_INDEX_NONE;
+  }
+  uint64_t word = set.words[word_index] &
+                  (UINT64_MAX
+                   << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT));
+  while (!word) {
+    if (++word_index >= IREE_TASK_AFFINITY_SET_WORD_COUNT) {
+      return IREE_TASK_AFFINITY_SET_INDEX_NONE;
+    }
+    word = set.words[word_index];
+  }
+  return word_index * IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT +
+         iree_math_count_trailing_zeros_u64(word);
+}
+
+// Returns the index of the first worker selected in |set| or
+// IREE_TASK_AFFINITY_SET_INDEX_NONE if the set is empty.
+static inline iree_host_size_t iree_task_affinity_set_find_first(
+    iree_task_affinity_set_t set) {
+  return iree_task_affinity_set_find_next(set, 0);
+}
+
+// Returns the index of the first worker selected in |set| at or after
+// |worker_index| wrapping around to the start of the set if required.
+// Returns IREE_TASK_AFFINITY_SET_INDEX_NONE if the set is empty.
+static inline iree_host_size_t iree_task_affinity_set_find_next_wrapping(
+    iree_task_affinity_set_t set, iree_host_size_t worker_index) {
+  iree_host_size_t index = iree_task_affinity_set_find_next(set, worker_index);
+  if (index == IREE_TASK_AFFINITY_SET_INDEX_NONE && worker_index > 0) {
+    index = iree_task_affinity_set_find_next(set, 0);
+  }
+  return index;
+}
+
+// Iterates over all worker indices selected in |set| in ascending order.
+// Example:
+//   IREE_TASK_AFFINITY_SET_FOR_EACH(i, mask) { wake(&workers[i]); }
+#define IREE_TASK_AFFINITY_SET_FOR_EACH(index_var, set)                     \
+  for (iree_host_size_t index_var = iree_task_affinity_set_find_first(set); \
+       index_var != IREE_TASK_AFFINITY_SET_INDEX_NONE;                      \
+       index_var = iree_task_affinity_set_find_next(set, index_var + 1))
+
+//===----------------------------------------------------------------------===//
+// iree_task_affinity_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of workers each bit of an iree_task_affinity_t may select.
+// Executors pick the smallest block size that covers all of their workers (see
+// iree_task_affinity_block_size) and only executors with more than 64 workers
+// use blocks larger than a single worker.
+#define IREE_TASK_AFFINITY_MAX_BLOCK_SIZE IREE_TASK_AFFINITY_SET_WORD_COUNT
+
+// Compact block-granular worker affinity stored in task headers.
+// Bit N selects workers [N * block_size, (N + 1) * block_size) where
+// block_size is that of the executor the task is submitted to.
+typedef uint64_t iree_task_affinity_t;
+
+// Returns the number of workers each bit of an iree_task_affinity_t selects in
+// an executor with |worker_count| workers.
+static inline iree_host_size_t iree_task_affinity_block_size(
+    iree_host_size_t worker_count) {
+  return worker_count > 64 ? (worker_count + 63) / 64 : 1;
+}
+
+// Allows for only the block containing a specific worker to be selected.
+// When |block_size| is 1 this selects exactly the worker.
+static inline iree_task_affinity_t iree_task_affinity_for_worker(
+    iree_host_size_t worker_index, iree_host_size_t block_size) {
+  return 1ull << (worker_index / block_size);
 }
 
 // Allows for any worker to be selected.
-static inline iree_task_affinity_set_t iree_task_affinity_for_any_worker(void) {
+static inline iree_task_affinity_t iree_task_affinity_for_any_worker(void) {
   return UINT64_MAX;
 }
 
-#define iree_task_affinity_set_ones(count) \
-  (0xFFFFFFFFFFFFFFFFull >> (64 - (count)))
-#define iree_task_affinity_set_count_leading_zeros(set) \
-  iree_math_count_leading_zeros_u64(set)
-#define iree_task_affinity_set_count_trailing_zeros(set) \
-  iree_math_count_trailing_zeros_u64(set)
-#define iree_task_affinity_set_count_ones(set) iree_math_count_ones_u64(set)
-#define iree_task_affinity_set_rotr(set, count) iree_math_rotr_u64(set, count)
+// Returns the maximum number of workers that may be selected by |affinity| in
+// an executor using |block_size|.
+static inline iree_host_size_t iree_task_affinity_worker_count(
+    iree_task_affinity_t affinity, iree_host_size_t block_size) {
+  return (iree_host_size_t)iree_math_count_ones_u64(affinity) * block_size;
+}
+
+// Expands a block-granular |affinity| into the full per-worker set.
+static inline iree_task_affinity_set_t iree_task_affinity_expand(
+    iree_task_affinity_t affinity, iree_host_size_t block_size) {
+  if (affinity == UINT64_MAX) {
+    return iree_task_affinity_set_for_any_worker();
+  }
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  if (block_size == 1) {
+    set.words[0] = affinity;
+    return set;
+  }
+  while (affinity) {
+    const int block_index = iree_math_count_trailing_zeros_u64(affinity);
+    affinity &= affinity - 1;
+    const iree_host_size_t worker_base =
+        (iree_host_size_t)block_index * block_size;
+    for (iree_host_size_t i = 0; i < block_size; ++i) {
+      if (worker_base + i < IREE_TASK_EXECUTOR_MAX_WORKER_COUNT) {
+        iree_task_affinity_set_insert(&set, worker_base + i);
+      }
+    }
+  }
+  return set;
+}
 
 //===----------------------------------------------------------------------===//
 // iree_atomic_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
-typedef iree_atomic_int64_t iree_atomic_task_affinity_set_t;
+// Atomic variant of iree_task_affinity_set_t.
+// Each word is individually atomic and operations touching a single worker only
+// touch the word containing it. Full-set loads are not snapshots: when there
+// is more than one word the set returned may be torn across words. All current
+// users treat the sets as hints and are fine with this.
+typedef struct iree_atomic_task_affinity_set_t {
+  iree_atomic_int64_t words[IREE_TASK_AFFINITY_SET_WORD_COUNT];
+} iree_atomic_task_affinity_set_t;
 
 static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_load(
     iree_atomic_task_affinity_set_t* set, iree_memory_order_t order) {
-  return iree_atomic_load(set, order);
+  iree_task_affinity_set_t value;
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    value.words[i] = (uint64_t)iree_atomic_load(&set->words[i], order);
+  }
+  return value;
 }
 
 static inline void iree_atomic_task_affinity_set_store(
     iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t value,
     iree_memory_order_t order) {
-  iree_atomic_store(set, value, order);
+  for (iree_host_size_t i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    iree_atomic_store(&set->words[i], (int64_t)value.words[i], order);
+  }
 }
 
-static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_and(
-    iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t value,
+// Selects |worker_index| in |set| and returns true if it was already selected.
+static inline bool iree_atomic_task_affinity_set_insert(
+    iree_atomic_task_affinity_set_t* set, iree_host_size_t worker_index,
     iree_memory_order_t order) {
-  return iree_atomic_fetch_and(set, value, order);
+  const uint64_t bit =
+      1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+  const uint64_t old_word = (uint64_t)iree_atomic_fetch_or(
+      &set->words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT],
+      (int64_t)bit, order);
+  return (old_word & bit) != 0;
 }
 
-static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_or(
-    iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t value,
+// Deselects |worker_index| in |set| and returns true if it was selected.
+static inline bool iree_atomic_task_affinity_set_erase(
+    iree_atomic_task_affinity_set_t* set, iree_host_size_t worker_index,
     iree_memory_order_t order) {
-  return iree_atomic_fetch_or(set, value, order);
+  const uint64_t bit =
+      1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+  const uint64_t old_word = (uint64_t)iree_atomic_fetch_and(
+      &set->words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT],
+      (int64_t)~bit, order);
+  return (old_word & bit) != 0;
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,152 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/affinity_set.h"
+
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// Returns all worker indices set in |set| in ascending order.
+static std::vector<iree_host_size_t> ToIndices(iree_task_affinity_set_t set) {
+  std::vector<iree_host_size_t> indices;
+  IREE_TASK_AFFINITY_SET_FOR_EACH(i, set) { indices.push_back(i); }
+  return indices;
+}
+
+TEST(AffinitySetTest, Empty) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  EXPECT_TRUE(iree_task_affinity_set_is_empty(set));
+  EXPECT_EQ(0, iree_task_affinity_set_count_ones(set));
+  EXPECT_EQ(IREE_TASK_AFFINITY_SET_INDEX_NONE,
+            iree_task_affinity_set_find_first(set));
+  EXPECT_EQ(IREE_TASK_AFFINITY_SET_INDEX_NONE,
+            iree_task_affinity_set_find_next_wrapping(set, 3));
+  EXPECT_TRUE(ToIndices(set).empty());
+}
+
+TEST(AffinitySetTest, Ones) {
+  EXPECT_TRUE(iree_task_affinity_set_is_empty(iree_task_affinity_set_ones(0)));
+  EXPECT_EQ(1,
+            iree_task_affinity_set_count_ones(iree_task_affinity_set_ones(1)));
+  EXPECT_EQ(63,
+            iree_task_affinity_set_count_ones(iree_task_affinity_set_ones(63)));
+  EXPECT_EQ(64,
+            iree_task_affinity_set_count_ones(iree_task_affinity_set_ones(64)));
+  EXPECT_EQ(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT,
+            iree_task_affinity_set_count_ones(
+                iree_task_affinity_set_for_any_worker()));
+  if (IREE_TASK_EXECUTOR_MAX_WORKER_COUNT > 64) {
+    iree_task_affinity_set_t set = iree_task_affinity_set_ones(65);
+    EXPECT_EQ(65, iree_task_affinity_set_count_ones(set));
+    EXPECT_TRUE(iree_task_affinity_set_test(set, 64));
+    EXPECT_FALSE(iree_task_affinity_set_test(set, 65));
+  }
+}
+
+TEST(AffinitySetTest, InsertErase) {
+  const iree_host_size_t last_index = IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1;
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  iree_task_affinity_set_insert(&set, 0);
+  iree_task_affinity_set_insert(&set, 5);
+  iree_task_affinity_set_insert(&set, last_index);
+  EXPECT_EQ(3, iree_task_affinity_set_count_ones(set));
+  EXPECT_TRUE(iree_task_affinity_set_test(set, 5));
+  EXPECT_TRUE(iree_task_affinity_set_test(set, last_index));
+  EXPECT_EQ((std::vector<iree_host_size_t>{0, 5, last_index}),
+            ToIndices(set));
+  iree_task_affinity_set_erase(&set, 5);
+  EXPECT_FALSE(iree_task_affinity_set_test(set, 5));
+  EXPECT_EQ((std::vector<iree_host_size_t>{0, last_index}), ToIndices(set));
+}
+
+TEST(AffinitySetTest, ForWorkerRange) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_for_worker_range(2, 5);
+  EXPECT_EQ((std::vector<iree_host_size_t>{2, 3, 4}), ToIndices(set));
+  set = iree_task_affinity_set_for_worker_range(0, 1);
+  EXPECT_EQ((std::vector<iree_host_size_t>{0}), ToIndices(set));
+}
+
+TEST(AffinitySetTest, Logic) {
+  iree_task_affinity_set_t a = iree_task_affinity_set_for_worker_range(0, 4);
+  iree_task_affinity_set_t b = iree_task_affinity_set_for_worker_range(2, 6);
+  EXPECT_EQ((std::vector<iree_host_size_t>{2, 3}),
+            ToIndices(iree_task_affinity_set_and(a, b)));
+  EXPECT_EQ((std::vector<iree_host_size_t>{0, 1, 2, 3, 4, 5}),
+            ToIndices(iree_task_affinity_set_or(a, b)));
+  EXPECT_EQ((std::vector<iree_host_size_t>{0, 1}),
+            ToIndices(iree_task_affinity_set_and_not(a, b)));
+  EXPECT_TRUE(iree_task_affinity_set_equal(a, a));
+  EXPECT_FALSE(iree_task_affinity_set_equal(a, b));
+}
+
+TEST(AffinitySetTest, FindNextWrapping) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  iree_task_affinity_set_insert(&set, 1);
+  iree_task_affinity_set_insert(&set, 6);
+  EXPECT_EQ(1, iree_task_affinity_set_find_next_wrapping(set, 0));
+  EXPECT_EQ(6, iree_task_affinity_set_find_next_wrapping(set, 2));
+  EXPECT_EQ(1, iree_task_affinity_set_find_next_wrapping(set, 7));
+  EXPECT_EQ(1, iree_task_affinity_set_find_next_wrapping(
+                   set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT));
+}
+
+TEST(AffinitySetTest, AtomicInsertErase) {
+  iree_atomic_task_affinity_set_t atomic_set;
+  iree_atomic_task_affinity_set_store(&atomic_set,
+                                      iree_task_affinity_set_empty(),
+                                      iree_memory_order_relaxed);
+  const iree_host_size_t last_index = IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1;
+  EXPECT_FALSE(iree_atomic_task_affinity_set_insert(&atomic_set, last_index,
+                                                    iree_memory_order_relaxed));
+  EXPECT_TRUE(iree_atomic_task_affinity_set_insert(&atomic_set, last_index,
+                                                   iree_memory_order_relaxed));
+  EXPECT_EQ((std::vector<iree_host_size_t>{last_index}),
+            ToIndices(iree_atomic_task_affinity_set_load(
+                &atomic_set, iree_memory_order_relaxed)));
+  EXPECT_TRUE(iree_atomic_task_affinity_set_erase(&atomic_set, last_index,
+                                                  iree_memory_order_relaxed));
+  EXPECT_FALSE(iree_atomic_task_affinity_set_erase(&atomic_set, last_index,
+                                                   iree_memory_order_relaxed));
+}
+
+TEST(AffinityTest, BlockSize) {
+  EXPECT_EQ(1, iree_task_affinity_block_size(1));
+  EXPECT_EQ(1, iree_task_affinity_block_size(64));
+  EXPECT_EQ(2, iree_task_affinity_block_size(65));
+  EXPECT_EQ(2, iree_task_affinity_block_size(128));
+  EXPECT_EQ(3, iree_task_affinity_block_size(129));
+  EXPECT_GE(IREE_TASK_AFFINITY_MAX_BLOCK_SIZE,
+            iree_task_affinity_block_size(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT));
+}
+
+TEST(AffinityTest, Expand) {
+  EXPECT_TRUE(iree_task_affinity_set_equal(
+      iree_task_affinity_set_for_any_worker(),
+      iree_task_affinity_expand(iree_task_affinity_for_any_worker(), 1)));
+
+  // Executors with <= 64 workers select exact workers.
+  iree_task_affinity_set_t set =
+      iree_task_affinity_expand(iree_task_affinity_for_worker(5, 1), 1);
+  EXPECT_EQ(std::vector<iree_host_size_t>({5}), ToIndices(set));
+  EXPECT_EQ(1, iree_task_affinity_worker_count(
+                   iree_task_affinity_for_worker(5, 1), 1));
+
+  // Larger executors select blocks of workers.
+  const iree_host_size_t block_size =
+      iree_task_affinity_block_size(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+  const iree_host_size_t last_index = IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1;
+  iree_task_affinity_t affinity =
+      iree_task_affinity_for_worker(last_index, block_size);
+  set = iree_task_affinity_expand(affinity, block_size);
+  EXPECT_EQ(block_size, iree_task_affinity_set_count_ones(set));
+  EXPECT_TRUE(iree_task_affinity_set_test(set, last_index));
+  EXPECT_EQ(block_size, iree_task_affinity_worker_count(affinity, block_size));
+}
+
+}  // namespace
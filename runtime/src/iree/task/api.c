@@ -44,6 +44,15 @@ IREE_FLAG(
     "be configured to make at least that amount of local memory available.\n"
     "By default the CPU L2 cache size is used if such queries are supported.");
 
+IREE_FLAG(
+    int32_t, task_donor_count, 0,
+    "Number of threads that may be donated to each executor at a time while\n"
+    "they wait on work (such as HAL semaphore waits on the host). Donated\n"
+    "threads steal and run tasks alongside the workers until their wait\n"
+    "resolves. Only callers with at least --task_worker_stack_size bytes of\n"
+    "stack remaining are donated and others just block. 0 disables donation\n"
+    "and waiting threads only block.");
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
@@ -54,6 +63,12 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
       (iree_host_size_t)FLAG_task_worker_local_memory;
+  if (FLAG_task_donor_count < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--task_donor_count must be >= 0 (got %d)",
+                            FLAG_task_donor_count);
+  }
+  out_options->donor_count = (iree_host_size_t)FLAG_task_donor_count;
   return iree_ok_status();
 }
 
@@ -308,6 +323,7 @@ static void iree_task_flags_dump_task_topology(
     const iree_task_topology_group_t* group = &topology->groups[j];
     fprintf(stdout, "# group[%d]: '%s'\n", group->group_index, group->name);
     fprintf(stdout, "#      processor: %u\n", group->processor_index);
+    fprintf(stdout, "#      numa node: %u\n", group->node_id);
     fprintf(stdout, "#       affinity: ");
     if (group->ideal_thread_affinity.group_any) {
       fprintf(stdout, "group=%u (any)", group->ideal_thread_affinity.group);
@@ -324,21 +340,21 @@ static void iree_task_flags_dump_task_topology(
             group->caches.l2_data);
 
     fprintf(stdout, "#  last level cache sharing: ");
-    if (group->constructive_sharing_mask == 0) {
+    if (iree_task_affinity_set_is_empty(group->constructive_sharing_mask)) {
       fprintf(stdout, "(none)\n");
-    } else if (group->constructive_sharing_mask ==
-               IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
+    } else if (iree_task_affinity_set_equal(
+                   group->constructive_sharing_mask,
+                   iree_task_topology_group_mask_all())) {
       fprintf(stdout, "(all/undefined)\n");
     } else {
       fprintf(stdout, "%d group(s): ",
-              iree_math_count_ones_u64(group->constructive_sharing_mask));
-      for (iree_host_size_t ic = 0, jc = 0;
-           ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
-        if ((group->constructive_sharing_mask >> ic) & 1) {
-          if (jc > 0) fprintf(stdout, ", ");
-          fprintf(stdout, "%" PRIhsz, ic);
-          ++jc;
-        }
+              iree_task_affinity_set_count_ones(
+                  group->constructive_sharing_mask));
+      iree_host_size_t jc = 0;
+      IREE_TASK_AFFINITY_SET_FOR_EACH(ic, group->constructive_sharing_mask) {
+        if (jc > 0) fprintf(stdout, ", ");
+        fprintf(stdout, "%" PRIhsz, ic);
+        ++jc;
       }
       fprintf(stdout, "\n");
     }
@@ -364,8 +380,7 @@ static iree_status_t iree_task_flags_dump_task_topologies(
     iree_task_topology_node_id_t node_base_id = 0;
     iree_host_size_t topology_index = 0;
     for (iree_host_size_t i = 0; i < topology_count; ++i) {
-      int node_offset =
-          iree_task_affinity_set_count_trailing_zeros(node_mask_bits);
+      int node_offset = iree_math_count_trailing_zeros_u64(node_mask_bits);
       iree_task_topology_node_id_t node_id = node_base_id + node_offset;
       node_base_id += node_offset + 1;
       node_mask_bits = iree_shr(node_mask_bits, node_offset + 1);
@@ -471,8 +486,7 @@ iree_status_t iree_task_executors_create_from_flags(
     uint64_t node_mask_bits = node_mask;
     iree_task_topology_node_id_t node_base_id = 0;
     for (iree_host_size_t i = 0; i < topology_count; ++i) {
-      int node_offset =
-          iree_task_affinity_set_count_trailing_zeros(node_mask_bits);
+      int node_offset = iree_math_count_trailing_zeros_u64(node_mask_bits);
       iree_task_topology_node_id_t node_id = node_base_id + node_offset;
       node_base_id += node_offset + 1;
       node_mask_bits = iree_shr(node_mask_bits, node_offset + 1);
@@ -11,7 +11,11 @@
 #include <string.h>
 
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/memory.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/internal/time.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor_impl.h"
 #include "iree/task/list.h"
@@ -29,13 +33,31 @@ void iree_task_executor_options_initialize(
   memset(out_options, 0, sizeof(*out_options));
 }
 
-// Returns the size of the worker local memory required by |group| in bytes.
-// We don't want destructive sharing between workers so ensure we are aligned to
-// at least the destructive interference size, even if a bit larger than what
-// the user asked for or the device supports.
+// Returns the alignment of each worker local memory span in bytes.
+// We don't want destructive sharing between workers so spans are aligned to at
+// least the destructive interference size. When the workers span multiple NUMA
+// nodes spans are whole pages so that the pages each worker touches first are
+// not shared with any other worker and first-touch placement puts them on the
+// node of the worker.
+static iree_host_size_t iree_task_topology_local_memory_alignment(
+    const iree_task_topology_t* topology) {
+  const iree_host_size_t group_count = iree_task_topology_group_count(topology);
+  for (iree_host_size_t i = 1; i < group_count; ++i) {
+    if (iree_task_topology_get_group(topology, i)->node_id !=
+        iree_task_topology_get_group(topology, 0)->node_id) {
+      return iree_max(iree_memory_query_info().normal_page_size,
+                      iree_hardware_destructive_interference_size);
+    }
+  }
+  return iree_hardware_destructive_interference_size;
+}
+
+// Returns the size of the worker local memory required by |group| in bytes,
+// rounded up to |alignment| even if a bit larger than what the user asked for
+// or the device supports.
 static iree_host_size_t iree_task_topology_group_local_memory_size(
     iree_task_executor_options_t options,
-    const iree_task_topology_group_t* group) {
+    const iree_task_topology_group_t* group, iree_host_size_t alignment) {
   iree_host_size_t worker_local_memory_size = options.worker_local_memory_size;
   if (!worker_local_memory_size) {
     worker_local_memory_size = group->caches.l2_data;
@@ -43,8 +65,7 @@ static iree_host_size_t iree_task_topology_group_local_memory_size(
   if (!worker_local_memory_size) {
     worker_local_memory_size = group->caches.l1_data;
   }
-  return iree_host_align(worker_local_memory_size,
-                         iree_hardware_destructive_interference_size);
+  return iree_host_align(worker_local_memory_size, alignment);
 }
 
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
@@ -71,12 +92,21 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
-  // The executor is followed in memory by worker[] + worker_local_memory[].
+  // The executor is followed in memory by worker[] + worker_local_memory[] +
+  // donor[] + donor_local_memory[]. Donors may run tasks from any worker and
+  // get as much local memory as the largest worker.
+  const iree_host_size_t local_memory_alignment =
+      iree_task_topology_local_memory_alignment(topology);
   iree_host_size_t total_worker_local_memory_size = 0;
+  iree_host_size_t donor_local_memory_size = 0;
   for (iree_host_size_t i = 0; i < worker_count; ++i) {
-    total_worker_local_memory_size +=
+    iree_host_size_t worker_local_memory_size =
         iree_task_topology_group_local_memory_size(
-            options, iree_task_topology_get_group(topology, i));
+            options, iree_task_topology_get_group(topology, i),
+            local_memory_alignment);
+    total_worker_local_memory_size += worker_local_memory_size;
+    donor_local_memory_size =
+        iree_max(donor_local_memory_size, worker_local_memory_size);
   }
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)total_worker_local_memory_size);
 
@@ -86,18 +116,51 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   iree_host_size_t worker_list_size =
       iree_host_align(worker_count * sizeof(iree_task_worker_t),
                       iree_hardware_destructive_interference_size);
+  iree_host_size_t donor_list_size =
+      iree_host_align(options.donor_count * sizeof(iree_task_donor_t),
+                      iree_hardware_destructive_interference_size);
+  // Padding to align the worker local memory as the allocation itself may not
+  // be aligned.
+  const iree_host_size_t worker_local_memory_padding =
+      local_memory_alignment - 1;
   iree_host_size_t executor_size =
-      executor_base_size + worker_list_size + total_worker_local_memory_size;
+      executor_base_size + worker_list_size + worker_local_memory_padding +
+      total_worker_local_memory_size + donor_list_size +
+      options.donor_count * donor_local_memory_size;
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, executor_size, (void**)&executor));
-  memset(executor, 0, executor_size);
+      z0, iree_allocator_malloc_uninitialized(allocator, executor_size,
+                                              (void**)&executor));
+  // NOTE: the worker local memory is left untouched here (including by the
+  // allocator) and is zeroed by each worker thread once it is running on its
+  // own processor(s) so that the pages are placed on the NUMA node of the
+  // worker.
+  memset(executor, 0, executor_base_size + worker_list_size);
+  uint8_t* worker_local_memory_base = (uint8_t*)iree_host_align(
+      (uintptr_t)executor + executor_base_size + worker_list_size,
+      local_memory_alignment);
+#if IREE_STATISTICS_ENABLE
+  executor->statistics_base_ticks = iree_platform_ticks_now();
+  executor->statistics_base_ns = iree_time_now();
+#endif  // IREE_STATISTICS_ENABLE
+  executor->donor_count = options.donor_count;
+  executor->donor_stack_size = options.worker_stack_size;
+  if (!executor->donor_stack_size) {
+    executor->donor_stack_size = IREE_TASK_EXECUTOR_DEFAULT_DONOR_STACK_SIZE;
+  }
+  executor->donors =
+      (iree_task_donor_t*)(worker_local_memory_base +
+                           total_worker_local_memory_size);
+  memset(executor->donors, 0,
+         donor_list_size + options.donor_count * donor_local_memory_size);
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
-  iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_atomic_task_slist_initialize(&executor->incoming_ready_slists[i]);
+  }
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
   IREE_TRACE({
@@ -125,8 +188,22 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   iree_prng_splitmix64_state_t seed_prng;
   iree_prng_splitmix64_initialize(/*seed=*/(uint64_t)(out_executor),
                                   &seed_prng);
-  iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(&seed_prng),
-                                  &executor->donation_theft_prng);
+
+  // Donor slots take the worker indices following the workers so that any
+  // per-worker state tasks index by worker ID does not collide.
+  uint8_t* donor_local_memory = (uint8_t*)executor->donors + donor_list_size;
+  for (iree_host_size_t i = 0; i < executor->donor_count; ++i) {
+    iree_task_donor_t* donor = &executor->donors[i];
+    donor->worker_index = options.worker_base_index + worker_count + i;
+    donor->local_memory =
+        iree_make_byte_span(donor_local_memory, donor_local_memory_size);
+    donor_local_memory += donor_local_memory_size;
+    iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(&seed_prng),
+                                    &donor->theft_prng);
+    for (iree_host_size_t j = 0; j < IREE_TASK_PRIORITY_COUNT; ++j) {
+      iree_task_queue_initialize(&donor->local_task_queues[j]);
+    }
+  }
 
   iree_status_t status = iree_ok_status();
 
@@ -165,10 +242,10 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   if (iree_status_is_ok(status)) {
     executor->worker_base_index = options.worker_base_index;
     executor->worker_count = worker_count;
+    executor->affinity_block_size = iree_task_affinity_block_size(worker_count);
     executor->workers =
         (iree_task_worker_t*)((uint8_t*)executor + executor_base_size);
-    uint8_t* worker_local_memory =
-        (uint8_t*)executor->workers + worker_list_size;
+    uint8_t* worker_local_memory = worker_local_memory_base;
 
     iree_task_affinity_set_t worker_mask =
         iree_task_affinity_set_ones(worker_count);
@@ -177,10 +254,13 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
       const iree_task_topology_group_t* group =
           iree_task_topology_get_group(topology, i);
       iree_host_size_t worker_local_memory_size =
-          iree_task_topology_group_local_memory_size(options, group);
+          iree_task_topology_group_local_memory_size(options, group,
+                                                     local_memory_alignment);
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
-          executor, i, group, options.worker_stack_size,
+          executor, i, group,
+          iree_task_topology_node_group_mask(topology, group->node_id),
+          options.worker_stack_size,
           iree_make_byte_span(worker_local_memory, worker_local_memory_size),
           &seed_prng, worker);
       worker_local_memory += worker_local_memory_size;
@@ -238,10 +318,18 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
     iree_task_worker_deinitialize(worker);
   }
   iree_task_poller_deinitialize(&executor->poller);
+  for (iree_host_size_t i = 0; i < executor->donor_count; ++i) {
+    iree_task_donor_t* donor = &executor->donors[i];
+    for (iree_host_size_t j = 0; j < IREE_TASK_PRIORITY_COUNT; ++j) {
+      iree_task_queue_deinitialize(&donor->local_task_queues[j]);
+    }
+  }
 
   iree_event_pool_free(executor->event_pool);
   iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
-  iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slists[i]);
+  }
   iree_task_pool_deinitialize(&executor->transient_task_pool);
   iree_allocator_free(executor->allocator, executor);
 
@@ -274,6 +362,107 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+iree_host_size_t iree_task_executor_worker_capacity(
+    iree_task_executor_t* executor) {
+  return executor->worker_count + executor->donor_count;
+}
+
+#if IREE_STATISTICS_ENABLE
+// Returns the number of nanoseconds per statistics tick as measured over the
+// lifetime of |executor|. Durations are counted in iree_platform_ticks_now
+// ticks as reading the tick counter is much cheaper than reading the time and
+// this is where they are converted.
+static double iree_task_executor_ns_per_tick(iree_task_executor_t* executor) {
+  const int64_t elapsed_ticks =
+      iree_platform_ticks_now() - executor->statistics_base_ticks;
+  const iree_time_t elapsed_ns = iree_time_now() - executor->statistics_base_ns;
+  if (elapsed_ticks <= 0 || elapsed_ns <= 0) return 1.0;
+  return (double)elapsed_ns / (double)elapsed_ticks;
+}
+#endif  // IREE_STATISTICS_ENABLE
+
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  out_statistics->worker_count = executor->worker_count;
+#if IREE_STATISTICS_ENABLE
+  const double ns_per_tick = iree_task_executor_ns_per_tick(executor);
+
+  // Work done by threads that aren't workers.
+  int64_t coordinate_ticks = iree_atomic_load(&executor->coordinate_ticks,
+                                              iree_memory_order_relaxed);
+  out_statistics->coordinate_count = iree_atomic_load(
+      &executor->coordinate_count, iree_memory_order_relaxed);
+  out_statistics->post_count =
+      iree_atomic_load(&executor->post_count, iree_memory_order_relaxed);
+  out_statistics->posted_task_count = iree_atomic_load(
+      &executor->posted_task_count, iree_memory_order_relaxed);
+  out_statistics->wake_request_count = iree_atomic_load(
+      &executor->wake_request_count, iree_memory_order_relaxed);
+  for (iree_host_size_t i = 0; i < executor->donor_count; ++i) {
+    out_statistics->donated_task_count += iree_atomic_load(
+        &executor->donors[i].task_count, iree_memory_order_relaxed);
+  }
+
+  // Work done by each worker including what it did on behalf of the executor.
+  iree_task_worker_statistics_t* total = &out_statistics->workers;
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    iree_task_worker_t* worker = &executor->workers[i];
+    iree_task_worker_statistics_t worker_statistics;
+    iree_task_worker_query_statistics(worker, ns_per_tick, &worker_statistics);
+    total->task_count += worker_statistics.task_count;
+    total->busy_ns += worker_statistics.busy_ns;
+    total->idle_ns += worker_statistics.idle_ns;
+    total->theft_attempt_count += worker_statistics.theft_attempt_count;
+    total->theft_count += worker_statistics.theft_count;
+    total->theft_ns += worker_statistics.theft_ns;
+    total->mailbox_flush_count += worker_statistics.mailbox_flush_count;
+    total->mailbox_task_count += worker_statistics.mailbox_task_count;
+    total->mailbox_max_depth = iree_max(total->mailbox_max_depth,
+                                        worker_statistics.mailbox_max_depth);
+    total->wake_count += worker_statistics.wake_count;
+    total->wake_latency_ns += worker_statistics.wake_latency_ns;
+
+    iree_task_worker_counters_t* counters = &worker->counters;
+    coordinate_ticks += iree_atomic_load(&counters->coordinate_ticks,
+                                         iree_memory_order_relaxed);
+    out_statistics->coordinate_count += iree_atomic_load(
+        &counters->coordinate_count, iree_memory_order_relaxed);
+    out_statistics->post_count +=
+        iree_atomic_load(&counters->post_count, iree_memory_order_relaxed);
+    out_statistics->posted_task_count += iree_atomic_load(
+        &counters->posted_task_count, iree_memory_order_relaxed);
+    out_statistics->wake_request_count += iree_atomic_load(
+        &counters->wake_request_count, iree_memory_order_relaxed);
+  }
+  out_statistics->coordinate_ns =
+      (iree_duration_t)(ns_per_tick * coordinate_ticks);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+iree_status_t iree_task_executor_query_worker_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_worker_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (worker_index >= executor->worker_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "worker index %" PRIhsz
+                            " out of range (executor has %" PRIhsz " workers)",
+                            worker_index, executor->worker_count);
+  }
+#if IREE_STATISTICS_ENABLE
+  iree_task_worker_query_statistics(&executor->workers[worker_index],
+                                    iree_task_executor_ns_per_tick(executor),
+                                    out_statistics);
+#endif  // IREE_STATISTICS_ENABLE
+  return iree_ok_status();
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -302,8 +491,9 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
 static void iree_task_executor_relay_to_worker(
     iree_task_executor_t* executor, iree_task_post_batch_t* post_batch,
     iree_task_t* task) {
-  iree_host_size_t worker_index =
-      iree_task_post_batch_select_worker(post_batch, task->affinity_set);
+  iree_host_size_t worker_index = iree_task_post_batch_select_worker(
+      post_batch,
+      iree_task_affinity_expand(task->affinity, executor->affinity_block_size));
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
@@ -391,13 +581,29 @@ void iree_task_executor_schedule_ready_tasks(
 
 void iree_task_executor_merge_submission(iree_task_executor_t* executor,
                                          iree_task_submission_t* submission) {
-  // Concatenate all of the incoming tasks into the submission list.
+  // Split the ready tasks by priority. Relative order within each priority is
+  // preserved. In the common case of all tasks sharing the same priority this
+  // is just a walk over the list.
+  iree_task_list_t priority_lists[IREE_TASK_PRIORITY_COUNT];
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_list_initialize(&priority_lists[i]);
+  }
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(&submission->ready_list))) {
+    iree_task_priority_t priority = iree_task_scope_priority(task->scope);
+    iree_task_list_push_back(&priority_lists[priority], task);
+  }
+
+  // Concatenate all of the incoming tasks into the submission lists.
   // Note that the submission stores tasks in LIFO order such that when they are
   // put into the LIFO atomic slist they match the order across all concats
   // (earlier concats are later in the LIFO list).
-  iree_atomic_task_slist_concat(&executor->incoming_ready_slist,
-                                submission->ready_list.head,
-                                submission->ready_list.tail);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    if (iree_task_list_is_empty(&priority_lists[i])) continue;
+    iree_atomic_task_slist_concat(&executor->incoming_ready_slists[i],
+                                  priority_lists[i].head,
+                                  priority_lists[i].tail);
+  }
 
   // Enqueue waiting tasks with the poller immediately: this may issue a
   // syscall to kick the poller. If we see bad context switches here then we
@@ -442,6 +648,9 @@ void iree_task_executor_flush(iree_task_executor_t* executor) {
 void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    iree_task_worker_t* current_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
+#if IREE_STATISTICS_ENABLE
+  const int64_t coordinate_start_ticks = iree_platform_ticks_now();
+#endif  // IREE_STATISTICS_ENABLE
 
   // We may be adding tasks/waiting/etc on each pass through coordination - to
   // ensure we completely drain the incoming queues and satisfied waits we loop
@@ -470,9 +679,18 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     // breadth-first traversal of task graphs even if they originate from
     // various places and have no relation - hopefully leading to better average
     // latency.
+    //
+    // Higher priority tasks are placed ahead of lower priority ones so that
+    // they are issued (and posted to workers) first.
     iree_task_submission_t pending_submission;
-    iree_task_submission_initialize_from_lifo_slist(
-        &executor->incoming_ready_slist, &pending_submission);
+    iree_task_submission_initialize(&pending_submission);
+    for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+      iree_task_submission_t priority_submission;
+      iree_task_submission_initialize_from_lifo_slist(
+          &executor->incoming_ready_slists[i], &priority_submission);
+      iree_task_list_append(&pending_submission.ready_list,
+                            &priority_submission.ready_list);
+    }
     if (iree_task_list_is_empty(&pending_submission.ready_list)) {
       iree_slim_mutex_unlock(&executor->coordinator_mutex);
       IREE_TRACE_ZONE_END(z1);
@@ -507,37 +725,46 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     schedule_dirty = iree_task_post_batch_submit(post_batch);
   } while (schedule_dirty);
 
+#if IREE_STATISTICS_ENABLE
+  const int64_t coordinate_ticks =
+      iree_platform_ticks_now() - coordinate_start_ticks;
+  if (current_worker) {
+    iree_task_worker_counter_add(&current_worker->counters.coordinate_count,
+                                 1);
+    iree_task_worker_counter_add(&current_worker->counters.coordinate_ticks,
+                                 coordinate_ticks);
+  } else {
+    iree_atomic_fetch_add(&executor->coordinate_count, 1,
+                          iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&executor->coordinate_ticks, coordinate_ticks,
+                          iree_memory_order_relaxed);
+  }
+#endif  // IREE_STATISTICS_ENABLE
+
   IREE_TRACE_ZONE_END(z0);
 }
 
 static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
-    iree_task_queue_t* local_task_queue) {
-  if (!victim_mask) return NULL;
+    uint32_t max_theft_attempts, iree_host_size_t max_theft_task_count,
+    iree_host_size_t start_index, iree_task_queue_t* local_task_queues) {
+  if (iree_task_affinity_set_is_empty(victim_mask)) return NULL;
   max_theft_attempts = iree_min(max_theft_attempts,
                                 iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
 
-  int worker_index = rotation_offset;
-  iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+  iree_host_size_t worker_index = start_index;
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
-    // Find the last set bit and skip to it. This avoids the need for doing
-    // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
+    // Find the next set bit (wrapping around) and skip to it. This avoids the
+    // need for doing a full O(n) scan and instead gets us at O(popcnt) * O(ctz)
+    // with whole empty words skipped in one step.
     //
-    // Example: sharing mask = 0b01010101
-    //          mask_rotation = 3 (randomly selected)
-    //          mask = 0b01010101 rotr 3 = 0b10101010
+    // Example: victim_mask = 0b01010101
+    //          start_index = 3 (randomly selected)
     //          for (i = 0; i < 4; ++i)
-    //            offset = ctz(0b10101010) = 1
-    //            mask_rotation += 1 = 4
-    //            mask >>= 1 = 0b01010101
-    //            victim_index = 4 % 64 = 4
-    int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
-    worker_index += offset + 1;
-    mask = iree_shr(mask, offset + 1);
+    //            victim_index = 4, 6, 0, 2
+    iree_host_size_t victim_index =
+        iree_task_affinity_set_find_next_wrapping(victim_mask, worker_index);
+    worker_index = victim_index + 1;
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
     if (iree_atomic_load(&victim_worker->state, iree_memory_order_acquire) !=
         IREE_TASK_WORKER_STATE_RUNNING) {
@@ -551,8 +778,8 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     // thievery taking ~half of the tasks each time (across all queues) will
     // lead to a relatively even distribution.
     iree_task_t* task = iree_task_worker_try_steal_task(
-        victim_worker, local_task_queue,
-        /*max_tasks=*/IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT);
+        victim_worker, local_task_queues,
+        /*max_tasks=*/max_theft_task_count);
     if (task) return task;
   }
 
@@ -562,7 +789,7 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
-// May steal multiple tasks and add them to the |local_task_queue|.
+// May steal multiple tasks and add them to the |local_task_queues|.
 //
 // We do a scan through ideal victims indicated by the
 // |constructive_sharing_mask|; these are the workers most likely to have some
@@ -577,8 +804,10 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
-    iree_task_queue_t* local_task_queue) {
+    iree_task_affinity_set_t node_sharing_mask, bool allow_remote_theft,
+    uint32_t max_theft_attempts, iree_host_size_t max_theft_task_count,
+    iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_queue_t* local_task_queues) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // The masks are accessed with 'relaxed' order because they are just hints.
@@ -590,31 +819,55 @@ iree_task_t* iree_task_executor_try_steal_task(
                                          iree_memory_order_relaxed);
   // Limit the workers we will steal from to the ones that are currently live
   // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
+  iree_task_affinity_set_t victim_mask =
+      iree_task_affinity_set_and_not(worker_live_mask, worker_idle_mask);
 
   // TODO(benvanik): it may be possible to rework this such that we better
-  // use the prng; for example, instead of all this rotating stuff we could just
-  // generate an 8-bit number (or even split it into two 4-bit numbers) per
-  // theft attempt. The current rotation strategy is biased toward the same try
-  // ordering vs. what we may really want with an unbiased random selection.
-  int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
-                        (8 * sizeof(iree_task_affinity_set_t) - 1);
+  // use the prng; for example, instead of picking a starting point we could
+  // just generate a new index per theft attempt. The current strategy is
+  // biased toward the same try ordering vs. what we may really want with an
+  // unbiased random selection.
+  uint32_t rotation = iree_prng_minilcg128_next_uint8(theft_prng);
+#if IREE_TASK_EXECUTOR_MAX_WORKER_COUNT > 256
+  rotation = (rotation << 8) | iree_prng_minilcg128_next_uint8(theft_prng);
+#endif  // IREE_TASK_EXECUTOR_MAX_WORKER_COUNT > 256
+  iree_host_size_t start_index = rotation % executor->worker_count;
 
   // Try first with the workers we may have some caches shared with. This
   // helps to prevent cache invalidations/availability updates as it's likely
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
+  iree_task_affinity_set_t node_victim_mask =
+      iree_task_affinity_set_and(victim_mask, node_sharing_mask);
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+      executor,
+      iree_task_affinity_set_and(node_victim_mask, constructive_sharing_mask),
+      max_theft_attempts, max_theft_task_count, start_index,
+      local_task_queues);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
+    // Next try the workers on the same NUMA node: we may miss in cache but at
+    // least the tasks and what they touch are behind the same memory
+    // controller.
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+        executor,
+        iree_task_affinity_set_and_not(node_victim_mask,
+                                       constructive_sharing_mask),
+        max_theft_attempts, max_theft_task_count, start_index,
+        local_task_queues);
     if (task) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "node");
+    } else if (allow_remote_theft) {
+      // Last resort: cross the interconnect to workers on other nodes.
+      task = iree_task_executor_try_steal_task_from_affinity_set(
+          executor,
+          iree_task_affinity_set_and_not(victim_mask, node_sharing_mask),
+          max_theft_attempts, max_theft_task_count, start_index,
+          local_task_queues);
+      if (task) {
+        IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
+      }
     }
   }
 
@@ -622,6 +875,120 @@ iree_task_t* iree_task_executor_try_steal_task(
   return task;
 }
 
+// Tries to claim a free donor slot for the calling thread.
+// Returns NULL if all slots are occupied (or none were reserved).
+static iree_task_donor_t* iree_task_executor_acquire_donor(
+    iree_task_executor_t* executor) {
+  for (iree_host_size_t i = 0; i < executor->donor_count; ++i) {
+    iree_task_donor_t* donor = &executor->donors[i];
+    int32_t expected = 0;
+    if (iree_atomic_compare_exchange_strong(
+            &donor->is_occupied, &expected, 1, iree_memory_order_acquire,
+            iree_memory_order_relaxed)) {
+      return donor;
+    }
+  }
+  return NULL;
+}
+
+static void iree_task_executor_release_donor(iree_task_donor_t* donor) {
+  iree_atomic_store(&donor->is_occupied, 0, iree_memory_order_release);
+}
+
+// Executes a task stolen by a donor thread.
+// Donors run shards with a NULL preemption mask as they have no mailbox for
+// higher priority work to arrive through and never yield.
+static void iree_task_executor_donor_execute(
+    iree_task_donor_t* donor, iree_cpu_processor_id_t processor_id,
+    iree_task_t* task, iree_task_submission_t* pending_submission) {
+  switch (task->type) {
+    case IREE_TASK_TYPE_CALL: {
+      iree_task_call_execute((iree_task_call_t*)task, pending_submission);
+      break;
+    }
+    case IREE_TASK_TYPE_DISPATCH_SHARD: {
+      iree_task_dispatch_shard_execute(
+          (iree_task_dispatch_shard_t*)task, processor_id,
+          (uint32_t)donor->worker_index, donor->local_memory,
+          /*pending_priority_mask=*/NULL, pending_submission);
+      break;
+    }
+    default:
+      IREE_ASSERT_UNREACHABLE("incorrect task type for donor execution");
+      break;
+  }
+}
+
+// Runs stolen tasks on the calling thread until |wait_source| resolves or
+// |deadline_ns| is reached. Tasks are stolen one at a time so that the donor
+// never holds work that other workers could be running when it returns.
+static iree_status_t iree_task_executor_donate_until(
+    iree_task_executor_t* executor, iree_task_donor_t* donor,
+    iree_wait_source_t wait_source, iree_time_t deadline_ns) {
+  // Tasks expect to run with the same FPU state as they do on workers.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+
+  iree_cpu_processor_tag_t processor_tag = 0;
+  iree_cpu_processor_id_t processor_id = 0;
+  iree_cpu_requery_processor_id(&processor_tag, &processor_id);
+
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    status = iree_wait_source_query(wait_source, &wait_status_code);
+    if (!iree_status_is_ok(status) ||
+        wait_status_code != IREE_STATUS_DEFERRED) {
+      break;
+    }
+
+    iree_task_affinity_set_t worker_live_mask =
+        iree_atomic_task_affinity_set_load(&executor->worker_live_mask,
+                                           iree_memory_order_relaxed);
+    iree_task_t* task = iree_task_executor_try_steal_task(
+        executor, worker_live_mask, worker_live_mask,
+        /*allow_remote_theft=*/true,
+        /*max_theft_attempts=*/(uint32_t)executor->worker_count,
+        /*max_theft_task_count=*/1, &donor->theft_prng,
+        donor->local_task_queues);
+    if (task) {
+      iree_task_submission_t pending_submission;
+      iree_task_submission_initialize(&pending_submission);
+      iree_task_executor_donor_execute(donor, processor_id, task,
+                                       &pending_submission);
+#if IREE_STATISTICS_ENABLE
+      iree_task_worker_counter_add(&donor->task_count, 1);
+#endif  // IREE_STATISTICS_ENABLE
+      if (!iree_task_submission_is_empty(&pending_submission)) {
+        iree_task_executor_merge_submission(executor, &pending_submission);
+        iree_task_executor_coordinate(executor, /*current_worker=*/NULL);
+      }
+      continue;
+    }
+
+    // Nothing to steal: block on the wait source for a short slice so that
+    // we can help out again if more work shows up before it resolves.
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) break;
+    iree_time_t slice_deadline_ns = iree_min(
+        deadline_ns, now_ns + IREE_TASK_EXECUTOR_DONATION_WAIT_SLICE_NS);
+    status = iree_wait_source_wait_one(
+        wait_source, iree_make_deadline(slice_deadline_ns));
+    if (iree_status_is_deadline_exceeded(status)) {
+      status = iree_status_ignore(status);
+    } else if (!iree_status_is_ok(status)) {
+      break;
+    }
+    iree_cpu_requery_processor_id(&processor_tag, &processor_id);
+  }
+
+  iree_fpu_state_pop(fpu_state);
+  if (!iree_status_is_ok(status)) return status;
+
+  // Resolve the final result (resolved, failed, or timed out).
+  return iree_wait_source_wait_one(wait_source, iree_immediate_timeout());
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
                                                iree_timeout_t timeout) {
@@ -630,12 +997,24 @@ iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
   // Perform an immediate flush/coordination (in case the caller queued).
   iree_task_executor_flush(executor);
 
-  // Wait until completed.
-  // TODO(benvanik): make this steal tasks until wait_handle resolves?
-  // Somewhat dangerous as we don't know what kind of thread we are running on;
-  // it may have a smaller stack than we are expecting or have some weird thread
-  // local state (FPU rounding modes/etc).
-  iree_status_t status = iree_wait_source_wait_one(wait_source, timeout);
+  // Help out with work until completed if we can get a donor slot and
+  // otherwise just wait. Tasks may use as much stack as they would on a worker
+  // and callers without that much headroom left (or on platforms where it
+  // can't be queried) only wait.
+  iree_status_t status = iree_ok_status();
+  iree_task_donor_t* donor = NULL;
+  if (executor->donor_count > 0 &&
+      iree_thread_stack_headroom() >= executor->donor_stack_size) {
+    donor = iree_task_executor_acquire_donor(executor);
+  }
+  if (donor) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "donated");
+    status = iree_task_executor_donate_until(
+        executor, donor, wait_source, iree_timeout_as_deadline_ns(timeout));
+    iree_task_executor_release_donor(donor);
+  } else {
+    status = iree_wait_source_wait_one(wait_source, timeout);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
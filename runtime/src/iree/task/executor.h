@@ -113,14 +113,15 @@ extern "C" {
 //      as iree_wait_handle_t then it is placed into the waiting_list.
 //
 // 2. iree_task_executor_submit (LIFO, atomic slist)
-//    Submissions have their task thread-local lists concatenated into a LIFO
-//    incoming_ready_slist or the wait poller shared by the executor.
+//    Submissions have their task thread-local lists concatenated into the LIFO
+//    incoming_ready_slists (one per scope priority) or the wait poller shared
+//    by the executor.
 //
 // 3. iree_task_executor_flush (or a worker puts on its coordinator hat 🎩)
 //
-//   a. Tasks are flushed from the incoming_ready_slist into a coordinator-local
-//      FIFO task queue. This centralizes enqueuing from all threads into a
-//      single ordered list.
+//   a. Tasks are flushed from the incoming_ready_slists into a
+//      coordinator-local FIFO task queue with higher priority tasks first.
+//      This centralizes enqueuing from all threads into a single ordered list.
 //
 //   b. iree_task_executor_schedule_ready_tasks: walks the FIFO task queue and
 //      builds a iree_task_post_batch_t containing the per-worker tasks
@@ -135,16 +136,19 @@ extern "C" {
 //    each worker will check its mailbox_slist to see if any tasks have been
 //    posted.
 //
-//    a. Tasks are flushed from the LIFO mailbox into the local_task_queue FIFO
-//       for the particular worker.
+//    a. Tasks are flushed from the LIFO mailbox into the local_task_queues
+//       FIFOs (one per scope priority) for the particular worker.
 //
 //    b. If the mailbox is empty the worker *may* attempt to steal work from
 //       another nearby worker in the topology.
 //
-//    c. Any tasks in the local_task_queue are executed until empty.
+//    c. Any tasks in the local_task_queues are executed until empty, highest
+//       priority first. Dispatch shards check for higher priority tasks posted
+//       to the mailbox between tile reservations and yield back to the queue
+//       if any have arrived.
 //       Tasks are retired and dependent tasks (via completion_task or barriers)
-//       are made ready and placed in the executor incoming_ready_slist as with
-//       iree_task_executor_submit.
+//       are made ready and placed in the executor incoming_ready_slists as
+//       with iree_task_executor_submit.
 //
 //    d. If no more thread-local work is available and the mailbox_slist is
 //       empty the worker will self-nominate for coordination and attempt to don
@@ -220,9 +224,13 @@ extern "C" {
 // Scaling Up
 //==============================================================================
 //
-// The task system has an implicit limit of 64 workers. This intentional
-// limitation simplifies several parts of the code while also preventing misuse:
-// it rarely (if ever) makes sense to have more than 64 compute-dominated
+// The task system has a compile-time limit of
+// IREE_TASK_EXECUTOR_MAX_WORKER_COUNT workers (256 by default) such that
+// many-core machines (128/192-core server parts) can be covered by a single
+// executor when a single queue is required. Worker sets are stored as arrays of
+// 64-bit words and executors with more than 64 workers use task affinities
+// that select blocks of workers instead of individual workers.
+// That said, it rarely makes sense to have more than 64 compute-dominated
 // threads working on a single problem. Achieving high performance in such
 // situations requires extremely careful control over the OS scheduler, memory
 // bandwidth consumption, and synchronization. It's always possible to make the
@@ -302,7 +310,20 @@ typedef struct iree_task_executor_options_t {
   // for their invocations and no more. May be 0 if no worker local memory is
   // required.
   // By default the CPU L2 cache size is used if such queries are supported.
+  //
+  // The memory is first touched by each worker after it has been pinned to its
+  // processors so that on platforms with first-touch page placement (Linux)
+  // it is local to the worker's NUMA node. When the workers span multiple
+  // nodes each worker's memory is rounded up to whole pages so that no page is
+  // shared between workers.
   iree_host_size_t worker_local_memory_size;
+
+  // Maximum number of threads that may be donated to the executor at the same
+  // time with iree_task_executor_donate_caller. Each donor slot reserves as
+  // much local memory as the largest worker and a worker index following those
+  // of the workers (see iree_task_executor_worker_capacity). When 0 donated
+  // threads only flush pending work and then wait.
+  iree_host_size_t donor_count;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -336,6 +357,78 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Returns the total number of worker indices that may be observed by tasks
+// executing on the executor: the worker count plus any donor slots. Users
+// preallocating per-worker storage must size it to this.
+iree_host_size_t iree_task_executor_worker_capacity(
+    iree_task_executor_t* executor);
+
+// Scheduler telemetry for a single worker accumulated since executor creation.
+// Counters are maintained with relaxed atomics by the worker (and by threads
+// posting work to it) and may tear when queried while work is in-flight.
+// Durations are measured with a CPU tick counter where available and converted
+// to nanoseconds using the tick rate observed since executor creation so they
+// are approximate shortly after creation.
+// All counters are zero when IREE_STATISTICS_ENABLE is not set.
+typedef struct iree_task_worker_statistics_t {
+  // Total number of tasks executed by the worker.
+  int64_t task_count;
+  // Total time spent executing tasks.
+  iree_duration_t busy_ns;
+  // Total time spent spinning or sleeping waiting for work to be posted.
+  iree_duration_t idle_ns;
+  // Number of attempts to steal work from other workers after running out.
+  int64_t theft_attempt_count;
+  // Number of theft attempts that returned a task.
+  int64_t theft_count;
+  // Total time spent trying to steal work (successful or not).
+  iree_duration_t theft_ns;
+  // Number of times tasks posted to the worker mailbox were moved into its
+  // local queues and the total number of tasks moved.
+  int64_t mailbox_flush_count;
+  int64_t mailbox_task_count;
+  // Largest number of tasks found in the mailbox by a single flush.
+  int64_t mailbox_max_depth;
+  // Number of times the worker resumed after being posted work while idle and
+  // the total latency from the post until it was running again.
+  int64_t wake_count;
+  iree_duration_t wake_latency_ns;
+} iree_task_worker_statistics_t;
+
+// Scheduler telemetry for an executor accumulated since creation.
+// See iree_task_worker_statistics_t for caveats.
+typedef struct iree_task_executor_statistics_t {
+  // Number of workers summed into |workers|.
+  iree_host_size_t worker_count;
+  // Statistics summed across all workers. mailbox_max_depth is the maximum
+  // across all workers.
+  iree_task_worker_statistics_t workers;
+  // Number of coordination passes run by any thread and the time spent in them
+  // (including waiting for other coordinators to finish).
+  int64_t coordinate_count;
+  iree_duration_t coordinate_ns;
+  // Number of post batches that posted tasks to workers and the total number
+  // of tasks posted.
+  int64_t post_count;
+  int64_t posted_task_count;
+  // Number of wakes requested for idle workers when posting to them.
+  int64_t wake_request_count;
+  // Number of tasks executed by threads donated with
+  // iree_task_executor_donate_caller.
+  int64_t donated_task_count;
+} iree_task_executor_statistics_t;
+
+// Queries a snapshot of the scheduler statistics of |executor|.
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics);
+
+// Queries a snapshot of the scheduler statistics of the worker at
+// |worker_index| local to |executor| (in [0, worker_count)).
+iree_status_t iree_task_executor_query_worker_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_worker_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -379,10 +472,23 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // resolves or |timeout| is exceeded. Flushes any pending task batches prior
 // to doing any work or waiting.
 //
-// If there are no tasks available then the calling thread will block as if
-// iree_wait_source_wait_one had been used on |wait_source|. If tasks are ready
-// then the caller will not block prior to starting to perform work on behalf of
-// the executor.
+// If the executor was created with donor slots (options.donor_count) and one is
+// free the calling thread acts as a temporary worker: it steals tasks from the
+// workers one at a time and executes them until |wait_source| resolves, only
+// blocking for short periods when there is no work available. While donated
+// the thread runs with the same FPU state as the workers (flushing denormals)
+// and its original state is restored before returning. Tasks may use as much
+// stack as they would on workers (options.worker_stack_size) and the thread is
+// only donated if it has at least that much stack remaining (or
+// IREE_TASK_EXECUTOR_DEFAULT_DONOR_STACK_SIZE when the workers use the platform
+// default); threads that don't, or whose stack can't be queried, never run
+// tasks.
+//
+// If there are no donor slots free or the thread can't be donated then it will
+// block as if iree_wait_source_wait_one had been used on |wait_source|. All
+// blocking (including the short waits a donor performs when there's nothing to
+// steal) goes through |wait_source| so any wait behavior it carries (such as
+// spinning) is preserved.
 //
 // Donation is intended as an optimization to elide context switches when the
 // caller would have waited anyway; now instead of performing a kernel wait and
@@ -25,6 +25,37 @@
 extern "C" {
 #endif  // __cplusplus
 
+// A slot occupied by a thread donated to the executor with
+// iree_task_executor_donate_caller while it steals and executes tasks.
+// Donors act like temporary workers without threads of their own: they have
+// their own worker index and local memory but own no tasks and are never stolen
+// from.
+typedef struct iree_task_donor_t {
+  // Nonzero while a donated thread is using the slot.
+  iree_atomic_int32_t is_occupied;
+
+  // Globally unique worker index reported to tiles executed by the donor.
+  // Donor indices follow all worker indices of the executor.
+  iree_host_size_t worker_index;
+
+  // Donor-local memory used in the same way as worker-local memory.
+  iree_byte_span_t local_memory;
+
+  // State used by the work-stealing operations performed by the donor.
+  iree_prng_minilcg128_state_t theft_prng;
+
+  // Queues stolen tasks are moved into, one per iree_task_priority_t. Donors
+  // only steal one task at a time and as such these are always empty outside
+  // of a theft.
+  iree_task_queue_t local_task_queues[IREE_TASK_PRIORITY_COUNT];
+
+#if IREE_STATISTICS_ENABLE
+  // Number of tasks executed in the slot. Only written by the thread
+  // occupying the slot.
+  iree_atomic_int64_t task_count;
+#endif  // IREE_STATISTICS_ENABLE
+} iree_task_donor_t;
+
 struct iree_task_executor_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
@@ -42,14 +73,6 @@ struct iree_task_executor_t {
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
-  // State used by the work-stealing operations performed by donated threads.
-  // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
-  // much care about the precise selection of workers enough to mind any tears
-  // we get in the PRNG state that lives inside. Cache write-back order and
-  // incidental cache line availability/visibility update frequency is like an
-  // extra layer of PRNG anyway ;)
-  iree_prng_minilcg128_state_t donation_theft_prng;
-
   // Pools of transient dispatch tasks shared across all workers.
   // Depending on configuration the task pool may allocate after creation using
   // the allocator provided upon executor creation.
@@ -58,6 +81,11 @@ struct iree_task_executor_t {
   //   iree_task_fence_t
   //   iree_task_dispatch_shard_t
   // Increasing the size larger than these will waste memory.
+  //
+  // The pool is not split per NUMA node: shards are acquired and written by
+  // the worker coordinating a dispatch and then read by whichever workers run
+  // them, so there is no single node to place them on. Pool blocks are
+  // first-touched by the coordinator that grows the pool.
   iree_task_pool_t transient_task_pool;
 
   // A list of incoming tasks that are ready to execute immediately.
@@ -74,7 +102,11 @@ struct iree_task_executor_t {
   //   existing tasks: C B A
   //        new tasks: 1 2 3
   //    updated tasks: 3 2 1 C B A
-  iree_atomic_task_slist_t incoming_ready_slist;
+  //
+  // There is one list per iree_task_priority_t so that coordination can
+  // schedule higher priority tasks ahead of lower priority ones regardless of
+  // submission order.
+  iree_atomic_task_slist_t incoming_ready_slists[IREE_TASK_PRIORITY_COUNT];
 
   // iree_event_t pool used to acquire system wait handles.
   // Many subsystems interacting with the executor will need events to park
@@ -126,6 +158,32 @@ struct iree_task_executor_t {
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // Number of workers selected by each bit of a task iree_task_affinity_t.
+  // 1 unless there are more than 64 workers.
+  iree_host_size_t affinity_block_size;
+
+  // Slots for threads donated with iree_task_executor_donate_caller.
+  iree_host_size_t donor_count;
+  iree_task_donor_t* donors;  // [donor_count]
+  // Minimum stack headroom a calling thread needs to act as a donor.
+  iree_host_size_t donor_stack_size;
+
+#if IREE_STATISTICS_ENABLE
+  // Tick counter value and time at creation used to convert tick durations to
+  // nanoseconds when statistics are queried.
+  int64_t statistics_base_ticks;
+  iree_time_t statistics_base_ns;
+
+  // Counters for coordination and posting performed by threads that are not
+  // workers (submitters and donors). Workers keep their own counters and they
+  // are summed with these when queried.
+  iree_atomic_int64_t coordinate_count;
+  iree_atomic_int64_t coordinate_ticks;
+  iree_atomic_int64_t post_count;
+  iree_atomic_int64_t posted_task_count;
+  iree_atomic_int64_t wake_request_count;
+#endif  // IREE_STATISTICS_ENABLE
 };
 
 // Merges a submission into the primary FIFO queues.
@@ -156,12 +214,19 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
-// May steal multiple tasks and add them to the |local_task_queue|.
+// May steal up to |max_theft_task_count| tasks and add all but the returned one
+// to the |local_task_queues|.
+//
+// Victims sharing caches (|constructive_sharing_mask|) are tried first and then
+// the remaining victims on the same NUMA node (|node_sharing_mask|). Victims on
+// other nodes are only tried if |allow_remote_theft| is set.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
-    iree_task_queue_t* local_task_queue);
+    iree_task_affinity_set_t node_sharing_mask, bool allow_remote_theft,
+    uint32_t max_theft_attempts, iree_host_size_t max_theft_task_count,
+    iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_queue_t* local_task_queues);
 
 #ifdef __cplusplus
 }  // extern "C"
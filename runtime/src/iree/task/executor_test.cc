@@ -6,13 +6,31 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
 
+#include "iree/base/internal/memory.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
+#if defined(IREE_PLATFORM_LINUX)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_LINUX
+
 namespace {
 
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
 // Tests that an executor can be created and destroyed repeatedly without
 // running out of system resources. Since all systems are different there's no
 // guarantee this will fail but it does give ASAN/TSAN some nice stuff to chew
@@ -135,4 +153,543 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that an executor with more workers than fit in a single affinity word
+// runs all of them. Each tile blocks until every tile has started and as such
+// the dispatch can only complete if all workers execute a tile concurrently.
+TEST(ExecutorTest, ManyWorkers) {
+  static constexpr iree_host_size_t kWorkerCount = 96;
+  static_assert(kWorkerCount <= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT,
+                "worker limit too low for test");
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 4 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::set<uint32_t> worker_ids;
+    bool timed_out = false;
+  } state;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)kWorkerCount, 1, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            State* state = (State*)user_context;
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->worker_ids.insert(tile_context->worker_id);
+            state->cond.notify_all();
+            if (!state->cond.wait_for(lock, std::chrono::seconds(30), [&] {
+                  return state->worker_ids.size() == kWorkerCount;
+                })) {
+              state->timed_out = true;
+            }
+            return iree_ok_status();
+          },
+          &state),
+      workgroup_size, workgroup_count, &dispatch);
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&dispatch.header, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+  EXPECT_FALSE(state.timed_out);
+  ASSERT_EQ(state.worker_ids.size(), kWorkerCount);
+  EXPECT_EQ(*state.worker_ids.begin(), 0u);
+  EXPECT_EQ(*state.worker_ids.rbegin(), kWorkerCount - 1);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+#if defined(IREE_PLATFORM_LINUX)
+// Returns the NUMA node the page containing |ptr| is placed on or -1 if it
+// cannot be queried.
+static int QueryPageNode(const void* ptr) {
+  int node = -1;
+  // get_mempolicy(MPOL_F_NODE | MPOL_F_ADDR)
+  if (syscall(SYS_get_mempolicy, &node, NULL, 0, ptr, 1 | 2) != 0) return -1;
+  return node;
+}
+
+// Returns the NUMA node the calling thread is running on or -1 if it cannot
+// be queried.
+static int QueryCurrentNode() {
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return -1;
+  return (int)node;
+}
+
+// Pins each group of |topology| to one of the processors the process may run
+// on so that workers do not migrate between nodes.
+static void PinGroups(iree_task_topology_t* topology) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) return;
+  uint32_t cpu = 0;
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    for (uint32_t j = 0; j < CPU_SETSIZE && !CPU_ISSET(cpu, &cpu_set); ++j) {
+      cpu = (cpu + 1) % CPU_SETSIZE;
+    }
+    iree_thread_affinity_t* affinity =
+        &topology->groups[i].ideal_thread_affinity;
+    memset(affinity, 0, sizeof(*affinity));
+    affinity->id_assigned = 1;
+    affinity->id = cpu;
+    cpu = (cpu + 1) % CPU_SETSIZE;
+  }
+}
+#else
+static int QueryPageNode(const void* ptr) { return -1; }
+static int QueryCurrentNode() { return -1; }
+static void PinGroups(iree_task_topology_t* topology) {}
+#endif  // IREE_PLATFORM_LINUX
+
+// Tests that when workers span NUMA nodes their local memory is zeroed in
+// whole pages not shared with any other worker and that the pages are first
+// touched by the worker so that they are placed on its node.
+TEST(ExecutorTest, NodeLocalMemory) {
+  static constexpr iree_host_size_t kWorkerCount = 4;
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  // Not a multiple of the page size.
+  options.worker_local_memory_size = 1000;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  PinGroups(&topology);
+  topology.groups[2].node_id = 1;
+  topology.groups[3].node_id = 1;
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  struct WorkerMemory {
+    iree_byte_span_t local_memory = iree_byte_span_empty();
+    bool is_zero = false;
+    int page_node = -1;
+    int current_node = -1;
+  };
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::set<uint32_t> worker_ids;
+    WorkerMemory workers[kWorkerCount];
+  } state;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)kWorkerCount, 1, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            State* state = (State*)user_context;
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (tile_context->worker_id < kWorkerCount &&
+                state->worker_ids.insert(tile_context->worker_id).second) {
+              WorkerMemory* worker = &state->workers[tile_context->worker_id];
+              worker->local_memory = tile_context->local_memory;
+              worker->is_zero = true;
+              for (iree_host_size_t i = 0;
+                   i < tile_context->local_memory.data_length; ++i) {
+                worker->is_zero &= tile_context->local_memory.data[i] == 0;
+              }
+              worker->page_node =
+                  QueryPageNode(tile_context->local_memory.data);
+              worker->current_node = QueryCurrentNode();
+            }
+            // Hold each worker until all have run a tile.
+            state->cond.notify_all();
+            state->cond.wait_for(lock, std::chrono::seconds(30), [&] {
+              return state->worker_ids.size() == kWorkerCount;
+            });
+            return iree_ok_status();
+          },
+          &state),
+      workgroup_size, workgroup_count, &dispatch);
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&dispatch.header, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  ASSERT_EQ(state.worker_ids.size(), kWorkerCount);
+
+  const uintptr_t page_size = iree_memory_query_info().normal_page_size;
+  for (iree_host_size_t i = 0; i < kWorkerCount; ++i) {
+    const WorkerMemory& worker = state.workers[i];
+    const uintptr_t begin = (uintptr_t)worker.local_memory.data;
+    EXPECT_EQ(begin % page_size, 0u) << "worker " << i;
+    EXPECT_EQ(worker.local_memory.data_length % page_size, 0u)
+        << "worker " << i;
+    EXPECT_GE(worker.local_memory.data_length,
+              options.worker_local_memory_size);
+    EXPECT_TRUE(worker.is_zero) << "worker " << i;
+    for (iree_host_size_t j = 0; j < i; ++j) {
+      const WorkerMemory& other = state.workers[j];
+      const uintptr_t other_begin = (uintptr_t)other.local_memory.data;
+      EXPECT_TRUE(begin >= other_begin + other.local_memory.data_length ||
+                  other_begin >= begin + worker.local_memory.data_length)
+          << "workers " << j << " and " << i << " overlap";
+    }
+    // Pages are first touched by the pinned worker so they land on its node.
+    if (worker.page_node >= 0 && worker.current_node >= 0) {
+      EXPECT_EQ(worker.page_node, worker.current_node) << "worker " << i;
+    }
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that a dispatch in a high priority scope preempts a long-running
+// dispatch in a low priority scope between tile reservations.
+TEST(ExecutorTest, PriorityPreemption) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  struct State {
+    iree_task_executor_t* executor;
+    iree_task_scope_t low_scope;
+    iree_task_scope_t high_scope;
+    iree_task_dispatch_t high_dispatch;
+    std::atomic<uint32_t> low_tile_count = {0};
+    std::atomic<uint32_t> low_tile_count_at_high = {UINT32_MAX};
+  } state;
+  state.executor = executor;
+  iree_task_scope_initialize(iree_make_cstring_view("low"),
+                             IREE_TASK_SCOPE_FLAG_PRIORITY_LOW,
+                             &state.low_scope);
+  iree_task_scope_initialize(iree_make_cstring_view("high"),
+                             IREE_TASK_SCOPE_FLAG_PRIORITY_HIGH,
+                             &state.high_scope);
+
+  // The first low priority tile submits the high priority dispatch. With a
+  // single worker the only way it can run before all low priority tiles
+  // complete is if the low priority shard yields to it.
+  static constexpr uint32_t kLowTileCount = 256;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t low_workgroup_count[3] = {kLowTileCount, 1, 1};
+  iree_task_dispatch_t low_dispatch;
+  iree_task_dispatch_initialize(
+      &state.low_scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            State* state = (State*)user_context;
+            if (state->low_tile_count++ > 0) return iree_ok_status();
+            const uint32_t workgroup_size[3] = {1, 1, 1};
+            const uint32_t workgroup_count[3] = {1, 1, 1};
+            iree_task_dispatch_initialize(
+                &state->high_scope,
+                iree_task_make_dispatch_closure(
+                    [](void* user_context,
+                       const iree_task_tile_context_t* tile_context,
+                       iree_task_submission_t* pending_submission) {
+                      State* state = (State*)user_context;
+                      state->low_tile_count_at_high =
+                          state->low_tile_count.load();
+                      return iree_ok_status();
+                    },
+                    state),
+                workgroup_size, workgroup_count, &state->high_dispatch);
+            iree_task_fence_t* fence = NULL;
+            IREE_RETURN_IF_ERROR(iree_task_executor_acquire_fence(
+                state->executor, &state->high_scope, &fence));
+            iree_task_set_completion_task(&state->high_dispatch.header,
+                                          &fence->header);
+            iree_task_submission_t submission;
+            iree_task_submission_initialize(&submission);
+            iree_task_submission_enqueue(&submission,
+                                         &state->high_dispatch.header);
+            iree_task_executor_submit(state->executor, &submission);
+            iree_task_executor_flush(state->executor);
+            return iree_ok_status();
+          },
+          &state),
+      workgroup_size, low_workgroup_count, &low_dispatch);
+  iree_task_fence_t* low_fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &state.low_scope,
+                                                  &low_fence));
+  iree_task_set_completion_task(&low_dispatch.header, &low_fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &low_dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&state.low_scope, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&state.high_scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(state.low_tile_count.load(), kLowTileCount);
+  EXPECT_LT(state.low_tile_count_at_high.load(), kLowTileCount);
+
+  iree_task_scope_deinitialize(&state.high_scope);
+  iree_task_scope_deinitialize(&state.low_scope);
+  iree_task_executor_release(executor);
+}
+
+// Wait source resolving when |scope| goes idle.
+static iree_status_t ScopeIdleWaitSourceCtl(iree_wait_source_t wait_source,
+                                            iree_wait_source_command_t command,
+                                            const void* params,
+                                            void** inout_ptr) {
+  iree_task_scope_t* scope = (iree_task_scope_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY:
+      *(iree_status_code_t*)inout_ptr = iree_task_scope_is_idle(scope)
+                                            ? IREE_STATUS_OK
+                                            : IREE_STATUS_DEFERRED;
+      return iree_ok_status();
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE:
+      return iree_task_scope_wait_idle(
+          scope, iree_timeout_as_deadline_ns(
+                     ((const iree_wait_source_wait_params_t*)params)->timeout));
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+  }
+}
+
+// Tests that a thread donated to the executor steals and runs queued tasks
+// while it waits.
+TEST(ExecutorTest, DonateCaller) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  options.donor_count = 1;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  EXPECT_EQ(iree_task_executor_worker_capacity(executor), 2);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // All calls land on the single worker; each takes long enough that the
+  // donor has time to steal some of the others from its queue.
+  struct State {
+    std::thread::id donor_thread_id;
+    std::atomic<int> call_count = {0};
+    std::atomic<int> donated_call_count = {0};
+  } state;
+  state.donor_thread_id = std::this_thread::get_id();
+  static constexpr int kCallCount = 16;
+  iree_task_call_t calls[kCallCount];
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (int i = 0; i < kCallCount; ++i) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              State* state = (State*)user_context;
+              std::this_thread::sleep_for(std::chrono::milliseconds(2));
+              if (std::this_thread::get_id() == state->donor_thread_id) {
+                ++state->donated_call_count;
+              }
+              ++state->call_count;
+              return iree_ok_status();
+            },
+            &state),
+        &calls[i]);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&calls[i].header, &fence->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+  iree_task_executor_submit(executor, &submission);
+
+  iree_wait_source_t wait_source = iree_wait_source_immediate();
+  wait_source.self = &scope;
+  wait_source.ctl = ScopeIdleWaitSourceCtl;
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(executor, wait_source,
+                                                  iree_infinite_timeout()));
+  EXPECT_TRUE(iree_task_scope_is_idle(&scope));
+  EXPECT_EQ(state.call_count.load(), kCallCount);
+  EXPECT_GT(state.donated_call_count.load(), 0);
+#if IREE_STATISTICS_ENABLE
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, &statistics);
+  EXPECT_EQ(statistics.donated_task_count, state.donated_call_count.load());
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that a thread without as much stack remaining as the workers have is
+// not donated and only waits.
+TEST(ExecutorTest, DonateCallerRequiresStackHeadroom) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  options.donor_count = 1;
+  // No thread in the test has this much stack; the workers themselves are
+  // only reserving it.
+  options.worker_stack_size = (iree_host_size_t)1 << 30;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  struct State {
+    std::thread::id donor_thread_id;
+    std::atomic<int> call_count = {0};
+    std::atomic<int> donated_call_count = {0};
+  } state;
+  state.donor_thread_id = std::this_thread::get_id();
+  static constexpr int kCallCount = 4;
+  iree_task_call_t calls[kCallCount];
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (int i = 0; i < kCallCount; ++i) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              State* state = (State*)user_context;
+              std::this_thread::sleep_for(std::chrono::milliseconds(2));
+              if (std::this_thread::get_id() == state->donor_thread_id) {
+                ++state->donated_call_count;
+              }
+              ++state->call_count;
+              return iree_ok_status();
+            },
+            &state),
+        &calls[i]);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&calls[i].header, &fence->header);
+    iree_task_submission_enqueue(&submission, &calls[i].header);
+  }
+  iree_task_executor_submit(executor, &submission);
+
+  iree_wait_source_t wait_source = iree_wait_source_immediate();
+  wait_source.self = &scope;
+  wait_source.ctl = ScopeIdleWaitSourceCtl;
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(executor, wait_source,
+                                                  iree_infinite_timeout()));
+  EXPECT_TRUE(iree_task_scope_is_idle(&scope));
+  EXPECT_EQ(state.call_count.load(), kCallCount);
+  EXPECT_EQ(state.donated_call_count.load(), 0);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+#if IREE_STATISTICS_ENABLE
+// Tests that scheduler statistics account for executed work.
+TEST(ExecutorTest, Statistics) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  static constexpr int kCallCount = 8;
+  for (int i = 0; i < kCallCount; ++i) {
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, &statistics);
+  EXPECT_EQ(statistics.worker_count, 2);
+  EXPECT_GE(statistics.workers.task_count, kCallCount);
+  EXPECT_GE(statistics.posted_task_count, kCallCount);
+  EXPECT_GT(statistics.post_count, 0);
+  EXPECT_GT(statistics.coordinate_count, 0);
+  EXPECT_GT(statistics.workers.mailbox_max_depth, 0);
+  // Durations are measured in ticks and converted when queried. The tick rate
+  // is estimated and only a loose bound is checked.
+  EXPECT_GE(statistics.workers.busy_ns, kCallCount * 1000000 / 2);
+
+  int64_t worker_task_count = 0;
+  for (iree_host_size_t i = 0; i < statistics.worker_count; ++i) {
+    iree_task_worker_statistics_t worker_statistics;
+    IREE_ASSERT_OK(iree_task_executor_query_worker_statistics(
+        executor, i, &worker_statistics));
+    worker_task_count += worker_statistics.task_count;
+  }
+  EXPECT_EQ(worker_task_count, statistics.workers.task_count);
+  iree_task_worker_statistics_t worker_statistics;
+  EXPECT_THAT(Status(iree_task_executor_query_worker_statistics(
+                  executor, statistics.worker_count, &worker_statistics)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 }  // namespace
@@ -21,7 +21,11 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_post_batch_t* out_post_batch) {
   out_post_batch->executor = executor;
   out_post_batch->current_worker = current_worker;
-  out_post_batch->worker_pending_mask = 0;
+  out_post_batch->worker_pending_mask = iree_task_affinity_set_empty();
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    out_post_batch->worker_priority_masks[i] = iree_task_affinity_set_empty();
+  }
+  out_post_batch->task_count = 0;
   memset(&out_post_batch->worker_pending_lifos, 0,
          executor->worker_count * sizeof(iree_task_list_t));
 }
@@ -31,14 +35,21 @@ iree_host_size_t iree_task_post_batch_worker_count(
   return post_batch->executor->worker_count;
 }
 
+iree_task_affinity_set_t iree_task_post_batch_expand_affinity(
+    const iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity) {
+  return iree_task_affinity_expand(affinity,
+                                   post_batch->executor->affinity_block_size);
+}
+
 static iree_host_size_t iree_task_post_batch_select_random_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
   // The masks are accessed with 'relaxed' order because they are just hints.
   iree_task_affinity_set_t worker_live_mask =
       iree_atomic_task_affinity_set_load(
           &post_batch->executor->worker_live_mask, iree_memory_order_relaxed);
-  iree_task_affinity_set_t valid_worker_mask = affinity_set & worker_live_mask;
-  if (!valid_worker_mask) {
+  iree_task_affinity_set_t valid_worker_mask =
+      iree_task_affinity_set_and(affinity_set, worker_live_mask);
+  if (iree_task_affinity_set_is_empty(valid_worker_mask)) {
     // No valid workers as desired; for now just bail to worker 0.
     return 0;
   }
@@ -46,7 +57,7 @@ static iree_host_size_t iree_task_post_batch_select_random_worker(
   // TODO(benvanik): rotate through workers here. Instead, if the affinity set
   // has the current_worker allowed we just use that to avoid needing a
   // cross-thread hop.
-  return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+  return iree_task_affinity_set_find_first(valid_worker_mask);
 }
 
 iree_host_size_t iree_task_post_batch_select_worker(
@@ -54,11 +65,12 @@ iree_host_size_t iree_task_post_batch_select_worker(
   if (post_batch->current_worker) {
     // Posting from a worker - prefer sending right back to this worker if we
     // haven't already scheduled for it.
-    if ((affinity_set & post_batch->current_worker->worker_bit) &&
-        !(post_batch->worker_pending_mask &
-          post_batch->current_worker->worker_bit)) {
-      return iree_task_affinity_set_count_trailing_zeros(
-          post_batch->current_worker->worker_bit);
+    const iree_host_size_t current_index =
+        post_batch->current_worker->worker_bit_index;
+    if (iree_task_affinity_set_test(affinity_set, current_index) &&
+        !iree_task_affinity_set_test(post_batch->worker_pending_mask,
+                                     current_index)) {
+      return current_index;
     }
   }
 
@@ -72,9 +84,11 @@ iree_host_size_t iree_task_post_batch_select_worker(
   iree_task_affinity_set_t worker_idle_mask =
       iree_atomic_task_affinity_set_load(
           &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
-  worker_idle_mask &= ~post_batch->worker_pending_mask;
-  iree_task_affinity_set_t idle_affinity_set = affinity_set & worker_idle_mask;
-  if (idle_affinity_set) {
+  worker_idle_mask = iree_task_affinity_set_and_not(
+      worker_idle_mask, post_batch->worker_pending_mask);
+  iree_task_affinity_set_t idle_affinity_set =
+      iree_task_affinity_set_and(affinity_set, worker_idle_mask);
+  if (!iree_task_affinity_set_is_empty(idle_affinity_set)) {
     return iree_task_post_batch_select_random_worker(post_batch,
                                                      idle_affinity_set);
   }
@@ -89,15 +103,36 @@ void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
                                   iree_task_t* task) {
   iree_task_list_push_front(&post_batch->worker_pending_lifos[worker_index],
                             task);
-  post_batch->worker_pending_mask |=
-      iree_task_affinity_for_worker(worker_index);
+  iree_task_affinity_set_insert(&post_batch->worker_pending_mask,
+                                worker_index);
+  const iree_task_priority_t priority = iree_task_scope_priority(task->scope);
+  iree_task_affinity_set_insert(&post_batch->worker_priority_masks[priority],
+                                worker_index);
+  ++post_batch->task_count;
+}
+
+// Returns a bitmask of priorities (1 << priority) that have pending tasks for
+// |worker_index| and resets them in the |post_batch|.
+static uint32_t iree_task_post_batch_consume_priority_mask(
+    iree_task_post_batch_t* post_batch, iree_host_size_t worker_index) {
+  uint32_t priority_mask = 0;
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    if (iree_task_affinity_set_test(post_batch->worker_priority_masks[i],
+                                    worker_index)) {
+      priority_mask |= 1u << i;
+      iree_task_affinity_set_erase(&post_batch->worker_priority_masks[i],
+                                   worker_index);
+    }
+  }
+  return priority_mask;
 }
 
 // Wakes each worker indicated in the |wake_mask|, if needed.
 static void iree_task_post_batch_wake_workers(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t wake_mask) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(wake_mask));
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(
+      z0, iree_task_affinity_set_count_ones(wake_mask));
 
   // TODO(#4016): use a FUTEX_WAKE_BITSET here to wake all of the workers that
   // have pending work in a single syscall (vs. popcnt(worker_pending_mask)
@@ -108,14 +143,7 @@ static void iree_task_post_batch_wake_workers(
   // threads will be needed simultaneously and can hopefully perform any needed
   // migrations prior to beginning execution.
   iree_task_executor_t* executor = post_batch->executor;
-  int wake_count = iree_task_affinity_set_count_ones(wake_mask);
-  int worker_index = 0;
-  for (int i = 0; i < wake_count; ++i) {
-    int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
-    int wake_index = worker_index + offset;
-    worker_index += offset + 1;
-    wake_mask = iree_shr(wake_mask, offset + 1);
-
+  IREE_TASK_AFFINITY_SET_FOR_EACH(wake_index, wake_mask) {
     // Wake workers if they are waiting - workers are the only thing that can
     // wait on this notification so this should almost always be either free (an
     // atomic load) if a particular worker isn't waiting or it's required to
@@ -127,46 +155,90 @@ static void iree_task_post_batch_wake_workers(
   IREE_TRACE_ZONE_END(z0);
 }
 
+#if IREE_STATISTICS_ENABLE
+// Counts a submit of |posted_task_count| tasks that requested
+// |wake_request_count| idle workers to wake. Workers count their own submits
+// and other threads count theirs on the executor.
+static void iree_task_post_batch_count_submit(
+    iree_task_post_batch_t* post_batch, int64_t posted_task_count,
+    int64_t wake_request_count) {
+  iree_task_worker_t* worker = post_batch->current_worker;
+  if (worker) {
+    iree_task_worker_counter_add(&worker->counters.post_count, 1);
+    iree_task_worker_counter_add(&worker->counters.posted_task_count,
+                                 posted_task_count);
+    iree_task_worker_counter_add(&worker->counters.wake_request_count,
+                                 wake_request_count);
+  } else {
+    iree_task_executor_t* executor = post_batch->executor;
+    iree_atomic_fetch_add(&executor->post_count, 1, iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&executor->posted_task_count, posted_task_count,
+                          iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&executor->wake_request_count, wake_request_count,
+                          iree_memory_order_relaxed);
+  }
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
-  if (!post_batch->worker_pending_mask) return false;
+  if (iree_task_affinity_set_is_empty(post_batch->worker_pending_mask)) {
+    return false;
+  }
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Run through each worker that has a bit set in the pending mask and post
   // the pending tasks.
   iree_task_affinity_set_t worker_mask = post_batch->worker_pending_mask;
-  post_batch->worker_pending_mask = 0;
-  int worker_index = 0;
-  int post_count = iree_task_affinity_set_count_ones(worker_mask);
-  iree_task_affinity_set_t worker_wake_mask = 0;
-  for (int i = 0; i < post_count; ++i) {
-    int offset = iree_task_affinity_set_count_trailing_zeros(worker_mask);
-    int target_index = worker_index + offset;
-    worker_index += offset + 1;
-    worker_mask = iree_shr(worker_mask, offset + 1);
-
+  post_batch->worker_pending_mask = iree_task_affinity_set_empty();
+#if IREE_STATISTICS_ENABLE
+  const int64_t posted_task_count = (int64_t)post_batch->task_count;
+  // Workers that are idle are (or are about to be) waiting and how long they
+  // take to resume after we post to them is the wake latency. The mask is just
+  // a hint.
+  iree_task_affinity_set_t worker_idle_mask =
+      iree_atomic_task_affinity_set_load(
+          &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
+  int64_t wake_request_count = 0;
+#endif  // IREE_STATISTICS_ENABLE
+  post_batch->task_count = 0;
+  iree_task_affinity_set_t worker_wake_mask = iree_task_affinity_set_empty();
+  IREE_TASK_AFFINITY_SET_FOR_EACH(target_index, worker_mask) {
     iree_task_worker_t* worker = &post_batch->executor->workers[target_index];
     iree_task_list_t* target_pending_lifo =
         &post_batch->worker_pending_lifos[target_index];
+    const uint32_t priority_mask =
+        iree_task_post_batch_consume_priority_mask(post_batch, target_index);
     if (worker == post_batch->current_worker) {
       // Fast-path for posting to self; this happens when a worker plays the
       // role of coordinator and we want to ensure we aren't doing a fully
       // block-and-flush loop when we could just be popping the next new task
       // off the list.
-      iree_task_queue_append_from_lifo_list_unsafe(&worker->local_task_queue,
-                                                   target_pending_lifo);
+      iree_task_worker_append_local_tasks(worker, target_pending_lifo);
     } else {
-      iree_task_worker_post_tasks(worker, target_pending_lifo);
-      worker_wake_mask |= iree_task_affinity_for_worker(target_index);
+#if IREE_STATISTICS_ENABLE
+      // Noted before posting so that the worker can't resume without seeing it.
+      if (iree_task_affinity_set_test(worker_idle_mask, target_index)) {
+        iree_task_worker_note_wake_request(worker);
+        ++wake_request_count;
+      }
+#endif  // IREE_STATISTICS_ENABLE
+      iree_task_worker_post_tasks(worker, target_pending_lifo, priority_mask);
+      iree_task_affinity_set_insert(&worker_wake_mask, target_index);
     }
   }
 
+#if IREE_STATISTICS_ENABLE
+  iree_task_post_batch_count_submit(post_batch, posted_task_count,
+                                    wake_request_count);
+#endif  // IREE_STATISTICS_ENABLE
+
   // Wake all workers that now have pending work. If a worker is not already
   // waiting this will be cheap (no syscall).
-  if (worker_wake_mask != 0) {
+  if (!iree_task_affinity_set_is_empty(worker_wake_mask)) {
     iree_task_post_batch_wake_workers(post_batch, worker_wake_mask);
   }
 
   IREE_TRACE_ZONE_END(z0);
-  return post_count != 0;
+  return true;
 }
@@ -13,6 +13,7 @@
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor.h"
 #include "iree/task/list.h"
+#include "iree/task/scope.h"
 #include "iree/task/task.h"
 #include "iree/task/tuning.h"
 
@@ -39,6 +40,14 @@ typedef struct iree_task_post_batch_t {
   // Used to quickly scan the lists and perform the posts only when required.
   iree_task_affinity_set_t worker_pending_mask;
 
+  // A bitmask of workers per iree_task_priority_t indicating which have pending
+  // tasks of that priority in their lists. Passed along with the posted tasks
+  // so that workers can tell when higher priority work has arrived.
+  iree_task_affinity_set_t worker_priority_masks[IREE_TASK_PRIORITY_COUNT];
+
+  // Total number of tasks enqueued in the batch since it was last submitted.
+  iree_host_size_t task_count;
+
   // A per-worker LIFO task list waiting to be posted.
   iree_task_list_t worker_pending_lifos[0];
 } iree_task_post_batch_t;
@@ -51,6 +60,10 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
+// Expands a task |affinity| into the workers it selects in the target executor.
+iree_task_affinity_set_t iree_task_post_batch_expand_affinity(
+    const iree_task_post_batch_t* post_batch, iree_task_affinity_t affinity);
+
 // Selects a random worker from the given affinity set.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
@@ -9,83 +9,258 @@
 #include <stddef.h>
 #include <string.h>
 
+static_assert((IREE_TASK_QUEUE_CAPACITY & (IREE_TASK_QUEUE_CAPACITY - 1)) == 0,
+              "queue capacity must be a power of two");
+
+#define IREE_TASK_QUEUE_SLOT_MASK ((int64_t)IREE_TASK_QUEUE_CAPACITY - 1)
+
+static inline iree_task_t* iree_task_queue_slot_load(iree_task_queue_t* queue,
+                                                     int64_t index) {
+  return (iree_task_t*)iree_atomic_load(
+      &queue->slots[index & IREE_TASK_QUEUE_SLOT_MASK],
+      iree_memory_order_relaxed);
+}
+
+static inline void iree_task_queue_slot_store(iree_task_queue_t* queue,
+                                              int64_t index,
+                                              iree_task_t* task) {
+  iree_atomic_store(&queue->slots[index & IREE_TASK_QUEUE_SLOT_MASK],
+                    (intptr_t)task, iree_memory_order_relaxed);
+}
+
+// Claims the task at the top (FIFO tail) of the ring, if any.
+// Returns NULL if the ring is empty or another thread won the race for the
+// task. Safe to call from any thread.
+static iree_task_t* iree_task_queue_steal_top(iree_task_queue_t* queue) {
+  int64_t top = iree_atomic_load(&queue->top, iree_memory_order_acquire);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t bottom = iree_atomic_load(&queue->bottom, iree_memory_order_acquire);
+  if (top >= bottom) return NULL;  // empty
+  iree_task_t* task = iree_task_queue_slot_load(queue, top);
+  if (!iree_atomic_compare_exchange_strong(&queue->top, &top, top + 1,
+                                           iree_memory_order_seq_cst,
+                                           iree_memory_order_relaxed)) {
+    return NULL;  // lost the race to another thief or the owner
+  }
+  return task;
+}
+
+// Pops the task at the bottom (FIFO head) of the ring, if any.
+// Only a single remaining task requires a CAS to resolve races with thieves.
+// Must only be called from the owning worker's thread.
+static iree_task_t* iree_task_queue_pop_bottom(iree_task_queue_t* queue) {
+  int64_t bottom =
+      iree_atomic_load(&queue->bottom, iree_memory_order_relaxed) - 1;
+  iree_atomic_store(&queue->bottom, bottom, iree_memory_order_relaxed);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t top = iree_atomic_load(&queue->top, iree_memory_order_relaxed);
+  if (top > bottom) {
+    // Empty; restore the bottom so that top == bottom.
+    iree_atomic_store(&queue->bottom, bottom + 1, iree_memory_order_relaxed);
+    return NULL;
+  }
+  iree_task_t* task = iree_task_queue_slot_load(queue, bottom);
+  if (top == bottom) {
+    // Last task in the ring: race any thieves for it.
+    if (!iree_atomic_compare_exchange_strong(&queue->top, &top, top + 1,
+                                             iree_memory_order_seq_cst,
+                                             iree_memory_order_relaxed)) {
+      task = NULL;
+    }
+    iree_atomic_store(&queue->bottom, bottom + 1, iree_memory_order_relaxed);
+  }
+  return task;
+}
+
+// Moves all tasks out of the ring and into |out_list| in FIFO order.
+// Thieves may still claim the tail task while this is in progress.
+// Must only be called from the owning worker's thread.
+static void iree_task_queue_take_all(iree_task_queue_t* queue,
+                                     iree_task_list_t* out_list) {
+  iree_task_list_initialize(out_list);
+  int64_t bottom = iree_atomic_load(&queue->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load(&queue->top, iree_memory_order_acquire);
+  if (top >= bottom) return;  // empty
+
+  // Pull the bottom down to where we last saw the top so that any thief
+  // arriving after the fence sees an empty ring. Thieves that already observed
+  // the old bottom can only ever be racing us for the task at the current top.
+  iree_atomic_store(&queue->bottom, top, iree_memory_order_relaxed);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  top = iree_atomic_load(&queue->top, iree_memory_order_relaxed);
+  if (top >= bottom) {
+    // Thieves took everything while we weren't looking.
+    iree_atomic_store(&queue->bottom, top, iree_memory_order_relaxed);
+    return;
+  }
+
+  // Everything above the top is ours; walk from the head down to the tail.
+  for (int64_t i = bottom - 1; i > top; --i) {
+    iree_task_list_push_back(out_list, iree_task_queue_slot_load(queue, i));
+  }
+  // The CAS overwrites |top| with the current value when it fails so the
+  // index of the tail task is captured first: either way the tail task is gone
+  // and the ring is empty when the bottom is restored to just past it.
+  const int64_t tail_index = top;
+  iree_task_t* tail_task = iree_task_queue_slot_load(queue, tail_index);
+  if (iree_atomic_compare_exchange_strong(&queue->top, &top, tail_index + 1,
+                                          iree_memory_order_seq_cst,
+                                          iree_memory_order_relaxed)) {
+    iree_task_list_push_back(out_list, tail_task);
+  }
+  iree_atomic_store(&queue->bottom, tail_index + 1, iree_memory_order_relaxed);
+}
+
+// Moves up to IREE_TASK_QUEUE_CAPACITY tasks from the head of the FIFO |list|
+// into the ring. Any remaining tasks are left in |list|.
+// The ring must be empty and this must only be called from the owning worker's
+// thread.
+static void iree_task_queue_refill(iree_task_queue_t* queue,
+                                   iree_task_list_t* list) {
+  if (iree_task_list_is_empty(list)) return;
+
+  // The head of the FIFO goes at the bottom of the ring so count how many tasks
+  // we'll be placing before we start writing them tail-to-head.
+  int64_t count = 0;
+  for (iree_task_t* task = list->head;
+       task != NULL && count < IREE_TASK_QUEUE_CAPACITY;
+       task = task->next_task) {
+    ++count;
+  }
+
+  // Thieves can't touch an empty ring so the indices are stable until we
+  // publish the new bottom.
+  int64_t bottom = iree_atomic_load(&queue->bottom, iree_memory_order_relaxed);
+  for (int64_t i = bottom + count - 1; i >= bottom; --i) {
+    iree_task_queue_slot_store(queue, i, iree_task_list_pop_front(list));
+  }
+  iree_atomic_store(&queue->bottom, bottom + count, iree_memory_order_release);
+}
+
+// Appends the FIFO |list| of tasks to the tail of the queue.
+// Must only be called from the owning worker's thread.
+static void iree_task_queue_append_list(iree_task_queue_t* queue,
+                                        iree_task_list_t* list) {
+  if (iree_task_list_is_empty(list)) return;
+
+  // Anything in the overflow list is already behind the ring so we can just
+  // add on to it.
+  if (!iree_task_list_is_empty(&queue->overflow_list)) {
+    iree_task_list_append(&queue->overflow_list, list);
+    return;
+  }
+
+  // The tail of the FIFO is where thieves operate and we can't insert there.
+  // Instead we take back whatever is in the ring (usually nothing) and put it
+  // back with the new tasks following it.
+  iree_task_list_t pending_list;
+  iree_task_queue_take_all(queue, &pending_list);
+  iree_task_list_append(&pending_list, list);
+  iree_task_queue_refill(queue, &pending_list);
+  iree_task_list_append(&queue->overflow_list, &pending_list);
+}
+
+// Appends the FIFO |list| of tasks to the tail of the queue and pops the task
+// at the head. This avoids a round-trip through the ring for the head task when
+// the queue is empty, as it always is when workers refill their queues.
+// Must only be called from the owning worker's thread.
+static iree_task_t* iree_task_queue_append_and_pop_front(
+    iree_task_queue_t* queue, iree_task_list_t* list) {
+  if (iree_task_queue_is_empty(queue)) {
+    iree_task_t* next_task = iree_task_list_pop_front(list);
+    iree_task_queue_refill(queue, list);
+    iree_task_list_append(&queue->overflow_list, list);
+    return next_task;
+  }
+  iree_task_queue_append_list(queue, list);
+  return iree_task_queue_pop_front(queue);
+}
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
-  iree_slim_mutex_initialize(&out_queue->mutex);
-  iree_task_list_initialize(&out_queue->list);
+  iree_task_list_initialize(&out_queue->overflow_list);
 }
 
 void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
-  iree_task_list_discard(&queue->list);
-  iree_slim_mutex_deinitialize(&queue->mutex);
+  iree_task_list_t pending_list;
+  iree_task_queue_take_all(queue, &pending_list);
+  iree_task_list_discard(&pending_list);
+  iree_task_list_discard(&queue->overflow_list);
 }
 
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  bool is_empty = iree_task_list_is_empty(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-  return is_empty;
+  int64_t bottom = iree_atomic_load(&queue->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load(&queue->top, iree_memory_order_acquire);
+  return top >= bottom && iree_task_list_is_empty(&queue->overflow_list);
 }
 
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_push_front(&queue->list, task);
-  iree_slim_mutex_unlock(&queue->mutex);
+  int64_t bottom = iree_atomic_load(&queue->bottom, iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load(&queue->top, iree_memory_order_acquire);
+  while (bottom - top >= IREE_TASK_QUEUE_CAPACITY) {
+    // Ring is full; spill the tail task to the head of the overflow list. We
+    // compete with thieves for it and if they win there's space for us anyway.
+    iree_task_t* tail_task = iree_task_queue_steal_top(queue);
+    if (tail_task) iree_task_list_push_front(&queue->overflow_list, tail_task);
+    top = iree_atomic_load(&queue->top, iree_memory_order_acquire);
+  }
+  iree_task_queue_slot_store(queue, bottom, task);
+  iree_atomic_store(&queue->bottom, bottom + 1, iree_memory_order_release);
 }
 
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list) {
-  // NOTE: reversing the list outside of the lock.
   iree_task_list_reverse(list);
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_queue_append_list(queue, list);
 }
 
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
     iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
-  // Perform the flush and swap outside of the lock; acquiring the list is
-  // atomic and then we own it exclusively.
+  // Acquiring the list is atomic and then we own it exclusively.
   iree_task_list_t suffix;
   iree_task_list_initialize(&suffix);
-  const bool did_flush = iree_atomic_task_slist_flush(
-      source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
-      &suffix.head, &suffix.tail);
+  iree_atomic_task_slist_flush(source_slist,
+                               IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
+                               &suffix.head, &suffix.tail);
 
   // Append the tasks and pop off the front for return.
-  iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-
-  return next_task;
+  return iree_task_queue_append_and_pop_front(queue, &suffix);
 }
 
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_t* next_task = iree_task_queue_pop_bottom(queue);
+  if (!next_task && !iree_task_list_is_empty(&queue->overflow_list)) {
+    // Ring has drained; take the head of the overflow list and move as much of
+    // the rest as will fit into the ring where thieves can get at it.
+    next_task = iree_task_list_pop_front(&queue->overflow_list);
+    iree_task_queue_refill(queue, &queue->overflow_list);
+  }
   return next_task;
 }
 
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks) {
-  // First attempt to steal up to max_tasks from the source queue.
+  // Take at most half of what is in the ring (rounding up so that a lone task
+  // is always stealable) to leave the victim something to work on.
+  int64_t top = iree_atomic_load(&source_queue->top, iree_memory_order_acquire);
+  int64_t bottom =
+      iree_atomic_load(&source_queue->bottom, iree_memory_order_acquire);
+  if (top >= bottom) return NULL;
+  iree_host_size_t steal_count =
+      iree_min(max_tasks, (iree_host_size_t)((bottom - top + 1) / 2));
+
+  // Claim tasks one at a time from the tail of the source FIFO. Each claim
+  // precedes the previous one in FIFO order so we build the list backwards.
   iree_task_list_t stolen_tasks;
   iree_task_list_initialize(&stolen_tasks);
-  if (iree_slim_mutex_try_lock(&source_queue->mutex)) {
-    iree_task_list_split(&source_queue->list, max_tasks, &stolen_tasks);
-    iree_slim_mutex_unlock(&source_queue->mutex);
+  for (iree_host_size_t i = 0; i < steal_count; ++i) {
+    iree_task_t* task = iree_task_queue_steal_top(source_queue);
+    if (!task) break;
+    iree_task_list_push_front(&stolen_tasks, task);
   }
+  if (iree_task_list_is_empty(&stolen_tasks)) return NULL;
 
   // Add any stolen tasks to the target queue and pop off the head for return.
-  iree_task_t* next_task = NULL;
-  if (!iree_task_list_is_empty(&stolen_tasks)) {
-    iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
-    next_task = iree_task_list_pop_front(&target_queue->list);
-    iree_slim_mutex_unlock(&target_queue->mutex);
-  }
-  return next_task;
+  return iree_task_queue_append_and_pop_front(target_queue, &stolen_tasks);
 }
@@ -10,35 +10,23 @@
 #include <stdbool.h>
 
 #include "iree/base/api.h"
-#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/task/list.h"
 #include "iree/task/task.h"
+#include "iree/task/tuning.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
-// A simple work-stealing LIFO queue modeled on a Chase-Lev concurrent deque.
+// A work-stealing queue built on a Chase-Lev concurrent deque.
 // This is used by workers to maintain their thread-local working lists. The
 // workers keep the tasks they will process in FIFO order. They allow it to
 // empty and then refresh it with more tasks from the incoming worker mailbox.
 // The performance bias here is to the workers as they are >90% of the
-// accesses and the only other accesses are thieves that hopefully we can just
-// improve our distribution to vs. introducing a slowdown here.
-//
-// A futex is used to synchronize access; because the common case is that of
-// only the worker that owns the queue touching it for pushing and popping items
-// this puts us into the sweet-spot of uncontended lightweight exclusive locks.
-// Since futices are effectively just single machine words managed with atomic
-// ops we can avoid a lot of the traditional atomic tomfoolery one finds in
-// systems like these that originated prior to the introduction of futices while
-// also keeping the tiny overhead of the pure atomic solutions.
-//
-// We can also take advantage of the futex providing an actual exclusive region
-// such that our data structure can be whatever we want as opposed to needing to
-// be something that someone had figured out how to make atomic. For example,
-// common implementations of work-stealing queues are all bounded as unbounded
-// atomic deques are an unsolved problem in CS.
+// accesses; the owner never performs an atomic read-modify-write operation on
+// its fast path and thieves only ever contend with each other (and the owner
+// when a single task remains) via a compare-and-swap on the top index.
 //
 // Very rarely when another worker runs out of work it'll try to steal tasks
 // from nearby workers and use this queue type to do it: the assumption is that
@@ -53,61 +41,72 @@ extern "C" {
 // push in multiple tasks at a time (flushed from the mailbox) and exclusively
 // pop a single task a time (what to work on next). The stealing part is batched
 // so that when a remote worker has to perform a theft it takes a good chunk of
-// tasks in one go (hopefully roughly half) to reduce the total overhead when
-// there is high imbalance in workloads.
-//
-// Flushing from the mailbox slist (LIFO) to our list (FIFO) requires a full
-// walk of the incoming task linked list. This is generally fine as the number
-// of tasks in any given flush is low(ish) and by walking in reverse order to
-// then process forward the cache should be hot as the worker starts making its
-// way back through the tasks. As we walk forward we'll be using the task fields
-// for execution and retiring of tasks (notifing dependencies/etc) and the
-// intrusive next pointer sitting next to those should be in-cache when we need
-// to access it. This, combined with slab allocation of tasks in command buffers
-// to begin with gives us the (probabilistically) same characteristics of a flat
-// array walked with an index as is common in other work queues but with the
-// flexibility to reorder tasks as we see fit (theft, redistribution/rotation,
-// reprioritization, etc).
-//
-// Similar concepts, though implemented with atomics:
+// tasks in one go (up to roughly half) to reduce the total overhead when there
+// is high imbalance in workloads. Each stolen task is claimed with its own CAS
+// as claiming a range in one go would race with the owner popping from the
+// other end without it performing a CAS of its own.
+//
+// The ring stores the FIFO in reverse: the owner pushes and pops the head of
+// the FIFO at |bottom| while thieves consume the tail of the FIFO at |top|.
+// Appending to the tail of the FIFO is therefore the one thing the deque can't
+// do directly; when the ring is non-empty the owner reclaims its contents with
+// a single CAS, concatenates the new tasks, and republishes the whole batch.
+// This is rare as workers usually only append once their queue has drained.
+//
+// Useful diagram from https://github.com/injinj/WSQ
+//  +--------+ <- slots[0]
+//  |  top   | <- stealers consume here: task = slots[top++]
+//  |        |    (the FIFO tail: the last task the owner would get to)
+//  |   ||   |
+//  |        |
+//  |   vv   |
+//  | bottom | <- owner pushes here:    slots[bottom++] = task
+//  |        |    owner consumes here:  task = slots[--bottom]
+//  |        |    (the FIFO head: the next task the owner will run)
+//  +--------+ <- slots[IREE_TASK_QUEUE_CAPACITY-1]
+//
+// Classic atomic work-stealing deques are bounded and so is our ring. To keep
+// the API unbounded any tasks that don't fit are kept in an owner-private
+// overflow list that logically follows the tail of the ring. Thieves can't see
+// those tasks but as the ring is sized such that it can hold far more tasks
+// than a worker usually has queued this only matters under heavy load where
+// there's plenty in the ring to steal anyway.
+//
+// Flushing from the mailbox slist (LIFO) to our FIFO requires a full walk of
+// the incoming task linked list. This is generally fine as the number of tasks
+// in any given flush is low(ish) and by walking in reverse order to then
+// process forward the cache should be hot as the worker starts making its way
+// back through the tasks.
+//
+// References:
 //   "Dynamic Circular Work-Stealing Deque":
 //   http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.170.1097&rep=rep1&type=pdf
 //   "Correct and Efficient Work-Stealing for Weak Memory Models":
 //   https://fzn.fr/readings/ppopp13.pdf
 //   Motivating article:
 //   https://blog.molecular-matters.com/2015/08/24/job-system-2-0-lock-free-work-stealing-part-1-basics/
-//
-// Useful diagram from https://github.com/injinj/WSQ
-// Much of this implementation is inspired from that; though significant
-// reworking was required for our FIFO->LIFO->FIFO sandwich.
-//  +--------+ <- tasks[0]
-//  |  top   | <- stealers consume here: task = tasks[top++]
-//  |        |
-//  |   ||   |
-//  |        |
-//  |   vv   |
-//  | bottom | <- owner pushes here:    tasks[bottom++] = task
-//  |        |    owner consumes here:  task = tasks[--bottom]
-//  |        |
-//  +--------+ <- tasks[IREE_TASK_QUEUE_CAPACITY-1]
-//
-// Unlike that implementation, though, our task list is unbounded because we use
-// a linked list. To keep our options open, though, I've left the API of this
-// implementation compatible with classic atomic work-stealing queues. I'm
-// hopeful this will not need to be revisted for awhile, though!
-//
-// Future improvement idea: have the owner of the queue maintain a theft point
-// skip list that makes it possible for thieves to quickly come in and slice
-// off batches of tasks at the tail of the queue. Since we are a singly-linked
-// list we can't easily just walk backward and we don't want to be introducing
-// cache line contention as thieves start touching the same tasks as the worker
-// is while processing.
 typedef struct iree_task_queue_t {
-  // Must be held when manipulating the queue. >90% accesses are by the owner.
-  iree_slim_mutex_t mutex;
+  // Index one past the FIFO head in |slots|. Only ever written by the owner.
+  iree_atomic_int64_t bottom;
+
+  // FIFO list of tasks that logically follow the tail of the ring.
+  // Only ever accessed by the owner.
+  iree_task_list_t overflow_list;
+
+  // Keeps |top| (hammered by thieves) off the owner's cache line.
+  uint8_t _owner_padding[iree_hardware_destructive_interference_size -
+                         sizeof(iree_atomic_int64_t) -
+                         sizeof(iree_task_list_t)];
 
-  // FIFO task list.
-  iree_task_list_t list IREE_GUARDED_BY(mutex);
+  // Index of the FIFO tail in |slots|. Advanced by a CAS from thieves or the
+  // owner when it races them for the last task.
+  iree_atomic_int64_t top;
+
+  uint8_t _top_padding[iree_hardware_destructive_interference_size -
+                       sizeof(iree_atomic_int64_t)];
+
+  // Ring of iree_task_t* indexed by (index & (IREE_TASK_QUEUE_CAPACITY - 1)).
+  iree_atomic_intptr_t slots[IREE_TASK_QUEUE_CAPACITY];
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -119,6 +118,8 @@ void iree_task_queue_deinitialize(iree_task_queue_t* queue);
 
 // Returns true if the queue is empty.
 // Note that due to races this may return both false-positives and -negatives.
+//
+// Must only be called from the owning worker's thread.
 bool iree_task_queue_is_empty(iree_task_queue_t* queue);
 
 // Pushes a task to the front of the queue.
@@ -0,0 +1,245 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/threading.h"
+#include "iree/task/executor.h"
+#include "iree/task/queue.h"
+#include "iree/task/scope.h"
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
+#include "iree/task/topology.h"
+#include "iree/testing/benchmark.h"
+
+// Number of tasks the owner pushes into its queue at a time. Roughly what a
+// worker sees when flushing its mailbox during a fine-grained dispatch.
+#define IREE_TASK_QUEUE_BENCHMARK_BATCH_SIZE 32
+
+//===----------------------------------------------------------------------===//
+// iree_task_queue_t owner/thief contention
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_task_queue_benchmark_thief_t {
+  iree_thread_t* thread;
+  iree_task_queue_t* victim_queue;
+  iree_atomic_int32_t* should_exit;
+  iree_atomic_int32_t* stolen_count;
+  iree_task_queue_t local_queue;
+} iree_task_queue_benchmark_thief_t;
+
+// Spins trying to steal from the victim and drains anything it gets.
+static int iree_task_queue_benchmark_thief_main(void* entry_arg) {
+  iree_task_queue_benchmark_thief_t* thief =
+      (iree_task_queue_benchmark_thief_t*)entry_arg;
+  while (!iree_atomic_load(thief->should_exit, iree_memory_order_acquire)) {
+    iree_task_t* task = iree_task_queue_try_steal(
+        thief->victim_queue, &thief->local_queue, /*max_tasks=*/4);
+    int32_t task_count = 0;
+    while (task) {
+      ++task_count;
+      task = iree_task_queue_pop_front(&thief->local_queue);
+    }
+    if (task_count > 0) {
+      iree_atomic_fetch_add(thief->stolen_count, task_count,
+                            iree_memory_order_release);
+    }
+  }
+  return 0;
+}
+
+// Measures the owner appending batches of tasks to its queue and popping them
+// while thieves continuously try to steal from it.
+//
+// user_data is the number of thief threads.
+static iree_status_t iree_task_queue_benchmark_contended_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_host_size_t thief_count =
+      (iree_host_size_t)(uintptr_t)benchmark_def->user_data;
+
+  iree_task_queue_t* queue = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, sizeof(*queue), (void**)&queue));
+  iree_task_queue_initialize(queue);
+  iree_task_t tasks[IREE_TASK_QUEUE_BENCHMARK_BATCH_SIZE];
+  memset(tasks, 0, sizeof(tasks));
+
+  iree_atomic_int32_t should_exit = IREE_ATOMIC_VAR_INIT(0);
+  iree_atomic_int32_t stolen_count = IREE_ATOMIC_VAR_INIT(0);
+  iree_task_queue_benchmark_thief_t* thieves = NULL;
+  if (thief_count > 0) {
+    IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                        thief_count * sizeof(*thieves),
+                                        (void**)&thieves));
+  }
+  for (iree_host_size_t i = 0; i < thief_count; ++i) {
+    iree_task_queue_benchmark_thief_t* thief = &thieves[i];
+    thief->victim_queue = queue;
+    thief->should_exit = &should_exit;
+    thief->stolen_count = &stolen_count;
+    iree_task_queue_initialize(&thief->local_queue);
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = iree_make_cstring_view("iree-queue-thief");
+    IREE_CHECK_OK(iree_thread_create(iree_task_queue_benchmark_thief_main,
+                                     thief, params, host_allocator,
+                                     &thief->thread));
+  }
+
+  while (iree_benchmark_keep_running(
+      benchmark_state, /*batch_count=*/IREE_TASK_QUEUE_BENCHMARK_BATCH_SIZE)) {
+    iree_task_list_t list;
+    iree_task_list_initialize(&list);
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(tasks); ++i) {
+      iree_task_list_push_front(&list, &tasks[i]);
+    }
+    iree_task_queue_append_from_lifo_list_unsafe(queue, &list);
+    int32_t popped_count = 0;
+    while (iree_task_queue_pop_front(queue)) ++popped_count;
+    // Wait for any thefts in flight to finish so that the tasks can be reused.
+    // This is not included in the timing as it's an artifact of the benchmark.
+    iree_benchmark_pause_timing(benchmark_state);
+    while (popped_count + iree_atomic_load(&stolen_count,
+                                           iree_memory_order_acquire) <
+           IREE_TASK_QUEUE_BENCHMARK_BATCH_SIZE) {
+      iree_thread_yield();
+    }
+    iree_atomic_store(&stolen_count, 0, iree_memory_order_relaxed);
+    iree_benchmark_resume_timing(benchmark_state);
+  }
+
+  iree_atomic_store(&should_exit, 1, iree_memory_order_release);
+  for (iree_host_size_t i = 0; i < thief_count; ++i) {
+    iree_thread_join(thieves[i].thread);
+    iree_thread_release(thieves[i].thread);
+    iree_task_queue_deinitialize(&thieves[i].local_queue);
+  }
+  iree_allocator_free(host_allocator, thieves);
+  iree_task_queue_deinitialize(queue);
+  iree_allocator_free(host_allocator, queue);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_task_dispatch_t fine-grained tiles
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_task_queue_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  return iree_ok_status();
+}
+
+// Measures end-to-end dispatch of a grid of empty tiles across all workers.
+// This is dominated by scheduling overhead and with enough workers the time
+// spent in the worker queues when thieves show up.
+//
+// user_data is the number of workers.
+static iree_status_t iree_task_queue_benchmark_dispatch_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  const iree_host_size_t worker_count =
+      (iree_host_size_t)(uintptr_t)benchmark_def->user_data;
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(worker_count, &topology);
+  iree_task_executor_t* executor = NULL;
+  iree_status_t status = iree_task_executor_create(options, &topology,
+                                                   host_allocator, &executor);
+  iree_task_topology_deinitialize(&topology);
+  IREE_RETURN_IF_ERROR(status);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)worker_count * 64, 1, 1};
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_task_dispatch_t dispatch_task;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(iree_task_queue_benchmark_tile, NULL),
+        workgroup_size, workgroup_count, &dispatch_task);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch_task.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch_task.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_task_queue_benchmark_contended_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_queue_benchmark_contended_n,
+    };
+    benchmark_def.user_data = (void*)0u;
+    iree_benchmark_register(iree_make_cstring_view("contended_0"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("contended_1"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)7u;
+    iree_benchmark_register(iree_make_cstring_view("contended_7"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)31u;
+    iree_benchmark_register(iree_make_cstring_view("contended_31"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)63u;
+    iree_benchmark_register(iree_make_cstring_view("contended_63"),
+                            &benchmark_def);
+  }
+
+  // iree_task_queue_benchmark_dispatch_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_task_queue_benchmark_dispatch_n,
+    };
+    benchmark_def.user_data = (void*)8u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_8"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)32u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_32"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("dispatch_64"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -6,6 +6,10 @@
 
 #include "iree/task/queue.h"
 
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "iree/base/internal/threading.h"
 #include "iree/testing/gtest.h"
 
@@ -336,4 +340,183 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+TEST(QueueTest, PushPopOverflow) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  // Push enough tasks to spill out of the ring into the overflow list.
+  std::vector<iree_task_t> tasks(IREE_TASK_QUEUE_CAPACITY * 2 + 3);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    iree_task_queue_push_front(&queue, &tasks[tasks.size() - i - 1]);
+  }
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    EXPECT_EQ(&tasks[i], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+TEST(QueueTest, AppendListOverflow) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  iree_task_t task_existing = {0};
+  iree_task_queue_push_front(&queue, &task_existing);
+
+  // Append more tasks than fit in the ring behind an existing task.
+  std::vector<iree_task_t> tasks(IREE_TASK_QUEUE_CAPACITY + 3);
+  iree_task_list_t list = {0};
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    iree_task_list_push_front(&list, &tasks[i]);
+  }
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  EXPECT_TRUE(iree_task_list_is_empty(&list));
+
+  EXPECT_EQ(&task_existing, iree_task_queue_pop_front(&queue));
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    EXPECT_EQ(&tasks[i], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+// Races thieves against the owner and ensures each task is taken exactly once.
+TEST(QueueTest, TryStealContended) {
+  static const size_t kThiefCount = 4;
+  static const size_t kTaskCount = 64 * 1024;
+  static const size_t kBatchSize = 32;
+
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::unique_ptr<iree_atomic_int32_t[]> take_counts(
+      new iree_atomic_int32_t[kTaskCount]);
+  for (size_t i = 0; i < kTaskCount; ++i) {
+    take_counts[i] = IREE_ATOMIC_VAR_INIT(0);
+  }
+  auto take_task = [&](iree_task_t* task) {
+    iree_atomic_fetch_add(&take_counts[task - tasks.data()], 1,
+                          iree_memory_order_relaxed);
+  };
+
+  iree_atomic_int32_t owner_done = IREE_ATOMIC_VAR_INIT(0);
+  std::vector<std::thread> thieves;
+  for (size_t i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t target_queue;
+      iree_task_queue_initialize(&target_queue);
+      while (!iree_atomic_load(&owner_done, iree_memory_order_acquire)) {
+        iree_task_t* task =
+            iree_task_queue_try_steal(&source_queue, &target_queue, 4);
+        while (task) {
+          take_task(task);
+          task = iree_task_queue_pop_front(&target_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&target_queue);
+    });
+  }
+
+  // Owner: append batches and pop some of them before appending more.
+  for (size_t i = 0; i < kTaskCount; i += kBatchSize) {
+    iree_task_list_t list = {0};
+    for (size_t j = i; j < i + kBatchSize; ++j) {
+      iree_task_list_push_front(&list, &tasks[j]);
+    }
+    iree_task_queue_append_from_lifo_list_unsafe(&source_queue, &list);
+    for (size_t j = 0; j < kBatchSize / 2; ++j) {
+      iree_task_t* task = iree_task_queue_pop_front(&source_queue);
+      if (!task) break;
+      take_task(task);
+    }
+  }
+  while (iree_task_t* task = iree_task_queue_pop_front(&source_queue)) {
+    take_task(task);
+  }
+  iree_atomic_store(&owner_done, 1, iree_memory_order_release);
+  for (auto& thief : thieves) thief.join();
+
+  for (size_t i = 0; i < kTaskCount; ++i) {
+    EXPECT_EQ(1, iree_atomic_load(&take_counts[i], iree_memory_order_relaxed))
+        << "task " << i;
+  }
+
+  iree_task_queue_deinitialize(&source_queue);
+}
+
+// Races thieves against the owner taking back the ring to append new tasks.
+// The ring is kept nearly empty such that the owner and the thieves are
+// usually contending for the same tail task.
+TEST(QueueTest, AppendListContended) {
+  static const size_t kThiefCount = 4;
+  static const size_t kTaskCount = 256 * 1024;
+  static const size_t kBatchSize = 2;
+
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::unique_ptr<iree_atomic_int32_t[]> take_counts(
+      new iree_atomic_int32_t[kTaskCount]);
+  for (size_t i = 0; i < kTaskCount; ++i) {
+    take_counts[i] = IREE_ATOMIC_VAR_INIT(0);
+  }
+  iree_atomic_int32_t invalid_count = IREE_ATOMIC_VAR_INIT(0);
+  auto take_task = [&](iree_task_t* task) {
+    if (task < tasks.data() || task >= tasks.data() + kTaskCount) {
+      iree_atomic_fetch_add(&invalid_count, 1, iree_memory_order_relaxed);
+      return;
+    }
+    iree_atomic_fetch_add(&take_counts[task - tasks.data()], 1,
+                          iree_memory_order_relaxed);
+  };
+
+  iree_atomic_int32_t owner_done = IREE_ATOMIC_VAR_INIT(0);
+  std::vector<std::thread> thieves;
+  for (size_t i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t target_queue;
+      iree_task_queue_initialize(&target_queue);
+      while (!iree_atomic_load(&owner_done, iree_memory_order_acquire)) {
+        iree_task_t* task =
+            iree_task_queue_try_steal(&source_queue, &target_queue, 1);
+        while (task) {
+          take_task(task);
+          task = iree_task_queue_pop_front(&target_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&target_queue);
+    });
+  }
+
+  // Owner: append small batches, popping only one task from each so that the
+  // ring always has something to take back on the next append.
+  for (size_t i = 0; i < kTaskCount; i += kBatchSize) {
+    iree_task_list_t list = {0};
+    for (size_t j = i; j < i + kBatchSize; ++j) {
+      iree_task_list_push_front(&list, &tasks[j]);
+    }
+    iree_task_queue_append_from_lifo_list_unsafe(&source_queue, &list);
+    iree_task_t* task = iree_task_queue_pop_front(&source_queue);
+    if (task) take_task(task);
+  }
+  while (iree_task_t* task = iree_task_queue_pop_front(&source_queue)) {
+    take_task(task);
+  }
+  iree_atomic_store(&owner_done, 1, iree_memory_order_release);
+  for (auto& thief : thieves) thief.join();
+
+  EXPECT_EQ(0, iree_atomic_load(&invalid_count, iree_memory_order_relaxed));
+  for (size_t i = 0; i < kTaskCount; ++i) {
+    EXPECT_EQ(1, iree_atomic_load(&take_counts[i], iree_memory_order_relaxed))
+        << "task " << i;
+  }
+
+  iree_task_queue_deinitialize(&source_queue);
+}
+
 }  // namespace
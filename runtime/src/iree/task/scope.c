@@ -26,6 +26,13 @@ void iree_task_scope_initialize(iree_string_view_t name,
   out_scope->name[name_length] = 0;
 
   out_scope->flags = flags;
+  if (flags & IREE_TASK_SCOPE_FLAG_PRIORITY_HIGH) {
+    out_scope->priority = IREE_TASK_PRIORITY_HIGH;
+  } else if (flags & IREE_TASK_SCOPE_FLAG_PRIORITY_LOW) {
+    out_scope->priority = IREE_TASK_PRIORITY_LOW;
+  } else {
+    out_scope->priority = IREE_TASK_PRIORITY_NORMAL;
+  }
 
   // TODO(benvanik): pick trace colors based on name hash.
   IREE_TRACE(out_scope->task_trace_color = 0xFFFF0000u);
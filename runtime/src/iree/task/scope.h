@@ -25,9 +25,33 @@ enum iree_task_scope_flag_bits_e {
   // Hosting applications should properly handle the errors by retrieving the
   // failure status from the appropriate query or wait primitive.
   IREE_TASK_SCOPE_FLAG_ABORT_ON_FAILURE = 1u << 0,
+
+  // Tasks within the scope are scheduled at IREE_TASK_PRIORITY_HIGH.
+  // Intended for latency-sensitive work that shares an executor with
+  // throughput-oriented work.
+  IREE_TASK_SCOPE_FLAG_PRIORITY_HIGH = 1u << 1,
+
+  // Tasks within the scope are scheduled at IREE_TASK_PRIORITY_LOW.
+  // Intended for background/batch work that should get out of the way of
+  // everything else.
+  IREE_TASK_SCOPE_FLAG_PRIORITY_LOW = 1u << 2,
 };
 typedef uint32_t iree_task_scope_flags_t;
 
+// Scheduling priority of tasks within a scope.
+// Workers run ready tasks of a higher priority before any of a lower priority
+// and dispatches yield between tile reservations when work of a higher priority
+// is posted to the worker executing them. Priorities are not strict: tasks that
+// have already begun executing (other than dispatch shards) run to completion.
+typedef enum iree_task_priority_e {
+  IREE_TASK_PRIORITY_HIGH = 0,
+  IREE_TASK_PRIORITY_NORMAL = 1,
+  IREE_TASK_PRIORITY_LOW = 2,
+} iree_task_priority_t;
+
+// Total number of priority levels; priorities are in [0, count).
+#define IREE_TASK_PRIORITY_COUNT 3
+
 // iree_task_scope_t is an atomic reference-counting helper posting a
 // notification when the reference count is decremended to 0.
 //
@@ -60,6 +84,9 @@ typedef struct iree_task_scope_t {
   // Flags controlling optional scope behavior.
   iree_task_scope_flags_t flags;
 
+  // Scheduling priority of all tasks within the scope derived from |flags|.
+  iree_task_priority_t priority;
+
   // Base color used for tasks in this scope.
   // The color will be modulated based on task type.
   IREE_TRACE(uint32_t task_trace_color;)
@@ -101,6 +128,13 @@ void iree_task_scope_deinitialize(iree_task_scope_t* scope);
 // string.
 iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope);
 
+// Returns the scheduling priority of tasks within |scope|.
+// Tasks without a scope are treated as IREE_TASK_PRIORITY_NORMAL.
+static inline iree_task_priority_t iree_task_scope_priority(
+    const iree_task_scope_t* scope) {
+  return scope ? scope->priority : IREE_TASK_PRIORITY_NORMAL;
+}
+
 // Returns and resets the statistics for the scope.
 // Statistics may experience tearing (non-atomic update across fields) if this
 // is performed while tasks are in-flight.
@@ -34,6 +34,27 @@ TEST(ScopeTest, LongNameTruncation) {
   iree_task_scope_deinitialize(&scope);
 }
 
+TEST(ScopeTest, Priority) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("normal"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+  EXPECT_EQ(IREE_TASK_PRIORITY_NORMAL, iree_task_scope_priority(&scope));
+  iree_task_scope_deinitialize(&scope);
+
+  iree_task_scope_initialize(iree_make_cstring_view("high"),
+                             IREE_TASK_SCOPE_FLAG_PRIORITY_HIGH, &scope);
+  EXPECT_EQ(IREE_TASK_PRIORITY_HIGH, iree_task_scope_priority(&scope));
+  iree_task_scope_deinitialize(&scope);
+
+  iree_task_scope_initialize(iree_make_cstring_view("low"),
+                             IREE_TASK_SCOPE_FLAG_PRIORITY_LOW, &scope);
+  EXPECT_EQ(IREE_TASK_PRIORITY_LOW, iree_task_scope_priority(&scope));
+  iree_task_scope_deinitialize(&scope);
+
+  // Tasks without a scope are treated as normal priority.
+  EXPECT_EQ(IREE_TASK_PRIORITY_NORMAL, iree_task_scope_priority(NULL));
+}
+
 TEST(ScopeTest, AbortEmpty) {
   iree_task_scope_t scope;
   iree_task_scope_initialize(iree_make_cstring_view("scope_a"),
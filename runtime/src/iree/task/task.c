@@ -26,7 +26,7 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
   // NOTE: only clears the header, not the task body.
   memset(out_task, 0, sizeof(*out_task));
   out_task->scope = scope;
-  out_task->affinity_set = iree_task_affinity_for_any_worker();
+  out_task->affinity = iree_task_affinity_for_any_worker();
   out_task->type = type;
 }
 
@@ -514,7 +514,19 @@ static uint32_t iree_task_tile_to_color(
 void iree_task_dispatch_statistics_merge(
     const iree_task_dispatch_statistics_t* source,
     iree_task_dispatch_statistics_t* target) {
-  // TODO(benvanik): statistics.
+#if IREE_STATISTICS_ENABLE
+  // The source is only read but the atomic load requires a mutable pointer.
+  iree_task_dispatch_statistics_t* mutable_source =
+      (iree_task_dispatch_statistics_t*)source;
+  iree_atomic_fetch_add(&target->tile_count,
+                        iree_atomic_load(&mutable_source->tile_count,
+                                         iree_memory_order_relaxed),
+                        iree_memory_order_relaxed);
+  iree_atomic_fetch_add(&target->tile_duration_ns,
+                        iree_atomic_load(&mutable_source->tile_duration_ns,
+                                         iree_memory_order_relaxed),
+                        iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
 }
 
 //==============================================================================
@@ -529,6 +541,7 @@ static void iree_task_dispatch_initialize_base(
   memcpy(out_task->workgroup_size, workgroup_size,
          sizeof(out_task->workgroup_size));
   out_task->local_memory_size = 0;
+  out_task->tile_cost_ns = NULL;
   iree_atomic_store(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
 
@@ -558,6 +571,38 @@ void iree_task_dispatch_initialize_indirect(
   out_task->workgroup_count.ptr = workgroup_count_ptr;
 }
 
+// Selects the shard count and tiles per reservation of |dispatch_task| based on
+// the |tile_cost_ns| measured by prior dispatches of the same function.
+// |inout_shard_count| is the maximum number of shards that may be used.
+static void iree_task_dispatch_select_adaptive_reservation(
+    iree_task_dispatch_t* dispatch_task, int64_t tile_cost_ns,
+    iree_host_size_t* inout_shard_count) {
+  const uint32_t tile_count = dispatch_task->tile_count;
+
+  // Grids that are cheaper to run than to distribute are run by a single shard
+  // that the post batch places on the issuing worker when there is one.
+  if ((uint64_t)tile_cost_ns * tile_count <=
+      IREE_TASK_DISPATCH_INLINE_MAX_DURATION_NS) {
+    *inout_shard_count = 1;
+    dispatch_task->tiles_per_reservation = tile_count;
+    return;
+  }
+
+  // Size reservations to the target duration but leave enough reservations
+  // per shard that slow tiles in one part of the grid can be balanced.
+  int64_t tiles_per_reservation =
+      IREE_TASK_DISPATCH_TARGET_RESERVATION_DURATION_NS / tile_cost_ns;
+  tiles_per_reservation = iree_min(
+      tiles_per_reservation,
+      (int64_t)(tile_count / (*inout_shard_count *
+                              IREE_TASK_DISPATCH_MIN_RESERVATIONS_PER_SHARD)));
+  tiles_per_reservation = iree_min(
+      tiles_per_reservation,
+      IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION);
+  dispatch_task->tiles_per_reservation =
+      (uint32_t)iree_max(1, tiles_per_reservation);
+}
+
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -574,9 +619,8 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
     // By the task being ready to execute we know any dependencies on the
     // indirection buffer have been satisfied and its safe to read. We perform
     // the indirection here and convert the dispatch to a direct one such that
-    // following code can read the value.
-    // TODO(benvanik): non-one-shot command buffers won't be able to do this as
-    // the intent is that they can be dynamic per execution.
+    // following code can read the value. Users re-issuing the same dispatch
+    // (such as reusable command buffers) must restore the flag and pointer.
     const uint32_t* source_ptr = dispatch_task->workgroup_count.ptr;
     memcpy(dispatch_task->workgroup_count.value, source_ptr,
            sizeof(dispatch_task->workgroup_count.value));
@@ -600,6 +644,10 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   dispatch_task->tile_count =
       workgroup_count[0] * workgroup_count[1] * workgroup_count[2];
 
+  // Statistics are reset each issue as dispatches may be reissued (such as
+  // from reusable command buffers) and each issue is measured independently.
+  memset(&dispatch_task->statistics, 0, sizeof(dispatch_task->statistics));
+
   // Compute shard count - almost always worker_count unless we are a very small
   // dispatch (1x1x1, etc).
   iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
@@ -609,8 +657,17 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
   // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (dispatch_task->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
+  const int64_t tile_cost_ns =
+      IREE_STATISTICS_ENABLE && dispatch_task->tile_cost_ns
+          ? iree_atomic_load(dispatch_task->tile_cost_ns,
+                             iree_memory_order_relaxed)
+          : 0;
+  if (tile_cost_ns > 0 && shard_count > 0) {
+    iree_task_dispatch_select_adaptive_reservation(dispatch_task, tile_cost_ns,
+                                                   &shard_count);
+  } else if (dispatch_task->tile_count <
+             worker_count *
+                 IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
     // Grid is small - allow it to be eagerly sliced up.
     dispatch_task->tiles_per_reservation = 1;
   } else {
@@ -620,7 +677,8 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
 
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
-      post_batch, dispatch_task->header.affinity_set);
+      post_batch, iree_task_post_batch_expand_affinity(
+                      post_batch, dispatch_task->header.affinity));
   iree_host_size_t worker_index = worker_offset;
 
   for (iree_host_size_t i = 0; i < shard_count; ++i) {
@@ -661,6 +719,28 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
       &dispatch_task->statistics,
       &dispatch_task->header.scope->dispatch_statistics);
 
+#if IREE_STATISTICS_ENABLE
+  // Fold the measured tile cost into the running average shared with future
+  // dispatches of the same function. Racing dispatches may drop each other's
+  // updates but as the value is only a scheduling hint that's fine.
+  if (dispatch_task->tile_cost_ns) {
+    const int64_t tile_count = iree_atomic_load(
+        &dispatch_task->statistics.tile_count, iree_memory_order_relaxed);
+    if (tile_count > 0) {
+      const int64_t duration_ns =
+          iree_atomic_load(&dispatch_task->statistics.tile_duration_ns,
+                           iree_memory_order_relaxed);
+      const int64_t sample_ns = iree_max(1, duration_ns / tile_count);
+      const int64_t average_ns = iree_atomic_load(dispatch_task->tile_cost_ns,
+                                                  iree_memory_order_relaxed);
+      iree_atomic_store(dispatch_task->tile_cost_ns,
+                        average_ns ? average_ns + (sample_ns - average_ns) / 4
+                                   : sample_ns,
+                        iree_memory_order_relaxed);
+    }
+  }
+#endif  // IREE_STATISTICS_ENABLE
+
   // Consume the status of the dispatch that may have been set from a workgroup
   // and notify the scope. We need to do this here so that each shard retires
   // before we discard any subsequent tasks: otherwise a failure of one shard
@@ -707,9 +787,10 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    iree_atomic_int32_t* pending_priority_mask,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -732,9 +813,17 @@ void iree_task_dispatch_shard_execute(
                          worker_local_memory.data_length));
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return true;
   }
 
+  // Any pending work with a priority value lower than ours (higher priority)
+  // preempts the shard. Shards of the highest priority never yield.
+  const uint32_t preempting_priority_bits =
+      pending_priority_mask
+          ? (1u << iree_task_scope_priority(dispatch_task->header.scope)) - 1
+          : 0;
+  bool yielded = false;
+
   // Prepare context shared for all tiles in the shard.
   iree_task_tile_context_t tile_context;
   memcpy(&tile_context.workgroup_size, dispatch_task->workgroup_size,
@@ -756,6 +845,11 @@ void iree_task_dispatch_shard_execute(
   // Hint as to which processor we are running on.
   tile_context.processor_id = processor_id;
 
+#if IREE_STATISTICS_ENABLE
+  int64_t executed_tile_count = 0;
+  const iree_time_t start_time_ns = iree_time_now();
+#endif  // IREE_STATISTICS_ENABLE
+
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
   const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
@@ -796,6 +890,9 @@ void iree_task_dispatch_shard_execute(
                                     &tile_context, pending_submission);
 
       IREE_TRACE_ZONE_END(z_tile);
+#if IREE_STATISTICS_ENABLE
+      ++executed_tile_count;
+#endif  // IREE_STATISTICS_ENABLE
 
       // If any tile fails we bail early from the loop. This doesn't match
       // what an accelerator would do but saves some unneeded work.
@@ -810,6 +907,20 @@ void iree_task_dispatch_shard_execute(
       }
     }
 
+    // Yield to higher priority work before grabbing more tiles. Any tiles we
+    // leave behind are picked up by other shards of the dispatch or by this
+    // one once it resumes.
+    if (IREE_UNLIKELY(preempting_priority_bits &&
+                      (iree_atomic_load(pending_priority_mask,
+                                        iree_memory_order_relaxed) &
+                       preempting_priority_bits))) {
+      if (iree_atomic_load(&dispatch_task->tile_index,
+                           iree_memory_order_relaxed) < tile_count) {
+        yielded = true;
+        break;
+      }
+    }
+
     // Try to grab the next slice of tiles.
     tile_base =
         iree_atomic_fetch_add(&dispatch_task->tile_index, tiles_per_reservation,
@@ -817,14 +928,29 @@ void iree_task_dispatch_shard_execute(
   }
 abort_shard:
 
+#if IREE_STATISTICS_ENABLE
+  iree_atomic_store(&shard_statistics.tile_count, executed_tile_count,
+                    iree_memory_order_relaxed);
+  iree_atomic_store(&shard_statistics.tile_duration_ns,
+                    iree_time_now() - start_time_ns, iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
+
   // Push aggregate statistics up to the dispatch.
   // Note that we may have partial information here if we errored out of the
   // loop but that's still useful to know.
   iree_task_dispatch_statistics_merge(&shard_statistics,
                                       &dispatch_task->statistics);
 
+  // When yielding the shard stays live and is requeued by the caller.
+  if (yielded) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "yielded");
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+
   // NOTE: even if an error was hit we retire OK - the error has already been
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return true;
 }
@@ -162,7 +162,10 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
   // of the specific work being performed. For example, some dispatches can be
   // limited to run on certain microarchitectures that workers have affinity
   // with at the OS scheduler level (such as little.BIG topologies).
-  iree_task_affinity_set_t affinity_set;
+  //
+  // This is block-granular (see iree_task_affinity_t) in order to keep the
+  // task header small on executors with more than 64 workers.
+  iree_task_affinity_t affinity;
 
   // Total number of dependent tasks still outstanding. Decremented each time
   // a dependent task completes. The task is considered ready to execute when
@@ -492,10 +495,16 @@ void iree_task_wait_set_wait_any(iree_task_wait_t* task,
 // generic ones like 'l2 cache misses' or 'ipc') then we can sprinkle in some
 // #ifdefs.
 typedef struct iree_task_dispatch_statistics_t {
-  // TODO(benvanik): statistics counters.
   // NOTE: each of these increases the command buffer storage requirements; we
   // should always guard these with IREE_STATISTICS_ENABLE.
+#if IREE_STATISTICS_ENABLE
+  // Total number of tiles executed.
+  iree_atomic_int64_t tile_count;
+  // Total time spent executing tiles summed across all workers.
+  iree_atomic_int64_t tile_duration_ns;
+#else
   iree_atomic_int32_t reserved;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_dispatch_statistics_t;
 
 // Merges statistics from |source| to |target| atomically per-field.
@@ -628,6 +637,14 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // dispatch closure.
   uint32_t local_memory_size;
 
+  // Optional storage for the average cost of a single tile in nanoseconds
+  // shared by all dispatches of the same function. When provided the dispatch
+  // sizes its tile reservations (and decides whether to fan out at all) based
+  // on the cost measured by prior dispatches and folds its own measurements
+  // back in when it retires. A value of 0 indicates no measurements have been
+  // made yet. Requires IREE_STATISTICS_ENABLE and is otherwise ignored.
+  iree_atomic_int64_t* tile_cost_ns;
+
   // Resulting status from the dispatch available once all workgroups have
   // completed (or would have completed). If multiple shards processing the
   // workgroups hit an error the first will be taken and the result ignored. A
@@ -642,8 +659,10 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   uint32_t tile_count;
 
   // Maximum number of tiles to fetch per tile reservation from the grid.
-  // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION and a
-  // reasonable number chosen based on the tile and shard counts.
+  // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (or
+  // IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION when the tile
+  // cost is known) and a reasonable number chosen based on the tile and shard
+  // counts.
   uint32_t tiles_per_reservation;
 
   // The tail tile index; the next reservation will start from here.
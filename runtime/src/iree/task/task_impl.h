@@ -118,11 +118,21 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 // |worker_local_memory| is a block of memory exclusively available to the shard
 // during execution. Contents are undefined both before and after execution.
 //
+// |pending_priority_mask| is an optional bitmask of iree_task_priority_t
+// levels (1 << priority) with work waiting on the executing worker. It is
+// polled between tile reservations and if work of a higher priority than the
+// shard's scope is pending the shard stops early and returns false without
+// retiring. The caller must then requeue the shard so that it can continue
+// once the higher priority work has been picked up.
+//
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+//
+// Returns true if the shard was retired.
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    iree_atomic_int32_t* pending_priority_mask,
     iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
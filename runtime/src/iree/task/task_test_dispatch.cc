@@ -148,6 +148,67 @@ TEST_F(TaskDispatchTest, IssueIndirect) {
   EXPECT_TRUE(coverage.Verify());
 }
 
+#if IREE_STATISTICS_ENABLE
+
+// Tests that dispatches sharing tile cost storage measure their tiles and
+// still cover the whole grid once the cost is known.
+TEST_F(TaskDispatchTest, IssueAdaptive) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {31, 17, 3};
+  iree_atomic_int64_t tile_cost_ns = IREE_ATOMIC_VAR_INIT(0);
+  for (int i = 0; i < 3; ++i) {
+    GridCoverage coverage(kWorkgroupCount);
+    iree_task_dispatch_t task;
+    iree_task_dispatch_initialize(
+        &scope_,
+        iree_task_make_dispatch_closure(GridCoverage::Tile, (void*)&coverage),
+        kWorkgroupSize, kWorkgroupCount, &task);
+    task.tile_cost_ns = &tile_cost_ns;
+    IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+    EXPECT_TRUE(coverage.Verify());
+    EXPECT_GT(iree_atomic_load(&tile_cost_ns, iree_memory_order_relaxed), 0);
+  }
+}
+
+// Tests that grids known to be cheap are run by a single worker.
+TEST_F(TaskDispatchTest, IssueAdaptiveInline) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {64, 1, 1};
+
+  struct WorkerTracker {
+    iree_atomic_int32_t worker_mask = IREE_ATOMIC_VAR_INIT(0);
+    iree_atomic_int32_t tile_count = IREE_ATOMIC_VAR_INIT(0);
+  } tracker;
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    WorkerTracker* tracker = (WorkerTracker*)user_context;
+    iree_atomic_fetch_or(&tracker->worker_mask,
+                         1 << (tile_context->worker_id % 32),
+                         iree_memory_order_relaxed);
+    iree_atomic_fetch_add(&tracker->tile_count, 1, iree_memory_order_relaxed);
+    return iree_ok_status();
+  };
+
+  // Pretend prior dispatches measured each tile taking 1ns.
+  iree_atomic_int64_t tile_cost_ns = IREE_ATOMIC_VAR_INIT(1);
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(
+      &scope_, iree_task_make_dispatch_closure(tile, (void*)&tracker),
+      kWorkgroupSize, kWorkgroupCount, &task);
+  task.tile_cost_ns = &tile_cost_ns;
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_EQ(64,
+            iree_atomic_load(&tracker.tile_count, iree_memory_order_relaxed));
+  int32_t worker_mask =
+      iree_atomic_load(&tracker.worker_mask, iree_memory_order_relaxed);
+  EXPECT_EQ(0, worker_mask & (worker_mask - 1));
+}
+
+#endif  // IREE_STATISTICS_ENABLE
+
 TEST_F(TaskDispatchTest, IssueFailure) {
   IREE_TRACE_SCOPE();
 
@@ -12,13 +12,13 @@
 #include "iree/base/api.h"
 
 void iree_task_topology_group_initialize(
-    uint8_t group_index, iree_task_topology_group_t* out_group) {
+    uint16_t group_index, iree_task_topology_group_t* out_group) {
   memset(out_group, 0, sizeof(*out_group));
   out_group->group_index = group_index;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "iree-worker-%u",
            group_index);
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
-  out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
+  out_group->constructive_sharing_mask = iree_task_topology_group_mask_all();
 }
 
 void iree_task_topology_initialize(iree_task_topology_t* out_topology) {
@@ -63,6 +63,18 @@ const iree_task_topology_group_t* iree_task_topology_get_group(
   return &topology->groups[group_index];
 }
 
+iree_task_topology_group_mask_t iree_task_topology_node_group_mask(
+    const iree_task_topology_t* topology,
+    iree_task_topology_node_id_t node_id) {
+  iree_task_topology_group_mask_t mask = iree_task_affinity_set_empty();
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    if (topology->groups[i].node_id == node_id) {
+      iree_task_affinity_set_insert(&mask, i);
+    }
+  }
+  return mask;
+}
+
 iree_status_t iree_task_topology_push_group(
     iree_task_topology_t* topology, const iree_task_topology_group_t* group) {
   if (topology->group_count + 1 > IREE_ARRAYSIZE(topology->groups)) {
@@ -118,7 +130,7 @@ iree_status_t iree_task_topology_initialize_from_thread_affinities(
   if (group_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many groups specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
+                            " provided for a max capacity of %" PRIhsz ")",
                             group_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
   }
 
@@ -131,6 +143,10 @@ iree_status_t iree_task_topology_initialize_from_thread_affinities(
     iree_task_topology_group_t* group = &out_topology->groups[i];
     iree_task_topology_group_initialize(i, group);
     group->ideal_thread_affinity = group_affinities[i];
+    // NOTE: on platforms where the thread affinity group is the NUMA node this
+    // is accurate; elsewhere it at least keeps workers of the same affinity
+    // group together.
+    group->node_id = group_affinities[i].group;
   }
   out_topology->group_count = group_count;
 
@@ -13,6 +13,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/threading.h"
+#include "iree/task/affinity_set.h"
 #include "iree/task/tuning.h"
 
 #ifdef __cplusplus
@@ -43,11 +44,19 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void);
 
 // A bitmask indicating which other groups from 0 to N may constructively share
 // caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
-typedef uint64_t iree_task_topology_group_mask_t;
+// Groups map 1:1 to executor workers and the mask shares the same multi-word
+// representation as worker affinity sets.
+typedef iree_task_affinity_set_t iree_task_topology_group_mask_t;
 
-#define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
+// Maximum number of groups that can be represented in a group mask.
 #define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
-  (sizeof(iree_task_topology_group_mask_t) * 8)
+  ((iree_host_size_t)IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
+
+// Returns a group mask with all groups set.
+static inline iree_task_topology_group_mask_t
+iree_task_topology_group_mask_all(void) {
+  return iree_task_affinity_set_for_any_worker();
+}
 
 // Total cache sizes (that we care about).
 // More information may be available but we shouldn't be specializing on it
@@ -66,14 +75,19 @@ typedef struct iree_task_topology_caches_t {
 typedef struct iree_task_topology_group_t {
   // Group index within the topology matching a particular bit in
   // iree_task_topology_group_mask_t.
-  uint8_t group_index;
+  uint16_t group_index;
 
   // A name assigned to executor workers used for logging/tracing.
-  char name[32 - /*group_index*/ 1];
+  char name[32 - /*group_index*/ 2];
 
   // Logical processor index.
   uint32_t processor_index;
 
+  // NUMA node the processor(s) of this group belong to. Groups on the same node
+  // share a memory controller and workers prefer to steal from each other
+  // before reaching across nodes. 0 if the platform does not report nodes.
+  iree_task_topology_node_id_t node_id;
+
   // Total cache sizes (that we care about).
   iree_task_topology_caches_t caches;
 
@@ -91,7 +105,7 @@ typedef struct iree_task_topology_group_t {
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
-void iree_task_topology_group_initialize(uint8_t group_index,
+void iree_task_topology_group_initialize(uint16_t group_index,
                                          iree_task_topology_group_t* out_group);
 
 //===----------------------------------------------------------------------===//
@@ -148,6 +162,10 @@ iree_host_size_t iree_task_topology_group_count(
 const iree_task_topology_group_t* iree_task_topology_get_group(
     const iree_task_topology_t* topology, iree_host_size_t group_index);
 
+// Returns a mask of all groups in the topology that are on NUMA node |node_id|.
+iree_task_topology_group_mask_t iree_task_topology_node_group_mask(
+    const iree_task_topology_t* topology, iree_task_topology_node_id_t node_id);
+
 // Pushes a new group onto the topology set.
 // The provided group data will be copied into the topology structure.
 iree_status_t iree_task_topology_push_group(
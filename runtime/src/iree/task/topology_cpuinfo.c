@@ -118,6 +118,7 @@ static void iree_task_topology_group_initialize_from_processor(
       processor->cache.l2 ? processor->cache.l2->size : 0;
   out_group->caches.l3_data =
       processor->cache.l3 ? processor->cache.l3->size : 0;
+  out_group->node_id = processor->cluster->cluster_id;
   iree_task_topology_set_affinity_from_processor(
       processor, &out_group->ideal_thread_affinity);
 }
@@ -136,29 +137,29 @@ static void iree_task_topology_group_initialize_from_core(
                                                      out_group);
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
+// Sets the bits of all *processors* that share the same |cache| in |mask|.
+// Processors beyond the representable range are ignored.
+static void iree_task_topology_calculate_cache_bits(
+    const struct cpuinfo_cache* cache, iree_task_affinity_set_t* mask) {
+  if (!cache) return;
   for (uint32_t processor_i = 0; processor_i < cache->processor_count;
        ++processor_i) {
     uint32_t i = cache->processor_start + processor_i;
     if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
+      iree_task_affinity_set_insert(mask, i);
     }
   }
-  return mask;
 }
 
 // Constructs a constructive sharing mask for all *processors* that share the
 // same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
+static iree_task_affinity_set_t
+iree_task_topology_calculate_constructive_sharing_mask(
     const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
+  iree_task_affinity_set_t mask = iree_task_affinity_set_empty();
+  iree_task_topology_calculate_cache_bits(processor->cache.l1i, &mask);
+  iree_task_topology_calculate_cache_bits(processor->cache.l1d, &mask);
+  iree_task_topology_calculate_cache_bits(processor->cache.l2, &mask);
   // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
   // info purely for distribution and focus the group mask on lower-latency
   // caches?
@@ -172,22 +173,23 @@ iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
     return iree_ok_status();
   }
 
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2), but n is always <= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT (and often
+  // <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
 
     // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
+    iree_task_affinity_set_t constructive_sharing_mask =
         iree_task_topology_calculate_constructive_sharing_mask(
             cpuinfo_get_processor(group->processor_index));
 
-    iree_task_topology_group_mask_t group_mask = 0;
+    iree_task_topology_group_mask_t group_mask = iree_task_affinity_set_empty();
     for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
       const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+      if (other_group->processor_index < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT &&
+          iree_task_affinity_set_test(constructive_sharing_mask,
+                                      other_group->processor_index)) {
+        iree_task_affinity_set_insert(&group_mask, other_group->group_index);
       }
     }
 
@@ -211,7 +213,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
   if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
+                            " provided for a max capacity of %" PRIhsz ")",
                             cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
   }
 
@@ -54,7 +54,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
   if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
+                            " provided for a max capacity of %" PRIhsz ")",
                             cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
   }
 
@@ -633,7 +633,8 @@ static bool iree_sysfs_find_sharing_cache_mask(uint32_t processor,
 // back to L2 if L3 is not available.
 iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
     iree_task_topology_t* topology) {
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2), but n is always <= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT (and often
+  // <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
     uint32_t processor = group->processor_index;
@@ -645,13 +646,13 @@ iree_status_t iree_task_topology_fixup_constructive_sharing_masks(
 
     // Convert processor bitmask to group bitmask.
     // Only processors in the topology can contribute to the group mask.
-    iree_task_topology_group_mask_t group_mask = 0;
+    iree_task_topology_group_mask_t group_mask = iree_task_affinity_set_empty();
     if (has_sharing_mask) {
       for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
         const iree_task_topology_group_t* other_group = &topology->groups[j];
         uint32_t other_processor = other_group->processor_index;
         if (CPU_ISSET(other_processor, &processor_sharing_mask)) {
-          group_mask |= 1ull << other_group->group_index;
+          iree_task_affinity_set_insert(&group_mask, other_group->group_index);
         }
       }
     }
@@ -669,7 +670,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
   if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
+                            " provided for a max capacity of %" PRIhsz ")",
                             cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
   }
   uint32_t processor_count = iree_sysfs_query_processor_count();
@@ -713,6 +714,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
         iree_sysfs_query_cluster_id(cpu_ids[i], &cluster_id);
     if (iree_status_is_ok(cluster_status)) {
       group->ideal_thread_affinity.group = cluster_id;
+      group->node_id = cluster_id;
     }
     iree_status_ignore(cluster_status);
   }
@@ -972,6 +974,7 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
         iree_sysfs_query_cluster_id(processor, &cluster_id);
     if (iree_status_is_ok(cluster_status)) {
       group->ideal_thread_affinity.group = cluster_id;
+      group->node_id = cluster_id;
     } else {
       iree_status_ignore(cluster_status);
     }
@@ -117,6 +117,37 @@ TEST(TopologyTest, FromGroupCount) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, NodeGroupMask) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // Two nodes with groups interleaved between them.
+  for (iree_host_size_t i = 0; i < 6; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    EXPECT_EQ(0, group.node_id);
+    group.node_id = i % 2;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  iree_task_topology_group_mask_t node0_mask =
+      iree_task_topology_node_group_mask(&topology, 0);
+  iree_task_topology_group_mask_t node1_mask =
+      iree_task_topology_node_group_mask(&topology, 1);
+  EXPECT_EQ(3, iree_task_affinity_set_count_ones(node0_mask));
+  EXPECT_EQ(3, iree_task_affinity_set_count_ones(node1_mask));
+  for (iree_host_size_t i = 0; i < 6; i += 2) {
+    EXPECT_TRUE(iree_task_affinity_set_test(node0_mask, i));
+    EXPECT_FALSE(iree_task_affinity_set_test(node1_mask, i));
+    EXPECT_FALSE(iree_task_affinity_set_test(node0_mask, i + 1));
+    EXPECT_TRUE(iree_task_affinity_set_test(node1_mask, i + 1));
+  }
+  EXPECT_TRUE(iree_task_affinity_set_is_empty(
+      iree_task_topology_node_group_mask(&topology, 2)));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 // Verifies only that the |topology| is usable.
 // If we actually checked the contents here then we'd just be validating that
 // cpuinfo was working and the tests would become machine-dependent.
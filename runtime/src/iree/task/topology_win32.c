@@ -28,6 +28,19 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void) {
   return (iree_task_topology_node_id_t)node_number;
 }
 
+// Returns the NUMA node of processor |number| in processor |group| or 0 if
+// the query fails.
+static iree_task_topology_node_id_t iree_task_topology_query_processor_node(
+    WORD group, BYTE number) {
+  PROCESSOR_NUMBER processor_number;
+  memset(&processor_number, 0, sizeof(processor_number));
+  processor_number.Group = group;
+  processor_number.Number = number;
+  USHORT node_number = 0;
+  if (!GetNumaProcessorNodeEx(&processor_number, &node_number)) return 0;
+  return (iree_task_topology_node_id_t)node_number;
+}
+
 //===----------------------------------------------------------------------===//
 // Topology initialization helpers
 //===----------------------------------------------------------------------===//
@@ -112,7 +125,8 @@ static void iree_task_topology_assign_constructive_sharing(
         iree_task_topology_group_t* other = &topology->groups[group_j];
         if (other->ideal_thread_affinity.group == group_mask.Group &&
             (group_mask.Mask & (1ull << other->ideal_thread_affinity.id))) {
-          group->constructive_sharing_mask |= 1ull << group_j;
+          iree_task_affinity_set_insert(&group->constructive_sharing_mask,
+                                        group_j);
         }
       }
     }
@@ -205,7 +219,7 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
   if (cpu_count >= IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "too many CPUs specified (%" PRIhsz
-                            " provided for a max capacity of %zu)",
+                            " provided for a max capacity of %" PRIhsz ")",
                             cpu_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
   }
 
@@ -295,11 +309,12 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
       iree_host_size_t global_processor_index = global_processor_count++;
       if (included_processors[global_processor_index]) {
         // Setup the group for the processor.
-        uint8_t group_index = (uint8_t)out_topology->group_count++;
+        uint16_t group_index = (uint16_t)out_topology->group_count++;
         iree_task_topology_group_t* group = &out_topology->groups[group_index];
         iree_task_topology_group_initialize(group_index, group);
         group->processor_index = (uint32_t)global_processor_index;
-        group->constructive_sharing_mask = 0;  // set below
+        group->constructive_sharing_mask =
+            iree_task_affinity_set_empty();  // set below
 
         // Pin group to the processor.
         iree_thread_affinity_t* affinity = &group->ideal_thread_affinity;
@@ -309,6 +324,8 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
         affinity->id_assigned = 1;
         affinity->id = group_offset + bit_offset;
         affinity->smt = (p->Processor.Flags & LTP_PC_SMT) == LTP_PC_SMT;
+        group->node_id = iree_task_topology_query_processor_node(
+            affinity->group, (BYTE)affinity->id);
       }
       group_offset += bit_offset + 1;
       if (out_topology->group_count >= cpu_count) break;
@@ -546,13 +563,17 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
     }
     ++used_core_index;
 
-    uint8_t group_index = (uint8_t)out_topology->group_count++;
+    uint16_t group_index = (uint16_t)out_topology->group_count++;
     iree_task_topology_group_t* group = &out_topology->groups[group_index];
     iree_task_topology_group_initialize(group_index, group);
     group->processor_index = (uint32_t)adjusted_core_index;
-    group->constructive_sharing_mask = 0;  // set below
+    group->constructive_sharing_mask =
+        iree_task_affinity_set_empty();  // set below
     iree_task_topology_set_affinity_from_processor(
         core, &group->ideal_thread_affinity);
+    group->node_id = iree_task_topology_query_processor_node(
+        group->ideal_thread_affinity.group,
+        (BYTE)group->ideal_thread_affinity.id);
   }
 
   // Assign constructive sharing masks to each topology group.
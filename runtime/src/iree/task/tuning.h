@@ -12,10 +12,17 @@ extern "C" {
 #endif  // __cplusplus
 
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
-#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+// Worker sets are stored as arrays of 64-bit words (see affinity_set.h) and
+// this controls how many words each set uses. The default allows a single
+// executor to span many-core machines (128/192-core server parts, etc) at the
+// cost of slightly larger executor/topology structures. Executors with <= 64
+// workers keep task affinities that select exact workers regardless of this
+// limit; larger executors use affinities that select blocks of workers (see
+// iree_task_affinity_block_size). Builds targeting small devices may lower it
+// to 64 to keep all worker sets as a single uint64_t.
+#if !defined(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
+#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (256)
+#endif  // !IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -77,8 +84,44 @@ extern "C" {
 // In real-time systems too few tasks is better (slightly more work for much
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
-#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+//
+// Thefts never take more than half of the victim's queue and so values above
+// half of IREE_TASK_QUEUE_CAPACITY have no effect.
+#if !defined(IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT)
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT (IREE_TASK_QUEUE_CAPACITY / 4)
+#endif  // !IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT
+
+// Number of consecutive failed theft attempts restricted to workers on the same
+// NUMA node before a worker will try stealing from workers on other nodes.
+//
+// Stealing across nodes moves the victim's tasks - and the memory they touch -
+// over the interconnect and it's usually better to wait a bit for same-node
+// work to show up. Only applies to executors whose topology spans multiple
+// nodes. Setting this to 0 will treat all nodes equally.
+#define IREE_TASK_EXECUTOR_REMOTE_THEFT_BACKOFF_COUNT (4)
+
+// Maximum duration a donated thread will block waiting on its wait source when
+// there are no tasks for it to steal before checking again. Shorter slices
+// let donors join in on work that shows up after they run out sooner at the
+// cost of more wakeups.
+#define IREE_TASK_EXECUTOR_DONATION_WAIT_SLICE_NS (100 * 1000)
+
+// Stack headroom in bytes a thread must have to be donated to an executor
+// whose workers use the platform default stack size (worker_stack_size = 0).
+// Threads with less stack remaining than this (or than the worker stack size
+// when specified) only wait instead of running tasks.
+#define IREE_TASK_EXECUTOR_DEFAULT_DONOR_STACK_SIZE (128 * 1024)
+
+// Number of task slots in the lock-free ring of each worker-local task queue.
+// Must be a power of two.
+//
+// Tasks beyond this count are held in an overflow list private to the owning
+// worker and only become visible to thieves once the ring drains and is
+// refilled. Larger rings expose more work for theft under load at the cost of
+// one pointer per slot per worker.
+#if !defined(IREE_TASK_QUEUE_CAPACITY)
+#define IREE_TASK_QUEUE_CAPACITY (256)
+#endif  // !IREE_TASK_QUEUE_CAPACITY
 
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
@@ -94,6 +137,31 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Maximum number of tiles that will be batched into a single reservation from
+// the grid of a dispatch with a known tile cost (iree_task_dispatch_t
+// tile_cost_ns). Cheap tiles are batched up to this count so that the shared
+// tile index is not hammered by all workers while expensive tiles are reserved
+// one at a time so that ragged grids can be balanced by other workers.
+#define IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_SHARD_RESERVATION (64)
+
+// Target duration of a single tile reservation of a dispatch with a known tile
+// cost, in nanoseconds. Reservations are sized to take about this long while
+// still leaving each shard IREE_TASK_DISPATCH_MIN_RESERVATIONS_PER_SHARD
+// reservations to balance with.
+#define IREE_TASK_DISPATCH_TARGET_RESERVATION_DURATION_NS (20 * 1000)
+
+// Minimum number of reservations each shard of an adaptive dispatch should
+// get if the grid is evenly split. Higher values give more opportunities for
+// idle shards to pick up the slack from shards with slower tiles.
+#define IREE_TASK_DISPATCH_MIN_RESERVATIONS_PER_SHARD (4)
+
+// Estimated total duration of a dispatch with a known tile cost below which
+// the grid is executed by a single shard on the issuing worker (when there is
+// one) instead of being fanned out. Waking other workers and having them
+// contend on the grid costs more than just running the tiles when they are
+// this cheap. Setting this to 0 will always fan out.
+#define IREE_TASK_DISPATCH_INLINE_MAX_DURATION_NS (20 * 1000)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
@@ -11,6 +11,7 @@
 
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/time.h"
 #include "iree/task/executor_impl.h"
 #include "iree/task/post_batch.h"
 #include "iree/task/submission.h"
@@ -21,31 +22,57 @@
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
 
+#if IREE_STATISTICS_ENABLE
+#define IREE_TASK_WORKER_COUNTER_ADD(worker, name, value) \
+  iree_task_worker_counter_add(&(worker)->counters.name, (value))
+#define IREE_TASK_WORKER_TICKS_NOW() iree_platform_ticks_now()
+#else
+#define IREE_TASK_WORKER_COUNTER_ADD(worker, name, value) (void)(value)
+#define IREE_TASK_WORKER_TICKS_NOW() 0
+#endif  // IREE_STATISTICS_ENABLE
+
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
+    iree_task_affinity_set_t node_sharing_mask, iree_host_size_t stack_size,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->worker_bit_index = worker_index;
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  out_worker->node_sharing_mask = node_sharing_mask;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
+  // Only back off remote thefts if there are workers on other nodes at all.
+  const bool spans_nodes = !iree_task_affinity_set_is_empty(
+      iree_task_affinity_set_and_not(
+          iree_task_affinity_set_ones(executor->worker_count),
+          node_sharing_mask));
+  out_worker->remote_theft_backoff_count =
+      spans_nodes ? IREE_TASK_EXECUTOR_REMOTE_THEFT_BACKOFF_COUNT : 0;
+  out_worker->remote_theft_miss_count = 0;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
   out_worker->local_memory = local_memory;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+#if IREE_STATISTICS_ENABLE
+  memset(&out_worker->counters, 0, sizeof(out_worker->counters));
+#endif  // IREE_STATISTICS_ENABLE
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
-  iree_task_queue_initialize(&out_worker->local_task_queue);
+  iree_atomic_store(&out_worker->mailbox_priority_mask, 0,
+                    iree_memory_order_relaxed);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_queue_initialize(&out_worker->local_task_queues[i]);
+  }
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   iree_atomic_store(&out_worker->state, initial_state,
@@ -129,14 +156,16 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
 
   // Release unfinished tasks by flushing the mailbox (which if we're here can't
   // get anything more posted to it) and then discarding everything we still
-  // have a reference to.
+  // have a reference to. The local task queues discard their tasks as part of
+  // deinitialization below.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
-  iree_task_queue_deinitialize(&worker->local_task_queue);
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_queue_deinitialize(&worker->local_task_queues[i]);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -144,53 +173,189 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
 // Marks the worker as "active" (scheduling work or executing it).
 // The idle mask is accessed with 'relaxed' order because it's just a hint.
 static void iree_task_worker_mark_active(iree_task_worker_t* worker) {
-  iree_task_affinity_set_t old_idle_mask =
-      iree_atomic_task_affinity_set_fetch_and(
-          &worker->executor->worker_idle_mask, ~worker->worker_bit,
-          iree_memory_order_relaxed);
-  (void)old_idle_mask;
-  IREE_TRACE_PLOT_VALUE_F32(
-      worker->executor->trace_name,
-      old_idle_mask
-          ? (100.0f -
-             100.0f * (iree_task_affinity_set_count_ones(old_idle_mask) - 1) /
-                 (float)worker->executor->worker_count)
-          : 100.0f);
+  iree_atomic_task_affinity_set_erase(&worker->executor->worker_idle_mask,
+                                      worker->worker_bit_index,
+                                      iree_memory_order_relaxed);
+  IREE_TRACE({
+    int idle_count =
+        iree_task_affinity_set_count_ones(iree_atomic_task_affinity_set_load(
+            &worker->executor->worker_idle_mask, iree_memory_order_relaxed));
+    IREE_TRACE_PLOT_VALUE_F32(
+        worker->executor->trace_name,
+        100.0f - 100.0f * idle_count / (float)worker->executor->worker_count);
+  });
 }
 
 // Marks the worker as "idle" (sleeping/spinning waiting to wake).
 // The idle mask is accessed with 'relaxed' order because it's just a hint.
 static void iree_task_worker_mark_idle(iree_task_worker_t* worker) {
-  iree_task_affinity_set_t old_idle_mask =
-      iree_atomic_task_affinity_set_fetch_or(
-          &worker->executor->worker_idle_mask, worker->worker_bit,
-          iree_memory_order_relaxed);
-  (void)old_idle_mask;
-  IREE_TRACE_PLOT_VALUE_F32(
-      worker->executor->trace_name,
-      100.0f - 100.0f * (iree_task_affinity_set_count_ones(old_idle_mask) + 1) /
-                   (float)worker->executor->worker_count);
+  iree_atomic_task_affinity_set_insert(&worker->executor->worker_idle_mask,
+                                       worker->worker_bit_index,
+                                       iree_memory_order_relaxed);
+  IREE_TRACE({
+    int idle_count =
+        iree_task_affinity_set_count_ones(iree_atomic_task_affinity_set_load(
+            &worker->executor->worker_idle_mask, iree_memory_order_relaxed));
+    IREE_TRACE_PLOT_VALUE_F32(
+        worker->executor->trace_name,
+        100.0f - 100.0f * idle_count / (float)worker->executor->worker_count);
+  });
 }
 
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
-                                 iree_task_list_t* list) {
+                                 iree_task_list_t* list,
+                                 uint32_t priority_mask) {
   // Move the list into the mailbox. Note that the mailbox is LIFO and this list
   // is concatenated with its current order preserved (which should be LIFO).
   iree_atomic_task_slist_concat(&worker->mailbox_slist, list->head, list->tail);
   memset(list, 0, sizeof(*list));
+
+  // Flag the priorities only after the tasks are visible: the worker clears the
+  // mask before flushing the mailbox and at worst sees a stale bit (and yields
+  // for nothing) but never misses the tasks.
+  iree_atomic_fetch_or(&worker->mailbox_priority_mask, (int32_t)priority_mask,
+                       iree_memory_order_release);
+}
+
+iree_host_size_t iree_task_worker_append_local_tasks(iree_task_worker_t* worker,
+                                                     iree_task_list_t* list) {
+  // Split into per-priority LIFO lists preserving relative order.
+  iree_task_list_t priority_lists[IREE_TASK_PRIORITY_COUNT];
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_list_initialize(&priority_lists[i]);
+  }
+  iree_host_size_t task_count = 0;
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(list))) {
+    iree_task_priority_t priority = iree_task_scope_priority(task->scope);
+    iree_task_list_push_back(&priority_lists[priority], task);
+    ++task_count;
+  }
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    if (iree_task_list_is_empty(&priority_lists[i])) continue;
+    iree_task_queue_append_from_lifo_list_unsafe(&worker->local_task_queues[i],
+                                                 &priority_lists[i]);
+  }
+  return task_count;
+}
+
+void iree_task_worker_note_wake_request(iree_task_worker_t* worker) {
+#if IREE_STATISTICS_ENABLE
+  // Only the first request since the worker last resumed is recorded as that
+  // is the one the worker is (or will be) slow to respond to.
+  int64_t expected = 0;
+  iree_atomic_compare_exchange_strong(&worker->counters.wake_requested_ticks,
+                                      &expected, iree_platform_ticks_now(),
+                                      iree_memory_order_relaxed,
+                                      iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Accumulates the latency of any wake requested since the worker last resumed.
+static void iree_task_worker_note_resumed(iree_task_worker_t* worker) {
+#if IREE_STATISTICS_ENABLE
+  int64_t requested_ticks = iree_atomic_exchange(
+      &worker->counters.wake_requested_ticks, 0, iree_memory_order_relaxed);
+  if (requested_ticks) {
+    IREE_TASK_WORKER_COUNTER_ADD(worker, wake_count, 1);
+    IREE_TASK_WORKER_COUNTER_ADD(
+        worker, wake_latency_ticks,
+        iree_max(0, iree_platform_ticks_now() - requested_ticks));
+  }
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+void iree_task_worker_query_statistics(
+    iree_task_worker_t* worker, double ns_per_tick,
+    iree_task_worker_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+#if IREE_STATISTICS_ENABLE
+  iree_task_worker_counters_t* counters = &worker->counters;
+#define IREE_TASK_WORKER_LOAD_COUNTER(name) \
+  out_statistics->name =                    \
+      iree_atomic_load(&counters->name, iree_memory_order_relaxed)
+#define IREE_TASK_WORKER_LOAD_DURATION(name)                          \
+  out_statistics->name##_ns = (iree_duration_t)(                      \
+      ns_per_tick *                                                   \
+      iree_atomic_load(&counters->name##_ticks, iree_memory_order_relaxed))
+  IREE_TASK_WORKER_LOAD_COUNTER(task_count);
+  IREE_TASK_WORKER_LOAD_DURATION(busy);
+  IREE_TASK_WORKER_LOAD_DURATION(idle);
+  IREE_TASK_WORKER_LOAD_COUNTER(theft_attempt_count);
+  IREE_TASK_WORKER_LOAD_COUNTER(theft_count);
+  IREE_TASK_WORKER_LOAD_DURATION(theft);
+  IREE_TASK_WORKER_LOAD_COUNTER(mailbox_flush_count);
+  IREE_TASK_WORKER_LOAD_COUNTER(mailbox_task_count);
+  IREE_TASK_WORKER_LOAD_COUNTER(mailbox_max_depth);
+  IREE_TASK_WORKER_LOAD_COUNTER(wake_count);
+  IREE_TASK_WORKER_LOAD_DURATION(wake_latency);
+#undef IREE_TASK_WORKER_LOAD_DURATION
+#undef IREE_TASK_WORKER_LOAD_COUNTER
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Moves all tasks posted to the worker mailbox into its local queues.
+static void iree_task_worker_flush_mailbox(iree_task_worker_t* worker) {
+  // Clear the priority mask first; see iree_task_worker_post_tasks.
+  iree_atomic_exchange(&worker->mailbox_priority_mask, 0,
+                       iree_memory_order_acquire);
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  if (iree_atomic_task_slist_flush(
+          &worker->mailbox_slist,
+          IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &list.head,
+          &list.tail)) {
+    iree_host_size_t task_count =
+        iree_task_worker_append_local_tasks(worker, &list);
+    IREE_TASK_WORKER_COUNTER_ADD(worker, mailbox_flush_count, 1);
+    IREE_TASK_WORKER_COUNTER_ADD(worker, mailbox_task_count,
+                                 (int64_t)task_count);
+#if IREE_STATISTICS_ENABLE
+    if ((int64_t)task_count >
+        iree_atomic_load(&worker->counters.mailbox_max_depth,
+                         iree_memory_order_relaxed)) {
+      iree_atomic_store(&worker->counters.mailbox_max_depth,
+                        (int64_t)task_count, iree_memory_order_relaxed);
+    }
+#endif  // IREE_STATISTICS_ENABLE
+  }
+}
+
+// Returns the highest priority (lowest value) with tasks in the worker local
+// queues or IREE_TASK_PRIORITY_COUNT if all are empty.
+static iree_host_size_t iree_task_worker_local_priority(
+    iree_task_worker_t* worker) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    if (!iree_task_queue_is_empty(&worker->local_task_queues[i])) return i;
+  }
+  return IREE_TASK_PRIORITY_COUNT;
+}
+
+// Pops the next task from the highest priority non-empty local queue.
+static iree_task_t* iree_task_worker_pop_local_task(
+    iree_task_worker_t* worker) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_queue_t* queue = &worker->local_task_queues[i];
+    if (iree_task_queue_is_empty(queue)) continue;
+    iree_task_t* task = iree_task_queue_pop_front(queue);
+    if (task) return task;
+  }
+  return NULL;
 }
 
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
-                                             iree_task_queue_t* target_queue,
+                                             iree_task_queue_t* target_queues,
                                              iree_host_size_t max_tasks) {
-  // Try to grab tasks from the worker; if more than one task is stolen then the
-  // first will be returned and the remaining will be added to the target queue.
-  iree_task_t* task = iree_task_queue_try_steal(&worker->local_task_queue,
-                                                target_queue, max_tasks);
-  if (task) return task;
-
+  // Try to grab tasks from the worker starting with its highest priority work;
+  // if more than one task is stolen then the first will be returned and the
+  // remaining will be added to the target queue of the same priority.
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_COUNT; ++i) {
+    iree_task_t* task = iree_task_queue_try_steal(
+        &worker->local_task_queues[i], &target_queues[i], max_tasks);
+    if (task) return task;
+  }
   // If we still didn't steal any tasks then let's try the slist instead.
-  task = iree_atomic_task_slist_pop(&worker->mailbox_slist);
+  iree_task_t* task = iree_atomic_task_slist_pop(&worker->mailbox_slist);
   if (task) return task;
 
   return NULL;
@@ -209,16 +374,23 @@ static void iree_task_worker_execute(
   // TODO(benvanik): think a bit more about this timing; this ensures we have
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+      if (!iree_task_dispatch_shard_execute(
+              (iree_task_dispatch_shard_t*)task, worker->processor_id,
+              worker->worker_index, worker->local_memory,
+              &worker->mailbox_priority_mask, pending_submission)) {
+        // The shard yielded to higher priority work posted to us. Put it back
+        // at the front of its queue so that it resumes (or is stolen) as soon
+        // as that work has been picked up.
+        iree_task_queue_push_front(
+            &worker->local_task_queues[iree_task_scope_priority(task->scope)],
+            task);
+      }
       break;
     }
     default:
@@ -237,10 +409,19 @@ static bool iree_task_worker_pump_once(
     iree_task_worker_t* worker, iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Check the local work queue for any work we know we should start
+  // If work of a higher priority than anything we have locally has been
+  // posted to the mailbox then pull it in first so that it runs next.
+  const uint32_t mailbox_priority_mask = (uint32_t)iree_atomic_load(
+      &worker->mailbox_priority_mask, iree_memory_order_relaxed);
+  if (mailbox_priority_mask &
+      ((1u << iree_task_worker_local_priority(worker)) - 1)) {
+    iree_task_worker_flush_mailbox(worker);
+  }
+
+  // Check the local work queues for any work we know we should start
   // processing immediately. Other workers may try to steal some of this work
   // if we take too long.
-  iree_task_t* task = iree_task_queue_pop_front(&worker->local_task_queue);
+  iree_task_t* task = iree_task_worker_pop_local_task(worker);
 
   // Check the mailbox to see if we have incoming work that has been posted.
   // We try to greedily move it to our local work list so that we can work
@@ -252,8 +433,8 @@ static bool iree_task_worker_pump_once(
     // first place (large uneven workloads for various workers, bad distribution
     // in the face of heterogenous multi-core architectures where some workers
     // complete tasks faster than others, etc).
-    task = iree_task_queue_flush_from_lifo_slist(&worker->local_task_queue,
-                                                 &worker->mailbox_slist);
+    iree_task_worker_flush_mailbox(worker);
+    task = iree_task_worker_pop_local_task(worker);
   }
 
 #if IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
@@ -261,11 +442,30 @@ static bool iree_task_worker_pump_once(
   // from other workers that we hopefully share some of the cache hierarchy
   // with. Their tasks will be moved from their local queue into ours and the
   // the first task in the queue is popped off and returned.
+  //
+  // Workers on other NUMA nodes are only considered after we've repeatedly
+  // failed to find work on our own node. Until then we keep pumping so that
+  // any work posted to us or our node neighbors in the meantime is picked up.
   if (!task) {
+    const bool allow_remote_theft = worker->remote_theft_miss_count >=
+                                    worker->remote_theft_backoff_count;
+    const int64_t theft_start_ticks = IREE_TASK_WORKER_TICKS_NOW();
     task = iree_task_executor_try_steal_task(
         worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->node_sharing_mask, allow_remote_theft,
+        worker->max_theft_attempts, IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT,
+        &worker->theft_prng, worker->local_task_queues);
+    IREE_TASK_WORKER_COUNTER_ADD(worker, theft_attempt_count, 1);
+    IREE_TASK_WORKER_COUNTER_ADD(worker, theft_count, task ? 1 : 0);
+    IREE_TASK_WORKER_COUNTER_ADD(
+        worker, theft_ticks, IREE_TASK_WORKER_TICKS_NOW() - theft_start_ticks);
+    if (task || allow_remote_theft) {
+      worker->remote_theft_miss_count = 0;
+    } else {
+      ++worker->remote_theft_miss_count;
+      IREE_TRACE_ZONE_END(z0);
+      return true;  // try again before crossing nodes
+    }
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -277,7 +477,11 @@ static bool iree_task_worker_pump_once(
 
   // Execute the task (may call out to arbitrary user code and may submit more
   // tasks for execution).
+  const int64_t execute_start_ticks = IREE_TASK_WORKER_TICKS_NOW();
   iree_task_worker_execute(worker, task, pending_submission);
+  IREE_TASK_WORKER_COUNTER_ADD(worker, task_count, 1);
+  IREE_TASK_WORKER_COUNTER_ADD(
+      worker, busy_ticks, IREE_TASK_WORKER_TICKS_NOW() - execute_start_ticks);
 
   IREE_TRACE_ZONE_END(z0);
   return true;  // try again
@@ -309,6 +513,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
 
     // Now active until we decide to go back to sleep until the next pump.
     iree_task_worker_mark_active(worker);
+    iree_task_worker_note_resumed(worker);
 
     // Check state to see if we've been asked to exit.
     if (iree_atomic_load(&worker->state, iree_memory_order_acquire) ==
@@ -355,7 +560,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // coordination didn't find anything) we go idle. Otherwise we fall
     // through and try the loop again.
     if (schedule_dirty ||
-        !iree_task_queue_is_empty(&worker->local_task_queue)) {
+        iree_task_worker_local_priority(worker) < IREE_TASK_PRIORITY_COUNT) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
     } else {
@@ -363,10 +568,13 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
       // just using it as a pulse.
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
+      const int64_t wait_start_ticks = IREE_TASK_WORKER_TICKS_NOW();
       iree_notification_commit_wait(
           &worker->wake_notification, wait_token,
           /*spin_ns=*/worker->executor->worker_spin_ns,
           /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      IREE_TASK_WORKER_COUNTER_ADD(
+          worker, idle_ticks, IREE_TASK_WORKER_TICKS_NOW() - wait_start_ticks);
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -392,6 +600,14 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Touch the worker-local memory from the worker thread now that it is
+  // running where it should be. The executor leaves it untouched so that on
+  // systems with first-touch page placement (Linux) the pages land on the NUMA
+  // node of the worker instead of that of the thread creating the executor.
+  if (worker->local_memory.data_length > 0) {
+    memset(worker->local_memory.data, 0, worker->local_memory.data_length);
+  }
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/prng.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/threading.h"
@@ -18,6 +19,7 @@
 #include "iree/task/executor.h"
 #include "iree/task/list.h"
 #include "iree/task/queue.h"
+#include "iree/task/scope.h"
 #include "iree/task/task.h"
 #include "iree/task/topology.h"
 #include "iree/task/tuning.h"
@@ -47,6 +49,44 @@ typedef enum iree_task_worker_state_e {
   IREE_TASK_WORKER_STATE_ZOMBIE = 2,
 } iree_task_worker_state_t;
 
+#if IREE_STATISTICS_ENABLE
+// Scheduler counters kept by each worker. Durations are measured in
+// iree_platform_ticks_now ticks and converted to nanoseconds when queried.
+// All but wake_requested_ticks are only written by the worker thread and are
+// updated with relaxed loads and stores so that the worker never pays for an
+// atomic read-modify-write on its hot paths. Work the worker does on behalf of
+// the executor (coordination and posting) is counted here too and summed
+// across workers when the executor statistics are queried.
+typedef struct iree_task_worker_counters_t {
+  iree_atomic_int64_t task_count;
+  iree_atomic_int64_t busy_ticks;
+  iree_atomic_int64_t idle_ticks;
+  iree_atomic_int64_t theft_attempt_count;
+  iree_atomic_int64_t theft_count;
+  iree_atomic_int64_t theft_ticks;
+  iree_atomic_int64_t mailbox_flush_count;
+  iree_atomic_int64_t mailbox_task_count;
+  iree_atomic_int64_t mailbox_max_depth;
+  iree_atomic_int64_t wake_count;
+  iree_atomic_int64_t wake_latency_ticks;
+  // Tick at which the first poster since the worker last resumed requested
+  // that the idle worker wake or 0 if no wake has been requested.
+  iree_atomic_int64_t wake_requested_ticks;
+  iree_atomic_int64_t coordinate_count;
+  iree_atomic_int64_t coordinate_ticks;
+  iree_atomic_int64_t post_count;
+  iree_atomic_int64_t posted_task_count;
+  iree_atomic_int64_t wake_request_count;
+} iree_task_worker_counters_t;
+
+// Adds |value| to a |counter| only ever written by a single thread.
+static inline void iree_task_worker_counter_add(iree_atomic_int64_t* counter,
+                                                int64_t value) {
+  int64_t current_value = iree_atomic_load(counter, iree_memory_order_relaxed);
+  iree_atomic_store(counter, current_value + value, iree_memory_order_relaxed);
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 // A worker within the executor pool.
 //
 // NOTE: fields in here are touched from multiple threads with lock-free
@@ -60,9 +100,16 @@ typedef struct iree_task_worker_t {
   // them based on the work distribution policy. When workers go to look for
   // more work after their local queue empties they will flush this list and
   // move all of the tasks into their local queue and restart processing.
-  // LAYOUT: must be 64b away from local_task_queue.
+  // LAYOUT: must be 64b away from local_task_queues.
   iree_atomic_task_slist_t mailbox_slist;
 
+  // A bitmask of iree_task_priority_t levels (1 << priority) that have had
+  // tasks posted to the mailbox since the worker last flushed it. Dispatch
+  // shards executing on the worker poll this to yield to higher priority work.
+  // May have bits set for tasks that have since been stolen.
+  // LAYOUT: next to mailbox_slist as they are always updated together.
+  iree_atomic_int32_t mailbox_priority_mask;
+
   // Current state of the worker (iree_task_worker_state_t).
   // LAYOUT: frequent access; next to wake_notification as they are always
   //         accessed together.
@@ -84,9 +131,9 @@ typedef struct iree_task_worker_t {
   // Globally unique worker index (worker_base_index + local worker_index).
   iree_host_size_t worker_index;
 
-  // Bit the worker represents in the various worker bitsets.
+  // Bit index the worker represents in the various worker bitsets.
   // Local to the executor owning the worker.
-  iree_task_affinity_set_t worker_bit;
+  iree_host_size_t worker_bit_index;
 
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
@@ -98,11 +145,24 @@ typedef struct iree_task_worker_t {
   // all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask of other group indices on the same NUMA node as this group.
+  // Thefts from these workers stay on the local memory controller and are
+  // preferred over thefts from workers on other nodes.
+  iree_task_affinity_set_t node_sharing_mask;
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
   uint32_t max_theft_attempts;
 
+  // Number of consecutive failed same-node theft attempts required before the
+  // worker will steal from workers on other nodes. 0 if the executor does not
+  // span multiple nodes.
+  uint32_t remote_theft_backoff_count;
+  // Consecutive same-node theft attempts that have failed since the last
+  // successful theft. Only ever touched by the worker thread.
+  uint32_t remote_theft_miss_count;
+
   // Rotation counter for work stealing (ensures we don't favor one victim).
   // Only ever touched by the worker thread as it steals work.
   iree_prng_minilcg128_state_t theft_prng;
@@ -121,7 +181,7 @@ typedef struct iree_task_worker_t {
   iree_cpu_processor_tag_t processor_tag;
 
   // Destructive interference padding between the mailbox and local task queue
-  // to ensure that the worker - who is pounding on local_task_queue - doesn't
+  // to ensure that the worker - who is pounding on local_task_queues - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
   //
   // Today we don't need this, however on 32-bit systems or if we adjust the
@@ -137,19 +197,26 @@ typedef struct iree_task_worker_t {
   // workers.
   iree_byte_span_t local_memory;
 
-  // Worker-local FIFO queue containing the tasks that will be processed by the
-  // worker. This queue supports work-stealing by other workers if they run out
-  // of work of their own.
+  // Worker-local FIFO queues containing the tasks that will be processed by the
+  // worker, one per iree_task_priority_t. Higher priority queues are always
+  // drained first. These queues support work-stealing by other workers if they
+  // run out of work of their own.
   // LAYOUT: must be 64b away from mailbox_slist.
-  iree_task_queue_t local_task_queue;
+  iree_task_queue_t local_task_queues[IREE_TASK_PRIORITY_COUNT];
+
+#if IREE_STATISTICS_ENABLE
+  // Scheduler telemetry counters.
+  // LAYOUT: after the queues so the counters stay off the mailbox cache line.
+  iree_task_worker_counters_t counters;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_worker_t;
 static_assert(offsetof(iree_task_worker_t, mailbox_slist) +
                       sizeof(iree_atomic_task_slist_t) <
                   iree_hardware_constructive_interference_size,
               "mailbox_slist must be in the first cache line");
-static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
+static_assert(offsetof(iree_task_worker_t, local_task_queues) >=
                   iree_hardware_constructive_interference_size,
-              "local_task_queue must be separated from mailbox_slist by "
+              "local_task_queues must be separated from mailbox_slist by "
               "at least a cache line");
 
 // Initializes a worker by creating its thread and configuring it for receiving
@@ -159,8 +226,9 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
+    iree_task_affinity_set_t node_sharing_mask, iree_host_size_t stack_size,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker);
 
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
@@ -185,18 +253,43 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 
 // Posts a FIFO list of tasks to the worker mailbox. The target worker takes
 // ownership of the tasks and will be woken if it is currently idle.
+// |priority_mask| has a bit (1 << priority) set for each iree_task_priority_t
+// present in |list|.
 //
 // May be called from any thread (including the worker thread).
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
-                                 iree_task_list_t* list);
+                                 iree_task_list_t* list,
+                                 uint32_t priority_mask);
+
+// Appends a LIFO list of tasks directly to the local queues of |worker| based
+// on their priority. Returns the number of tasks appended.
+//
+// Must only be called from the worker thread.
+iree_host_size_t iree_task_worker_append_local_tasks(iree_task_worker_t* worker,
+                                                     iree_task_list_t* list);
+
+// Records that a wake of the idle |worker| was requested by a poster so that
+// the latency until it resumes can be measured.
+//
+// May be called from any thread.
+void iree_task_worker_note_wake_request(iree_task_worker_t* worker);
+
+// Queries a snapshot of the worker scheduler statistics converting tick
+// durations to nanoseconds with |ns_per_tick|.
+//
+// May be called from any thread.
+void iree_task_worker_query_statistics(
+    iree_task_worker_t* worker, double ns_per_tick,
+    iree_task_worker_statistics_t* out_statistics);
 
-// Tries to steal up to |max_tasks| from the back of the queue.
+// Tries to steal up to |max_tasks| from the back of the queues.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the worker FIFO will be moved to the |target_queue|
-// and the first of the stolen tasks is returned. While tasks from the FIFO
-// are preferred this may also steal tasks from the mailbox.
+// that were at the tail of the highest priority non-empty worker FIFO will be
+// moved to the matching queue in |target_queues| (one per priority) and the
+// first of the stolen tasks is returned. While tasks from the FIFOs are
+// preferred this may also steal tasks from the mailbox.
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
-                                             iree_task_queue_t* target_queue,
+                                             iree_task_queue_t* target_queues,
                                              iree_host_size_t max_tasks);
 
 #ifdef __cplusplus
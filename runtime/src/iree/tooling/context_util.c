@@ -43,6 +43,11 @@ IREE_FLAG(
     "        warm-up time and variance as mapped pages are swapped\n"
     "        by the OS.");
 
+IREE_FLAG(bool, module_lazy_verification, false,
+          "Defers verification of each bytecode function until it is first\n"
+          "called instead of verifying all functions when the module loads.\n"
+          "Reduces startup time for modules with many rarely used functions.");
+
 static iree_status_t iree_tooling_load_bytecode_module(
     iree_vm_instance_t* instance, iree_string_view_t path,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
@@ -73,9 +78,14 @@ static iree_status_t iree_tooling_load_bytecode_module(
   // Try to load the module as bytecode (all we have today that we can use).
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  if (FLAG_module_lazy_verification) {
+    options.flags |= IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION;
+  }
   iree_vm_module_t* module = NULL;
-  iree_status_t status = iree_vm_bytecode_module_create(
-      instance, file_contents->const_buffer,
+  iree_status_t status = iree_vm_bytecode_module_create_with_options(
+      instance, &options, file_contents->const_buffer,
       iree_io_file_contents_deallocator(file_contents), host_allocator,
       &module);
 
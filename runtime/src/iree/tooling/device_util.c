@@ -11,6 +11,7 @@
 #include "iree/hal/drivers/init.h"
 #include "iree/hal/utils/allocators.h"
 #include "iree/hal/utils/mpi_channel_provider.h"
+#include "iree/hal/utils/scheduler_statistics.h"
 
 //===----------------------------------------------------------------------===//
 // Shared driver registry
@@ -473,3 +474,37 @@ iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device) {
   if (strlen(FLAG_device_profiling_mode) == 0) return iree_ok_status();
   return iree_hal_device_profiling_end(device);
 }
+
+//===----------------------------------------------------------------------===//
+// Scheduler statistics
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_hal_device_scheduler_statistics_fprint(
+    FILE* file, iree_hal_device_t* device) {
+  if (!device) return iree_ok_status();
+
+  // Devices without a task executor don't report anything.
+  int64_t worker_count = 0;
+  const iree_string_view_t category =
+      IREE_SV(IREE_HAL_SCHEDULER_STATISTICS_CATEGORY);
+  iree_status_t status = iree_hal_device_query_i64(
+      device, category, IREE_SV("worker_count"), &worker_count);
+  if (iree_status_is_not_found(status)) return iree_status_ignore(status);
+  IREE_RETURN_IF_ERROR(status);
+
+  static const char* const keys[] = {
+#define IREE_HAL_SCHEDULER_STATISTIC_KEY(name) #name,
+      IREE_HAL_SCHEDULER_WORKER_STATISTICS(IREE_HAL_SCHEDULER_STATISTIC_KEY)
+      IREE_HAL_SCHEDULER_EXECUTOR_STATISTICS(IREE_HAL_SCHEDULER_STATISTIC_KEY)
+#undef IREE_HAL_SCHEDULER_STATISTIC_KEY
+  };
+  fprintf(file, "[[ iree_task_executor_t scheduler statistics ]]\n");
+  fprintf(file, "  %-20s: %" PRIi64 "\n", "worker_count", worker_count);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(keys); ++i) {
+    int64_t value = 0;
+    IREE_RETURN_IF_ERROR(iree_hal_device_query_i64(
+        device, category, iree_make_cstring_view(keys[i]), &value));
+    fprintf(file, "  %-20s: %" PRIi64 "\n", keys[i], value);
+  }
+  return iree_ok_status();
+}
@@ -6,12 +6,21 @@
 
 #include "iree/tooling/parameter_util.h"
 
+#include <stdlib.h>
+
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/path.h"
+#include "iree/io/file_contents.h"
 #include "iree/io/file_handle.h"
+#include "iree/io/formats/gguf/gguf_parser.h"
+#include "iree/io/formats/irpa/irpa_parser.h"
 #include "iree/io/formats/parser_registry.h"
+#include "iree/io/parallel.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/parameter_index_provider.h"
+#include "iree/io/parameter_profile.h"
 #include "iree/io/scope_map.h"
+#include "iree/io/stdio_stream.h"
 #include "iree/modules/io/parameters/module.h"
 
 //===----------------------------------------------------------------------===//
@@ -20,9 +29,12 @@
 
 IREE_FLAG(
     string, parameter_mode, "file",
-    "A parameter I/O mode of ['preload', 'file'].\n"
+    "A parameter I/O mode of ['preload', 'file', 'mmap'].\n"
     "  preload: read entire parameter files into wired memory on startup.\n"
-    "  file: uses platform file APIs to read/write the file as needed.");
+    "  file: uses platform file APIs to read/write the file as needed.\n"
+    "  mmap: maps parameter files read-only and loads aligned parameters as\n"
+    "        buffers aliasing the mapping where the device supports it.\n"
+    "        Processes sharing a file share its page cache pages.");
 
 // Opens the parameter file at |path| with the mode specified by the
 // --parameter_mode flag and returns its handle.
@@ -39,7 +51,8 @@ static iree_status_t iree_io_open_parameter_file(
   if (strcmp(FLAG_parameter_mode, "preload") == 0) {
     status = iree_io_file_handle_preload(IREE_IO_FILE_MODE_READ, path,
                                          host_allocator, &file_handle);
-  } else if (strcmp(FLAG_parameter_mode, "file") == 0) {
+  } else if (strcmp(FLAG_parameter_mode, "file") == 0 ||
+             strcmp(FLAG_parameter_mode, "mmap") == 0) {
     status = iree_io_file_handle_open(IREE_IO_FILE_MODE_READ, path,
                                       host_allocator, &file_handle);
   } else {
@@ -70,6 +83,19 @@ IREE_FLAG_LIST(
     "- .gguf (https://github.com/ggerganov/ggml/blob/master/docs/gguf.md)\n"
     "- .safetensors (https://github.com/huggingface/safetensors)");
 
+IREE_FLAG(
+    string, parameter_gguf_repack, "none",
+    "Repacks 2D block-quantized tensors in .gguf files into mmt4d tiles as\n"
+    "they are loaded. Specified as `layout[:N0xK0]` with a layout of\n"
+    "['none', 's4', 'u4', 's8', 'f32'] (such as `u4:32x8`). Repacked\n"
+    "tensors are available as `<name>.packed`, `<name>.scales`, and\n"
+    "`<name>.biases` in addition to the original `<name>`.");
+
+IREE_FLAG(
+    bool, parameter_verify, false,
+    "Verifies the contents of .irpa parameters against the hashes stored in\n"
+    "the archive when loading. Reads all parameter contents on startup.");
+
 // Appends the parameter file located at |path| to |index|.
 static iree_status_t iree_io_append_parameter_file_to_index(
     iree_string_view_t path, iree_io_parameter_index_t* index,
@@ -82,9 +108,35 @@ static iree_status_t iree_io_append_parameter_file_to_index(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_io_open_parameter_file(path, host_allocator, &file_handle));
 
-  // Index the file based on its (inferred) format.
-  iree_status_t status =
-      iree_io_parse_file_index(path, file_handle, index, host_allocator);
+  // Index the file based on its (inferred) format. GGUF files may have their
+  // quantized tensors repacked and IRPA files may have their contents verified
+  // and both need options the registry doesn't carry.
+  iree_io_gguf_parse_options_t gguf_options;
+  memset(&gguf_options, 0, sizeof(gguf_options));
+  iree_status_t status = iree_io_gguf_repack_options_parse(
+      iree_make_cstring_view(FLAG_parameter_gguf_repack),
+      &gguf_options.repack);
+  if (iree_status_is_ok(status)) {
+    iree_string_view_t basename = iree_string_view_empty();
+    iree_string_view_t extension = iree_string_view_empty();
+    iree_file_path_split_basename(path, &basename, &extension);
+    if (gguf_options.repack.layout != IREE_IO_GGUF_REPACK_LAYOUT_NONE &&
+        iree_string_view_equal_case(extension, IREE_SV("gguf"))) {
+      status = iree_io_parse_gguf_index_with_options(
+          file_handle, &gguf_options, index, host_allocator);
+    } else if (FLAG_parameter_verify &&
+               iree_string_view_equal_case(extension, IREE_SV("irpa"))) {
+      iree_io_irpa_parse_options_t irpa_options;
+      memset(&irpa_options, 0, sizeof(irpa_options));
+      irpa_options.verify_hashes = true;
+      irpa_options.worker_count = 8;
+      status = iree_io_parse_irpa_index_with_options(
+          file_handle, &irpa_options, index, host_allocator);
+    } else {
+      status =
+          iree_io_parse_file_index(path, file_handle, index, host_allocator);
+    }
+  }
 
   // Release our file reference - it's still retained by the index if it had any
   // parameters in it.
@@ -94,34 +146,348 @@ static iree_status_t iree_io_append_parameter_file_to_index(
   return status;
 }
 
-iree_status_t iree_tooling_build_parameter_indices_from_flags(
-    iree_io_scope_map_t* scope_map) {
+IREE_FLAG(
+    bool, parameter_lazy, false,
+    "Defers parsing the parameter files of each scope until a parameter in\n"
+    "the scope is first requested. Scopes that are never used are never\n"
+    "parsed. Parse errors are reported when the scope is first used.");
+
+// Number of parameter files parsed concurrently. Parsing is dominated by file
+// open and header read latency and benefits from more workers than cores.
+#define IREE_TOOLING_PARAMETER_PARSE_WORKER_COUNT 16
+
+// A parameter file specified by a `--parameters=` flag.
+typedef struct iree_tooling_parameter_file_t {
+  // Scope the parameters in the file are made available under.
+  iree_string_view_t scope;
+  // Path to the parameter file.
+  iree_string_view_t path;
+  // Index holding the file's parameters after it has been parsed.
+  iree_io_parameter_index_t* index;
+} iree_tooling_parameter_file_t;
+
+// A set of parameter files parsed together. Flag values live for the lifetime
+// of the process and are referenced directly.
+typedef struct iree_tooling_parameter_file_set_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t count;
+  iree_tooling_parameter_file_t* files;
+} iree_tooling_parameter_file_set_t;
+
+// Allocates a file set with |count| (initially empty) files.
+static iree_status_t iree_tooling_parameter_file_set_allocate(
+    iree_host_size_t count, iree_allocator_t host_allocator,
+    iree_tooling_parameter_file_set_t** out_file_set) {
+  *out_file_set = NULL;
+  iree_tooling_parameter_file_set_t* file_set = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*file_set) + count * sizeof(file_set->files[0]),
+      (void**)&file_set));
+  file_set->host_allocator = host_allocator;
+  file_set->count = count;
+  file_set->files =
+      (iree_tooling_parameter_file_t*)((uint8_t*)file_set + sizeof(*file_set));
+  *out_file_set = file_set;
+  return iree_ok_status();
+}
+
+// Releases the per-file indices of |file_set|.
+static void iree_tooling_parameter_file_set_reset(
+    iree_tooling_parameter_file_set_t* file_set) {
+  for (iree_host_size_t i = 0; i < file_set->count; ++i) {
+    iree_io_parameter_index_release(file_set->files[i].index);
+    file_set->files[i].index = NULL;
+  }
+}
+
+static void iree_tooling_parameter_file_set_free(void* user_data) {
+  iree_tooling_parameter_file_set_t* file_set =
+      (iree_tooling_parameter_file_set_t*)user_data;
+  if (!file_set) return;
+  iree_tooling_parameter_file_set_reset(file_set);
+  iree_allocator_free(file_set->host_allocator, file_set);
+}
+
+static iree_status_t iree_tooling_parameter_file_set_parse_file(
+    void* user_data, iree_host_size_t file_ordinal) {
+  iree_tooling_parameter_file_set_t* file_set =
+      (iree_tooling_parameter_file_set_t*)user_data;
+  iree_tooling_parameter_file_t* file = &file_set->files[file_ordinal];
+  IREE_RETURN_IF_ERROR(
+      iree_io_parameter_index_create(file_set->host_allocator, &file->index));
+  return iree_io_append_parameter_file_to_index(file->path, file->index,
+                                                file_set->host_allocator);
+}
+
+// Parses all files in |file_set| concurrently into their own indices.
+static iree_status_t iree_tooling_parameter_file_set_parse(
+    iree_tooling_parameter_file_set_t* file_set) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, file_set->count);
+  iree_status_t status = iree_io_parallel_for(
+      IREE_TOOLING_PARAMETER_PARSE_WORKER_COUNT, file_set->count,
+      iree_tooling_parameter_file_set_parse_file, file_set,
+      file_set->host_allocator);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
 
-  // Create one index per scope and add parameters to each.
-  for (iree_host_size_t i = 0; i < FLAG_parameters_list().count; ++i) {
-    // Parse the `scope=path` flag. Note that the scope is optional.
-    iree_string_view_t flag = FLAG_parameters_list().values[i];
-    iree_string_view_t scope, path;
-    if (iree_string_view_split(flag, '=', &scope, &path) == -1) {
-      // No scope provided (that's ok).
-      path = scope;
-      scope = iree_string_view_empty();
+// Adds all entries parsed from |file| to |target_index|. Does not query
+// |target_index| so that it can be used while populating it.
+static iree_status_t iree_tooling_parameter_file_merge(
+    iree_tooling_parameter_file_t* file,
+    iree_io_parameter_index_t* target_index) {
+  iree_host_size_t entry_count = iree_io_parameter_index_count(file->index);
+  for (iree_host_size_t i = 0; i < entry_count; ++i) {
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    IREE_RETURN_IF_ERROR(iree_io_parameter_index_get(file->index, i, &entry));
+    IREE_RETURN_IF_ERROR(iree_io_parameter_index_add(target_index, entry));
+  }
+  return iree_ok_status();
+}
+
+// Populates a lazily-created index with all files in the file set. Files are
+// merged in flag order so that duplicate keys resolve as if the files had been
+// parsed sequentially.
+static iree_status_t iree_tooling_parameter_file_set_populate(
+    void* user_data, iree_io_parameter_index_t* index) {
+  iree_tooling_parameter_file_set_t* file_set =
+      (iree_tooling_parameter_file_set_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_tooling_parameter_file_set_parse(file_set);
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t total_count = 0;
+    for (iree_host_size_t i = 0; i < file_set->count; ++i) {
+      total_count += iree_io_parameter_index_count(file_set->files[i].index);
     }
+    status = iree_io_parameter_index_reserve(index, total_count);
+  }
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < file_set->count; ++i) {
+    status = iree_tooling_parameter_file_merge(&file_set->files[i], index);
+  }
+  // The per-file indices are no longer needed; the entries reference the
+  // files directly.
+  iree_tooling_parameter_file_set_reset(file_set);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
 
+// Parses the `scope=path` flag value. Note that the scope is optional.
+static void iree_tooling_parse_parameters_flag(iree_string_view_t flag,
+                                               iree_string_view_t* out_scope,
+                                               iree_string_view_t* out_path) {
+  if (iree_string_view_split(flag, '=', out_scope, out_path) == -1) {
+    // No scope provided (that's ok).
+    *out_path = *out_scope;
+    *out_scope = iree_string_view_empty();
+  }
+}
+
+// Parses all parameter files concurrently and adds them to the indices of
+// their scopes in |scope_map|.
+static iree_status_t iree_tooling_build_parameter_indices_eager(
+    iree_io_scope_map_t* scope_map) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_tooling_parameter_file_set_t* file_set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_tooling_parameter_file_set_allocate(FLAG_parameters_list().count,
+                                                   scope_map->host_allocator,
+                                                   &file_set));
+  for (iree_host_size_t i = 0; i < file_set->count; ++i) {
+    iree_tooling_parameter_file_t* file = &file_set->files[i];
+    iree_tooling_parse_parameters_flag(FLAG_parameters_list().values[i],
+                                       &file->scope, &file->path);
+    file->index = NULL;
+  }
+
+  // Parse all files (across all scopes) concurrently and then add them to
+  // their scopes in flag order.
+  iree_status_t status = iree_tooling_parameter_file_set_parse(file_set);
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < file_set->count; ++i) {
     // Lookup (or create) the index for the given scope.
     iree_io_parameter_index_t* index = NULL;  // unowned
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_io_scope_map_lookup(scope_map, scope, &index));
+    iree_tooling_parameter_file_t* file = &file_set->files[i];
+    status = iree_io_scope_map_lookup(scope_map, file->scope, &index);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_index_reserve(
+          index, iree_io_parameter_index_count(index) +
+                     iree_io_parameter_index_count(file->index));
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_tooling_parameter_file_merge(file, index);
+    }
+  }
+
+  iree_tooling_parameter_file_set_free(file_set);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// A `--parameters=` flag value and its position in the flag list.
+typedef struct iree_tooling_parameter_flag_t {
+  iree_string_view_t scope;
+  iree_string_view_t path;
+  iree_host_size_t ordinal;
+} iree_tooling_parameter_flag_t;
+
+// Orders flags by scope and then by flag order within each scope.
+static int iree_tooling_parameter_flag_compare(const void* lhs_ptr,
+                                               const void* rhs_ptr) {
+  const iree_tooling_parameter_flag_t* lhs =
+      (const iree_tooling_parameter_flag_t*)lhs_ptr;
+  const iree_tooling_parameter_flag_t* rhs =
+      (const iree_tooling_parameter_flag_t*)rhs_ptr;
+  int cmp = iree_string_view_compare(lhs->scope, rhs->scope);
+  if (cmp != 0) return cmp;
+  return (lhs->ordinal > rhs->ordinal) - (lhs->ordinal < rhs->ordinal);
+}
+
+// Inserts a lazily-populated index into |scope_map| for the scope of the
+// |flag_count| |flags| that parses their files when first queried.
+static iree_status_t iree_tooling_insert_lazy_parameter_index(
+    iree_io_scope_map_t* scope_map, iree_host_size_t flag_count,
+    const iree_tooling_parameter_flag_t* flags) {
+  iree_tooling_parameter_file_set_t* file_set = NULL;
+  IREE_RETURN_IF_ERROR(iree_tooling_parameter_file_set_allocate(
+      flag_count, scope_map->host_allocator, &file_set));
+  for (iree_host_size_t i = 0; i < flag_count; ++i) {
+    iree_tooling_parameter_file_t* file = &file_set->files[i];
+    file->scope = flags[i].scope;
+    file->path = flags[i].path;
+    file->index = NULL;
+  }
 
-    // Index the file.
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_io_append_parameter_file_to_index(path, index,
-                                                   scope_map->host_allocator));
+  // The index takes ownership of the file set.
+  iree_io_parameter_index_populator_t populator = {
+      .fn = iree_tooling_parameter_file_set_populate,
+      .release = iree_tooling_parameter_file_set_free,
+      .user_data = file_set,
+  };
+  iree_io_parameter_index_t* index = NULL;
+  iree_status_t status = iree_io_parameter_index_create_lazy(
+      populator, scope_map->host_allocator, &index);
+  if (!iree_status_is_ok(status)) {
+    iree_tooling_parameter_file_set_free(file_set);
+    return status;
   }
+  status = iree_io_scope_map_insert(scope_map, flags[0].scope, index);
+  iree_io_parameter_index_release(index);
+  return status;
+}
 
+// Creates one lazily-populated index per scope in |scope_map| that parses the
+// scope's parameter files when first queried.
+static iree_status_t iree_tooling_build_parameter_indices_lazy(
+    iree_io_scope_map_t* scope_map) {
+  const iree_host_size_t flag_count = FLAG_parameters_list().count;
+  if (flag_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Group the files by scope once, keeping flag order within each scope so
+  // that duplicate keys resolve as if the files were parsed sequentially.
+  iree_tooling_parameter_flag_t* flags = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(scope_map->host_allocator,
+                                flag_count * sizeof(flags[0]), (void**)&flags));
+  for (iree_host_size_t i = 0; i < flag_count; ++i) {
+    iree_tooling_parse_parameters_flag(FLAG_parameters_list().values[i],
+                                       &flags[i].scope, &flags[i].path);
+    flags[i].ordinal = i;
+  }
+  qsort(flags, flag_count, sizeof(flags[0]),
+        iree_tooling_parameter_flag_compare);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < flag_count;) {
+    iree_host_size_t scope_flag_count = 1;
+    while (i + scope_flag_count < flag_count &&
+           iree_string_view_equal(flags[i].scope,
+                                  flags[i + scope_flag_count].scope)) {
+      ++scope_flag_count;
+    }
+    status = iree_tooling_insert_lazy_parameter_index(
+        scope_map, scope_flag_count, &flags[i]);
+    i += scope_flag_count;
+  }
+
+  iree_allocator_free(scope_map->host_allocator, flags);
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+  return status;
+}
+
+iree_status_t iree_tooling_build_parameter_indices_from_flags(
+    iree_io_scope_map_t* scope_map) {
+  if (FLAG_parameter_lazy) {
+    return iree_tooling_build_parameter_indices_lazy(scope_map);
+  }
+  return iree_tooling_build_parameter_indices_eager(scope_map);
+}
+
+//===----------------------------------------------------------------------===//
+// Parameter access profiling
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(
+    string, parameter_profile, "",
+    "Path to a parameter access profile used to warm the page cache on\n"
+    "startup. If the file exists the parameters listed are prefetched in\n"
+    "order from a background thread. The file is then replaced with the\n"
+    "order parameters are first accessed by this run. Parameters of scopes\n"
+    "loaded with --parameter_lazy are not prefetched.");
+
+// Creates a parameter profile if specified by the --parameter_profile flag and
+// begins prefetching the parameters in |scope_map| listed in any existing
+// profile. |out_profile| is set to NULL if profiling is disabled.
+static iree_status_t iree_tooling_create_parameter_profile_from_flags(
+    iree_io_scope_map_t* scope_map, iree_allocator_t host_allocator,
+    iree_io_parameter_profile_t** out_profile) {
+  *out_profile = NULL;
+  if (strlen(FLAG_parameter_profile) == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_string_view_t path = iree_make_cstring_view(FLAG_parameter_profile);
+
+  // Read the profile from the prior run (if any) before it is overwritten.
+  iree_io_file_contents_t* prior_contents = NULL;
+  iree_status_t status =
+      iree_io_file_contents_read(path, host_allocator, &prior_contents);
+  if (iree_status_is_not_found(status)) {
+    status = iree_status_ignore(status);
+  }
+
+  // Open the profile for this run; accesses are written as they happen.
+  iree_io_stream_t* output_stream = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_stdio_stream_open(
+        IREE_IO_STDIO_STREAM_MODE_WRITE | IREE_IO_STDIO_STREAM_MODE_DISCARD,
+        path, host_allocator, &output_stream);
+  }
+  iree_io_parameter_profile_t* profile = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_profile_create(output_stream, host_allocator,
+                                              &profile);
+  }
+  iree_io_stream_release(output_stream);
+
+  // Begin prefetching in the order from the prior run.
+  if (iree_status_is_ok(status) && prior_contents) {
+    status = iree_io_parameter_profile_prefetch(
+        profile,
+        iree_make_string_view((const char*)prior_contents->const_buffer.data,
+                              prior_contents->const_buffer.data_length),
+        scope_map);
+  }
+  iree_io_file_contents_free(prior_contents);
+
+  if (iree_status_is_ok(status)) {
+    *out_profile = profile;
+  } else {
+    iree_io_parameter_profile_release(profile);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_tooling_create_parameters_module_from_flags(
@@ -136,17 +502,30 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
   iree_status_t status =
       iree_tooling_build_parameter_indices_from_flags(&scope_map);
 
+  // Optionally profile parameter accesses and prefetch based on a prior run.
+  iree_io_parameter_profile_t* profile = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_create_parameter_profile_from_flags(
+        &scope_map, host_allocator, &profile);
+  }
+
   // Create one provider per scope.
   iree_host_size_t provider_count = 0;
   iree_io_parameter_provider_t** providers =
       (iree_io_parameter_provider_t**)iree_alloca(
           scope_map.count * sizeof(iree_io_parameter_provider_t*));
+  iree_io_parameter_index_provider_flags_t provider_flags =
+      IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_NONE;
+  if (strcmp(FLAG_parameter_mode, "mmap") == 0) {
+    provider_flags |= IREE_IO_PARAMETER_INDEX_PROVIDER_FLAG_MAP_FILES;
+  }
   if (iree_status_is_ok(status)) {
     for (iree_host_size_t i = 0; i < scope_map.count; ++i) {
-      status = iree_io_parameter_index_provider_create(
+      status = iree_io_parameter_index_provider_create_with_flags(
           scope_map.entries[i]->scope, scope_map.entries[i]->index,
+          provider_flags,
           IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
-          host_allocator, &providers[i]);
+          profile, host_allocator, &providers[i]);
       if (!iree_status_is_ok(status)) break;
       ++provider_count;
     }
@@ -158,10 +537,11 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
         instance, provider_count, providers, host_allocator, out_module);
   }
 
-  // Cleanup (module owns providers which own indices/etc).
+  // Cleanup (module owns providers which own indices/profiles/etc).
   for (iree_host_size_t i = 0; i < provider_count; ++i) {
     iree_io_parameter_provider_release(providers[i]);
   }
+  iree_io_parameter_profile_release(profile);
   iree_io_scope_map_deinitialize(&scope_map);
 
   IREE_TRACE_ZONE_END(z0);
@@ -17,6 +17,7 @@
 #include "iree/tooling/function_io.h"
 #include "iree/tooling/function_util.h"
 #include "iree/tooling/instrument_util.h"
+#include "iree/tooling/vm_sampling_util.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/module.h"
 
@@ -247,6 +248,14 @@ static iree_status_t iree_tooling_run_function(
                                     "beginning device profiling");
   }
 
+  // Sample the VM stacks for only the duration of the invocation.
+  iree_vm_sampling_profiler_t* vm_profiler = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(
+        iree_tooling_begin_vm_sampling_from_flags(host_allocator, &vm_profiler),
+        "beginning VM sampling");
+  }
+
   // Invoke the function with the provided inputs.
   if (iree_status_is_ok(status)) {
     status = iree_status_annotate_f(
@@ -257,6 +266,14 @@ static iree_status_t iree_tooling_run_function(
   }
   iree_vm_list_release(inputs);
 
+  // End sampling once the VM has returned. Asynchronous device work is not
+  // attributed to any VM function and is covered by device profiling instead.
+  // Samples are written even if the invocation failed.
+  status = iree_status_join(
+      status, iree_status_annotate_f(
+                  iree_tooling_end_vm_sampling_from_flags(vm_profiler),
+                  "ending VM sampling"));
+
   // If the function is async we need to wait for it to complete.
   if (iree_status_is_ok(status) && finish_fence) {
     IREE_RETURN_IF_ERROR(
@@ -428,6 +445,10 @@ iree_status_t iree_tooling_run_module_with_data(
     IREE_IGNORE_ERROR(
         iree_hal_allocator_statistics_fprint(stderr, device_allocator));
   }
+  if (device && FLAG_print_statistics) {
+    IREE_IGNORE_ERROR(
+        iree_hal_device_scheduler_statistics_fprint(stderr, device));
+  }
 
   iree_hal_allocator_release(device_allocator);
   iree_hal_device_release(device);
@@ -0,0 +1,139 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/vm_sampling_util.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/internal/flags.h"
+
+//===----------------------------------------------------------------------===//
+// VM sampling profiler
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(string, vm_sampling_file, "",
+          "File to populate with VM function samples or empty to disable\n"
+          "sampling. Samples are taken of the VM call stacks executing while\n"
+          "the program runs and attributed to functions and source locations.");
+IREE_FLAG(string, vm_sampling_format, "",
+          "Format of the --vm_sampling_file (one of ['pprof', 'collapsed']).\n"
+          "When empty the format is inferred from the file extension with\n"
+          "`.pb` and `.pprof` producing pprof and all others producing\n"
+          "collapsed stacks as consumed by flamegraph.pl and speedscope.");
+IREE_FLAG(int32_t, vm_sampling_interval_us, 1000,
+          "Interval between VM samples in microseconds.");
+
+typedef enum iree_tooling_vm_sampling_format_e {
+  IREE_TOOLING_VM_SAMPLING_FORMAT_COLLAPSED = 0,
+  IREE_TOOLING_VM_SAMPLING_FORMAT_PPROF,
+} iree_tooling_vm_sampling_format_t;
+
+static iree_status_t iree_tooling_parse_vm_sampling_format(
+    iree_tooling_vm_sampling_format_t* out_format) {
+  iree_string_view_t format = iree_make_cstring_view(FLAG_vm_sampling_format);
+  if (iree_string_view_is_empty(format)) {
+    iree_string_view_t path = iree_make_cstring_view(FLAG_vm_sampling_file);
+    const bool is_pprof = iree_string_view_ends_with(path, IREE_SV(".pb")) ||
+                          iree_string_view_ends_with(path, IREE_SV(".pprof"));
+    *out_format = is_pprof ? IREE_TOOLING_VM_SAMPLING_FORMAT_PPROF
+                           : IREE_TOOLING_VM_SAMPLING_FORMAT_COLLAPSED;
+  } else if (iree_string_view_equal(format, IREE_SV("pprof"))) {
+    *out_format = IREE_TOOLING_VM_SAMPLING_FORMAT_PPROF;
+  } else if (iree_string_view_equal(format, IREE_SV("collapsed"))) {
+    *out_format = IREE_TOOLING_VM_SAMPLING_FORMAT_COLLAPSED;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported VM sampling format '%s'",
+                            FLAG_vm_sampling_format);
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_tooling_begin_vm_sampling_from_flags(
+    iree_allocator_t host_allocator,
+    iree_vm_sampling_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  if (strlen(FLAG_vm_sampling_file) == 0) return iree_ok_status();
+
+  // Validate the format up-front so that users don't find out after a long
+  // run that their samples could not be written.
+  iree_tooling_vm_sampling_format_t format =
+      IREE_TOOLING_VM_SAMPLING_FORMAT_COLLAPSED;
+  IREE_RETURN_IF_ERROR(iree_tooling_parse_vm_sampling_format(&format));
+  if (FLAG_vm_sampling_interval_us <= 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "VM sampling interval must be positive; got %d",
+                            FLAG_vm_sampling_interval_us);
+  }
+
+  iree_vm_sampling_profiler_options_t options = {0};
+  options.interval_ns = FLAG_vm_sampling_interval_us * 1000ll;
+  iree_vm_sampling_profiler_t* profiler = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_sampling_profiler_create(options, host_allocator, &profiler));
+  iree_status_t status = iree_vm_sampling_profiler_start(profiler);
+  if (iree_status_is_ok(status)) {
+    *out_profiler = profiler;
+  } else {
+    iree_vm_sampling_profiler_release(profiler);
+  }
+  return status;
+}
+
+static iree_status_t iree_tooling_write_vm_samples(
+    iree_vm_sampling_profiler_t* profiler) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_vm_sampling_file);
+
+  iree_tooling_vm_sampling_format_t format =
+      IREE_TOOLING_VM_SAMPLING_FORMAT_COLLAPSED;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_tooling_parse_vm_sampling_format(&format));
+
+  // Serialize the entire profile before opening the file so that a failure
+  // doesn't leave a partial file behind.
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  iree_status_t status =
+      format == IREE_TOOLING_VM_SAMPLING_FORMAT_PPROF
+          ? iree_vm_sampling_profiler_append_pprof(profiler, &builder)
+          : iree_vm_sampling_profiler_append_collapsed(profiler, &builder);
+
+  if (iree_status_is_ok(status)) {
+    FILE* file = fopen(FLAG_vm_sampling_file, "wb");
+    if (file) {
+      const iree_host_size_t size = iree_string_builder_size(&builder);
+      if (fwrite(iree_string_builder_buffer(&builder), 1, size, file) !=
+          size) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "failed to write VM samples to '%s'",
+                                  FLAG_vm_sampling_file);
+      }
+      fclose(file);
+    } else {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to open VM sampling file '%s' for "
+                                "writing",
+                                FLAG_vm_sampling_file);
+    }
+  }
+
+  iree_string_builder_deinitialize(&builder);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_tooling_end_vm_sampling_from_flags(
+    iree_vm_sampling_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  iree_vm_sampling_profiler_stop(profiler);
+  iree_status_t status = iree_tooling_write_vm_samples(profiler);
+  iree_vm_sampling_profiler_release(profiler);
+  return status;
+}
@@ -0,0 +1,37 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TOOLING_VM_SAMPLING_UTIL_H_
+#define IREE_TOOLING_VM_SAMPLING_UTIL_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// VM sampling profiler
+//===----------------------------------------------------------------------===//
+
+// Creates and starts a VM sampling profiler configured from command line
+// flags. |out_profiler| is set to NULL if sampling is not enabled.
+// Must be matched with a call to iree_tooling_end_vm_sampling_from_flags.
+iree_status_t iree_tooling_begin_vm_sampling_from_flags(
+    iree_allocator_t host_allocator,
+    iree_vm_sampling_profiler_t** out_profiler);
+
+// Stops |profiler|, writes the recorded samples to the file specified by
+// command line flags, and releases the profiler. No-op if |profiler| is NULL.
+iree_status_t iree_tooling_end_vm_sampling_from_flags(
+    iree_vm_sampling_profiler_t* profiler);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_VM_SAMPLING_UTIL_H_
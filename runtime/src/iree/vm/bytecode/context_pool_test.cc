@@ -0,0 +1,177 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests for the bytecode module reset_state implementation used when pooled
+// contexts are recycled. The native module behavior is covered by
+// iree/vm/context_pool_test.cc.
+
+#include "iree/vm/context_pool.h"
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode/context_pool_test_module_c.h"
+#include "iree/vm/bytecode/module.h"
+
+namespace {
+
+using iree::StatusOr;
+using iree::vm::ref;
+
+// Uses context_pool_test.mlir: `add` accumulates into an i32 global stored in
+// rwdata and `swap_buffer` exchanges the value of a !vm.buffer ref global.
+class VMBytecodeContextPoolTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+
+    const auto* module_file_toc = iree_vm_context_pool_test_module_create();
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        instance_,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &bytecode_module_,
+        iree_allocator_system(), &parent_context_));
+  }
+
+  virtual void TearDown() {
+    iree_vm_context_release(parent_context_);
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  ref<iree_vm_buffer_t> CreateBuffer() {
+    ref<iree_vm_buffer_t> buffer;
+    IREE_CHECK_OK(iree_vm_buffer_create(
+        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+        /*length=*/16, /*alignment=*/0, iree_allocator_system(), &buffer));
+    return buffer;
+  }
+
+  // Invokes |function_name| in |context| with |inputs| and returns the
+  // single result.
+  StatusOr<ref<iree_vm_list_t>> Invoke(iree_vm_context_t* context,
+                                       const char* function_name,
+                                       iree_vm_list_t* inputs) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_make_cstring_view(function_name), &function));
+    ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &outputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        inputs, outputs.get(), iree_allocator_system()));
+    return outputs;
+  }
+
+  // Runs add(|delta|) in |context| and returns the new counter value.
+  StatusOr<int32_t> RunAdd(iree_vm_context_t* context, int32_t delta) {
+    ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &inputs));
+    iree_vm_value_t delta_value = iree_vm_value_make_i32(delta);
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_value(inputs.get(), &delta_value));
+    IREE_ASSIGN_OR_RETURN(auto outputs, Invoke(context, "add", inputs.get()));
+    iree_vm_value_t result_value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value(outputs.get(), 0, &result_value));
+    return result_value.i32;
+  }
+
+  // Runs swap_buffer(|new_buffer|) in |context| and returns the prior value.
+  StatusOr<ref<iree_vm_buffer_t>> RunSwapBuffer(
+      iree_vm_context_t* context, const ref<iree_vm_buffer_t>& new_buffer) {
+    ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &inputs));
+    iree_vm_ref_t new_buffer_ref = iree_vm_buffer_retain_ref(new_buffer.get());
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(inputs.get(), &new_buffer_ref));
+    IREE_ASSIGN_OR_RETURN(auto outputs,
+                          Invoke(context, "swap_buffer", inputs.get()));
+    iree_vm_ref_t old_buffer_ref = iree_vm_ref_null();
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_ref_retain(outputs.get(), 0, &old_buffer_ref));
+    iree_vm_buffer_t* old_buffer = NULL;
+    iree_status_t status =
+        iree_vm_buffer_check_deref_or_null(old_buffer_ref, &old_buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_vm_ref_release(&old_buffer_ref);
+      return status;
+    }
+    return iree::vm::assign_ref(old_buffer);
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+  iree_vm_context_t* parent_context_ = nullptr;
+};
+
+// Tests that recycling a context restores both rwdata and ref globals mutated
+// by bytecode to the values they had in the parent context.
+TEST_F(VMBytecodeContextPoolTest, RecycleResetsGlobals) {
+  // Populate the parent globals before the pool forks from it.
+  ref<iree_vm_buffer_t> parent_buffer = CreateBuffer();
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t parent_v0, RunAdd(parent_context_, 5));
+  ASSERT_EQ(parent_v0, 5);
+  IREE_ASSERT_OK_AND_ASSIGN(auto parent_old_buffer,
+                            RunSwapBuffer(parent_context_, parent_buffer));
+  ASSERT_EQ(parent_old_buffer.get(), nullptr);
+
+  iree_vm_context_pool_options_t options = {0};
+  options.warm_count = 1;
+  iree_vm_context_pool_t* pool = NULL;
+  IREE_ASSERT_OK(iree_vm_context_pool_create(
+      parent_context_, options, iree_allocator_system(), &pool));
+
+  // Mutate both globals in the pooled context.
+  ref<iree_vm_buffer_t> child_buffer = CreateBuffer();
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_pool_acquire(pool, &context));
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunAdd(context, 3));
+  EXPECT_EQ(v0, 8);
+  IREE_ASSERT_OK_AND_ASSIGN(auto old_buffer0,
+                            RunSwapBuffer(context, child_buffer));
+  EXPECT_EQ(old_buffer0.get(), parent_buffer.get());
+  iree_vm_context_t* first_context = context;
+  IREE_ASSERT_OK(iree_vm_context_pool_recycle(pool, context));
+
+  // The reset released the pooled context's reference to child_buffer.
+  EXPECT_EQ(iree_atomic_ref_count_load(&child_buffer->ref_object.counter), 1);
+
+  // The same warm context is reused and observes the parent values again.
+  IREE_ASSERT_OK(iree_vm_context_pool_acquire(pool, &context));
+  EXPECT_EQ(context, first_context);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, RunAdd(context, 3));
+  EXPECT_EQ(v1, 8);
+  IREE_ASSERT_OK_AND_ASSIGN(auto old_buffer1,
+                            RunSwapBuffer(context, child_buffer));
+  EXPECT_EQ(old_buffer1.get(), parent_buffer.get());
+  IREE_ASSERT_OK(iree_vm_context_pool_recycle(pool, context));
+
+  iree_vm_context_pool_release(pool);
+
+  // The parent globals are unaffected by the pooled contexts.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t parent_v1, RunAdd(parent_context_, 0));
+  EXPECT_EQ(parent_v1, 5);
+  IREE_ASSERT_OK_AND_ASSIGN(auto parent_old_buffer1,
+                            RunSwapBuffer(parent_context_, parent_buffer));
+  EXPECT_EQ(parent_old_buffer1.get(), parent_buffer.get());
+}
+
+}  // namespace
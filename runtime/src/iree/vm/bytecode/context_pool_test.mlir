@@ -0,0 +1,21 @@
+vm.module @context_pool_test {
+  vm.global.i32 private mutable @counter : i32
+  vm.global.ref private mutable @buffer : !vm.buffer
+
+  // Adds |delta| to the counter global in rwdata and returns the new value.
+  vm.export @add
+  vm.func @add(%delta: i32) -> i32 {
+    %counter = vm.global.load.i32 @counter : i32
+    %sum = vm.add.i32 %counter, %delta : i32
+    vm.global.store.i32 %sum, @counter : i32
+    vm.return %sum : i32
+  }
+
+  // Stores |new_buffer| in the buffer ref global and returns the prior value.
+  vm.export @swap_buffer
+  vm.func @swap_buffer(%new_buffer: !vm.buffer) -> !vm.buffer {
+    %old_buffer = vm.global.load.ref @buffer : !vm.buffer
+    vm.global.store.ref %new_buffer, @buffer : !vm.buffer
+    vm.return %old_buffer : !vm.buffer
+  }
+}
@@ -1666,6 +1666,42 @@ iree_status_t iree_vm_bytecode_disassemble_op(
       break;
     }
 
+#define DISASM_OP_CORE_CMP_BR(op_name, op_mnemonic, type)                    \
+  DISASM_OP(CORE, op_name) {                                                 \
+    uint16_t lhs_reg = VM_ParseOperandReg##type("lhs");                      \
+    uint16_t rhs_reg = VM_ParseOperandReg##type("rhs");                      \
+    int32_t true_block_pc = VM_ParseBranchTarget("true_dest");               \
+    const iree_vm_register_remap_list_t* true_remap_list =                   \
+        VM_ParseBranchOperands("true_operands");                             \
+    int32_t false_block_pc = VM_ParseBranchTarget("false_dest");             \
+    const iree_vm_register_remap_list_t* false_remap_list =                  \
+        VM_ParseBranchOperands("false_operands");                            \
+    IREE_RETURN_IF_ERROR(                                                    \
+        iree_string_builder_append_format(b, "%s ", op_mnemonic));           \
+    EMIT_##type##_REG_NAME(lhs_reg);                                         \
+    EMIT_OPTIONAL_VALUE_##type(regs->i32[lhs_reg]);                          \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ", "));       \
+    EMIT_##type##_REG_NAME(rhs_reg);                                         \
+    EMIT_OPTIONAL_VALUE_##type(regs->i32[rhs_reg]);                          \
+    IREE_RETURN_IF_ERROR(                                                    \
+        iree_string_builder_append_format(b, ", ^%08X(", true_block_pc));    \
+    EMIT_REMAP_LIST(true_remap_list);                                        \
+    IREE_RETURN_IF_ERROR(                                                    \
+        iree_string_builder_append_format(b, "), ^%08X(", false_block_pc));  \
+    EMIT_REMAP_LIST(false_remap_list);                                       \
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(b, ")"));        \
+    break;                                                                   \
+  }
+
+    DISASM_OP_CORE_CMP_BR(CmpBrEQI32, "vm.cmp_br.eq.i32", I32);
+    DISASM_OP_CORE_CMP_BR(CmpBrNEI32, "vm.cmp_br.ne.i32", I32);
+    DISASM_OP_CORE_CMP_BR(CmpBrLTI32S, "vm.cmp_br.lt.i32.s", I32);
+    DISASM_OP_CORE_CMP_BR(CmpBrLTI32U, "vm.cmp_br.lt.i32.u", I32);
+    DISASM_OP_CORE_CMP_BR(CmpBrEQI64, "vm.cmp_br.eq.i64", I64);
+    DISASM_OP_CORE_CMP_BR(CmpBrNEI64, "vm.cmp_br.ne.i64", I64);
+    DISASM_OP_CORE_CMP_BR(CmpBrLTI64S, "vm.cmp_br.lt.i64.s", I64);
+    DISASM_OP_CORE_CMP_BR(CmpBrLTI64U, "vm.cmp_br.lt.i64.u", I64);
+
     DISASM_OP(CORE, BranchTable) {
       uint16_t index_reg = VM_ParseOperandRegI32("index");
       IREE_RETURN_IF_ERROR(
@@ -102,6 +102,8 @@ static iree_status_t iree_vm_bytecode_function_enter(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "import ordinal out of range");
   }
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_ensure_function_verified(
+      module, (uint16_t)function.ordinal));
   const iree_vm_FunctionDescriptor_t* target_descriptor =
       &module->function_descriptor_table[function.ordinal];
 
@@ -447,16 +449,47 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
   }
 }
 
+// Calls a native module import directly through its resolved trampoline.
+// The callee module state is queried once per import table and cached.
+static iree_status_t iree_vm_bytecode_issue_import_trampoline(
+    iree_vm_stack_t* stack, const iree_vm_bytecode_import_t* import,
+    const iree_vm_function_call_t call) {
+  // The import table is otherwise immutable but the cached state is lazily
+  // populated on first use.
+  iree_atomic_intptr_t* trampoline_state =
+      (iree_atomic_intptr_t*)&import->trampoline_state;
+  intptr_t tagged_state =
+      iree_atomic_load(trampoline_state, iree_memory_order_relaxed);
+  if (IREE_UNLIKELY(!tagged_state)) {
+    iree_vm_module_state_t* module_state = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_query_module_state(
+        stack, call.function.module, &module_state));
+    tagged_state =
+        (intptr_t)module_state | IREE_VM_BYTECODE_IMPORT_STATE_RESOLVED;
+    iree_atomic_store(trampoline_state, tagged_state,
+                      iree_memory_order_relaxed);
+  }
+  iree_vm_module_state_t* module_state =
+      (iree_vm_module_state_t*)(tagged_state &
+                                ~IREE_VM_BYTECODE_IMPORT_STATE_RESOLVED);
+  return iree_vm_native_function_trampoline_call(
+      &import->trampoline, stack, &call.function, module_state, call.arguments,
+      call.results);
+}
+
 // Issues a populated import call and marshals the results into |dst_reg_list|.
 static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+    iree_vm_stack_t* stack, const iree_vm_bytecode_import_t* import,
+    const iree_vm_function_call_t call,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
     iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
   // Call external function.
   iree_status_t call_status =
-      call.function.module->begin_call(call.function.module->self, stack, call);
+      import->trampoline.function_ptr.shim
+          ? iree_vm_bytecode_issue_import_trampoline(stack, import, call)
+          : call.function.module->begin_call(call.function.module->self,
+                                             stack, call);
   if (iree_status_is_deferred(call_status)) {
     if (!iree_byte_span_is_empty(call.results)) {
       iree_status_ignore(call_status);
@@ -478,6 +511,7 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
       iree_vm_bytecode_get_register_storage(*out_caller_frame);
 
   // Marshal outputs from the ABI results buffer to registers.
+  iree_string_view_t cconv_results = import->results;
   iree_vm_registers_t caller_registers = *out_caller_registers;
   uint8_t* IREE_RESTRICT p = call.results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
@@ -572,8 +606,8 @@ static iree_status_t iree_vm_bytecode_call_import(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, import, call, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -613,8 +647,8 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, import, call, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -665,6 +699,25 @@ iree_status_t iree_vm_bytecode_dispatch_resume(
                                    call_results);
 }
 
+// Returns the function of the import referenced by |function_ordinal|.
+static inline const iree_vm_function_t* iree_vm_bytecode_import_function(
+    const iree_vm_bytecode_module_state_t* module_state,
+    uint32_t function_ordinal) {
+  return &module_state->import_table[function_ordinal & 0x7FFFFFFFu].function;
+}
+
+// Records a sampling profiler sample at a safepoint if the sample epoch has
+// advanced since it was last observed by the dispatch loop. |leaf_function| is
+// only evaluated when a sample is taken.
+#define IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(leaf_function)                    \
+  do {                                                                      \
+    if (IREE_UNLIKELY(iree_vm_sampling_profiler_epoch() != sample_epoch)) { \
+      current_frame->pc = pc;                                               \
+      sample_epoch = iree_vm_sampling_profiler_record(stack, sample_epoch,  \
+                                                      (leaf_function));     \
+    }                                                                       \
+  } while (0)
+
 static iree_status_t iree_vm_bytecode_dispatch(
     iree_vm_stack_t* IREE_RESTRICT stack,
     iree_vm_bytecode_module_t* IREE_RESTRICT module,
@@ -694,6 +747,10 @@ static iree_status_t iree_vm_bytecode_dispatch(
   IREE_BUILTIN_ASSUME_ALIGNED(regs_ref, sizeof(iree_max_align_t));
 
   iree_vm_source_offset_t pc = current_frame->pc;
+
+  // Sampling profiler epoch last observed at a safepoint.
+  int32_t sample_epoch = iree_vm_sampling_profiler_epoch();
+
   BEGIN_DISPATCH_CORE() {
     //===------------------------------------------------------------------===//
     // Globals
@@ -1633,6 +1690,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
         iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref,
                                                          remap_list);
       }
+      IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(NULL);
     });
 
     DISPATCH_OP(CORE, CondBranch, {
@@ -1656,6 +1714,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
                                                            false_remap_list);
         }
       }
+      IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(NULL);
     });
 
     DISPATCH_OP(CORE, BranchTable, {
@@ -1687,8 +1746,74 @@ static iree_status_t iree_vm_bytecode_dispatch(
                                                            case_remap_list);
         }
       }
+      IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(NULL);
     });
 
+    //===------------------------------------------------------------------===//
+    // Fused superinstructions (EXT_FUSED)
+    //===------------------------------------------------------------------===//
+    // These are only emitted by the compiler in place of a comparison that is
+    // immediately consumed by a vm.cond_br. The comparison result is never
+    // observed and not written to a register.
+
+#if IREE_VM_EXT_FUSED_ENABLE
+
+#define DISPATCH_OP_CORE_CMP_BR(op_name, type, dec_fn, op_func)              \
+  DISPATCH_OP(CORE, op_name, {                                               \
+    type lhs = dec_fn("lhs");                                                \
+    type rhs = dec_fn("rhs");                                                \
+    int32_t true_block_pc = VM_DecBranchTarget("true_dest");                 \
+    const iree_vm_register_remap_list_t* true_remap_list =                   \
+        VM_DecBranchOperands("true_operands");                               \
+    int32_t false_block_pc = VM_DecBranchTarget("false_dest");               \
+    const iree_vm_register_remap_list_t* false_remap_list =                  \
+        VM_DecBranchOperands("false_operands");                              \
+    if (op_func(lhs, rhs)) {                                                 \
+      pc = true_block_pc + IREE_VM_BLOCK_MARKER_SIZE;                        \
+      if (IREE_UNLIKELY(true_remap_list->size > 0)) {                        \
+        iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref, \
+                                                         true_remap_list);   \
+      }                                                                      \
+    } else {                                                                 \
+      pc = false_block_pc + IREE_VM_BLOCK_MARKER_SIZE;                       \
+      if (IREE_UNLIKELY(false_remap_list->size > 0)) {                       \
+        iree_vm_bytecode_dispatch_remap_branch_registers(regs_i32, regs_ref, \
+                                                         false_remap_list);  \
+      }                                                                      \
+    }                                                                        \
+    IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(NULL);                                 \
+  });
+
+    DISPATCH_OP_CORE_CMP_BR(CmpBrEQI32, int32_t, VM_DecOperandRegI32,
+                            vm_cmp_eq_i32);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrNEI32, int32_t, VM_DecOperandRegI32,
+                            vm_cmp_ne_i32);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrLTI32S, int32_t, VM_DecOperandRegI32,
+                            vm_cmp_lt_i32s);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrLTI32U, int32_t, VM_DecOperandRegI32,
+                            vm_cmp_lt_i32u);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrEQI64, int64_t, VM_DecOperandRegI64,
+                            vm_cmp_eq_i64);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrNEI64, int64_t, VM_DecOperandRegI64,
+                            vm_cmp_ne_i64);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrLTI64S, int64_t, VM_DecOperandRegI64,
+                            vm_cmp_lt_i64s);
+    DISPATCH_OP_CORE_CMP_BR(CmpBrLTI64U, int64_t, VM_DecOperandRegI64,
+                            vm_cmp_lt_i64u);
+
+#else
+
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrEQI32, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrNEI32, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrLTI32S, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrLTI32U, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrEQI64, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrNEI64, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrLTI64S, EXT_FUSED);
+    UNHANDLED_DISPATCH_OP(CORE, CmpBrLTI64U, EXT_FUSED);
+
+#endif  // IREE_VM_EXT_FUSED_ENABLE
+
     DISPATCH_OP(CORE, Call, {
       int32_t function_ordinal = VM_DecFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
@@ -1723,6 +1848,12 @@ static iree_status_t iree_vm_bytecode_dispatch(
       regs_ref = regs.ref;
       IREE_BUILTIN_ASSUME_ALIGNED(regs_ref, sizeof(iree_max_align_t));
       pc = current_frame->pc;
+
+      // Time spent in imports is attributed to the import called from here.
+      IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(
+          is_import ? iree_vm_bytecode_import_function(module_state,
+                                                       function_ordinal)
+                    : NULL);
     });
 
     DISPATCH_OP(CORE, CallVariadic, {
@@ -1759,6 +1890,9 @@ static iree_status_t iree_vm_bytecode_dispatch(
       regs_ref = regs.ref;
       IREE_BUILTIN_ASSUME_ALIGNED(regs_ref, sizeof(iree_max_align_t));
       pc = current_frame->pc;
+
+      IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(
+          iree_vm_bytecode_import_function(module_state, function_ordinal));
     });
 
     DISPATCH_OP(CORE, Return, {
@@ -1766,6 +1900,10 @@ static iree_status_t iree_vm_bytecode_dispatch(
           VM_DecVariadicOperands("operands");
       current_frame->pc = pc;
 
+      // Sampled before leaving so that time spent in the function is
+      // attributed to it even when returning to a native caller.
+      IREE_VM_BYTECODE_SAMPLE_SAFEPOINT(NULL);
+
       // TODO(benvanik): faster check for escaping; this is slow (cache misses).
       iree_vm_stack_frame_t* parent_frame = iree_vm_stack_parent_frame(stack);
       if (!parent_frame ||
@@ -294,6 +294,12 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,             \
                             "unhandled dispatch extension " #ext); \
   }
+#define UNHANDLED_DISPATCH_OP(ext, op_name, feature)                   \
+  _dispatch_##ext##_##op_name : {                                      \
+    IREE_ASSERT(0);                                                    \
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,                 \
+                            "unhandled dispatch extension " #feature); \
+  }
 
 #define DISPATCH_OP(ext, op_name, body)                               \
   _dispatch_##ext##_##op_name :;                                      \
@@ -332,6 +338,13 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,             \
                             "unhandled dispatch extension " #ext); \
   }
+#define UNHANDLED_DISPATCH_OP(ext, op_name, feature)                   \
+  case IREE_VM_OP_##ext##_##op_name: {                                 \
+    IREE_ASSERT(0);                                                    \
+    IREE_BUILTIN_UNREACHABLE(); /* ok because verified */              \
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,                 \
+                            "unhandled dispatch extension " #feature); \
+  }
 
 #define DISPATCH_OP(ext, op_name, body)                                 \
   case IREE_VM_OP_##ext##_##op_name: {                                  \
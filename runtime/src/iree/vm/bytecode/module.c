@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "iree/base/internal/sha256.h"
 #include "iree/vm/bytecode/archive.h"
 #include "iree/vm/bytecode/module_impl.h"
 #include "iree/vm/bytecode/verifier.h"
@@ -748,12 +749,56 @@ static iree_status_t IREE_API_PTR iree_vm_bytecode_module_fork_state(
   memcpy(child_state->import_table, parent_state->import_table,
          parent_state->import_count * sizeof(child_state->import_table[0]));
 
+  // Cached trampoline callee states reference modules in the parent context
+  // and must be queried again from the child context.
+  for (iree_host_size_t i = 0; i < child_state->import_count; ++i) {
+    iree_atomic_store(&child_state->import_table[i].trampoline_state, 0,
+                      iree_memory_order_relaxed);
+  }
+
   *out_child_state = (iree_vm_module_state_t*)child_state;
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
+static iree_status_t IREE_API_PTR iree_vm_bytecode_module_reset_state(
+    void* self, iree_vm_module_state_t* base_parent_state,
+    iree_vm_module_state_t* base_module_state) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_bytecode_module_state_t* parent_state =
+      (iree_vm_bytecode_module_state_t*)base_parent_state;
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)base_module_state;
+
+  // rwdata is a single flat block and restoring it wholesale is cheaper than
+  // tracking which bytes were written.
+  memcpy(state->rwdata_storage.data, parent_state->rwdata_storage.data,
+         state->rwdata_storage.data_length);
+
+  // Only ref globals that were changed since the fork are reassigned so that
+  // unchanged resources are not needlessly released and retained.
+  iree_host_size_t reset_ref_count = 0;
+  for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_t* parent_ref = &parent_state->global_ref_table[i];
+    iree_vm_ref_t* ref = &state->global_ref_table[i];
+    if (ref->ptr == parent_ref->ptr && ref->type == parent_ref->type) continue;
+    iree_vm_ref_retain(parent_ref, ref);
+    ++reset_ref_count;
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)reset_ref_count);
+
+  // Imports still resolve to the same functions but the callee module states
+  // may have been forked again by the context.
+  for (iree_host_size_t i = 0; i < state->import_count; ++i) {
+    iree_atomic_store(&state->import_table[i].trampoline_state, 0,
+                      iree_memory_order_relaxed);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -797,6 +842,11 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
   import->argument_buffer_size = (uint16_t)argument_buffer_size;
   import->result_buffer_size = (uint16_t)result_buffer_size;
 
+  // Native module imports can be called directly without going through the
+  // module interface; the callee state is queried on first call.
+  iree_vm_native_module_resolve_trampoline(function, &import->trampoline);
+  iree_atomic_store(&import->trampoline_state, 0, iree_memory_order_relaxed);
+
   return iree_ok_status();
 }
 
@@ -858,14 +908,82 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+IREE_API_EXPORT void iree_vm_bytecode_module_options_initialize(
+    iree_vm_bytecode_module_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->flags = IREE_VM_BYTECODE_MODULE_FLAG_NONE;
+  out_options->verification_cache = iree_vm_bytecode_verification_cache_null();
+}
+
+// Computes the digest of |contents| for use as a verification cache key.
+static void iree_vm_bytecode_module_digest_contents(
+    iree_const_byte_span_t contents,
+    iree_vm_bytecode_content_digest_t* out_digest) {
+  iree_sha256_digest_t digest;
+  iree_sha256(contents, &digest);
+  static_assert(sizeof(digest.bytes) == sizeof(out_digest->bytes),
+                "digest size mismatch");
+  memcpy(out_digest->bytes, digest.bytes, sizeof(out_digest->bytes));
+}
+
+iree_status_t iree_vm_bytecode_module_verify_function_lazy(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_vm_bytecode_function_verify");
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, function_ordinal);
+
+  // Multiple threads may race to verify the same function. That's fine as
+  // verification has no side-effects and the result is the same.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_function_verify(module, function_ordinal,
+                                           module->allocator));
+
+  // Mark the function verified. Only the thread that sets the bit counts it so
+  // that the cache is notified exactly once.
+  const int32_t bit = (int32_t)(1u << (function_ordinal % 32));
+  const int32_t prior_word = iree_atomic_fetch_or(
+      &module->verified_function_bits[function_ordinal / 32], bit,
+      iree_memory_order_acq_rel);
+  if (!(prior_word & bit)) {
+    const int32_t verified_count =
+        iree_atomic_fetch_add(&module->verified_function_count, 1,
+                              iree_memory_order_acq_rel) +
+        1;
+    if (verified_count == (int32_t)module->function_descriptor_count &&
+        module->verification_cache.insert) {
+      module->verification_cache.insert(module->verification_cache.self,
+                                        &module->content_digest);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  return iree_vm_bytecode_module_create_with_options(
+      instance, /*options=*/NULL, archive_contents, archive_allocator,
+      allocator, out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
 
+  iree_vm_bytecode_module_options_t default_options;
+  if (!options) {
+    iree_vm_bytecode_module_options_initialize(&default_options);
+    options = &default_options;
+  }
+
   // Parse and verify the archive header to locate the FlatBuffer.
   iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
   iree_host_size_t archive_rodata_offset = 0;
@@ -902,13 +1020,56 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  // Determine how functions will be verified: if the contents have previously
+  // been verified we can skip it entirely and otherwise we either verify all
+  // functions now or defer each until first call.
+  iree_host_size_t function_count = iree_vm_FunctionDescriptor_vec_len(
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def));
+  bool verify_functions = IREE_VM_BYTECODE_VERIFICATION_ENABLE;
+  iree_vm_bytecode_content_digest_t content_digest;
+  memset(&content_digest, 0, sizeof(content_digest));
+  const iree_vm_bytecode_verification_cache_t* verification_cache =
+      &options->verification_cache;
+  if (verify_functions &&
+      (verification_cache->lookup || verification_cache->insert)) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_module_digest_contents");
+    iree_vm_bytecode_module_digest_contents(flatbuffer_contents,
+                                            &content_digest);
+    IREE_TRACE_ZONE_END(z1);
+    if (verification_cache->lookup &&
+        verification_cache->lookup(verification_cache->self,
+                                   &content_digest)) {
+      verify_functions = false;
+    }
+  }
+  const bool verify_lazily =
+      verify_functions && function_count > 0 &&
+      iree_all_bits_set(options->flags,
+                        IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION);
+  size_t verified_function_bits_size =
+      verify_lazily ? iree_host_align(iree_host_align(function_count, 32) / 8,
+                                      16)
+                    : 0;
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size +
+                                    verified_function_bits_size,
+                                (void**)&module));
   module->allocator = allocator;
+  module->verification_cache = *verification_cache;
+  module->content_digest = content_digest;
+  iree_atomic_store(&module->verified_function_count, 0,
+                    iree_memory_order_relaxed);
+  module->verified_function_bits = NULL;
+  if (verify_lazily) {
+    module->verified_function_bits =
+        (iree_atomic_int32_t*)((uint8_t*)module + sizeof(*module) +
+                               type_table_size + rodata_ref_table_size);
+    memset(module->verified_function_bits, 0, verified_function_bits_size);
+  }
 
   iree_vm_FunctionDescriptor_vec_t function_descriptors =
       iree_vm_BytecodeModuleDef_function_descriptors(module_def);
@@ -953,6 +1114,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   module->interface.free_state = iree_vm_bytecode_module_free_state;
   module->interface.fork_state = iree_vm_bytecode_module_fork_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
+  module->interface.reset_state = iree_vm_bytecode_module_reset_state;
   module->interface.notify = iree_vm_bytecode_module_notify;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
   module->interface.resume_call = iree_vm_bytecode_module_resume_call;
@@ -987,16 +1149,20 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   }
 
   // Verify functions in the module now that we've verified the metadata that we
-  // need to do so.
+  // need to do so. When verifying lazily each function is verified by
+  // iree_vm_bytecode_module_verify_function_lazy when first entered.
   iree_status_t verify_status = iree_ok_status();
-#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
-  for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
-    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
-    verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
-    IREE_TRACE_ZONE_END(z1);
-    if (!iree_status_is_ok(verify_status)) break;
+  if (verify_functions && !verify_lazily) {
+    for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
+      verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
+      IREE_TRACE_ZONE_END(z1);
+      if (!iree_status_is_ok(verify_status)) break;
+    }
+    if (iree_status_is_ok(verify_status) && verification_cache->insert) {
+      verification_cache->insert(verification_cache->self, &content_digest);
+    }
   }
-#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
   if (iree_status_is_ok(verify_status)) {
     *out_module = &module->interface;
   } else {
@@ -14,6 +14,75 @@
 extern "C" {
 #endif  // __cplusplus
 
+//===----------------------------------------------------------------------===//
+// iree_vm_bytecode_verification_cache_t
+//===----------------------------------------------------------------------===//
+
+// SHA-256 digest of module FlatBuffer contents.
+typedef struct iree_vm_bytecode_content_digest_t {
+  uint8_t bytes[32];
+} iree_vm_bytecode_content_digest_t;
+
+// A cache of module contents that are known to have passed verification.
+// Modules are keyed by the SHA-256 digest of their FlatBuffer contents and when
+// a lookup succeeds all bytecode function verification is skipped. The digest
+// is collision resistant so contents crafted to match the key of a verified
+// module are not practical.
+//
+// The cache is trusted: an entry for contents that did not verify allows
+// malformed bytecode to execute. Persistent caches must only be stored in
+// locations the application trusts as much as the module files themselves.
+//
+// Both functions may be called from any thread and must be thread-safe.
+typedef struct iree_vm_bytecode_verification_cache_t {
+  // User-defined pointer passed to all functions.
+  void* self;
+  // Returns true if module contents with |digest| previously verified.
+  bool(IREE_API_PTR* lookup)(void* self,
+                             const iree_vm_bytecode_content_digest_t* digest);
+  // Records that module contents with |digest| verified successfully.
+  void(IREE_API_PTR* insert)(void* self,
+                             const iree_vm_bytecode_content_digest_t* digest);
+} iree_vm_bytecode_verification_cache_t;
+
+// Returns a cache that never hits and discards all insertions.
+static inline iree_vm_bytecode_verification_cache_t
+iree_vm_bytecode_verification_cache_null(void) {
+  iree_vm_bytecode_verification_cache_t cache = {NULL, NULL, NULL};
+  return cache;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_vm_bytecode_module_t
+//===----------------------------------------------------------------------===//
+
+enum iree_vm_bytecode_module_flag_bits_t {
+  IREE_VM_BYTECODE_MODULE_FLAG_NONE = 0u,
+
+  // Defers verification of each function until it is first called instead of
+  // verifying all functions when the module is created. Functions that are
+  // never called are never verified and a function failing verification
+  // will fail the call instead of module creation.
+  IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION = 1u << 0,
+};
+typedef uint32_t iree_vm_bytecode_module_flags_t;
+
+// Options controlling bytecode module creation.
+typedef struct iree_vm_bytecode_module_options_t {
+  // Flags controlling module behavior.
+  iree_vm_bytecode_module_flags_t flags;
+
+  // Optional cache used to skip verification of previously verified contents.
+  // When verification is lazy the contents are recorded once all functions
+  // have been verified and the cache must remain valid for the lifetime of the
+  // module.
+  iree_vm_bytecode_verification_cache_t verification_cache;
+} iree_vm_bytecode_module_options_t;
+
+// Initializes |out_options| to their default values.
+IREE_API_EXPORT void iree_vm_bytecode_module_options_initialize(
+    iree_vm_bytecode_module_options_t* out_options);
+
 // Creates a VM module from an in-memory ModuleDef FlatBuffer archive.
 // If a |archive_allocator| is provided then it will be used to free the
 // |archive_contents| when the module is destroyed and otherwise the ownership
@@ -23,6 +92,14 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module as with iree_vm_bytecode_module_create using the
+// provided |options|. If |options| is NULL the defaults are used.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
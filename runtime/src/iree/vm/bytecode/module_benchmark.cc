@@ -12,6 +12,7 @@
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/module.h"
 #include "iree/vm/bytecode/module_benchmark_module_c.h"
+#include "iree/vm/bytecode/module_benchmark_unfused_module_c.h"
 
 namespace {
 
@@ -71,10 +72,11 @@ static iree_status_t native_import_module_create(
 }
 
 // Benchmarks the given exported function, optionally passing in arguments.
-static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
-                                 iree_string_view_t function_name,
-                                 std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+// |module_file_toc| defaults to the module compiled with fused ops enabled.
+static iree_status_t RunFunction(
+    iree_benchmark_state_t* benchmark_state, iree_string_view_t function_name,
+    std::vector<int32_t> i32_args, int result_count, int64_t batch_size = 1,
+    const iree_file_toc_t* module_file_toc = NULL) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
@@ -83,8 +85,9 @@ static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
   IREE_CHECK_OK(native_import_module_create(instance, iree_allocator_system(),
                                             &import_module));
 
-  const auto* module_file_toc =
-      iree_vm_bytecode_module_benchmark_module_create();
+  if (!module_file_toc) {
+    module_file_toc = iree_vm_bytecode_module_benchmark_module_create();
+  }
   iree_vm_module_t* bytecode_module = nullptr;
   IREE_CHECK_OK(iree_vm_bytecode_module_create(
       instance,
@@ -160,6 +163,37 @@ IREE_BENCHMARK_FN(BM_ModuleCreate) {
 }
 IREE_BENCHMARK_REGISTER(BM_ModuleCreate);
 
+IREE_BENCHMARK_FN(BM_ModuleCreateLazyVerification) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  options.flags |= IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION;
+
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    const auto* module_file_toc =
+        iree_vm_bytecode_module_benchmark_module_create();
+    iree_vm_module_t* module = nullptr;
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_options(
+        instance, &options,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), iree_allocator_system(), &module));
+
+    // Functions are verified on first call so this only measures creation.
+    iree_optimization_barrier(module);
+
+    iree_vm_module_release(module);
+  }
+
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+IREE_BENCHMARK_REGISTER(BM_ModuleCreateLazyVerification);
+
 IREE_BENCHMARK_FN(BM_ModuleCreateState) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
@@ -335,6 +369,19 @@ IREE_BENCHMARK_FN(BM_LoopSumBytecode) {
 }
 IREE_BENCHMARK_REGISTER(BM_LoopSumBytecode);
 
+// Same as BM_LoopSumBytecode but with each compare-and-branch dispatched as
+// two instructions instead of one fused superinstruction.
+IREE_BENCHMARK_FN(BM_LoopSumBytecodeUnfused) {
+  static const int batch = 100000;
+  return RunFunction(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.loop_sum"), {batch},
+      /*result_count=*/1,
+      /*batch_size=*/batch,
+      iree_vm_bytecode_module_benchmark_unfused_module_create());
+}
+IREE_BENCHMARK_REGISTER(BM_LoopSumBytecodeUnfused);
+
 IREE_BENCHMARK_FN(BM_BufferReduceReference) {
   static const int batch = 100000;
   static auto work = +[](int32_t* buffer, int i, int sum) {
@@ -374,6 +421,18 @@ IREE_BENCHMARK_FN(BM_BufferReduceBytecode) {
 }
 IREE_BENCHMARK_REGISTER(BM_BufferReduceBytecode);
 
+IREE_BENCHMARK_FN(BM_BufferReduceBytecodeUnfused) {
+  static const int batch = 100000;
+  return RunFunction(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.buffer_reduce"),
+      {batch},
+      /*result_count=*/1,
+      /*batch_size=*/batch,
+      iree_vm_bytecode_module_benchmark_unfused_module_create());
+}
+IREE_BENCHMARK_REGISTER(BM_BufferReduceBytecodeUnfused);
+
 // NOTE: unrolled 8x, requires %count to be % 8 = 0.
 IREE_BENCHMARK_FN(BM_BufferReduceBytecodeUnrolled) {
   static const int batch = 100000;
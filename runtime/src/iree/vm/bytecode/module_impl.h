@@ -11,7 +11,9 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/vm/api.h"
+#include "iree/vm/bytecode/module.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
 #ifdef __cplusplus
@@ -48,6 +50,18 @@ typedef struct iree_vm_bytecode_module_t {
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
 
+  // Bitmap with one bit per function descriptor set once the function has
+  // been verified. NULL if all functions were verified (or verification was
+  // skipped) during module creation.
+  iree_atomic_int32_t* verified_function_bits;
+  // Number of bits set in |verified_function_bits|.
+  iree_atomic_int32_t verified_function_count;
+
+  // Cache that is notified once all functions have been lazily verified.
+  iree_vm_bytecode_verification_cache_t verification_cache;
+  // Digest of the FlatBuffer contents used as the |verification_cache| key.
+  iree_vm_bytecode_content_digest_t content_digest;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -73,8 +87,22 @@ typedef struct iree_vm_bytecode_import_t {
   // don't support variadic values (yet).
   uint16_t argument_buffer_size;
   uint16_t result_buffer_size;
+
+  // Direct-call trampoline used instead of begin_call when the import is
+  // implemented by a native module using the default call support. The shim is
+  // NULL if the import must be called through the module interface.
+  iree_vm_native_function_trampoline_t trampoline;
+
+  // Module state of the trampoline callee in the context owning this import
+  // table, lazily queried on first call and tagged with
+  // IREE_VM_BYTECODE_IMPORT_STATE_RESOLVED as native module state may be NULL.
+  // Concurrent invocations may race to store the same value.
+  iree_atomic_intptr_t trampoline_state;
 } iree_vm_bytecode_import_t;
 
+// Tag bit set on iree_vm_bytecode_import_t::trampoline_state once resolved.
+#define IREE_VM_BYTECODE_IMPORT_STATE_RESOLVED ((intptr_t)1)
+
 // Per-instance module state.
 // This is allocated with a provided allocator as a single flat allocation.
 // This struct is a prefix to the allocation pointing into the dynamic offsets
@@ -96,6 +124,27 @@ typedef struct iree_vm_bytecode_module_state_t {
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
+// Verifies |function_ordinal| if it has not yet been verified.
+// Only called when verification of the module is deferred until first call.
+iree_status_t iree_vm_bytecode_module_verify_function_lazy(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal);
+
+// Ensures that |function_ordinal| has been verified before it is executed.
+// This is a single predictable branch when all functions were verified
+// during module creation.
+static inline iree_status_t iree_vm_bytecode_module_ensure_function_verified(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  if (IREE_LIKELY(!module->verified_function_bits)) return iree_ok_status();
+  const int32_t word = iree_atomic_load(
+      &module->verified_function_bits[function_ordinal / 32],
+      iree_memory_order_acquire);
+  if (IREE_LIKELY((word >> (function_ordinal % 32)) & 1)) {
+    return iree_ok_status();
+  }
+  return iree_vm_bytecode_module_verify_function_lazy(module,
+                                                      function_ordinal);
+}
+
 // Begins execution of the current frame and continues until either a yield or
 // return.
 iree_status_t iree_vm_bytecode_dispatch_begin(
@@ -11,6 +11,8 @@
 #include "iree/vm/bytecode/module.h"
 
 #include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -113,13 +115,10 @@ class VMBytecodeModuleTest : public ::testing::Test {
     IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                           iree_allocator_system(), &instance_));
 
-    const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
-    IREE_CHECK_OK(iree_vm_bytecode_module_create(
-        instance_,
-        iree_const_byte_span_t{
-            reinterpret_cast<const uint8_t*>(module_file_toc->data),
-            static_cast<iree_host_size_t>(module_file_toc->size)},
-        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+    iree_vm_bytecode_module_options_t options = GetModuleOptions();
+    IREE_CHECK_OK(iree_vm_bytecode_module_create_with_options(
+        instance_, &options, GetModuleContents(), iree_allocator_null(),
+        iree_allocator_system(), &bytecode_module_));
 
     std::vector<iree_vm_module_t*> modules = {bytecode_module_};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
@@ -133,6 +132,19 @@ class VMBytecodeModuleTest : public ::testing::Test {
     iree_vm_instance_release(instance_);
   }
 
+  virtual iree_vm_bytecode_module_options_t GetModuleOptions() {
+    iree_vm_bytecode_module_options_t options;
+    iree_vm_bytecode_module_options_initialize(&options);
+    return options;
+  }
+
+  static iree_const_byte_span_t GetModuleContents() {
+    const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
+    return iree_const_byte_span_t{
+        reinterpret_cast<const uint8_t*>(module_file_toc->data),
+        static_cast<iree_host_size_t>(module_file_toc->size)};
+  }
+
   StatusOr<std::vector<iree_vm_value_t>> RunFunction(
       const char* function_name, std::vector<iree_vm_value_t> inputs) {
     ref<iree_vm_list_t> input_list;
@@ -228,4 +240,95 @@ TEST_F(VMBytecodeModuleTest, FuncIO600) {
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+// Verification cache recording all lookups and insertions.
+struct TestVerificationCache {
+  std::set<std::string> entries;
+  int lookup_count = 0;
+  int insert_count = 0;
+
+  static std::string Key(const iree_vm_bytecode_content_digest_t* digest) {
+    return std::string(reinterpret_cast<const char*>(digest->bytes),
+                       sizeof(digest->bytes));
+  }
+
+  iree_vm_bytecode_verification_cache_t Get() {
+    iree_vm_bytecode_verification_cache_t cache;
+    cache.self = this;
+    cache.lookup = +[](void* self,
+                       const iree_vm_bytecode_content_digest_t* digest) {
+      auto* cache = reinterpret_cast<TestVerificationCache*>(self);
+      ++cache->lookup_count;
+      return cache->entries.count(Key(digest)) > 0;
+    };
+    cache.insert = +[](void* self,
+                       const iree_vm_bytecode_content_digest_t* digest) {
+      auto* cache = reinterpret_cast<TestVerificationCache*>(self);
+      ++cache->insert_count;
+      cache->entries.insert(Key(digest));
+    };
+    return cache;
+  }
+};
+
+class VMBytecodeModuleLazyVerificationTest : public VMBytecodeModuleTest {
+ protected:
+  iree_vm_bytecode_module_options_t GetModuleOptions() override {
+    iree_vm_bytecode_module_options_t options;
+    iree_vm_bytecode_module_options_initialize(&options);
+    options.flags |= IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION;
+    options.verification_cache = cache_.Get();
+    return options;
+  }
+
+  TestVerificationCache cache_;
+};
+
+// Tests that functions run when verified on first call and that the cache is
+// only populated once every function in the module has been verified.
+TEST_F(VMBytecodeModuleLazyVerificationTest, VerifiesOnFirstCall) {
+  EXPECT_EQ(cache_.lookup_count, 1);
+  EXPECT_EQ(cache_.insert_count, 0);
+
+  EXPECT_THAT(RunFunction("FuncIOEmpty", std::vector<iree_vm_value_t>()),
+              IsOkAndHolds(Eq(std::vector<iree_vm_value_t>())));
+  EXPECT_THAT(RunFunction("FuncIO1", MakeValuesList({1})),
+              IsOkAndHolds(Eq(MakeValuesList({1}))));
+  EXPECT_THAT(RunFunction("FuncIO8", MakeValueRangeList(0, 7)),
+              IsOkAndHolds(Eq(MakeValueRangeList(7, 0))));
+  EXPECT_EQ(cache_.insert_count, 0);
+
+  EXPECT_THAT(RunFunction("FuncIO600", MakeNullRefList(600)),
+              IsOkAndHolds(Eq(MakeNullRefList(600))));
+  EXPECT_EQ(cache_.insert_count, 1);
+
+  // Calling again must not verify or record again.
+  EXPECT_THAT(RunFunction("FuncIO1", MakeValuesList({2})),
+              IsOkAndHolds(Eq(MakeValuesList({2}))));
+  EXPECT_EQ(cache_.insert_count, 1);
+}
+
+// Tests that eager verification records the contents in the cache and that
+// later loads of the same contents hit it.
+TEST_F(VMBytecodeModuleLazyVerificationTest, CacheSkipsVerification) {
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  options.verification_cache = cache_.Get();
+
+  iree_vm_module_t* eager_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create_with_options(
+      instance_, &options, GetModuleContents(), iree_allocator_null(),
+      iree_allocator_system(), &eager_module));
+  EXPECT_EQ(cache_.lookup_count, 2);
+  EXPECT_EQ(cache_.insert_count, 1);
+  iree_vm_module_release(eager_module);
+
+  iree_vm_module_t* cached_module = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create_with_options(
+      instance_, &options, GetModuleContents(), iree_allocator_null(),
+      iree_allocator_system(), &cached_module));
+  EXPECT_EQ(cache_.lookup_count, 3);
+  EXPECT_EQ(cache_.insert_count, 1);
+  iree_vm_module_release(cached_module);
+}
+
 }  // namespace
@@ -0,0 +1,180 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests for the sampling profiler safepoints in the bytecode interpreter. The
+// profiler itself is covered by iree/vm/sampling_profiler_test.cc.
+
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode/module.h"
+#include "iree/vm/bytecode/sampling_profiler_test_module_c.h"
+
+namespace {
+
+// Profiler ticked by the sampling_test.tick import.
+static iree_vm_sampling_profiler_t* tick_profiler = NULL;
+
+typedef iree_status_t (*call_i32_i32_t)(iree_vm_stack_t* stack,
+                                        void* module_ptr, void* module_state,
+                                        int32_t arg0, int32_t* out_ret0);
+
+static iree_status_t call_shim_i32_i32(iree_vm_stack_t* stack,
+                                       iree_vm_native_function_flags_t flags,
+                                       iree_byte_span_t args_storage,
+                                       iree_byte_span_t rets_storage,
+                                       call_i32_i32_t target_fn, void* module,
+                                       void* module_state) {
+  return target_fn(stack, module, module_state,
+                   *(const int32_t*)args_storage.data,
+                   (int32_t*)rets_storage.data);
+}
+
+// vm.import private @sampling_test.tick(%value : i32) -> i32
+static iree_status_t sampling_test_tick(iree_vm_stack_t* stack, void* module,
+                                        void* module_state, int32_t value,
+                                        int32_t* out_value) {
+  iree_vm_sampling_profiler_tick(tick_profiler);
+  *out_value = value;
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t sampling_test_exports_[] = {
+    {IREE_SV("tick"), IREE_SV("0i_i"), 0, NULL},
+};
+static const iree_vm_native_function_ptr_t sampling_test_funcs_[] = {
+    {(iree_vm_native_function_shim_t)call_shim_i32_i32,
+     (iree_vm_native_function_target_t)sampling_test_tick},
+};
+static const iree_vm_native_module_descriptor_t sampling_test_descriptor_ = {
+    /*name=*/IREE_SV("sampling_test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(sampling_test_exports_),
+    /*exports=*/sampling_test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(sampling_test_funcs_),
+    /*functions=*/sampling_test_funcs_,
+};
+
+// Uses sampling_profiler_test.mlir: `call_tick` calls a native import that
+// ticks the profiler so the epoch is observed as advanced at the safepoint
+// following the call.
+class VMBytecodeSamplingProfilerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+
+    iree_vm_module_t interface;
+    IREE_CHECK_OK(iree_vm_module_initialize(&interface, NULL));
+    iree_vm_module_t* native_module = NULL;
+    IREE_CHECK_OK(iree_vm_native_module_create(
+        &interface, &sampling_test_descriptor_, instance_,
+        iree_allocator_system(), &native_module));
+
+    const auto* module_file_toc =
+        iree_vm_sampling_profiler_test_module_create();
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        instance_,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+
+    iree_vm_module_t* modules[2] = {native_module, bytecode_module_};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules), modules,
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(native_module);
+
+    iree_vm_sampling_profiler_options_t options = {0};
+    options.flags = IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK;
+    IREE_CHECK_OK(iree_vm_sampling_profiler_create(
+        options, iree_allocator_system(), &profiler_));
+    tick_profiler = profiler_;
+  }
+
+  virtual void TearDown() {
+    tick_profiler = NULL;
+    iree_vm_sampling_profiler_release(profiler_);
+    iree_vm_context_release(context_);
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Runs call_tick(|value|) and returns the result.
+  iree::StatusOr<int32_t> RunCallTick(int32_t value) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        IREE_SV("call_tick"), &function));
+    iree::vm::ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &inputs));
+    iree_vm_value_t value_arg = iree_vm_value_make_i32(value);
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_value(inputs.get(), &value_arg));
+    iree::vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &outputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context_, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        inputs.get(), outputs.get(), iree_allocator_system()));
+    iree_vm_value_t result;
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_value(outputs.get(), 0, &result));
+    return result.i32;
+  }
+
+  std::string AppendCollapsed() {
+    iree_string_builder_t builder;
+    iree_string_builder_initialize(iree_allocator_system(), &builder);
+    IREE_CHECK_OK(
+        iree_vm_sampling_profiler_append_collapsed(profiler_, &builder));
+    std::string result(iree_string_builder_buffer(&builder),
+                       iree_string_builder_size(&builder));
+    iree_string_builder_deinitialize(&builder);
+    return result;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_sampling_profiler_t* profiler_ = nullptr;
+};
+
+// Tests that time spent in an import is attributed to the import as called
+// from the bytecode function.
+TEST_F(VMBytecodeSamplingProfilerTest, SampleAtImportCall) {
+  IREE_ASSERT_OK(iree_vm_sampling_profiler_start(profiler_));
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunCallTick(1));
+  EXPECT_EQ(v0, 1);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, RunCallTick(2));
+  EXPECT_EQ(v1, 2);
+  iree_vm_sampling_profiler_stop(profiler_);
+
+  // Invocations without an active profiler are not sampled.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v2, RunCallTick(3));
+  EXPECT_EQ(v2, 3);
+
+  // The bytecode frame name depends on the debug information in the module so
+  // only the module and the import leaf are checked.
+  EXPECT_EQ(iree_vm_sampling_profiler_sample_count(profiler_), 2);
+  std::string collapsed = AppendCollapsed();
+  EXPECT_THAT(collapsed, ::testing::StartsWith("sampling_profiler_test"));
+  EXPECT_THAT(collapsed, ::testing::EndsWith(";sampling_test.tick 2\n"));
+  EXPECT_EQ(collapsed.find('\n'), collapsed.size() - 1);
+}
+
+}  // namespace
@@ -0,0 +1,12 @@
+vm.module @sampling_profiler_test {
+  // Native import that advances the sample epoch of the active profiler.
+  vm.import private @sampling_test.tick(%value : i32) -> i32
+
+  // Calls the tick import such that the sample epoch has advanced when the
+  // interpreter reaches the safepoint following the call.
+  vm.export @call_tick
+  vm.func @call_tick(%value: i32) -> i32 {
+    %result = vm.call @sampling_test.tick(%value) : (i32) -> i32
+    vm.return %result : i32
+  }
+}
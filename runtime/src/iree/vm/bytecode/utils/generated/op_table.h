@@ -140,14 +140,14 @@ typedef enum {
   IREE_VM_OP_CORE_CastAnyRef = 0x82,
   IREE_VM_OP_CORE_BranchTable = 0x83,
   IREE_VM_OP_CORE_BufferHash = 0x84,
-  IREE_VM_OP_CORE_RSV_0x85,
-  IREE_VM_OP_CORE_RSV_0x86,
-  IREE_VM_OP_CORE_RSV_0x87,
-  IREE_VM_OP_CORE_RSV_0x88,
-  IREE_VM_OP_CORE_RSV_0x89,
-  IREE_VM_OP_CORE_RSV_0x8A,
-  IREE_VM_OP_CORE_RSV_0x8B,
-  IREE_VM_OP_CORE_RSV_0x8C,
+  IREE_VM_OP_CORE_CmpBrEQI32 = 0x85,
+  IREE_VM_OP_CORE_CmpBrNEI32 = 0x86,
+  IREE_VM_OP_CORE_CmpBrLTI32S = 0x87,
+  IREE_VM_OP_CORE_CmpBrLTI32U = 0x88,
+  IREE_VM_OP_CORE_CmpBrEQI64 = 0x89,
+  IREE_VM_OP_CORE_CmpBrNEI64 = 0x8A,
+  IREE_VM_OP_CORE_CmpBrLTI64S = 0x8B,
+  IREE_VM_OP_CORE_CmpBrLTI64U = 0x8C,
   IREE_VM_OP_CORE_RSV_0x8D,
   IREE_VM_OP_CORE_RSV_0x8E,
   IREE_VM_OP_CORE_RSV_0x8F,
@@ -399,14 +399,14 @@ typedef enum {
     OPC(0x82, CastAnyRef) \
     OPC(0x83, BranchTable) \
     OPC(0x84, BufferHash) \
-    RSV(0x85) \
-    RSV(0x86) \
-    RSV(0x87) \
-    RSV(0x88) \
-    RSV(0x89) \
-    RSV(0x8A) \
-    RSV(0x8B) \
-    RSV(0x8C) \
+    OPC(0x85, CmpBrEQI32) \
+    OPC(0x86, CmpBrNEI32) \
+    OPC(0x87, CmpBrLTI32S) \
+    OPC(0x88, CmpBrLTI32U) \
+    OPC(0x89, CmpBrEQI64) \
+    OPC(0x8A, CmpBrNEI64) \
+    OPC(0x8B, CmpBrLTI64S) \
+    OPC(0x8C, CmpBrLTI64U) \
     RSV(0x8D) \
     RSV(0x8E) \
     RSV(0x8F) \
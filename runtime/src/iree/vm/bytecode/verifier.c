@@ -1581,6 +1581,40 @@ static iree_status_t iree_vm_bytecode_function_verify_bytecode_op(
       verify_state->in_block = 0;  // terminator
     });
 
+    //===------------------------------------------------------------------===//
+    // Fused superinstructions (EXT_FUSED)
+    //===------------------------------------------------------------------===//
+
+#if IREE_VM_EXT_FUSED_ENABLE
+#define VERIFY_OP_CORE_CMP_BR(op_name, verify_operand_fn)      \
+  VERIFY_OP(CORE, op_name, {                                   \
+    IREE_VM_VERIFY_REQUIREMENT(iree_vm_FeatureBits_EXT_FUSED); \
+    verify_operand_fn(lhs);                                    \
+    verify_operand_fn(rhs);                                    \
+    VM_VerifyBranchTarget(true_dest_pc);                       \
+    VM_VerifyBranchOperands(true_operands);                    \
+    VM_VerifyBranchTarget(false_dest_pc);                      \
+    VM_VerifyBranchOperands(false_operands);                   \
+    verify_state->in_block = 0; /* terminator */               \
+  });
+#else
+#define VERIFY_OP_CORE_CMP_BR(op_name, verify_operand_fn)                     \
+  case IREE_VM_OP_CORE_##op_name: {                                           \
+    return iree_vm_check_feature_mismatch(__FILE__, __LINE__,                 \
+                                          iree_vm_FeatureBits_EXT_FUSED,      \
+                                          function_descriptor->requirements); \
+  }
+#endif  // IREE_VM_EXT_FUSED_ENABLE
+
+    VERIFY_OP_CORE_CMP_BR(CmpBrEQI32, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_CMP_BR(CmpBrNEI32, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_CMP_BR(CmpBrLTI32S, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_CMP_BR(CmpBrLTI32U, VM_VerifyOperandRegI32);
+    VERIFY_OP_CORE_CMP_BR(CmpBrEQI64, VM_VerifyOperandRegI64);
+    VERIFY_OP_CORE_CMP_BR(CmpBrNEI64, VM_VerifyOperandRegI64);
+    VERIFY_OP_CORE_CMP_BR(CmpBrLTI64S, VM_VerifyOperandRegI64);
+    VERIFY_OP_CORE_CMP_BR(CmpBrLTI64U, VM_VerifyOperandRegI64);
+
     VERIFY_OP(CORE, Call, {
       VM_VerifyFuncAttr(callee_ordinal);
       VM_VerifyVariadicOperandsAny(operands);
@@ -420,6 +420,54 @@ IREE_API_EXPORT iree_status_t iree_vm_context_fork(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_reset(
+    iree_vm_context_t* child_context, const iree_vm_context_t* parent_context) {
+  IREE_ASSERT_ARGUMENT(child_context);
+  IREE_ASSERT_ARGUMENT(parent_context);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The module lists must match exactly as they would after a fork.
+  bool is_forked = child_context->list.count == parent_context->list.count;
+  for (iree_host_size_t i = 0; is_forked && i < child_context->list.count;
+       ++i) {
+    is_forked =
+        child_context->list.modules[i] == parent_context->list.modules[i];
+  }
+  if (IREE_UNLIKELY(!is_forked)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "child context was not forked from the parent "
+                            "context; module lists differ");
+  }
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < child_context->list.count; ++i) {
+    iree_vm_module_t* module = child_context->list.modules[i];
+    iree_vm_module_state_t* parent_state =
+        parent_context->list.module_states[i];
+    iree_vm_module_state_t** child_state =
+        &child_context->list.module_states[i];
+    if (module->reset_state) {
+      status = module->reset_state(module->self, parent_state, *child_state);
+    } else if (parent_state || *child_state) {
+      // Modules without reset support get a fresh fork of the parent state.
+      if (*child_state) module->free_state(module->self, *child_state);
+      *child_state = NULL;
+      status = module->fork_state(module->self, parent_state,
+                                  child_context->allocator, child_state);
+    }
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  // Notify all modules as with a fork. They may reinitialize state.
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_context_notify(child_context, IREE_VM_SIGNAL_FORK);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_vm_context_destroy(iree_vm_context_t* context) {
   if (!context) return;
 
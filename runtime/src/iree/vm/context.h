@@ -77,6 +77,18 @@ IREE_API_EXPORT iree_status_t iree_vm_context_fork(
     const iree_vm_context_t* parent_context, iree_allocator_t allocator,
     iree_vm_context_t** out_child_context);
 
+// Resets |child_context|, which must have been forked from |parent_context|,
+// back to the state it had immediately after the fork. Modules implementing
+// reset_state restore only the state that has diverged from the parent while
+// all others have their state forked again. The fork signal is sent to all
+// modules once their state has been reset.
+//
+// No invocations may be in-flight on |child_context| and |parent_context| must
+// not be executing while the reset is performed. If the reset fails the child
+// context is left in an undefined state and must be released.
+IREE_API_EXPORT iree_status_t iree_vm_context_reset(
+    iree_vm_context_t* child_context, const iree_vm_context_t* parent_context);
+
 // Retains the given |context| for the caller.
 IREE_API_EXPORT void iree_vm_context_retain(iree_vm_context_t* context);
 
@@ -0,0 +1,169 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/context_pool.h"
+
+#include <stddef.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+
+struct iree_vm_context_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+
+  // Context all pooled contexts are forked from and reset to.
+  iree_vm_context_t* parent_context;
+
+  // Guards the idle context stack. Contexts are forked and reset outside of
+  // the lock.
+  iree_slim_mutex_t mutex;
+
+  // Stack of idle contexts ready for reuse. The most recently recycled context
+  // is reused first as its state is most likely to still be in cache.
+  iree_host_size_t idle_capacity;
+  iree_host_size_t idle_count IREE_GUARDED_BY(mutex);
+  iree_vm_context_t* idle_contexts[];
+};
+
+static void iree_vm_context_pool_destroy(iree_vm_context_pool_t* pool);
+
+IREE_API_EXPORT iree_status_t iree_vm_context_pool_create(
+    iree_vm_context_t* parent_context, iree_vm_context_pool_options_t options,
+    iree_allocator_t host_allocator, iree_vm_context_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(parent_context);
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)options.warm_count);
+
+  const iree_host_size_t idle_capacity =
+      iree_max(options.warm_count, options.max_idle_count);
+  iree_vm_context_pool_t* pool = NULL;
+  iree_host_size_t total_size =
+      sizeof(*pool) + idle_capacity * sizeof(pool->idle_contexts[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->parent_context = parent_context;
+  iree_vm_context_retain(parent_context);
+  iree_slim_mutex_initialize(&pool->mutex);
+  pool->idle_capacity = idle_capacity;
+  pool->idle_count = 0;
+
+  // Fork the warm contexts up-front. No other thread can observe the pool yet.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < options.warm_count; ++i) {
+    status = iree_vm_context_fork(parent_context, host_allocator,
+                                  &pool->idle_contexts[i]);
+    if (!iree_status_is_ok(status)) break;
+    ++pool->idle_count;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_vm_context_pool_release(pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_vm_context_pool_destroy(iree_vm_context_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < pool->idle_count; ++i) {
+    iree_vm_context_release(pool->idle_contexts[i]);
+  }
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_vm_context_release(pool->parent_context);
+  iree_allocator_free(pool->host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_context_pool_retain(iree_vm_context_pool_t* pool) {
+  if (pool) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_context_pool_release(
+    iree_vm_context_pool_t* pool) {
+  if (pool && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_vm_context_pool_destroy(pool);
+  }
+}
+
+IREE_API_EXPORT iree_vm_context_t* iree_vm_context_pool_parent(
+    const iree_vm_context_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  return pool->parent_context;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_context_pool_acquire(
+    iree_vm_context_pool_t* pool, iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+
+  iree_vm_context_t* context = NULL;
+  iree_slim_mutex_lock(&pool->mutex);
+  if (pool->idle_count > 0) {
+    context = pool->idle_contexts[--pool->idle_count];
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (context) {
+    *out_context = context;
+    return iree_ok_status();
+  }
+
+  // Pool exhausted; fork a new context that will be pooled when recycled.
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_vm_context_pool_acquire_fork");
+  iree_status_t status = iree_vm_context_fork(
+      pool->parent_context, pool->host_allocator, out_context);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Pushes |context| onto the idle stack and returns true if there was capacity.
+static bool iree_vm_context_pool_try_push(iree_vm_context_pool_t* pool,
+                                          iree_vm_context_t* context) {
+  bool pushed = false;
+  iree_slim_mutex_lock(&pool->mutex);
+  if (pool->idle_count < pool->idle_capacity) {
+    pool->idle_contexts[pool->idle_count++] = context;
+    pushed = true;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  return pushed;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_context_pool_recycle(
+    iree_vm_context_pool_t* pool, iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(pool);
+  if (!context) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Avoid resetting contexts that will be dropped anyway. The pool may still
+  // fill up while resetting in which case the context is dropped afterward.
+  iree_slim_mutex_lock(&pool->mutex);
+  const bool has_capacity = pool->idle_count < pool->idle_capacity;
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (!has_capacity) {
+    iree_vm_context_release(context);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_status_t status = iree_vm_context_reset(context, pool->parent_context);
+  if (!iree_status_is_ok(status) ||
+      !iree_vm_context_pool_try_push(pool, context)) {
+    iree_vm_context_release(context);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,88 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_CONTEXT_POOL_H_
+#define IREE_VM_CONTEXT_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_vm_context_pool_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_vm_context_pool_options_t {
+  // Number of contexts forked when the pool is created so that the first
+  // acquisitions do not need to fork.
+  iree_host_size_t warm_count;
+  // Maximum number of idle contexts retained by the pool. Contexts recycled
+  // while the pool is full are released instead. If less than |warm_count|
+  // then |warm_count| is used.
+  iree_host_size_t max_idle_count;
+} iree_vm_context_pool_options_t;
+
+// A pool of contexts forked from a common parent context.
+//
+// Serving isolated requests from a single loaded program requires a context
+// per request so that globals mutated by one request are not observed by
+// another. Forking a context per request avoids repeating module loading and
+// initialization but still allocates and populates all module state. The pool
+// instead keeps forked contexts warm and when a context is recycled resets it
+// back to the state of the parent with iree_vm_context_reset. Modules that
+// support resetting only restore the state that diverged (such as mutated
+// globals) while all immutable module data remains shared with the parent.
+//
+// The parent context is retained by the pool and must not be executed or
+// modified while the pool exists as it is read whenever a context is forked or
+// reset.
+//
+// Thread-safe.
+typedef struct iree_vm_context_pool_t iree_vm_context_pool_t;
+
+// Creates a pool of contexts forked from |parent_context| and forks
+// |options.warm_count| contexts before returning.
+// |out_pool| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_context_pool_create(
+    iree_vm_context_t* parent_context, iree_vm_context_pool_options_t options,
+    iree_allocator_t host_allocator, iree_vm_context_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+IREE_API_EXPORT void iree_vm_context_pool_retain(iree_vm_context_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+// Any contexts acquired from the pool remain valid until released.
+IREE_API_EXPORT void iree_vm_context_pool_release(iree_vm_context_pool_t* pool);
+
+// Returns the parent context all pooled contexts are forked from.
+IREE_API_EXPORT iree_vm_context_t* iree_vm_context_pool_parent(
+    const iree_vm_context_pool_t* pool);
+
+// Acquires a context in the state of the parent context from the |pool|.
+// An idle context is reused if available and otherwise a new one is forked.
+// The returned context should be passed back to iree_vm_context_pool_recycle
+// when no longer needed but may also be released directly.
+IREE_API_EXPORT iree_status_t iree_vm_context_pool_acquire(
+    iree_vm_context_pool_t* pool, iree_vm_context_t** out_context);
+
+// Returns a |context| previously acquired from |pool|, taking ownership of the
+// caller's reference. The context is reset to the state of the parent context
+// and kept for reuse if the pool has capacity. The caller must not hold any
+// other references to the context and must have no in-flight invocations.
+//
+// If the reset fails the context is released and the error is returned; the
+// pool remains usable.
+IREE_API_EXPORT iree_status_t iree_vm_context_pool_recycle(
+    iree_vm_context_pool_t* pool, iree_vm_context_t* context);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_CONTEXT_POOL_H_
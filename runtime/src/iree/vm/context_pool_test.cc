@@ -0,0 +1,180 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/context_pool.h"
+
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/invocation.h"
+#include "iree/vm/list.h"
+#include "iree/vm/native_module_test.h"
+#include "iree/vm/ref.h"
+#include "iree/vm/value.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Uses module_a and module_b defined in native_module_test.h. module_b.entry
+// accumulates into a per-context counter so that each call observes the state
+// left by prior calls in the same context.
+class VMContextPoolTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+  }
+
+  virtual void TearDown() { iree_vm_instance_release(instance_); }
+
+  iree_vm_context_t* CreateContext() {
+    iree_vm_module_t* module_a = nullptr;
+    IREE_CHECK_OK(
+        module_a_create(instance_, iree_allocator_system(), &module_a));
+    iree_vm_module_t* module_b = nullptr;
+    IREE_CHECK_OK(
+        module_b_create(instance_, iree_allocator_system(), &module_b));
+    iree_vm_context_t* context = NULL;
+    std::vector<iree_vm_module_t*> modules = {module_a, module_b};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context));
+    iree_vm_module_release(module_a);
+    iree_vm_module_release(module_b);
+    return context;
+  }
+
+  // Runs module_b.entry(|arg0|) in |context| and returns the result.
+  StatusOr<int32_t> RunEntry(iree_vm_context_t* context, int32_t arg0) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context, iree_make_cstring_view("module_b.entry"), &function));
+    vm::ref<iree_vm_list_t> input_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &input_list));
+    auto arg0_value = iree_vm_value_make_i32(arg0);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_value(input_list.get(), &arg0_value));
+    vm::ref<iree_vm_list_t> output_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &output_list));
+    IREE_RETURN_IF_ERROR(
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                       /*policy=*/nullptr, input_list.get(), output_list.get(),
+                       iree_allocator_system()));
+    iree_vm_value_t ret0_value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value(output_list.get(), 0, &ret0_value));
+    return ret0_value.i32;
+  }
+
+ private:
+  iree_vm_instance_t* instance_ = nullptr;
+};
+
+// Tests that recycled contexts are reset to the parent state.
+TEST_F(VMContextPoolTest, RecycleResetsState) {
+  iree_vm_context_t* parent_context = CreateContext();
+
+  // Mutate the parent state before creating the pool; counter=2.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t parent_v0, RunEntry(parent_context, 1));
+  ASSERT_EQ(parent_v0, 1);
+
+  iree_vm_context_pool_options_t options = {0};
+  options.warm_count = 1;
+  iree_vm_context_pool_t* pool = NULL;
+  IREE_ASSERT_OK(iree_vm_context_pool_create(
+      parent_context, options, iree_allocator_system(), &pool));
+  EXPECT_EQ(iree_vm_context_pool_parent(pool), parent_context);
+
+  // counter=2+3 in the pooled context.
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_pool_acquire(pool, &context));
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunEntry(context, 2));
+  EXPECT_EQ(v0, 4);
+  iree_vm_context_t* first_context = context;
+  IREE_ASSERT_OK(iree_vm_context_pool_recycle(pool, context));
+
+  // The same warm context is reused and starts again from counter=2.
+  IREE_ASSERT_OK(iree_vm_context_pool_acquire(pool, &context));
+  EXPECT_EQ(context, first_context);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, RunEntry(context, 2));
+  EXPECT_EQ(v1, 4);
+  IREE_ASSERT_OK(iree_vm_context_pool_recycle(pool, context));
+
+  iree_vm_context_pool_release(pool);
+
+  // The parent state is unaffected by the pooled contexts; counter=2+3.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t parent_v1, RunEntry(parent_context, 2));
+  EXPECT_EQ(parent_v1, 4);
+  iree_vm_context_release(parent_context);
+}
+
+// Tests acquiring more contexts than are kept warm.
+TEST_F(VMContextPoolTest, AcquireBeyondCapacity) {
+  iree_vm_context_t* parent_context = CreateContext();
+
+  iree_vm_context_pool_options_t options = {0};
+  options.warm_count = 1;
+  options.max_idle_count = 2;
+  iree_vm_context_pool_t* pool = NULL;
+  IREE_ASSERT_OK(iree_vm_context_pool_create(
+      parent_context, options, iree_allocator_system(), &pool));
+
+  // Each context is isolated from the others; counter=0+2.
+  std::vector<iree_vm_context_t*> contexts(4);
+  for (auto& context : contexts) {
+    IREE_ASSERT_OK(iree_vm_context_pool_acquire(pool, &context));
+    IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunEntry(context, 1));
+    EXPECT_EQ(v0, 1);
+  }
+
+  // Contexts beyond max_idle_count are released.
+  for (auto* context : contexts) {
+    IREE_ASSERT_OK(iree_vm_context_pool_recycle(pool, context));
+  }
+
+  // Pool can be released while contexts are outstanding.
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_pool_acquire(pool, &context));
+  iree_vm_context_pool_release(pool);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, RunEntry(context, 1));
+  EXPECT_EQ(v1, 1);
+  iree_vm_context_release(context);
+
+  iree_vm_context_release(parent_context);
+}
+
+// Tests that contexts can only be reset to the context they were forked from.
+TEST_F(VMContextPoolTest, ResetRequiresMatchingParent) {
+  iree_vm_context_t* parent_context = CreateContext();
+  iree_vm_context_t* child_context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_fork(parent_context, iree_allocator_system(),
+                                      &child_context));
+
+  iree_vm_context_t* empty_context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_create(
+      iree_vm_context_instance(parent_context), IREE_VM_CONTEXT_FLAG_NONE,
+      iree_allocator_system(), &empty_context));
+  EXPECT_THAT(Status(iree_vm_context_reset(child_context, empty_context)),
+              StatusIs(StatusCode::kInvalidArgument));
+  IREE_EXPECT_OK(iree_vm_context_reset(child_context, parent_context));
+
+  iree_vm_context_release(empty_context);
+  iree_vm_context_release(child_context);
+  iree_vm_context_release(parent_context);
+}
+
+}  // namespace
+}  // namespace iree
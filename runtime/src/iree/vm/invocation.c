@@ -12,6 +12,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
 #include "iree/vm/value.h"
@@ -741,6 +742,7 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
   state->begin_params.inputs = inputs;
   iree_vm_list_retain(inputs);
   state->deadline_ns = IREE_TIME_INFINITE_FUTURE;
+  iree_atomic_store(&state->cancelled, 0, iree_memory_order_relaxed);
   state->host_allocator = host_allocator;
   state->outputs = outputs;
   iree_vm_list_retain(outputs);
@@ -777,7 +779,14 @@ static iree_status_t iree_vm_async_begin_invoke(void* user_data,
   iree_vm_async_invoke_state_t* state =
       (iree_vm_async_invoke_state_t*)user_data;
 
-  // Check to see if the loop has failed before we even begin.
+  // Check to see if the loop has failed or the invocation was cancelled before
+  // we even begin.
+  if (IREE_UNLIKELY(iree_status_is_ok(loop_status) &&
+                    iree_atomic_load(&state->cancelled,
+                                     iree_memory_order_acquire))) {
+    loop_status = iree_make_status(IREE_STATUS_CANCELLED,
+                                   "invocation cancelled before it began");
+  }
   if (IREE_UNLIKELY(!iree_status_is_ok(loop_status))) {
     // We release our retained resources because we don't guarantee they live to
     // the callback. This allows callbacks to reuse memory.
@@ -907,6 +916,15 @@ static iree_status_t iree_vm_async_wake_invoke(void* user_data,
     return iree_vm_async_complete_invoke(state, loop, loop_status);
   }
 
+  // Cancellation overrides whatever the wait produced so that the program
+  // unwinds instead of continuing.
+  if (IREE_UNLIKELY(
+          iree_atomic_load(&state->cancelled, iree_memory_order_acquire))) {
+    iree_status_ignore(loop_status);
+    loop_status =
+        iree_make_status(IREE_STATUS_CANCELLED, "invocation cancelled");
+  }
+
   // The loop_status we receive here is the result of the wait operation and
   // something we need to propagate to the waiter.
   iree_vm_stack_frame_t* current_frame =
@@ -941,6 +959,14 @@ static iree_status_t iree_vm_async_tick_invoke(
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "unbalanced stack after yield");
   } else if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+    // Cancelled invocations don't wait and instead wake immediately to fail
+    // the wait.
+    if (IREE_UNLIKELY(
+            iree_atomic_load(&state->cancelled, iree_memory_order_acquire))) {
+      return iree_loop_call(loop, IREE_LOOP_PRIORITY_DEFAULT,
+                            iree_vm_async_wake_invoke, state);
+    }
+
     // Wait on a wait source.
     iree_vm_wait_frame_t* wait_frame =
         (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame);
@@ -999,3 +1025,176 @@ static iree_status_t iree_vm_async_complete_invoke(
   iree_vm_list_t* outputs = state->outputs;
   return state->callback(state->user_data, loop, status, outputs);
 }
+
+IREE_API_EXPORT void iree_vm_async_invoke_cancel(
+    iree_vm_async_invoke_state_t* state) {
+  IREE_ASSERT_ARGUMENT(state);
+  iree_atomic_store(&state->cancelled, 1, iree_memory_order_release);
+}
+
+//===----------------------------------------------------------------------===//
+// Asynchronous stateful invocation
+//===----------------------------------------------------------------------===//
+
+struct iree_vm_invocation_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+
+  // Posted when the invocation completes.
+  iree_notification_t completion_notification;
+  // Set (with release semantics) once the invocation has completed. |status|
+  // and |outputs| are immutable after it is set.
+  iree_atomic_int32_t completed;
+  // Result of the invocation once completed.
+  iree_status_t status;
+  // Output list populated by the invocation. Only valid if |status| is OK.
+  iree_vm_list_t* outputs;
+
+  // Storage for the in-flight invocation. Must be last as it contains the
+  // inlined VM stack storage.
+  iree_vm_async_invoke_state_t async_state;
+};
+
+static void iree_vm_invocation_destroy(iree_vm_invocation_t* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = invocation->host_allocator;
+  iree_status_free(invocation->status);
+  iree_vm_list_release(invocation->outputs);
+  iree_notification_deinitialize(&invocation->completion_notification);
+  iree_allocator_free(host_allocator, invocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Completion callback from iree_vm_async_invoke. Stores the results and wakes
+// any waiters. The reference held by the in-flight invocation is released.
+static iree_status_t iree_vm_invocation_complete(void* user_data,
+                                                 iree_loop_t loop,
+                                                 iree_status_t status,
+                                                 iree_vm_list_t* outputs) {
+  iree_vm_invocation_t* invocation = (iree_vm_invocation_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // We retain our own reference to the output list; drop the one passed in.
+  iree_vm_list_release(outputs);
+
+  invocation->status = status;  // takes ownership
+  iree_atomic_store(&invocation->completed, 1, iree_memory_order_release);
+  iree_notification_post(&invocation->completion_notification,
+                         IREE_ALL_WAITERS);
+  iree_vm_invocation_release(invocation);
+
+  IREE_TRACE_ZONE_END(z0);
+
+  // Invocation failures are reported via the invocation and must not fail the
+  // loop (and with it all other invocations sharing it).
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
+    iree_loop_t loop, iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_allocator_t host_allocator,
+    iree_vm_invocation_t** out_invocation) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_invocation);
+  *out_invocation = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*invocation),
+                                (void**)&invocation));
+  iree_atomic_ref_count_init(&invocation->ref_count);
+  invocation->host_allocator = host_allocator;
+  iree_notification_initialize(&invocation->completion_notification);
+  iree_atomic_store(&invocation->completed, 0, iree_memory_order_relaxed);
+  invocation->status = iree_ok_status();
+  invocation->outputs = NULL;
+
+  iree_status_t status = iree_vm_list_create(
+      iree_vm_make_undefined_type_def(), /*initial_capacity=*/0,
+      host_allocator, &invocation->outputs);
+
+  // The in-flight invocation holds a reference that is released upon
+  // completion. Note that the invocation may complete before the call returns.
+  if (iree_status_is_ok(status)) {
+    iree_vm_invocation_retain(invocation);
+    status = iree_vm_async_invoke(
+        loop, &invocation->async_state, context, function, flags, policy,
+        (iree_vm_list_t*)inputs, invocation->outputs, host_allocator,
+        iree_vm_invocation_complete, invocation);
+    if (!iree_status_is_ok(status)) {
+      // The callback is not issued if the invocation failed to launch.
+      iree_vm_invocation_release(invocation);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    iree_vm_invocation_release(invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation) {
+  if (IREE_LIKELY(invocation)) {
+    iree_atomic_ref_count_inc(&invocation->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation) {
+  if (IREE_LIKELY(invocation) &&
+      iree_atomic_ref_count_dec(&invocation->ref_count) == 1) {
+    iree_vm_invocation_destroy(invocation);
+  }
+}
+
+static bool iree_vm_invocation_is_completed(void* arg) {
+  iree_vm_invocation_t* invocation = (iree_vm_invocation_t*)arg;
+  return iree_atomic_load(&invocation->completed, iree_memory_order_acquire) !=
+         0;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_query_status(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_completed(invocation)) {
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  return iree_status_clone(invocation->status);
+}
+
+IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_completed(invocation) ||
+      !iree_status_is_ok(invocation->status)) {
+    return NULL;
+  }
+  return invocation->outputs;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_await(
+    iree_vm_invocation_t* invocation, iree_time_t deadline_ns) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (!iree_notification_await(&invocation->completion_notification,
+                               iree_vm_invocation_is_completed, invocation,
+                               iree_make_deadline(deadline_ns))) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_vm_invocation_query_status(invocation);
+}
+
+IREE_API_EXPORT void iree_vm_invocation_cancel(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (iree_vm_invocation_is_completed(invocation)) return;
+  iree_vm_async_invoke_cancel(&invocation->async_state);
+}
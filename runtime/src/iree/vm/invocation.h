@@ -228,6 +228,9 @@ typedef struct iree_vm_async_invoke_state_t {
   iree_vm_invocation_id_t invocation_id;
   // TBD: deadline for when the invocation will be aborted.
   iree_time_t deadline_ns;
+  // Nonzero when cancellation has been requested with
+  // iree_vm_async_invoke_cancel.
+  iree_atomic_int32_t cancelled;
   // Allocator used for transient allocations required during invocation.
   // If an arena it must remain valid for the duration of the invocation.
   iree_allocator_t host_allocator;
@@ -290,24 +293,54 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
     iree_allocator_t host_allocator,
     iree_vm_async_invoke_callback_fn_t callback, void* user_data);
 
+// Requests cooperative cancellation of an in-flight asynchronous invocation.
+// May be called from any thread so long as |state| remains live.
+//
+// If the invocation has not yet begun it will not begin and the callback will
+// receive IREE_STATUS_CANCELLED. Otherwise cancellation is observed at wait
+// frames: any wait the invocation is blocked on completes with
+// IREE_STATUS_CANCELLED once it wakes and all subsequent waits fail
+// immediately with IREE_STATUS_CANCELLED. Programs see the failed waits as
+// they would any other wait failure and are expected to unwind. Invocations
+// that never wait run to completion.
+IREE_API_EXPORT void iree_vm_async_invoke_cancel(
+    iree_vm_async_invoke_state_t* state);
+
 //===----------------------------------------------------------------------===//
 // Asynchronous stateful invocation
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): document and implement.
+// Asynchronously invokes |function| in |context| on the given |loop| and
+// returns a reference-counted invocation object used to query, await, or
+// cancel it. This is a convenience wrapper around iree_vm_async_invoke that
+// manages the state storage and output list so that callers can issue
+// fire-and-forget invocations without building their own state machines.
+//
+// The invocation makes progress only as |loop| is run: with an inline loop the
+// invocation completes before this returns while with a loop serviced by
+// another thread it completes asynchronously. Invocation failures do not
+// propagate to the loop and are only reported via the invocation.
+//
+// |inputs| will be retained until no longer needed by the invocation and must
+// not be modified until the invocation completes.
+//
+// Multiple invocations to the same context are only allowed to overlap if the
+// context was created with the IREE_VM_CONTEXT_FLAG_CONCURRENT flag set.
 IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
-    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_loop_t loop, iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    const iree_vm_list_t* inputs, iree_allocator_t allocator,
+    const iree_vm_list_t* inputs, iree_allocator_t host_allocator,
     iree_vm_invocation_t** out_invocation);
 
 // Retains the given |invocation| for the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_retain(iree_vm_invocation_t* invocation);
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation);
 
 // Releases the given |invocation| from the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_release(iree_vm_invocation_t* invocation);
+// In-flight invocations continue running until they complete and keep the
+// resources they use live until then.
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation);
 
 // Queries the completion status of the invocation.
 // Returns one of the following:
@@ -328,15 +361,20 @@ iree_vm_invocation_query_status(iree_vm_invocation_t* invocation);
 IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
     iree_vm_invocation_t* invocation);
 
-// Blocks the caller until the invocation completes (successfully or otherwise).
+// Blocks the caller until the invocation completes (successfully or otherwise)
+// or |deadline_ns| elapses. The loop the invocation was created on must be
+// serviced by another thread (or be inline) as this does not run the loop.
 //
-// Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses before the
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline_ns| elapses before the
 // invocation completes and otherwise returns iree_vm_invocation_query_status.
 IREE_API_EXPORT iree_status_t iree_vm_invocation_await(
-    iree_vm_invocation_t* invocation, iree_time_t deadline);
+    iree_vm_invocation_t* invocation, iree_time_t deadline_ns);
 
 // Attempts to cancel the invocation if it is in-flight.
-// Cancellation is not guaranteed to work and should be considered a hint.
+// Cancellation is not guaranteed to work and should be considered a hint; see
+// iree_vm_async_invoke_cancel for when it is observed. Cancelled invocations
+// complete with IREE_STATUS_CANCELLED (or whatever status the program produces
+// as it unwinds from the cancelled wait).
 // A no-op if the invocation has already completed.
 IREE_API_EXPORT void iree_vm_invocation_cancel(
     iree_vm_invocation_t* invocation);
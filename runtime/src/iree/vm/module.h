@@ -479,6 +479,16 @@ typedef struct iree_vm_module_t {
   // without first completing prior ones.
   iree_status_t(IREE_API_PTR* resume_call)(void* self, iree_vm_stack_t* stack,
                                            iree_byte_span_t call_results);
+
+  // Optional. Resets |module_state|, which was previously forked from
+  // |parent_state| with fork_state, back to the contents of |parent_state|
+  // such that it is indistinguishable from a freshly forked state. Only the
+  // contents that have diverged from the parent need to be restored. After all
+  // module state is reset the fork signal will be sent to all modules. When
+  // not provided the state will be freed and forked again from the parent.
+  iree_status_t(IREE_API_PTR* reset_state)(
+      void* self, iree_vm_module_state_t* parent_state,
+      iree_vm_module_state_t* module_state);
 } iree_vm_module_t;
 
 // Initializes the interface of a module handle.
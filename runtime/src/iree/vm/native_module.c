@@ -328,6 +328,14 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_fork_state(
              : iree_ok_status();
 }
 
+static iree_status_t IREE_API_PTR iree_vm_native_module_reset_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_vm_module_state_t* module_state) {
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
+  return module->user_interface.reset_state(module->self, parent_state,
+                                            module_state);
+}
+
 static iree_status_t IREE_API_PTR iree_vm_native_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -350,6 +358,26 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_notify(
   return iree_ok_status();
 }
 
+// Annotates a failed |status| from the function at |function_ordinal|.
+static iree_status_t iree_vm_native_module_annotate_call_status(
+    iree_vm_native_module_t* module, uint16_t function_ordinal,
+    iree_status_t status) {
+#if IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
+  iree_string_view_t module_name IREE_ATTRIBUTE_UNUSED =
+      iree_vm_native_module_name(module);
+  iree_string_view_t function_name IREE_ATTRIBUTE_UNUSED =
+      iree_string_view_empty();
+  iree_status_ignore(iree_vm_native_module_get_export_function(
+      module, function_ordinal, NULL, &function_name, NULL));
+  return iree_status_annotate_f(status,
+                                "while invoking native function %.*s.%.*s",
+                                (int)module_name.size, module_name.data,
+                                (int)function_name.size, function_name.data);
+#else
+  return status;
+#endif  // IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
+}
+
 static iree_status_t iree_vm_native_module_issue_call(
     iree_vm_native_module_t* module, iree_vm_stack_t* stack,
     iree_vm_stack_frame_t* callee_frame, iree_vm_native_function_flags_t flags,
@@ -370,20 +398,8 @@ static iree_status_t iree_vm_native_module_issue_call(
   }
 
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
-#if IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
-    iree_string_view_t module_name IREE_ATTRIBUTE_UNUSED =
-        iree_vm_native_module_name(module);
-    iree_string_view_t function_name IREE_ATTRIBUTE_UNUSED =
-        iree_string_view_empty();
-    iree_status_ignore(iree_vm_native_module_get_export_function(
-        module, function_ordinal, NULL, &function_name, NULL));
-    return iree_status_annotate_f(status,
-                                  "while invoking native function %.*s.%.*s",
-                                  (int)module_name.size, module_name.data,
-                                  (int)function_name.size, function_name.data);
-#else
-    return status;
-#endif  // IREE_STATUS_FEATURES & IREE_STATUS_FEATURE_ANNOTATIONS
+    return iree_vm_native_module_annotate_call_status(module, function_ordinal,
+                                                      status);
   }
 
   // Call completed successfully; pop the stack and return to caller.
@@ -550,6 +566,68 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
   module->base_interface.notify = iree_vm_native_module_notify;
   module->base_interface.begin_call = iree_vm_native_module_begin_call;
   module->base_interface.resume_call = iree_vm_native_module_resume_call;
+  // Left NULL when not provided so that contexts fall back to forking again.
+  module->base_interface.reset_state = module->user_interface.reset_state
+                                           ? iree_vm_native_module_reset_state
+                                           : NULL;
 
   return iree_ok_status();
 }
+
+//===----------------------------------------------------------------------===//
+// Direct-call trampolines
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT bool iree_vm_native_module_resolve_trampoline(
+    const iree_vm_function_t* function,
+    iree_vm_native_function_trampoline_t* out_trampoline) {
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(out_trampoline);
+  memset(out_trampoline, 0, sizeof(*out_trampoline));
+
+  // Only modules routing calls through the default begin_call/resume_call can
+  // be called directly; any user override may do arbitrary work per call.
+  if (!function->module ||
+      function->module->begin_call != iree_vm_native_module_begin_call) {
+    return false;
+  }
+  iree_vm_native_module_t* module =
+      (iree_vm_native_module_t*)function->module->self;
+  if (module->user_interface.begin_call || module->user_interface.resume_call) {
+    return false;
+  }
+  if ((function->linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT &&
+       function->linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT_OPTIONAL) ||
+      function->ordinal >= module->descriptor->function_count) {
+    return false;
+  }
+
+  out_trampoline->function_ptr =
+      module->descriptor->functions[function->ordinal];
+  out_trampoline->module_self = module->self;
+  return true;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_native_function_trampoline_call(
+    const iree_vm_native_function_trampoline_t* trampoline,
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    iree_vm_module_state_t* module_state, iree_byte_span_t args_storage,
+    iree_byte_span_t rets_storage) {
+  IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter_with_state(
+      stack, function, module_state, IREE_VM_STACK_FRAME_NATIVE,
+      /*frame_size=*/0, /*frame_cleanup_fn=*/NULL, /*out_callee_frame=*/NULL));
+
+  iree_status_t status = trampoline->function_ptr.shim(
+      stack, IREE_VM_NATIVE_FUNCTION_CALL_BEGIN, args_storage, rets_storage,
+      trampoline->function_ptr.target, trampoline->module_self, module_state);
+  if (iree_status_is_deferred(status)) {
+    // Call deferred; the frame is preserved for the module resume_call.
+    return status;
+  } else if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+    return iree_vm_native_module_annotate_call_status(
+        (iree_vm_native_module_t*)function->module->self, function->ordinal,
+        status);
+  }
+
+  return iree_vm_stack_function_leave(stack);
+}
@@ -146,6 +146,43 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
     iree_vm_instance_t* instance, iree_allocator_t allocator,
     iree_vm_module_t* module);
 
+//===----------------------------------------------------------------------===//
+// Direct-call trampolines
+//===----------------------------------------------------------------------===//
+
+// A resolved native function that can be called directly without routing
+// through the module begin_call interface.
+//
+// Callers that repeatedly invoke the same function (such as bytecode modules
+// calling their imports) can resolve a trampoline once and then skip the
+// per-call interface dispatch, export table lookup, and module state query.
+// The arguments and results are still passed using the calling convention ABI
+// buffers expected by the function shim.
+typedef struct iree_vm_native_function_trampoline_t {
+  // Shim and target function of the resolved export.
+  iree_vm_native_function_ptr_t function_ptr;
+  // Module self pointer passed to the shim.
+  void* module_self;
+} iree_vm_native_function_trampoline_t;
+
+// Resolves a direct-call trampoline for |function| into |out_trampoline|.
+// Returns false and leaves |out_trampoline| zeroed if |function| is not an
+// export of a native module using the default call support (such as when the
+// module overrides begin_call) and callers must use begin_call instead.
+IREE_API_EXPORT bool iree_vm_native_module_resolve_trampoline(
+    const iree_vm_function_t* function,
+    iree_vm_native_function_trampoline_t* out_trampoline);
+
+// Calls |function| via its resolved |trampoline| using the |module_state| of
+// the function module in the context the |stack| is executing in.
+// A native stack frame is entered for the duration of the call so that
+// deferred calls can be resumed with the module resume_call interface.
+IREE_API_EXPORT iree_status_t iree_vm_native_function_trampoline_call(
+    const iree_vm_native_function_trampoline_t* trampoline,
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    iree_vm_module_state_t* module_state, iree_byte_span_t args_storage,
+    iree_byte_span_t rets_storage);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
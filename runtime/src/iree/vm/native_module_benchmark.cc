@@ -4,8 +4,16 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <atomic>
+#include <cstring>
+#include <vector>
+
 #include "iree/base/api.h"
+#include "iree/base/loop_sync.h"
+#include "iree/base/loop_threaded.h"
 #include "iree/testing/benchmark.h"
+#include "iree/vm/context_pool.h"
+#include "iree/vm/invocation.h"
 #include "iree/vm/module.h"
 #include "iree/vm/native_module.h"
 #include "iree/vm/native_module_test.h"
@@ -13,6 +21,321 @@
 
 namespace {
 
-// TODO(benvanik): native module benchmarks.
+// Number of async invocations kept in flight per benchmark iteration.
+static constexpr iree_host_size_t kInFlightInvocationCount = 10000;
+
+// Shared state for a batch of in-flight invocations of module_a.add_1.
+struct AsyncInvokeBatch {
+  iree_vm_instance_t* instance = nullptr;
+  iree_vm_context_t* context = nullptr;
+  iree_vm_function_t function;
+  iree_vm_list_t* inputs = nullptr;
+  std::vector<iree_vm_async_invoke_state_t> states;
+  std::vector<iree_vm_list_t*> outputs;
+  std::atomic<iree_host_size_t> completed_count = {0};
+};
+
+static iree_status_t AsyncInvokeBatchInitialize(AsyncInvokeBatch* batch) {
+  iree_allocator_t allocator = iree_allocator_system();
+  IREE_RETURN_IF_ERROR(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                               allocator, &batch->instance));
+  iree_vm_module_t* module_a = nullptr;
+  IREE_RETURN_IF_ERROR(module_a_create(batch->instance, allocator, &module_a));
+  iree_status_t status = iree_vm_context_create_with_modules(
+      batch->instance, IREE_VM_CONTEXT_FLAG_CONCURRENT, 1, &module_a,
+      allocator, &batch->context);
+  iree_vm_module_release(module_a);
+  IREE_RETURN_IF_ERROR(status);
+  IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+      batch->context, IREE_SV("module_a.add_1"), &batch->function));
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                           1, allocator, &batch->inputs));
+  iree_vm_value_t arg0_value = iree_vm_value_make_i32(1);
+  IREE_RETURN_IF_ERROR(iree_vm_list_push_value(batch->inputs, &arg0_value));
+  batch->states.resize(kInFlightInvocationCount);
+  batch->outputs.resize(kInFlightInvocationCount);
+  for (auto& outputs : batch->outputs) {
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        iree_vm_make_undefined_type_def(), 1, allocator, &outputs));
+  }
+  return iree_ok_status();
+}
+
+static void AsyncInvokeBatchDeinitialize(AsyncInvokeBatch* batch) {
+  for (auto* outputs : batch->outputs) iree_vm_list_release(outputs);
+  iree_vm_list_release(batch->inputs);
+  iree_vm_context_release(batch->context);
+  iree_vm_instance_release(batch->instance);
+}
+
+static iree_status_t AsyncInvokeCallback(void* user_data, iree_loop_t loop,
+                                         iree_status_t status,
+                                         iree_vm_list_t* outputs) {
+  AsyncInvokeBatch* batch = (AsyncInvokeBatch*)user_data;
+  iree_vm_list_release(outputs);  // retained by iree_vm_async_invoke
+  batch->completed_count.fetch_add(1, std::memory_order_relaxed);
+  return status;
+}
+
+// Issues all invocations of |batch| against |loop| and drains it.
+static iree_status_t AsyncInvokeBatchRun(AsyncInvokeBatch* batch,
+                                         iree_loop_t loop) {
+  batch->completed_count = 0;
+  for (iree_host_size_t i = 0; i < batch->states.size(); ++i) {
+    IREE_RETURN_IF_ERROR(iree_vm_async_invoke(
+        loop, &batch->states[i], batch->context, batch->function,
+        IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr, batch->inputs,
+        batch->outputs[i], iree_allocator_system(), AsyncInvokeCallback,
+        batch));
+  }
+  IREE_RETURN_IF_ERROR(iree_loop_drain(loop, iree_infinite_timeout()));
+  if (batch->completed_count != batch->states.size()) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "only %" PRIhsz " of %" PRIhsz
+                            " invocations completed",
+                            (iree_host_size_t)batch->completed_count,
+                            batch->states.size());
+  }
+  return iree_ok_status();
+}
+
+static void StoreScopeError(void* user_data, iree_status_t status) {
+  iree_status_t* status_ptr = (iree_status_t*)user_data;
+  if (iree_status_is_ok(*status_ptr)) {
+    *status_ptr = status;
+  } else {
+    iree_status_ignore(status);
+  }
+}
+
+// Baseline: all invocations driven from the calling thread by a loop_sync.
+IREE_BENCHMARK_FN(BM_AsyncInvoke10kSync) {
+  AsyncInvokeBatch batch;
+  IREE_RETURN_IF_ERROR(AsyncInvokeBatchInitialize(&batch));
+
+  iree_loop_sync_options_t options = {0};
+  options.max_queue_depth = kInFlightInvocationCount * 2;
+  options.max_wait_count = kInFlightInvocationCount;
+  iree_loop_sync_t* loop_sync = nullptr;
+  IREE_RETURN_IF_ERROR(
+      iree_loop_sync_allocate(options, iree_allocator_system(), &loop_sync));
+  iree_status_t scope_status = iree_ok_status();
+  iree_loop_sync_scope_t scope;
+  iree_loop_sync_scope_initialize(loop_sync, StoreScopeError, &scope_status,
+                                  &scope);
+  iree_loop_t loop = iree_loop_sync_scope(&scope);
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && iree_status_is_ok(scope_status) &&
+         iree_benchmark_keep_running(benchmark_state,
+                                     kInFlightInvocationCount)) {
+    status = AsyncInvokeBatchRun(&batch, loop);
+  }
+
+  iree_loop_sync_scope_deinitialize(&scope);
+  iree_loop_sync_free(loop_sync);
+  status = iree_status_join(status, scope_status);
+  AsyncInvokeBatchDeinitialize(&batch);
+  return status;
+}
+IREE_BENCHMARK_REGISTER(BM_AsyncInvoke10kSync);
+
+#if IREE_LOOP_THREADED_SUPPORTED
+
+// All invocations issued from the calling thread and executed by the workers
+// of a loop_threaded.
+IREE_BENCHMARK_FN(BM_AsyncInvoke10kThreaded) {
+  AsyncInvokeBatch batch;
+  IREE_RETURN_IF_ERROR(AsyncInvokeBatchInitialize(&batch));
+
+  iree_loop_threaded_options_t options = {0};
+  iree_loop_threaded_t* loop_threaded = nullptr;
+  IREE_RETURN_IF_ERROR(iree_loop_threaded_allocate(
+      options, iree_allocator_system(), &loop_threaded));
+  iree_status_t scope_status = iree_ok_status();
+  iree_loop_threaded_scope_t scope;
+  iree_loop_threaded_scope_initialize(loop_threaded, StoreScopeError,
+                                      &scope_status, &scope);
+  iree_loop_t loop = iree_loop_threaded_scope(&scope);
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && iree_status_is_ok(scope_status) &&
+         iree_benchmark_keep_running(benchmark_state,
+                                     kInFlightInvocationCount)) {
+    status = AsyncInvokeBatchRun(&batch, loop);
+  }
+
+  iree_loop_threaded_scope_deinitialize(&scope);
+  iree_loop_threaded_free(loop_threaded);
+  status = iree_status_join(status, scope_status);
+  AsyncInvokeBatchDeinitialize(&batch);
+  return status;
+}
+IREE_BENCHMARK_REGISTER(BM_AsyncInvoke10kThreaded);
+
+#endif  // IREE_LOOP_THREADED_SUPPORTED
+
+//===----------------------------------------------------------------------===//
+// Native function calls
+//===----------------------------------------------------------------------===//
+
+// Number of calls to module_a.add_1 made per benchmark iteration.
+static constexpr int kNativeCallCount = 1000;
+
+// A context with module_a and module_b (which imports module_a) registered.
+struct NativeCallContext {
+  iree_vm_instance_t* instance = nullptr;
+  iree_vm_context_t* context = nullptr;
+  iree_vm_function_t function;
+};
+
+static iree_status_t NativeCallContextInitialize(NativeCallContext* ctx) {
+  iree_allocator_t allocator = iree_allocator_system();
+  IREE_RETURN_IF_ERROR(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                               allocator, &ctx->instance));
+  iree_vm_module_t* modules[2] = {nullptr, nullptr};
+  IREE_RETURN_IF_ERROR(module_a_create(ctx->instance, allocator, &modules[0]));
+  iree_status_t status = module_b_create(ctx->instance, allocator, &modules[1]);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_context_create_with_modules(
+        ctx->instance, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules),
+        modules, allocator, &ctx->context);
+  }
+  iree_vm_module_release(modules[0]);
+  iree_vm_module_release(modules[1]);
+  IREE_RETURN_IF_ERROR(status);
+  return iree_vm_context_resolve_function(
+      ctx->context, IREE_SV("module_a.add_1"), &ctx->function);
+}
+
+static void NativeCallContextDeinitialize(NativeCallContext* ctx) {
+  iree_vm_context_release(ctx->context);
+  iree_vm_instance_release(ctx->instance);
+}
+
+// Calls module_a.add_1 through the module begin_call interface as the VM does
+// for imports that cannot use a trampoline.
+IREE_BENCHMARK_FN(BM_NativeCallBeginCall) {
+  NativeCallContext ctx;
+  IREE_RETURN_IF_ERROR(NativeCallContextInitialize(&ctx));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(ctx.context),
+                                  iree_allocator_system());
+
+  int32_t arg0 = 0;
+  int32_t ret0 = 0;
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = ctx.function;
+  call.arguments = iree_make_byte_span(&arg0, sizeof(arg0));
+  call.results = iree_make_byte_span(&ret0, sizeof(ret0));
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, kNativeCallCount)) {
+    for (int i = 0; i < kNativeCallCount && iree_status_is_ok(status); ++i) {
+      arg0 = i;
+      status = call.function.module->begin_call(call.function.module->self,
+                                                stack, call);
+    }
+  }
+  if (iree_status_is_ok(status) && ret0 != kNativeCallCount) {
+    status = iree_make_status(IREE_STATUS_INTERNAL, "unexpected result %d",
+                              ret0);
+  }
+
+  iree_vm_stack_deinitialize(stack);
+  NativeCallContextDeinitialize(&ctx);
+  return status;
+}
+IREE_BENCHMARK_REGISTER(BM_NativeCallBeginCall);
+
+// Calls module_a.add_1 through a resolved trampoline with the module state
+// cached as the bytecode module does for imports.
+IREE_BENCHMARK_FN(BM_NativeCallTrampoline) {
+  NativeCallContext ctx;
+  IREE_RETURN_IF_ERROR(NativeCallContextInitialize(&ctx));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(ctx.context),
+                                  iree_allocator_system());
+
+  iree_vm_native_function_trampoline_t trampoline;
+  iree_vm_module_state_t* module_state = nullptr;
+  iree_status_t status = iree_ok_status();
+  if (!iree_vm_native_module_resolve_trampoline(&ctx.function, &trampoline)) {
+    status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "module_a.add_1 has no trampoline");
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_stack_query_module_state(stack, ctx.function.module,
+                                              &module_state);
+  }
+
+  int32_t arg0 = 0;
+  int32_t ret0 = 0;
+  iree_byte_span_t arguments = iree_make_byte_span(&arg0, sizeof(arg0));
+  iree_byte_span_t results = iree_make_byte_span(&ret0, sizeof(ret0));
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, kNativeCallCount)) {
+    for (int i = 0; i < kNativeCallCount && iree_status_is_ok(status); ++i) {
+      arg0 = i;
+      status = iree_vm_native_function_trampoline_call(
+          &trampoline, stack, &ctx.function, module_state, arguments, results);
+    }
+  }
+  if (iree_status_is_ok(status) && ret0 != kNativeCallCount) {
+    status = iree_make_status(IREE_STATUS_INTERNAL, "unexpected result %d",
+                              ret0);
+  }
+
+  iree_vm_stack_deinitialize(stack);
+  NativeCallContextDeinitialize(&ctx);
+  return status;
+}
+IREE_BENCHMARK_REGISTER(BM_NativeCallTrampoline);
+
+//===----------------------------------------------------------------------===//
+// Context pooling
+//===----------------------------------------------------------------------===//
+
+// Forks a fresh context from the parent per request.
+IREE_BENCHMARK_FN(BM_ContextForkPerRequest) {
+  NativeCallContext ctx;
+  IREE_RETURN_IF_ERROR(NativeCallContextInitialize(&ctx));
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, 1)) {
+    iree_vm_context_t* context = nullptr;
+    status = iree_vm_context_fork(ctx.context, iree_allocator_system(),
+                                  &context);
+    iree_vm_context_release(context);
+  }
+  NativeCallContextDeinitialize(&ctx);
+  return status;
+}
+IREE_BENCHMARK_REGISTER(BM_ContextForkPerRequest);
+
+// Acquires a warm context from a pool per request and recycles it after.
+IREE_BENCHMARK_FN(BM_ContextPoolPerRequest) {
+  NativeCallContext ctx;
+  IREE_RETURN_IF_ERROR(NativeCallContextInitialize(&ctx));
+  iree_vm_context_pool_options_t options = {0};
+  options.warm_count = 1;
+  iree_vm_context_pool_t* pool = nullptr;
+  iree_status_t status = iree_vm_context_pool_create(
+      ctx.context, options, iree_allocator_system(), &pool);
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, 1)) {
+    iree_vm_context_t* context = nullptr;
+    status = iree_vm_context_pool_acquire(pool, &context);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_context_pool_recycle(pool, context);
+    }
+  }
+  iree_vm_context_pool_release(pool);
+  NativeCallContextDeinitialize(&ctx);
+  return status;
+}
+IREE_BENCHMARK_REGISTER(BM_ContextPoolPerRequest);
 
 }  // namespace
@@ -6,9 +6,13 @@
 
 #include "iree/vm/native_module_test.h"
 
+#include <thread>
 #include <vector>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/wait_handle.h"
+#include "iree/base/loop_inline.h"
+#include "iree/base/loop_sync.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 #include "iree/vm/context.h"
@@ -21,6 +25,71 @@
 namespace iree {
 namespace {
 
+using ::iree::testing::status::StatusIs;
+
+// Event the wait_test.wait export parks on.
+static iree_event_t* wait_test_event = NULL;
+
+typedef iree_status_t (*call_v_v_t)(iree_vm_stack_t* stack, void* module_ptr,
+                                    void* module_state);
+
+static iree_status_t call_shim_v_v(iree_vm_stack_t* stack,
+                                   iree_vm_native_function_flags_t flags,
+                                   iree_byte_span_t args_storage,
+                                   iree_byte_span_t rets_storage,
+                                   call_v_v_t target_fn, void* module,
+                                   void* module_state) {
+  return target_fn(stack, module, module_state);
+}
+
+// PC for wait_test_wait.
+enum wait_test_wait_pc_e {
+  WAIT_TEST_WAIT_PC_BEGIN = 0,
+  WAIT_TEST_WAIT_PC_RESUME,
+};
+
+// vm.import private @wait_test.wait()
+// Parks the invocation at a wait frame until wait_test_event is set and then
+// returns the result of the wait.
+static iree_status_t wait_test_wait(iree_vm_stack_t* stack, void* module,
+                                    void* module_state) {
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_top(stack);
+  if (current_frame->pc == WAIT_TEST_WAIT_PC_BEGIN) {
+    current_frame->pc = WAIT_TEST_WAIT_PC_RESUME;
+    iree_vm_wait_frame_t* wait_frame = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_wait_enter(
+        stack, IREE_VM_WAIT_ALL, 1, iree_infinite_timeout(),
+        /*trace_zone=*/0, &wait_frame));
+    wait_frame->wait_sources[0] = iree_event_await(wait_test_event);
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  iree_vm_wait_result_t wait_result;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_wait_leave(stack, &wait_result));
+  return wait_result.status;
+}
+
+static const iree_vm_native_export_descriptor_t wait_test_exports_[] = {
+    {IREE_SV("wait"), IREE_SV("0v_v"), 0, NULL},
+};
+static const iree_vm_native_function_ptr_t wait_test_funcs_[] = {
+    {(iree_vm_native_function_shim_t)call_shim_v_v,
+     (iree_vm_native_function_target_t)wait_test_wait},
+};
+static const iree_vm_native_module_descriptor_t wait_test_descriptor_ = {
+    /*name=*/IREE_SV("wait_test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(wait_test_exports_),
+    /*exports=*/wait_test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(wait_test_funcs_),
+    /*functions=*/wait_test_funcs_,
+};
+
 // Test suite that uses module_a and module_b defined in native_module_test.h.
 // Both modules are put in a context and the module_b.entry function can be
 // executed with RunFunction.
@@ -33,7 +102,8 @@ class VMNativeModuleTest : public ::testing::Test {
 
   virtual void TearDown() { iree_vm_instance_release(instance_); }
 
-  iree_vm_context_t* CreateContext() {
+  iree_vm_context_t* CreateContext(
+      iree_vm_context_flags_t flags = IREE_VM_CONTEXT_FLAG_NONE) {
     // Create both modules shared instances. These are generally immutable and
     // can be shared by multiple contexts.
     iree_vm_module_t* module_a = nullptr;
@@ -49,7 +119,7 @@ class VMNativeModuleTest : public ::testing::Test {
     iree_vm_context_t* context = NULL;
     std::vector<iree_vm_module_t*> modules = {module_a, module_b};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
-        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        instance_, flags, modules.size(), modules.data(),
         iree_allocator_system(), &context));
 
     // No longer need the modules as the context retains them.
@@ -59,6 +129,24 @@ class VMNativeModuleTest : public ::testing::Test {
     return context;
   }
 
+  // Creates a context with only the wait_test module.
+  iree_vm_context_t* CreateWaitContext() {
+    iree_vm_module_t interface;
+    IREE_CHECK_OK(iree_vm_module_initialize(&interface, NULL));
+    iree_vm_module_t* module = nullptr;
+    IREE_CHECK_OK(iree_vm_native_module_create(&interface,
+                                               &wait_test_descriptor_,
+                                               instance_,
+                                               iree_allocator_system(),
+                                               &module));
+    iree_vm_context_t* context = NULL;
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+        iree_allocator_system(), &context));
+    iree_vm_module_release(module);
+    return context;
+  }
+
   StatusOr<int32_t> RunFunction(iree_vm_context_t* context,
                                 iree_string_view_t function_name,
                                 int32_t arg0) {
@@ -97,6 +185,46 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
+  // Creates an invocation of module_b.entry(|arg0|) on |loop|.
+  StatusOr<iree_vm_invocation_t*> CreateInvocation(iree_loop_t loop,
+                                                   iree_vm_context_t* context,
+                                                   int32_t arg0) {
+    return CreateInvocation(loop, context, IREE_SV("module_b.entry"), &arg0);
+  }
+
+  // Creates an invocation of |function_name| on |loop| passing |arg0| if not
+  // NULL.
+  StatusOr<iree_vm_invocation_t*> CreateInvocation(
+      iree_loop_t loop, iree_vm_context_t* context,
+      iree_string_view_t function_name, const int32_t* arg0) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_context_resolve_function(context, function_name, &function));
+    vm::ref<iree_vm_list_t> input_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &input_list));
+    if (arg0) {
+      auto arg0_value = iree_vm_value_make_i32(*arg0);
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_push_value(input_list.get(), &arg0_value));
+    }
+    iree_vm_invocation_t* invocation = NULL;
+    IREE_RETURN_IF_ERROR(iree_vm_invocation_create(
+        loop, context, function, IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/nullptr, input_list.get(), iree_allocator_system(),
+        &invocation));
+    return invocation;
+  }
+
+  static int32_t GetResult(iree_vm_invocation_t* invocation) {
+    const iree_vm_list_t* outputs = iree_vm_invocation_outputs(invocation);
+    if (!outputs) return -1;
+    iree_vm_value_t ret0_value;
+    IREE_CHECK_OK(iree_vm_list_get_value(outputs, 0, &ret0_value));
+    return ret0_value.i32;
+  }
+
  private:
   iree_vm_instance_t* instance_ = nullptr;
 };
@@ -159,5 +287,198 @@ TEST_F(VMNativeModuleTest, Fork) {
   iree_vm_context_release(child_context);
 }
 
+// Tests calling an export through a resolved direct-call trampoline.
+TEST_F(VMNativeModuleTest, Trampoline) {
+  iree_vm_context_t* context = CreateContext();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_a.add_1"), &function));
+  iree_vm_native_function_trampoline_t trampoline;
+  ASSERT_TRUE(iree_vm_native_module_resolve_trampoline(&function, &trampoline));
+
+  // Only exports have trampolines.
+  iree_vm_function_t import_function = function;
+  import_function.linkage = IREE_VM_FUNCTION_LINKAGE_IMPORT;
+  iree_vm_native_function_trampoline_t import_trampoline;
+  EXPECT_FALSE(iree_vm_native_module_resolve_trampoline(&import_function,
+                                                        &import_trampoline));
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context),
+                                  iree_allocator_system());
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_ASSERT_OK(
+      iree_vm_stack_query_module_state(stack, function.module, &module_state));
+  int32_t arg0 = 41;
+  int32_t ret0 = 0;
+  IREE_ASSERT_OK(iree_vm_native_function_trampoline_call(
+      &trampoline, stack, &function, module_state,
+      iree_make_byte_span(&arg0, sizeof(arg0)),
+      iree_make_byte_span(&ret0, sizeof(ret0))));
+  EXPECT_EQ(ret0, 42);
+  EXPECT_EQ(iree_vm_stack_current_frame(stack), nullptr);
+  iree_vm_stack_deinitialize(stack);
+
+  iree_vm_context_release(context);
+}
+
+// Tests that invocations on an inline loop complete before creation returns.
+TEST_F(VMNativeModuleTest, InvocationInline) {
+  iree_vm_context_t* context = CreateContext();
+  iree_status_t loop_status = iree_ok_status();
+  IREE_ASSERT_OK_AND_ASSIGN(
+      iree_vm_invocation_t * invocation,
+      CreateInvocation(iree_loop_inline(&loop_status), context, 1));
+  IREE_ASSERT_OK(loop_status);
+  IREE_EXPECT_OK(iree_vm_invocation_query_status(invocation));
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(GetResult(invocation), 1);
+  // Cancelling a completed invocation is a no-op.
+  iree_vm_invocation_cancel(invocation);
+  IREE_EXPECT_OK(iree_vm_invocation_query_status(invocation));
+  iree_vm_invocation_release(invocation);
+  iree_vm_context_release(context);
+}
+
+// Tests that invocations progress only as the loop runs and that cancelled
+// invocations complete with IREE_STATUS_CANCELLED.
+TEST_F(VMNativeModuleTest, InvocationDeferredAndCancelled) {
+  iree_vm_context_t* context = CreateContext();
+  iree_loop_sync_options_t options = {};
+  options.max_queue_depth = 16;
+  options.max_wait_count = 16;
+  iree_loop_sync_t* loop_sync = NULL;
+  IREE_ASSERT_OK(
+      iree_loop_sync_allocate(options, iree_allocator_system(), &loop_sync));
+  iree_loop_sync_scope_t scope;
+  iree_loop_sync_scope_initialize(loop_sync, /*error_fn=*/NULL,
+                                  /*error_user_data=*/NULL, &scope);
+  iree_loop_t loop = iree_loop_sync_scope(&scope);
+
+  IREE_ASSERT_OK_AND_ASSIGN(iree_vm_invocation_t * invocation,
+                            CreateInvocation(loop, context, 1));
+  IREE_ASSERT_OK_AND_ASSIGN(iree_vm_invocation_t * cancelled_invocation,
+                            CreateInvocation(loop, context, 2));
+  EXPECT_THAT(Status(iree_vm_invocation_query_status(invocation)),
+              StatusIs(StatusCode::kDeferred));
+  EXPECT_EQ(iree_vm_invocation_outputs(invocation), nullptr);
+  EXPECT_THAT(Status(iree_vm_invocation_await(invocation,
+                                              IREE_TIME_INFINITE_PAST)),
+              StatusIs(StatusCode::kDeadlineExceeded));
+  iree_vm_invocation_cancel(cancelled_invocation);
+
+  IREE_ASSERT_OK(
+      iree_loop_sync_wait_idle(loop_sync, iree_infinite_timeout()));
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(GetResult(invocation), 1);
+  EXPECT_THAT(Status(iree_vm_invocation_await(cancelled_invocation,
+                                              IREE_TIME_INFINITE_FUTURE)),
+              StatusIs(StatusCode::kCancelled));
+  EXPECT_EQ(iree_vm_invocation_outputs(cancelled_invocation), nullptr);
+
+  iree_vm_invocation_release(invocation);
+  iree_vm_invocation_release(cancelled_invocation);
+  iree_loop_sync_scope_deinitialize(&scope);
+  iree_loop_sync_free(loop_sync);
+  iree_vm_context_release(context);
+}
+
+// Tests that cancelling an invocation parked at a wait frame completes it with
+// IREE_STATUS_CANCELLED once the wait wakes and releases its resources.
+TEST_F(VMNativeModuleTest, InvocationCancelledWhileWaiting) {
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  wait_test_event = &event;
+  iree_vm_context_t* context = CreateWaitContext();
+  iree_loop_sync_options_t options = {};
+  options.max_queue_depth = 16;
+  options.max_wait_count = 16;
+  iree_loop_sync_t* loop_sync = NULL;
+  IREE_ASSERT_OK(
+      iree_loop_sync_allocate(options, iree_allocator_system(), &loop_sync));
+  iree_loop_sync_scope_t scope;
+  iree_loop_sync_scope_initialize(loop_sync, /*error_fn=*/NULL,
+                                  /*error_user_data=*/NULL, &scope);
+  iree_loop_t loop = iree_loop_sync_scope(&scope);
+
+  IREE_ASSERT_OK_AND_ASSIGN(
+      iree_vm_invocation_t * invocation,
+      CreateInvocation(loop, context, IREE_SV("wait_test.wait"),
+                       /*arg0=*/NULL));
+
+  // Run the invocation until it parks on the unset event.
+  IREE_ASSERT_OK(
+      iree_loop_sync_wait_idle(loop_sync, iree_immediate_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_query_status(invocation)),
+              StatusIs(StatusCode::kDeferred));
+
+  // The wait succeeds but cancellation overrides its result.
+  iree_vm_invocation_cancel(invocation);
+  iree_event_set(&event);
+  IREE_ASSERT_OK(
+      iree_loop_sync_wait_idle(loop_sync, iree_infinite_timeout()));
+  EXPECT_THAT(Status(iree_vm_invocation_await(invocation,
+                                              IREE_TIME_INFINITE_FUTURE)),
+              StatusIs(StatusCode::kCancelled));
+  EXPECT_EQ(iree_vm_invocation_outputs(invocation), nullptr);
+
+  iree_vm_invocation_release(invocation);
+  iree_loop_sync_scope_deinitialize(&scope);
+  iree_loop_sync_free(loop_sync);
+  iree_vm_context_release(context);
+  wait_test_event = NULL;
+  iree_event_deinitialize(&event);
+}
+
+// Tests many invocations running concurrently from multiple threads on a
+// single context created with IREE_VM_CONTEXT_FLAG_CONCURRENT.
+TEST_F(VMNativeModuleTest, InvocationConcurrent) {
+  iree_vm_context_t* context = CreateContext(IREE_VM_CONTEXT_FLAG_CONCURRENT);
+
+  // module_a is stateless and safe to call concurrently; module_b is not.
+  constexpr int kThreadCount = 8;
+  constexpr int kInvocationCount = 64;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t]() {
+      iree_loop_sync_options_t options = {};
+      options.max_queue_depth = 2 * kInvocationCount;
+      options.max_wait_count = 2 * kInvocationCount;
+      iree_loop_sync_t* loop_sync = NULL;
+      IREE_ASSERT_OK(iree_loop_sync_allocate(options, iree_allocator_system(),
+                                             &loop_sync));
+      iree_loop_sync_scope_t scope;
+      iree_loop_sync_scope_initialize(loop_sync, /*error_fn=*/NULL,
+                                      /*error_user_data=*/NULL, &scope);
+      iree_loop_t loop = iree_loop_sync_scope(&scope);
+
+      std::vector<iree_vm_invocation_t*> invocations(kInvocationCount);
+      for (int i = 0; i < kInvocationCount; ++i) {
+        int32_t arg0 = t * kInvocationCount + i;
+        IREE_ASSERT_OK_AND_ASSIGN(
+            invocations[i], CreateInvocation(loop, context,
+                                             IREE_SV("module_a.add_1"), &arg0));
+      }
+      IREE_ASSERT_OK(
+          iree_loop_sync_wait_idle(loop_sync, iree_infinite_timeout()));
+      for (int i = 0; i < kInvocationCount; ++i) {
+        IREE_EXPECT_OK(iree_vm_invocation_await(invocations[i],
+                                                IREE_TIME_INFINITE_FUTURE));
+        EXPECT_EQ(GetResult(invocations[i]), t * kInvocationCount + i + 1);
+        iree_vm_invocation_release(invocations[i]);
+      }
+
+      iree_loop_sync_scope_deinitialize(&scope);
+      iree_loop_sync_free(loop_sync);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  iree_vm_context_release(context);
+}
+
 }  // namespace
 }  // namespace iree
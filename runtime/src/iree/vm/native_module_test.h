@@ -211,6 +211,17 @@ static iree_status_t IREE_API_PTR module_b_fork_state(
   return iree_ok_status();
 }
 
+// Resets a state forked from |parent_state| back to the parent contents when a
+// pooled context is recycled. The resolved imports never change across forks
+// so only the user data that may have diverged needs to be restored.
+static iree_status_t IREE_API_PTR
+module_b_reset_state(void* self, iree_vm_module_state_t* parent_state,
+                     iree_vm_module_state_t* module_state) {
+  module_b_state_t* state = (module_b_state_t*)module_state;
+  state->counter = ((module_b_state_t*)parent_state)->counter;
+  return iree_ok_status();
+}
+
 // Called once per import function so the module can store the function ref.
 static iree_status_t IREE_API_PTR module_b_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
@@ -326,6 +337,7 @@ static iree_status_t module_b_create(iree_vm_instance_t* instance,
   interface.alloc_state = module_b_alloc_state;
   interface.free_state = module_b_free_state;
   interface.fork_state = module_b_fork_state;
+  interface.reset_state = module_b_reset_state;
   interface.resolve_import = module_b_resolve_import;
   return iree_vm_native_module_create(&interface, &module_b_descriptor_,
                                       instance, allocator, out_module);
@@ -0,0 +1,1201 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/sampling_profiler.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+
+iree_atomic_int32_t iree_vm_sampling_profiler_global_epoch =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// The currently active profiler, if any.
+static iree_atomic_intptr_t iree_vm_sampling_profiler_active =
+    IREE_ATOMIC_VAR_INIT(0);
+
+// Number of threads in iree_vm_sampling_profiler_record that may be using the
+// active profiler. Stopping waits for this to drain so that a profiler is not
+// released while a sample is still being stored into it.
+static iree_atomic_int32_t iree_vm_sampling_profiler_recorder_count =
+    IREE_ATOMIC_VAR_INIT(0);
+
+//===----------------------------------------------------------------------===//
+// Utilities
+//===----------------------------------------------------------------------===//
+
+// A single frame of a sampled stack.
+typedef struct iree_vm_sampling_frame_t {
+  // Function executing in the frame.
+  iree_vm_function_t function;
+  // Program counter within the function or -1 if the frame has no meaningful
+  // pc (such as native functions).
+  iree_vm_source_offset_t pc;
+} iree_vm_sampling_frame_t;
+
+static bool iree_vm_sampling_frame_equal(const iree_vm_sampling_frame_t* lhs,
+                                         const iree_vm_sampling_frame_t* rhs) {
+  return lhs->function.module == rhs->function.module &&
+         lhs->function.linkage == rhs->function.linkage &&
+         lhs->function.ordinal == rhs->function.ordinal && lhs->pc == rhs->pc;
+}
+
+#define IREE_VM_SAMPLING_HASH_SEED 0xCBF29CE484222325ull
+
+static uint64_t iree_vm_sampling_hash_combine(uint64_t hash, uint64_t value) {
+  hash ^= value;
+  hash *= 0x100000001B3ull;
+  return hash ^ (hash >> 29);
+}
+
+static uint64_t iree_vm_sampling_frame_hash(
+    uint64_t hash, const iree_vm_sampling_frame_t* frame) {
+  hash = iree_vm_sampling_hash_combine(
+      hash, (uint64_t)(uintptr_t)frame->function.module);
+  hash = iree_vm_sampling_hash_combine(
+      hash,
+      ((uint64_t)frame->function.linkage << 16) | frame->function.ordinal);
+  return iree_vm_sampling_hash_combine(hash, (uint64_t)frame->pc);
+}
+
+static uint64_t iree_vm_sampling_string_hash(iree_string_view_t value) {
+  uint64_t hash = IREE_VM_SAMPLING_HASH_SEED;
+  for (iree_host_size_t i = 0; i < value.size; ++i) {
+    hash = (hash ^ (uint8_t)value.data[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Grows |*inout_ptr| to hold at least |minimum_count| elements of
+// |element_size| bytes each.
+static iree_status_t iree_vm_sampling_array_reserve(
+    iree_allocator_t allocator, iree_host_size_t element_size,
+    iree_host_size_t minimum_count, iree_host_size_t* inout_capacity,
+    void** inout_ptr) {
+  if (minimum_count <= *inout_capacity) return iree_ok_status();
+  iree_host_size_t new_capacity =
+      iree_max(iree_max((iree_host_size_t)16, *inout_capacity * 2),
+               minimum_count);
+  IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+      allocator, new_capacity * element_size, inout_ptr));
+  *inout_capacity = new_capacity;
+  return iree_ok_status();
+}
+
+typedef struct iree_vm_sampling_index_slot_t {
+  uint64_t hash;
+  // Index of the entry plus one or 0 if the slot is empty.
+  iree_host_size_t value;
+} iree_vm_sampling_index_slot_t;
+
+// An open-addressed hash index mapping entries stored in an external array.
+// Equality of entries with matching hashes is checked with a callback.
+typedef struct iree_vm_sampling_index_t {
+  // Total slot count; always a power of two.
+  iree_host_size_t capacity;
+  iree_host_size_t count;
+  iree_vm_sampling_index_slot_t* slots;
+} iree_vm_sampling_index_t;
+
+typedef bool (*iree_vm_sampling_index_equal_fn_t)(void* user_data,
+                                                  iree_host_size_t index);
+
+static void iree_vm_sampling_index_deinitialize(
+    iree_vm_sampling_index_t* index, iree_allocator_t allocator) {
+  iree_allocator_free(allocator, index->slots);
+  memset(index, 0, sizeof(*index));
+}
+
+// Ensures |index| can have one more entry inserted while remaining at most
+// half full. Invalidates slot pointers previously returned from the index.
+static iree_status_t iree_vm_sampling_index_reserve(
+    iree_vm_sampling_index_t* index, iree_allocator_t allocator) {
+  if ((index->count + 1) * 2 <= index->capacity) return iree_ok_status();
+  iree_host_size_t new_capacity =
+      iree_max((iree_host_size_t)64, index->capacity * 2);
+  iree_vm_sampling_index_slot_t* new_slots = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator, new_capacity * sizeof(*new_slots), (void**)&new_slots));
+  for (iree_host_size_t i = 0; i < index->capacity; ++i) {
+    const iree_vm_sampling_index_slot_t* slot = &index->slots[i];
+    if (!slot->value) continue;
+    iree_host_size_t j = slot->hash & (new_capacity - 1);
+    while (new_slots[j].value) j = (j + 1) & (new_capacity - 1);
+    new_slots[j] = *slot;
+  }
+  iree_allocator_free(allocator, index->slots);
+  index->capacity = new_capacity;
+  index->slots = new_slots;
+  return iree_ok_status();
+}
+
+// Returns the slot of the entry with |hash| for which |equal_fn| returns true
+// or the empty slot the entry should be inserted into. The index must have
+// been reserved with iree_vm_sampling_index_reserve.
+static iree_vm_sampling_index_slot_t* iree_vm_sampling_index_find(
+    iree_vm_sampling_index_t* index, uint64_t hash,
+    iree_vm_sampling_index_equal_fn_t equal_fn, void* user_data) {
+  iree_host_size_t i = hash & (index->capacity - 1);
+  for (;;) {
+    iree_vm_sampling_index_slot_t* slot = &index->slots[i];
+    if (!slot->value) return slot;
+    if (slot->hash == hash && equal_fn(user_data, slot->value - 1)) {
+      return slot;
+    }
+    i = (i + 1) & (index->capacity - 1);
+  }
+}
+
+// Inserts entry |value| into the empty |slot| returned from
+// iree_vm_sampling_index_find.
+static void iree_vm_sampling_index_insert(iree_vm_sampling_index_t* index,
+                                          iree_vm_sampling_index_slot_t* slot,
+                                          uint64_t hash,
+                                          iree_host_size_t value) {
+  slot->hash = hash;
+  slot->value = value + 1;
+  ++index->count;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_vm_sampling_profiler_t
+//===----------------------------------------------------------------------===//
+
+// A unique sampled stack and its accumulated weight.
+typedef struct iree_vm_sampling_stack_t {
+  uint64_t hash;
+  // Range of frames in the profiler frame storage ordered from the bottom of
+  // the stack to the top.
+  iree_host_size_t frame_offset;
+  iree_host_size_t frame_count;
+  // Total number of intervals attributed to the stack.
+  int64_t weight;
+} iree_vm_sampling_stack_t;
+
+struct iree_vm_sampling_profiler_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_vm_sampling_profiler_options_t options;
+
+  // Timer thread advancing the sample epoch while the profiler is active.
+  // Only used if IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK is not set.
+  iree_thread_t* timer_thread;
+  iree_atomic_int32_t timer_exit_requested;
+  iree_notification_t timer_notification;
+
+  // Time the profiler was last started and the total time spent active.
+  iree_time_t start_time_ns;
+  iree_duration_t active_duration_ns;
+
+  // Guards all sample storage. Samples are recorded from any thread executing
+  // VM code while the profiler is active.
+  iree_slim_mutex_t mutex;
+
+  // Total weight of all samples recorded.
+  int64_t total_weight IREE_GUARDED_BY(mutex);
+
+  // Unique stacks and an index of them by hash.
+  iree_host_size_t stack_count IREE_GUARDED_BY(mutex);
+  iree_host_size_t stack_capacity IREE_GUARDED_BY(mutex);
+  iree_vm_sampling_stack_t* stacks IREE_GUARDED_BY(mutex);
+  iree_vm_sampling_index_t stack_index IREE_GUARDED_BY(mutex);
+
+  // Frame storage referenced by the stacks.
+  iree_host_size_t frame_count IREE_GUARDED_BY(mutex);
+  iree_host_size_t frame_capacity IREE_GUARDED_BY(mutex);
+  iree_vm_sampling_frame_t* frames IREE_GUARDED_BY(mutex);
+
+  // Modules referenced by sampled frames. Retained so that functions can be
+  // resolved when the samples are written out after the modules are released.
+  iree_host_size_t module_count IREE_GUARDED_BY(mutex);
+  iree_host_size_t module_capacity IREE_GUARDED_BY(mutex);
+  iree_vm_module_t** modules IREE_GUARDED_BY(mutex);
+};
+
+static void iree_vm_sampling_profiler_destroy(
+    iree_vm_sampling_profiler_t* profiler);
+
+IREE_API_EXPORT iree_status_t iree_vm_sampling_profiler_create(
+    iree_vm_sampling_profiler_options_t options,
+    iree_allocator_t host_allocator,
+    iree_vm_sampling_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  if (options.interval_ns < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "sampling interval must be positive");
+  } else if (options.interval_ns == 0) {
+    options.interval_ns = IREE_VM_SAMPLING_PROFILER_DEFAULT_INTERVAL_NS;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, options.interval_ns);
+
+  iree_vm_sampling_profiler_t* profiler = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*profiler),
+                                (void**)&profiler));
+  iree_atomic_ref_count_init(&profiler->ref_count);
+  profiler->host_allocator = host_allocator;
+  profiler->options = options;
+  iree_atomic_store(&profiler->timer_exit_requested, 0,
+                    iree_memory_order_relaxed);
+  iree_notification_initialize(&profiler->timer_notification);
+  iree_slim_mutex_initialize(&profiler->mutex);
+
+  *out_profiler = profiler;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_vm_sampling_profiler_destroy(
+    iree_vm_sampling_profiler_t* profiler) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = profiler->host_allocator;
+  iree_vm_sampling_profiler_stop(profiler);
+  for (iree_host_size_t i = 0; i < profiler->module_count; ++i) {
+    iree_vm_module_release(profiler->modules[i]);
+  }
+  iree_allocator_free(host_allocator, profiler->modules);
+  iree_allocator_free(host_allocator, profiler->frames);
+  iree_vm_sampling_index_deinitialize(&profiler->stack_index, host_allocator);
+  iree_allocator_free(host_allocator, profiler->stacks);
+  iree_slim_mutex_deinitialize(&profiler->mutex);
+  iree_notification_deinitialize(&profiler->timer_notification);
+  iree_allocator_free(host_allocator, profiler);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_sampling_profiler_retain(
+    iree_vm_sampling_profiler_t* profiler) {
+  if (profiler) {
+    iree_atomic_ref_count_inc(&profiler->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_sampling_profiler_release(
+    iree_vm_sampling_profiler_t* profiler) {
+  if (profiler && iree_atomic_ref_count_dec(&profiler->ref_count) == 1) {
+    iree_vm_sampling_profiler_destroy(profiler);
+  }
+}
+
+#if IREE_THREADING_ENABLE
+
+static bool iree_vm_sampling_profiler_timer_should_exit(void* arg) {
+  iree_vm_sampling_profiler_t* profiler = (iree_vm_sampling_profiler_t*)arg;
+  return iree_atomic_load(&profiler->timer_exit_requested,
+                          iree_memory_order_acquire) != 0;
+}
+
+static int iree_vm_sampling_profiler_timer_main(void* arg) {
+  iree_vm_sampling_profiler_t* profiler = (iree_vm_sampling_profiler_t*)arg;
+  const iree_duration_t interval_ns = profiler->options.interval_ns;
+  // Deadlines advance by a fixed interval so that if the thread is delayed the
+  // missed intervals are still accounted for by the following ticks.
+  iree_time_t deadline_ns = iree_time_now() + interval_ns;
+  while (!iree_notification_await(&profiler->timer_notification,
+                                  iree_vm_sampling_profiler_timer_should_exit,
+                                  profiler, iree_make_deadline(deadline_ns))) {
+    iree_vm_sampling_profiler_tick(profiler);
+    deadline_ns += interval_ns;
+  }
+  return 0;
+}
+
+static iree_status_t iree_vm_sampling_profiler_start_timer(
+    iree_vm_sampling_profiler_t* profiler) {
+  iree_atomic_store(&profiler->timer_exit_requested, 0,
+                    iree_memory_order_release);
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = IREE_SV("iree-vm-sampling");
+  params.priority_class = IREE_THREAD_PRIORITY_CLASS_HIGH;
+  return iree_thread_create(iree_vm_sampling_profiler_timer_main, profiler,
+                            params, profiler->host_allocator,
+                            &profiler->timer_thread);
+}
+
+static void iree_vm_sampling_profiler_stop_timer(
+    iree_vm_sampling_profiler_t* profiler) {
+  if (!profiler->timer_thread) return;
+  iree_atomic_store(&profiler->timer_exit_requested, 1,
+                    iree_memory_order_release);
+  iree_notification_post(&profiler->timer_notification, IREE_ALL_WAITERS);
+  iree_thread_join(profiler->timer_thread);
+  iree_thread_release(profiler->timer_thread);
+  profiler->timer_thread = NULL;
+}
+
+#else
+
+static iree_status_t iree_vm_sampling_profiler_start_timer(
+    iree_vm_sampling_profiler_t* profiler) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "threading is disabled; sampling requires "
+                          "IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK");
+}
+
+static void iree_vm_sampling_profiler_stop_timer(
+    iree_vm_sampling_profiler_t* profiler) {}
+
+#endif  // IREE_THREADING_ENABLE
+
+IREE_API_EXPORT iree_status_t
+iree_vm_sampling_profiler_start(iree_vm_sampling_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong(
+          &iree_vm_sampling_profiler_active, &expected, (intptr_t)profiler,
+          iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "a sampling profiler is already active");
+  }
+  profiler->start_time_ns = iree_time_now();
+
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(profiler->options.flags,
+                         IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK)) {
+    status = iree_vm_sampling_profiler_start_timer(profiler);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_atomic_store(&iree_vm_sampling_profiler_active, 0,
+                      iree_memory_order_release);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_vm_sampling_profiler_stop(
+    iree_vm_sampling_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  if (iree_atomic_load(&iree_vm_sampling_profiler_active,
+                       iree_memory_order_acquire) != (intptr_t)profiler) {
+    return;  // not active
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_sampling_profiler_stop_timer(profiler);
+  profiler->active_duration_ns += iree_time_now() - profiler->start_time_ns;
+  iree_atomic_store(&iree_vm_sampling_profiler_active, 0,
+                    iree_memory_order_seq_cst);
+#if IREE_THREADING_ENABLE
+  // Recorders that observed the profiler before it was deactivated may still
+  // be storing their samples. Recording is short and never blocks on anything
+  // but the profiler mutex so we spin until they have all left.
+  while (iree_atomic_load(&iree_vm_sampling_profiler_recorder_count,
+                          iree_memory_order_seq_cst) != 0) {
+    iree_thread_yield();
+  }
+#endif  // IREE_THREADING_ENABLE
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_sampling_profiler_tick(
+    iree_vm_sampling_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  iree_atomic_fetch_add(&iree_vm_sampling_profiler_global_epoch, 1,
+                        iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT int64_t
+iree_vm_sampling_profiler_sample_count(iree_vm_sampling_profiler_t* profiler) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  iree_slim_mutex_lock(&profiler->mutex);
+  int64_t total_weight = profiler->total_weight;
+  iree_slim_mutex_unlock(&profiler->mutex);
+  return total_weight;
+}
+
+//===----------------------------------------------------------------------===//
+// Sample recording
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_vm_sampling_stack_key_t {
+  iree_vm_sampling_profiler_t* profiler;
+  const iree_vm_sampling_frame_t* frames;
+  iree_host_size_t frame_count;
+} iree_vm_sampling_stack_key_t;
+
+static bool iree_vm_sampling_stack_equal(void* user_data,
+                                         iree_host_size_t index) {
+  const iree_vm_sampling_stack_key_t* key =
+      (const iree_vm_sampling_stack_key_t*)user_data;
+  const iree_vm_sampling_stack_t* stack = &key->profiler->stacks[index];
+  if (stack->frame_count != key->frame_count) return false;
+  const iree_vm_sampling_frame_t* frames =
+      &key->profiler->frames[stack->frame_offset];
+  for (iree_host_size_t i = 0; i < key->frame_count; ++i) {
+    if (!iree_vm_sampling_frame_equal(&frames[i], &key->frames[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Retains |module| for the lifetime of the profiler if not already retained.
+// Must be called with the profiler mutex held.
+static iree_status_t iree_vm_sampling_profiler_retain_module(
+    iree_vm_sampling_profiler_t* profiler, iree_vm_module_t* module) {
+  for (iree_host_size_t i = 0; i < profiler->module_count; ++i) {
+    if (profiler->modules[i] == module) return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_array_reserve(
+      profiler->host_allocator, sizeof(profiler->modules[0]),
+      profiler->module_count + 1, &profiler->module_capacity,
+      (void**)&profiler->modules));
+  profiler->modules[profiler->module_count++] = module;
+  iree_vm_module_retain(module);
+  return iree_ok_status();
+}
+
+// Appends a new unique stack with |frames| and returns its index.
+// Must be called with the profiler mutex held.
+static iree_status_t iree_vm_sampling_profiler_append_stack(
+    iree_vm_sampling_profiler_t* profiler,
+    const iree_vm_sampling_frame_t* frames, iree_host_size_t frame_count,
+    uint64_t hash, iree_host_size_t* out_stack_index) {
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_array_reserve(
+      profiler->host_allocator, sizeof(profiler->stacks[0]),
+      profiler->stack_count + 1, &profiler->stack_capacity,
+      (void**)&profiler->stacks));
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_array_reserve(
+      profiler->host_allocator, sizeof(profiler->frames[0]),
+      profiler->frame_count + frame_count, &profiler->frame_capacity,
+      (void**)&profiler->frames));
+  for (iree_host_size_t i = 0; i < frame_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_vm_sampling_profiler_retain_module(
+        profiler, frames[i].function.module));
+  }
+
+  iree_vm_sampling_stack_t* stack = &profiler->stacks[profiler->stack_count];
+  stack->hash = hash;
+  stack->frame_offset = profiler->frame_count;
+  stack->frame_count = frame_count;
+  stack->weight = 0;
+  memcpy(&profiler->frames[profiler->frame_count], frames,
+         frame_count * sizeof(*frames));
+  profiler->frame_count += frame_count;
+  *out_stack_index = profiler->stack_count++;
+  return iree_ok_status();
+}
+
+// Adds |weight| to the stack with the given |frames|, inserting it if new.
+static iree_status_t iree_vm_sampling_profiler_add_sample(
+    iree_vm_sampling_profiler_t* profiler,
+    const iree_vm_sampling_frame_t* frames, iree_host_size_t frame_count,
+    int64_t weight) {
+  uint64_t hash = iree_vm_sampling_hash_combine(IREE_VM_SAMPLING_HASH_SEED,
+                                                (uint64_t)frame_count);
+  for (iree_host_size_t i = 0; i < frame_count; ++i) {
+    hash = iree_vm_sampling_frame_hash(hash, &frames[i]);
+  }
+  iree_vm_sampling_stack_key_t key = {
+      .profiler = profiler,
+      .frames = frames,
+      .frame_count = frame_count,
+  };
+
+  iree_slim_mutex_lock(&profiler->mutex);
+  iree_status_t status = iree_vm_sampling_index_reserve(
+      &profiler->stack_index, profiler->host_allocator);
+  iree_host_size_t stack_index = 0;
+  if (iree_status_is_ok(status)) {
+    iree_vm_sampling_index_slot_t* slot = iree_vm_sampling_index_find(
+        &profiler->stack_index, hash, iree_vm_sampling_stack_equal, &key);
+    if (slot->value) {
+      stack_index = slot->value - 1;
+    } else {
+      status = iree_vm_sampling_profiler_append_stack(
+          profiler, frames, frame_count, hash, &stack_index);
+      if (iree_status_is_ok(status)) {
+        iree_vm_sampling_index_insert(&profiler->stack_index, slot, hash,
+                                      stack_index);
+      }
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    profiler->stacks[stack_index].weight += weight;
+    profiler->total_weight += weight;
+  }
+  iree_slim_mutex_unlock(&profiler->mutex);
+  return status;
+}
+
+IREE_API_EXPORT int32_t iree_vm_sampling_profiler_record(
+    iree_vm_stack_t* stack, int32_t last_epoch,
+    const iree_vm_function_t* leaf_function) {
+  const int32_t epoch = iree_vm_sampling_profiler_epoch();
+  // The epoch may wrap and the difference is computed unsigned.
+  const uint32_t weight = (uint32_t)epoch - (uint32_t)last_epoch;
+  if (!stack || weight == 0) return epoch;
+
+  // Register as a recorder before observing the active profiler so that
+  // iree_vm_sampling_profiler_stop either hides the profiler from us or waits
+  // for us to finish with it.
+  iree_atomic_fetch_add(&iree_vm_sampling_profiler_recorder_count, 1,
+                        iree_memory_order_seq_cst);
+  iree_vm_sampling_profiler_t* profiler =
+      (iree_vm_sampling_profiler_t*)iree_atomic_load(
+          &iree_vm_sampling_profiler_active, iree_memory_order_seq_cst);
+  if (!profiler) {
+    iree_atomic_fetch_sub(&iree_vm_sampling_profiler_recorder_count, 1,
+                          iree_memory_order_release);
+    return epoch;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Capture frames from the top of the stack down. External frames only mark
+  // transitions into the VM and wait frames have no function of their own.
+  iree_vm_sampling_frame_t frames[IREE_VM_SAMPLING_PROFILER_MAX_DEPTH];
+  iree_host_size_t frame_count = 0;
+  if (leaf_function && leaf_function->module) {
+    frames[frame_count].function = *leaf_function;
+    frames[frame_count].pc = -1;
+    ++frame_count;
+  }
+  for (iree_vm_stack_frame_t* frame = iree_vm_stack_current_frame(stack);
+       frame && frame_count < IREE_ARRAYSIZE(frames);
+       frame = iree_vm_stack_frame_parent(frame)) {
+    if (!frame->function.module) continue;
+    if (frame->type == IREE_VM_STACK_FRAME_BYTECODE) {
+      frames[frame_count].pc = frame->pc;
+    } else if (frame->type == IREE_VM_STACK_FRAME_NATIVE) {
+      frames[frame_count].pc = -1;
+    } else {
+      continue;
+    }
+    frames[frame_count].function = frame->function;
+    ++frame_count;
+  }
+
+  // Stacks are stored from the bottom up to match the output formats.
+  for (iree_host_size_t i = 0; i < frame_count / 2; ++i) {
+    iree_vm_sampling_frame_t temp = frames[i];
+    frames[i] = frames[frame_count - i - 1];
+    frames[frame_count - i - 1] = temp;
+  }
+
+  // Samples that cannot be stored due to allocation failure are dropped.
+  iree_status_ignore(iree_vm_sampling_profiler_add_sample(
+      profiler, frames, frame_count, (int64_t)weight));
+
+  iree_atomic_fetch_sub(&iree_vm_sampling_profiler_recorder_count, 1,
+                        iree_memory_order_release);
+  IREE_TRACE_ZONE_END(z0);
+  return epoch;
+}
+
+//===----------------------------------------------------------------------===//
+// Frame formatting
+//===----------------------------------------------------------------------===//
+
+// Appends |value| to |builder| replacing characters that are reserved in the
+// collapsed stack format.
+static iree_status_t iree_vm_sampling_append_sanitized(
+    iree_string_builder_t* builder, iree_string_view_t value) {
+  while (!iree_string_view_is_empty(value)) {
+    iree_host_size_t split = iree_string_view_find_first_of(
+        value, iree_make_cstring_view(";\n"), 0);
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_string(
+        builder, iree_string_view_substr(value, 0, split)));
+    if (split == IREE_STRING_VIEW_NPOS) break;
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ","));
+    value = iree_string_view_remove_prefix(value, split + 1);
+  }
+  return iree_ok_status();
+}
+
+// Appends the fully-qualified name of |function| to |builder|.
+static iree_status_t iree_vm_sampling_append_function_name(
+    const iree_vm_function_t* function, iree_string_builder_t* builder) {
+  iree_string_view_t module_name = iree_vm_module_name(function->module);
+  iree_string_view_t function_name = iree_vm_function_name(function);
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_append_sanitized(builder, module_name));
+  if (iree_string_view_is_empty(function_name)) {
+    return iree_string_builder_append_format(builder, "@%d",
+                                             (int)function->ordinal);
+  }
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "."));
+  return iree_vm_sampling_append_sanitized(builder, function_name);
+}
+
+// Resolves the source location of |frame| into |scratch| and returns its first
+// line in |out_location| or an empty string if no location is available.
+static iree_status_t iree_vm_sampling_resolve_location(
+    const iree_vm_sampling_frame_t* frame, iree_string_builder_t* scratch,
+    iree_string_view_t* out_location) {
+  *out_location = iree_string_view_empty();
+  iree_string_builder_reset(scratch);
+  if (frame->pc < 0) return iree_ok_status();
+  iree_vm_source_location_t source_location;
+  iree_status_t status = iree_vm_module_resolve_source_location(
+      frame->function.module, frame->function, frame->pc, &source_location);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_source_location_format(
+        &source_location, IREE_VM_SOURCE_LOCATION_FORMAT_FLAG_SINGLE_LINE,
+        scratch);
+  }
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    iree_string_builder_reset(scratch);
+    return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(status);
+  iree_string_view_t location = iree_string_builder_view(scratch);
+  *out_location = iree_string_view_substr(
+      location, 0, iree_string_view_find_char(location, '\n', 0));
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Collapsed stack output
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_status_t iree_vm_sampling_profiler_append_collapsed(
+    iree_vm_sampling_profiler_t* profiler, iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_builder_t scratch;
+  iree_string_builder_initialize(profiler->host_allocator, &scratch);
+
+  iree_slim_mutex_lock(&profiler->mutex);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < profiler->stack_count && iree_status_is_ok(status); ++i) {
+    const iree_vm_sampling_stack_t* stack = &profiler->stacks[i];
+    for (iree_host_size_t j = 0;
+         j < stack->frame_count && iree_status_is_ok(status); ++j) {
+      const iree_vm_sampling_frame_t* frame =
+          &profiler->frames[stack->frame_offset + j];
+      if (j > 0) {
+        status = iree_string_builder_append_cstring(builder, ";");
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_sampling_append_function_name(&frame->function,
+                                                       builder);
+      }
+      iree_string_view_t location = iree_string_view_empty();
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_sampling_resolve_location(frame, &scratch, &location);
+      }
+      if (iree_status_is_ok(status) && !iree_string_view_is_empty(location)) {
+        status = iree_string_builder_append_cstring(builder, " (");
+        if (iree_status_is_ok(status)) {
+          status = iree_vm_sampling_append_sanitized(builder, location);
+        }
+        if (iree_status_is_ok(status)) {
+          status = iree_string_builder_append_cstring(builder, ")");
+        }
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_format(builder, " %" PRId64 "\n",
+                                                 stack->weight);
+    }
+  }
+  iree_slim_mutex_unlock(&profiler->mutex);
+
+  iree_string_builder_deinitialize(&scratch);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// pprof output
+//===----------------------------------------------------------------------===//
+// Emits the perftools.profiles.Profile protocol buffer message:
+// https://github.com/google/pprof/blob/main/proto/profile.proto
+//
+// Each VM function is emitted as a pprof function and each unique
+// (function, pc) as a location with the pc as its address. When a source
+// location can be resolved and ends in `:line` or `:line:column` the line is
+// attached to the location and the remainder used as the function filename.
+
+// Field numbers within the messages we emit.
+enum iree_vm_pprof_field_e {
+  IREE_VM_PPROF_PROFILE_SAMPLE_TYPE = 1,
+  IREE_VM_PPROF_PROFILE_SAMPLE = 2,
+  IREE_VM_PPROF_PROFILE_LOCATION = 4,
+  IREE_VM_PPROF_PROFILE_FUNCTION = 5,
+  IREE_VM_PPROF_PROFILE_STRING_TABLE = 6,
+  IREE_VM_PPROF_PROFILE_DURATION_NANOS = 10,
+  IREE_VM_PPROF_PROFILE_PERIOD_TYPE = 11,
+  IREE_VM_PPROF_PROFILE_PERIOD = 12,
+  IREE_VM_PPROF_VALUE_TYPE_TYPE = 1,
+  IREE_VM_PPROF_VALUE_TYPE_UNIT = 2,
+  IREE_VM_PPROF_SAMPLE_LOCATION_ID = 1,
+  IREE_VM_PPROF_SAMPLE_VALUE = 2,
+  IREE_VM_PPROF_LOCATION_ID = 1,
+  IREE_VM_PPROF_LOCATION_ADDRESS = 3,
+  IREE_VM_PPROF_LOCATION_LINE = 4,
+  IREE_VM_PPROF_LINE_FUNCTION_ID = 1,
+  IREE_VM_PPROF_LINE_LINE = 2,
+  IREE_VM_PPROF_FUNCTION_ID = 1,
+  IREE_VM_PPROF_FUNCTION_NAME = 2,
+  IREE_VM_PPROF_FUNCTION_SYSTEM_NAME = 3,
+  IREE_VM_PPROF_FUNCTION_FILENAME = 4,
+};
+
+enum iree_vm_pprof_wire_type_e {
+  IREE_VM_PPROF_WIRE_TYPE_VARINT = 0,
+  IREE_VM_PPROF_WIRE_TYPE_LENGTH_DELIMITED = 2,
+};
+
+static iree_status_t iree_vm_pprof_append_varint(iree_string_builder_t* builder,
+                                                 uint64_t value) {
+  char buffer[10];
+  iree_host_size_t length = 0;
+  do {
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    buffer[length++] = (char)(value ? byte | 0x80 : byte);
+  } while (value);
+  return iree_string_builder_append_string(
+      builder, iree_make_string_view(buffer, length));
+}
+
+static iree_status_t iree_vm_pprof_append_varint_field(
+    iree_string_builder_t* builder, uint32_t field, uint64_t value) {
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint(
+      builder, (field << 3) | IREE_VM_PPROF_WIRE_TYPE_VARINT));
+  return iree_vm_pprof_append_varint(builder, value);
+}
+
+static iree_status_t iree_vm_pprof_append_bytes_field(
+    iree_string_builder_t* builder, uint32_t field, iree_string_view_t value) {
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint(
+      builder, (field << 3) | IREE_VM_PPROF_WIRE_TYPE_LENGTH_DELIMITED));
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint(builder, value.size));
+  // Empty strings may have NULL data that must not be passed to memcpy.
+  if (!value.size) return iree_ok_status();
+  return iree_string_builder_append_string(builder, value);
+}
+
+typedef struct iree_vm_pprof_string_t {
+  iree_host_size_t offset;
+  iree_host_size_t length;
+} iree_vm_pprof_string_t;
+
+typedef struct iree_vm_pprof_function_t {
+  iree_vm_function_t function;
+  uint64_t name_id;
+  uint64_t filename_id;
+} iree_vm_pprof_function_t;
+
+typedef struct iree_vm_pprof_location_t {
+  iree_vm_sampling_frame_t frame;
+  uint64_t function_id;
+  int64_t line;
+} iree_vm_pprof_location_t;
+
+// Tables of the strings, functions, and locations referenced by the profile.
+// IDs are table indices; strings are 0-based and functions and locations are
+// 1-based as required by pprof.
+typedef struct iree_vm_pprof_tables_t {
+  iree_allocator_t allocator;
+
+  iree_string_builder_t string_data;
+  iree_host_size_t string_count;
+  iree_host_size_t string_capacity;
+  iree_vm_pprof_string_t* strings;
+  iree_vm_sampling_index_t string_index;
+
+  iree_host_size_t function_count;
+  iree_host_size_t function_capacity;
+  iree_vm_pprof_function_t* functions;
+  iree_vm_sampling_index_t function_index;
+
+  iree_host_size_t location_count;
+  iree_host_size_t location_capacity;
+  iree_vm_pprof_location_t* locations;
+  iree_vm_sampling_index_t location_index;
+} iree_vm_pprof_tables_t;
+
+static void iree_vm_pprof_tables_initialize(iree_allocator_t allocator,
+                                            iree_vm_pprof_tables_t* tables) {
+  memset(tables, 0, sizeof(*tables));
+  tables->allocator = allocator;
+  iree_string_builder_initialize(allocator, &tables->string_data);
+}
+
+static void iree_vm_pprof_tables_deinitialize(iree_vm_pprof_tables_t* tables) {
+  iree_allocator_t allocator = tables->allocator;
+  iree_vm_sampling_index_deinitialize(&tables->location_index, allocator);
+  iree_allocator_free(allocator, tables->locations);
+  iree_vm_sampling_index_deinitialize(&tables->function_index, allocator);
+  iree_allocator_free(allocator, tables->functions);
+  iree_vm_sampling_index_deinitialize(&tables->string_index, allocator);
+  iree_allocator_free(allocator, tables->strings);
+  iree_string_builder_deinitialize(&tables->string_data);
+}
+
+static iree_string_view_t iree_vm_pprof_string_at(
+    const iree_vm_pprof_tables_t* tables, iree_host_size_t id) {
+  // The string data may not have been allocated if only "" was interned.
+  if (!tables->strings[id].length) return iree_string_view_empty();
+  return iree_make_string_view(
+      iree_string_builder_buffer(&tables->string_data) +
+          tables->strings[id].offset,
+      tables->strings[id].length);
+}
+
+typedef struct iree_vm_pprof_string_key_t {
+  const iree_vm_pprof_tables_t* tables;
+  iree_string_view_t value;
+} iree_vm_pprof_string_key_t;
+
+static bool iree_vm_pprof_string_equal(void* user_data,
+                                       iree_host_size_t index) {
+  const iree_vm_pprof_string_key_t* key =
+      (const iree_vm_pprof_string_key_t*)user_data;
+  // Empty strings may have NULL data that must not be passed to memcmp.
+  if (key->tables->strings[index].length != key->value.size) return false;
+  if (!key->value.size) return true;
+  return iree_string_view_equal(iree_vm_pprof_string_at(key->tables, index),
+                                key->value);
+}
+
+// Interns |value| in the string table and returns its ID.
+// |value| must not reference the string table storage.
+static iree_status_t iree_vm_pprof_intern_string(iree_vm_pprof_tables_t* tables,
+                                                 iree_string_view_t value,
+                                                 uint64_t* out_id) {
+  const uint64_t hash = iree_vm_sampling_string_hash(value);
+  IREE_RETURN_IF_ERROR(
+      iree_vm_sampling_index_reserve(&tables->string_index, tables->allocator));
+  iree_vm_pprof_string_key_t key = {tables, value};
+  iree_vm_sampling_index_slot_t* slot = iree_vm_sampling_index_find(
+      &tables->string_index, hash, iree_vm_pprof_string_equal, &key);
+  if (slot->value) {
+    *out_id = slot->value - 1;
+    return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_array_reserve(
+      tables->allocator, sizeof(tables->strings[0]), tables->string_count + 1,
+      &tables->string_capacity, (void**)&tables->strings));
+  iree_vm_pprof_string_t* string = &tables->strings[tables->string_count];
+  string->offset = iree_string_builder_size(&tables->string_data);
+  string->length = value.size;
+  if (value.size) {
+    IREE_RETURN_IF_ERROR(
+        iree_string_builder_append_string(&tables->string_data, value));
+  }
+  iree_vm_sampling_index_insert(&tables->string_index, slot, hash,
+                                tables->string_count);
+  *out_id = tables->string_count++;
+  return iree_ok_status();
+}
+
+typedef struct iree_vm_pprof_function_key_t {
+  const iree_vm_pprof_tables_t* tables;
+  const iree_vm_function_t* function;
+  uint64_t filename_id;
+} iree_vm_pprof_function_key_t;
+
+static bool iree_vm_pprof_function_equal(void* user_data,
+                                         iree_host_size_t index) {
+  const iree_vm_pprof_function_key_t* key =
+      (const iree_vm_pprof_function_key_t*)user_data;
+  const iree_vm_pprof_function_t* function = &key->tables->functions[index];
+  return function->function.module == key->function->module &&
+         function->function.linkage == key->function->linkage &&
+         function->function.ordinal == key->function->ordinal &&
+         function->filename_id == key->filename_id;
+}
+
+// Interns |function| as defined in |filename_id| and returns its ID.
+// |scratch| is used to format the function name.
+static iree_status_t iree_vm_pprof_intern_function(
+    iree_vm_pprof_tables_t* tables, const iree_vm_function_t* function,
+    uint64_t filename_id, iree_string_builder_t* scratch, uint64_t* out_id) {
+  iree_vm_sampling_frame_t hash_frame = {*function, (int64_t)filename_id};
+  const uint64_t hash =
+      iree_vm_sampling_frame_hash(IREE_VM_SAMPLING_HASH_SEED, &hash_frame);
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_index_reserve(&tables->function_index,
+                                                      tables->allocator));
+  iree_vm_pprof_function_key_t key = {tables, function, filename_id};
+  iree_vm_sampling_index_slot_t* slot = iree_vm_sampling_index_find(
+      &tables->function_index, hash, iree_vm_pprof_function_equal, &key);
+  if (slot->value) {
+    *out_id = slot->value;
+    return iree_ok_status();
+  }
+
+  iree_string_builder_reset(scratch);
+  IREE_RETURN_IF_ERROR(
+      iree_vm_sampling_append_function_name(function, scratch));
+  uint64_t name_id = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_intern_string(
+      tables, iree_string_builder_view(scratch), &name_id));
+
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_array_reserve(
+      tables->allocator, sizeof(tables->functions[0]),
+      tables->function_count + 1, &tables->function_capacity,
+      (void**)&tables->functions));
+  iree_vm_pprof_function_t* entry = &tables->functions[tables->function_count];
+  entry->function = *function;
+  entry->name_id = name_id;
+  entry->filename_id = filename_id;
+  iree_vm_sampling_index_insert(&tables->function_index, slot, hash,
+                                tables->function_count);
+  *out_id = ++tables->function_count;
+  return iree_ok_status();
+}
+
+// Splits a trailing `:line` or `:line:column` from |location|.
+// Returns false and leaves |location| unmodified if there is none.
+static bool iree_vm_pprof_split_line(iree_string_view_t* location,
+                                     int64_t* out_line) {
+  // Find up to two trailing `:<digits>` components.
+  iree_host_size_t end = location->size;
+  iree_host_size_t starts[2] = {0, 0};
+  int count = 0;
+  while (count < 2) {
+    iree_host_size_t i = end;
+    while (i > 0 && location->data[i - 1] >= '0' &&
+           location->data[i - 1] <= '9') {
+      --i;
+    }
+    if (i == end || i == 0 || location->data[i - 1] != ':') break;
+    starts[count++] = i;
+    end = i - 1;
+  }
+  if (count == 0) return false;
+
+  // With both a line and column the line is the first of the two.
+  iree_host_size_t line_start = starts[count - 1];
+  iree_host_size_t line_end = count == 2 ? starts[0] - 1 : location->size;
+  uint32_t line = 0;
+  if (!iree_string_view_atoi_uint32(
+          iree_make_string_view(location->data + line_start,
+                                line_end - line_start),
+          &line)) {
+    return false;
+  }
+  *out_line = line;
+  *location = iree_string_view_substr(*location, 0, line_start - 1);
+  return true;
+}
+
+typedef struct iree_vm_pprof_location_key_t {
+  const iree_vm_pprof_tables_t* tables;
+  const iree_vm_sampling_frame_t* frame;
+} iree_vm_pprof_location_key_t;
+
+static bool iree_vm_pprof_location_equal(void* user_data,
+                                         iree_host_size_t index) {
+  const iree_vm_pprof_location_key_t* key =
+      (const iree_vm_pprof_location_key_t*)user_data;
+  return iree_vm_sampling_frame_equal(&key->tables->locations[index].frame,
+                                      key->frame);
+}
+
+// Interns the location of |frame| and returns its ID.
+static iree_status_t iree_vm_pprof_intern_location(
+    iree_vm_pprof_tables_t* tables, const iree_vm_sampling_frame_t* frame,
+    iree_string_builder_t* scratch, uint64_t* out_id) {
+  const uint64_t hash =
+      iree_vm_sampling_frame_hash(IREE_VM_SAMPLING_HASH_SEED, frame);
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_index_reserve(&tables->location_index,
+                                                      tables->allocator));
+  iree_vm_pprof_location_key_t key = {tables, frame};
+  iree_vm_sampling_index_slot_t* slot = iree_vm_sampling_index_find(
+      &tables->location_index, hash, iree_vm_pprof_location_equal, &key);
+  if (slot->value) {
+    *out_id = slot->value;
+    return iree_ok_status();
+  }
+
+  // Resolve the source location into a filename and line.
+  iree_string_view_t filename = iree_string_view_empty();
+  IREE_RETURN_IF_ERROR(
+      iree_vm_sampling_resolve_location(frame, scratch, &filename));
+  int64_t line = 0;
+  iree_vm_pprof_split_line(&filename, &line);
+  uint64_t filename_id = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_pprof_intern_string(tables, filename, &filename_id));
+  uint64_t function_id = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_intern_function(
+      tables, &frame->function, filename_id, scratch, &function_id));
+
+  IREE_RETURN_IF_ERROR(iree_vm_sampling_array_reserve(
+      tables->allocator, sizeof(tables->locations[0]),
+      tables->location_count + 1, &tables->location_capacity,
+      (void**)&tables->locations));
+  iree_vm_pprof_location_t* entry = &tables->locations[tables->location_count];
+  entry->frame = *frame;
+  entry->function_id = function_id;
+  entry->line = line;
+  iree_vm_sampling_index_insert(&tables->location_index, slot, hash,
+                                tables->location_count);
+  *out_id = ++tables->location_count;
+  return iree_ok_status();
+}
+
+// Appends a ValueType message |field| with the given type and unit strings.
+static iree_status_t iree_vm_pprof_append_value_type(
+    iree_string_builder_t* builder, uint32_t field, uint64_t type_id,
+    uint64_t unit_id, iree_string_builder_t* message) {
+  iree_string_builder_reset(message);
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+      message, IREE_VM_PPROF_VALUE_TYPE_TYPE, type_id));
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+      message, IREE_VM_PPROF_VALUE_TYPE_UNIT, unit_id));
+  return iree_vm_pprof_append_bytes_field(builder, field,
+                                          iree_string_builder_view(message));
+}
+
+// Appends the profile to |builder| using |message| and |submessage| as scratch
+// storage for nested messages. Must be called with the profiler mutex held.
+static iree_status_t iree_vm_sampling_profiler_append_pprof_locked(
+    iree_vm_sampling_profiler_t* profiler, iree_vm_pprof_tables_t* tables,
+    iree_string_builder_t* builder, iree_string_builder_t* message,
+    iree_string_builder_t* submessage) {
+  // String 0 must be the empty string.
+  uint64_t empty_id = 0, samples_id = 0, count_id = 0, time_id = 0,
+           nanoseconds_id = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_pprof_intern_string(tables, IREE_SV(""), &empty_id));
+  IREE_RETURN_IF_ERROR(
+      iree_vm_pprof_intern_string(tables, IREE_SV("samples"), &samples_id));
+  IREE_RETURN_IF_ERROR(
+      iree_vm_pprof_intern_string(tables, IREE_SV("count"), &count_id));
+  IREE_RETURN_IF_ERROR(
+      iree_vm_pprof_intern_string(tables, IREE_SV("time"), &time_id));
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_intern_string(
+      tables, IREE_SV("nanoseconds"), &nanoseconds_id));
+
+  // Each sample has the number of samples and the time they represent.
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_value_type(
+      builder, IREE_VM_PPROF_PROFILE_SAMPLE_TYPE, samples_id, count_id,
+      message));
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_value_type(
+      builder, IREE_VM_PPROF_PROFILE_SAMPLE_TYPE, time_id, nanoseconds_id,
+      message));
+
+  // Samples list locations from the top of the stack to the bottom.
+  const int64_t interval_ns = profiler->options.interval_ns;
+  for (iree_host_size_t i = 0; i < profiler->stack_count; ++i) {
+    const iree_vm_sampling_stack_t* stack = &profiler->stacks[i];
+    iree_string_builder_reset(message);
+    iree_string_builder_reset(submessage);
+    for (iree_host_size_t j = stack->frame_count; j > 0; --j) {
+      const iree_vm_sampling_frame_t* frame =
+          &profiler->frames[stack->frame_offset + j - 1];
+      uint64_t location_id = 0;
+      IREE_RETURN_IF_ERROR(iree_vm_pprof_intern_location(
+          tables, frame, message, &location_id));
+      IREE_RETURN_IF_ERROR(
+          iree_vm_pprof_append_varint(submessage, location_id));
+    }
+    iree_string_builder_reset(message);
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        message, IREE_VM_PPROF_SAMPLE_LOCATION_ID,
+        iree_string_builder_view(submessage)));
+    iree_string_builder_reset(submessage);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_pprof_append_varint(submessage, (uint64_t)stack->weight));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint(
+        submessage, (uint64_t)(stack->weight * interval_ns)));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        message, IREE_VM_PPROF_SAMPLE_VALUE,
+        iree_string_builder_view(submessage)));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        builder, IREE_VM_PPROF_PROFILE_SAMPLE,
+        iree_string_builder_view(message)));
+  }
+
+  for (iree_host_size_t i = 0; i < tables->location_count; ++i) {
+    const iree_vm_pprof_location_t* location = &tables->locations[i];
+    iree_string_builder_reset(submessage);
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+        submessage, IREE_VM_PPROF_LINE_FUNCTION_ID, location->function_id));
+    if (location->line) {
+      IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+          submessage, IREE_VM_PPROF_LINE_LINE, (uint64_t)location->line));
+    }
+    iree_string_builder_reset(message);
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+        message, IREE_VM_PPROF_LOCATION_ID, i + 1));
+    if (location->frame.pc >= 0) {
+      IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+          message, IREE_VM_PPROF_LOCATION_ADDRESS,
+          (uint64_t)location->frame.pc));
+    }
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        message, IREE_VM_PPROF_LOCATION_LINE,
+        iree_string_builder_view(submessage)));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        builder, IREE_VM_PPROF_PROFILE_LOCATION,
+        iree_string_builder_view(message)));
+  }
+
+  for (iree_host_size_t i = 0; i < tables->function_count; ++i) {
+    const iree_vm_pprof_function_t* function = &tables->functions[i];
+    iree_string_builder_reset(message);
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+        message, IREE_VM_PPROF_FUNCTION_ID, i + 1));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+        message, IREE_VM_PPROF_FUNCTION_NAME, function->name_id));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+        message, IREE_VM_PPROF_FUNCTION_SYSTEM_NAME, function->name_id));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+        message, IREE_VM_PPROF_FUNCTION_FILENAME, function->filename_id));
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        builder, IREE_VM_PPROF_PROFILE_FUNCTION,
+        iree_string_builder_view(message)));
+  }
+
+  // Strings are emitted last as all have been interned by now.
+  for (iree_host_size_t i = 0; i < tables->string_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_vm_pprof_append_bytes_field(
+        builder, IREE_VM_PPROF_PROFILE_STRING_TABLE,
+        iree_vm_pprof_string_at(tables, i)));
+  }
+
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_varint_field(
+      builder, IREE_VM_PPROF_PROFILE_DURATION_NANOS,
+      (uint64_t)profiler->active_duration_ns));
+  IREE_RETURN_IF_ERROR(iree_vm_pprof_append_value_type(
+      builder, IREE_VM_PPROF_PROFILE_PERIOD_TYPE, time_id, nanoseconds_id,
+      message));
+  return iree_vm_pprof_append_varint_field(
+      builder, IREE_VM_PPROF_PROFILE_PERIOD, (uint64_t)interval_ns);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_sampling_profiler_append_pprof(
+    iree_vm_sampling_profiler_t* profiler, iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(profiler);
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_pprof_tables_t tables;
+  iree_vm_pprof_tables_initialize(profiler->host_allocator, &tables);
+  iree_string_builder_t message;
+  iree_string_builder_initialize(profiler->host_allocator, &message);
+  iree_string_builder_t submessage;
+  iree_string_builder_initialize(profiler->host_allocator, &submessage);
+
+  iree_slim_mutex_lock(&profiler->mutex);
+  iree_status_t status = iree_vm_sampling_profiler_append_pprof_locked(
+      profiler, &tables, builder, &message, &submessage);
+  iree_slim_mutex_unlock(&profiler->mutex);
+
+  iree_string_builder_deinitialize(&submessage);
+  iree_string_builder_deinitialize(&message);
+  iree_vm_pprof_tables_deinitialize(&tables);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
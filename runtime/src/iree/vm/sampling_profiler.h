@@ -0,0 +1,153 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_SAMPLING_PROFILER_H_
+#define IREE_VM_SAMPLING_PROFILER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/vm/module.h"
+#include "iree/vm/stack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_vm_sampling_profiler_t
+//===----------------------------------------------------------------------===//
+
+// Interval between samples used when none is specified.
+#define IREE_VM_SAMPLING_PROFILER_DEFAULT_INTERVAL_NS (1000000ll)  // 1ms
+
+// Maximum number of frames recorded per sample. Deeper stacks are truncated
+// and only the frames nearest the top of the stack are recorded.
+#define IREE_VM_SAMPLING_PROFILER_MAX_DEPTH 64
+
+enum iree_vm_sampling_profiler_flag_bits_t {
+  IREE_VM_SAMPLING_PROFILER_FLAG_NONE = 0u,
+
+  // Does not start a timer thread and instead the hosting application must
+  // call iree_vm_sampling_profiler_tick to advance the sample epoch. Useful
+  // on platforms without threads or when samples should be driven by an
+  // existing timer.
+  IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK = 1u << 0,
+};
+typedef uint32_t iree_vm_sampling_profiler_flags_t;
+
+typedef struct iree_vm_sampling_profiler_options_t {
+  // Flags controlling profiler behavior.
+  iree_vm_sampling_profiler_flags_t flags;
+  // Interval between samples or 0 to use
+  // IREE_VM_SAMPLING_PROFILER_DEFAULT_INTERVAL_NS.
+  iree_duration_t interval_ns;
+} iree_vm_sampling_profiler_options_t;
+
+// A low-overhead sampling profiler attributing host time to VM functions.
+//
+// While a profiler is active a timer thread advances a global sample epoch at
+// the requested interval. Interpreters compare the epoch against the value
+// they last observed at safepoints (branches, calls, and returns) and when it
+// has advanced record the current VM stack weighted by the number of elapsed
+// intervals. Samples are taken by the executing thread itself so the stack can
+// be walked without suspending the thread, and time spent blocked in a native
+// call is attributed to the call when it returns. When no profiler is active
+// the epoch never changes and the safepoint check is a relaxed load and a
+// predictable branch, allowing the support to always be compiled in.
+//
+// Samples are aggregated by unique stack (the function and pc of each frame)
+// and can be written as collapsed stacks, as consumed by flamegraph.pl and
+// speedscope, or as a pprof profile. Frames are resolved to source locations
+// with the module debug information when available.
+//
+// Only one profiler may be active at a time. Invocations may continue
+// executing while the profiler is stopped: samples being recorded at the time
+// are stored before iree_vm_sampling_profiler_stop returns and no more are
+// recorded afterward.
+//
+// Thread-safe.
+typedef struct iree_vm_sampling_profiler_t iree_vm_sampling_profiler_t;
+
+// Creates a sampling profiler with the given |options|. The profiler does not
+// record samples until started with iree_vm_sampling_profiler_start.
+// |out_profiler| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_sampling_profiler_create(
+    iree_vm_sampling_profiler_options_t options,
+    iree_allocator_t host_allocator,
+    iree_vm_sampling_profiler_t** out_profiler);
+
+// Retains the given |profiler| for the caller.
+IREE_API_EXPORT void iree_vm_sampling_profiler_retain(
+    iree_vm_sampling_profiler_t* profiler);
+
+// Releases the given |profiler| from the caller.
+// The profiler must not be active.
+IREE_API_EXPORT void iree_vm_sampling_profiler_release(
+    iree_vm_sampling_profiler_t* profiler);
+
+// Makes |profiler| the active profiler and begins sampling.
+// Fails with IREE_STATUS_FAILED_PRECONDITION if another profiler is active.
+IREE_API_EXPORT iree_status_t
+iree_vm_sampling_profiler_start(iree_vm_sampling_profiler_t* profiler);
+
+// Stops sampling with |profiler|. Samples recorded so far are retained and
+// sampling may be started again to accumulate more. Waits for any threads
+// concurrently recording a sample into |profiler| so that it may be released
+// once this returns.
+IREE_API_EXPORT void iree_vm_sampling_profiler_stop(
+    iree_vm_sampling_profiler_t* profiler);
+
+// Advances the sample epoch of the active |profiler| by one interval.
+// Only required with IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK.
+IREE_API_EXPORT void iree_vm_sampling_profiler_tick(
+    iree_vm_sampling_profiler_t* profiler);
+
+// Returns the total weight of all samples recorded in units of intervals.
+IREE_API_EXPORT int64_t
+iree_vm_sampling_profiler_sample_count(iree_vm_sampling_profiler_t* profiler);
+
+// Appends all recorded samples to |builder| in the collapsed stack format with
+// one `bottom;...;top count` line per unique stack.
+IREE_API_EXPORT iree_status_t iree_vm_sampling_profiler_append_collapsed(
+    iree_vm_sampling_profiler_t* profiler, iree_string_builder_t* builder);
+
+// Appends all recorded samples to |builder| as an uncompressed binary pprof
+// profile (perftools.profiles.Profile protocol buffer).
+IREE_API_EXPORT iree_status_t iree_vm_sampling_profiler_append_pprof(
+    iree_vm_sampling_profiler_t* profiler, iree_string_builder_t* builder);
+
+//===----------------------------------------------------------------------===//
+// Interpreter support
+//===----------------------------------------------------------------------===//
+
+// Global sample epoch advanced by the active profiler.
+// Use iree_vm_sampling_profiler_epoch instead of accessing directly.
+extern iree_atomic_int32_t iree_vm_sampling_profiler_global_epoch;
+
+// Returns the current sample epoch. Interpreters cache the value at entry and
+// call iree_vm_sampling_profiler_record at a safepoint when it differs.
+static inline int32_t iree_vm_sampling_profiler_epoch(void) {
+  return iree_atomic_load(&iree_vm_sampling_profiler_global_epoch,
+                          iree_memory_order_relaxed);
+}
+
+// Records a sample of |stack| into the active profiler, if any, weighted by
+// the number of intervals elapsed since |last_epoch|. The pc of the current
+// frame must be stored in the frame prior to calling. |leaf_function| is an
+// optional function called by the current frame that no longer has a frame of
+// its own, such as a native import that has just returned.
+// Returns the current epoch to compare against at the next safepoint.
+IREE_API_EXPORT int32_t iree_vm_sampling_profiler_record(
+    iree_vm_stack_t* stack, int32_t last_epoch,
+    const iree_vm_function_t* leaf_function);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_SAMPLING_PROFILER_H_
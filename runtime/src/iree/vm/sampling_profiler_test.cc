@@ -0,0 +1,249 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/sampling_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/native_module_test.h"
+#include "iree/vm/stack.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Uses module_a and module_b defined in native_module_test.h as the functions
+// on the sampled stacks. Samples are driven with manual ticks so that the
+// results are deterministic.
+class VMSamplingProfilerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+    iree_vm_module_t* module_a = nullptr;
+    IREE_CHECK_OK(
+        module_a_create(instance_, iree_allocator_system(), &module_a));
+    iree_vm_module_t* module_b = nullptr;
+    IREE_CHECK_OK(
+        module_b_create(instance_, iree_allocator_system(), &module_b));
+    std::vector<iree_vm_module_t*> modules = {module_a, module_b};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(module_a);
+    iree_vm_module_release(module_b);
+
+    iree_vm_sampling_profiler_options_t options = {0};
+    options.flags = IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK;
+    IREE_CHECK_OK(iree_vm_sampling_profiler_create(
+        options, iree_allocator_system(), &profiler_));
+  }
+
+  virtual void TearDown() {
+    iree_vm_sampling_profiler_release(profiler_);
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_vm_function_t ResolveFunction(const char* name) {
+    iree_vm_function_t function;
+    IREE_CHECK_OK(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view(name), &function));
+    return function;
+  }
+
+  std::string AppendCollapsed() {
+    iree_string_builder_t builder;
+    iree_string_builder_initialize(iree_allocator_system(), &builder);
+    IREE_CHECK_OK(
+        iree_vm_sampling_profiler_append_collapsed(profiler_, &builder));
+    std::string result(iree_string_builder_buffer(&builder),
+                       iree_string_builder_size(&builder));
+    iree_string_builder_deinitialize(&builder);
+    return result;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_sampling_profiler_t* profiler_ = nullptr;
+};
+
+// Tests that samples are weighted by elapsed intervals and aggregated by stack.
+TEST_F(VMSamplingProfilerTest, RecordStacks) {
+  IREE_ASSERT_OK(iree_vm_sampling_profiler_start(profiler_));
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+  iree_vm_function_t entry_function = ResolveFunction("module_b.entry");
+  iree_vm_function_t add_function = ResolveFunction("module_a.add_1");
+  iree_vm_stack_frame_t* frame = nullptr;
+  IREE_ASSERT_OK(iree_vm_stack_function_enter(stack, &entry_function,
+                                              IREE_VM_STACK_FRAME_NATIVE, 0,
+                                              NULL, &frame));
+
+  // No sample is recorded until the epoch advances.
+  int32_t epoch = iree_vm_sampling_profiler_epoch();
+  EXPECT_EQ(iree_vm_sampling_profiler_record(stack, epoch, NULL), epoch);
+  EXPECT_EQ(iree_vm_sampling_profiler_sample_count(profiler_), 0);
+
+  // Two elapsed intervals are recorded as a single sample of weight 2.
+  iree_vm_sampling_profiler_tick(profiler_);
+  iree_vm_sampling_profiler_tick(profiler_);
+  epoch = iree_vm_sampling_profiler_record(stack, epoch, NULL);
+  EXPECT_EQ(epoch, iree_vm_sampling_profiler_epoch());
+
+  // Leaf functions are recorded as called from the top frame.
+  iree_vm_sampling_profiler_tick(profiler_);
+  epoch = iree_vm_sampling_profiler_record(stack, epoch, &add_function);
+
+  // Repeated stacks accumulate into the existing entry.
+  iree_vm_sampling_profiler_tick(profiler_);
+  epoch = iree_vm_sampling_profiler_record(stack, epoch, NULL);
+
+  // Samples are no longer recorded once stopped.
+  iree_vm_sampling_profiler_stop(profiler_);
+  iree_vm_sampling_profiler_tick(profiler_);
+  iree_vm_sampling_profiler_record(stack, epoch, &add_function);
+
+  IREE_ASSERT_OK(iree_vm_stack_function_leave(stack));
+  iree_vm_stack_deinitialize(stack);
+
+  EXPECT_EQ(iree_vm_sampling_profiler_sample_count(profiler_), 4);
+  EXPECT_EQ(AppendCollapsed(),
+            "module_b.entry 3\n"
+            "module_b.entry;module_a.add_1 1\n");
+}
+
+// Tests that the pprof output is a well-formed Profile message.
+TEST_F(VMSamplingProfilerTest, AppendPprof) {
+  IREE_ASSERT_OK(iree_vm_sampling_profiler_start(profiler_));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+  iree_vm_function_t entry_function = ResolveFunction("module_b.entry");
+  iree_vm_stack_frame_t* frame = nullptr;
+  IREE_ASSERT_OK(iree_vm_stack_function_enter(stack, &entry_function,
+                                              IREE_VM_STACK_FRAME_NATIVE, 0,
+                                              NULL, &frame));
+  int32_t epoch = iree_vm_sampling_profiler_epoch();
+  iree_vm_sampling_profiler_tick(profiler_);
+  iree_vm_sampling_profiler_record(stack, epoch, NULL);
+  IREE_ASSERT_OK(iree_vm_stack_function_leave(stack));
+  iree_vm_stack_deinitialize(stack);
+  iree_vm_sampling_profiler_stop(profiler_);
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_ASSERT_OK(iree_vm_sampling_profiler_append_pprof(profiler_, &builder));
+  std::string profile(iree_string_builder_buffer(&builder),
+                      iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+
+  // Walk the top-level fields to verify the message is well-formed.
+  std::vector<std::string> strings;
+  int sample_count = 0;
+  size_t i = 0;
+  auto read_varint = [&]() {
+    uint64_t value = 0;
+    for (int shift = 0; i < profile.size(); shift += 7) {
+      uint8_t byte = static_cast<uint8_t>(profile[i++]);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) break;
+    }
+    return value;
+  };
+  while (i < profile.size()) {
+    uint64_t key = read_varint();
+    if ((key & 0x7) == 0) {
+      read_varint();
+    } else {
+      ASSERT_EQ(key & 0x7, 2u);
+      uint64_t length = read_varint();
+      ASSERT_LE(i + length, profile.size());
+      if ((key >> 3) == 2) ++sample_count;
+      if ((key >> 3) == 6) strings.push_back(profile.substr(i, length));
+      i += length;
+    }
+  }
+  EXPECT_EQ(i, profile.size());
+  EXPECT_EQ(sample_count, 1);
+  ASSERT_FALSE(strings.empty());
+  EXPECT_EQ(strings[0], "");
+  EXPECT_NE(std::find(strings.begin(), strings.end(), "module_b.entry"),
+            strings.end());
+}
+
+// Tests that only one profiler may be active at a time.
+TEST_F(VMSamplingProfilerTest, SingleActiveProfiler) {
+  iree_vm_sampling_profiler_options_t options = {0};
+  options.flags = IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK;
+  iree_vm_sampling_profiler_t* other_profiler = NULL;
+  IREE_ASSERT_OK(iree_vm_sampling_profiler_create(
+      options, iree_allocator_system(), &other_profiler));
+
+  IREE_ASSERT_OK(iree_vm_sampling_profiler_start(profiler_));
+  EXPECT_THAT(Status(iree_vm_sampling_profiler_start(other_profiler)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  iree_vm_sampling_profiler_stop(profiler_);
+  IREE_EXPECT_OK(iree_vm_sampling_profiler_start(other_profiler));
+  iree_vm_sampling_profiler_stop(other_profiler);
+
+  iree_vm_sampling_profiler_release(other_profiler);
+}
+
+// Tests that stopping a profiler waits for threads concurrently recording into
+// it so that the profiler can be released immediately afterward.
+TEST_F(VMSamplingProfilerTest, StopWaitsForRecorders) {
+  std::atomic<bool> done = {false};
+  std::thread recorder_thread([&]() {
+    IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                    iree_vm_context_state_resolver(context_),
+                                    iree_allocator_system());
+    iree_vm_function_t entry_function = ResolveFunction("module_b.entry");
+    iree_vm_stack_frame_t* frame = nullptr;
+    IREE_CHECK_OK(iree_vm_stack_function_enter(stack, &entry_function,
+                                               IREE_VM_STACK_FRAME_NATIVE, 0,
+                                               NULL, &frame));
+    // Passing a prior epoch records a sample on every call.
+    while (!done.load()) {
+      int32_t epoch = iree_vm_sampling_profiler_epoch();
+      iree_vm_sampling_profiler_record(stack, epoch - 1, NULL);
+    }
+    IREE_CHECK_OK(iree_vm_stack_function_leave(stack));
+    iree_vm_stack_deinitialize(stack);
+  });
+
+  iree_vm_sampling_profiler_options_t options = {0};
+  options.flags = IREE_VM_SAMPLING_PROFILER_FLAG_MANUAL_TICK;
+  for (int i = 0; i < 200; ++i) {
+    iree_vm_sampling_profiler_t* profiler = NULL;
+    IREE_ASSERT_OK(iree_vm_sampling_profiler_create(
+        options, iree_allocator_system(), &profiler));
+    IREE_ASSERT_OK(iree_vm_sampling_profiler_start(profiler));
+    while (iree_vm_sampling_profiler_sample_count(profiler) == 0) {
+      std::this_thread::yield();
+    }
+    iree_vm_sampling_profiler_stop(profiler);
+    iree_vm_sampling_profiler_release(profiler);
+  }
+
+  done.store(true);
+  recorder_thread.join();
+}
+
+}  // namespace
+}  // namespace iree
@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "iree/base/api.h"
@@ -320,6 +321,16 @@ IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_parent_frame(
   return parent_header ? &parent_header->frame : NULL;
 }
 
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_frame_parent(
+    iree_vm_stack_frame_t* frame) {
+  if (!frame) return NULL;
+  iree_vm_stack_frame_header_t* header =
+      (iree_vm_stack_frame_header_t*)((uintptr_t)frame -
+                                      offsetof(iree_vm_stack_frame_header_t,
+                                               frame));
+  return header->parent ? &header->parent->frame : NULL;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
     iree_vm_stack_t* stack, iree_vm_module_t* module,
     iree_vm_module_state_t** out_module_state) {
@@ -537,9 +548,10 @@ static iree_zone_id_t iree_vm_stack_trace_function_zone_begin(
 }
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
-IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
+IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter_with_state(
     iree_vm_stack_t* stack, const iree_vm_function_t* function,
-    iree_vm_stack_frame_type_t frame_type, iree_host_size_t frame_size,
+    iree_vm_module_state_t* module_state, iree_vm_stack_frame_type_t frame_type,
+    iree_host_size_t frame_size,
     iree_vm_stack_frame_cleanup_fn_t frame_cleanup_fn,
     iree_vm_stack_frame_t* IREE_RESTRICT* out_callee_frame) {
   if (out_callee_frame) *out_callee_frame = NULL;
@@ -553,18 +565,9 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
     IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
   }
 
-  // Try to reuse the same module state if the caller and callee are from the
-  // same module. Otherwise, query the state from the registered handler.
   iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
   iree_vm_stack_frame_t* caller_frame =
       caller_frame_header ? &caller_frame_header->frame : NULL;
-  iree_vm_module_state_t* module_state = NULL;
-  if (caller_frame && caller_frame->function.module == function->module) {
-    module_state = caller_frame->module_state;
-  } else if (function->module != NULL) {
-    IREE_RETURN_IF_ERROR(stack->state_resolver.query_module_state(
-        stack->state_resolver.self, function->module, &module_state));
-  }
 
   // Bump pointer and get real stack pointer offsets.
   iree_vm_stack_frame_header_t* frame_header =
@@ -600,6 +603,31 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
+    iree_vm_stack_t* stack, const iree_vm_function_t* function,
+    iree_vm_stack_frame_type_t frame_type, iree_host_size_t frame_size,
+    iree_vm_stack_frame_cleanup_fn_t frame_cleanup_fn,
+    iree_vm_stack_frame_t* IREE_RESTRICT* out_callee_frame) {
+  if (out_callee_frame) *out_callee_frame = NULL;
+
+  // Try to reuse the same module state if the caller and callee are from the
+  // same module. Otherwise, query the state from the registered handler.
+  iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
+  iree_vm_stack_frame_t* caller_frame =
+      caller_frame_header ? &caller_frame_header->frame : NULL;
+  iree_vm_module_state_t* module_state = NULL;
+  if (caller_frame && caller_frame->function.module == function->module) {
+    module_state = caller_frame->module_state;
+  } else if (function->module != NULL) {
+    IREE_RETURN_IF_ERROR(stack->state_resolver.query_module_state(
+        stack->state_resolver.self, function->module, &module_state));
+  }
+
+  return iree_vm_stack_function_enter_with_state(
+      stack, function, module_state, frame_type, frame_size, frame_cleanup_fn,
+      out_callee_frame);
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
   if (IREE_UNLIKELY(!stack->top)) {
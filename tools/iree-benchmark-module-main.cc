@@ -68,6 +68,7 @@
 #include "iree/tooling/context_util.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/function_io.h"
+#include "iree/tooling/vm_sampling_util.h"
 #include "iree/vm/api.h"
 
 constexpr char kNanosecondsUnitString[] = "ns";
@@ -631,7 +632,11 @@ static int runMain(int argc, char** argv) {
     return exit_code;
   }
   IREE_CHECK_OK(iree_hal_begin_profiling_from_flags(iree_benchmark.device()));
+  iree_vm_sampling_profiler_t* vm_profiler = NULL;
+  IREE_CHECK_OK(iree_tooling_begin_vm_sampling_from_flags(
+      iree_allocator_system(), &vm_profiler));
   ::benchmark::RunSpecifiedBenchmarks();
+  IREE_CHECK_OK(iree_tooling_end_vm_sampling_from_flags(vm_profiler));
   IREE_CHECK_OK(iree_hal_end_profiling_from_flags(iree_benchmark.device()));
 
   IREE_TRACE_ZONE_END(z0);
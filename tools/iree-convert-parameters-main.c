@@ -13,8 +13,10 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/flags.h"
 #include "iree/hal/api.h"
+#include "iree/io/compression.h"
 #include "iree/io/file_handle.h"
 #include "iree/io/formats/irpa/irpa_builder.h"
+#include "iree/io/formats/irpa/irpa_util.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/scope_map.h"
 #include "iree/tooling/parameter_util.h"
@@ -164,6 +166,19 @@ IREE_FLAG(bool, quiet, false,
 
 IREE_FLAG(string, output, "", "Output .irpa file path.");
 
+IREE_FLAG(string, compress, "none",
+          "Compresses file-backed parameters in the output archive with the\n"
+          "given codec (`none` or `lz4`). Compressed parameters in the inputs\n"
+          "are decompressed when `none`.");
+IREE_FLAG(int32_t, compress_block_size, IREE_IO_COMPRESSION_DEFAULT_BLOCK_SIZE,
+          "Uncompressed bytes per compressed block. Smaller blocks allow for\n"
+          "more parallelism when loading at the cost of compression ratio.");
+IREE_FLAG(string, hash, "xxh64",
+          "Hash stored with each parameter to allow verifying its contents\n"
+          "when loading (`none` or `xxh64`).");
+IREE_FLAG(int32_t, worker_count, 8,
+          "Maximum number of threads used to write parameter contents.");
+
 typedef struct {
   iree_allocator_t host_allocator;
   const char* path;
@@ -214,7 +229,17 @@ int main(int argc, char** argv) {
       "    --parameters=input.irpa \\\n"
       "    --strip \\\n"
       "    --splat=special_param=f32=1.0 \\\n"
-      "    --output=output.irpa\n");
+      "    --output=output.irpa\n"
+      "\n"
+      "Example compressing parameters so that they are decompressed when\n"
+      "loaded:\n"
+      "  iree-convert-parameters \\\n"
+      "    --parameters=input.irpa \\\n"
+      "    --compress=lz4 \\\n"
+      "    --output=output.irpa\n"
+      "\n"
+      "Parameter contents are hashed by default so that they can be verified\n"
+      "when loaded with `--parameter_verify`.\n");
   iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
 
   // Load parameter indices as specified by command line flags.
@@ -239,6 +264,22 @@ int main(int argc, char** argv) {
     status = iree_io_parameter_index_create(host_allocator, &built_index);
   }
 
+  // Parse how parameter contents should be stored.
+  iree_io_parameter_archive_build_options_t build_options = {
+      .compression_type = IREE_IO_COMPRESSION_TYPE_NONE,
+      .compression_block_size = (uint32_t)FLAG_compress_block_size,
+      .hash_type = IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE,
+      .worker_count = (iree_host_size_t)iree_max(0, FLAG_worker_count),
+  };
+  if (iree_status_is_ok(status)) {
+    status = iree_io_compression_type_parse(
+        iree_make_cstring_view(FLAG_compress), &build_options.compression_type);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_hash_type_parse(
+        iree_make_cstring_view(FLAG_hash), &build_options.hash_type);
+  }
+
   // Write out the new archive.
   if (iree_status_is_ok(status)) {
     iree_tooling_open_params_t open_params = {
@@ -249,9 +290,9 @@ int main(int argc, char** argv) {
         .fn = iree_tooling_open_output_parameter_file,
         .user_data = &open_params,
     };
-    status = iree_io_build_parameter_archive(
+    status = iree_io_build_parameter_archive_with_options(
         new_index, built_index, open_callback,
-        /*target_file_offset=*/0, host_allocator);
+        /*target_file_offset=*/0, &build_options, host_allocator);
   }
 
   // Dump the new index ala iree-dump-parameters to show the final file.
@@ -14,6 +14,7 @@
 #include "iree/hal/api.h"
 #include "iree/io/file_handle.h"
 #include "iree/io/formats/irpa/irpa_builder.h"
+#include "iree/io/formats/irpa/irpa_util.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/stream.h"
 
@@ -151,6 +152,49 @@ static iree_status_t iree_tooling_declare_parameters(
   return iree_ok_status();
 }
 
+// Computes the content hashes of all data parameters as they will be written
+// by iree_tooling_define_parameters.
+static iree_status_t iree_tooling_hash_parameters(
+    iree_io_parameter_archive_builder_t* builder) {
+  if (builder->hash_type == IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Data parameters were declared after all splat parameters.
+  const iree_host_size_t base_entry_index = FLAG_splat_list().count;
+  for (iree_host_size_t i = 0; i < FLAG_data_list().count; ++i) {
+    iree_io_parameter_info_t info;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0,
+        iree_io_parameter_info_from_string(FLAG_data_list().values[i], &info));
+
+    // Hash the repeated pattern a chunk at a time. The chunk holds a whole
+    // number of patterns so that each chunk continues where the last left off.
+    uint8_t chunk[4096];
+    const iree_host_size_t chunk_length =
+        (sizeof(chunk) / info.splat.pattern_length) * info.splat.pattern_length;
+    for (iree_host_size_t j = 0; j < chunk_length;
+         j += info.splat.pattern_length) {
+      memcpy(&chunk[j], info.splat.pattern, info.splat.pattern_length);
+    }
+    iree_io_xxh64_state_t state;
+    iree_io_xxh64_initialize(/*seed=*/0, &state);
+    for (uint64_t j = 0; j < info.storage_size; j += chunk_length) {
+      const uint64_t length = iree_min(chunk_length, info.storage_size - j);
+      iree_io_xxh64_update(
+          &state, iree_make_const_byte_span(chunk, (iree_host_size_t)length));
+    }
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_archive_builder_set_entry_hash(
+                builder, base_entry_index + i,
+                iree_io_xxh64_finalize(&state)));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 // Defines parameter storage for those that require it.
 static iree_status_t iree_tooling_define_parameters(
     iree_io_parameter_index_t* target_index,
@@ -190,6 +234,10 @@ IREE_FLAG(bool, quiet, false,
 // TODO(benvanik): add --append= to chain archive headers.
 IREE_FLAG(string, output, "", "Output .irpa file path.");
 
+IREE_FLAG(string, hash, "xxh64",
+          "Hash stored with each data parameter to allow verifying its\n"
+          "contents when loading (`none` or `xxh64`).");
+
 static iree_status_t iree_tooling_open_output_parameter_file(
     iree_io_physical_offset_t archive_offset,
     iree_io_physical_size_t archive_length, iree_allocator_t host_allocator,
@@ -240,9 +288,28 @@ int main(int argc, char** argv) {
   iree_io_parameter_archive_builder_t builder;
   iree_io_parameter_archive_builder_initialize(host_allocator, &builder);
 
+  // Select the hash stored with data parameters. This must happen before any
+  // parameters are declared as the hashes occupy space in the header.
+  iree_io_parameter_archive_hash_type_t hash_type =
+      IREE_IO_PARAMETER_ARCHIVE_HASH_TYPE_NONE;
+  iree_status_t status = iree_io_parameter_archive_hash_type_parse(
+      iree_make_cstring_view(FLAG_hash), &hash_type);
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_io_parameter_archive_builder_set_hash_type(&builder, hash_type);
+  }
+
   // Declare parameters based on flags, populating the builder with the metadata
   // for each parameter without yet writing any data.
-  iree_status_t status = iree_tooling_declare_parameters(&builder);
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_declare_parameters(&builder);
+  }
+
+  // Hash the contents each data parameter will have so that the hashes can be
+  // written with the header.
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_hash_parameters(&builder);
+  }
 
   // Open a file of sufficient size (now that we know it) for writing.
   iree_io_physical_offset_t target_file_offset = 0;